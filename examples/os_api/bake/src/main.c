@@ -27,6 +27,15 @@ int32_t bake_adec(int32_t *value) {
     return ut_adec(value);
 }
 
+static
+int32_t bake_aload(const int32_t *value) {
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    return InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#endif
+}
+
 static
 ecs_os_mutex_t bake_mutex_new(void) {
     struct ut_mutex_s *m = ecs_os_malloc(sizeof(struct ut_mutex_s));
@@ -154,6 +163,7 @@ void bake_set_os_api(void) {
     api.thread_join_ = bake_thread_join;
     api.ainc_ = bake_ainc;
     api.adec_ = bake_adec;
+    api.aload_ = bake_aload;
     api.mutex_new_ = bake_mutex_new;
     api.mutex_free_ = bake_mutex_free;
     api.mutex_lock_ = bake_mutex_lock;
@@ -48,6 +48,15 @@ int32_t stdcpp_adec(int32_t *count) {
 #endif
 }
 
+static
+int32_t stdcpp_aload(const int32_t *value) {
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    return InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#endif
+}
+
 static
 ecs_os_mutex_t stdcpp_mutex_new(void) {
     std::mutex *mutex = new std::mutex;
@@ -112,6 +121,7 @@ void stdcpp_set_os_api(void) {
     api.thread_join_ = stdcpp_thread_join;
     api.ainc_ = stdcpp_ainc;
     api.adec_ = stdcpp_adec;
+    api.aload_ = stdcpp_aload;
     api.mutex_new_ = stdcpp_mutex_new;
     api.mutex_free_ = stdcpp_mutex_free;
     api.mutex_lock_ = stdcpp_mutex_lock;
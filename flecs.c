@@ -114,6 +114,9 @@ void flecs_stack_free(
 void flecs_stack_reset(
     ecs_stack_t *stack);
 
+int64_t flecs_stack_trim(
+    ecs_stack_t *stack);
+
 ecs_stack_cursor_t flecs_stack_get_cursor(
     ecs_stack_t *stack);
 
@@ -198,6 +201,11 @@ void flecs_bitset_swap(
     int32_t elem_a,
     int32_t elem_b);
 
+/** Return index of lowest set bit. Value must not be 0. */
+FLECS_DBG_API
+int32_t flecs_ctz64(
+    uint64_t value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -206,26 +214,22 @@ void flecs_bitset_swap(
 
 /**
  * @file switch_list.h
- * @brief Interleaved linked list for storing mutually exclusive values.
+ * @brief Datastructure for storing mutually exclusive values.
  *
- * Datastructure that stores N interleaved linked lists in an array. 
- * This allows for efficient storage of elements with mutually exclusive values.
- * Each linked list has a header element which points to the index in the array
- * that stores the first node of the list. Each list node points to the next
- * array element.
+ * Datastructure that stores for each element a value, and for each value a
+ * dense array with the elements that have the value. This allows for efficient
+ * storage of elements with mutually exclusive values.
  *
- * The datastructure needs to be created with min and max values, so that it can
- * allocate an array of headers that can be directly indexed by the value. The
- * values are stored in a contiguous array, which allows for the values to be
- * iterated without having to follow the linked list nodes.
+ * Each element stores its index in the dense array of its value, so that the
+ * value of an element can be changed in constant time by swapping the element
+ * with the last element in the dense array. The values are stored in a
+ * contiguous array, which allows for the values to be iterated without having
+ * to go through the dense arrays.
  *
  * The datastructure allows for efficient storage and retrieval for values with
- * mutually exclusive values, such as enumeration values. The linked list allows
- * an application to obtain all elements for a given (enumeration) value without
- * having to search.
- *
- * While the list accepts 64 bit values, it only uses the lower 32bits of the
- * value for selecting the correct linked list.
+ * mutually exclusive values, such as enumeration values. The dense arrays allow
+ * an application to obtain all elements for a given (enumeration) value with a
+ * contiguous scan.
  */
 
 #ifndef FLECS_SWITCH_LIST_H
@@ -233,13 +237,11 @@ void flecs_bitset_swap(
 
 
 typedef struct ecs_switch_header_t {
-    int32_t element;        /* First element for value */
-    int32_t count;          /* Number of elements for value */
+    ecs_vec_t elements;     /* vec<int32_t>, elements with value */
 } ecs_switch_header_t;
 
 typedef struct ecs_switch_node_t {
-    int32_t next;           /* Next node in list */
-    int32_t prev;           /* Prev node in list */
+    int32_t index;          /* Index of element in elements of its value */
 } ecs_switch_node_t;
 
 struct ecs_switch_t {    
@@ -342,6 +344,13 @@ int32_t flecs_switch_next(
     const ecs_switch_t *sw,
     int32_t elem);
 
+/** Return elements for value. Elements that were assigned to the value last
+ * are stored last. Use together with case_count(). */
+FLECS_DBG_API
+const int32_t* flecs_switch_elements(
+    const ecs_switch_t *sw,
+    uint64_t value);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -358,6 +367,9 @@ extern const ecs_entity_t EcsFlag;
 
 #define ECS_MAX_JOBS_PER_WORKER (16)
 
+/* Number of rows per block for which changes are tracked by dirty_blocks */
+#define ECS_DIRTY_BLOCK_SIZE (64)
+
 /* Magic number for a flecs object */
 #define ECS_OBJECT_MAGIC (0x6563736f)
 
@@ -514,6 +526,8 @@ struct ecs_table_t {
     ecs_type_info_t **type_info;     /* Cached type info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_vec_t *dirty_blocks;         /* Per column, dirty state for each block
+                                      * of rows (only for changed_only queries) */
 
     int16_t sw_count;
     int16_t sw_offset;
@@ -561,6 +575,13 @@ typedef struct flecs_bitset_term_t {
     int32_t column_index;
 } flecs_bitset_term_t;
 
+/* Query term for component stored in sparse set */
+typedef struct flecs_sparse_join_term_t {
+    ecs_id_record_t *idr;
+    ecs_oper_kind_t oper;
+    int32_t field_index;
+} flecs_sparse_join_term_t;
+
 typedef struct ecs_query_table_match_t ecs_query_table_match_t;
 
 /** List node used to iterate tables in a query.
@@ -597,6 +618,35 @@ struct ecs_query_table_match_t {
     int32_t *monitor;         /* Used to monitor table for changes */
 };
 
+/** Match fields that are read for each iterated table */
+typedef struct ecs_query_table_data_t {
+    int32_t *columns;
+    int32_t *storage_columns;
+    ecs_id_t *ids;
+    ecs_entity_t *sources;
+    ecs_size_t *sizes;
+    ecs_ref_t *references;
+    ecs_vector_t *sparse_columns;
+    ecs_vector_t *bitset_columns;
+} ecs_query_table_data_t;
+
+/** Element of a table array. Stores a copy of the list node and match data,
+ * so that iterating the array doesn't dereference the match. */
+typedef struct ecs_query_table_elem_t {
+    ecs_query_table_node_t node; /* Must be first, iterators walk the nodes */
+    ecs_query_table_data_t data;
+} ecs_query_table_elem_t;
+
+/** Contiguous array with the tables of a query, in iteration order. Iterators 
+ * hold a reference to the array, which is replaced instead of modified while
+ * it is referenced. */
+struct ecs_query_table_array_t {
+    ecs_query_table_elem_t *elems;
+    int32_t count;
+    int32_t size;
+    int32_t refs;                    /* Query + number of iterators */
+};
+
 /** A single table can occur multiple times in the cache when a term matches
  * multiple table columns. */
 typedef struct ecs_query_table_t {
@@ -646,9 +696,21 @@ struct ecs_query_t {
     /* Tables matched with query */
     ecs_table_cache_t cache;
 
+    /* Terms for components stored in sparse sets, which are joined with the
+     * rows of matched tables during iteration */
+    ecs_vector_t *sparse_terms; /* vector<flecs_sparse_join_term_t> */
+
+    /* Filter used to match tables if the query has sparse terms. The sparse
+     * terms are optional in this filter. */
+    ecs_filter_t match_filter;
+
     /* Linked list with all matched non-empty tables, in iteration order */
     ecs_query_table_list_t list;
 
+    /* Contiguous copy of list nodes, so iteration doesn't chase pointers */
+    ecs_query_table_array_t *table_array;
+    ecs_vector_t *table_array_retired; /* vector<ecs_query_table_array_t*> */
+
     /* Contains head/tail to nodes of query groups (if group_by is used) */
     ecs_map_t groups;
 
@@ -707,6 +769,34 @@ typedef struct ecs_event_id_record_t {
     int32_t observer_count;
 } ecs_event_id_record_t;
 
+/** Number of filter match results cached by a multi observer */
+#define FLECS_OBSERVER_MATCH_CACHE_SIZE (8)
+
+/** Result of matching the filter of a multi observer with a table */
+typedef struct ecs_observer_match_t {
+    const ecs_table_t *table;      /* Table the event was emitted for */
+    const ecs_table_t *prev_table; /* Table before the event (monitor, Not) */
+    ecs_entity_t event;
+    int32_t pivot_term;            /* Term of the child observer */
+    int32_t column;                /* Column of the pivot term */
+    bool match;
+
+    /* Field data of the match, field_count elements each */
+    ecs_id_t *ids;
+    int32_t *columns;
+    ecs_entity_t *sources;
+} ecs_observer_match_t;
+
+/** Filter match results of a multi observer, so that events for the same
+ * table don't have to evaluate the filter again. Since a table type never
+ * changes, results only become invalid when a table is deleted, after which
+ * its address could be reused by a new table. */
+typedef struct ecs_observer_match_cache_t {
+    ecs_observer_match_t entries[FLECS_OBSERVER_MATCH_CACHE_SIZE];
+    int64_t table_delete_total;    /* Value of world counter when filled */
+    bool has_up;                   /* Filter has terms that traverse IsA */
+} ecs_observer_match_cache_t;
+
 /* World level allocators are for operations that are not multithreaded */
 typedef struct ecs_world_allocators_t {
     ecs_map_params_t ptr;
@@ -774,6 +864,13 @@ typedef struct ecs_cmd_t {
     } is;
 } ecs_cmd_t;
 
+/* Range of commands in the queue of a stage */
+typedef struct ecs_cmd_range_t {
+    int32_t stage;              /* Stage index */
+    int32_t first;              /* First command in range */
+    int32_t count;              /* Number of commands in range */
+} ecs_cmd_range_t;
+
 /* Entity specific metadata for command in defer queue */
 typedef struct ecs_cmd_entry_t {
     int32_t first;
@@ -857,8 +954,67 @@ typedef struct ecs_store_t {
 
     /* Stack of ids being deleted. */
     ecs_vector_t *marked_ids;    /* vector<ecs_marked_ids_t> */
+
+    /* Id records with sparse component storage */
+    ecs_vector_t *sparse_ids;    /* vector<ecs_id_record_t*> */
+
+    /* Sparse components per entity */
+    ecs_map_t sparse_entities;   /* map<entity, vec<ecs_id_record_t*>> */
+
+    /* Id records with a transitive closure */
+    ecs_vector_t *subset_ids;    /* vector<ecs_id_record_t*> */
 } ecs_store_t;
 
+/* Component value that is written to storage after the structural changes of
+ * a merge have been applied (see ecs_set_parallel_merge) */
+typedef struct ecs_merge_write_t {
+    ecs_entity_t entity;
+    ecs_id_t id;
+    void *value;
+    ecs_size_t size;
+
+    /* Storage location, resolved right before the value is written */
+    int32_t row;
+    int32_t column;
+    int32_t order;               /* Position in queue, used for stable sort */
+    ecs_table_t *table;
+} ecs_merge_write_t;
+
+/* Job that writes part of the values of a parallel merge. The job is invoked
+ * on multiple threads at the same time, which claim work until none is left. */
+typedef void (*ecs_merge_job_action_t)(
+    ecs_world_t *world,
+    void *ctx);
+
+/* Run merge job on all threads, returns when all threads are done */
+typedef void (*ecs_merge_run_action_t)(
+    ecs_world_t *world,
+    ecs_merge_job_action_t job,
+    void *ctx);
+
+/* Command in a command queue. The value of a set command is stored in the
+ * same slot, directly after the element. */
+typedef struct ecs_cmd_queue_elem_t {
+    ecs_cmd_kind_t kind;
+    ecs_size_t size;
+    ecs_entity_t entity;
+    ecs_id_t id;
+} ecs_cmd_queue_elem_t;
+
+/* Bounded queue that a single producer thread adds commands to, and that is
+ * merged by the thread that owns the world. */
+struct ecs_cmd_queue_t {
+    ecs_world_t *world;
+    void *slots;                 /* Ring buffer with capacity slots */
+    ecs_size_t slot_size;        /* Size of element + value */
+    ecs_size_t value_size;       /* Max size of value */
+    int32_t capacity;
+    int32_t head;                /* Next slot to write (producer) */
+    int32_t tail;                /* Next slot to read (consumer) */
+    int32_t count;               /* Number of published commands */
+    int32_t used;                /* Number of slots that can't be written */
+};
+
 /* fini actions */
 typedef struct ecs_action_elem_t {
     ecs_fini_action_t action;
@@ -899,6 +1055,7 @@ struct ecs_world_t {
     /* --  Pending table event buffers -- */
     ecs_sparse_t *pending_buffer;  /* sparse<table_id, ecs_table_t*> */
     ecs_sparse_t *pending_tables;  /* sparse<table_id, ecs_table_t*> */
+    ecs_vector_t *pending_queries; /* vector<ecs_query_t*>, table array updates */
 
     /* Used to track when cache needs to be updated */
     ecs_monitor_set_t monitors;    /* map<id, ecs_monitor_t> */
@@ -920,6 +1077,21 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t workers_gen;         /* Incremented each time workers are signaled */
+    bool sync_parked;            /* Whether main thread blocks on sync_cond */
+
+    /* -- Command queues -- */
+    ecs_vec_t cmd_queues;        /* vec<ecs_cmd_queue_t*> */
+
+    /* -- Parallel merge -- */
+    ecs_vec_t merge_writes;      /* vec<ecs_merge_write_t> */
+    ecs_merge_run_action_t merge_run; /* Set while workers can run merge jobs */
+    ecs_merge_job_action_t merge_job; /* Job that workers should run */
+    void *merge_job_ctx;         /* Context passed to merge job */
+    int32_t merge_jobs_done;     /* Number of workers that finished job */
+    const ecs_cmd_range_t *merge_order; /* If set, order of stage merge */
+    int32_t merge_order_count;   /* Number of ranges in merge_order */
 
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
@@ -1043,6 +1215,33 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+typedef struct ecs_subset_elem_t {
+    ecs_table_t *table;
+    int32_t column;
+} ecs_subset_elem_t;
+
+/* Tables of a transitive closure. Iterators that yield the tables hold a
+ * reference, so a closure that changes while it is iterated replaces its
+ * tables instead of modifying them. Tables use the OS heap, since a worker
+ * thread can release the last reference. */
+typedef struct ecs_subset_tables_t {
+    ecs_vector_t *tables; /* vector<ecs_subset_elem_t>, in depth-first order */
+    int32_t refs;         /* Cache + number of iterators yielding tables */
+} ecs_subset_tables_t;
+
+/* Transitive closure of a (R, tgt) pair: all tables that have the pair, or
+ * have (R, e) where e is in one of the tables of the closure. The storage
+ * queues tables with an R pair that are created, and targets that move to
+ * another table. Queued changes are applied the next time the closure is
+ * used. Deleted tables are removed right away. */
+typedef struct ecs_subset_cache_t {
+    ecs_subset_tables_t *tables;
+    ecs_map_t table_refs; /* map<table id, int32_t>, (R, member) pairs */
+    ecs_map_t members;    /* map<entity, bool>, entities with subsets in closure */
+    ecs_vec_t created;    /* vec<uint64_t>, ids of created tables */
+    ecs_vec_t moved;      /* vec<ecs_entity_t>, targets that changed table */
+} ecs_subset_cache_t;
+
 /* Payload for id index which contains all datastructures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -1060,9 +1259,17 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Transitive closure for pairs with a transitive relationship. Lazily 
+     * created by the rule engine. */
+    ecs_subset_cache_t *subsets;
+
     /* Cached pointer to type info for id, if id contains data. */
     const ecs_type_info_t *type_info;
 
+    /* Component storage for ids with the Sparse property. Lazily created when
+     * the id is added to its first entity. */
+    ecs_sparse_t *sparse; /* sparse<entity, T> */
+
     /* Id of record */
     ecs_id_t id;
 
@@ -1135,6 +1342,83 @@ const ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Get id record if id is stored in a sparse set */
+ecs_id_record_t* flecs_sparse_id_record_get(
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+/* Test if id is stored in a sparse set */
+bool flecs_id_is_sparse(
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+/* Same as flecs_sparse_id_record_get, but creates the record if necessary */
+ecs_id_record_t* flecs_sparse_id_record_ensure(
+    ecs_world_t *world,
+    ecs_id_t id);
+
+/* Get sparse component for entity, or NULL if entity does not have it */
+void* flecs_sparse_component_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Get or add sparse component for entity. When the component is added the
+ * constructor is invoked if construct is true, followed by the on_add hook. */
+void* flecs_sparse_component_ensure(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    bool construct,
+    bool *is_new);
+
+/* Invoke on_set hook for sparse component of entity */
+void flecs_sparse_component_on_set(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    void *ptr);
+
+/* Remove sparse component from entity. Returns false if not found. */
+bool flecs_sparse_component_remove(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Remove all sparse components from entity (used when entity is deleted). Only
+ * visits the sparse components of the entity. */
+void flecs_sparse_components_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Release reference to tables of transitive closure */
+void flecs_subset_tables_release(
+    ecs_subset_tables_t *tables);
+
+/* Get closure tables that can be modified. Tables that are being yielded by
+ * iterators are copied. */
+ecs_subset_tables_t* flecs_subset_tables_mut(
+    ecs_subset_cache_t *cache);
+
+/* Remove table from transitive closure */
+void flecs_subset_cache_remove_table(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table);
+
+/* Queue table with R pairs for the closures of R */
+void flecs_subsets_table_created(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Remove deleted table from closures */
+void flecs_subsets_table_deleted(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Queue pair target that moved to another table, or was deleted */
+void flecs_subsets_entity_moved(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
@@ -1371,6 +1655,12 @@ int32_t* flecs_table_get_dirty_state(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Get dirty state for blocks of rows in table columns. Enables tracking
+ * changes per block of rows for the table. */
+ecs_vec_t* flecs_table_get_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 /* Initialize root table */
 void flecs_init_root_table(
     ecs_world_t *world);
@@ -1425,7 +1715,16 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows dirty for column. If count is 0, mark all rows. */
+void flecs_table_mark_column_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count);
 
 void flecs_table_notify(
     ecs_world_t *world,
@@ -1625,6 +1924,10 @@ void flecs_stage_fini(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Free command queues of world */
+void flecs_cmd_queues_fini(
+    ecs_world_t *world);
+
 /* Post-frame merge actions */
 void flecs_stage_merge_post_frame(
     ecs_world_t *world,
@@ -1708,10 +2011,20 @@ bool flecs_defer_end(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+void flecs_defer_end_ordered(
+    ecs_world_t *world,
+    const ecs_cmd_range_t *ranges,
+    int32_t range_count);
+
 bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Stop batching commands with commands that are already in the queue, and
+ * return the number of commands in the queue. */
+int32_t flecs_stage_cmd_cut(
+    ecs_stage_t *stage);
+
 #endif
 
 /**
@@ -2231,6 +2544,19 @@ void flecs_query_notify(
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+bool flecs_query_update_table_array(
+    ecs_query_t *query);
+
+/* Find next result without finalizing the iterator when it is depleted */
+bool flecs_query_iter_next(
+    ecs_iter_t *it);
+
+/* Restrict query iterator to the results of a single table node. Used by
+ * chunked worker iterators to iterate the tables they claimed. */
+void flecs_query_iter_seek(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node);
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
@@ -3183,6 +3509,24 @@ void flecs_run_remove_hooks(
     }
 }
 
+/* Queue pair targets that leave or enter the table, so that transitive 
+ * closures that contain the tables of their subsets are updated. */
+static
+void flecs_table_subsets_moved(
+    ecs_world_t *world,
+    ecs_record_t **records,
+    ecs_entity_t *entities,
+    int32_t row,
+    int32_t count)
+{
+    int32_t i, end = row + count;
+    for (i = row; i < end; i ++) {
+        if (records[i]->row & EcsEntityObservedTarget) {
+            flecs_subsets_entity_moved(world, entities[i]);
+        }
+    }
+}
+
 static
 void flecs_dtor_all_components(
     ecs_world_t *world,
@@ -3204,6 +3548,10 @@ void flecs_dtor_all_components(
 
     (void)records;
 
+    if (update_entity_index && (world->flags & EcsWorldHasSubsets)) {
+        flecs_table_subsets_moved(world, records, entities, row, count);
+    }
+
     /* If table has components with destructors, iterate component columns */
     if (table->flags & EcsTableHasDtors) {
         /* Throw up a lock just to be sure */
@@ -3242,6 +3590,9 @@ void flecs_dtor_all_components(
                     ECS_INTERNAL_ERROR, NULL);
 
                 if (is_delete) {
+                    if (world->flags & EcsWorldHasSparse) {
+                        flecs_sparse_components_remove(world, e);
+                    }
                     flecs_entities_remove(world, e);
                     ecs_assert(ecs_is_valid(world, e) == false, 
                         ECS_INTERNAL_ERROR, NULL);
@@ -3269,6 +3620,9 @@ void flecs_dtor_all_components(
                 ecs_assert(!e || records[i]->table == table, 
                     ECS_INTERNAL_ERROR, NULL);
 
+                if (world->flags & EcsWorldHasSparse) {
+                    flecs_sparse_components_remove(world, e);
+                }
                 flecs_entities_remove(world, e);
                 ecs_assert(!ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
             } 
@@ -3426,6 +3780,10 @@ void flecs_table_free(
                 .kind = EcsQueryTableUnmatch,
                 .table = table
             });
+
+        if (world->flags & EcsWorldHasSubsets) {
+            flecs_subsets_table_deleted(world, table);
+        }
     }
 
     if (ecs_should_log_2()) {
@@ -3454,6 +3812,13 @@ void flecs_table_free(
     }
 
     flecs_wfree_n(world, int32_t, table->storage_count + 1, table->dirty_state);
+    if (table->dirty_blocks) {
+        int32_t i, column_count = table->storage_count;
+        for (i = 0; i < column_count; i ++) {
+            ecs_vec_fini_t(&world->allocator, &table->dirty_blocks[i], int32_t);
+        }
+        flecs_wfree_n(world, ecs_vec_t, column_count, table->dirty_blocks);
+    }
     flecs_wfree_n(world, int32_t, table->storage_count + table->type.count, 
         table->storage_map);
     flecs_table_records_unregister(world, table);
@@ -3559,10 +3924,88 @@ void flecs_table_mark_table_dirty(
     }
 }
 
+/* Make sure that dirty blocks exist for all rows of the table. Rows are marked
+ * dirty while iterating, possibly from multiple threads at the same time, so
+ * the blocks are created when rows are added instead. */
+static
+void flecs_table_grow_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    if (!dirty_blocks) {
+        return;
+    }
+
+    int32_t count = ecs_vec_count(&table->data.entities);
+    int32_t block_count = (count + ECS_DIRTY_BLOCK_SIZE - 1) / 
+        ECS_DIRTY_BLOCK_SIZE;
+
+    /* Blocks of all columns are grown together */
+    if (ecs_vec_count(&dirty_blocks[0]) >= block_count) {
+        return;
+    }
+
+    int32_t i, j, column_count = table->storage_count;
+    for (i = 0; i < column_count; i ++) {
+        ecs_vec_t *blocks = &dirty_blocks[i];
+        int32_t cur_count = ecs_vec_count(blocks);
+        ecs_vec_set_count_t(&world->allocator, blocks, int32_t, block_count);
+        int32_t *states = ecs_vec_first_t(blocks, int32_t);
+        for (j = cur_count; j < block_count; j ++) {
+            states[j] = 0;
+        }
+    }
+}
+
+void flecs_table_mark_column_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count)
+{
+    (void)world;
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ dirty_state[column + 1];
+
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    if (!dirty_blocks) {
+        return;
+    }
+
+    if (!count) {
+        row = 0;
+        count = ecs_table_count(table);
+        if (!count) {
+            return;
+        }
+    }
+
+    /* Store dirty state of column in blocks that contain the rows, so that
+     * queries can find which rows changed since they were last iterated. This
+     * can run on multiple threads, so it doesn't grow the blocks. */
+    ecs_vec_t *blocks = &dirty_blocks[column];
+    int32_t i;
+    int32_t first = row / ECS_DIRTY_BLOCK_SIZE;
+    int32_t last = (row + count - 1) / ECS_DIRTY_BLOCK_SIZE;
+    ecs_assert(last < ecs_vec_count(blocks), ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *states = ecs_vec_first_t(blocks, int32_t);
+    for (i = first; i <= last; i ++) {
+        states[i] = state;
+    }
+}
+
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3570,7 +4013,7 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_column_dirty(world, table, index, row, 1);
     }
 }
 
@@ -3734,9 +4177,12 @@ void* flecs_table_grow_column(
     ecs_assert(dst_size >= dst_count, ECS_INTERNAL_ERROR, NULL);
 
     /* If the array could possibly realloc and the component has a move action 
-     * defined, move old elements manually */
+     * defined, move old elements manually. Relocatable types can be moved with
+     * a memcpy, so they can use a regular realloc. */
     ecs_move_t move_ctor;
-    if (count && can_realloc && (move_ctor = ti->hooks.ctor_move_dtor)) {
+    if (count && can_realloc && (move_ctor = ti->hooks.ctor_move_dtor) &&
+        !(ti->hooks.flags & EcsTypeHookRelocatable))
+    {
         ecs_xtor_t ctor = ti->hooks.ctor;
         ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
         ecs_assert(move_ctor != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3851,6 +4297,7 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_grow_dirty_blocks(world, table);
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -3907,9 +4354,16 @@ int32_t flecs_table_append(
         &data->records, ecs_record_t*);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
     *r = record;
+
+    if ((world->flags & EcsWorldHasSubsets) && 
+        (record->row & EcsEntityObservedTarget)) 
+    {
+        flecs_subsets_entity_moved(world, entity);
+    }
  
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_grow_dirty_blocks(world, table);
     ecs_assert(count >= 0, ECS_INTERNAL_ERROR, NULL);
 
     ecs_type_info_t **type_info = table->type_info;
@@ -4511,8 +4965,11 @@ void flecs_merge_column(
         ecs_vec_set_count(&world->allocator, 
             dst, size, dst_count + src_count);
 
+        /* Relocatable values don't need to be constructed & moved */
+        bool relocate = ti && (ti->hooks.flags & EcsTypeHookRelocatable);
+
         /* Construct new values */
-        if (ti) {
+        if (ti && !relocate) {
             flecs_ctor_component(ti, dst, dst_count, src_count);
         }
         
@@ -4521,7 +4978,7 @@ void flecs_merge_column(
         
         /* Move values into column */
         ecs_move_t move = NULL;
-        if (ti) {
+        if (ti && !relocate) {
             move = ti->hooks.move;
         }
         if (move) {
@@ -4566,6 +5023,7 @@ void flecs_merge_table_data(
         ECS_SIZEOF(ecs_entity_t), NULL);
     ecs_assert(dst_data->entities.count == src_count + dst_count, 
         ECS_INTERNAL_ERROR, NULL);
+    ecs_entity_t *entities = dst_data->entities.array;
 
     /* Merge record pointers */
     flecs_merge_column(world, &dst_data->records, &src_data->records, 
@@ -4585,16 +5043,21 @@ void flecs_merge_table_data(
             i_new ++;
             i_old ++;
         } else if (dst_id < src_id) {
-            /* New column, make sure vector is large enough. */
+            /* New column, make sure vector is large enough. Only construct
+             * the merged values, existing values are already constructed. */
             ecs_vec_t *column = &dst[i_new];
+            ecs_vec_set_size(&world->allocator, column, size, 
+                dst_data->entities.size);
             ecs_vec_set_count(&world->allocator, column, size, src_count + dst_count);
-            flecs_ctor_component(dst_ti, column, 0, src_count + dst_count);
+            flecs_run_add_hooks(world, dst_table, dst_ti, column, 
+                &entities[dst_count], dst_id, dst_count, src_count, true);
             i_new ++;
         } else if (dst_id > src_id) {
             /* Old column does not occur in new table, destruct */
             ecs_vec_t *column = &src[i_old];
             ecs_type_info_t *ti = src_type_info[i_old];
-            flecs_dtor_component(ti, column, 0, src_count);
+            flecs_run_remove_hooks(world, src_table, ti, column, 
+                &entities[dst_count], src_id, 0, src_count, true);
             ecs_vec_fini(&world->allocator, column, ti->size);
             i_old ++;
         }
@@ -4609,20 +5072,25 @@ void flecs_merge_table_data(
         ecs_type_info_t *ti = dst_type_info[i_new];
         int32_t size = ti->size;        
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+        ecs_vec_set_size(&world->allocator, column, size, 
+            dst_data->entities.size);
         ecs_vec_set_count(&world->allocator, column, size, src_count + dst_count);
-        flecs_ctor_component(ti, column, 0, src_count + dst_count);
+        flecs_run_add_hooks(world, dst_table, ti, column, 
+            &entities[dst_count], dst_ids[i_new], dst_count, src_count, true);
     }
 
     /* Destruct remaining columns */
     for (; i_old < src_column_count; i_old ++) {
         ecs_vec_t *column = &src[i_old];
         ecs_type_info_t *ti = src_type_info[i_old];
-        flecs_dtor_component(ti, column, 0, src_count);
+        flecs_run_remove_hooks(world, src_table, ti, column, 
+            &entities[dst_count], src_ids[i_old], 0, src_count, true);
         ecs_vec_fini(&world->allocator, column, ti->size);
     }    
 
     /* Mark entity column as dirty */
     flecs_table_mark_table_dirty(world, dst_table, 0); 
+    flecs_table_grow_dirty_blocks(world, dst_table);
 }
 
 int32_t ecs_table_count(
@@ -4687,6 +5155,12 @@ void flecs_table_merge(
         uint32_t flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
         record->row = ECS_ROW_TO_RECORD(dst_count + i, flags);
         record->table = dst_table;
+
+        if ((flags & EcsEntityObservedTarget) && 
+            (world->flags & EcsWorldHasSubsets)) 
+        {
+            flecs_subsets_entity_moved(world, src_entities[i]);
+        }
     }
 
     /* Merge table columns */
@@ -4732,6 +5206,8 @@ void flecs_table_replace_data(
         flecs_table_init_data(world, table);
     }
 
+    flecs_table_grow_dirty_blocks(world, table);
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -4759,6 +5235,40 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+ecs_vec_t* flecs_table_get_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (!table->dirty_blocks) {
+        int32_t column_count = table->storage_count;
+        if (!column_count) {
+            return NULL;
+        }
+
+        int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+        int32_t i, j, count = ecs_table_count(table);
+        int32_t block_count = (count + ECS_DIRTY_BLOCK_SIZE - 1) / 
+            ECS_DIRTY_BLOCK_SIZE;
+
+        table->dirty_blocks = flecs_alloc_n(&world->allocator, 
+            ecs_vec_t, column_count);
+
+        /* Changes that happened before blocks were tracked are not known, so
+         * initialize existing blocks with the dirty state of the column */
+        for (i = 0; i < column_count; i ++) {
+            ecs_vec_t *blocks = &table->dirty_blocks[i];
+            ecs_vec_init_t(&world->allocator, blocks, int32_t, block_count);
+            ecs_vec_set_count_t(&world->allocator, blocks, int32_t, 
+                block_count);
+            int32_t *states = ecs_vec_first_t(blocks, int32_t);
+            for (j = 0; j < block_count; j ++) {
+                states[j] = dirty_state[i + 1];
+            }
+        }
+    }
+    return table->dirty_blocks;
+}
+
 void flecs_table_notify(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -5245,6 +5755,7 @@ const ecs_entity_t* flecs_bulk_new(
 typedef struct {
     ecs_type_info_t *ti;
     void *ptr;
+    bool is_sparse;
 } flecs_component_ptr_t;
 
 static
@@ -5458,6 +5969,9 @@ ecs_table_t* flecs_find_table_add(
     ecs_id_t id,
     ecs_table_diff_builder_t *diff)
 {
+    ecs_check(!flecs_id_is_sparse(world, id), ECS_UNSUPPORTED,
+        "sparse components can only be added with ecs_add/ecs_set");
+
     ecs_table_diff_t temp_diff = ECS_TABLE_DIFF_INIT;
     table = flecs_table_traverse_add(world, table, &id, &temp_diff);
     ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -5872,6 +6386,13 @@ void flecs_delete_entity(
     ecs_table_t *table = record->table;
     int32_t row = ECS_RECORD_TO_ROW(record->row);
 
+    if ((world->flags & EcsWorldHasSubsets) && 
+        (record->row & EcsEntityObservedTarget)) 
+    {
+        flecs_subsets_entity_moved(world, ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row)[0]);
+    }
+
     /* Invoke remove actions before deleting */
     flecs_notify_on_remove(world, table, NULL, row, 1, &diff->removed);
     flecs_table_delete(world, table, row, true);
@@ -6134,6 +6655,16 @@ void flecs_add_id(
     }
 
     ecs_record_t *r = flecs_entities_ensure(world, entity);
+
+    /* Sparse components are not stored in tables, so adding them doesn't
+     * move the entity */
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        flecs_sparse_component_ensure(world, idr, entity, true, NULL);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *src_table = r->table;
     ecs_table_t *dst_table = flecs_table_traverse_add(
@@ -6156,6 +6687,11 @@ void flecs_remove_id(
         return;
     }
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr && flecs_sparse_component_remove(world, idr, entity)) {
+        goto done;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *src_table = NULL;
     if (!r || !(src_table = r->table)) {
@@ -6187,6 +6723,14 @@ flecs_component_ptr_t flecs_get_mut(
     ecs_check((id & ECS_COMPONENT_MASK) == id || 
         ECS_HAS_ID_FLAG(id, PAIR), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        dst.ptr = flecs_sparse_component_ensure(world, idr, entity, true, NULL);
+        dst.ti = (ecs_type_info_t*)idr->type_info;
+        dst.is_sparse = true;
+        return dst;
+    }
+
     if (r->table) {
         dst = flecs_get_component_ptr(
             world, r->table, ECS_RECORD_TO_ROW(r->row), id);
@@ -6450,6 +6994,13 @@ ecs_entity_t ecs_new_w_id(
     ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(!id || ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
 
+    /* Sparse components are not part of the table, add them separately */
+    if (id && flecs_id_is_sparse(ecs_get_world(world), id)) {
+        ecs_entity_t entity = ecs_new_w_id(world, 0);
+        ecs_add_id(world, entity, id);
+        return entity;
+    }
+
     ecs_stage_t *stage = flecs_stage_from_world(&world);    
     ecs_entity_t entity = ecs_new_id(world);
 
@@ -7138,6 +7689,10 @@ void ecs_clear(
         return; /* Nothing to clear */
     }
 
+    if (world->flags & EcsWorldHasSparse) {
+        flecs_sparse_components_remove(world, entity);
+    }
+
     ecs_table_t *table = r->table;
     if (table) {
         ecs_table_diff_t diff = {
@@ -7623,6 +8178,10 @@ void ecs_delete(
     if (r) {
         flecs_journal_begin(world, EcsJournalDelete, entity, NULL, NULL);
 
+        if (world->flags & EcsWorldHasSparse) {
+            flecs_sparse_components_remove(world, entity);
+        }
+
         ecs_flags32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
         ecs_table_t *table;
         if (row_flags) {
@@ -7707,6 +8266,146 @@ error:
     return;
 }
 
+static
+void flecs_bulk_commit_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_id_t id,
+    bool remove)
+{
+    int32_t count = ecs_table_count(table);
+    if (!count) {
+        return;
+    }
+
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    ecs_table_t *dst_table;
+    if (remove) {
+        dst_table = flecs_table_traverse_remove(world, table, &id, &diff);
+    } else {
+        dst_table = flecs_table_traverse_add(world, table, &id, &diff);
+    }
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (dst_table == table) {
+        /* Table didn't change, but a union relationship could have */
+        flecs_notify_on_add(world, table, table, 0, count, &diff.added, 0);
+        return;
+    }
+
+    if (table->observed_count) {
+        flecs_update_component_monitors(world, &diff.added, &diff.removed);
+    }
+
+    if (diff.removed.count) {
+        flecs_notify_on_remove(world, table, dst_table, 0, count, 
+            &diff.removed);
+    }
+
+    if (!dst_table->type.count) {
+        /* All components were removed, entities no longer have a table */
+        flecs_table_clear_entities_silent(world, table);
+        return;
+    }
+
+    /* Move all entities in one go, and update their records */
+    int32_t dst_count = ecs_table_count(dst_table);
+    flecs_table_merge(world, dst_table, table, &dst_table->data, &table->data);
+    flecs_notify_on_add(world, dst_table, table, dst_count, count, 
+        &diff.added, 0);
+}
+
+static
+void flecs_bulk_commit(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id,
+    bool remove)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter->flags & EcsFilterMatchThis, ECS_INVALID_PARAMETER, 
+        "filter for bulk operation must match $this");
+
+    ecs_world_t *stage_world = world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    ecs_iter_t it = ecs_filter_iter(stage_world, filter);
+    ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+
+    /* If the world is deferred or the id is sparse, entities aren't moved in
+     * bulk. Fall back to regular (deferred) add/remove operations. */
+    bool deferred = flecs_defer_cmd(world, stage);
+    bool per_entity = deferred || flecs_id_is_sparse(world, id);
+
+    ecs_vec_t tables;
+    ecs_vec_init_t(&world->allocator, &tables, ecs_table_t*, 0);
+
+    while (ecs_filter_next(&it)) {
+        ecs_table_t *table = it.table;
+        if (!table || !it.count) {
+            continue;
+        }
+
+        /* If only part of the table is matched (for example because the
+         * filter has union or toggle terms), enqueue per entity commands. These
+         * are flushed after the tables have been moved. */
+        if (per_entity || it.offset || it.count != ecs_table_count(table)) {
+            int32_t i;
+            for (i = 0; i < it.count; i ++) {
+                if (remove) {
+                    ecs_remove_id(stage_world, it.entities[i], id);
+                } else {
+                    ecs_add_id(stage_world, it.entities[i], id);
+                }
+            }
+            continue;
+        }
+
+        /* Filters can return the same table multiple times for wildcards */
+        int32_t count = ecs_vec_count(&tables);
+        if (count && 
+            ecs_vec_get_t(&tables, ecs_table_t*, count - 1)[0] == table) 
+        {
+            continue;
+        }
+
+        ecs_vec_append_t(&world->allocator, &tables, ecs_table_t*)[0] = table;
+    }
+
+    /* Tables are collected before they're moved, so that the filter doesn't
+     * iterate tables it has already moved entities into. */
+    int32_t i, count = ecs_vec_count(&tables);
+    ecs_table_t **table_array = ecs_vec_first_t(&tables, ecs_table_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_bulk_commit_table(world, table_array[i], id, remove);
+    }
+
+    ecs_vec_fini_t(&world->allocator, &tables, ecs_table_t*);
+
+    if (!deferred) {
+        flecs_defer_end(world, stage);
+    }
+error:
+    return;
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    flecs_bulk_commit(world, filter, id, false);
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    flecs_bulk_commit(world, filter, id, true);
+}
+
 ecs_entity_t ecs_clone(
     ecs_world_t *world,
     ecs_entity_t dst,
@@ -7764,6 +8463,15 @@ const void* ecs_get_id(
 
     world = ecs_get_world(world);
 
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return NULL;
+    }
+
+    if ((idr->flags & EcsIdSparse) && idr->type_info) {
+        return flecs_sparse_component_get(idr, entity);
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     if (!r) {
         return NULL;
@@ -7774,11 +8482,6 @@ const void* ecs_get_id(
         return NULL;
     }
 
-    ecs_id_record_t *idr = flecs_id_record_get(world, id);
-    if (!idr) {
-        return NULL;
-    }
-
     const ecs_table_record_t *tr = NULL;
     ecs_table_t *storage_table = table->storage_table;
     if (storage_table) {
@@ -8039,9 +8742,17 @@ void* ecs_emplace_id(
     }
 
     ecs_record_t *r = flecs_entities_ensure(world, entity);
-    flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
 
-    void *ptr = flecs_get_component(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
+    void *ptr;
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        ptr = flecs_sparse_component_ensure(world, idr, entity, 
+            false /* Add without ctor */, NULL);
+    } else {
+        flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
+        ptr = flecs_get_component(
+            world, r->table, ECS_RECORD_TO_ROW(r->row), id);
+    }
     ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
 
     flecs_defer_end(world, stage);
@@ -8069,7 +8780,9 @@ void flecs_modified_id_if(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
-    if (!flecs_table_record_get(world, table, id)) {
+    if (!table || flecs_sparse_id_record_get(world, id) ||
+        !flecs_table_record_get(world, table, id)) 
+    {
         flecs_defer_end(world, stage);
         return;
     }
@@ -8077,7 +8790,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8104,12 +8817,22 @@ void ecs_modified_id(
      * operations are being deferred. */
     ecs_check(ecs_has_id(world, entity, id), ECS_INVALID_PARAMETER, NULL);
 
+    /* Sparse components have no change tracking or OnSet observers, so only
+     * the on_set hook is invoked */
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr) {
+        flecs_sparse_component_on_set(world, idr, entity, 
+            flecs_sparse_component_get(idr, entity));
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8146,13 +8869,18 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    if (!dst.is_sparse) {
+        flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
-    ecs_table_t *table = r->table;
-    if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
-        ecs_type_t ids = { .array = &id, .count = 1 };
-        flecs_notify_on_set(
-            world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        ecs_table_t *table = r->table;
+        if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
+            ecs_type_t ids = { .array = &id, .count = 1 };
+            flecs_notify_on_set(
+                world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        }
+    } else {
+        flecs_sparse_component_on_set(world, 
+            flecs_id_record_get(world, id), entity, dst.ptr);
     }
 
     flecs_defer_end(world, stage);
@@ -8194,15 +8922,20 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    if (!dst.is_sparse) {
+        flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
-    if (cmd_kind == EcsOpSet) {
-        ecs_table_t *table = r->table;
-        if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
-            ecs_type_t ids = { .array = &id, .count = 1 };
-            flecs_notify_on_set(
-                world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        if (cmd_kind == EcsOpSet) {
+            ecs_table_t *table = r->table;
+            if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
+                ecs_type_t ids = { .array = &id, .count = 1 };
+                flecs_notify_on_set(
+                    world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+            }
         }
+    } else if (cmd_kind == EcsOpSet) {
+        flecs_sparse_component_on_set(world, 
+            flecs_id_record_get(world, id), entity, dst.ptr);
     }
 
     flecs_defer_end(world, stage);
@@ -8333,6 +9066,11 @@ bool ecs_has_id(
     /* Make sure we're not working with a stage */
     world = ecs_get_world(world);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr) {
+        return flecs_sparse_component_get(idr, entity) != NULL;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table;
     if (!r || !(table = r->table)) {
@@ -9196,10 +9934,236 @@ bool flecs_remove_invalid(
     return true;
 }
 
+/* Entities with the same table transition that are moved together */
+typedef struct ecs_cmd_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    ecs_table_diff_builder_t diff;
+    ecs_vec_t entities;          /* vec<ecs_entity_t> */
+} ecs_cmd_group_t;
+
+/* Move entities in group to the destination table. Because entities are
+ * appended to the destination table in order, they end up in a contiguous
+ * range, which is used to notify observers with a single event. */
+static
+void flecs_cmd_group_flush(
+    ecs_world_t *world,
+    ecs_cmd_group_t *group)
+{
+    int32_t i, count = ecs_vec_count(&group->entities);
+    if (!count) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&group->entities);
+    ecs_table_t *src_table = group->src, *dst_table = group->dst;
+    ecs_table_diff_t diff;
+    flecs_table_diff_build_noalloc(&group->diff, &diff);
+
+    flecs_defer_begin(world, &world->stages[0]);
+
+    if (count == 1) {
+        ecs_record_t *r = flecs_entities_get(world, entities[0]);
+        flecs_commit(world, entities[0], r, dst_table, &diff, true, 0);
+    } else {
+        int32_t first_row = 0;
+        bool monitored = false;
+
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = entities[i];
+            ecs_record_t *r = flecs_entities_get(world, e);
+            ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+            ecs_assert(r->table == src_table, ECS_INTERNAL_ERROR, NULL);
+            flecs_journal_begin(world, EcsJournalMove, e, 
+                &diff.added, &diff.removed);
+
+            uint32_t row_flags = r->row & ECS_ROW_FLAGS_MASK;
+            int observed = (row_flags & EcsEntityObservedAcyclic) != 0;
+            flecs_table_observer_add(dst_table, observed);
+
+            int32_t dst_row;
+            if (src_table) {
+                int32_t src_row = ECS_RECORD_TO_ROW(r->row);
+                dst_row = flecs_table_append(
+                    world, dst_table, e, r, false, false);
+                flecs_table_move(world, e, e, dst_table, dst_row, 
+                    src_table, src_row, true);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row, row_flags);
+                flecs_table_delete(world, src_table, src_row, false);
+                flecs_table_observer_add(src_table, -observed);
+            } else {
+                dst_row = flecs_table_append(
+                    world, dst_table, e, r, true, true);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row, row_flags);
+            }
+
+            if (!i) {
+                first_row = dst_row;
+            }
+
+            ecs_assert(dst_row == (first_row + i), ECS_INTERNAL_ERROR, NULL);
+            monitored |= row_flags != 0;
+            flecs_journal_end();
+        }
+
+        flecs_notify_on_add(world, dst_table, src_table, first_row, count, 
+            &diff.added, 0);
+
+        if (monitored) {
+            flecs_update_component_monitors(world, &diff.added, &diff.removed);
+        }
+
+        world->info.cmd.batched_group_count ++;
+    }
+
+    flecs_defer_end(world, &world->stages[0]);
+    ecs_vec_clear(&group->entities);
+}
+
+/* Add entity to group if it has the same table transition as the entities
+ * already in the group. Only transitions that add ids are grouped. */
+static
+bool flecs_cmd_group_add(
+    ecs_world_t *world,
+    ecs_cmd_group_t *group,
+    ecs_entity_t entity,
+    ecs_record_t *r,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff)
+{
+    if (!r || !dst_table || !dst_table->type.count || diff->removed.count) {
+        return false;
+    }
+
+    ecs_table_t *src_table = r->table;
+    if (src_table == dst_table) {
+        return false;
+    }
+
+    if (!src_table && world->range_check_enabled) {
+        return false;
+    }
+
+    if (ecs_vec_count(&group->entities)) {
+        if (group->src != src_table || group->dst != dst_table ||
+            group->diff.added.count != diff->added.count ||
+            ecs_os_memcmp(group->diff.added.array, diff->added.array, 
+                ECS_SIZEOF(ecs_id_t) * diff->added.count))
+        {
+            flecs_cmd_group_flush(world, group);
+        }
+    }
+
+    if (!ecs_vec_count(&group->entities)) {
+        group->src = src_table;
+        group->dst = dst_table;
+        flecs_table_diff_builder_clear(&group->diff);
+        flecs_table_diff_build_append_table(world, &group->diff, diff);
+    }
+
+    ecs_vec_append_t(&world->allocator, &group->entities, ecs_entity_t)[0] = 
+        entity;
+    return true;
+}
+
+/* Test if emplaced component can be added together with the other components
+ * of a batch. Emplaced components are added without invoking the constructor,
+ * which is only possible in a batched move if there is no constructor. */
+static
+bool flecs_cmd_emplace_can_batch(
+    ecs_world_t *world,
+    ecs_cmd_t *cmd,
+    ecs_table_t *table)
+{
+    ecs_id_record_t *idr = cmd->idr;
+    if (!idr) {
+        idr = flecs_id_record_get(world, cmd->id);
+    }
+    if (!idr || (idr->flags & EcsIdSparse)) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (!ti || ti->hooks.ctor) {
+        return false;
+    }
+
+    /* If entity already has the component use regular path, which reports
+     * an error */
+    if (table && flecs_id_record_get_table(idr, table)) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Move emplaced values into the components that were added by the batch. The
+ * value is moved directly from the command queue into the table column. */
+static
+void flecs_cmd_batch_emplace(
+    ecs_world_t *world,
+    ecs_record_t *r,
+    ecs_table_t *src_table,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    ecs_table_t *table = r->table;
+    if (!table || !table->storage_table) {
+        return;
+    }
+
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    int32_t cur = start, next_for_entity;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+
+        if (cmd->kind != EcsOpEmplace) {
+            continue;
+        }
+
+        if (!flecs_cmd_emplace_can_batch(world, cmd, src_table)) {
+            continue;
+        }
+
+        /* If the component was removed again by the batch, the emplace is
+         * processed as a regular command which adds it back */
+        const ecs_table_record_t *tr = flecs_table_record_get(
+            world, table->storage_table, cmd->id);
+        if (!tr) {
+            continue;
+        }
+
+        flecs_component_ptr_t dst = flecs_get_component_w_index(
+            table, tr->column, row);
+        const ecs_type_info_t *ti = dst.ti;
+        ecs_move_t move_ctor = ti->hooks.move_ctor;
+        if (move_ctor) {
+            move_ctor(dst.ptr, cmd->is._1.value, 1, ti);
+        } else {
+            ecs_os_memcpy(dst.ptr, cmd->is._1.value, ti->size);
+        }
+
+        flecs_table_mark_dirty(world, table, cmd->id, row);
+        flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
+
+        /* Clear value so that skipped command doesn't destruct it again */
+        cmd->is._1.value = NULL;
+        cmd->kind = EcsOpSkip;
+        world->info.cmd.get_mut_count ++;
+    } while ((cur = next_for_entity));
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
     ecs_table_diff_builder_t *diff,
+    ecs_cmd_group_t *group,
     ecs_entity_t entity,
     ecs_cmd_t *cmds,
     int32_t start)
@@ -9210,6 +10174,8 @@ void flecs_cmd_batch_for_entity(
         table = r->table;
     }
 
+    ecs_table_t *src_table = table;
+
     world->info.cmd.batched_entity_count ++;
 
     ecs_cmd_t *cmd;
@@ -9218,6 +10184,8 @@ void flecs_cmd_batch_for_entity(
     int32_t cur = start;
     ecs_id_t id;
     bool has_set = false;
+    bool has_emplace = false;
+    bool add_only = true;
 
     do {
         cmd = &cmds[cur];
@@ -9241,13 +10209,25 @@ void flecs_cmd_batch_for_entity(
             } else {
                 /* Id was no longer valid and had a Delete policy */
                 cmd->kind = EcsOpSkip;
+                flecs_cmd_group_flush(world, group);
                 ecs_delete(world, entity);
                 flecs_table_diff_builder_clear(diff);
                 return;
             }
         }
 
+        /* Sparse components don't change the table of the entity, so they
+         * are not batched. The command is executed as a regular command. */
+        if (id && flecs_id_is_sparse(world, id)) {
+            add_only = false;
+            continue;
+        }
+
         ecs_cmd_kind_t kind = cmd->kind;
+        if (kind != EcsOpAdd) {
+            add_only = false;
+        }
+
         switch(kind) {
         case EcsOpAdd:
             table = flecs_find_table_add(world, table, id, diff);
@@ -9260,8 +10240,13 @@ void flecs_cmd_batch_for_entity(
             has_set = true;
             break;
         case EcsOpEmplace:
-            /* Don't add for emplace, as this requires a special call to ensure
-             * the constructor is not invoked for the component */
+            /* Only add for emplace if the component has no constructor, as
+             * the constructor must not be invoked for the component. */
+            if (flecs_cmd_emplace_can_batch(world, cmd, src_table)) {
+                table = flecs_find_table_add(world, table, id, diff);
+                world->info.cmd.batched_command_count ++;
+                has_emplace = true;
+            }
             break;
         case EcsOpRemove:
             table = flecs_find_table_remove(world, table, id, diff);
@@ -9269,6 +10254,9 @@ void flecs_cmd_batch_for_entity(
             break;
         case EcsOpClear:
             table = NULL;
+            if (world->flags & EcsWorldHasSparse) {
+                flecs_sparse_components_remove(world, entity);
+            }
             world->info.cmd.batched_command_count ++;
             break;
         default:
@@ -9284,8 +10272,22 @@ void flecs_cmd_batch_for_entity(
 
     /* Move entity to destination table in single operation */
     flecs_table_diff_build_noalloc(diff, &table_diff);
+
+    /* If entity only has add commands, try to move it together with other
+     * entities that have the same table transition */
+    if (add_only && flecs_cmd_group_add(
+        world, group, entity, r, table, &table_diff)) 
+    {
+        flecs_table_diff_builder_clear(diff);
+        return;
+    }
+
+    flecs_cmd_group_flush(world, group);
     flecs_defer_begin(world, &world->stages[0]);
     flecs_commit(world, entity, r, table, &table_diff, true, 0);
+    if (has_emplace) {
+        flecs_cmd_batch_emplace(world, r, src_table, cmds, start);
+    }
     flecs_defer_end(world, &world->stages[0]);
     flecs_table_diff_builder_clear(diff);
 
@@ -9308,6 +10310,10 @@ void flecs_cmd_batch_for_entity(
                     idr = flecs_id_record_get(world, cmd->id);
                 }
 
+                if (idr->flags & EcsIdSparse) {
+                    break;
+                }
+
                 if (!flecs_id_record_get_table(idr, table)) {
                     /* Component was deleted */
                     cmd->kind = EcsOpSkip;
@@ -9323,6 +10329,465 @@ void flecs_cmd_batch_for_entity(
     }
 }
 
+/* Minimum number of values written by a single merge job. Values for the same
+ * table are never split up between jobs. */
+#ifndef FLECS_MERGE_JOB_MIN_COUNT
+#define FLECS_MERGE_JOB_MIN_COUNT (256)
+#endif
+
+typedef struct ecs_merge_job_t {
+    ecs_merge_write_t *writes;
+    int32_t *bounds;             /* End of each job in writes array */
+    int32_t job_count;
+    int32_t next;                /* Number of claimed jobs */
+} ecs_merge_job_t;
+
+/* Test if a set command can be written to storage after the structural changes
+ * of the merge have been applied. This is only the case if writing the value
+ * has no side effects besides invoking the move hook. If the entity doesn't
+ * have the component yet, it is added here when the move to the new table runs
+ * no hooks or observers, so the value write can still be deferred.
+ *
+ * Commands that stay serial (flush the pending writes before they run):
+ * - commands other than set/mut, as they can run code that reads values
+ * - sets to sparse components, or components with an on_set hook
+ * - sets to tables with OnSet observers
+ * - sets that add a component to a table with add actions (ctors, on_add 
+ *   hooks, OnAdd/OnSet observers, IsA, union relationships)
+ * - sets to entities that are not stored in a table yet */
+static
+bool flecs_merge_write_defer(
+    ecs_world_t *world,
+    ecs_cmd_t *cmd)
+{
+    ecs_cmd_kind_t kind = cmd->kind;
+    if (kind != EcsOpSet && kind != EcsOpMut) {
+        return false;
+    }
+
+    ecs_id_record_t *idr = cmd->idr;
+    if (!idr) {
+        idr = flecs_id_record_get(world, cmd->id);
+    }
+    if (!idr || (idr->flags & EcsIdSparse)) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (!ti || ti->hooks.on_set) {
+        return false;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, cmd->entity);
+    ecs_table_t *table = r ? r->table : NULL;
+    if (!table) {
+        return false;
+    }
+
+    if (!table->storage_table || 
+        !flecs_id_record_get_table(idr, table->storage_table)) 
+    {
+        /* Entity doesn't have the component yet. Nothing can observe the
+         * values of pending writes while adding it if the destination table
+         * has no add actions, otherwise use the regular path. */
+        ecs_id_t id = cmd->id;
+        ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+        ecs_table_t *dst = flecs_table_traverse_add(world, table, &id, &diff);
+        if (dst == table || (dst->flags & EcsTableHasAddActions) ||
+            !dst->storage_table || 
+            !flecs_id_record_get_table(idr, dst->storage_table))
+        {
+            return false;
+        }
+
+        flecs_commit(world, cmd->entity, r, dst, &diff, true, 0);
+    } else if ((kind == EcsOpSet) && (table->flags & EcsTableHasOnSet)) {
+        return false;
+    }
+
+    ecs_merge_write_t *w = ecs_vec_append_t(
+        &world->allocator, &world->merge_writes, ecs_merge_write_t);
+    w->entity = cmd->entity;
+    w->id = cmd->id;
+    w->value = cmd->is._1.value;
+    w->size = cmd->is._1.size;
+    return true;
+}
+
+static
+int flecs_merge_write_compare(
+    const void *ptr_a,
+    const void *ptr_b)
+{
+    const ecs_merge_write_t *a = ptr_a;
+    const ecs_merge_write_t *b = ptr_b;
+    if (a->table != b->table) {
+        uint64_t id_a = a->table->id, id_b = b->table->id;
+        return (id_a > id_b) - (id_a < id_b);
+    }
+    return (a->order > b->order) - (a->order < b->order);
+}
+
+static
+void flecs_merge_writes_apply(
+    ecs_merge_write_t *writes,
+    int32_t count)
+{
+    int32_t i, j;
+    for (i = 0; i < count; i += j) {
+        ecs_merge_write_t *w = &writes[i];
+        ecs_table_t *table = w->table;
+        const ecs_type_info_t *ti = table->type_info[w->column];
+        ecs_size_t size = ti->size;
+        void *dst = ecs_vec_get(
+            &table->data.columns[w->column], size, w->row);
+        ecs_move_t move = ti->hooks.move;
+        if (move) {
+            move(dst, w->value, 1, ti);
+            flecs_stack_free(w->value, w->size);
+            j = 1;
+            continue;
+        }
+
+        /* Values that were set for consecutive rows in a loop are usually
+         * also stored consecutively in the queue, in which case they can be
+         * copied with a single memcpy */
+        for (j = 1; (i + j) < count; j ++) {
+            ecs_merge_write_t *next = &writes[i + j];
+            if (next->table != table || next->column != w->column ||
+                next->row != (w->row + j) || 
+                next->value != ECS_OFFSET(w->value, size * j))
+            {
+                break;
+            }
+        }
+
+        ecs_os_memcpy(dst, w->value, size * j);
+
+        int32_t k;
+        for (k = 0; k < j; k ++) {
+            flecs_stack_free(writes[i + k].value, writes[i + k].size);
+        }
+    }
+}
+
+static
+void flecs_merge_job(
+    ecs_world_t *world,
+    void *ctx)
+{
+    (void)world;
+    ecs_merge_job_t *job = ctx;
+    int32_t i;
+    while ((i = ecs_os_ainc(&job->next) - 1) < job->job_count) {
+        int32_t start = i ? job->bounds[i - 1] : 0;
+        flecs_merge_writes_apply(&job->writes[start], job->bounds[i] - start);
+    }
+}
+
+/* Write values of deferred set commands to storage. When worker threads are
+ * available, values for different tables are written in parallel. */
+static
+void flecs_merge_writes_flush(
+    ecs_world_t *world)
+{
+    int32_t i, count = ecs_vec_count(&world->merge_writes);
+    if (!count) {
+        return;
+    }
+
+    /* Find where values should be written. Entities may have moved to another
+     * table since the command was added. */
+    ecs_merge_write_t *writes = ecs_vec_first(&world->merge_writes);
+    ecs_table_t *first_table = NULL;
+    bool single_table = true;
+    int32_t write_count = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_merge_write_t *w = &writes[i];
+        ecs_record_t *r = flecs_entities_get(world, w->entity);
+        ecs_table_t *table = r ? r->table : NULL;
+        const ecs_table_record_t *tr = NULL;
+        if (table && table->storage_table) {
+            tr = flecs_table_record_get(world, table->storage_table, w->id);
+        }
+
+        if (!tr) {
+            /* Entity was deleted or component was removed */
+            flecs_dtor_value(world, w->id, w->value, 1);
+            flecs_stack_free(w->value, w->size);
+            world->info.cmd.discard_count ++;
+            continue;
+        }
+
+        if (!first_table) {
+            first_table = table;
+        } else if (first_table != table) {
+            single_table = false;
+        }
+
+        /* Mark dirty here, before the writes are divided between threads */
+        int32_t row = ECS_RECORD_TO_ROW(r->row);
+        flecs_table_mark_column_dirty(world, table, tr->column, row, 1);
+
+        ecs_merge_write_t *dst = &writes[write_count];
+        *dst = *w;
+        dst->table = table;
+        dst->row = row;
+        dst->column = tr->column;
+        dst->order = write_count;
+        write_count ++;
+    }
+
+    ecs_merge_run_action_t run = world->merge_run;
+    if (!run || single_table || (write_count < FLECS_MERGE_JOB_MIN_COUNT * 2)) {
+        flecs_merge_writes_apply(writes, write_count);
+        ecs_vec_clear(&world->merge_writes);
+        return;
+    }
+
+    /* Group values by table while preserving queue order within a table, so
+     * that the last value for a component is the one that remains */
+    qsort(writes, flecs_itosize(write_count), ECS_SIZEOF(ecs_merge_write_t), 
+        flecs_merge_write_compare);
+
+    int32_t max_jobs = write_count / FLECS_MERGE_JOB_MIN_COUNT + 1;
+    int32_t *bounds = flecs_walloc_n(world, int32_t, max_jobs);
+    int32_t job_count = 0, start = 0;
+    for (i = 1; i < write_count; i ++) {
+        if ((writes[i].table != writes[i - 1].table) && 
+            ((i - start) >= FLECS_MERGE_JOB_MIN_COUNT)) 
+        {
+            bounds[job_count ++] = i;
+            start = i;
+        }
+    }
+    bounds[job_count ++] = write_count;
+
+    ecs_merge_job_t job = {
+        .writes = writes,
+        .bounds = bounds,
+        .job_count = job_count
+    };
+
+    if (job_count == 1) {
+        flecs_merge_writes_apply(writes, write_count);
+    } else {
+        run(world, flecs_merge_job, &job);
+    }
+
+    flecs_wfree_n(world, int32_t, max_jobs, bounds);
+    ecs_vec_clear(&world->merge_writes);
+}
+
+/* Take command queue from stage, so that commands that are added to the stage
+ * while the queue is flushed are stored in a new queue. */
+static
+void flecs_defer_take(
+    ecs_stage_t *stage,
+    ecs_vec_t *commands,
+    ecs_stack_t *stack)
+{
+    *commands = stage->commands;
+    stage->commands.array = NULL;
+    stage->commands.count = 0;
+    stage->commands.size = 0;
+    ecs_vec_init_t(NULL, &stage->commands, ecs_cmd_t, 0);
+
+    *stack = stage->defer_stack;
+    flecs_stack_init(&stage->defer_stack);
+    flecs_sparse_clear(&stage->cmd_entries);
+}
+
+/* Restore flushed command queue, so its storage is reused */
+static
+void flecs_defer_restore(
+    ecs_stage_t *stage,
+    ecs_vec_t *commands,
+    ecs_stack_t *stack)
+{
+    ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
+
+    /* Restore defer queue */
+    ecs_vec_clear(commands);
+    stage->commands = *commands;
+
+    /* Restore stack */
+    flecs_stack_fini(&stage->defer_stack);
+    stage->defer_stack = *stack;
+    flecs_stack_reset(&stage->defer_stack);
+}
+
+/* Run range of commands from a queue that was taken from a stage */
+static
+void flecs_defer_flush(
+    ecs_world_t *world,
+    ecs_stage_t *dst_stage,
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count,
+    bool merge_to_world)
+{
+    /* Values that are written after structural changes. Values left by a 
+     * merge that is still in progress are written first, so that they don't
+     * overwrite values set by commands in this queue. */
+    bool merge_writes = merge_to_world && 
+        (world->flags & EcsWorldParallelMerge);
+    if (merge_writes) {
+        flecs_merge_writes_flush(world);
+    }
+
+    ecs_table_diff_builder_t diff;
+    flecs_table_diff_builder_init(world, &diff);
+
+    ecs_cmd_group_t group = {0};
+    flecs_table_diff_builder_init(world, &group.diff);
+    ecs_vec_init_t(&world->allocator, &group.entities, ecs_entity_t, 0);
+
+    int32_t i, last = first + count;
+    for (i = first; i < last; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_entity_t e = cmd->entity;
+        bool is_alive = flecs_entities_is_valid(world, e);
+
+        /* A negative index indicates the first command for an entity */
+        if (merge_to_world && (cmd->next_for_entity < 0)) {
+            /* Batch commands for entity to limit archetype moves */
+            if (is_alive) {
+                flecs_cmd_batch_for_entity(
+                    world, &diff, &group, e, cmds, i);
+            } else {
+                world->info.cmd.discard_count ++;
+            }
+
+        /* An add command that is the only command for an entity can be
+         * moved together with other entities that get the same id */
+        } else if (merge_to_world && is_alive && e && 
+            (cmd->kind == EcsOpAdd) && !cmd->next_for_entity) 
+        {
+            flecs_cmd_batch_for_entity(
+                world, &diff, &group, e, cmds, i);
+        }
+
+        /* If entity is no longer alive, this could be because the queue
+         * contained both a delete and a subsequent add/remove/set which
+         * should be ignored. */
+        ecs_cmd_kind_t kind = cmd->kind;
+        if ((kind == EcsOpSkip) || (e && !is_alive)) {
+            world->info.cmd.discard_count ++;
+            flecs_discard_cmd(world, cmd);
+            continue;
+        }
+
+        if (merge_writes) {
+            if (flecs_merge_write_defer(world, cmd)) {
+                if (kind == EcsOpSet) {
+                    world->info.cmd.set_count ++;
+                } else {
+                    world->info.cmd.get_mut_count ++;
+                }
+                continue;
+            }
+
+            /* Command may depend on values of earlier commands */
+            flecs_merge_writes_flush(world);
+        }
+
+        /* Command may depend on entities that haven't been moved yet */
+        flecs_cmd_group_flush(world, &group);
+
+        ecs_id_t id = cmd->id;
+
+        switch(kind) {
+        case EcsOpAdd:
+            ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (flecs_remove_invalid(world, id, &id)) {
+                if (id) {
+                    world->info.cmd.add_count ++;
+                    flecs_add_id(world, e, id);
+                } else {
+                    world->info.cmd.discard_count ++;
+                }
+            } else {
+                world->info.cmd.discard_count ++;
+                ecs_delete(world, e);
+            }
+            break;
+        case EcsOpRemove:
+            flecs_remove_id(world, e, id);
+            world->info.cmd.remove_count ++;
+            break;
+        case EcsOpClone:
+            ecs_clone(world, e, id, cmd->is._1.clone_value);
+            break;
+        case EcsOpSet:
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.set_count ++;
+            break;
+        case EcsOpEmplace:
+            if (merge_to_world) {
+                ecs_emplace_id(world, e, id);
+            }
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.get_mut_count ++;
+            break;
+        case EcsOpMut:
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.get_mut_count ++;
+            break;
+        case EcsOpModified:
+            flecs_modified_id_if(world, e, id);
+            world->info.cmd.modified_count ++;
+            break;
+        case EcsOpDelete: {
+            ecs_delete(world, e);
+            world->info.cmd.delete_count ++;
+            break;
+        }
+        case EcsOpClear:
+            ecs_clear(world, e);
+            world->info.cmd.clear_count ++;
+            break;
+        case EcsOpOnDeleteAction:
+            flecs_on_delete(world, id, e);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpEnable:
+            ecs_enable_id(world, e, id, true);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpDisable:
+            ecs_enable_id(world, e, id, false);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpBulkNew:
+            flecs_flush_bulk_new(world, cmd);
+            world->info.cmd.other_count ++;
+            continue;
+        case EcsOpSkip:
+            break;
+        }
+
+        if (cmd->is._1.value) {
+            flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
+        }
+    }
+
+    if (merge_writes) {
+        flecs_merge_writes_flush(world);
+    }
+
+    flecs_cmd_group_flush(world, &group);
+    ecs_vec_fini_t(&world->allocator, &group.entities, ecs_entity_t);
+    flecs_table_diff_builder_fini(world, &group.diff);
+    flecs_table_diff_builder_fini(world, &diff);
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_end(
     ecs_world_t *world,
@@ -9347,148 +10812,82 @@ bool flecs_defer_end(
 
         ecs_stage_t *dst_stage = flecs_stage_from_world(&world);
         if (ecs_vec_count(&stage->commands)) {
-            ecs_vec_t commands = stage->commands;
-            stage->commands.array = NULL;
-            stage->commands.count = 0;
-            stage->commands.size = 0;
-
-            ecs_cmd_t *cmds = ecs_vec_first(&commands);
-            int32_t i, count = ecs_vec_count(&commands);
-            ecs_vec_init_t(NULL, &stage->commands, ecs_cmd_t, 0);
-
-            ecs_stack_t stack = stage->defer_stack;
-            flecs_stack_init(&stage->defer_stack);
-
-            ecs_table_diff_builder_t diff;
-            flecs_table_diff_builder_init(world, &diff);
-            flecs_sparse_clear(&stage->cmd_entries);
-
-            for (i = 0; i < count; i ++) {
-                ecs_cmd_t *cmd = &cmds[i];
-                ecs_entity_t e = cmd->entity;
-                bool is_alive = flecs_entities_is_valid(world, e);
-
-                /* A negative index indicates the first command for an entity */
-                if (merge_to_world && (cmd->next_for_entity < 0)) {
-                    /* Batch commands for entity to limit archetype moves */
-                    if (is_alive) {
-                        flecs_cmd_batch_for_entity(world, &diff, e, cmds, i);
-                    } else {
-                        world->info.cmd.discard_count ++;
-                    }
-                }
-
-                /* If entity is no longer alive, this could be because the queue
-                 * contained both a delete and a subsequent add/remove/set which
-                 * should be ignored. */
-                ecs_cmd_kind_t kind = cmd->kind;
-                if ((kind == EcsOpSkip) || (e && !is_alive)) {
-                    world->info.cmd.discard_count ++;
-                    flecs_discard_cmd(world, cmd);
-                    continue;
-                }
+            ecs_vec_t commands;
+            ecs_stack_t stack;
+            flecs_defer_take(stage, &commands, &stack);
+            flecs_defer_flush(world, dst_stage, ecs_vec_first(&commands), 0,
+                ecs_vec_count(&commands), merge_to_world);
+            flecs_defer_restore(stage, &commands, &stack);
+        }
 
-                ecs_id_t id = cmd->id;
+        return true;
+    }
 
-                switch(kind) {
-                case EcsOpAdd:
-                    ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
-                    if (flecs_remove_invalid(world, id, &id)) {
-                        if (id) {
-                            world->info.cmd.add_count ++;
-                            flecs_add_id(world, e, id);
-                        } else {
-                            world->info.cmd.discard_count ++;
-                        }
-                    } else {
-                        world->info.cmd.discard_count ++;
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    flecs_remove_id(world, e, id);
-                    world->info.cmd.remove_count ++;
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, id, cmd->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.set_count ++;
-                    break;
-                case EcsOpEmplace:
-                    if (merge_to_world) {
-                        ecs_emplace_id(world, e, id);
-                    }
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.get_mut_count ++;
-                    break;
-                case EcsOpMut:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.get_mut_count ++;
-                    break;
-                case EcsOpModified:
-                    flecs_modified_id_if(world, e, id);
-                    world->info.cmd.modified_count ++;
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    world->info.cmd.delete_count ++;
-                    break;
-                }
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    world->info.cmd.clear_count ++;
-                    break;
-                case EcsOpOnDeleteAction:
-                    flecs_on_delete(world, id, e);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpEnable:
-                    ecs_enable_id(world, e, id, true);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_id(world, e, id, false);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpBulkNew:
-                    flecs_flush_bulk_new(world, cmd);
-                    world->info.cmd.other_count ++;
-                    continue;
-                case EcsOpSkip:
-                    break;
-                }
+    return false;
+}
 
-                if (cmd->is._1.value) {
-                    flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
-                }
-            }
+/* Make sure that batching doesn't follow the commands of an entity past the
+ * end of a range. Commands of a later range may only run after the commands
+ * of other stages that are ordered before them. */
+static
+void flecs_cmd_range_cut(
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count)
+{
+    int32_t i, last = first + count;
+    for (i = first; i < last; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        int32_t next = cmd->next_for_entity;
+        if (next < 0) {
+            next *= -1;
+        }
+        if (next >= last) {
+            cmd->next_for_entity = 0;
+        }
+    }
+}
 
-            ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
+/* Leave safe section for all stages, and run the deferred commands of the
+ * stages in the order of the provided ranges. Ranges of commands must have 
+ * been separated with flecs_stage_cmd_cut, and together must cover all 
+ * commands of all stages. */
+void flecs_defer_end_ordered(
+    ecs_world_t *world,
+    const ecs_cmd_range_t *ranges,
+    int32_t range_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
 
-            /* Restore defer queue */
-            ecs_vec_clear(&commands);
-            stage->commands = commands;
+    int32_t i, stage_count = world->stage_count;
+    ecs_vec_t *commands = flecs_walloc_n(world, ecs_vec_t, stage_count);
+    ecs_stack_t *stacks = flecs_walloc_n(world, ecs_stack_t, stage_count);
 
-            /* Restore stack */
-            flecs_stack_fini(&stage->defer_stack);
-            stage->defer_stack = stack;
-            flecs_stack_reset(&stage->defer_stack);
+    for (i = 0; i < stage_count; i ++) {
+        ecs_stage_t *stage = &world->stages[i];
+        ecs_assert(stage->defer == 1, ECS_INVALID_OPERATION, 
+            "mismatching defer_begin/defer_end detected");
+        stage->defer --;
+        flecs_defer_take(stage, &commands[i], &stacks[i]);
+    }
 
-            flecs_table_diff_builder_fini(world, &diff);
-        }
+    for (i = 0; i < range_count; i ++) {
+        const ecs_cmd_range_t *range = &ranges[i];
+        ecs_vec_t *stage_commands = &commands[range->stage];
+        ecs_assert(range->first + range->count <= 
+            ecs_vec_count(stage_commands), ECS_INTERNAL_ERROR, NULL);
+        ecs_cmd_t *cmds = ecs_vec_first(stage_commands);
+        flecs_cmd_range_cut(cmds, range->first, range->count);
+        flecs_defer_flush(world, &world->stages[0], 
+            cmds, range->first, range->count, true);
+    }
 
-        return true;
+    for (i = 0; i < stage_count; i ++) {
+        flecs_defer_restore(&world->stages[i], &commands[i], &stacks[i]);
     }
 
-    return false;
+    flecs_wfree_n(world, ecs_stack_t, stage_count, stacks);
+    flecs_wfree_n(world, ecs_vec_t, stage_count, commands);
 }
 
 /* Delete operations from queue without executing them. */
@@ -9609,6 +11008,10 @@ void flecs_stages_merge(
                 "mismatching defer_begin/defer_end detected");
             flecs_defer_end(world, stage);
         }
+    } else if (world->merge_order) {
+        /* Merge commands of all stages in the order provided by the caller */
+        flecs_defer_end_ordered(world, world->merge_order, 
+            world->merge_order_count);
     } else {
         /* Merge stages. Only merge if the stage has auto_merging turned on, or 
          * if this is a forced merge (like when ecs_merge is called) */
@@ -9652,6 +11055,13 @@ void flecs_stage_manual_merge(
     flecs_stages_merge(world, true);
 }
 
+int32_t flecs_stage_cmd_cut(
+    ecs_stage_t *stage)
+{
+    flecs_sparse_clear(&stage->cmd_entries);
+    return ecs_vec_count(&stage->commands);
+}
+
 bool flecs_defer_begin(
     ecs_world_t *world,
     ecs_stage_t *stage)
@@ -10231,6 +11641,14 @@ void ecs_set_automerge(
     }
 }
 
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldParallelMerge, enable);
+}
+
 bool ecs_stage_is_readonly(
     const ecs_world_t *stage)
 {
@@ -10296,6 +11714,293 @@ bool ecs_stage_is_async(
     return ((ecs_stage_t*)stage)->async;
 }
 
+/* -- Command queues -- */
+
+/* Reserve slot for command. Only called by the producer thread. */
+static
+ecs_cmd_queue_elem_t* flecs_cmd_queue_reserve(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_kind_t kind,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    /* The consumer only ever decreases the number of used slots, so if the
+     * value read is outdated, the queue appears more full than it is. The
+     * acquire load ensures the consumer is done reading a slot before it is
+     * reused. */
+    if (ecs_os_aload(&queue->used) == queue->capacity) {
+        return NULL;
+    }
+
+    ecs_os_ainc(&queue->used);
+
+    ecs_cmd_queue_elem_t *elem = ECS_ELEM(
+        queue->slots, queue->slot_size, queue->head);
+    elem->kind = kind;
+    elem->size = 0;
+    elem->entity = entity;
+    elem->id = id;
+    return elem;
+}
+
+/* Make command visible to consumer. Only called by the producer thread. */
+static
+void flecs_cmd_queue_publish(
+    ecs_cmd_queue_t *queue)
+{
+    queue->head = (queue->head + 1) % queue->capacity;
+
+    /* Atomic increment ensures that the element is written before the
+     * consumer can see it */
+    ecs_os_ainc(&queue->count);
+}
+
+static
+void flecs_cmd_queue_apply(
+    ecs_world_t *world,
+    ecs_cmd_queue_elem_t *elem)
+{
+    ecs_entity_t e = elem->entity;
+    ecs_id_t id = elem->id;
+
+    /* Producers can't check whether entities and ids are valid, since they
+     * can't read from the world */
+    if (!ecs_is_alive(world, e) || (id && !ecs_id_is_valid(world, id))) {
+        world->info.cmd.discard_count ++;
+        return;
+    }
+
+    switch(elem->kind) {
+    case EcsOpAdd:
+        ecs_add_id(world, e, id);
+        break;
+    case EcsOpRemove:
+        ecs_remove_id(world, e, id);
+        break;
+    case EcsOpSet:
+        ecs_set_id(world, e, id, flecs_itosize(elem->size), 
+            ECS_OFFSET(elem, ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16)));
+        break;
+    case EcsOpDelete:
+        ecs_delete(world, e);
+        break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Apply commands published to queue. Commands that are published while the
+ * queue is merged are applied by the next merge. */
+static
+int32_t flecs_cmd_queue_merge(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue)
+{
+    /* The acquire load ensures that elements published by the producer are
+     * visible to this thread */
+    int32_t i, count = ecs_os_aload(&queue->count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_adec(&queue->count);
+
+        ecs_cmd_queue_elem_t *elem = ECS_ELEM(
+            queue->slots, queue->slot_size, queue->tail);
+        flecs_cmd_queue_apply(world, elem);
+        queue->tail = (queue->tail + 1) % queue->capacity;
+
+        /* Return slot to producer after the command has been read. Values of
+         * set commands are copied by ecs_set_id, also when deferred. */
+        ecs_os_adec(&queue->used);
+    }
+
+    return count;
+}
+
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->_canary == 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->value_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_has_threading(), ECS_MISSING_OS_API, "ainc/adec/aload");
+
+    int32_t capacity = desc->capacity;
+    if (!capacity) {
+        capacity = ECS_CMD_QUEUE_DEFAULT_CAPACITY;
+    }
+
+    ecs_size_t value_size = desc->value_size;
+    if (!value_size) {
+        value_size = ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE;
+    }
+    value_size = ECS_ALIGN(value_size, 16);
+
+    ecs_cmd_queue_t *result = ecs_os_calloc_t(ecs_cmd_queue_t);
+    result->world = world;
+    result->capacity = capacity;
+    result->value_size = value_size;
+    result->slot_size = 
+        ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16) + value_size;
+    result->slots = ecs_os_malloc(result->slot_size * capacity);
+
+    ecs_vec_append_t(&world->allocator, &world->cmd_queues, 
+        ecs_cmd_queue_t*)[0] = result;
+
+    return result;
+error:
+    return NULL;
+}
+
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_world_t *world = queue->world;
+
+    /* Apply commands that haven't been merged yet */
+    ecs_defer_begin(world);
+    flecs_cmd_queue_merge(world, queue);
+    ecs_defer_end(world);
+
+    ecs_cmd_queue_t **queues = ecs_vec_first(&world->cmd_queues);
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    for (i = 0; i < count; i ++) {
+        if (queues[i] == queue) {
+            /* Preserve order, so queues are merged in order of creation */
+            ecs_os_memmove(&queues[i], &queues[i + 1], 
+                ECS_SIZEOF(ecs_cmd_queue_t*) * (count - i - 1));
+            ecs_vec_remove_last(&world->cmd_queues);
+            break;
+        }
+    }
+
+    ecs_os_free(queue->slots);
+    ecs_os_free(queue);
+error:
+    return;
+}
+
+bool ecs_cmd_queue_add_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpAdd, entity, id)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_remove_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpRemove, entity, id)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_set_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(flecs_utosize(size) <= queue->value_size, 
+        ECS_INVALID_PARAMETER, "value exceeds value_size of queue");
+
+    ecs_cmd_queue_elem_t *elem = flecs_cmd_queue_reserve(
+        queue, EcsOpSet, entity, id);
+    if (!elem) {
+        return false;
+    }
+
+    elem->size = flecs_utosize(size);
+    ecs_os_memcpy(ECS_OFFSET(elem, 
+        ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16)), ptr, elem->size);
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpDelete, entity, 0)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+int32_t ecs_cmd_queues_merge(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), 
+        ECS_INVALID_OPERATION, NULL);
+
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    if (!count) {
+        return 0;
+    }
+
+    /* Commands are applied as deferred commands, so that they are batched
+     * with the other commands for the same entity */
+    int32_t result = 0;
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_queue_t *queue = ecs_vec_get_t(
+            &world->cmd_queues, ecs_cmd_queue_t*, i)[0];
+        result += flecs_cmd_queue_merge(world, queue);
+    }
+    ecs_defer_end(world);
+
+    return result;
+error:
+    return 0;
+}
+
+void flecs_cmd_queues_fini(
+    ecs_world_t *world)
+{
+    ecs_cmd_queue_t **queues = ecs_vec_first(&world->cmd_queues);
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(queues[i]->slots);
+        ecs_os_free(queues[i]);
+    }
+    ecs_vec_fini_t(&world->allocator, &world->cmd_queues, ecs_cmd_queue_t*);
+}
+
 bool ecs_is_deferred(
     const ecs_world_t *world)
 {
@@ -10342,6 +12047,19 @@ void flecs_allocator_fini(
     flecs_ballocator_fini(&a->chunks);
 }
 
+int64_t flecs_allocator_trim(
+    ecs_allocator_t *a)
+{
+    int64_t result = 0;
+    int32_t i = 0, count = flecs_sparse_count(&a->sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_block_allocator_t *ba = flecs_sparse_get_dense(
+            &a->sizes, ecs_block_allocator_t, i);
+        result += flecs_ballocator_trim(ba);
+    }
+    return result + flecs_ballocator_trim(&a->chunks);
+}
+
 ecs_block_allocator_t* flecs_allocator_get(
     ecs_allocator_t *a, 
     ecs_size_t size)
@@ -11280,6 +12998,43 @@ void flecs_sparse_clear(
     sparse->max_id_local = 0;
 }
 
+void flecs_sparse_shrink(
+    ecs_sparse_t *sparse)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    /* Free chunks that don't have any paired elements */
+    int32_t i, count = ecs_vector_count(sparse->chunks);
+    int32_t last = 0;
+    chunk_t *chunks = ecs_vector_first(sparse->chunks, chunk_t);
+    for (i = 0; i < count; i ++) {
+        chunk_t *chunk = &chunks[i];
+        int32_t *indices = chunk->sparse;
+        if (!indices) {
+            continue;
+        }
+
+        int32_t j;
+        for (j = 0; j < FLECS_SPARSE_CHUNK_SIZE; j ++) {
+            if (indices[j]) {
+                break;
+            }
+        }
+
+        if (j == FLECS_SPARSE_CHUNK_SIZE) {
+            flecs_sparse_chunk_free(sparse, chunk);
+            chunk->sparse = NULL;
+            chunk->data = NULL;
+        } else {
+            last = i + 1;
+        }
+    }
+
+    ecs_vector_set_count(&sparse->chunks, chunk_t, last);
+    ecs_vector_reclaim(&sparse->chunks, chunk_t);
+    ecs_vector_reclaim(&sparse->dense, uint64_t);
+}
+
 void _flecs_sparse_fini(
     ecs_sparse_t *sparse)
 {
@@ -11792,27 +13547,28 @@ void* _ecs_sparse_get(
 
 
 #ifdef FLECS_SANITIZE
-static 
-void verify_nodes(
+static
+void verify_elements(
+    const ecs_switch_t *sw,
     ecs_switch_header_t *hdr,
-    ecs_switch_node_t *nodes)
+    uint64_t value)
 {
     if (!hdr) {
         return;
     }
 
-    int32_t prev = -1, elem = hdr->element, count = 0;
-    while (elem != -1) {
-        ecs_assert(prev == nodes[elem].prev, ECS_INTERNAL_ERROR, NULL);
-        prev = elem;
-        elem = nodes[elem].next;
-        count ++;
+    ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    uint64_t *values = ecs_vec_first(&sw->values);
+    int32_t *elements = ecs_vec_first(&hdr->elements);
+    int32_t i, count = ecs_vec_count(&hdr->elements);
+    for (i = 0; i < count; i ++) {
+        int32_t elem = elements[i];
+        ecs_assert(nodes[elem].index == i, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(values[elem] == value, ECS_INTERNAL_ERROR, NULL);
     }
-
-    ecs_assert(count == hdr->count, ECS_INTERNAL_ERROR, NULL);
 }
 #else
-#define verify_nodes(hdr, nodes)
+#define verify_elements(sw, hdr, value)
 #endif
 
 static
@@ -11836,50 +13592,61 @@ ecs_switch_header_t *ensure_header(
         return NULL;
     }
 
-    ecs_switch_header_t *node = get_header(sw, value);
-    if (!node) {
-        node = ecs_map_ensure(&sw->hdrs, ecs_switch_header_t, value);
-        node->element = -1;
+    ecs_switch_header_t *hdr = get_header(sw, value);
+    if (!hdr) {
+        hdr = ecs_map_ensure(&sw->hdrs, ecs_switch_header_t, value);
+        ecs_vec_init_t(sw->hdrs.allocator, &hdr->elements, int32_t, 0);
     }
 
-    return node;
+    return hdr;
 }
 
+/* Remove element from the elements of a value. The last element is moved into
+ * the slot of the removed element. */
 static
-void remove_node(
+void remove_element(
     ecs_switch_header_t *hdr,
     ecs_switch_node_t *nodes,
-    ecs_switch_node_t *node,
     int32_t element)
 {
-    ecs_assert(&nodes[element] == node, ECS_INTERNAL_ERROR, NULL);
+    int32_t index = nodes[element].index;
+    int32_t *elements = ecs_vec_first(&hdr->elements);
+    int32_t last = ecs_vec_count(&hdr->elements) - 1;
+    ecs_assert(index <= last, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(elements[index] == element, ECS_INTERNAL_ERROR, NULL);
 
-    /* Update previous node/header */
-    if (hdr->element == element) {
-        ecs_assert(node->prev == -1, ECS_INVALID_PARAMETER, NULL);
-        /* If this is the first node, update the header */
-        hdr->element = node->next;
-    } else {
-        /* If this is not the first node, update the previous node to the 
-         * removed node's next ptr */
-        ecs_assert(node->prev != -1, ECS_INVALID_PARAMETER, NULL);
-        ecs_switch_node_t *prev_node = &nodes[node->prev];
-        prev_node->next = node->next;
+    if (index != last) {
+        int32_t moved = elements[last];
+        elements[index] = moved;
+        nodes[moved].index = index;
     }
 
-    /* Update next node */
-    int32_t next = node->next;
-    if (next != -1) {
-        ecs_assert(next >= 0, ECS_INVALID_PARAMETER, NULL);
-        /* If this is not the last node, update the next node to point to the
-         * removed node's prev ptr */
-        ecs_switch_node_t *next_node = &nodes[next];
-        next_node->prev = node->prev;
-    }
+    ecs_vec_remove_last(&hdr->elements);
+    nodes[element].index = -1;
+}
 
-    /* Decrease count of current header */
-    hdr->count --;
-    ecs_assert(hdr->count >= 0, ECS_INTERNAL_ERROR, NULL);
+static
+void add_element(
+    ecs_switch_t *sw,
+    ecs_switch_header_t *hdr,
+    ecs_switch_node_t *nodes,
+    int32_t element)
+{
+    nodes[element].index = ecs_vec_count(&hdr->elements);
+    int32_t *elem = ecs_vec_append_t(
+        sw->hdrs.allocator, &hdr->elements, int32_t);
+    *elem = element;
+}
+
+static
+void fini_headers(
+    ecs_switch_t *sw)
+{
+    ecs_map_iter_t it = ecs_map_iter(&sw->hdrs);
+    ecs_switch_header_t *hdr;
+    while ((hdr = ecs_map_next(&it, ecs_switch_header_t, NULL))) {
+        ecs_vec_fini_t(sw->hdrs.allocator, &hdr->elements, int32_t);
+    }
 }
 
 void flecs_switch_init(
@@ -11896,8 +13663,7 @@ void flecs_switch_init(
 
     int i;
     for (i = 0; i < elements; i ++) {
-        nodes[i].prev = -1;
-        nodes[i].next = -1;
+        nodes[i].index = -1;
         values[i] = 0;
     }
 }
@@ -11905,6 +13671,7 @@ void flecs_switch_init(
 void flecs_switch_clear(
     ecs_switch_t *sw)
 {
+    fini_headers(sw);
     ecs_map_clear(&sw->hdrs);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->nodes, ecs_switch_node_t);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->values, uint64_t);
@@ -11913,6 +13680,7 @@ void flecs_switch_clear(
 void flecs_switch_fini(
     ecs_switch_t *sw)
 {
+    fini_headers(sw);
     ecs_map_fini(&sw->hdrs);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->nodes, ecs_switch_node_t);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->values, uint64_t);
@@ -11921,12 +13689,11 @@ void flecs_switch_fini(
 void flecs_switch_add(
     ecs_switch_t *sw)
 {
-    ecs_switch_node_t *node = ecs_vec_append_t(sw->hdrs.allocator, 
+    ecs_switch_node_t *node = ecs_vec_append_t(sw->hdrs.allocator,
         &sw->nodes, ecs_switch_node_t);
-    uint64_t *value = ecs_vec_append_t(sw->hdrs.allocator, 
+    uint64_t *value = ecs_vec_append_t(sw->hdrs.allocator,
         &sw->values, uint64_t);
-    node->prev = -1;
-    node->next = -1;
+    node->index = -1;
     *value = 0;
 }
 
@@ -11947,9 +13714,7 @@ void flecs_switch_set_count(
 
     int32_t i;
     for (i = old_count; i < count; i ++) {
-        ecs_switch_node_t *node = &nodes[i];
-        node->prev = -1;
-        node->next = -1;
+        nodes[i].index = -1;
         values[i] = 0;
     }
 }
@@ -12001,39 +13766,26 @@ void flecs_switch_set(
     }
 
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
-    ecs_switch_node_t *node = &nodes[element];
 
+    /* Get dst header first, as ensuring a header can move existing headers */
     ecs_switch_header_t *dst_hdr = ensure_header(sw, value);
     ecs_switch_header_t *cur_hdr = get_header(sw, cur_value);
 
-    verify_nodes(cur_hdr, nodes);
-    verify_nodes(dst_hdr, nodes);
+    verify_elements(sw, cur_hdr, cur_value);
+    verify_elements(sw, dst_hdr, value);
 
     /* If value is not 0, and dst_hdr is NULL, then this is not a valid value
      * for this switch */
     ecs_assert(dst_hdr != NULL || !value, ECS_INVALID_PARAMETER, NULL);
 
     if (cur_hdr) {
-        remove_node(cur_hdr, nodes, node, element);
+        remove_element(cur_hdr, nodes, element);
     }
 
-    /* Now update the node itself by adding it as the first node of dst */
-    node->prev = -1;
     values[element] = value;
 
     if (dst_hdr) {
-        node->next = dst_hdr->element;
-
-        /* Also update the dst header */
-        int32_t first = dst_hdr->element;
-        if (first != -1) {
-            ecs_assert(first >= 0, ECS_INTERNAL_ERROR, NULL);
-            ecs_switch_node_t *first_node = &nodes[first];
-            first_node->prev = element;
-        }
-
-        dst_hdr->element = element;
-        dst_hdr->count ++;        
+        add_element(sw, dst_hdr, nodes, element);
     }
 }
 
@@ -12048,36 +13800,25 @@ void flecs_switch_remove(
     uint64_t *values = ecs_vec_first(&sw->values);
     uint64_t value = values[elem];
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
-    ecs_switch_node_t *node = &nodes[elem];
 
-    /* If node is currently assigned to a case, remove it from the list */
+    /* If element is currently assigned to a value, remove it from the list */
     if (value != 0) {
         ecs_switch_header_t *hdr = get_header(sw, value);
         ecs_assert(hdr != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        verify_nodes(hdr, nodes);
-        remove_node(hdr, nodes, node, elem);
+        verify_elements(sw, hdr, value);
+        remove_element(hdr, nodes, elem);
     }
 
+    /* The last element is moved into the slot of the removed element, so
+     * update the elements of its value. */
     int32_t last_elem = ecs_vec_count(&sw->nodes) - 1;
     if (last_elem != elem) {
-        ecs_switch_node_t *last = ecs_vec_last_t(&sw->nodes, ecs_switch_node_t);
-        int32_t next = last->next, prev = last->prev;
-        if (next != -1) {
-            ecs_switch_node_t *n = &nodes[next];
-            n->prev = elem;
-        }
-
-        if (prev != -1) {
-            ecs_switch_node_t *n = &nodes[prev];
-            n->next = elem;
-        } else {
-            ecs_switch_header_t *hdr = get_header(sw, values[last_elem]);
-            if (hdr && hdr->element != -1) {
-                ecs_assert(hdr->element == last_elem, 
-                    ECS_INTERNAL_ERROR, NULL);
-                hdr->element = elem;
-            }
+        ecs_switch_header_t *hdr = get_header(sw, values[last_elem]);
+        if (hdr) {
+            int32_t index = nodes[last_elem].index;
+            ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
+            ecs_vec_get_t(&hdr->elements, int32_t, index)[0] = elem;
         }
     }
 
@@ -12114,7 +13855,7 @@ int32_t flecs_switch_case_count(
         return 0;
     }
 
-    return hdr->count;
+    return ecs_vec_count(&hdr->elements);
 }
 
 void flecs_switch_swap(
@@ -12122,11 +13863,36 @@ void flecs_switch_swap(
     int32_t elem_1,
     int32_t elem_2)
 {
-    uint64_t v1 = flecs_switch_get(sw, elem_1);
-    uint64_t v2 = flecs_switch_get(sw, elem_2);
+    if (elem_1 == elem_2) {
+        return;
+    }
 
-    flecs_switch_set(sw, elem_2, v1);
-    flecs_switch_set(sw, elem_1, v2);
+    uint64_t *values = ecs_vec_first(&sw->values);
+    ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    uint64_t v1 = values[elem_1];
+    uint64_t v2 = values[elem_2];
+
+    /* Swap element ids in the elements of both values, then swap the nodes so
+     * that each node points to the right index. */
+    ecs_switch_header_t *hdr_1 = get_header(sw, v1);
+    ecs_switch_header_t *hdr_2 = get_header(sw, v2);
+    if (hdr_1) {
+        ecs_vec_get_t(&hdr_1->elements, int32_t, nodes[elem_1].index)[0] =
+            elem_2;
+    }
+    if (hdr_2) {
+        ecs_vec_get_t(&hdr_2->elements, int32_t, nodes[elem_2].index)[0] =
+            elem_1;
+    }
+
+    ecs_switch_node_t tmp = nodes[elem_1];
+    nodes[elem_1] = nodes[elem_2];
+    nodes[elem_2] = tmp;
+    values[elem_1] = v2;
+    values[elem_2] = v1;
+
+    verify_elements(sw, hdr_1, v1);
+    verify_elements(sw, hdr_2, v2);
 }
 
 int32_t flecs_switch_first(
@@ -12134,13 +13900,20 @@ int32_t flecs_switch_first(
     uint64_t value)
 {
     ecs_assert(sw != NULL, ECS_INVALID_PARAMETER, NULL);
-    
+
     ecs_switch_header_t *hdr = get_header(sw, value);
     if (!hdr) {
         return -1;
     }
 
-    return hdr->element;
+    /* Iterate elements from last to first, so that elements that were most
+     * recently assigned to the value are returned first */
+    int32_t count = ecs_vec_count(&hdr->elements);
+    if (!count) {
+        return -1;
+    }
+
+    return ecs_vec_get_t(&hdr->elements, int32_t, count - 1)[0];
 }
 
 int32_t flecs_switch_next(
@@ -12152,8 +13925,30 @@ int32_t flecs_switch_next(
     ecs_assert(element >= 0, ECS_INVALID_PARAMETER, NULL);
 
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    int32_t index = nodes[element].index;
+    if (index <= 0) {
+        return -1;
+    }
+
+    uint64_t *values = ecs_vec_first(&sw->values);
+    ecs_switch_header_t *hdr = get_header(sw, values[element]);
+    ecs_assert(hdr != NULL, ECS_INTERNAL_ERROR, NULL);
 
-    return nodes[element].next;
+    return ecs_vec_get_t(&hdr->elements, int32_t, index - 1)[0];
+}
+
+const int32_t* flecs_switch_elements(
+    const ecs_switch_t *sw,
+    uint64_t value)
+{
+    ecs_assert(sw != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_switch_header_t *hdr = get_header(sw, value);
+    if (!hdr) {
+        return NULL;
+    }
+
+    return ecs_vec_first(&hdr->elements);
 }
 
 
@@ -12840,6 +14635,21 @@ error:
     return;
 }
 
+int32_t flecs_ctz64(
+    uint64_t value)
+{
+    /* De Bruijn sequence lookup, portable across compilers */
+    static const uint8_t ctz_table[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6};
+
+    ecs_assert(value != 0, ECS_INTERNAL_ERROR, NULL);
+    uint64_t lsb = value & (~value + 1);
+    return ctz_table[(lsb * 0x03f79d71b4cb0a89ull) >> 58];
+}
+
 #include <math.h>
 
 /**
@@ -13832,12 +15642,24 @@ void* ecs_vec_first(
  * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
 #define LOAD_FACTOR (1.2f)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
-#define GET_ELEM(array, elem_size, index) \
-    ECS_OFFSET(array, (elem_size) * (index))
+
+/* Number of control bytes that are tested at the same time. The control array
+ * has GROUP_SIZE cloned bytes at the end, so that a group can be loaded from
+ * any slot without wrapping around. This requires the map to have at least
+ * GROUP_SIZE slots. */
+#define GROUP_SIZE (8)
+
+/* Control byte values. Full slots store the 7 bits of the hash (h2) that were
+ * not used to compute the slot, so the most significant bit is never set. */
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+
+#define GROUP_LSBS (0x0101010101010101ull)
+#define GROUP_MSBS (0x8080808080808080ull)
 
 static
 uint8_t ecs_log2(uint32_t v) {
-    static const uint8_t log2table[32] = 
+    static const uint8_t log2table[32] =
         {0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
          8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31};
 
@@ -13849,6 +15671,70 @@ uint8_t ecs_log2(uint32_t v) {
     return log2table[(uint32_t)(v * 0x07C4ACDDU) >> 27];
 }
 
+/* Get index of lowest set bit in group mask, divided by 8 (the byte index) */
+static
+int32_t flecs_map_group_first(
+    uint64_t mask)
+{
+    ecs_assert(mask != 0, ECS_INTERNAL_ERROR, NULL);
+    return flecs_ctz64(mask) >> 3;
+}
+
+/* Get index of highest set byte in group mask */
+static
+int32_t flecs_map_group_last(
+    uint64_t mask)
+{
+    ecs_assert(mask != 0, ECS_INTERNAL_ERROR, NULL);
+    int32_t result = GROUP_SIZE - 1;
+    while (!(mask & (0x80ull << (result * 8)))) {
+        result --;
+    }
+    return result;
+}
+
+/* Load group of control bytes, with the first byte in the least significant
+ * byte of the result */
+static
+uint64_t flecs_map_group_load(
+    const uint8_t *ctrl)
+{
+    uint64_t result;
+    ecs_os_memcpy(&result, ctrl, ECS_SIZEOF(uint64_t));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+/* Return mask with the msb set for each control byte that matches h2. This can
+ * return false positives for a byte that follows a match, which is fine as the
+ * key of each candidate slot is compared. */
+static
+uint64_t flecs_map_group_match(
+    uint64_t group,
+    uint64_t h2)
+{
+    uint64_t x = group ^ (GROUP_LSBS * h2);
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+/* Return mask with the msb set for each empty control byte */
+static
+uint64_t flecs_map_group_empty(
+    uint64_t group)
+{
+    return (group & (~group << 6)) & GROUP_MSBS;
+}
+
+/* Return mask with the msb set for each empty or deleted control byte */
+static
+uint64_t flecs_map_group_empty_or_deleted(
+    uint64_t group)
+{
+    return (group & ~(group << 7)) & GROUP_MSBS;
+}
+
 /* Get bucket count for number of elements */
 static
 int32_t get_bucket_count(
@@ -13865,204 +15751,298 @@ uint8_t get_bucket_shift (
     return (uint8_t)(64u - ecs_log2((uint32_t)bucket_count));
 }
 
-/* Get bucket index for provided map key */
+/* Get hash for provided map key. The most significant bits are used for the
+ * slot index, the 7 bits after that are stored in the control byte. */
 static
-int32_t get_bucket_index(
-    uint16_t bucket_shift,
-    ecs_map_key_t key) 
+uint64_t flecs_map_hash(
+    ecs_map_key_t key)
 {
-    ecs_assert(bucket_shift != 0, ECS_INTERNAL_ERROR, NULL);
-    return (int32_t)((11400714819323198485ull * key) >> bucket_shift);
+    return 11400714819323198485ull * key;
 }
 
-/* Get bucket for key */
 static
-ecs_bucket_t* flecs_map_get_bucket(
+int32_t flecs_map_h1(
     const ecs_map_t *map,
-    ecs_map_key_t key)
+    uint64_t hash)
 {
     ecs_assert(map->bucket_shift == get_bucket_shift(map->bucket_count),
         ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map->bucket_shift, key);
-    ecs_assert(bucket_id < map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (int32_t)(hash >> map->bucket_shift);
 }
 
-/* Ensure that map has at least new_count buckets */
 static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
+uint8_t flecs_map_h2(
+    const ecs_map_t *map,
+    uint64_t hash)
 {
-    int32_t bucket_count = map->bucket_count;
-    new_count = flecs_next_pow_of_2(new_count);
-    if (new_count < 2) {
-        new_count = 2;
-    }
+    return (uint8_t)((hash >> (map->bucket_shift - 7)) & 0x7F);
+}
 
-    if (new_count && new_count > bucket_count) {
-        if (map->allocator) {
-            map->buckets = flecs_realloc_n(map->allocator, ecs_bucket_t,
-                new_count, bucket_count, map->buckets);
-        } else {
-            map->buckets = ecs_os_realloc_n(
-                map->buckets, ecs_bucket_t, new_count);
-        }
+static
+ecs_size_t flecs_map_slot_size(
+    ecs_size_t elem_size)
+{
+    return ECS_ALIGN((KEY_SIZE + elem_size), KEY_SIZE);
+}
 
-        map->buckets_end = ECS_ELEM_T(map->buckets, ecs_bucket_t, new_count);
-        map->bucket_count = new_count;
-        map->bucket_shift = get_bucket_shift(new_count);
-        ecs_os_memset_n(ECS_ELEM_T(map->buckets, ecs_bucket_t, bucket_count),
-            0, ecs_bucket_t, (new_count - bucket_count));
-    }
+static
+ecs_size_t flecs_map_alloc_size(
+    const ecs_map_t *map)
+{
+    int32_t count = map->bucket_count;
+    return (map->slot_size * count) + count + GROUP_SIZE;
 }
 
-/* Free contents of bucket */
 static
-void clear_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_entry_t *bucket)
+ecs_map_key_t* flecs_map_slot(
+    const ecs_map_t *map,
+    int32_t index)
 {
-    while(bucket) {
-      ecs_bucket_entry_t *next = bucket->next;
-      flecs_bfree(allocator, bucket);
-      bucket = next;
-    }
+    return ECS_OFFSET(map->slots, map->slot_size * index);
 }
 
-/* Clear all buckets */
 static
-void clear_buckets(
-    ecs_map_t *map)
+void flecs_map_set_ctrl(
+    ecs_map_t *map,
+    int32_t index,
+    uint8_t ctrl)
 {
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(map->entry_allocator, map->buckets[i].first);
+    map->ctrl[index] = ctrl;
+    if (index < GROUP_SIZE) {
+        /* Update cloned byte */
+        map->ctrl[map->bucket_count + index] = ctrl;
     }
+}
+
+/* Allocate storage for slots and control bytes */
+static
+void flecs_map_alloc(
+    ecs_map_t *map,
+    int32_t bucket_count)
+{
+    ecs_assert(bucket_count >= GROUP_SIZE, ECS_INTERNAL_ERROR, NULL);
+    map->bucket_count = bucket_count;
+    map->bucket_shift = get_bucket_shift(bucket_count);
+    map->deleted = 0;
+
+    ecs_size_t size = flecs_map_alloc_size(map);
     if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, count, map->buckets);
+        map->slots = flecs_alloc(map->allocator, size);
     } else {
-        ecs_os_free(map->buckets);
+        map->slots = ecs_os_malloc(size);
     }
-    map->buckets = NULL;
-    map->bucket_count = 0;
+
+    map->ctrl = ECS_OFFSET(map->slots, map->slot_size * bucket_count);
+    ecs_os_memset(map->ctrl, CTRL_EMPTY, bucket_count + GROUP_SIZE);
 }
 
-/* Add element to bucket */
 static
-void* flecs_map_add_to_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    const void *payload)
+void flecs_map_free_slots(
+    ecs_map_t *map,
+    void *slots,
+    int32_t bucket_count)
 {
-    ecs_bucket_entry_t *new_entry = flecs_balloc(allocator);
-    new_entry->key = key;
-    new_entry->next = bucket->first;
-    bucket->first = new_entry;
-    void *new_payload = ECS_OFFSET(&new_entry->key, ECS_SIZEOF(ecs_map_key_t));
-    if (elem_size && payload) {
-        ecs_os_memcpy(new_payload, payload, elem_size);
+    if (!slots) {
+        return;
+    }
+
+    ecs_size_t size = (map->slot_size * bucket_count) +
+        bucket_count + GROUP_SIZE;
+    if (map->allocator) {
+        flecs_free(map->allocator, size, slots);
+    } else {
+        ecs_os_free(slots);
     }
-    return new_payload;
 }
 
-/*  Remove element from bucket */
+/* Find first empty or deleted slot for hash. Map must have free slots. */
 static
-bool remove_from_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key)
+int32_t flecs_map_find_free(
+    const ecs_map_t *map,
+    uint64_t hash)
 {
-    ecs_bucket_entry_t *entry;
-    for (entry = bucket->first; entry; entry = entry->next) {
-        if (entry->key == key) {
-            ecs_bucket_entry_t **next_holder = &bucket->first;
-            while(*next_holder != entry) {
-                next_holder = &(*next_holder)->next;
-            }
-            *next_holder = entry->next;
-            flecs_bfree(allocator, entry);
-            return true;
+    int32_t mask = map->bucket_count - 1;
+    int32_t pos = flecs_map_h1(map, hash);
+    int32_t stride = 0;
+
+    while (true) {
+        uint64_t group = flecs_map_group_load(&map->ctrl[pos]);
+        uint64_t free_mask = flecs_map_group_empty_or_deleted(group);
+        if (free_mask) {
+            return (pos + flecs_map_group_first(free_mask)) & mask;
         }
+
+        /* Triangular probing visits every group when the number of slots is
+         * a power of 2 */
+        stride += GROUP_SIZE;
+        pos = (pos + stride) & mask;
+        ecs_assert(stride <= map->bucket_count, ECS_INTERNAL_ERROR, NULL);
     }
-    
-    return false;
 }
 
-/* Get payload pointer for key from bucket */
+/* Find slot index for key, or -1 if key is not in map */
 static
-void* flecs_map_get_from_bucket(
-    ecs_bucket_t *bucket,
+int32_t flecs_map_find(
+    const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    ecs_bucket_entry_t *entry;
-    for (entry = bucket->first; entry; entry = entry->next) {
-        if (entry->key == key) {
-            return ECS_OFFSET(&entry->key, ECS_SIZEOF(ecs_map_key_t));
+    uint64_t hash = flecs_map_hash(key);
+    uint64_t h2 = flecs_map_h2(map, hash);
+    int32_t mask = map->bucket_count - 1;
+    int32_t pos = flecs_map_h1(map, hash);
+    int32_t stride = 0;
+
+    while (true) {
+        uint64_t group = flecs_map_group_load(&map->ctrl[pos]);
+        uint64_t match = flecs_map_group_match(group, h2);
+        while (match) {
+            int32_t index = (pos + flecs_map_group_first(match)) & mask;
+            if (flecs_map_slot(map, index)[0] == key) {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        /* An empty slot terminates the probe sequence */
+        if (flecs_map_group_empty(group)) {
+            return -1;
+        }
+
+        stride += GROUP_SIZE;
+        pos = (pos + stride) & mask;
+        if (stride > map->bucket_count) {
+            return -1;
         }
     }
-    
-    return NULL;
 }
 
-/* Grow number of buckets */
+/* Resize slot array, reinsert elements and drop deleted slots */
 static
 void flecs_map_rehash(
     ecs_map_t *map,
     int32_t bucket_count)
 {
     ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    
+
     int32_t old_count = map->bucket_count;
-    ecs_bucket_t *old_buckets = map->buckets;
-    
+    uint8_t *old_ctrl = map->ctrl;
+    void *old_slots = map->slots;
+
     int32_t new_count = flecs_next_pow_of_2(bucket_count);
-    map->bucket_count = new_count;
-    map->bucket_shift = get_bucket_shift(new_count);
-    if (map->allocator) {
-        map->buckets = flecs_calloc_n(map->allocator, ecs_bucket_t, new_count);
-    } else {
-        map->buckets = ecs_os_calloc_n(ecs_bucket_t, new_count);
+    int32_t min_count = get_bucket_count(map->count);
+    if (new_count < min_count) {
+        new_count = min_count;
+    }
+    if (new_count < GROUP_SIZE) {
+        new_count = GROUP_SIZE;
     }
-    map->buckets_end = ECS_ELEM_T(map->buckets, ecs_bucket_t, new_count);
 
-    /* Remap old bucket entries to new buckets */
+    flecs_map_alloc(map, new_count);
+
+    /* Reinsert old slots */
+    ecs_size_t slot_size = map->slot_size;
     int32_t index;
     for (index = 0; index < old_count; ++index) {
-        ecs_bucket_entry_t* entry;
-        for (entry = old_buckets[index].first; entry;) {
-            ecs_bucket_entry_t* next = entry->next;
-            int32_t bucket_index = get_bucket_index(
-                map->bucket_shift, entry->key);
-            ecs_bucket_t *bucket = &map->buckets[bucket_index];
-            entry->next = bucket->first;
-            bucket->first = entry;
-            entry = next;
+        if (old_ctrl[index] & CTRL_EMPTY) {
+            continue; /* Empty or deleted */
         }
-    }
 
-    if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, old_count, old_buckets);
-    } else {
-        ecs_os_free(old_buckets);
+        ecs_map_key_t *old_slot = ECS_OFFSET(old_slots, slot_size * index);
+        uint64_t hash = flecs_map_hash(old_slot[0]);
+        int32_t new_index = flecs_map_find_free(map, hash);
+        flecs_map_set_ctrl(map, new_index, flecs_map_h2(map, hash));
+        ecs_os_memcpy(flecs_map_slot(map, new_index), old_slot, slot_size);
     }
+
+    flecs_map_free_slots(map, old_slots, old_count);
 }
 
-bool ecs_map_is_initialized(
-    const ecs_map_t *result)
+/* Get index of probe group for slot, relative to the start of the probe */
+static
+int32_t flecs_map_probe_index(
+    const ecs_map_t *map,
+    int32_t index,
+    uint64_t hash)
 {
-    return result != NULL && result->bucket_count != 0;
+    int32_t mask = map->bucket_count - 1;
+    return ((index - flecs_map_h1(map, hash)) & mask) / GROUP_SIZE;
 }
 
 static
-ecs_size_t flecs_map_chunk_size(
-    ecs_size_t size)
+void flecs_map_swap_slots(
+    ecs_map_t *map,
+    int32_t index_a,
+    int32_t index_b)
+{
+    uint8_t *a = (uint8_t*)flecs_map_slot(map, index_a);
+    uint8_t *b = (uint8_t*)flecs_map_slot(map, index_b);
+    ecs_size_t i, size = map->slot_size;
+    for (i = 0; i < size; i ++) {
+        uint8_t tmp = a[i];
+        a[i] = b[i];
+        b[i] = tmp;
+    }
+}
+
+/* Remove deleted slots without resizing the map. This avoids allocating a new
+ * slot array for maps that have many removes & inserts, but don't grow. */
+static
+void flecs_map_drop_deleted(
+    ecs_map_t *map)
 {
-    int32_t entry_size = size + ECS_SIZEOF(ecs_bucket_entry_t);
-    return ECS_MAX(entry_size, ECS_SIZEOF(ecs_block_allocator_chunk_header_t));
+    int32_t index, count = map->bucket_count;
+    uint8_t *ctrl = map->ctrl;
+
+    /* Mark deleted slots as empty, and full slots as deleted. Slots that are
+     * marked as deleted still need to be moved to their new position. */
+    for (index = 0; index < count; index ++) {
+        ctrl[index] = (ctrl[index] & CTRL_EMPTY) ? CTRL_EMPTY : CTRL_DELETED;
+    }
+    ecs_os_memcpy(&ctrl[count], ctrl, GROUP_SIZE);
+
+    for (index = 0; index < count; index ++) {
+        if (ctrl[index] != CTRL_DELETED) {
+            continue;
+        }
+
+        ecs_map_key_t *slot = flecs_map_slot(map, index);
+        uint64_t hash = flecs_map_hash(slot[0]);
+        uint8_t h2 = flecs_map_h2(map, hash);
+        int32_t new_index = flecs_map_find_free(map, hash);
+
+        /* If the slot is in the same probe group as the new slot, there is no
+         * need to move it. */
+        if (flecs_map_probe_index(map, index, hash) == 
+            flecs_map_probe_index(map, new_index, hash)) 
+        {
+            flecs_map_set_ctrl(map, index, h2);
+            continue;
+        }
+
+        if (ctrl[new_index] == CTRL_EMPTY) {
+            /* Move slot to empty position */
+            flecs_map_set_ctrl(map, new_index, h2);
+            ecs_os_memcpy(flecs_map_slot(map, new_index), slot, 
+                map->slot_size);
+            flecs_map_set_ctrl(map, index, CTRL_EMPTY);
+        } else {
+            /* Target slot still needs to be moved, swap & process current 
+             * slot again. */
+            ecs_assert(ctrl[new_index] == CTRL_DELETED, 
+                ECS_INTERNAL_ERROR, NULL);
+            flecs_map_set_ctrl(map, new_index, h2);
+            flecs_map_swap_slots(map, index, new_index);
+            index --;
+        }
+    }
+
+    map->deleted = 0;
+}
+
+bool ecs_map_is_initialized(
+    const ecs_map_t *result)
+{
+    return result != NULL && result->bucket_count != 0;
 }
 
 void _ecs_map_params_init(
@@ -14072,14 +16052,13 @@ void _ecs_map_params_init(
 {
     params->size = size;
     params->allocator = allocator;
-    flecs_ballocator_init(&params->entry_allocator,
-        flecs_map_chunk_size(size));
+    params->initial_count = 0;
 }
 
 void ecs_map_params_fini(
     ecs_map_params_t *params)
 {
-    flecs_ballocator_fini(&params->entry_allocator);
+    (void)params;
 }
 
 void _ecs_map_init_w_params(
@@ -14090,17 +16069,15 @@ void _ecs_map_init_w_params(
 
     result->count = 0;
     result->elem_size = flecs_ito(int16_t, params->size);
+    result->slot_size = flecs_ito(int16_t, flecs_map_slot_size(params->size));
     result->allocator = params->allocator;
 
-    if (params->entry_allocator.chunk_size) {
-        result->entry_allocator = &params->entry_allocator;
-        result->shared_allocator = true;
-    } else {
-        result->entry_allocator = flecs_ballocator_new(
-            flecs_map_chunk_size(params->size));
+    int32_t bucket_count = get_bucket_count(params->initial_count);
+    if (bucket_count < GROUP_SIZE) {
+        bucket_count = GROUP_SIZE;
     }
 
-    ensure_buckets(result, get_bucket_count(params->initial_count));
+    flecs_map_alloc(result, bucket_count);
 }
 
 void _ecs_map_init_w_params_if(
@@ -14108,7 +16085,7 @@ void _ecs_map_init_w_params_if(
     ecs_map_params_t *params)
 {
     if (ecs_map_is_initialized(result)) {
-        ecs_assert(params->size == result->elem_size, 
+        ecs_assert(params->size == result->elem_size,
             ECS_INVALID_PARAMETER, NULL);
         return;
     }
@@ -14158,40 +16135,12 @@ void ecs_map_fini(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-#ifdef FLECS_SANITIZE
-    bool sanitize = true;
-#else
-    bool sanitize = false;
-#endif
-
-    /* Free buckets in sanirized mode, so we can replace the allocator with
-     * regular malloc/free and use asan/valgrind to find memory errors. */
-    if (map->shared_allocator || sanitize) {
-        ecs_bucket_t *bucket = map->buckets;
-        while ((bucket != map->buckets_end)) {
-            ecs_bucket_entry_t *entry = bucket->first;
-            while (entry) {
-                ecs_bucket_entry_t *next = entry->next;
-                flecs_bfree(map->entry_allocator, entry);
-                entry = next;
-            }
-            bucket ++;
-        }
-    }
-
-    if (map->entry_allocator && !map->shared_allocator) {
-        flecs_ballocator_free(map->entry_allocator);
-        map->entry_allocator = NULL;
-    }
-    if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, map->bucket_count, 
-            map->buckets);
-    } else {
-        ecs_os_free(map->buckets);
-    }
-    map->buckets = NULL;
-    map->buckets_end = NULL;
+    flecs_map_free_slots(map, map->slots, map->bucket_count);
+    map->slots = NULL;
+    map->ctrl = NULL;
     map->bucket_count = 0;
+    map->count = 0;
+    map->deleted = 0;
     ecs_assert(!ecs_map_is_initialized(map), ECS_INTERNAL_ERROR, NULL);
 }
 
@@ -14217,9 +16166,12 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
+    int32_t index = flecs_map_find(map, key);
+    if (index == -1) {
+        return NULL;
+    }
 
-    return flecs_map_get_from_bucket(bucket, key);
+    return ECS_OFFSET(flecs_map_slot(map, index), KEY_SIZE);
 }
 
 void* _ecs_map_get_ptr(
@@ -14243,9 +16195,7 @@ bool ecs_map_has(
         return false;
     }
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-
-    return flecs_map_get_from_bucket(bucket, key) != NULL;
+    return flecs_map_find(map, key) != -1;
 }
 
 void* _ecs_map_ensure(
@@ -14273,30 +16223,44 @@ void* _ecs_map_set(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ecs_map_is_initialized(map), ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-
-    void *elem = flecs_map_get_from_bucket(bucket, key);
-    if (!elem) {
-        void *added_data = flecs_map_add_to_bucket(
-            map->entry_allocator, bucket, elem_size, key, payload);
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            flecs_map_rehash(map, target_bucket_count);
-            bucket = flecs_map_get_bucket(map, key);
-            added_data = flecs_map_get_from_bucket(bucket, key);
-            ecs_assert(added_data != NULL, ECS_INVALID_PARAMETER, NULL);
-        }
-        return added_data;
-    } else {
+    int32_t index = flecs_map_find(map, key);
+    if (index != -1) {
+        void *elem = ECS_OFFSET(flecs_map_slot(map, index), KEY_SIZE);
         if (payload) {
             ecs_os_memcpy(elem, payload, elem_size);
         }
         return elem;
     }
+
+    /* Deleted slots are part of the load, as they don't terminate a probe
+     * sequence. If there are too many, rehash (and grow if necessary). */
+    int32_t load = map->count + map->deleted + 1;
+    if (get_bucket_count(load) > map->bucket_count) {
+        int32_t bucket_count = get_bucket_count(map->count + 1);
+        if (bucket_count > map->bucket_count) {
+            flecs_map_rehash(map, bucket_count);
+        } else {
+            flecs_map_drop_deleted(map);
+        }
+    }
+
+    uint64_t hash = flecs_map_hash(key);
+    index = flecs_map_find_free(map, hash);
+    map->deleted -= map->ctrl[index] == CTRL_DELETED;
+    flecs_map_set_ctrl(map, index, flecs_map_h2(map, hash));
+    map->count ++;
+
+    ecs_map_key_t *slot = flecs_map_slot(map, index);
+    slot[0] = key;
+
+    void *elem = ECS_OFFSET(slot, KEY_SIZE);
+    if (elem_size && payload) {
+        ecs_os_memcpy(elem, payload, elem_size);
+    }
+
+    return elem;
 }
 
 int32_t ecs_map_remove(
@@ -14305,12 +16269,35 @@ int32_t ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-    if (remove_from_bucket(map->entry_allocator, bucket, key)) {
-        return --map->count;
+    if (!ecs_map_is_initialized(map)) {
+        return 0;
+    }
+
+    int32_t index = flecs_map_find(map, key);
+    if (index == -1) {
+        return map->count;
+    }
+
+    /* If every group that contains the slot also contains an empty slot, no
+     * probe sequence could have passed over the slot while it was full, and it
+     * can be marked as empty. Otherwise the slot is marked as deleted, so that
+     * probe sequences continue past it. */
+    int32_t mask = map->bucket_count - 1;
+    uint64_t empty_after = flecs_map_group_empty(
+        flecs_map_group_load(&map->ctrl[index]));
+    uint64_t empty_before = flecs_map_group_empty(
+        flecs_map_group_load(&map->ctrl[(index - GROUP_SIZE) & mask]));
+    if (empty_after && empty_before && 
+       ((flecs_map_group_first(empty_after) + 
+         (GROUP_SIZE - 1 - flecs_map_group_last(empty_before))) < GROUP_SIZE))
+    {
+        flecs_map_set_ctrl(map, index, CTRL_EMPTY);
+    } else {
+        flecs_map_set_ctrl(map, index, CTRL_DELETED);
+        map->deleted ++;
     }
-    
-    return map->count;
+
+    return --map->count;
 }
 
 int32_t ecs_map_count(
@@ -14329,9 +16316,9 @@ void ecs_map_clear(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    clear_buckets(map);
+    flecs_map_free_slots(map, map->slots, map->bucket_count);
     map->count = 0;
-    ensure_buckets(map, 2);
+    flecs_map_alloc(map, GROUP_SIZE);
 }
 
 ecs_map_iter_t ecs_map_iter(
@@ -14339,8 +16326,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .entry = NULL
+        .index = 0
     };
 }
 
@@ -14354,46 +16340,29 @@ void* _ecs_map_next(
     if (!ecs_map_is_initialized(map)) {
         return NULL;
     }
-    if (iter->bucket == map->buckets_end) {
-        return NULL;
-    }
 
-    ecs_assert(!elem_size || elem_size == map->elem_size, 
+    ecs_assert(!elem_size || elem_size == map->elem_size,
         ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_entry_t *entry = NULL;
-    
-    if (!iter->bucket) {
-        for (iter->bucket = map->buckets; 
-            iter->bucket != map->buckets_end; 
-            ++iter->bucket) 
-        {
-            if (iter->bucket->first) {
-                entry = iter->bucket->first;
-                break;
-            }
-        }
-        if (iter->bucket == map->buckets_end) {
-            return NULL;
-        }
-    } else if ((entry = iter->entry) == NULL) {
-        do {
-            ++iter->bucket;
-            if (iter->bucket == map->buckets_end) {
-                return NULL;
-            }
-        } while(!iter->bucket->first);
-        entry = iter->bucket->first;
+    const uint8_t *ctrl = map->ctrl;
+    int32_t index = iter->index, count = map->bucket_count;
+    while (index < count && (ctrl[index] & CTRL_EMPTY)) {
+        index ++; /* Skip empty & deleted slots */
     }
-    
-    if (key_out) {
-        ecs_assert(entry != NULL, ECS_INTERNAL_ERROR, NULL);
-        *key_out = entry->key;
+
+    if (index >= count) {
+        iter->index = count;
+        return NULL;
     }
 
-    iter->entry = entry->next;
+    iter->index = index + 1;
 
-    return ECS_OFFSET(&entry->key, ECS_SIZEOF(ecs_map_key_t));
+    ecs_map_key_t *slot = flecs_map_slot(map, index);
+    if (key_out) {
+        *key_out = slot[0];
+    }
+
+    return ECS_OFFSET(slot, KEY_SIZE);
 }
 
 void* _ecs_map_next_ptr(
@@ -14409,7 +16378,7 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -14422,9 +16391,9 @@ void ecs_map_grow(
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t bucket_count = get_bucket_count(element_count);
 
@@ -14463,6 +16432,19 @@ ecs_map_t* ecs_map_copy(
 int64_t ecs_block_allocator_alloc_count = 0;
 int64_t ecs_block_allocator_free_count = 0;
 
+/* Alignment of chunks returned for an allocator with the specified data size */
+static
+ecs_size_t flecs_balloc_align(
+    ecs_size_t data_size)
+{
+    ecs_size_t size = ECS_ALIGN(data_size, 16);
+    ecs_size_t align = size & -size;
+    if (align > FLECS_BALLOC_ALIGN) {
+        align = FLECS_BALLOC_ALIGN;
+    }
+    return align;
+}
+
 static
 ecs_block_allocator_chunk_header_t* flecs_balloc_block(
     ecs_block_allocator_t *allocator)
@@ -14471,11 +16453,18 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
         return NULL;
     }
 
+    /* Allocate enough memory to align the first chunk. Chunk sizes are a
+     * multiple of the chunk alignment, so all other chunks are aligned too */
+    ecs_size_t align = flecs_balloc_align(allocator->data_size);
     ecs_block_allocator_block_t *block = 
         ecs_os_malloc(ECS_SIZEOF(ecs_block_allocator_block_t) +
-            allocator->block_size);
-    ecs_block_allocator_chunk_header_t *first_chunk = ECS_OFFSET(block, 
+            allocator->block_size + align);
+    uintptr_t first_addr = (uintptr_t)ECS_OFFSET(block, 
         ECS_SIZEOF(ecs_block_allocator_block_t));
+    first_addr = (first_addr + (uintptr_t)(align - 1)) & 
+        ~(uintptr_t)(align - 1);
+    ecs_block_allocator_chunk_header_t *first_chunk = 
+        (ecs_block_allocator_chunk_header_t*)first_addr;
 
     block->memory = first_chunk;
     if (!allocator->block_tail) {
@@ -14510,7 +16499,8 @@ void flecs_ballocator_init(
     ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
     ba->data_size = size;
 #ifdef FLECS_SANITIZE
-    size += ECS_SIZEOF(int64_t);
+    /* Reserve space for the chunk size, without changing data alignment */
+    size = ECS_ALIGN(size, 16) + flecs_balloc_align(size);
 #endif
     ba->chunk_size = ECS_ALIGN(size, 16);
     ba->chunks_per_block = ECS_MAX(4096 / ba->chunk_size, 1);
@@ -14554,6 +16544,132 @@ void flecs_ballocator_free(
     ecs_os_free(ba);
 }
 
+typedef struct flecs_block_free_t {
+    uintptr_t memory;
+    int32_t free_count;
+} flecs_block_free_t;
+
+static
+int flecs_block_free_compare(
+    const void *ptr_1,
+    const void *ptr_2)
+{
+    uintptr_t b_1 = ((const flecs_block_free_t*)ptr_1)->memory;
+    uintptr_t b_2 = ((const flecs_block_free_t*)ptr_2)->memory;
+    return (b_1 > b_2) - (b_1 < b_2);
+}
+
+/* Find block that contains chunk in array sorted by memory address */
+static
+flecs_block_free_t* flecs_block_free_find(
+    flecs_block_free_t *blocks,
+    int32_t count,
+    ecs_size_t block_size,
+    const void *chunk)
+{
+    uintptr_t addr = (uintptr_t)chunk;
+    int32_t lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        uintptr_t start = blocks[mid].memory;
+        if (addr < start) {
+            hi = mid - 1;
+        } else if (addr >= (start + (uintptr_t)block_size)) {
+            lo = mid + 1;
+        } else {
+            return &blocks[mid];
+        }
+    }
+    return NULL;
+}
+
+int64_t flecs_ballocator_trim(
+    ecs_block_allocator_t *ba)
+{
+    ecs_assert(ba != NULL, ECS_INTERNAL_ERROR, NULL);
+
+#ifdef FLECS_USE_OS_ALLOC
+    return 0;
+#endif
+
+    if (!ba->head) {
+        return 0; /* No free chunks */
+    }
+
+    int32_t i, block_count = 0;
+    ecs_block_allocator_block_t *block;
+    for (block = ba->block_head; block; block = block->next) {
+        block_count ++;
+    }
+
+    flecs_block_free_t *blocks = ecs_os_malloc_n(
+        flecs_block_free_t, block_count);
+    for (i = 0, block = ba->block_head; block; block = block->next, i ++) {
+        blocks[i].memory = (uintptr_t)block->memory;
+        blocks[i].free_count = 0;
+    }
+
+    ecs_qsort_t(blocks, block_count, flecs_block_free_t, 
+        flecs_block_free_compare);
+
+    /* Count free chunks per block */
+    ecs_block_allocator_chunk_header_t *chunk;
+    for (chunk = ba->head; chunk; chunk = chunk->next) {
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, chunk);
+        ecs_assert(bf != NULL, ECS_INTERNAL_ERROR, NULL);
+        bf->free_count ++;
+    }
+
+    int32_t release_count = 0;
+    for (i = 0; i < block_count; i ++) {
+        ecs_assert(blocks[i].free_count <= ba->chunks_per_block, 
+            ECS_INTERNAL_ERROR, NULL);
+        release_count += blocks[i].free_count == ba->chunks_per_block;
+    }
+
+    if (!release_count) {
+        ecs_os_free(blocks);
+        return 0;
+    }
+
+    /* Remove chunks of released blocks from the free list */
+    ecs_block_allocator_chunk_header_t **prev = &ba->head;
+    for (chunk = ba->head; chunk; chunk = chunk->next) {
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, chunk);
+        if (bf->free_count != ba->chunks_per_block) {
+            *prev = chunk;
+            prev = &chunk->next;
+        }
+    }
+    *prev = NULL;
+
+    /* Unlink & free released blocks */
+    ecs_block_allocator_block_t **prev_block = &ba->block_head;
+    ecs_block_allocator_block_t *next;
+    ba->block_tail = NULL;
+    for (block = ba->block_head; block; block = next) {
+        next = block->next;
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, block->memory);
+        if (bf->free_count == ba->chunks_per_block) {
+            ecs_os_free(block);
+            ecs_os_linc(&ecs_block_allocator_free_count);
+        } else {
+            *prev_block = block;
+            prev_block = &block->next;
+            ba->block_tail = block;
+        }
+    }
+    *prev_block = NULL;
+
+    ecs_os_free(blocks);
+
+    return (int64_t)release_count * (ECS_SIZEOF(ecs_block_allocator_block_t) +
+        ba->block_size + flecs_balloc_align(ba->data_size));
+}
+
 void* flecs_balloc(
     ecs_block_allocator_t *ba) 
 {
@@ -14574,7 +16690,7 @@ void* flecs_balloc(
     ecs_assert(ba->alloc_count >= 0, ECS_INTERNAL_ERROR, "corrupted allocator");
     ba->alloc_count ++;
     *(int64_t*)result = ba->chunk_size;
-    result = ECS_OFFSET(result, ECS_SIZEOF(int64_t));
+    result = ECS_OFFSET(result, flecs_balloc_align(ba->data_size));
     ecs_os_memset(result, 0xAA, ba->data_size);
 #endif
 
@@ -14612,7 +16728,7 @@ void flecs_bfree(
     }
 
 #ifdef FLECS_SANITIZE
-    memory = ECS_OFFSET(memory, -ECS_SIZEOF(int64_t));
+    memory = ECS_OFFSET(memory, -flecs_balloc_align(ba->data_size));
     if (*(int64_t*)memory != ba->chunk_size) {
         ecs_err("chunk %p returned to wrong allocator "
             "(chunk = %ub, allocator = %ub)",
@@ -15026,6 +17142,34 @@ void flecs_stack_reset(
     stack->first.sp = 0;
 }
 
+int64_t flecs_stack_trim(
+    ecs_stack_t *stack)
+{
+    /* Only release pages if nothing is allocated from the stack */
+    if (stack->cur != &stack->first || stack->first.sp) {
+        return 0;
+    }
+
+    int64_t result = 0;
+    ecs_stack_page_t *next, *cur = stack->first.next;
+    for (; cur; cur = next) {
+        next = cur->next;
+        ecs_os_linc(&ecs_stack_allocator_free_count);
+        ecs_os_free(cur);
+        result += FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE;
+    }
+
+    if (stack->first.data) {
+        ecs_os_linc(&ecs_stack_allocator_free_count);
+        ecs_os_free(stack->first.data);
+        result += ECS_STACK_PAGE_SIZE;
+    }
+
+    stack->first.next = NULL;
+    stack->first.data = NULL;
+    return result;
+}
+
 void flecs_stack_init(
     ecs_stack_t *stack)
 {
@@ -15607,6 +17751,9 @@ typedef struct ecs_system_t {
     /* Schedule parameters */
     bool multi_threaded;
     bool no_readonly;
+    bool concurrent;
+    int32_t chunk_size;
+    ecs_worker_cursor_t chunk_cursor; /* Shared between workers */
 
     int64_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
@@ -15655,24 +17802,45 @@ ecs_entity_t ecs_run_intern(
 #define FLECS_PIPELINE_PRIVATE_H
 
 
+/** Number of iterations a thread spins on a sync point before it blocks */
+#ifndef ECS_WORKER_SPIN_COUNT
+#define ECS_WORKER_SPIN_COUNT (1024)
+#endif
+
 /** Instruction data for pipeline.
  * This type is the element type in the "ops" vector of a pipeline and contains
  * information about the set of systems that need to be ran before a merge. */
 typedef struct ecs_pipeline_op_t {
+    int32_t offset;             /* Offset of first system in groups vector */
     int32_t count;              /* Number of systems to run before merge */
     bool multi_threaded;        /* Whether systems can be ran multi threaded */
     bool no_readonly;            /* Whether systems are staged or not */
 } ecs_pipeline_op_t;
 
+/* Number of commands in the queue of a stage after it ran a system */
+typedef struct ecs_pipeline_cmd_cut_t {
+    int32_t system;             /* Index of system in op */
+    int32_t end;                /* Number of commands after system ran */
+} ecs_pipeline_cmd_cut_t;
+
+/* Data that a worker collects while running the systems of an op */
+typedef struct ecs_pipeline_stage_t {
+    ecs_vector_t *cmd_cuts;     /* vector<ecs_pipeline_cmd_cut_t> */
+    ecs_ftime_t system_time;    /* Time spent running systems */
+} ecs_pipeline_stage_t;
+
 typedef struct ecs_pipeline_state_t {
     ecs_query_t *query;         /* Pipeline query */
     ecs_vector_t *ops;          /* Pipeline schedule */
+    ecs_vector_t *groups;       /* Concurrency group for each active system */
     ecs_entity_t last_system;   /* Last system ran by pipeline */
     ecs_id_record_t *idr_inactive; /* Cached record for quick inactive test */
     int32_t match_count;        /* Used to track of rebuild is necessary */
     int32_t rebuild_count;      /* Number of pipeline rebuilds */
     ecs_iter_t *iters;          /* Iterator for worker(s) */
+    ecs_pipeline_stage_t *stages; /* Per worker data (same count as iters) */
     int32_t iter_count;
+    ecs_vector_t *merge_order;  /* vector<ecs_cmd_range_t> */
 
     /* Members for continuing pipeline iteration after pipeline rebuild */
     ecs_pipeline_op_t *cur_op;  /* Current pipeline op */
@@ -15706,6 +17874,14 @@ void flecs_run_pipeline(
     ecs_pipeline_state_t *pq,
     ecs_ftime_t delta_time);
 
+void flecs_pipeline_merge_order(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq);
+
+void flecs_pipeline_system_time(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Worker API
 ////////////////////////////////////////////////////////////////////////////////
@@ -15733,6 +17909,35 @@ typedef struct ecs_worker_state_t {
     ecs_pipeline_state_t *pq;
 } ecs_worker_state_t;
 
+/* Wait until main thread signals workers. Spins for a bounded number of 
+ * iterations before blocking on the condition variable, since for short 
+ * systems the next signal often arrives before a parked thread would have
+ * been woken up. */
+static
+void flecs_worker_wait(
+    ecs_world_t *world,
+    int32_t gen)
+{
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->workers_gen) != gen) {
+            return;
+        }
+    }
+
+    /* The parked counter is incremented before the generation is checked, 
+     * and the main thread increments the generation before it checks the
+     * counter. Either the worker sees the new generation, or the main thread
+     * sees the parked worker and wakes it up. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (ecs_os_aload(&world->workers_gen) == gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* flecs_worker(void *arg) {
@@ -15747,13 +17952,13 @@ void* flecs_worker(void *arg) {
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t gen = world->workers_gen;
+    ecs_os_mutex_unlock(world->sync_mutex);
 
     if (!(world->flags & EcsWorldQuitWorkers)) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        flecs_worker_wait(world, gen);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
 
@@ -15832,16 +18037,43 @@ void flecs_sync_worker(
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
+    /* Read generation before signaling, as the main thread won't signal the
+     * workers before all of them have reached the sync point */
+    int32_t gen = ecs_os_aload(&world->workers_gen);
+
     /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == stage_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    if (ecs_os_ainc(&world->workers_waiting) == stage_count) {
+        /* Only wake up main thread when all threads are waiting */
+        ecs_os_mutex_lock(world->sync_mutex);
+        if (world->sync_parked) {
+            ecs_os_cond_signal(world->sync_cond);
+        }
+        ecs_os_mutex_unlock(world->sync_mutex);
     }
 
-    /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    /* Wait until main thread signals that thread can continue. While workers
+     * are synchronized the main thread can hand out merge jobs. */
+    do {
+        flecs_worker_wait(world, gen);
+        gen = ecs_os_aload(&world->workers_gen);
+
+        /* The job is written before workers_gen is incremented, so the
+         * acquire load of the generation makes it visible */
+        ecs_merge_job_action_t job = world->merge_job;
+        if (!job) {
+            break;
+        }
+
+        job(world, world->merge_job_ctx);
+
+        if (ecs_os_ainc(&world->merge_jobs_done) == stage_count) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            if (world->sync_parked) {
+                ecs_os_cond_signal(world->sync_cond);
+            }
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+    } while (true);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -15853,17 +18085,27 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != stage_count) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->workers_waiting) == stage_count) {
+            break;
+        }
     }
-    
+
+    if (i == ECS_WORKER_SPIN_COUNT) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        world->sync_parked = true;
+        while (ecs_os_aload(&world->workers_waiting) != stage_count) {
+            ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+        }
+        world->sync_parked = false;
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+
     /* We should have been signalled unless all workers are waiting on sync */
     ecs_assert(world->workers_waiting == stage_count, 
         ECS_INTERNAL_ERROR, NULL);
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     ecs_dbg_3("#[bold]pipeline: workers synced");
 }
 
@@ -15873,9 +18115,55 @@ void flecs_signal_workers(
     ecs_world_t *world)
 {
     ecs_dbg_3("#[bold]pipeline: signal workers");
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+
+    /* Workers that are still spinning pick up the new generation without
+     * having to go through the mutex. The mutex is only taken when workers
+     * are parked on the condition variable. */
+    ecs_os_ainc(&world->workers_gen);
+
+    if (ecs_os_aload(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+}
+
+/* Run merge job on synchronized workers and the main thread */
+static
+void flecs_workers_run_merge_job(
+    ecs_world_t *world,
+    ecs_merge_job_action_t job,
+    void *ctx)
+{
+    int32_t stage_count = ecs_get_stage_count(world);
+
+    world->merge_job = job;
+    world->merge_job_ctx = ctx;
+    world->merge_jobs_done = 0;
+    flecs_signal_workers(world);
+
+    job(world, ctx);
+
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->merge_jobs_done) == stage_count) {
+            break;
+        }
+    }
+
+    if (i == ECS_WORKER_SPIN_COUNT) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        world->sync_parked = true;
+        while (ecs_os_aload(&world->merge_jobs_done) != stage_count) {
+            ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+        }
+        world->sync_parked = false;
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+
+    /* Workers wake up from the next signal without running the job again */
+    world->merge_job = NULL;
+    world->merge_job_ctx = NULL;
 }
 
 /** Stop workers */
@@ -16017,7 +18305,16 @@ void flecs_workers_progress(
     int32_t stage_count = ecs_get_stage_count(world);
 
     if (stage_count != pq->iter_count) {
+        int32_t i;
+        for (i = stage_count; i < pq->iter_count; i ++) {
+            ecs_vector_free(pq->stages[i].cmd_cuts);
+        }
         pq->iters = ecs_os_realloc_n(pq->iters, ecs_iter_t, stage_count);
+        pq->stages = ecs_os_realloc_n(
+            pq->stages, ecs_pipeline_stage_t, stage_count);
+        for (i = pq->iter_count; i < stage_count; i ++) {
+            ecs_os_zeromem(&pq->stages[i]);
+        }
         pq->iter_count = stage_count;
     }
 
@@ -16057,9 +18354,20 @@ void flecs_workers_progress(
             /* Wait until all workers are waiting on sync point */
             flecs_wait_for_sync(world);
 
-            /* Merge */
+            if (world->flags & EcsWorldMeasureSystemTime) {
+                flecs_pipeline_system_time(world, pq);
+            }
+
+            /* Merge. Workers are synchronized, so they can help with writing
+             * values when parallel merging is enabled. Commands are merged in
+             * the order in which their systems appear in the pipeline. */
             if (!op->no_readonly) {
+                flecs_pipeline_merge_order(world, pq);
+                world->merge_run = flecs_workers_run_merge_job;
                 ecs_readonly_end(world);
+                world->merge_run = NULL;
+                world->merge_order = NULL;
+                world->merge_order_count = 0;
             }
             if (is_threaded) {
                 world->flags |= EcsWorldMultiThreaded;
@@ -16116,8 +18424,15 @@ void ecs_set_threads(
 #ifdef FLECS_PIPELINE
 
 static ECS_DTOR(EcsPipeline, ptr, {
+    int32_t s;
+    for (s = 0; s < ptr->state->iter_count; s ++) {
+        ecs_vector_free(ptr->state->stages[s].cmd_cuts);
+    }
     ecs_vector_free(ptr->state->ops);
+    ecs_vector_free(ptr->state->groups);
+    ecs_vector_free(ptr->state->merge_order);
     ecs_os_free(ptr->state->iters);
+    ecs_os_free(ptr->state->stages);
 })
 
 typedef enum ecs_write_kind_t {
@@ -16322,6 +18637,193 @@ bool flecs_pipeline_check_terms(
     return needs_merge;
 }
 
+/* Get whether term accesses component data, and if so, whether it writes */
+static
+bool flecs_pipeline_term_access(
+    ecs_term_t *term,
+    bool *write_out)
+{
+    if (term->oper == EcsNot) {
+        return false;
+    }
+
+    bool from_any = ecs_term_match_0(term);
+    bool from_this = ecs_term_match_this(term);
+    bool is_shared = !from_any && 
+        (!from_this || !(term->src.flags & EcsSelf));
+
+    ecs_inout_kind_t inout = term->inout;
+    if (inout == EcsInOutDefault) {
+        if (from_any) {
+            return false;
+        } else if (is_shared) {
+            inout = EcsIn;
+        } else {
+            inout = EcsInOut;
+        }
+    }
+
+    if (inout == EcsInOutNone) {
+        return false;
+    }
+
+    /* Writes to terms without a source are deferred, and don't modify the 
+     * storage while systems are running */
+    *write_out = !from_any && (inout == EcsOut || inout == EcsInOut);
+
+    return true;
+}
+
+/* Test if two systems access the same component, with at least one write */
+static
+bool flecs_pipeline_systems_conflict(
+    ecs_system_t *sys_a,
+    ecs_system_t *sys_b)
+{
+    ecs_filter_t *filter_a = &sys_a->query->filter;
+    ecs_filter_t *filter_b = &sys_b->query->filter;
+    int32_t a, b;
+
+    for (a = 0; a < filter_a->term_count; a ++) {
+        ecs_term_t *term_a = &filter_a->terms[a];
+        bool write_a;
+        if (!flecs_pipeline_term_access(term_a, &write_a)) {
+            continue;
+        }
+
+        for (b = 0; b < filter_b->term_count; b ++) {
+            ecs_term_t *term_b = &filter_b->terms[b];
+            bool write_b;
+            if (!flecs_pipeline_term_access(term_b, &write_b)) {
+                continue;
+            }
+
+            if (!write_a && !write_b) {
+                continue;
+            }
+
+            if (ecs_id_match(term_a->id, term_b->id) || 
+                ecs_id_match(term_b->id, term_a->id)) 
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Scheduling data for active system while building the pipeline */
+typedef struct ecs_pipeline_sched_t {
+    ecs_system_t *system;
+    int32_t parent;             /* Parent in set of conflicting systems */
+    bool pinned;                /* Must run on main thread */
+} ecs_pipeline_sched_t;
+
+static
+int32_t flecs_pipeline_sched_root(
+    ecs_pipeline_sched_t *sched,
+    int32_t index)
+{
+    while (sched[index].parent != index) {
+        index = sched[index].parent = sched[sched[index].parent].parent;
+    }
+    return index;
+}
+
+static
+void flecs_pipeline_sched_union(
+    ecs_pipeline_sched_t *sched,
+    int32_t a,
+    int32_t b)
+{
+    a = flecs_pipeline_sched_root(sched, a);
+    b = flecs_pipeline_sched_root(sched, b);
+    if (a > b) {
+        int32_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    /* Root is always the first system of the set. A set is pinned if any of
+     * its systems is pinned. */
+    if (a != b) {
+        sched[b].parent = a;
+        sched[a].pinned |= sched[b].pinned;
+    }
+}
+
+/* Add active system to schedule. Systems in the same op that access the same
+ * components are added to the same set, so they run in order on one worker. */
+static
+void flecs_pipeline_sched_add(
+    ecs_vector_t **sched_vec,
+    ecs_pipeline_op_t *op,
+    ecs_system_t *sys)
+{
+    ecs_pipeline_sched_t *elem = ecs_vector_add(
+        sched_vec, ecs_pipeline_sched_t);
+    int32_t i, index = ecs_vector_count(*sched_vec) - 1;
+    elem->system = sys;
+    elem->parent = index;
+    elem->pinned = !sys->concurrent || op->no_readonly;
+
+    if (op->multi_threaded) {
+        return;
+    }
+
+    ecs_pipeline_sched_t *sched = ecs_vector_first(
+        *sched_vec, ecs_pipeline_sched_t);
+    elem = &sched[index];
+
+    for (i = op->offset; i < index; i ++) {
+        if (flecs_pipeline_systems_conflict(sched[i].system, sys)) {
+            flecs_pipeline_sched_union(sched, i, index);
+        }
+    }
+}
+
+/* Assign group to each system. Systems in group 0 run on the main thread, 
+ * other groups are distributed across workers. */
+static
+ecs_vector_t* flecs_pipeline_sched_groups(
+    ecs_vector_t *sched_vec,
+    ecs_vector_t *ops)
+{
+    ecs_vector_t *result = NULL;
+    ecs_pipeline_sched_t *sched = ecs_vector_first(
+        sched_vec, ecs_pipeline_sched_t);
+    int32_t i, count = ecs_vector_count(sched_vec);
+    if (!count) {
+        return NULL;
+    }
+
+    ecs_vector_set_count(&result, int32_t, count);
+    int32_t *groups = ecs_vector_first(result, int32_t);
+
+    ecs_pipeline_op_t *op = ecs_vector_first(ops, ecs_pipeline_op_t);
+    int32_t o, op_count = ecs_vector_count(ops);
+    for (o = 0; o < op_count; o ++) {
+        int32_t first = op[o].offset, last = first + op[o].count;
+        int32_t group_count = 1;
+
+        for (i = first; i < last; i ++) {
+            int32_t root = flecs_pipeline_sched_root(sched, i);
+            if (op[o].multi_threaded) {
+                groups[i] = 0;
+            } else if (root != i) {
+                groups[i] = groups[root];
+            } else if (sched[i].pinned) {
+                groups[i] = 0;
+            } else {
+                groups[i] = group_count ++;
+            }
+        }
+    }
+
+    return result;
+}
+
 static
 bool flecs_pipeline_is_inactive(
     const ecs_pipeline_state_t *pq,
@@ -16366,11 +18868,15 @@ bool flecs_pipeline_build(
 
     ecs_pipeline_op_t *op = NULL;
     ecs_vector_t *ops = NULL;
+    ecs_vector_t *sched = NULL;
     ecs_query_t *query = pq->query;
 
     if (pq->ops) {
         ecs_vector_free(pq->ops);
     }
+    if (pq->groups) {
+        ecs_vector_free(pq->groups);
+    }
 
     bool multi_threaded = false;
     bool no_readonly = false;
@@ -16444,6 +18950,7 @@ bool flecs_pipeline_build(
 
             if (!op) {
                 op = ecs_vector_add(&ops, ecs_pipeline_op_t);
+                op->offset = ecs_vector_count(sched);
                 op->count = 0;
                 op->multi_threaded = false;
                 op->no_readonly = false;
@@ -16456,6 +18963,7 @@ bool flecs_pipeline_build(
                     op->multi_threaded = multi_threaded;
                     op->no_readonly = no_readonly;
                 }
+                flecs_pipeline_sched_add(&sched, op, sys);
                 op->count ++;
             }
         }
@@ -16464,6 +18972,9 @@ bool flecs_pipeline_build(
     ecs_map_free(ws.ids);
     ecs_map_free(ws.wildcard_ids);
 
+    pq->groups = flecs_pipeline_sched_groups(sched, ops);
+    ecs_vector_free(sched);
+
     /* Find the system ran last this frame (helps workers reset iter) */
     ecs_entity_t last_system = 0;
     op = ecs_vector_first(ops, ecs_pipeline_op_t);
@@ -16483,6 +18994,8 @@ bool flecs_pipeline_build(
             op->multi_threaded, !op->no_readonly);
         ecs_log_push_1();
 
+        int32_t *groups = ecs_vector_first(pq->groups, int32_t);
+
         it = ecs_query_iter(world, pq->query);
         while (ecs_query_next(&it)) {
             if (flecs_pipeline_is_inactive(pq, it.table)) {
@@ -16495,7 +19008,14 @@ bool flecs_pipeline_build(
                 ecs_system_t *sys = ecs_poly(poly[i].poly, ecs_system_t);
                 if (ecs_should_log_1()) {
                     char *path = ecs_get_fullpath(world, it.entities[i]);
-                    ecs_dbg("#[green]system#[reset] %s", path);
+                    int32_t group = groups[
+                        op[op_index].offset + ran_since_merge];
+                    if (group) {
+                        ecs_dbg("#[green]system#[reset] %s (group %d)", 
+                            path, group);
+                    } else {
+                        ecs_dbg("#[green]system#[reset] %s", path);
+                    }
                     ecs_os_free(path);
                 }
 
@@ -16658,6 +19178,20 @@ void ecs_run_pipeline(
     flecs_run_pipeline(world, pq->state, delta_time);
 }
 
+static
+void flecs_pipeline_add_time(
+    ecs_world_t *world,
+    ecs_pipeline_stage_t *ps,
+    ecs_time_t *st)
+{
+    ecs_ftime_t t = (ecs_ftime_t)ecs_time_measure(st);
+    if (ps) {
+        ps->system_time += t;
+    } else {
+        world->info.system_time_total += t;
+    }
+}
+
 void flecs_run_pipeline(
     ecs_world_t *world,
     ecs_pipeline_state_t *pq,
@@ -16696,9 +19230,17 @@ void flecs_run_pipeline(
 
     flecs_worker_begin(stage->thread_ctx);
 
+    /* Workers measure their own system time, which the main thread collects
+     * when it merges. Commands are cut after each system, so that the main
+     * thread can merge them in pipeline order. */
+    ecs_pipeline_stage_t *ps = NULL;
+    if (stage_count > 1) {
+        ps = &pq->stages[stage_index];
+    }
+
     ecs_time_t st = {0};
     bool measure_time = false;
-    if (!stage_index && (world->flags & EcsWorldMeasureSystemTime)) {
+    if (world->flags & EcsWorldMeasureSystemTime) {
         ecs_time_measure(&st);
         measure_time = true;
     }
@@ -16719,7 +19261,16 @@ void flecs_run_pipeline(
 
             sys->last_frame = world->info.frame_count_total + 1;
 
-            if (!stage_index || op->multi_threaded) {
+            /* Single threaded systems run on the worker assigned to their 
+             * group. Group 0 always runs on the main thread. */
+            bool run_system = op->multi_threaded;
+            if (!run_system) {
+                int32_t *groups = ecs_vector_first(pq->groups, int32_t);
+                int32_t group = groups[op->offset + ran_since_merge];
+                run_system = (group % stage_count) == stage_index;
+            }
+
+            if (run_system) {
                 ecs_stage_t *s = NULL;
                 if (!op->no_readonly) {
                     s = stage;
@@ -16727,6 +19278,13 @@ void flecs_run_pipeline(
 
                 ecs_run_intern(world, s, e, sys, stage_index, 
                     stage_count, delta_time, 0, 0, NULL);
+
+                if (ps && s) {
+                    ecs_pipeline_cmd_cut_t *cut = ecs_vector_add(
+                        &ps->cmd_cuts, ecs_pipeline_cmd_cut_t);
+                    cut->system = ran_since_merge;
+                    cut->end = flecs_stage_cmd_cut(s);
+                }
             }
 
             ran_since_merge ++;
@@ -16740,8 +19298,7 @@ void flecs_run_pipeline(
 
                 if (measure_time) {
                     /* Don't include merge time in system time */
-                    world->info.system_time_total += 
-                        (ecs_ftime_t)ecs_time_measure(&st);
+                    flecs_pipeline_add_time(world, ps, &st);
                 }
 
                 ran_since_merge = 0;
@@ -16772,12 +19329,117 @@ void flecs_run_pipeline(
 
 done:
     if (measure_time) {
-        world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
+        flecs_pipeline_add_time(world, ps, &st);
     }
 
     flecs_worker_end(stage->thread_ctx);
 }
 
+void flecs_pipeline_merge_order(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq)
+{
+    int32_t s, stage_count = pq->iter_count;
+    ecs_pipeline_stage_t *stages = pq->stages;
+
+    ecs_vector_clear(pq->merge_order);
+
+    /* Stages that don't auto merge are merged by the application */
+    bool ordered = true;
+    for (s = 0; s < stage_count; s ++) {
+        if (!world->stages[s].auto_merge) {
+            ordered = false;
+        }
+    }
+
+    int32_t *cur = flecs_walloc_n(world, int32_t, stage_count);
+    int32_t *end = flecs_walloc_n(world, int32_t, stage_count);
+    for (s = 0; s < stage_count; s ++) {
+        cur[s] = 0;
+        end[s] = 0;
+    }
+
+    /* Each worker ran its systems in pipeline order, so the cuts of a stage
+     * are sorted by system. Take the commands of the earliest system from all
+     * stages until all cuts are processed. If a multi threaded system ran on
+     * multiple stages, its commands are merged in stage order. */
+    while (ordered) {
+        int32_t stage = -1, system = 0;
+        for (s = 0; s < stage_count; s ++) {
+            ecs_vector_t *cuts = stages[s].cmd_cuts;
+            if (cur[s] == ecs_vector_count(cuts)) {
+                continue;
+            }
+
+            ecs_pipeline_cmd_cut_t *cut = ecs_vector_get(
+                cuts, ecs_pipeline_cmd_cut_t, cur[s]);
+            if (stage == -1 || cut->system < system) {
+                stage = s;
+                system = cut->system;
+            }
+        }
+
+        if (stage == -1) {
+            break;
+        }
+
+        ecs_pipeline_cmd_cut_t *cut = ecs_vector_get(
+            stages[stage].cmd_cuts, ecs_pipeline_cmd_cut_t, cur[stage]);
+        if (cut->end != end[stage]) {
+            ecs_cmd_range_t *range = ecs_vector_add(
+                &pq->merge_order, ecs_cmd_range_t);
+            range->stage = stage;
+            range->first = end[stage];
+            range->count = cut->end - end[stage];
+            end[stage] = cut->end;
+        }
+
+        cur[stage] ++;
+    }
+
+    /* Commands that weren't added by a system are merged last */
+    for (s = 0; s < stage_count; s ++) {
+        int32_t count = ecs_vec_count(&world->stages[s].commands);
+        if (ordered && (count != end[s])) {
+            ecs_cmd_range_t *range = ecs_vector_add(
+                &pq->merge_order, ecs_cmd_range_t);
+            range->stage = s;
+            range->first = end[s];
+            range->count = count - end[s];
+        }
+
+        ecs_vector_clear(stages[s].cmd_cuts);
+    }
+
+    flecs_wfree_n(world, int32_t, stage_count, end);
+    flecs_wfree_n(world, int32_t, stage_count, cur);
+
+    if (ordered) {
+        world->merge_order = ecs_vector_first(
+            pq->merge_order, ecs_cmd_range_t);
+        world->merge_order_count = ecs_vector_count(pq->merge_order);
+    }
+}
+
+void flecs_pipeline_system_time(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq)
+{
+    /* Workers run systems at the same time, so the time spent in the systems
+     * of an op is the time of the worker that took the longest. */
+    ecs_ftime_t max = 0;
+    int32_t s, stage_count = pq->iter_count;
+    for (s = 0; s < stage_count; s ++) {
+        ecs_pipeline_stage_t *ps = &pq->stages[s];
+        if (ps->system_time > max) {
+            max = ps->system_time;
+        }
+        ps->system_time = 0;
+    }
+
+    world->info.system_time_total += max;
+}
+
 bool ecs_progress(
     ecs_world_t *world,
     ecs_ftime_t user_delta_time)
@@ -18075,6 +20737,15 @@ int64_t win_ladec(
     return InterlockedDecrement64(count);
 }
 
+static
+int32_t win_aload(
+    const int32_t *value) 
+{
+    /* Compare exchange with equal values doesn't modify the value, and acts
+     * as a full barrier */
+    return InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
 static
 ecs_os_mutex_t win_mutex_new(void) {
     CRITICAL_SECTION *mutex = ecs_os_malloc_t(CRITICAL_SECTION);
@@ -18258,6 +20929,7 @@ void ecs_set_os_api_impl(void) {
     api.adec_ = win_adec;
     api.lainc_ = win_lainc;
     api.ladec_ = win_ladec;
+    api.aload_ = win_aload;
     api.mutex_new_ = win_mutex_new;
     api.mutex_free_ = win_mutex_free;
     api.mutex_lock_ = win_mutex_lock;
@@ -18372,6 +21044,18 @@ int64_t posix_ladec(
 #endif
 }
 
+static
+int32_t posix_aload(
+    const int32_t *value) 
+{
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
 static
 ecs_os_mutex_t posix_mutex_new(void) {
     pthread_mutex_t *mutex = ecs_os_malloc(sizeof(pthread_mutex_t));
@@ -18550,6 +21234,7 @@ void ecs_set_os_api_impl(void) {
     api.adec_ = posix_adec;
     api.lainc_ = posix_lainc;
     api.ladec_ = posix_ladec;
+    api.aload_ = posix_aload;
     api.mutex_new_ = posix_mutex_new;
     api.mutex_free_ = posix_mutex_free;
     api.mutex_lock_ = posix_mutex_lock;
@@ -19965,6 +22650,11 @@ typedef struct ecs_rule_with_ctx_t {
     ecs_id_record_t *idr;      /* Currently evaluated table set */
     ecs_table_cache_iter_t it;
     int32_t column;
+
+    /* Partitioning state of select for worker iterators */
+    ecs_table_t *worker_table; /* Last table found by select */
+    int32_t worker_tables;     /* Number of tables found by select */
+    bool worker_owned;         /* Is last table owned by current worker */
 } ecs_rule_with_ctx_t;
 
 /* Subset context */
@@ -19976,9 +22666,10 @@ typedef struct ecs_rule_subset_frame_t {
 } ecs_rule_subset_frame_t;
 
 typedef struct ecs_rule_subset_ctx_t {
-    ecs_rule_subset_frame_t storage[16]; /* Alloc-free array for small trees */
-    ecs_rule_subset_frame_t *stack;
+    ecs_vec_t stack;                     /* vec<ecs_rule_subset_frame_t> */
     int32_t sp;
+    ecs_subset_tables_t *closure;        /* Tables of transitive closure */
+    int32_t closure_index;               /* Current element in closure */
 } ecs_rule_subset_ctx_t;
 
 /* Superset context */
@@ -19988,8 +22679,7 @@ typedef struct ecs_rule_superset_frame_t {
 } ecs_rule_superset_frame_t;
 
 typedef struct ecs_rule_superset_ctx_t {
-    ecs_rule_superset_frame_t storage[16]; /* Alloc-free array for small trees */
-    ecs_rule_superset_frame_t *stack;
+    ecs_vec_t stack;                     /* vec<ecs_rule_superset_frame_t> */
     ecs_id_record_t *idr;
     int32_t sp;
 } ecs_rule_superset_ctx_t;
@@ -20034,6 +22724,36 @@ typedef struct ecs_rule_term_vars_t {
     int32_t second;
 } ecs_rule_term_vars_t;
 
+/* Table cached rule results depend on, with the value of its entity counter 
+ * (dirty_state[0]) at the time the results were cached */
+typedef struct ecs_rule_cache_table_t {
+    ecs_table_t *table;
+    int32_t dirty_state;
+} ecs_rule_cache_table_t;
+
+/* Results of rules created with EcsFilterCacheResults. Results are stored as
+ * the register and column frames of the yield operation, so that replaying a
+ * result is the same as yielding it from the program. Iterators that replay
+ * results hold a reference, so that results aren't modified or freed while
+ * they are replayed. Results don't use the world allocator, since the last
+ * reference can be released by a worker thread. */
+typedef struct ecs_rule_cache_results_t {
+    ecs_vector_t *registers;    /* vector<ecs_var_t>, var_count per result */
+    ecs_vector_t *columns;      /* vector<int32_t>, term_count per result */
+    int32_t count;              /* Number of cached results */
+    int32_t refs;               /* Cache + number of replaying iterators */
+} ecs_rule_cache_results_t;
+
+/* Result cache. A new fill populates a separate results object, which
+ * replaces the current results when all results have been stored. */
+typedef struct ecs_rule_cache_t {
+    ecs_rule_cache_results_t *results; /* Results that can be replayed */
+    ecs_rule_cache_results_t *filling; /* Results that are being populated */
+    ecs_vec_t tables;           /* vec<ecs_rule_cache_table_t> */
+    int64_t table_stamp;        /* Table create + delete count at fill time */
+    bool valid;                 /* Can cache be replayed */
+} ecs_rule_cache_t;
+
 /* Top-level rule datastructure */
 struct ecs_rule_t {
     ecs_header_t hdr;
@@ -20059,6 +22779,8 @@ struct ecs_rule_t {
     int32_t frame_count;        /* Number of register frames */
     int32_t operation_count;    /* Number of operations in rule */
 
+    ecs_rule_cache_t *cache;    /* Result cache (EcsFilterCacheResults) */
+
     ecs_iterable_t iterable;    /* Iterable mixin */
 };
 
@@ -22552,12 +25274,32 @@ ecs_rule_t* ecs_rule_init(
 
     result->iterable.init = rule_iter_init;
 
+    if (ECS_BIT_IS_SET(result->filter.flags, EcsFilterCacheResults)) {
+        ecs_allocator_t *a = &((ecs_world_t*)ecs_get_world(world))->allocator;
+        ecs_rule_cache_t *cache = result->cache = 
+            ecs_os_calloc_t(ecs_rule_cache_t);
+        ecs_vec_init_t(a, &cache->tables, ecs_rule_cache_table_t, 0);
+    }
+
     return result;
 error:
     ecs_rule_fini(result);
     return NULL;
 }
 
+/* Release reference to cached results. Results are freed when the cache and
+ * all iterators that replay them have released them. */
+static
+void flecs_rule_cache_results_release(
+    ecs_rule_cache_results_t *results)
+{
+    if (results && !ecs_os_adec(&results->refs)) {
+        ecs_vector_free(results->registers);
+        ecs_vector_free(results->columns);
+        ecs_os_free(results);
+    }
+}
+
 void ecs_rule_fini(
     ecs_rule_t *rule)
 {
@@ -22566,6 +25308,16 @@ void ecs_rule_fini(
         ecs_os_free(rule->vars[i].name);
     }
 
+    ecs_rule_cache_t *cache = rule->cache;
+    if (cache) {
+        ecs_allocator_t *a = 
+            &((ecs_world_t*)ecs_get_world(rule->world))->allocator;
+        flecs_rule_cache_results_release(cache->results);
+        flecs_rule_cache_results_release(cache->filling);
+        ecs_vec_fini_t(a, &cache->tables, ecs_rule_cache_table_t);
+        ecs_os_free(cache);
+    }
+
     ecs_filter_fini(&rule->filter);
 
     ecs_os_free(rule->operations);
@@ -22771,11 +25523,240 @@ bool ecs_rule_var_is_entity(
     return rule->vars[var_id].kind == EcsRuleVarKindEntity;
 }
 
+/* Returns the id record an id with variables and Any resolves to. Results for
+ * the id can only change when the tables of this id record change. */
+static
+ecs_id_t flecs_rule_cache_id(
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = ECS_PAIR_FIRST(id);
+        ecs_entity_t second = ECS_PAIR_SECOND(id);
+        if (first == EcsAny) {
+            first = EcsWildcard;
+        }
+        if (second == EcsAny) {
+            second = EcsWildcard;
+        }
+        return ecs_pair(first, second);
+    } else if (id == EcsAny) {
+        return EcsWildcard;
+    }
+    return id;
+}
+
+/* Store the tables of an id, so that changes to them invalidate the cache */
+static
+bool flecs_rule_cache_add_tables(
+    ecs_world_t *world,
+    ecs_rule_cache_t *cache,
+    ecs_id_t id)
+{
+    id = flecs_rule_cache_id(id);
+
+    /* The target of a union relationship can change without the entity
+     * changing tables, which isn't tracked by the cache. */
+    if (ECS_IS_PAIR(id) && flecs_id_record_get(
+        world, ecs_pair(EcsUnion, ECS_PAIR_FIRST(id))))
+    {
+        return false;
+    }
+
+    ecs_id_record_t *idr = flecs_query_id_record_get(world, id);
+    if (!idr) {
+        /* Tables created for the id will change the table stamp */
+        return true;
+    }
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_all_iter(&idr->cache, &it)) {
+        ecs_allocator_t *a = &world->allocator;
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+            ecs_rule_cache_table_t *elem = ecs_vec_append_t(
+                a, &cache->tables, ecs_rule_cache_table_t);
+            elem->table = table;
+            elem->dirty_state = dirty_state[0];
+        }
+    }
+
+    return true;
+}
+
+/* Start populating the cache. The tables the results depend on are stored
+ * before evaluating the rule, so that changes made while the iterator is 
+ * active invalidate the results. */
+static
+bool flecs_rule_cache_fill_begin(
+    ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_assert(cache != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (cache->filling) {
+        return false;
+    }
+
+    /* Iterators that are replaying the current results keep their reference
+     * to it, new results are stored in a separate object. */
+    ecs_vec_clear(&cache->tables);
+    cache->valid = false;
+
+    const ecs_filter_t *filter = &rule->filter;
+    int32_t i, term_count = filter->term_count;
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        if (!flecs_rule_cache_add_tables(world, cache, term->id)) {
+            return false;
+        }
+
+        /* Terms that traverse relationships also depend on the tables with
+         * the traversed relationship */
+        ecs_term_id_t *ids[3] = { &term->first, &term->src, &term->second };
+        int32_t t;
+        for (t = 0; t < 3; t ++) {
+            ecs_term_id_t *term_id = ids[t];
+            if (term_id->trav && (term_id->flags & (EcsUp|EcsDown))) {
+                if (!flecs_rule_cache_add_tables(world, cache, 
+                    ecs_pair(term_id->trav, EcsWildcard))) 
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    cache->table_stamp = world->info.table_create_total + 
+        world->info.table_delete_total;
+
+    cache->filling = ecs_os_calloc_t(ecs_rule_cache_results_t);
+    cache->filling->refs = 1;
+
+    return true;
+}
+
+/* Store result that's about to be yielded by the yield operation */
+static
+void flecs_rule_cache_append(
+    ecs_rule_iter_t *it,
+    ecs_rule_op_t *op)
+{
+    const ecs_rule_t *rule = it->rule;
+    ecs_rule_cache_results_t *results = rule->cache->filling;
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+
+    if (var_count) {
+        ecs_var_t *regs = ecs_vector_addn(
+            &results->registers, ecs_var_t, var_count);
+        ecs_os_memcpy_n(regs, get_register_frame(it, op->frame), 
+            ecs_var_t, var_count);
+    }
+
+    if (term_count) {
+        int32_t *columns = ecs_vector_addn(
+            &results->columns, int32_t, term_count);
+        ecs_os_memcpy_n(columns, rule_get_columns_frame(it, op->frame), 
+            int32_t, term_count);
+    }
+
+    results->count ++;
+}
+
+/* Results are valid if no tables were created or deleted, and none of the 
+ * tables the results depend on gained or lost entities. */
+static
+bool flecs_rule_cache_is_valid(
+    const ecs_world_t *world,
+    const ecs_rule_cache_t *cache)
+{
+    if (!cache->valid) {
+        return false;
+    }
+
+    int64_t table_stamp = world->info.table_create_total + 
+        world->info.table_delete_total;
+    if (cache->table_stamp != table_stamp) {
+        return false;
+    }
+
+    const ecs_rule_cache_table_t *tables = ecs_vec_first(&cache->tables);
+    int32_t i, count = ecs_vec_count(&cache->tables);
+    for (i = 0; i < count; i ++) {
+        const ecs_rule_cache_table_t *elem = &tables[i];
+        if (elem->table->dirty_state[0] != elem->dirty_state) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Allocator for data owned by the iterator. Uses the allocator of the stage,
+ * since rules can be iterated from multiple threads. */
+static
+ecs_allocator_t* flecs_rule_iter_allocator(
+    const ecs_iter_t *it)
+{
+    ecs_world_t *world = it->world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    return &stage->allocator;
+}
+
+/* Get frame from subset or superset stack, grow stack if necessary */
+static
+void* flecs_rule_stack_frame(
+    const ecs_iter_t *it,
+    ecs_vec_t *stack,
+    ecs_size_t size,
+    int32_t sp)
+{
+    if (sp >= ecs_vec_count(stack)) {
+        ecs_vec_set_count(flecs_rule_iter_allocator(it), stack, size, sp + 1);
+    }
+    return ecs_vec_get(stack, size, sp);
+}
+
+#define flecs_rule_stack_frame_t(it, stack, T, sp)\
+    ECS_CAST(T*, flecs_rule_stack_frame(it, stack, ECS_SIZEOF(T), sp))
+
 static
 void ecs_rule_iter_free(
     ecs_iter_t *iter)
 {
     ecs_rule_iter_t *it = &iter->priv.iter.rule;
+    const ecs_rule_t *rule = it->rule;
+
+    if (it->op_ctx) {
+        ecs_allocator_t *a = flecs_rule_iter_allocator(iter);
+        int32_t i;
+        for (i = 0; i < rule->operation_count; i ++) {
+            ecs_rule_op_kind_t kind = rule->operations[i].kind;
+            if (kind == EcsRuleSubSet) {
+                ecs_vec_fini_t(a, &it->op_ctx[i].is.subset.stack, 
+                    ecs_rule_subset_frame_t);
+                flecs_subset_tables_release(it->op_ctx[i].is.subset.closure);
+            } else if (kind == EcsRuleSuperSet) {
+                ecs_vec_fini_t(a, &it->op_ctx[i].is.superset.stack, 
+                    ecs_rule_superset_frame_t);
+            }
+        }
+    }
+
+    if (it->fill_cache) {
+        /* Iterator was stopped before all results were stored */
+        ecs_rule_cache_t *cache = it->rule->cache;
+        it->fill_cache = false;
+        flecs_rule_cache_results_release(cache->filling);
+        cache->filling = NULL;
+    }
+
+    flecs_rule_cache_results_release(it->cached);
+    it->cached = NULL;
+
     ecs_os_free(it->registers);
     ecs_os_free(it->columns);
     ecs_os_free(it->op_ctx);
@@ -22823,6 +25804,7 @@ ecs_iter_t ecs_rule_iter(
     }
 
     it->op = 0;
+    it->cached_result = -1;
 
     for (i = 0; i < rule->var_count; i ++) {
         if (rule->vars[i].kind == EcsRuleVarKindEntity) {
@@ -22855,6 +25837,37 @@ ecs_iter_t ecs_rule_iter(
     return result;
 }
 
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_rule_iter(world, rule);
+    ecs_rule_iter_t *it = &result.priv.iter.rule;
+    it->worker_index = index;
+    it->worker_count = count;
+    it->worker_op = -1;
+
+    /* Partition the program at its first select operation, so that only the
+     * remainder of the program is evaluated for the tables of a worker */
+    int32_t i;
+    for (i = 0; i < rule->operation_count; i ++) {
+        if (rule->operations[i].kind == EcsRuleSelect) {
+            it->worker_op = i;
+            break;
+        }
+    }
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
 /* Edge case: if the filter has the same variable for both predicate and
  * object, they are both resolved at the same time but at the time of 
  * evaluating the filter they're still wildcards which would match columns
@@ -23092,9 +26105,11 @@ bool eval_superset(
     }
 
     if (!redo) {
-        op_ctx->stack = op_ctx->storage;
+        ecs_vec_reset_t(flecs_rule_iter_allocator(it), &op_ctx->stack, 
+            ecs_rule_superset_frame_t);
         sp = op_ctx->sp = 0;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_superset_frame_t, sp);
 
         /* Get table of object for which to get supersets */
         ecs_entity_t second = ECS_PAIR_SECOND(filter.mask);
@@ -23145,7 +26160,7 @@ bool eval_superset(
     }
 
     sp = op_ctx->sp;
-    frame = &op_ctx->stack[sp];
+    frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_superset_frame_t, sp);
     table = frame->table;
     int32_t column = frame->column;
 
@@ -23155,13 +26170,14 @@ bool eval_superset(
 
     if (next_table) {
         sp ++;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_superset_frame_t, sp);
         frame->table = next_table;
         frame->column = -1;
     }
 
     do {
-        frame = &op_ctx->stack[sp];
+        frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_superset_frame_t, sp);
         table = frame->table;
         column = frame->column;
 
@@ -23181,6 +26197,329 @@ bool eval_superset(
     return false;
 }
 
+/* Closure is up to date if no tables were created and no targets moved to 
+ * another table since it was last used. */
+static
+bool flecs_rule_subsets_valid(
+    const ecs_subset_cache_t *cache)
+{
+    return !ecs_vec_count(&cache->created) && !ecs_vec_count(&cache->moved);
+}
+
+/* Add (R, member) pair of table to closure. Tables are yielded once for each
+ * pair, like when walking the hierarchy. Returns true if the table was not
+ * yet in the closure. */
+static
+bool flecs_rule_subsets_add_pair(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table,
+    int32_t column)
+{
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    ecs_subset_elem_t *elem = ecs_vector_add(
+        &tables->tables, ecs_subset_elem_t);
+    elem->table = table;
+    elem->column = column;
+
+    int32_t *refs = ecs_map_ensure(&cache->table_refs, int32_t, table->id);
+    return !(refs[0] ++);
+}
+
+/* Remove (R, member) pair of table from closure. Returns true if the table is
+ * no longer in the closure. */
+static
+bool flecs_rule_subsets_remove_pair(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table,
+    int32_t column)
+{
+    int32_t *refs = ecs_map_get(&cache->table_refs, int32_t, table->id);
+    if (!refs) {
+        return false;
+    }
+
+    if (!(-- refs[0])) {
+        flecs_subset_cache_remove_table(cache, table);
+        return true;
+    }
+
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    int32_t i, count = ecs_vector_count(tables->tables);
+    ecs_subset_elem_t *elems = ecs_vector_first(
+        tables->tables, ecs_subset_elem_t);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].table == table && elems[i].column == column) {
+            ecs_os_memmove(&elems[i], &elems[i + 1], 
+                ECS_SIZEOF(ecs_subset_elem_t) * (count - i - 1));
+            ecs_vector_set_count(&tables->tables, ecs_subset_elem_t, count - 1);
+            break;
+        }
+    }
+
+    return false;
+}
+
+typedef struct ecs_rule_closure_frame_t {
+    ecs_table_cache_iter_t it;
+    ecs_table_t *table;
+    int32_t row;
+} ecs_rule_closure_frame_t;
+
+/* Compute transitive closure of a pair. Tables are stored in the same order
+ * in which the subset operation would find them when walking the hierarchy. */
+static
+void flecs_rule_subsets_build(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_entity_t rel,
+    ecs_id_record_t *idr)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t stack;
+    ecs_vec_init_t(a, &stack, ecs_rule_closure_frame_t, 16);
+
+    ecs_rule_closure_frame_t *frame = ecs_vec_append_t(
+        a, &stack, ecs_rule_closure_frame_t);
+    flecs_table_cache_all_iter(&idr->cache, &frame->it);
+    frame->table = NULL;
+
+    while (ecs_vec_count(&stack)) {
+        frame = ecs_vec_last_t(&stack, ecs_rule_closure_frame_t);
+        ecs_table_t *table = frame->table;
+        if (table && frame->row < ecs_table_count(table)) {
+            ecs_entity_t e = ecs_vec_get_t(&table->data.entities, 
+                ecs_entity_t, frame->row)[0];
+            frame->row ++;
+
+            ecs_id_record_t *e_idr = flecs_id_record_get(
+                world, ecs_pair(rel, e));
+            if (e_idr) {
+                ecs_map_ensure(&cache->members, bool, e)[0] = true;
+                frame = ecs_vec_append_t(a, &stack, ecs_rule_closure_frame_t);
+                flecs_table_cache_all_iter(&e_idr->cache, &frame->it);
+                frame->table = NULL;
+            }
+            continue;
+        }
+
+        const ecs_table_record_t *tr = flecs_table_cache_next(
+            &frame->it, ecs_table_record_t);
+        if (!tr) {
+            ecs_vec_remove_last(&stack);
+            continue;
+        }
+
+        /* Only walk the entities of a table the first time it's found */
+        table = tr->hdr.table;
+        if (flecs_rule_subsets_add_pair(cache, table, tr->column)) {
+            frame->table = table;
+            frame->row = 0;
+        } else {
+            frame->table = NULL;
+        }
+    }
+
+    ecs_vec_fini_t(a, &stack, ecs_rule_closure_frame_t);
+}
+
+/* Queue entities of table that have subsets */
+static
+void flecs_rule_subsets_queue_table(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_table_count(table);
+    ecs_entity_t *entities = ecs_vec_first(&table->data.entities);
+    ecs_vec_t *moved = &cache->moved;
+    for (i = 0; i < count; i ++) {
+        ecs_vec_append_t(&world->allocator, moved, ecs_entity_t)[0] = 
+            entities[i];
+    }
+}
+
+/* Add or remove the subsets of a target that entered or left the closure */
+static
+void flecs_rule_subsets_update_target(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_id_record_t *e_idr,
+    bool add)
+{
+    ecs_table_cache_iter_t it;
+    if (!flecs_table_cache_all_iter(&e_idr->cache, &it)) {
+        return;
+    }
+
+    const ecs_table_record_t *tr;
+    while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+        ecs_table_t *table = tr->hdr.table;
+        bool changed;
+        if (add) {
+            changed = flecs_rule_subsets_add_pair(cache, table, tr->column);
+        } else {
+            changed = flecs_rule_subsets_remove_pair(cache, table, tr->column);
+        }
+        if (changed) {
+            flecs_rule_subsets_queue_table(world, cache, table);
+        }
+    }
+}
+
+/* Apply created tables and moved targets to closure. Only the subsets of 
+ * targets that entered or left the closure are visited. */
+static
+void flecs_rule_subsets_apply(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_id_record_t *idr)
+{
+    ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+
+    /* Count the pairs of created tables with targets that are in the closure.
+     * Targets that don't have subsets in the closure yet are evaluated with the
+     * moved targets. */
+    int32_t i, count = ecs_vec_count(&cache->created);
+    uint64_t *created = ecs_vec_first(&cache->created);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, created[i]);
+        if (!table || ecs_map_get(&cache->table_refs, int32_t, table->id)) {
+            continue;
+        }
+
+        const ecs_table_record_t *tr = flecs_table_record_get(
+            world, table, ecs_pair(rel, EcsWildcard));
+        if (!tr) {
+            continue;
+        }
+
+        int32_t c;
+        for (c = tr->column; c < (tr->column + tr->count); c ++) {
+            ecs_id_t pair = table->type.array[c];
+            ecs_entity_t tgt = ecs_pair_second(world, pair);
+            if ((pair == idr->id) || 
+                ecs_map_get(&cache->members, bool, tgt)) 
+            {
+                flecs_rule_subsets_add_pair(cache, table, c);
+            } else if (tgt) {
+                ecs_vec_append_t(&world->allocator, &cache->moved, 
+                    ecs_entity_t)[0] = tgt;
+            }
+        }
+    }
+    ecs_vec_clear(&cache->created);
+
+    /* Evaluate targets until no more tables are added to or removed from the
+     * closure. A target has subsets in the closure if its table is. */
+    ecs_vec_t *moved = &cache->moved;
+    while (ecs_vec_count(moved)) {
+        ecs_entity_t e = ecs_vec_last_t(moved, ecs_entity_t)[0];
+        ecs_vec_remove_last(moved);
+
+        ecs_table_t *table = NULL;
+        bool is_alive = ecs_is_alive(world, e);
+        if (is_alive) {
+            table = flecs_entities_get(world, e)->table;
+        }
+
+        bool in_closure = table && 
+            ecs_map_get(&cache->table_refs, int32_t, table->id);
+        bool is_member = ecs_map_get(&cache->members, bool, e) != NULL;
+        if (in_closure == is_member) {
+            continue;
+        }
+
+        /* A deleted target with a recycled id no longer owns the pair */
+        ecs_id_record_t *e_idr = NULL;
+        if (is_alive || !ecs_get_alive(world, (uint32_t)e)) {
+            e_idr = flecs_id_record_get(world, ecs_pair(rel, e));
+        }
+
+        if (in_closure) {
+            if (!e_idr) {
+                continue;
+            }
+            ecs_map_ensure(&cache->members, bool, e)[0] = true;
+        } else {
+            ecs_map_remove(&cache->members, e);
+        }
+
+        if (e_idr) {
+            flecs_rule_subsets_update_target(world, cache, e_idr, in_closure);
+        }
+    }
+}
+
+/* Get up to date transitive closure for a pair. Returns NULL if the closure
+ * isn't available, in which case the hierarchy is walked. */
+static
+ecs_subset_tables_t* flecs_rule_get_subsets(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return NULL;
+    }
+
+    ecs_subset_cache_t *cache = idr->subsets;
+    if (cache && flecs_rule_subsets_valid(cache)) {
+        return cache->tables;
+    }
+
+    /* Don't modify cache when other threads could be reading it */
+    if (world->flags & EcsWorldMultiThreaded) {
+        return NULL;
+    }
+
+    if (cache) {
+        flecs_rule_subsets_apply(world, cache, idr);
+        return cache->tables;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    cache = idr->subsets = ecs_os_calloc_t(ecs_subset_cache_t);
+    cache->tables = ecs_os_calloc_t(ecs_subset_tables_t);
+    cache->tables->refs = 1;
+    ecs_map_init(&cache->table_refs, int32_t, a, 0);
+    ecs_map_init(&cache->members, bool, a, 0);
+    ecs_vec_init_t(a, &cache->created, uint64_t, 0);
+    ecs_vec_init_t(a, &cache->moved, ecs_entity_t, 0);
+    ecs_vector_add(&world->store.subset_ids, ecs_id_record_t*)[0] = idr;
+    world->flags |= EcsWorldHasSubsets;
+
+    flecs_rule_subsets_build(world, cache, ECS_PAIR_FIRST(id), idr);
+
+    return cache->tables;
+}
+
+/* Yield next non-empty table from transitive closure */
+static
+bool eval_subset_closure(
+    ecs_rule_iter_t *iter,
+    ecs_rule_op_t *op,
+    ecs_rule_subset_ctx_t *op_ctx,
+    ecs_var_t *regs)
+{
+    ecs_vector_t *tables = op_ctx->closure->tables;
+    int32_t count = ecs_vector_count(tables);
+    ecs_subset_elem_t *elem;
+    do {
+        int32_t index = op_ctx->closure_index ++;
+        if (index >= count) {
+            return false;
+        }
+        elem = ecs_vector_get(tables, ecs_subset_elem_t, index);
+    } while (!ecs_table_count(elem->table));
+
+    ecs_table_t *table = elem->table;
+    table_reg_set(iter->rule, regs, op->r_out, table);
+    set_term_vars(iter->rule, regs, op->term, table->type.array[elem->column]);
+
+    return true;
+}
+
 static
 bool eval_subset(
     ecs_iter_t *it,
@@ -23208,9 +26547,24 @@ bool eval_subset(
     ecs_table_t *table = NULL;
 
     if (!redo) {
-        op_ctx->stack = op_ctx->storage;
+        /* Use transitive closure if the pair is known. The iterator keeps a
+         * reference to the closure tables while it yields them. */
+        flecs_subset_tables_release(op_ctx->closure);
+        op_ctx->closure = NULL;
+        if (!filter.wildcard && !filter.same_var) {
+            op_ctx->closure = flecs_rule_get_subsets(world, filter.mask);
+            if (op_ctx->closure) {
+                ecs_os_ainc(&op_ctx->closure->refs);
+                op_ctx->closure_index = 0;
+                return eval_subset_closure(iter, op, op_ctx, regs);
+            }
+        }
+
+        ecs_vec_reset_t(flecs_rule_iter_allocator(it), &op_ctx->stack, 
+            ecs_rule_subset_frame_t);
         sp = op_ctx->sp = 0;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_subset_frame_t, sp);
         idr = frame->with_ctx.idr = find_tables(world, filter.mask);
         if (!idr) {
             return false;
@@ -23230,9 +26584,13 @@ bool eval_subset(
         goto yield;
     }
 
+    if (op_ctx->closure) {
+        return eval_subset_closure(iter, op, op_ctx, regs);
+    }
+
     do {
         sp = op_ctx->sp;
-        frame = &op_ctx->stack[sp];
+        frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_subset_frame_t, sp);
         table = frame->table;
         row = frame->row;
 
@@ -23254,7 +26612,8 @@ bool eval_subset(
                     /* If none of the frames yielded anything, no more data */
                     return false;
                 }
-                frame = &op_ctx->stack[sp];
+                frame = ecs_vec_get_t(
+                    &op_ctx->stack, ecs_rule_subset_frame_t, sp);
                 table = frame->table;
                 idr = frame->with_ctx.idr;
                 row = ++ frame->row;
@@ -23287,7 +26646,11 @@ bool eval_subset(
 
             /* If table set is found, find first non-empty table */
             if (idr) {
-                ecs_rule_subset_frame_t *new_frame = &op_ctx->stack[sp + 1];
+                /* Growing the stack can move the current frame */
+                ecs_rule_subset_frame_t *new_frame = flecs_rule_stack_frame_t(
+                    it, &op_ctx->stack, ecs_rule_subset_frame_t, sp + 1);
+                frame = ecs_vec_get_t(
+                    &op_ctx->stack, ecs_rule_subset_frame_t, sp);
                 new_frame->with_ctx.idr = idr;
                 flecs_table_cache_iter(&idr->cache, &new_frame->with_ctx.it);
                 table_record = find_next_table(&filter, &new_frame->with_ctx);
@@ -23467,6 +26830,45 @@ bool eval_select(
     return true;
 }
 
+/* Select operation for partitioned iterators. Each table found by the select
+ * at which the program is partitioned is assigned to one of the workers, and
+ * tables of other workers are skipped. Since all workers evaluate the program
+ * in the same order, each table is evaluated by exactly one worker. */
+static
+bool eval_select_partition(
+    ecs_iter_t *it,
+    ecs_rule_op_t *op,
+    int32_t op_index,
+    bool redo)
+{
+    ecs_rule_iter_t *iter = &it->priv.iter.rule;
+    if (iter->worker_count <= 1 || iter->worker_op != op_index) {
+        return eval_select(it, op, op_index, redo);
+    }
+
+    ecs_rule_with_ctx_t *op_ctx = &iter->op_ctx[op_index].is.with;
+    ecs_var_t *regs = get_registers(iter, op);
+
+    while (eval_select(it, op, op_index, redo)) {
+        ecs_table_t *table = table_reg_get(iter->rule, regs, op->r_out).table;
+        if (table != op_ctx->worker_table) {
+            /* Wildcard selects can return the same table multiple times */
+            op_ctx->worker_table = table;
+            op_ctx->worker_owned = (op_ctx->worker_tables % 
+                iter->worker_count) == iter->worker_index;
+            op_ctx->worker_tables ++;
+        }
+
+        if (op_ctx->worker_owned) {
+            return true;
+        }
+
+        redo = true;
+    }
+
+    return false;
+}
+
 /* With operation. The With operation always comes after either the Select or
  * another With operation, and applies additional filters to the table. */
 static
@@ -23894,7 +27296,7 @@ bool eval_op(
     case EcsRuleInput:
         return eval_input(it, op, op_index, redo);
     case EcsRuleSelect:
-        return eval_select(it, op, op_index, redo);
+        return eval_select_partition(it, op, op_index, redo);
     case EcsRuleWith:
         return eval_with(it, op, op_index, redo);
     case EcsRuleSubSet:
@@ -24215,6 +27617,53 @@ bool ecs_rule_next_instanced(
     if (first_time) {
         ecs_assert(redo == false, ECS_INTERNAL_ERROR, NULL);
         rule_iter_set_initial_state(it, iter, rule);
+
+        /* Cached results are only valid when no variables are constrained. The
+         * cache is not modified while the world is accessed from multiple
+         * threads, so that iterators on other threads can safely replay it. */
+        if (rule->cache && !it->constrained_vars) {
+            ecs_world_t *world = it->real_world;
+            if (flecs_rule_cache_is_valid(world, rule->cache)) {
+                /* Partitioned iterators replay every worker_count'th result */
+                iter->cached_result = iter->worker_count > 1 
+                    ? iter->worker_index : 0;
+                iter->cached = rule->cache->results;
+                ecs_os_ainc(&iter->cached->refs);
+            } else if (!(world->flags & EcsWorldMultiThreaded) && 
+                iter->worker_count <= 1) 
+            {
+                iter->fill_cache = flecs_rule_cache_fill_begin(world, rule);
+            }
+        }
+    }
+
+    /* Replay cached results */
+    if (iter->cached_result != -1) {
+        ecs_rule_cache_results_t *cache = iter->cached;
+        int32_t index = iter->cached_result;
+        if (index >= cache->count) {
+            ecs_iter_fini(it);
+            return false;
+        }
+
+        ecs_rule_op_t *op = &rule->operations[rule->operation_count - 1];
+        ecs_assert(op->kind == EcsRuleYield, ECS_INTERNAL_ERROR, NULL);
+        int32_t var_count = rule->var_count;
+        int32_t term_count = rule->filter.term_count;
+        if (var_count) {
+            ecs_os_memcpy_n(get_register_frame(iter, op->frame), 
+                ecs_vector_get(cache->registers, ecs_var_t, 
+                    index * var_count), ecs_var_t, var_count);
+        }
+        if (term_count) {
+            ecs_os_memcpy_n(rule_get_columns_frame(iter, op->frame),
+                ecs_vector_get(cache->columns, int32_t,
+                    index * term_count), int32_t, term_count);
+        }
+
+        populate_iterator(rule, it, iter, op);
+        iter->cached_result += iter->worker_count > 1 ? iter->worker_count : 1;
+        return true;
     }
 
     do {
@@ -24249,8 +27698,19 @@ bool ecs_rule_next_instanced(
         bool result = eval_op(it, op, op_index, redo);
         iter->op = result ? op->on_pass : op->on_fail;
 
+        /* If the program isn't partitioned at a select, each worker yields 
+         * every worker_count'th result */
+        bool yield = op->kind == EcsRuleYield;
+        if (yield && iter->worker_count > 1 && iter->worker_op == -1) {
+            yield = (iter->worker_yield ++ % iter->worker_count) == 
+                iter->worker_index;
+        }
+
         /* If the current operation is yield, return results */
-        if (op->kind == EcsRuleYield) {
+        if (yield) {
+            if (iter->fill_cache) {
+                flecs_rule_cache_append(iter, op);
+            }
             populate_iterator(rule, it, iter, op);
             iter->redo = true;
             return true;
@@ -24270,6 +27730,16 @@ bool ecs_rule_next_instanced(
         }
     } while (iter->op != -1);
 
+    /* All results have been stored, cache can now be replayed */
+    if (iter->fill_cache) {
+        ecs_rule_cache_t *cache = rule->cache;
+        flecs_rule_cache_results_release(cache->results);
+        cache->results = cache->filling;
+        cache->filling = NULL;
+        cache->valid = true;
+        iter->fill_cache = false;
+    }
+
     ecs_iter_fini(it);
 
 error:
@@ -24278,6 +27748,453 @@ error:
 
 #endif
 
+/**
+ * @file addons/index.c
+ * @brief Secondary index addon.
+ */
+
+
+#ifdef FLECS_INDEX
+
+/* Location of an entity in the index */
+typedef struct ecs_index_elem_t {
+    uint64_t key;           /* Indexed value */
+    int32_t index;          /* Position in entity array of value */
+} ecs_index_elem_t;
+
+typedef struct ecs_index_t {
+    ecs_world_t *world;
+    ecs_entity_t component;
+    ecs_size_t size;        /* Size of component */
+    ecs_size_t offset;      /* Offset of member in component */
+    ecs_meta_type_op_kind_t kind;
+    ecs_term_t term;        /* Term for index iterator */
+    ecs_map_t values;       /* map<key, vec<ecs_entity_t>> */
+    ecs_map_t entities;     /* map<ecs_entity_t, ecs_index_elem_t> */
+} ecs_index_t;
+
+static
+bool flecs_index_kind_supported(
+    ecs_meta_type_op_kind_t kind)
+{
+    switch(kind) {
+    case EcsOpBool:
+    case EcsOpChar:
+    case EcsOpByte:
+    case EcsOpU8:
+    case EcsOpU16:
+    case EcsOpU32:
+    case EcsOpU64:
+    case EcsOpI8:
+    case EcsOpI16:
+    case EcsOpI32:
+    case EcsOpI64:
+    case EcsOpUPtr:
+    case EcsOpIPtr:
+    case EcsOpEntity:
+    case EcsOpEnum:
+    case EcsOpBitmask:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Convert value to key. Signed values are sign extended, so that the key is
+ * the same regardless of the width of the member type. */
+static
+uint64_t flecs_index_key(
+    ecs_meta_type_op_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsOpBool: return *(const ecs_bool_t*)ptr;
+    case EcsOpChar: return (uint64_t)(int64_t)*(const ecs_char_t*)ptr;
+    case EcsOpByte: return *(const ecs_byte_t*)ptr;
+    case EcsOpU8: return *(const ecs_u8_t*)ptr;
+    case EcsOpU16: return *(const ecs_u16_t*)ptr;
+    case EcsOpU32: return *(const ecs_u32_t*)ptr;
+    case EcsOpBitmask: return *(const ecs_u32_t*)ptr;
+    case EcsOpU64: return *(const ecs_u64_t*)ptr;
+    case EcsOpUPtr: return *(const ecs_uptr_t*)ptr;
+    case EcsOpEntity: return *(const ecs_entity_t*)ptr;
+    case EcsOpI8: return (uint64_t)(int64_t)*(const ecs_i8_t*)ptr;
+    case EcsOpI16: return (uint64_t)(int64_t)*(const ecs_i16_t*)ptr;
+    case EcsOpI32: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr;
+    case EcsOpEnum: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr;
+    case EcsOpI64: return (uint64_t)(int64_t)*(const ecs_i64_t*)ptr;
+    case EcsOpIPtr: return (uint64_t)(int64_t)*(const ecs_iptr_t*)ptr;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Find serializer op for (nested) member of component */
+static
+const ecs_meta_type_op_t* flecs_index_find_member(
+    const ecs_world_t *world,
+    ecs_entity_t component,
+    const char *member)
+{
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, component, EcsMetaTypeSerialized);
+    if (!ser) {
+        char *path = ecs_get_fullpath(world, component);
+        ecs_err("cannot index '%s': component has no reflection data", path);
+        ecs_os_free(path);
+        return NULL;
+    }
+
+    const ecs_meta_type_op_t *op = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    ecs_assert(op != NULL, ECS_INTERNAL_ERROR, NULL);
+    if (!member) {
+        return op;
+    }
+
+    const char *ptr = member;
+    char token[ECS_MAX_TOKEN_SIZE];
+    while (ptr[0]) {
+        const char *sep = strchr(ptr, '.');
+        ecs_size_t len = sep ? flecs_ito(ecs_size_t, sep - ptr) :
+            ecs_os_strlen(ptr);
+        if (len >= ECS_MAX_TOKEN_SIZE) {
+            ecs_err("member name '%s' is too long", member);
+            return NULL;
+        }
+
+        ecs_os_memcpy(token, ptr, len);
+        token[len] = '\0';
+
+        const uint64_t *cur = NULL;
+        if (op->kind == EcsOpPush && op->members) {
+            cur = flecs_name_index_find_ptr(op->members, token, 0, 0);
+        }
+        if (!cur) {
+            char *path = ecs_get_fullpath(world, component);
+            ecs_err("unknown member '%s' for component '%s'", member, path);
+            ecs_os_free(path);
+            return NULL;
+        }
+
+        /* Member indices are relative to the first op after the push op */
+        op = &op[1 + flecs_uto(int32_t, cur[0])];
+
+        ptr += len;
+        if (ptr[0] == '.') {
+            ptr ++;
+        }
+    }
+
+    return op;
+}
+
+static
+void flecs_index_remove(
+    ecs_index_t *index,
+    ecs_entity_t e)
+{
+    ecs_index_elem_t *elem = ecs_map_get(
+        &index->entities, ecs_index_elem_t, e);
+    if (!elem) {
+        return;
+    }
+
+    uint64_t key = elem->key;
+    int32_t elem_index = elem->index;
+    ecs_map_remove(&index->entities, e);
+
+    ecs_vec_t *v = ecs_map_get(&index->values, ecs_vec_t, key);
+    ecs_assert(v != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Entity is moved to removed position, update its element */
+    int32_t last = ecs_vec_count(v) - 1;
+    if (elem_index != last) {
+        ecs_entity_t moved = ecs_vec_get_t(v, ecs_entity_t, last)[0];
+        ecs_index_elem_t *moved_elem = ecs_map_get(
+            &index->entities, ecs_index_elem_t, moved);
+        ecs_assert(moved_elem != NULL, ECS_INTERNAL_ERROR, NULL);
+        moved_elem->index = elem_index;
+    }
+
+    ecs_vec_remove_t(v, ecs_entity_t, elem_index);
+    if (!ecs_vec_count(v)) {
+        ecs_vec_fini_t(&index->world->allocator, v, ecs_entity_t);
+        ecs_map_remove(&index->values, key);
+    }
+}
+
+static
+void flecs_index_set(
+    ecs_index_t *index,
+    ecs_entity_t e,
+    const void *ptr)
+{
+    uint64_t key = flecs_index_key(index->kind,
+        ECS_OFFSET(ptr, index->offset));
+
+    ecs_index_elem_t *elem = ecs_map_get(
+        &index->entities, ecs_index_elem_t, e);
+    if (elem) {
+        if (elem->key == key) {
+            return;
+        }
+        flecs_index_remove(index, e);
+    }
+
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_vec_t *v = ecs_map_ensure(&index->values, ecs_vec_t, key);
+    int32_t count = ecs_vec_count(v);
+    if (!count) {
+        /* Values without entities are removed, so this is a new value */
+        ecs_vec_init_t(a, v, ecs_entity_t, 0);
+    }
+    ecs_vec_append_t(a, v, ecs_entity_t)[0] = e;
+
+    elem = ecs_map_ensure(&index->entities, ecs_index_elem_t, e);
+    elem->key = key;
+    elem->index = count;
+}
+
+static
+void flecs_index_observer(
+    ecs_iter_t *it)
+{
+    ecs_index_t *index = it->ctx;
+    int32_t i, count = it->count;
+
+    if (it->event == EcsOnSet) {
+        void *ptr = ecs_field_w_size(it, flecs_itosize(index->size), 1);
+        for (i = 0; i < count; i ++) {
+            flecs_index_set(index, it->entities[i],
+                ECS_ELEM(ptr, index->size, i));
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            flecs_index_remove(index, it->entities[i]);
+        }
+    }
+}
+
+static
+void flecs_index_free(
+    void *ptr)
+{
+    ecs_index_t *index = ptr;
+    ecs_allocator_t *a = &index->world->allocator;
+
+    ecs_map_iter_t mit = ecs_map_iter(&index->values);
+    ecs_vec_t *v;
+    while ((v = ecs_map_next(&mit, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(a, v, ecs_entity_t);
+    }
+
+    ecs_map_fini(&index->values);
+    ecs_map_fini(&index->entities);
+    ecs_os_free(index);
+}
+
+static
+const ecs_index_t* flecs_index_get(
+    const ecs_world_t *world,
+    ecs_entity_t index)
+{
+    world = ecs_get_world(world);
+    const EcsPoly *o = ecs_poly_bind_get(world, index, ecs_observer_t);
+    ecs_check(o != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    const ecs_observer_t *observer = o->poly;
+    ecs_check(observer->callback == flecs_index_observer, 
+        ECS_INVALID_PARAMETER, "entity is not an index");
+    return observer->ctx;
+error:
+    return NULL;
+}
+
+ecs_entity_t ecs_index_init(
+    ecs_world_t *world,
+    const ecs_index_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->_canary == 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->component != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_entity_t component = desc->component;
+    const ecs_type_info_t *ti = ecs_get_type_info(world, component);
+    if (!ti) {
+        char *path = ecs_get_fullpath(world, component);
+        ecs_err("cannot index '%s': not a component", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    const ecs_meta_type_op_t *op = flecs_index_find_member(
+        world, component, desc->member);
+    if (!op) {
+        return 0;
+    }
+
+    if (!flecs_index_kind_supported(op->kind) || op->count > 1) {
+        char *path = ecs_get_fullpath(world, op->type);
+        ecs_err("cannot index member of type '%s'", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    ecs_index_t *index = ecs_os_calloc_t(ecs_index_t);
+    index->world = world;
+    index->component = component;
+    index->size = ti->size;
+    index->offset = op->offset;
+    index->kind = op->kind;
+    index->term.id = component;
+    index->term.inout = EcsIn;
+    index->term.field_index = 0;
+    ecs_map_init(&index->values, ecs_vec_t, &world->allocator, 0);
+    ecs_map_init(&index->entities, ecs_index_elem_t, &world->allocator, 0);
+
+    ecs_entity_t result = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .entity = desc->entity,
+        .filter.terms = {{ .id = component, .src.flags = EcsSelf }},
+        .events = { EcsOnSet, EcsOnRemove },
+        .callback = flecs_index_observer,
+        .ctx = index,
+        .ctx_free = flecs_index_free
+    });
+    if (!result) {
+        flecs_index_free(index);
+        return 0;
+    }
+
+    /* Add entities that already have the component */
+    ecs_filter_t f = ECS_FILTER_INIT;
+    ecs_filter_t *filter = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ .id = component, .src.flags = EcsSelf, .inout = EcsIn }}
+    });
+    ecs_assert(filter != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, filter);
+    while (ecs_filter_next(&it)) {
+        void *ptr = ecs_field_w_size(&it, flecs_itosize(index->size), 1);
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            flecs_index_set(index, it.entities[i],
+                ECS_ELEM(ptr, index->size, i));
+        }
+    }
+    ecs_filter_fini(filter);
+
+    return result;
+error:
+    return 0;
+}
+
+const ecs_entity_t* ecs_index_lookup(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value,
+    int32_t *count_out)
+{
+    ecs_check(value != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const ecs_index_t *impl = flecs_index_get(world, index);
+    ecs_check(impl != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    uint64_t key = flecs_index_key(impl->kind, value);
+    ecs_vec_t *v = ecs_map_get(&impl->values, ecs_vec_t, key);
+    if (!v) {
+        *count_out = 0;
+        return NULL;
+    }
+
+    *count_out = ecs_vec_count(v);
+    return ecs_vec_first_t(v, ecs_entity_t);
+error:
+    return NULL;
+}
+
+ecs_iter_t ecs_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const ecs_world_t *real_world = ecs_get_world(world);
+    const ecs_index_t *impl = flecs_index_get(real_world, index);
+    ecs_check(impl != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t count;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        real_world, index, value, &count);
+
+    ecs_iter_t it = {
+        .real_world = (ecs_world_t*)real_world,
+        .world = (ecs_world_t*)world,
+        .terms = (ecs_term_t*)&impl->term,
+        .field_count = 1,
+        .flags = EcsIterRowRange,
+        .next = ecs_index_next,
+        .priv.iter.index = {
+            .entities = entities,
+            .count = count
+        }
+    };
+
+    flecs_iter_init(world, &it, flecs_iter_cache_all);
+
+    it.ids[0] = impl->component;
+    it.columns[0] = 1;
+    it.sizes[0] = impl->size;
+
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool ecs_index_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_index_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_index_iter_t *iter = &it->priv.iter.index;
+    if (iter->index >= iter->count) {
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    ecs_world_t *world = it->real_world;
+    ecs_entity_t e = iter->entities[iter->index ++];
+    ecs_record_t *r = flecs_entities_get(world, e);
+    ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *table = r->table;
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    it->table = table;
+    it->offset = row;
+    it->count = 1;
+    it->entities = ecs_vec_get_t(&table->data.entities, ecs_entity_t, row);
+
+    const ecs_table_record_t *tr = flecs_table_record_get(
+        world, table->storage_table, it->ids[0]);
+    ecs_assert(tr != NULL, ECS_INTERNAL_ERROR, NULL);
+    it->ptrs[0] = ecs_vec_get(
+        &table->data.columns[tr->column], it->sizes[0], row);
+
+    flecs_iter_validate(it);
+    return true;
+error:
+    return false;
+}
+
+#endif
+
 
 #ifdef FLECS_MODULE
 
@@ -31774,7 +35691,14 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
+        /* Chunks are claimed from the tables of the system query, so paged
+         * systems fall back to a regular worker iterator */
+        if (system_data->chunk_size && it == &qit) {
+            wit = ecs_worker_chunk_iter(it, stage_index, stage_count, 
+                system_data->chunk_size, &system_data->chunk_cursor);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+        }
         it = &wit;
     }
 
@@ -31954,6 +35878,8 @@ ecs_entity_t ecs_system_init(
 
         system->multi_threaded = desc->multi_threaded;
         system->no_readonly = desc->no_readonly;
+        system->concurrent = desc->concurrent;
+        system->chunk_size = desc->chunk_size;
 
         if (desc->interval != 0 || desc->rate != 0 || desc->tick_source != 0) {
 #ifdef FLECS_TIMER
@@ -32001,6 +35927,12 @@ ecs_entity_t ecs_system_init(
         if (desc->no_readonly) {
             system->no_readonly = desc->no_readonly;
         }
+        if (desc->concurrent) {
+            system->concurrent = desc->concurrent;
+        }
+        if (desc->chunk_size) {
+            system->chunk_size = desc->chunk_size;
+        }
     }
 
     ecs_poly_modified(world, entity, ecs_system_t);
@@ -38480,6 +42412,9 @@ const ecs_entity_t EcsChildOf =               ECS_HI_COMPONENT_ID + 25;
 const ecs_entity_t EcsIsA =                   ECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsDependsOn =             ECS_HI_COMPONENT_ID + 27;
 
+/* Storage properties */
+const ecs_entity_t EcsSparse =                ECS_HI_COMPONENT_ID + 28;
+
 /* Identifier tags */
 const ecs_entity_t EcsName =                  ECS_HI_COMPONENT_ID + 30;
 const ecs_entity_t EcsSymbol =                ECS_HI_COMPONENT_ID + 31;
@@ -39007,6 +42942,9 @@ void flecs_log_addons(void) {
     #ifdef FLECS_RULES
         ecs_trace("FLECS_RULES");
     #endif
+    #ifdef FLECS_INDEX
+        ecs_trace("FLECS_INDEX");
+    #endif
     #ifdef FLECS_SNAPSHOT
         ecs_trace("FLECS_SNAPSHOT");
     #endif
@@ -39135,6 +43073,10 @@ ecs_world_t *ecs_mini(void) {
         ecs_table_t*);
     flecs_name_index_init(&world->aliases, &world->allocator);
     flecs_name_index_init(&world->symbols, &world->allocator);
+    ecs_vec_init_t(&world->allocator, &world->merge_writes, 
+        ecs_merge_write_t, 0);
+    ecs_vec_init_t(&world->allocator, &world->cmd_queues, 
+        ecs_cmd_queue_t*, 0);
 
     world->info.time_scale = 1.0;
 
@@ -39407,6 +43349,7 @@ void ecs_set_hooks_id(
     if (h->move_ctor) ti->hooks.move_ctor = h->move_ctor;
     if (h->ctor_move_dtor) ti->hooks.ctor_move_dtor = h->ctor_move_dtor;
     if (h->move_dtor) ti->hooks.move_dtor = h->move_dtor;
+    ti->hooks.flags |= h->flags;
 
     if (h->on_add) ti->hooks.on_add = h->on_add;
     if (h->on_remove) ti->hooks.on_remove = h->on_remove;
@@ -39635,6 +43578,9 @@ int ecs_fini(
     flecs_name_index_fini(&world->aliases);
     flecs_name_index_fini(&world->symbols);
     ecs_set_stage_count(world, 0);
+    ecs_vec_fini_t(&world->allocator, &world->merge_writes, 
+        ecs_merge_write_t);
+    flecs_cmd_queues_fini(world);
     ecs_log_pop_1();
 
     flecs_world_allocators_fini(world);
@@ -39665,6 +43611,68 @@ void ecs_dim(
     flecs_entities_set_size(world, entity_count + ECS_HI_COMPONENT_ID);
 }
 
+int64_t ecs_world_trim(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    /* Shrink table storage. This returns memory to the world allocator, which
+     * is trimmed below. Skip the first (dummy) table. */
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    flecs_table_shrink(world, &world->store.root);
+    for (i = 1; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense(
+            &world->store.tables, ecs_table_t, i);
+        if (!table->lock) {
+            flecs_table_shrink(world, table);
+        }
+    }
+
+    flecs_sparse_shrink(&world->store.entity_index);
+    flecs_sparse_shrink(&world->store.tables);
+    flecs_sparse_shrink(&world->id_index_lo);
+    flecs_sparse_shrink(world->type_info);
+    flecs_sparse_shrink(world->pending_tables);
+    flecs_sparse_shrink(world->pending_buffer);
+
+    /* Shrink sparse component storage */
+    count = ecs_vector_count(world->store.sparse_ids);
+    ecs_id_record_t **sparse_ids = ecs_vector_first(
+        world->store.sparse_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_shrink(sparse_ids[i]->sparse);
+    }
+
+    int64_t result = flecs_allocator_trim(&world->allocator);
+
+    ecs_world_allocators_t *a = &world->allocators;
+    result += flecs_ballocator_trim(&a->query_table);
+    result += flecs_ballocator_trim(&a->query_table_match);
+    result += flecs_ballocator_trim(&a->graph_edge_lo);
+    result += flecs_ballocator_trim(&a->graph_edge);
+    result += flecs_ballocator_trim(&a->id_record);
+    result += flecs_ballocator_trim(&a->id_record_chunk);
+    result += flecs_ballocator_trim(&a->table_diff);
+    result += flecs_ballocator_trim(&a->sparse_chunk);
+    result += flecs_ballocator_trim(&a->hashmap);
+
+    count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = &world->stages[i];
+        result += flecs_allocator_trim(&stage->allocator);
+        result += flecs_ballocator_trim(&stage->allocators.cmd_entry_chunk);
+        result += flecs_stack_trim(&stage->allocators.iter_stack);
+        result += flecs_stack_trim(&stage->allocators.deser_stack);
+    }
+
+    ecs_dbg_1("#[red]trimmed#[normal] %.2fKB", (double)result / 1024.0);
+
+    return result;
+error:
+    return 0;
+}
+
 void flecs_eval_component_monitors(
     ecs_world_t *world)
 {
@@ -40012,6 +44020,9 @@ ecs_ftime_t ecs_frame_begin(
     /* Keep track of total scaled time passed in world */
     world->info.world_time_total += world->info.delta_time;
 
+    /* Merge commands that were added to command queues by other threads */
+    ecs_cmd_queues_merge(world);
+
     ecs_run_aperiodic(world, 0);
 
     return world->info.delta_time;
@@ -40089,6 +44100,31 @@ void flecs_delete_table(
     flecs_table_release(world, table);
 }
 
+/* Bring the table arrays of queries in sync with the tables that became empty
+ * or non-empty. This happens here and not when a query is iterated, as
+ * iterators can be created from multiple threads. Only queries of which the
+ * iterated tables changed, or that have retired arrays, are queued. */
+static
+void flecs_process_query_table_arrays(
+    ecs_world_t *world)
+{
+    int32_t i, kept = 0, count = ecs_vector_count(world->pending_queries);
+    if (!count) {
+        return;
+    }
+
+    ecs_query_t **queries = ecs_vector_first(
+        world->pending_queries, ecs_query_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_query_t *query = queries[i];
+        if (flecs_query_update_table_array(query)) {
+            queries[kept ++] = query;
+        }
+    }
+
+    ecs_vector_set_count(&world->pending_queries, ecs_query_t*, kept);
+}
+
 static
 void flecs_process_empty_queries(
     ecs_world_t *world)
@@ -40162,6 +44198,7 @@ void flecs_process_pending_tables(
      * more predictable. */
     int32_t i, count = flecs_sparse_count(world->pending_tables);
     if (!count) {
+        flecs_process_query_table_arrays(world);
         return;
     }
 
@@ -40222,6 +44259,8 @@ void flecs_process_pending_tables(
         world->pending_buffer = pending_tables;
     } while ((count = flecs_sparse_count(world->pending_tables)));
 
+    flecs_process_query_table_arrays(world);
+
     flecs_journal_end();
 }
 
@@ -42545,6 +46584,111 @@ void ecs_term_fini(
     term->name = NULL;
 }
 
+typedef struct ecs_filter_plan_elem_t {
+    int64_t cost;
+    int32_t term;
+    int32_t count;
+} ecs_filter_plan_elem_t;
+
+/* Estimate how expensive it is to reach a verdict with a term (or Or chain).
+ * Terms that are most likely to reject a table come first, so that a table 
+ * that doesn't match fails on as few lookups as possible. */
+static
+int64_t flecs_filter_plan_cost(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_oper_kind_t oper = term->oper;
+    if (!term->src.id || oper == EcsOptional) {
+        /* Terms that can't reject a table are evaluated last */
+        return INT64_MAX;
+    }
+
+    if (!ecs_term_match_this(term)) {
+        /* Terms with a fixed source yield the same result for every table */
+        return 0;
+    }
+
+    ecs_id_record_t *idr = flecs_query_id_record_get(world, term->id);
+    int64_t table_count = 0;
+    if (idr) {
+        table_count = flecs_table_cache_count(&idr->cache);
+    }
+
+    if (oper == EcsAnd) {
+        /* The fewer tables have the id, the more likely it rejects a table. 
+         * Terms that traverse relationships are more expensive to test. */
+        if ((term->src.flags & EcsTraverseFlags) != EcsSelf) {
+            table_count += INT32_MAX;
+        }
+        return 1 + table_count;
+    } else if (oper == EcsNot) {
+        /* The more tables have the id, the more likely it rejects a table */
+        return 2 * (int64_t)INT32_MAX + 1 - table_count;
+    }
+
+    /* Or chains reject a table only if none of their terms match */
+    return 3 * (int64_t)INT32_MAX;
+}
+
+/* Compute order in which flecs_filter_match_table evaluates terms. The plan is
+ * computed once when the filter is finalized, from the tables that exist at
+ * that point. A plan that gets out of date only affects performance. */
+static
+void flecs_filter_plan(
+    const ecs_world_t *world,
+    ecs_filter_t *filter)
+{
+    int32_t i, j, term_count = filter->term_count;
+    if (term_count < 2) {
+        ecs_os_free(filter->plan);
+        filter->plan = NULL;
+        return;
+    }
+
+    ecs_term_t *terms = filter->terms;
+    ecs_filter_plan_elem_t *elems = ecs_os_malloc_n(
+        ecs_filter_plan_elem_t, term_count);
+    int32_t elem_count = 0;
+
+    /* Insertion sort, terms of an Or chain are kept together as one element.
+     * Elements with the same cost remain in declaration order. */
+    for (i = 0; i < term_count; ) {
+        ecs_term_t *term = &terms[i];
+        int32_t count = 1;
+        if (term->oper == EcsOr) {
+            while ((i + count) < term_count && 
+                terms[i + count].oper == EcsOr &&
+                terms[i + count].field_index == term->field_index) 
+            {
+                count ++;
+            }
+        }
+
+        int64_t cost = flecs_filter_plan_cost(world, term);
+        for (j = elem_count; j > 0 && elems[j - 1].cost > cost; j --) {
+            elems[j] = elems[j - 1];
+        }
+
+        elems[j] = (ecs_filter_plan_elem_t){ 
+            .cost = cost, .term = i, .count = count };
+        elem_count ++;
+        i += count;
+    }
+
+    filter->plan = ecs_os_realloc_n(filter->plan, int32_t, term_count);
+
+    int32_t *plan = filter->plan;
+    for (i = 0; i < elem_count; i ++) {
+        for (j = 0; j < elems[i].count; j ++) {
+            plan[0] = elems[i].term + j;
+            plan ++;
+        }
+    }
+
+    ecs_os_free(elems);
+}
+
 int ecs_filter_finalize(
     const ecs_world_t *world,
     ecs_filter_t *f)
@@ -42587,6 +46731,16 @@ int ecs_filter_finalize(
         prev_src_id = term->src.id;
         prev_or = is_or;
 
+        /* Sparse components are not stored in tables, so they can't be 
+         * matched by filters. Queries match them while iterating. */
+        if (!(f->flags & EcsFilterMatchSparse) && 
+            flecs_id_is_sparse(ecs_get_world(world), term->id)) 
+        {
+            flecs_filter_error(&ctx, 
+                "sparse component can only be matched by a query");
+            return -1;
+        }
+
         if (ecs_term_match_this(term)) {
             ECS_BIT_SET(f->flags, EcsFilterMatchThis);
         } else {
@@ -42619,6 +46773,8 @@ int ecs_filter_finalize(
         ECS_BIT_SET(f->flags, EcsFilterIsFilter);
     }
 
+    flecs_filter_plan(ecs_get_world(world), f);
+
     return 0;
 }
 
@@ -42788,10 +46944,15 @@ void ecs_filter_copy(
         int32_t i, term_count = src->term_count;
         dst->terms = ecs_os_malloc_n(ecs_term_t, term_count);
         dst->terms_owned = true;
+        dst->plan = NULL;
 
         for (i = 0; i < term_count; i ++) {
             dst->terms[i] = ecs_term_copy(&src->terms[i]);
         }
+
+        if (src->plan) {
+            dst->plan = ecs_os_memdup_n(src->plan, int32_t, term_count);
+        }
     } else {
         ecs_os_memset_t(dst, 0, ecs_filter_t);
     }
@@ -42810,6 +46971,7 @@ void ecs_filter_move(
         if (src->terms_owned) {
             dst->terms = src->terms;
             dst->terms_owned = true;
+            src->plan = NULL;
         } else {
             ecs_filter_copy(dst, src);
         }
@@ -42835,9 +46997,12 @@ void ecs_filter_fini(
     }
 
     ecs_os_free(filter->name);
+    ecs_os_free(filter->plan);
 
     filter->terms = NULL;
+    filter->term_count = 0;
     filter->name = NULL;
+    filter->plan = NULL;
 
     if (filter->owned) {
         ecs_os_free(filter);
@@ -43310,16 +47475,22 @@ bool flecs_filter_match_table(
     ecs_flags32_t iter_flags)
 {
     ecs_term_t *terms = filter->terms;
-    int32_t i, count = filter->term_count;
+    const int32_t *plan = filter->plan;
+    int32_t p, count = filter->term_count;
 
     bool is_or = false;
     bool or_result = false;
+    int32_t or_field = -1;
     int32_t match_count = 1;
     if (matches_left) {
         match_count = *matches_left;
     }
 
-    for (i = 0; i < count; i ++) {
+    /* Terms are evaluated in the order of the filter plan (if any), which
+     * keeps the terms of an Or chain together. Because the plan may put two Or
+     * chains next to each other, chains are told apart by their field. */
+    for (p = 0; p < count; p ++) {
+        int32_t i = plan ? plan[p] : p;
         if (i == skip_term) {
             continue;
         }
@@ -43330,10 +47501,7 @@ bool flecs_filter_match_table(
         const ecs_table_t *match_table = table;
         int32_t t_i = term->field_index;
 
-        if (!is_or && oper == EcsOr) {
-            is_or = true;
-            or_result = false;
-        } else if (is_or && oper != EcsOr) {
+        if (is_or && (oper != EcsOr || t_i != or_field)) {
             if (!or_result) {
                 return false;
             }
@@ -43341,6 +47509,12 @@ bool flecs_filter_match_table(
             is_or = false;
         }
 
+        if (!is_or && oper == EcsOr) {
+            is_or = true;
+            or_result = false;
+            or_field = t_i;
+        }
+
         ecs_entity_t src_id = src->id;
         if (!src_id) {
             if (ids) {
@@ -43375,8 +47549,13 @@ bool flecs_filter_match_table(
             or_result |= result;
             if (result) {
                 /* If Or term matched, skip following Or terms */
-                for (; i < count && terms[i].oper == EcsOr; i ++) { }
-                i -- ;
+                for (; p < count; p ++) {
+                    const ecs_term_t *next = &terms[plan ? plan[p] : p];
+                    if (next->oper != EcsOr || next->field_index != or_field) {
+                        break;
+                    }
+                }
+                p -- ;
             }
         } else if (!result) {
             return false;
@@ -43824,7 +48003,8 @@ int32_t ecs_filter_pivot_term(
 
     ecs_term_t *terms = filter->terms;
     int32_t i, term_count = filter->term_count;
-    int32_t pivot_term = -1, min_count = -1, self_pivot_term = -1;
+    int32_t pivot_term = -1, min_count = -1;
+    bool pivot_self = false;
 
     for (i = 0; i < term_count; i ++) {
         ecs_term_t *term = &terms[i];
@@ -43845,20 +48025,21 @@ int32_t ecs_filter_pivot_term(
             return -2; /* -2 indicates filter doesn't match anything */
         }
 
+        /* Iterating a term that traverses relationships also visits the
+         * tables that inherit the id, so prefer any term that only matches
+         * on self. Between terms of the same kind pick the one with the
+         * fewest tables. */
         int32_t table_count = flecs_table_cache_count(&idr->cache);
-        if (min_count == -1 || table_count < min_count) {
+        bool self = (term->src.flags & EcsTraverseFlags) == EcsSelf;
+        if (pivot_term == -1 || (self && !pivot_self) || 
+           ((self == pivot_self) && (table_count < min_count))) 
+        {
             min_count = table_count;
             pivot_term = i;
-            if ((term->src.flags & EcsTraverseFlags) == EcsSelf) {
-                self_pivot_term = i;
-            }
+            pivot_self = self;
         }
     }
 
-    if (self_pivot_term != -1) {
-        pivot_term = self_pivot_term;
-    }
-
     return pivot_term;
 error:
     return -2;
@@ -44202,9 +48383,17 @@ error:
     return false;
 
 yield:
-    it->offset = 0;
-    flecs_iter_populate_data(world, it, table, 0, 
-        table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
+    if (chain_it && ECS_BIT_IS_SET(chain_it->flags, EcsIterRowRange)) {
+        /* Only return the rows returned by the chained iterator, which are a
+         * subset of the table (for example when it's an index iterator). */
+        it->offset = chain_it->offset;
+        flecs_iter_populate_data(world, it, table, chain_it->offset, 
+            chain_it->count, it->ptrs, it->sizes);
+    } else {
+        it->offset = 0;
+        flecs_iter_populate_data(world, it, table, 0, 
+            table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
+    }
     ECS_BIT_SET(it->flags, EcsIterIsValid);
     return true;    
 }
@@ -44918,6 +49107,121 @@ void flecs_observers_invoke(
     }
 }
 
+/* Match filter of multi observer with table the event was emitted for */
+static
+bool flecs_multi_observer_match(
+    ecs_world_t *world,
+    ecs_observer_t *o,
+    ecs_iter_t *user_it,
+    const ecs_table_t *table,
+    const ecs_table_t *prev_table,
+    ecs_term_t *term)
+{
+    if (!flecs_filter_match_table(world, &o->filter, table, user_it->ids, 
+        user_it->columns, user_it->sources, NULL, NULL, false, -1, 
+        user_it->flags))
+    {
+        return false;
+    }
+
+    /* Monitor observers only invoke when the filter matches for the first
+     * time with an entity */
+    if (o->is_monitor) {
+        if (flecs_filter_match_table(world, &o->filter, prev_table, 
+            NULL, NULL, NULL, NULL, NULL, true, -1, user_it->flags)) 
+        {
+            return false;
+        }
+    }
+
+    /* While filter matching needs to be reversed for a Not term, the
+     * component data must be fetched from the table we got notified for.
+     * Repeat the matching process for the non-matching table so we get the
+     * correct column ids and sources, which we need for populate_data */
+    if (term->oper == EcsNot) {
+        flecs_filter_match_table(world, &o->filter, prev_table, user_it->ids, 
+            user_it->columns, user_it->sources, NULL, NULL, false, -1, 
+            user_it->flags | EcsFilterPopulate);
+    }
+
+    return true;
+}
+
+/* Filter results can only be cached if they only depend on the table. Terms
+ * that traverse IsA only depend on other entities if a table has an IsA pair,
+ * which is checked when the cache is accessed. */
+static
+bool flecs_multi_observer_can_cache(
+    const ecs_filter_t *filter,
+    bool *has_up)
+{
+    int32_t i, count = filter->term_count;
+    *has_up = false;
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &filter->terms[i];
+        if (term->oper == EcsAndFrom || term->oper == EcsOrFrom) {
+            return false;
+        }
+        if (term->src.id && !ecs_term_match_this(term)) {
+            return false;
+        }
+        if (term->src.flags & EcsUp) {
+            if (term->src.trav != EcsIsA) {
+                return false;
+            }
+            *has_up = true;
+        }
+    }
+    return true;
+}
+
+static
+ecs_observer_match_t* flecs_multi_observer_cache_get(
+    ecs_world_t *world,
+    ecs_observer_t *o,
+    const ecs_table_t *table,
+    const ecs_table_t *prev_table,
+    ecs_entity_t event,
+    int32_t pivot_term,
+    int32_t column,
+    bool *hit)
+{
+    ecs_observer_match_cache_t *cache = o->match_cache;
+    *hit = false;
+    if (!cache) {
+        return NULL;
+    }
+
+    if (cache->has_up && 
+        ((table->flags | prev_table->flags) & EcsTableHasIsA)) 
+    {
+        return NULL;
+    }
+
+    /* A deleted table can't be matched anymore, but its address may be reused
+     * by a new table with a different type. */
+    int32_t i;
+    if (cache->table_delete_total != world->info.table_delete_total) {
+        for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+            cache->entries[i].table = NULL;
+        }
+        cache->table_delete_total = world->info.table_delete_total;
+    }
+
+    uint64_t hash = table->id ^ (prev_table->id << 3) ^ 
+        (uint64_t)event ^ (uint64_t)pivot_term;
+    ecs_observer_match_t *m = &cache->entries[
+        hash % FLECS_OBSERVER_MATCH_CACHE_SIZE];
+    if (m->table == table && m->prev_table == prev_table && 
+        m->event == event && m->pivot_term == pivot_term && 
+        m->column == column) 
+    {
+        *hit = true;
+    }
+
+    return m;
+}
+
 static
 bool flecs_multi_observer_invoke(ecs_iter_t *it) {
     ecs_observer_t *o = it->ctx;
@@ -44968,30 +49272,43 @@ bool flecs_multi_observer_invoke(ecs_iter_t *it) {
     user_it.columns[0] = 0;
     user_it.columns[pivot_term] = column;
 
-    if (flecs_filter_match_table(world, &o->filter, table, user_it.ids, 
-        user_it.columns, user_it.sources, NULL, NULL, false, -1, 
-        user_it.flags))
-    {
-        /* Monitor observers only invoke when the filter matches for the first
-         * time with an entity */
-        if (o->is_monitor) {
-            if (flecs_filter_match_table(world, &o->filter, prev_table, 
-                NULL, NULL, NULL, NULL, NULL, true, -1, user_it.flags)) 
-            {
-                goto done;
-            }
-        }
-
-        /* While filter matching needs to be reversed for a Not term, the
-         * component data must be fetched from the table we got notified for.
-         * Repeat the matching process for the non-matching table so we get the
-         * correct column ids and sources, which we need for populate_data */
-        if (term->oper == EcsNot) {
-            flecs_filter_match_table(world, &o->filter, prev_table, user_it.ids, 
-                user_it.columns, user_it.sources, NULL, NULL, false, -1, 
-                user_it.flags | EcsFilterPopulate);
-        }
-
+    /* Events for the same table produce the same result, so that bulk 
+     * operations only evaluate the filter once per table */
+    int32_t field_count = o->filter.field_count;
+    bool hit, match;
+    ecs_observer_match_t *cached = flecs_multi_observer_cache_get(world, o, 
+        table, prev_table, it->event, pivot_term, column, &hit);
+    if (hit) {
+        match = cached->match;
+        if (match) {
+            ecs_os_memcpy_n(user_it.ids, cached->ids, ecs_id_t, field_count);
+            ecs_os_memcpy_n(user_it.columns, cached->columns, int32_t, 
+                field_count);
+            ecs_os_memcpy_n(user_it.sources, cached->sources, ecs_entity_t, 
+                field_count);
+        }
+    } else {
+        match = flecs_multi_observer_match(
+            world, o, &user_it, table, prev_table, term);
+        if (cached) {
+            cached->table = table;
+            cached->prev_table = prev_table;
+            cached->event = it->event;
+            cached->pivot_term = pivot_term;
+            cached->column = column;
+            cached->match = match;
+            if (match) {
+                ecs_os_memcpy_n(cached->ids, user_it.ids, ecs_id_t, 
+                    field_count);
+                ecs_os_memcpy_n(cached->columns, user_it.columns, int32_t, 
+                    field_count);
+                ecs_os_memcpy_n(cached->sources, user_it.sources, 
+                    ecs_entity_t, field_count);
+            }
+        }
+    }
+
+    if (match) {
         flecs_iter_populate_data(world, &user_it, it->table, it->offset, 
             it->count, user_it.ptrs, user_it.sizes);
 
@@ -45009,7 +49326,6 @@ bool flecs_multi_observer_invoke(ecs_iter_t *it) {
         return true;
     }
 
-done:
     ecs_iter_fini(&user_it);
     return false;
 }
@@ -45202,8 +49518,23 @@ int flecs_multi_observer_init(
     /* Mark observer as multi observer */
     observer->is_multi = true;
 
-    /* Create a child observer for each term in the filter */
+    /* Cache filter results if they only depend on the matched table */
     ecs_filter_t *filter = &observer->filter;
+    bool has_up;
+    if (flecs_multi_observer_can_cache(filter, &has_up)) {
+        int32_t i, field_count = filter->field_count;
+        ecs_observer_match_cache_t *cache = observer->match_cache = 
+            ecs_os_calloc_t(ecs_observer_match_cache_t);
+        cache->has_up = has_up;
+        for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+            ecs_observer_match_t *m = &cache->entries[i];
+            m->ids = ecs_os_calloc_n(ecs_id_t, field_count);
+            m->columns = ecs_os_calloc_n(int32_t, field_count);
+            m->sources = ecs_os_calloc_n(ecs_entity_t, field_count);
+        }
+    }
+
+    /* Create a child observer for each term in the filter */
     ecs_observer_desc_t child_desc = *desc;
     child_desc.last_event_id = observer->last_event_id;
     child_desc.run = NULL;
@@ -45340,6 +49671,9 @@ ecs_entity_t ecs_observer_init(
          * filter will have the name of the observer. */
         ecs_filter_desc_t filter_desc = desc->filter;
         filter_desc.name = ecs_get_name(world, entity);
+        if (desc->batched) {
+            filter_desc.instanced = true;
+        }
         ecs_filter_t *filter = filter_desc.storage = &observer->filter;
         *filter = ECS_FILTER_INIT;
 
@@ -45476,6 +49810,18 @@ void flecs_observer_fini(
     if (observer->is_multi) {
         /* Child observers get deleted up by entity cleanup logic */
         ecs_os_free(observer->last_event_id);
+
+        ecs_observer_match_cache_t *cache = observer->match_cache;
+        if (cache) {
+            int32_t i;
+            for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+                ecs_observer_match_t *m = &cache->entries[i];
+                ecs_os_free(m->ids);
+                ecs_os_free(m->columns);
+                ecs_os_free(m->sources);
+            }
+            ecs_os_free(cache);
+        }
     } else {
         if (observer->filter.term_count) {
             flecs_unregister_observer(
@@ -45803,11 +50149,27 @@ int64_t ecs_os_api_realloc_count = 0;
 int64_t ecs_os_api_calloc_count = 0;
 int64_t ecs_os_api_free_count = 0;
 
+/* Atomic load for OS API implementations that don't provide one. MSVC gives
+ * volatile loads acquire semantics on the platforms it supports. */
+static
+int32_t ecs_os_api_aload(
+    const int32_t *value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    return *(const volatile int32_t*)value;
+#endif
+}
+
 void ecs_os_set_api(
     ecs_os_api_t *os_api)
 {
     if (!ecs_os_api_initialized) {
         ecs_os_api = *os_api;
+        if (!ecs_os_api.aload_) {
+            ecs_os_api.aload_ = ecs_os_api_aload;
+        }
         ecs_os_api_initialized = true;
     }
 }
@@ -46211,6 +50573,11 @@ void ecs_os_set_api_defaults(void)
         ecs_os_api.module_to_etc_ = ecs_os_api_module_to_etc;
     }
 
+    /* Atomics */
+    if (!ecs_os_api.aload_) {
+        ecs_os_api.aload_ = ecs_os_api_aload;
+    }
+
     ecs_os_api.abort_ = abort;
 
 #   ifdef FLECS_OS_API_IMPL
@@ -46243,7 +50610,7 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL);
 }
 
 bool ecs_os_has_time(void) {
@@ -46489,6 +50856,21 @@ ecs_query_table_list_t* flecs_query_ensure_node_list(
     }
 }
 
+/* Mark table array of query as outdated. The query is added to a queue on the
+ * world, so that only queries with changed tables are updated. */
+static
+void flecs_query_table_array_dirty(
+    ecs_query_t *query)
+{
+    query->flags |= EcsQueryTableArrayDirty;
+    if (!(query->flags & EcsQueryTableArrayQueued)) {
+        ecs_query_t **elem = ecs_vector_add(
+            &query->world->pending_queries, ecs_query_t*);
+        *elem = query;
+        query->flags |= EcsQueryTableArrayQueued;
+    }
+}
+
 /* Remove node from list */
 static
 void flecs_query_remove_table_node(
@@ -46578,6 +50960,7 @@ void flecs_query_remove_table_node(
     node->next = NULL;
 
     query->match_count ++;
+    flecs_query_table_array_dirty(query);
 }
 
 /* Add node to list */
@@ -46641,6 +51024,7 @@ void flecs_query_insert_table_node(
 
     query->list.info.table_count ++;
     query->match_count ++;
+    flecs_query_table_array_dirty(query);
 
     ecs_assert(node->prev != node, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(node->next != node, ECS_INTERNAL_ERROR, NULL);
@@ -47049,6 +51433,9 @@ void flecs_query_set_table_match(
     int32_t field_count = filter->field_count;
     ecs_term_t *terms = filter->terms;
 
+    /* Table arrays store pointers to match resources */
+    flecs_query_table_array_dirty(query);
+
     /* Reset resources in case this is an existing record */
     if (qm->sparse_columns) {
         ecs_vector_free(qm->sparse_columns);
@@ -47078,6 +51465,11 @@ void flecs_query_set_table_match(
             }
         }
 
+        /* Track changes per block of rows for changed_only queries */
+        if (query->flags & EcsQueryChangedOnly) {
+            flecs_table_get_dirty_blocks(world, table);
+        }
+
         /* Look for union fields */
         if (table->flags & EcsTableHasUnion) {
             for (i = 0; i < term_count; i ++) {
@@ -47110,6 +51502,20 @@ void flecs_query_set_table_match(
             }
         }
 
+        /* Sparse fields are not stored in the table */
+        if (query->flags & EcsQueryHasSparse) {
+            int32_t count = ecs_vector_count(query->sparse_terms);
+            flecs_sparse_join_term_t *jt = ecs_vector_first(
+                query->sparse_terms, flecs_sparse_join_term_t);
+            for (i = 0; i < count; i ++) {
+                int32_t field = jt[i].field_index;
+                if (!qm->columns[field]) {
+                    qm->ids[field] = jt[i].idr->id;
+                    qm->sizes[field] = jt[i].idr->type_info->size;
+                }
+            }
+        }
+
         /* Look for disabled fields */
         if (table->flags & EcsTableHasToggle) {
             for (i = 0; i < term_count; i ++) {
@@ -47162,6 +51568,17 @@ void flecs_query_set_table_match(
     }
 }
 
+/* Filter used to match tables with the query */
+static
+ecs_filter_t* flecs_query_match_filter(
+    ecs_query_t *query)
+{
+    if (query->flags & EcsQueryHasSparse) {
+        return &query->match_filter;
+    }
+    return &query->filter;
+}
+
 /** Populate query cache with tables */
 static
 void flecs_query_match_tables(
@@ -47171,7 +51588,7 @@ void flecs_query_match_tables(
     ecs_table_t *table = NULL;
     ecs_query_table_t *qt = NULL;
 
-    ecs_iter_t it = ecs_filter_iter(world, &query->filter);
+    ecs_iter_t it = ecs_filter_iter(world, flecs_query_match_filter(query));
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
@@ -47200,7 +51617,7 @@ bool flecs_query_match_table(
     }
 
     ecs_query_table_t *qt = NULL;
-    ecs_filter_t *filter = &query->filter;
+    ecs_filter_t *filter = flecs_query_match_filter(query);
     int var_id = ecs_filter_find_this_var(filter);
     if (var_id == -1) {
         /* If query doesn't match with This term, it can't match with tables */
@@ -47228,6 +51645,60 @@ bool flecs_query_match_table(
 
 ECS_SORT_TABLE_WITH_COMPARE(_, flecs_query_sort_table_generic, order_by, static)
 
+/* Max number of out of order rows for which insertion sort is used instead of
+ * a full sort. Tables of a sorted query are typically already sorted, except
+ * for a few rows that were added or changed since the last sort. */
+#define ECS_SORT_INSERTION_THRESHOLD (16)
+
+/* Min number of rows per out of order row for insertion sort. Small tables are
+ * cheap to sort regardless, and use the regular sort. */
+#define ECS_SORT_INSERTION_RATIO (32)
+
+/* Count number of rows that compare lower than their predecessor */
+static
+int32_t flecs_query_count_unsorted(
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, result = 0;
+    for (i = 1; i < count; i ++) {
+        if (compare(entities[i - 1], ECS_ELEM(ptr, size, i - 1),
+            entities[i], ECS_ELEM(ptr, size, i)) > 0)
+        {
+            result ++;
+        }
+    }
+    return result;
+}
+
+/* Insertion sort only moves a row past rows that compare higher, so rows with
+ * equal values keep their order. */
+static
+void flecs_query_insertion_sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, j;
+    for (i = 1; i < count; i ++) {
+        for (j = i; j > 0; j --) {
+            if (compare(entities[j - 1], ECS_ELEM(ptr, size, j - 1),
+                entities[j], ECS_ELEM(ptr, size, j)) <= 0)
+            {
+                break;
+            }
+            ecs_table_swap_rows(world, table, j - 1, j);
+        }
+    }
+}
+
 static
 void flecs_query_sort_table(
     ecs_world_t *world,
@@ -47258,6 +51729,24 @@ void flecs_query_sort_table(
         ptr = ecs_vec_first(column);
     }
 
+    /* A table is marked dirty when any of its rows is written, which doesn't
+     * mean that its order changed. Do a linear pass first to find out if (and
+     * how much) sorting is necessary. Both shortcuts keep the order of rows
+     * with equal values, so equal rows don't swap places on each resort. */
+    int32_t unsorted = flecs_query_count_unsorted(
+        entities, ptr, size, count, compare);
+    if (!unsorted) {
+        return;
+    }
+
+    if (unsorted <= ECS_SORT_INSERTION_THRESHOLD && 
+        (unsorted * ECS_SORT_INSERTION_RATIO) <= count) 
+    {
+        flecs_query_insertion_sort_table(
+            world, table, entities, ptr, size, count, compare);
+        return;
+    }
+
     if (sort) {
         sort(world, table, entities, ptr, size, 0, count - 1, compare);
     } else {
@@ -47301,6 +51790,54 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Returns true if the current row of helper a sorts before helper b. Ties are
+ * resolved by helper index, so that rows from tables earlier in the list come
+ * first. */
+static
+bool flecs_query_sort_helper_lt(
+    sort_helper_t *helper,
+    int32_t a,
+    int32_t b,
+    ecs_order_by_action_t compare)
+{
+    int r = compare(e_from_helper(&helper[a]), ptr_from_helper(&helper[a]),
+        e_from_helper(&helper[b]), ptr_from_helper(&helper[b]));
+    if (r) {
+        return r < 0;
+    }
+    return a < b;
+}
+
+static
+void flecs_query_sort_heap_down(
+    sort_helper_t *helper,
+    int32_t *heap,
+    int32_t count,
+    int32_t i,
+    ecs_order_by_action_t compare)
+{
+    for (;;) {
+        int32_t min = i, l = 2 * i + 1, r = l + 1;
+        if (l < count && flecs_query_sort_helper_lt(
+            helper, heap[l], heap[min], compare))
+        {
+            min = l;
+        }
+        if (r < count && flecs_query_sort_helper_lt(
+            helper, heap[r], heap[min], compare))
+        {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+        int32_t tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    }
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -47368,56 +51905,43 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
-        }
-
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
-            }
-
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
-
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
-            }
-        }
-
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
-            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->match = cur_helper->match;
-            cur->offset = cur_helper->row;
-            cur->count = 1;
+    /* Merge sorted tables with a min-heap of helpers, ordered by the current
+     * row of each helper. Popping the next row is O(log k) in the number of
+     * tables, instead of a linear scan over all helpers. */
+    int32_t i, heap_count = to_sort;
+    int32_t *heap = ecs_os_malloc_n(int32_t, to_sort);
+    for (i = 0; i < to_sort; i ++) {
+        heap[i] = i;
+    }
+    for (i = heap_count / 2 - 1; i >= 0; i --) {
+        flecs_query_sort_heap_down(helper, heap, heap_count, i, compare);
+    }
+
+    ecs_query_table_node_t *slice = NULL;
+    while (heap_count) {
+        sort_helper_t *cur_helper = &helper[heap[0]];
+        if (!slice || slice->match != cur_helper->match) {
+            slice = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
+            ecs_assert(slice != NULL, ECS_INTERNAL_ERROR, NULL);
+            slice->match = cur_helper->match;
+            slice->offset = cur_helper->row;
+            slice->count = 1;
         } else {
-            cur->count ++;
+            slice->count ++;
         }
 
         cur_helper->row ++;
-    } while (proceed);
+        if (cur_helper->row == cur_helper->count) {
+            heap[0] = heap[-- heap_count];
+        }
+        flecs_query_sort_heap_down(helper, heap, heap_count, 0, compare);
+    }
+
+    ecs_os_free(heap);
 
     /* Iterate through the vector of slices to set the prev/next ptrs. This
      * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vector_count(query->table_slices);    
+    int32_t count = ecs_vector_count(query->table_slices);
     ecs_query_table_node_t *nodes = ecs_vector_first(
         query->table_slices, ecs_query_table_node_t);
     for (i = 0; i < count; i ++) {
@@ -47462,6 +51986,174 @@ void flecs_query_build_sorted_tables(
     }
 }
 
+static
+void flecs_query_table_data_init(
+    ecs_query_table_data_t *data,
+    ecs_query_table_match_t *match)
+{
+    data->columns = match->columns;
+    data->storage_columns = match->storage_columns;
+    data->ids = match->ids;
+    data->sources = match->sources;
+    data->sizes = match->sizes;
+    data->references = ecs_vec_first(&match->refs);
+    data->sparse_columns = match->sparse_columns;
+    data->bitset_columns = match->bitset_columns;
+}
+
+static
+void flecs_query_table_array_free(
+    ecs_query_table_array_t *array)
+{
+    ecs_os_free(array->elems);
+    ecs_os_free(array);
+}
+
+/* Free retired arrays that are no longer used by iterators. Returns the number
+ * of arrays that are still in use. */
+static
+int32_t flecs_query_table_array_sweep(
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->table_array_retired);
+    ecs_query_table_array_t **arrays = ecs_vector_first(
+        query->table_array_retired, ecs_query_table_array_t*);
+    
+    for (i = count - 1; i >= 0; i --) {
+        if (!ecs_os_aload(&arrays[i]->refs)) {
+            flecs_query_table_array_free(arrays[i]);
+            arrays[i] = arrays[-- count];
+        }
+    }
+
+    ecs_vector_set_count(&query->table_array_retired, 
+        ecs_query_table_array_t*, count);
+
+    return count;
+}
+
+/* Build array with copies of the list nodes. Iterating the array is a linear
+ * scan, whereas nodes in the list are scattered across match allocations. The
+ * array is only rebuilt on the main thread after the set of iterated tables
+ * changed, so iterators (which can run on worker threads) only read from it.
+ * An array that is referenced by an iterator is never modified. Instead a new
+ * array is created, and the old one is retired until its iterators are done. */
+static
+void flecs_query_build_table_array(
+    ecs_query_t *query)
+{
+    ecs_assert(!(query->world->flags & EcsWorldReadonly), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (!(query->flags & EcsQueryTableArrayDirty)) {
+        return;
+    }
+
+    query->flags &= ~EcsQueryTableArrayDirty;
+
+    /* Sorted queries iterate the table slices */
+    if (query->order_by) {
+        return;
+    }
+
+    ecs_query_table_node_t *cur;
+    int32_t i = 0, count = 0;
+    for (cur = query->list.first; cur; cur = cur->next) {
+        count ++;
+    }
+
+    ecs_query_table_array_t *array = query->table_array;
+    if (array && (array->size < count || ecs_os_aload(&array->refs) != 1)) {
+        if (ecs_os_adec(&array->refs)) {
+            ecs_query_table_array_t **retired = ecs_vector_add(
+                &query->table_array_retired, ecs_query_table_array_t*);
+            *retired = array;
+        } else {
+            flecs_query_table_array_free(array);
+        }
+        array = query->table_array = NULL;
+    }
+
+    if (!count) {
+        if (array) {
+            array->count = 0;
+        }
+        return;
+    }
+
+    if (!array) {
+        array = query->table_array = ecs_os_calloc_t(ecs_query_table_array_t);
+        array->size = flecs_next_pow_of_2(count);
+        array->elems = ecs_os_malloc_n(ecs_query_table_elem_t, array->size);
+        array->refs = 1;
+    }
+
+    array->count = count;
+    ecs_query_table_elem_t *elems = array->elems;
+
+    for (cur = query->list.first; cur; cur = cur->next, i ++) {
+        ecs_query_table_node_t *node = &elems[i].node;
+        *node = *cur;
+        node->prev = i ? &elems[i - 1].node : NULL;
+        node->next = (i < (count - 1)) ? &elems[i + 1].node : NULL;
+        flecs_query_table_data_init(&elems[i].data, cur->match);
+    }
+}
+
+/* Bring table array of query up to date. Returns whether the query must stay
+ * queued, which is the case while retired arrays are used by iterators. */
+bool flecs_query_update_table_array(
+    ecs_query_t *query)
+{
+    flecs_query_build_table_array(query);
+    if (flecs_query_table_array_sweep(query)) {
+        return true;
+    }
+
+    query->flags &= ~EcsQueryTableArrayQueued;
+    return false;
+}
+
+static
+void flecs_query_table_array_fini(
+    ecs_query_t *query)
+{
+    if (query->flags & EcsQueryTableArrayQueued) {
+        ecs_world_t *world = query->world;
+        int32_t i, count = ecs_vector_count(world->pending_queries);
+        ecs_query_t **queries = ecs_vector_first(
+            world->pending_queries, ecs_query_t*);
+        for (i = 0; i < count; i ++) {
+            if (queries[i] == query) {
+                ecs_vector_remove(world->pending_queries, ecs_query_t*, i);
+                break;
+            }
+        }
+    }
+
+    if (query->table_array) {
+        flecs_query_table_array_free(query->table_array);
+    }
+
+    ecs_vector_each(query->table_array_retired, ecs_query_table_array_t*, 
+        array, {
+            flecs_query_table_array_free(*array);
+        });
+    ecs_vector_free(query->table_array_retired);
+}
+
+static
+void flecs_query_table_array_release(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    if (iter->table_array) {
+        /* Arrays are only freed on the main thread */
+        ecs_os_adec(&iter->table_array->refs);
+        iter->table_array = NULL;
+    }
+}
+
 static
 void flecs_query_sort_tables(
     ecs_world_t *world,
@@ -47607,6 +52299,99 @@ bool flecs_query_is_term_id_supported(
     return false;
 }
 
+/* Terms for sparse components can't be matched with tables, as the component
+ * is never stored in a table. Tables are matched with a copy of the filter in
+ * which these terms are optional, and the terms are evaluated per entity while
+ * iterating. */
+static
+int flecs_query_init_sparse_terms(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return 0;
+    }
+
+    ecs_term_t *terms = query->filter.terms;
+    ecs_term_t *match_terms = NULL;
+    int32_t i, count = query->filter.term_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (!ecs_term_match_this(term)) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper != EcsAnd && oper != EcsNot && oper != EcsOptional) {
+            continue;
+        }
+
+        ecs_id_t id = term->id;
+        if (ecs_id_is_wildcard(id)) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+        if (!idr) {
+            continue;
+        }
+
+        flecs_id_record_claim(world, idr);
+
+        flecs_sparse_join_term_t *jt = ecs_vector_add(
+            &query->sparse_terms, flecs_sparse_join_term_t);
+        jt->idr = idr;
+        jt->oper = oper;
+        jt->field_index = term->field_index;
+
+        /* Terms are copied by ecs_filter_init, so a shallow copy is enough */
+        if (!match_terms) {
+            match_terms = ecs_os_memdup_n(terms, ecs_term_t, count);
+        }
+        match_terms[i].oper = EcsOptional;
+
+        query->flags |= EcsQueryHasSparse;
+        if (oper != EcsNot && term->inout != EcsInOutNone) {
+            query->flags |= EcsQueryHasSparseData;
+        }
+    }
+
+    if (!match_terms) {
+        return 0;
+    }
+
+    query->match_filter = ECS_FILTER_INIT;
+    ecs_filter_t *f = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .terms_buffer = match_terms,
+        .terms_buffer_count = count,
+        .storage = &query->match_filter,
+        .flags = query->filter.flags & 
+            (EcsFilterMatchEmptyTables | EcsFilterMatchSparse)
+    });
+    ecs_os_free(match_terms);
+
+    return f ? 0 : -1;
+}
+
+static
+void flecs_query_fini_sparse_terms(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    for (i = 0; i < count; i ++) {
+        flecs_id_record_release(world, terms[i].idr);
+    }
+    ecs_vector_free(query->sparse_terms);
+
+    if (query->flags & EcsQueryHasSparse) {
+        ecs_filter_fini(&query->match_filter);
+    }
+}
+
 static
 int flecs_query_process_signature(
     ecs_world_t *world,
@@ -47813,9 +52598,10 @@ void flecs_query_rematch_tables(
 
     if (parent_query) {
         parent_it = ecs_query_iter(world, parent_query);
-        it = ecs_filter_chain_iter(&parent_it, &query->filter);
+        it = ecs_filter_chain_iter(
+            &parent_it, flecs_query_match_filter(query));
     } else {
-        it = ecs_filter_iter(world, &query->filter);
+        it = ecs_filter_iter(world, flecs_query_match_filter(query));
     }
 
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
@@ -48142,6 +52928,8 @@ void flecs_query_fini(
 
     ecs_vector_free(query->subqueries);
     ecs_vector_free(query->table_slices);
+    flecs_query_table_array_fini(query);
+    flecs_query_fini_sparse_terms(world, query);
     ecs_filter_fini(&query->filter);
 
     flecs_query_allocators_fini(query);
@@ -48165,7 +52953,8 @@ ecs_query_t* ecs_query_init(
     ecs_observer_desc_t observer_desc = { .filter = desc->filter };
     ecs_entity_t entity = desc->entity;
 
-    observer_desc.filter.flags = EcsFilterMatchEmptyTables;
+    observer_desc.filter.flags = EcsFilterMatchEmptyTables | 
+        EcsFilterMatchSparse;
     observer_desc.filter.storage = &result->filter;
     result->filter = ECS_FILTER_INIT;
 
@@ -48174,6 +52963,9 @@ ecs_query_t* ecs_query_init(
     }
 
     flecs_query_allocators_init(result);
+    if (flecs_query_init_sparse_terms(world, result)) {
+        goto error;
+    }
 
     if (result->filter.term_count) {
         observer_desc.entity = entity;
@@ -48185,8 +52977,9 @@ ecs_query_t* ecs_query_init(
 
         /* ecs_filter_init could have moved away resources from the terms array
          * in the descriptor, so use the terms array from the filter. */
-        observer_desc.filter.terms_buffer = result->filter.terms;
-        observer_desc.filter.terms_buffer_count = result->filter.term_count;
+        const ecs_filter_t *match_filter = flecs_query_match_filter(result);
+        observer_desc.filter.terms_buffer = match_filter->terms;
+        observer_desc.filter.terms_buffer_count = match_filter->term_count;
         observer_desc.filter.expr = NULL; /* Already parsed */
 
         entity = ecs_observer_init(world, &observer_desc);
@@ -48236,6 +53029,10 @@ ecs_query_t* ecs_query_init(
         result->flags |= EcsQueryIsSubquery;
     }
 
+    if (desc->changed_only) {
+        result->flags |= EcsQueryChangedOnly | EcsQueryHasMonitor;
+    }
+
     /* If the query refers to itself, add the components that were queried for
      * to the query itself. */
     if (entity)  {
@@ -48350,8 +53147,27 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
-        it.node = ecs_vector_first(query->table_slices, ecs_query_table_node_t);
+    if (query->order_by) {
+        if (query->list.info.table_count) {
+            it.node = ecs_vector_first(
+                query->table_slices, ecs_query_table_node_t);
+        }
+    } else {
+        /* The table array is kept up to date while processing table events,
+         * which happens before the world enters readonly mode. Rematching or
+         * matching new tables can outdate it outside of table events. */
+        if (!(world->flags & EcsWorldReadonly)) {
+            flecs_query_build_table_array(query);
+        }
+        ecs_assert(!(query->flags & EcsQueryTableArrayDirty),
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_query_table_array_t *array = query->table_array;
+        if (array && array->count) {
+            it.node = &array->elems[0].node;
+            it.table_array = array;
+        } else {
+            it.node = NULL;
+        }
     }
 
     ecs_flags32_t flags = 0;
@@ -48405,10 +53221,17 @@ ecs_iter_t ecs_query_iter(
         ecs_iter_fini(&fit);
     }
 
+    /* Keep array alive while it's iterated */
+    if (it.table_array) {
+        ecs_os_ainc(&it.table_array->refs);
+        result.fini = flecs_query_table_array_release;
+    }
+
     return result;
 error:
 noresults:
     result.priv.iter.query.node = NULL;
+    result.priv.iter.query.table_array = NULL;
     return result;
 }
 
@@ -48424,6 +53247,9 @@ void ecs_query_set_group(
     ecs_query_t *q = qit->query;
     ecs_check(q != NULL, ECS_INVALID_PARAMETER, NULL);
 
+    /* Group nodes are iterated from the list */
+    flecs_query_table_array_release(it);
+
     ecs_query_table_list_t *node = flecs_query_get_group(q, group_id);
     if (!node) {
         qit->node = NULL;
@@ -48546,51 +53372,65 @@ int sparse_column_next(
 
     /* Find next entity to iterate in sparse column */
     int32_t first, sparse_first = iter->sparse_first;
+    int32_t i, count = ecs_vector_count(sparse_columns);
 
     if (!filter) {
+        /* Scan elements of smallest case, from last to first so that entities
+         * that most recently switched to the case are returned first. */
+        const int32_t *elements = flecs_switch_elements(
+            sw_smallest, case_smallest);
+        int32_t index = sparse_first;
         if (first_iteration) {
-            first = flecs_switch_first(sw_smallest, case_smallest);
-        } else {
-            first = flecs_switch_next(sw_smallest, sparse_first);
+            index = flecs_switch_case_count(sw_smallest, case_smallest);
         }
-    } else {
-        int32_t cur_first = cur->first, cur_count = cur->count;
-        first = cur_first;
-        while (flecs_switch_get(sw_smallest, first) != case_smallest) {
-            first ++;
-            if (first >= (cur_first + cur_count)) {
-                first = -1;
-                break;
+
+        do {
+            if (!index) {
+                goto done;
             }
-        }
-    }
 
-    if (first == -1) {
-        goto done;
-    }
+            first = elements[-- index];
 
-    /* Check if entity matches with other sparse columns, if any */
-    int32_t i, count = ecs_vector_count(sparse_columns);
-    do {
-        for (i = 0; i < count; i ++) {
-            if (i == sparse_smallest) {
-                /* Already validated this one */
-                continue;
-            }
+            /* Check if entity matches with other sparse columns, if any */
+            for (i = 0; i < count; i ++) {
+                if (i == sparse_smallest) {
+                    /* Already validated this one */
+                    continue;
+                }
 
-            column = &columns[i];
-            sw = column->sw_column;
+                column = &columns[i];
+                sw = column->sw_column;
+                if (flecs_switch_get(sw, first) != column->sw_case) {
+                    break;
+                }
+            }
+        } while (i != count);
 
-            if (flecs_switch_get(sw, first) != column->sw_case) {
-                first = flecs_switch_next(sw_smallest, first);
-                if (first == -1) {
-                    goto done;
+        iter->sparse_first = index;
+    } else {
+        /* Find first entity in range that matches all sparse columns */
+        int32_t cur_last = cur->first + cur->count;
+        for (first = cur->first; first < cur_last; first ++) {
+            for (i = 0; i < count; i ++) {
+                column = &columns[i];
+                sw = column->sw_column;
+                if (flecs_switch_get(sw, first) != column->sw_case) {
+                    break;
                 }
             }
+            if (i == count) {
+                break;
+            }
         }
-    } while (i != count);
 
-    cur->first = iter->sparse_first = first;
+        if (first == cur_last) {
+            goto done;
+        }
+
+        iter->sparse_first = first;
+    }
+
+    cur->first = first;
     cur->count = 1;
 
     return 0;
@@ -48603,8 +53443,156 @@ done:
     return -1;
 }
 
+/* Test if rows in block changed for any of the columns that are read by the
+ * query, since the query last iterated the match */
+static
+bool flecs_query_block_changed(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_vec_t *dirty_blocks,
+    int32_t block)
+{
+    int32_t *monitor = match->monitor;
+    int32_t *storage_columns = match->storage_columns;
+    int32_t i, field_count = query->filter.field_count;
+    for (i = 0; i < field_count; i ++) {
+        int32_t mon = monitor[i + 1];
+        int32_t column = storage_columns[i];
+        if (mon == -1 || column < 0) {
+            continue;
+        }
+
+        ecs_vec_t *blocks = &dirty_blocks[column];
+        if (block < ecs_vec_count(blocks)) {
+            if (ecs_vec_get_t(blocks, int32_t, block)[0] > mon) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Find next range of rows that changed since the query last iterated the
+ * match. Changes to shared components, or rows that were added, removed or
+ * moved invalidate the entire table. */
+static
+int flecs_query_changed_rows_next(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_query_iter_t *iter,
+    query_iter_cursor_t *cur)
+{
+    ecs_world_t *world = query->world;
+    ecs_table_t *table = match->node.table;
+    int32_t first = cur->first, last = first + cur->count;
+    if (iter->changed_first) {
+        first = iter->changed_first;
+    }
+
+    iter->changed_first = 0;
+
+    if (flecs_query_get_match_monitor(query, match)) {
+        /* Match hasn't been iterated yet, everything changed */
+        goto all;
+    }
+
+    int32_t *monitor = match->monitor;
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    if (monitor[0] != dirty_state[0]) {
+        goto all;
+    }
+
+    int32_t i, field_count = query->filter.field_count;
+    int32_t *storage_columns = match->storage_columns;
+    bool owned_changed = false;
+    for (i = 0; i < field_count; i ++) {
+        int32_t mon = monitor[i + 1];
+        if (mon == -1) {
+            continue;
+        }
+
+        int32_t column = storage_columns[i];
+        if (column >= 0) {
+            if (mon != dirty_state[column + 1]) {
+                owned_changed = true;
+            }
+        } else if (column == -2) {
+            if (flecs_query_check_match_monitor_term(query, match, i + 1)) {
+                goto all;
+            }
+        }
+    }
+
+    if (!owned_changed) {
+        return -1;
+    }
+
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    ecs_assert(dirty_blocks != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t block = first / ECS_DIRTY_BLOCK_SIZE;
+    int32_t block_last = (last - 1) / ECS_DIRTY_BLOCK_SIZE;
+    int32_t block_first = -1;
+    for (; block <= block_last; block ++) {
+        if (flecs_query_block_changed(query, match, dirty_blocks, block)) {
+            if (block_first == -1) {
+                block_first = block;
+            }
+        } else if (block_first != -1) {
+            break;
+        }
+    }
+
+    if (block_first == -1) {
+        return -1;
+    }
+
+    int32_t range_first = block_first * ECS_DIRTY_BLOCK_SIZE;
+    int32_t range_last = block * ECS_DIRTY_BLOCK_SIZE;
+    if (range_first < first) {
+        range_first = first;
+    }
+    if (range_last >= last) {
+        range_last = last;
+    } else {
+        iter->changed_first = range_last;
+    }
+
+    cur->first = range_first;
+    cur->count = range_last - range_first;
+    return 0;
+all:
+    cur->first = first;
+    cur->count = last - first;
+    return 0;
+}
+
 #define BS_MAX ((uint64_t)0xFFFFFFFFFFFFFFFF)
 
+/* Load block of bits that are enabled for all bitset columns. Bits past the
+ * last element are cleared. */
+static
+uint64_t flecs_query_bitset_block(
+    flecs_bitset_term_t *columns,
+    int32_t column_count,
+    int32_t block,
+    int32_t elem_count)
+{
+    uint64_t v = columns[0].bs_column->data[block];
+    int32_t i;
+    for (i = 1; i < column_count; i ++) {
+        v &= columns[i].bs_column->data[block];
+    }
+
+    int32_t remain = elem_count - block * 64;
+    if (remain < 64) {
+        v &= BS_MAX >> (64 - remain);
+    }
+
+    return v;
+}
+
 static
 int bitset_column_next(
     ecs_table_t *table,
@@ -48612,60 +53600,14 @@ int bitset_column_next(
     ecs_query_iter_t *iter,
     query_iter_cursor_t *cur)
 {
-    /* Precomputed single-bit test */
-    static const uint64_t bitmask[64] = {
-    (uint64_t)1 << 0, (uint64_t)1 << 1, (uint64_t)1 << 2, (uint64_t)1 << 3,
-    (uint64_t)1 << 4, (uint64_t)1 << 5, (uint64_t)1 << 6, (uint64_t)1 << 7,
-    (uint64_t)1 << 8, (uint64_t)1 << 9, (uint64_t)1 << 10, (uint64_t)1 << 11,
-    (uint64_t)1 << 12, (uint64_t)1 << 13, (uint64_t)1 << 14, (uint64_t)1 << 15,
-    (uint64_t)1 << 16, (uint64_t)1 << 17, (uint64_t)1 << 18, (uint64_t)1 << 19,
-    (uint64_t)1 << 20, (uint64_t)1 << 21, (uint64_t)1 << 22, (uint64_t)1 << 23,
-    (uint64_t)1 << 24, (uint64_t)1 << 25, (uint64_t)1 << 26, (uint64_t)1 << 27,  
-    (uint64_t)1 << 28, (uint64_t)1 << 29, (uint64_t)1 << 30, (uint64_t)1 << 31,
-    (uint64_t)1 << 32, (uint64_t)1 << 33, (uint64_t)1 << 34, (uint64_t)1 << 35,  
-    (uint64_t)1 << 36, (uint64_t)1 << 37, (uint64_t)1 << 38, (uint64_t)1 << 39,
-    (uint64_t)1 << 40, (uint64_t)1 << 41, (uint64_t)1 << 42, (uint64_t)1 << 43,
-    (uint64_t)1 << 44, (uint64_t)1 << 45, (uint64_t)1 << 46, (uint64_t)1 << 47,  
-    (uint64_t)1 << 48, (uint64_t)1 << 49, (uint64_t)1 << 50, (uint64_t)1 << 51,
-    (uint64_t)1 << 52, (uint64_t)1 << 53, (uint64_t)1 << 54, (uint64_t)1 << 55,  
-    (uint64_t)1 << 56, (uint64_t)1 << 57, (uint64_t)1 << 58, (uint64_t)1 << 59,
-    (uint64_t)1 << 60, (uint64_t)1 << 61, (uint64_t)1 << 62, (uint64_t)1 << 63
-    };
-
-    /* Precomputed test to verify if remainder of block is set (or not) */
-    static const uint64_t bitmask_remain[64] = {
-    BS_MAX, BS_MAX - (BS_MAX >> 63), BS_MAX - (BS_MAX >> 62),
-    BS_MAX - (BS_MAX >> 61), BS_MAX - (BS_MAX >> 60), BS_MAX - (BS_MAX >> 59),
-    BS_MAX - (BS_MAX >> 58), BS_MAX - (BS_MAX >> 57), BS_MAX - (BS_MAX >> 56), 
-    BS_MAX - (BS_MAX >> 55), BS_MAX - (BS_MAX >> 54), BS_MAX - (BS_MAX >> 53), 
-    BS_MAX - (BS_MAX >> 52), BS_MAX - (BS_MAX >> 51), BS_MAX - (BS_MAX >> 50), 
-    BS_MAX - (BS_MAX >> 49), BS_MAX - (BS_MAX >> 48), BS_MAX - (BS_MAX >> 47), 
-    BS_MAX - (BS_MAX >> 46), BS_MAX - (BS_MAX >> 45), BS_MAX - (BS_MAX >> 44), 
-    BS_MAX - (BS_MAX >> 43), BS_MAX - (BS_MAX >> 42), BS_MAX - (BS_MAX >> 41), 
-    BS_MAX - (BS_MAX >> 40), BS_MAX - (BS_MAX >> 39), BS_MAX - (BS_MAX >> 38), 
-    BS_MAX - (BS_MAX >> 37), BS_MAX - (BS_MAX >> 36), BS_MAX - (BS_MAX >> 35), 
-    BS_MAX - (BS_MAX >> 34), BS_MAX - (BS_MAX >> 33), BS_MAX - (BS_MAX >> 32), 
-    BS_MAX - (BS_MAX >> 31), BS_MAX - (BS_MAX >> 30), BS_MAX - (BS_MAX >> 29), 
-    BS_MAX - (BS_MAX >> 28), BS_MAX - (BS_MAX >> 27), BS_MAX - (BS_MAX >> 26), 
-    BS_MAX - (BS_MAX >> 25), BS_MAX - (BS_MAX >> 24), BS_MAX - (BS_MAX >> 23), 
-    BS_MAX - (BS_MAX >> 22), BS_MAX - (BS_MAX >> 21), BS_MAX - (BS_MAX >> 20), 
-    BS_MAX - (BS_MAX >> 19), BS_MAX - (BS_MAX >> 18), BS_MAX - (BS_MAX >> 17), 
-    BS_MAX - (BS_MAX >> 16), BS_MAX - (BS_MAX >> 15), BS_MAX - (BS_MAX >> 14), 
-    BS_MAX - (BS_MAX >> 13), BS_MAX - (BS_MAX >> 12), BS_MAX - (BS_MAX >> 11), 
-    BS_MAX - (BS_MAX >> 10), BS_MAX - (BS_MAX >> 9), BS_MAX - (BS_MAX >> 8), 
-    BS_MAX - (BS_MAX >> 7), BS_MAX - (BS_MAX >> 6), BS_MAX - (BS_MAX >> 5), 
-    BS_MAX - (BS_MAX >> 4), BS_MAX - (BS_MAX >> 3), BS_MAX - (BS_MAX >> 2),
-    BS_MAX - (BS_MAX >> 1)
-    };
-
     int32_t i, count = ecs_vector_count(bitset_columns);
     flecs_bitset_term_t *columns = ecs_vector_first(
         bitset_columns, flecs_bitset_term_t);
     int32_t bs_offset = table->bs_offset;
 
-    int32_t first = iter->bitset_first;
-    int32_t last = 0;
-
+    /* Enabled elements are found by testing blocks of 64 bits, in which the
+     * bits of all bitset columns are combined. */
+    int32_t elem_count = 0;
     for (i = 0; i < count; i ++) {
         flecs_bitset_term_t *column = &columns[i];
         ecs_bitset_t *bs = columns[i].bs_column;
@@ -48676,126 +53618,165 @@ int bitset_column_next(
             bs = &table->data.bs_columns[index - bs_offset];
             columns[i].bs_column = bs;
         }
-        
-        int32_t bs_elem_count = bs->count;
-        int32_t bs_block = first >> 6;
-        int32_t bs_block_count = ((bs_elem_count - 1) >> 6) + 1;
 
-        if (bs_block >= bs_block_count) {
+        if (!i || bs->count < elem_count) {
+            elem_count = bs->count;
+        }
+    }
+
+    int32_t first = iter->bitset_first;
+    if (first >= elem_count) {
+        goto done;
+    }
+
+    /* Step 1: find first block with enabled elements */
+    int32_t block = first >> 6;
+    int32_t block_count = ((elem_count - 1) >> 6) + 1;
+    uint64_t v = flecs_query_bitset_block(columns, count, block, elem_count);
+    v &= BS_MAX << (first & 0x3F);
+    while (!v) {
+        if ((++ block) >= block_count) {
+            /* No enabled elements left */
             goto done;
         }
+        v = flecs_query_bitset_block(columns, count, block, elem_count);
+    }
 
-        uint64_t *data = bs->data;
-        int32_t bs_start = first & 0x3F;
+    first = block * 64 + flecs_ctz64(v);
 
-        /* Step 1: find the first non-empty block */
-        uint64_t v = data[bs_block];
-        uint64_t remain = bitmask_remain[bs_start];
-        while (!(v & remain)) {
-            /* If no elements are remaining, move to next block */
-            if ((++bs_block) >= bs_block_count) {
-                /* No non-empty blocks left */
-                goto done;
-            }
+    /* Step 2: find first disabled element after the first enabled element */
+    uint64_t disabled = ~v & (BS_MAX << (first & 0x3F));
+    while (!disabled) {
+        if ((++ block) >= block_count) {
+            break;
+        }
+        disabled = ~flecs_query_bitset_block(
+            columns, count, block, elem_count);
+    }
 
-            bs_start = 0;
-            remain = BS_MAX; /* Test the full block */
-            v = data[bs_block];
+    int32_t last = elem_count;
+    if (disabled) {
+        last = block * 64 + flecs_ctz64(disabled);
+        if (last > elem_count) {
+            last = elem_count;
         }
+    }
 
-        /* Step 2: find the first non-empty element in the block */
-        while (!(v & bitmask[bs_start])) {
-            bs_start ++;
+    ecs_assert(last > first, ECS_INTERNAL_ERROR, NULL);
 
-            /* Block was not empty, so bs_start must be smaller than 64 */
-            ecs_assert(bs_start < 64, ECS_INTERNAL_ERROR, NULL);
-        }
-        
-        /* Step 3: Find number of contiguous enabled elements after start */
-        int32_t bs_end = bs_start, bs_block_end = bs_block;
-        
-        remain = bitmask_remain[bs_end];
-        while ((v & remain) == remain) {
-            bs_end = 0;
-            bs_block_end ++;
+    cur->first = first;
+    cur->count = last - first;
 
-            if (bs_block_end == bs_block_count) {
-                break;
-            }
+    /* Keep track of last processed element for iteration */ 
+    iter->bitset_first = last;
+
+    return 0;
+done:
+    iter->sparse_smallest = 0;
+    iter->sparse_first = 0;
+    return -1;
+}
 
-            v = data[bs_block_end];
-            remain = BS_MAX; /* Test the full block */
+static
+bool flecs_query_sparse_match_row(
+    const flecs_sparse_join_term_t *terms,
+    int32_t term_count,
+    const ecs_query_table_match_t *match,
+    ecs_entity_t e)
+{
+    int32_t i;
+    for (i = 0; i < term_count; i ++) {
+        const flecs_sparse_join_term_t *jt = &terms[i];
+        ecs_oper_kind_t oper = jt->oper;
+        if (oper == EcsOptional) {
+            continue;
         }
 
-        /* Step 4: find remainder of enabled elements in current block */
-        if (bs_block_end != bs_block_count) {
-            while ((v & bitmask[bs_end])) {
-                bs_end ++;
-            }
+        bool has = match->columns[jt->field_index] != 0 || 
+            flecs_sparse_component_get(jt->idr, e) != NULL;
+        if (has != (oper == EcsAnd)) {
+            return false;
         }
+    }
+    return true;
+}
 
-        /* Block was not 100% occupied, so bs_start must be smaller than 64 */
-        ecs_assert(bs_end < 64, ECS_INTERNAL_ERROR, NULL);
+/* Find the first range of rows in the cursor that matches the sparse terms. If
+ * the query reads sparse data the range is a single row, as sparse components
+ * are not stored contiguously. The remainder of the cursor is stored in the
+ * iterator so the next call can resume from there. */
+static
+bool flecs_query_sparse_join(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_table_t *table,
+    ecs_query_iter_t *iter,
+    query_iter_cursor_t *cur)
+{
+    int32_t term_count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    ecs_entity_t *entities = ecs_vec_first(&table->data.entities);
+    int32_t row = cur->first, end = cur->first + cur->count;
 
-        /* Step 5: translate to element start/end and make sure that each column
-         * range is a subset of the previous one. */
-        first = bs_block * 64 + bs_start;
-        int32_t cur_last = bs_block_end * 64 + bs_end;
-        
-        /* No enabled elements found in table */
-        if (first == cur_last) {
-            goto done;
+    for (; row < end; row ++) {
+        if (flecs_query_sparse_match_row(terms, term_count, match, 
+            entities[row])) 
+        {
+            break;
         }
+    }
 
-        /* If multiple bitsets are evaluated, make sure each subsequent range
-         * is equal or a subset of the previous range */
-        if (i) {
-            /* If the first element of a subsequent bitset is larger than the
-             * previous last value, start over. */
-            if (first >= last) {
-                i = -1;
-                continue;
-            }
+    if (row == end) {
+        iter->join_count = 0;
+        return false;
+    }
 
-            /* Make sure the last element of the range doesn't exceed the last
-             * element of the previous range. */
-            if (cur_last > last) {
-                cur_last = last;
+    int32_t last = row + 1;
+    if (!(query->flags & EcsQueryHasSparseData)) {
+        for (; last < end; last ++) {
+            if (!flecs_query_sparse_match_row(terms, term_count, match, 
+                entities[last])) 
+            {
+                break;
             }
         }
+    }
 
-        last = cur_last;
-        int32_t elem_count = last - first;
+    cur->first = row;
+    cur->count = last - row;
+    iter->join_first = last;
+    iter->join_count = end - last;
 
-        /* Make sure last element doesn't exceed total number of elements in 
-         * the table */
-        if (elem_count > (bs_elem_count - first)) {
-            elem_count = (bs_elem_count - first);
-            if (!elem_count) {
-                iter->bitset_first = 0;
-                goto done;
-            }
+    return true;
+}
+
+static
+void flecs_query_sparse_populate(
+    ecs_query_t *query,
+    ecs_iter_t *it)
+{
+    int32_t i, term_count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    ecs_entity_t e = it->entities[0];
+
+    for (i = 0; i < term_count; i ++) {
+        flecs_sparse_join_term_t *jt = &terms[i];
+        int32_t field = jt->field_index;
+        if (jt->oper == EcsNot || it->columns[field]) {
+            continue;
         }
-        
-        cur->first = first;
-        cur->count = elem_count;
-        iter->bitset_first = first;
+        it->ptrs[field] = flecs_sparse_component_get(jt->idr, e);
     }
-    
-    /* Keep track of last processed element for iteration */ 
-    iter->bitset_first = last;
-
-    return 0;
-done:
-    iter->sparse_smallest = 0;
-    iter->sparse_first = 0;
-    return -1;
 }
 
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    int32_t row,
+    int32_t row_count)
 {
     ecs_table_t *table = qm->node.table;
     if (!table) {
@@ -48822,7 +53803,8 @@ void flecs_query_mark_columns_dirty(
                 continue;
             }
 
-            dirty_state[column + 1] ++;
+            flecs_table_mark_column_dirty(
+                query->world, table, column, row, row_count);
         }
     }
 }
@@ -48842,7 +53824,7 @@ bool ecs_query_next_table(
     if ((query->flags & EcsQueryHasOutColumns)) {
         ecs_query_table_node_t *prev = iter->prev;
         if (prev && it->count) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 0, 0);
         }
     }
 
@@ -48930,12 +53912,41 @@ error:
     return false;
 }
 
-bool ecs_query_next_instanced(
-    ecs_iter_t *it)
+/* Process result returned by previous call to next. Results are processed
+ * once, so a mix of regular and batched iteration doesn't mark twice. */
+static
+void flecs_query_iter_sync_prev(
+    ecs_query_iter_t *iter)
 {
-    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_query_table_node_t *prev = iter->prev;
+    if (!prev) {
+        return;
+    }
 
+    ecs_query_t *query = iter->query;
+    ecs_flags32_t flags = query->flags;
+
+    /* Match has been iterated, update monitor for change tracking. If not
+     * all changed rows or ranges of the match have been returned yet, the 
+     * monitor is synchronized after the last range. */
+    if ((flags & EcsQueryHasMonitor) && !iter->changed_first && 
+        !iter->changed_ranges) 
+    {
+        flecs_query_sync_match_monitor(query, prev->match);
+    }
+    if (flags & EcsQueryHasOutColumns) {
+        flecs_query_mark_columns_dirty(query, prev->match, 
+            iter->prev_first, iter->prev_count);
+    }
+
+    iter->prev = NULL;
+}
+
+/* Find next result. Unlike ecs_query_next_instanced this does not finalize the
+ * iterator when no more results are available. */
+bool flecs_query_iter_next(
+    ecs_iter_t *it)
+{
     ecs_query_iter_t *iter = &it->priv.iter.query;
     ecs_query_t *query = iter->query;
     ecs_world_t *world = query->world;
@@ -48947,16 +53958,11 @@ bool ecs_query_next_instanced(
     (void)world;
 
     query_iter_cursor_t cur;
-    ecs_query_table_node_t *node, *next, *prev, *last;
-    if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
-            flecs_query_sync_match_monitor(query, prev->match);
-        }
-        if (flags & EcsQueryHasOutColumns) {
-            flecs_query_mark_columns_dirty(query, prev->match);
-        }
-    }
+    ecs_query_table_node_t *node, *next, *last;
+    ecs_query_table_data_t list_data;
+    const ecs_query_table_data_t *data;
+    bool is_array = iter->table_array != NULL;
+    flecs_query_iter_sync_prev(iter);
 
     iter->skip_count = 0;
 
@@ -48965,23 +53971,40 @@ bool ecs_query_next_instanced(
     last = iter->last;
     for (node = iter->node; node != last; node = next) {     
         ecs_query_table_match_t *match = node->match;
-        ecs_table_t *table = match->node.table;
+        ecs_table_t *table;
+        if (is_array) {
+            /* Array elements store the match data inline */
+            data = &((ecs_query_table_elem_t*)node)->data;
+            table = node->table;
+        } else {
+            flecs_query_table_data_init(&list_data, match);
+            data = &list_data;
+            table = match->node.table;
+        }
 
         next = node->next;
 
         if (table) {
-            cur.first = node->offset;
-            cur.count = node->count;
-            if (!cur.count) {
-                cur.count = ecs_table_count(table);
+            bool join_resume = iter->join_count != 0;
+            if (join_resume) {
+                /* Continue with remaining rows of previous sparse join */
+                cur.first = iter->join_first;
+                cur.count = iter->join_count;
+                next = iter->join_next;
+            } else {
+                cur.first = node->offset;
+                cur.count = node->count;
+                if (!cur.count) {
+                    cur.count = ecs_table_count(table);
 
-                /* List should never contain empty tables */
-                ecs_assert(cur.count != 0, ECS_INTERNAL_ERROR, NULL);
+                    /* List should never contain empty tables */
+                    ecs_assert(cur.count != 0, ECS_INTERNAL_ERROR, NULL);
+                }
             }
 
-            ecs_vector_t *bitset_columns = match->bitset_columns;
-            ecs_vector_t *sparse_columns = match->sparse_columns;
-            if (bitset_columns || sparse_columns) {
+            ecs_vector_t *bitset_columns = data->bitset_columns;
+            ecs_vector_t *sparse_columns = data->sparse_columns;
+            if (!join_resume && (bitset_columns || sparse_columns)) {
                 bool found = false;
 
                 do {
@@ -49023,11 +54046,50 @@ bool ecs_query_next_instanced(
                 } while (!found);
 
                 if (!found) {
+                    if (iter->changed_ranges) {
+                        /* Last range of changed table has been returned */
+                        flecs_query_sync_match_monitor(query, match);
+                        iter->changed_ranges = false;
+                    }
                     continue;
                 }
             }
 
-            it->group_id = match->node.group_id;
+            if ((flags & EcsQueryChangedOnly) && !join_resume) {
+                if (bitset_columns || sparse_columns) {
+                    /* Row ranges are already determined by toggle/union
+                     * columns, only test if table changed. The table stays
+                     * changed until its last range has been returned. */
+                    if (!iter->changed_ranges && 
+                        !flecs_query_check_match_monitor(query, match)) 
+                    {
+                        continue;
+                    }
+                    iter->changed_ranges = next == node;
+                } else if (flecs_query_changed_rows_next(
+                    query, match, iter, &cur) == -1) 
+                {
+                    /* Nothing changed, sync monitor so that the blocks of
+                     * this table don't have to be tested again */
+                    flecs_query_sync_match_monitor(query, match);
+                    continue;
+                } else if (iter->changed_first) {
+                    /* More changed rows left in table */
+                    next = node;
+                }
+            }
+
+            if (flags & EcsQueryHasSparse) {
+                if (!flecs_query_sparse_join(query, match, table, iter, &cur)) {
+                    continue;
+                }
+                if (iter->join_count) {
+                    iter->join_next = next;
+                    next = node;
+                }
+            }
+
+            it->group_id = is_array ? node->group_id : match->node.group_id;
         } else {
             cur.count = 0;
             cur.first = 0;
@@ -49035,9 +54097,9 @@ bool ecs_query_next_instanced(
 
         if (only_this) {
             /* If query has only This terms, reuse cache storage */
-            it->ids = match->ids;
-            it->columns = match->columns;
-            it->sizes = match->sizes;
+            it->ids = data->ids;
+            it->columns = data->columns;
+            it->sizes = data->sizes;
         } else {
             /* If query has non-This terms make sure not to overwrite them */
             int32_t t, term_count = filter->term_count;
@@ -49048,30 +54110,219 @@ bool ecs_query_next_instanced(
                 }
 
                 int32_t field = term->field_index;
-                it->ids[field] = match->ids[field];
-                it->columns[field] = match->columns[field];
-                it->sizes[field] = match->sizes[field];
+                it->ids[field] = data->ids[field];
+                it->columns[field] = data->columns[field];
+                it->sizes[field] = data->sizes[field];
             }
         }
 
-        it->sources = match->sources;
-        it->references = ecs_vec_first(&match->refs);
+        it->sources = data->sources;
+        it->references = data->references;
         it->instance_count = 0;
 
         flecs_iter_populate_data(world, it, table, cur.first, cur.count,
             it->ptrs, NULL);
 
+        if ((flags & EcsQueryHasSparseData) && table && it->ptrs) {
+            flecs_query_sparse_populate(query, it);
+        }
+
         iter->node = next;
         iter->prev = node;
-        goto yield;
+        iter->prev_first = cur.first;
+        iter->prev_count = cur.count;
+        return true;
+    }
+
+    iter->node = last;
+    return false;
+}
+
+void flecs_query_iter_seek(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    iter->node = node;
+    iter->last = node ? node->next : NULL;
+    iter->sparse_smallest = 0;
+    iter->sparse_first = 0;
+    iter->bitset_first = 0;
+    iter->skip_count = 0;
+    iter->join_next = NULL;
+    iter->join_first = 0;
+    iter->join_count = 0;
+    iter->changed_first = 0;
+    iter->changed_ranges = false;
+}
+
+bool ecs_query_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+
+    if (flecs_query_iter_next(it)) {
+        return true;
     }
 
 error:
     ecs_iter_fini(it);
     return false;
+}
 
-yield:
-    return true;  
+static
+void* flecs_query_batch_field(
+    ecs_world_t *world,
+    const ecs_query_table_data_t *data,
+    ecs_table_t *table,
+    const ecs_term_t *terms,
+    int32_t field,
+    int32_t offset)
+{
+    int32_t column = data->columns[field];
+    if (!column || terms[field].inout == EcsInOutNone) {
+        return NULL;
+    }
+
+    if (column < 0) {
+        /* Component is not owned, get it from cached reference */
+        ecs_ref_t *ref = &data->references[-column - 1];
+        if (!ref->id) {
+            return NULL;
+        }
+        return ecs_ref_get_id(world, ref, ref->id);
+    }
+
+    int32_t storage_column = data->storage_columns[field];
+    if (storage_column >= 0) {
+        ecs_size_t size = table->type_info[storage_column]->size;
+        return ecs_vec_get(&table->data.columns[storage_column], size, offset);
+    }
+
+    int32_t u_index = flecs_table_column_to_union_index(table, column - 1);
+    if (u_index != -1) {
+        ecs_switch_t *sw = &table->data.sw_columns[u_index];
+        return ecs_vec_get_t(flecs_switch_values(sw), ecs_entity_t, offset);
+    }
+
+    return NULL;
+}
+
+int32_t ecs_query_next_batch(
+    ecs_iter_t *it,
+    ecs_query_batch_t *batch,
+    void **ptrs,
+    int32_t max_count)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(batch != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(max_count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptrs != NULL || !it->field_count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_world_t *world = query->world;
+    ecs_flags32_t flags = query->flags;
+    const ecs_filter_t *filter = &query->filter;
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, field_count = it->field_count;
+    bool is_filter = ECS_BIT_IS_SET(it->flags, EcsIterIsFilter);
+
+    /* Queries that return row ranges, sparse data or fields that are not
+     * matched on This use the regular iterator to produce results. */
+    bool direct = !(flags & (EcsQueryChangedOnly | EcsQueryHasSparse | 
+        EcsQueryHasSparseData)) && (filter->flags & EcsFilterMatchOnlyThis);
+
+    flecs_query_iter_sync_prev(iter);
+    flecs_iter_validate(it);
+
+    int32_t count = 0;
+    ecs_query_table_node_t *node = iter->node, *last = iter->last;
+    ecs_query_table_data_t list_data;
+    const ecs_query_table_data_t *data;
+    bool is_array = iter->table_array != NULL;
+    while (count < max_count && node != last) {
+        ecs_query_batch_t *elem = &batch[count];
+        void **elem_ptrs = ptrs ? &ptrs[count * field_count] : NULL;
+        ecs_query_table_match_t *match = node->match;
+        ecs_table_t *table;
+        if (is_array) {
+            data = &((ecs_query_table_elem_t*)node)->data;
+            table = node->table;
+        } else {
+            flecs_query_table_data_init(&list_data, match);
+            data = &list_data;
+            table = match->node.table;
+        }
+
+        if (!direct || !table || data->bitset_columns || 
+            data->sparse_columns) 
+        {
+            if (!flecs_query_iter_next(it)) {
+                break;
+            }
+
+            elem->table = it->table;
+            elem->entities = it->entities;
+            elem->offset = it->offset;
+            elem->count = it->count;
+            elem->group_id = it->group_id;
+            elem->sources = it->sources;
+            elem->ptrs = elem_ptrs;
+            if (it->ptrs) {
+                ecs_os_memcpy_n(elem_ptrs, it->ptrs, void*, field_count);
+            } else if (field_count) {
+                ecs_os_memset_n(elem_ptrs, 0, void*, field_count);
+            }
+
+            node = iter->node;
+            count ++;
+            continue;
+        }
+
+        int32_t offset = node->offset;
+        int32_t table_count = node->count;
+        if (!table_count) {
+            table_count = ecs_table_count(table);
+            ecs_assert(table_count != 0, ECS_INTERNAL_ERROR, NULL);
+        }
+
+        elem->table = table;
+        elem->entities = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, offset);
+        elem->offset = offset;
+        elem->count = table_count;
+        elem->group_id = node->group_id;
+        elem->sources = data->sources;
+        elem->ptrs = elem_ptrs;
+
+        for (i = 0; i < field_count; i ++) {
+            elem_ptrs[i] = is_filter ? NULL : flecs_query_batch_field(
+                world, data, table, terms, i, offset);
+        }
+
+        /* Results are not revisited, so sync change tracking right away */
+        if (flags & EcsQueryHasMonitor) {
+            flecs_query_sync_match_monitor(query, match);
+        }
+        if (flags & EcsQueryHasOutColumns) {
+            flecs_query_mark_columns_dirty(query, match, offset, table_count);
+        }
+
+        node = node->next;
+        iter->node = node;
+        count ++;
+    }
+
+    if (!count) {
+        ecs_iter_fini(it);
+    }
+
+    return count;
+error:
+    return 0;
 }
 
 bool ecs_query_changed(
@@ -49083,9 +54334,9 @@ bool ecs_query_changed(
         ecs_check(ECS_BIT_IS_SET(it->flags, EcsIterIsValid), 
             ECS_INVALID_PARAMETER, NULL);
 
-        ecs_query_table_match_t *qm = 
-            (ecs_query_table_match_t*)it->priv.iter.query.prev;
-        ecs_assert(qm != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_query_table_node_t *prev = it->priv.iter.query.prev;
+        ecs_assert(prev != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_query_table_match_t *qm = prev->match;
 
         if (!query) {
             query = it->priv.iter.query.query;
@@ -49705,6 +54956,7 @@ void flecs_init_table(
     table->type_info = NULL;
     table->flags = 0;
     table->dirty_state = NULL;
+    table->dirty_blocks = NULL;
     table->lock = 0;
     table->refcount = 1;
     table->generation = 0;
@@ -49712,6 +54964,10 @@ void flecs_init_table(
     flecs_table_init_node(&table->node);
 
     flecs_table_init(world, table, prev);
+
+    if (world->flags & EcsWorldHasSubsets) {
+        flecs_subsets_table_created(world, table);
+    }
 }
 
 static
@@ -50869,7 +56125,8 @@ bool ecs_field_is_set(
 
     int32_t column = it->columns[index - 1];
     if (!column) {
-        return false;
+        /* Fields for sparse components are not stored in a table column */
+        return it->ptrs && it->ptrs[index - 1] != NULL;
     } else if (column < 0) {
         if (it->references) {
             column = -column - 1;
@@ -51484,6 +56741,240 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+/* Tell the CPU that the thread is spinning on a lock */
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define flecs_cpu_pause() __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define flecs_cpu_pause() __asm__ __volatile__("yield")
+#else
+#define flecs_cpu_pause()
+#endif
+
+/* Number of pause rounds after which a waiting worker yields its thread */
+#define ECS_WORKER_CURSOR_SPIN_COUNT (16)
+
+static
+void flecs_worker_cursor_lock(
+    ecs_worker_cursor_t *cursor)
+{
+    /* Only the thread that increments the lock from 0 to 1 owns it. The lock
+     * is only held while the position is advanced, so a waiting worker first
+     * spins with an increasing number of pauses before it yields the thread.
+     * Waiting workers only read the lock, so they don't slow down the owner. */
+    int32_t spin = 0;
+    while (ecs_os_ainc(&cursor->lock) != 1) {
+        ecs_os_adec(&cursor->lock);
+        do {
+            if (spin < ECS_WORKER_CURSOR_SPIN_COUNT) {
+                int32_t i, pauses = 1 << (spin / 4);
+                for (i = 0; i < pauses; i ++) {
+                    flecs_cpu_pause();
+                }
+                spin ++;
+            } else if (ecs_os_api.sleep_) {
+                ecs_os_sleep(0, 0);
+            }
+        } while (ecs_os_aload(&cursor->lock) != 0);
+    }
+}
+
+static
+void flecs_worker_cursor_unlock(
+    ecs_worker_cursor_t *cursor)
+{
+    ecs_os_adec(&cursor->lock);
+}
+
+static
+void flecs_worker_chunk_done(
+    ecs_iter_t *it)
+{
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    if (iter->chunk_done) {
+        return;
+    }
+
+    iter->chunk_done = true;
+
+    /* The last worker to finish resets the position, so that the cursor can be
+     * reused in the same frame. */
+    ecs_worker_cursor_t *cursor = iter->cursor;
+    flecs_worker_cursor_lock(cursor);
+    if (cursor->frame == iter->chunk_frame) {
+        if (++ cursor->done == iter->count) {
+            cursor->started = false;
+        }
+    }
+    flecs_worker_cursor_unlock(cursor);
+}
+
+static
+void flecs_worker_chunk_fini(
+    ecs_iter_t *it)
+{
+    /* Iterators that are finalized before they are depleted don't claim any
+     * more chunks, which must not prevent the cursor from being reset. */
+    flecs_worker_chunk_done(it);
+}
+
+ecs_iter_t ecs_worker_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count,
+    int32_t chunk_size,
+    ecs_worker_cursor_t *cursor)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, 
+        "chunked worker iterators require a query iterator");
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(cursor != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_worker_iter(it, index, count);
+    ecs_worker_iter_t *iter = &result.priv.iter.worker;
+    iter->chunk_size = chunk_size;
+    iter->chunk_frame = ecs_get_world_info(it->world)->frame_count_total;
+    iter->chunk_start = it->priv.iter.query.node;
+    iter->cursor = cursor;
+    result.fini = flecs_worker_chunk_fini;
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Claim the next chunk from the cursor. All workers share the position in the
+ * list of matched tables, so a worker only iterates the tables it claims. */
+static
+ecs_query_table_node_t* flecs_worker_chunk_claim(
+    ecs_iter_t *it)
+{
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    ecs_worker_cursor_t *cursor = iter->cursor;
+    int32_t chunk_size = iter->chunk_size;
+
+    flecs_worker_cursor_lock(cursor);
+
+    /* Reset the position for the first worker of a new frame, in case workers
+     * of a previous frame stopped before the last one finished. */
+    if (!cursor->started || cursor->frame != iter->chunk_frame) {
+        cursor->node = iter->chunk_start;
+        cursor->row = 0;
+        cursor->done = 0;
+        cursor->frame = iter->chunk_frame;
+        cursor->started = true;
+    }
+
+    ecs_query_table_node_t *node = cursor->node;
+    if (node) {
+        ecs_table_t *table = node->table;
+        if (table) {
+            int32_t count = node->count;
+            if (!count) {
+                count = ecs_table_count(table);
+            }
+
+            iter->chunk_first = node->offset + cursor->row;
+            cursor->row += chunk_size;
+            if (cursor->row < count) {
+                iter->chunk_last = iter->chunk_first + chunk_size;
+            } else {
+                iter->chunk_last = node->offset + count;
+                cursor->node = node->next;
+                cursor->row = 0;
+            }
+        } else {
+            /* Results without a table (tasks) are processed by one worker */
+            iter->chunk_first = 0;
+            iter->chunk_last = -1;
+            cursor->node = node->next;
+        }
+    }
+
+    flecs_worker_cursor_unlock(cursor);
+
+    return node;
+}
+
+static
+bool ecs_worker_chunk_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    bool instanced = ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced);
+    int32_t first = 0, last = 0;
+
+    if (iter->chunk_done) {
+        return false;
+    }
+
+    while (true) {
+        if (!iter->chunk_claimed) {
+            ecs_query_table_node_t *node = flecs_worker_chunk_claim(it);
+            flecs_query_iter_seek(chain_it, node);
+            if (!node) {
+                /* Finish up the last result before releasing the iterator */
+                flecs_query_iter_next(chain_it);
+                ecs_iter_fini(chain_it);
+                flecs_worker_chunk_done(it);
+                return false;
+            }
+            iter->chunk_claimed = true;
+        }
+
+        if (!flecs_query_iter_next(chain_it)) {
+            iter->chunk_claimed = false;
+            continue;
+        }
+
+        if (iter->chunk_last == -1) {
+            break;
+        }
+
+        /* A result can extend beyond the claimed chunk, as other workers 
+         * iterate other chunks of the same table */
+        first = chain_it->offset;
+        last = first + chain_it->count;
+        if (first < iter->chunk_first) {
+            first = iter->chunk_first;
+        }
+        if (last > iter->chunk_last) {
+            last = iter->chunk_last;
+        }
+        if (first < last) {
+            break;
+        }
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+
+    /* Keep instancing setting from original iterator */
+    ECS_BIT_COND(it->flags, EcsIterIsInstanced, instanced);
+
+    if (!it->table || iter->chunk_last == -1) {
+        return true;
+    }
+
+    int32_t offset = first - it->offset;
+    int32_t count = last - first;
+
+    it->instance_count = count;
+    it->frame_offset += offset;
+    flecs_offset_iter(it, offset);
+    it->count = count;
+
+    if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
+        it->offset = first;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+}
+
 static
 bool ecs_worker_next_instanced(
     ecs_iter_t *it)
@@ -51492,10 +56983,14 @@ bool ecs_worker_next_instanced(
     ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(it->next == ecs_worker_next, ECS_INVALID_PARAMETER, NULL);
 
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    if (iter->chunk_size) {
+        return ecs_worker_chunk_next_instanced(it);
+    }
+
     bool instanced = ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced);
 
     ecs_iter_t *chain_it = it->chain_it;
-    ecs_worker_iter_t *iter = &it->priv.iter.worker;
     int32_t res_count = iter->count, res_index = iter->index;
     int32_t per_worker, instances_per_worker, first;
 
@@ -52308,6 +57803,12 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_sparse(ecs_iter_t *it) {
+    flecs_register_id_flag_for_relation(it, EcsSparse, EcsIdSparse, 0, 0);
+    it->real_world->flags |= EcsWorldHasSparse;
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -52751,6 +58252,7 @@ void flecs_bootstrap(
     flecs_bootstrap_tag(world, EcsDontInherit);
     flecs_bootstrap_tag(world, EcsTag);
     flecs_bootstrap_tag(world, EcsUnion);
+    flecs_bootstrap_tag(world, EcsSparse);
     flecs_bootstrap_tag(world, EcsExclusive);
     flecs_bootstrap_tag(world, EcsAcyclic);
     flecs_bootstrap_tag(world, EcsWith);
@@ -52885,6 +58387,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = EcsSparse, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_sparse
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer_init(world, &(ecs_observer_desc_t){
@@ -53863,6 +59371,157 @@ void flecs_id_record_assert_empty(
         ECS_INTERNAL_ERROR, NULL);
 }
 
+/* Invoke component hook for a sparse component of a single entity */
+static
+void flecs_sparse_component_hook(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_iter_action_t callback,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    void *ptr)
+{
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_t it = { .field_count = 1 };
+    it.entities = &entity;
+
+    flecs_iter_init(world, &it, flecs_iter_cache_all);
+    it.world = world;
+    it.real_world = world;
+    it.ptrs[0] = ptr;
+    it.sizes[0] = ti->size;
+    it.ids[0] = idr->id;
+    it.event = event;
+    it.event_id = idr->id;
+    it.ctx = ti->hooks.ctx;
+    it.binding_ctx = ti->hooks.binding_ctx;
+    it.count = 1;
+    flecs_iter_validate(&it);
+    callback(&it);
+    ecs_iter_fini(&it);
+}
+
+/* Register sparse component with the entity, so that deleting the entity only
+ * has to visit the sparse components it has. */
+static
+void flecs_sparse_entity_add(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    ecs_map_init_if(&world->store.sparse_entities, ecs_vec_t, 
+        &world->allocator, 0);
+    ecs_vec_t *idrs = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!idrs) {
+        idrs = ecs_map_ensure(&world->store.sparse_entities, ecs_vec_t, entity);
+        ecs_vec_init_t(&world->allocator, idrs, ecs_id_record_t*, 1);
+    }
+    ecs_vec_append_t(&world->allocator, idrs, ecs_id_record_t*)[0] = idr;
+}
+
+static
+void flecs_sparse_entity_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    if (!ecs_map_is_initialized(&world->store.sparse_entities)) {
+        return;
+    }
+
+    ecs_vec_t *idrs = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!idrs) {
+        return;
+    }
+
+    int32_t i, count = ecs_vec_count(idrs);
+    ecs_id_record_t **arr = ecs_vec_first(idrs);
+    for (i = 0; i < count; i ++) {
+        if (arr[i] == idr) {
+            ecs_vec_remove_t(idrs, ecs_id_record_t*, i);
+            break;
+        }
+    }
+
+    if (!ecs_vec_count(idrs)) {
+        ecs_vec_fini_t(&world->allocator, idrs, ecs_id_record_t*);
+        ecs_map_remove(&world->store.sparse_entities, entity);
+    }
+}
+
+static
+void flecs_sparse_component_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_action_t on_remove = ti ? ti->hooks.on_remove : NULL;
+    ecs_xtor_t dtor = ti ? ti->hooks.dtor : NULL;
+    if (on_remove || dtor) {
+        int32_t i, count = flecs_sparse_count(sparse);
+        const uint64_t *entities = flecs_sparse_ids(sparse);
+        for (i = 0; i < count; i ++) {
+            void *ptr = _flecs_sparse_get_dense(sparse, 0, i);
+            if (on_remove) {
+                flecs_sparse_component_hook(world, idr, on_remove, 
+                    EcsOnRemove, entities[i], ptr);
+            }
+            if (dtor) {
+                dtor(ptr, 1, ti);
+            }
+        }
+    }
+
+    int32_t i, count = flecs_sparse_count(sparse);
+    const uint64_t *entities = flecs_sparse_ids(sparse);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_entity_remove(world, entities[i], idr);
+    }
+
+    flecs_sparse_free(sparse);
+    idr->sparse = NULL;
+
+    count = ecs_vector_count(world->store.sparse_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.sparse_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (idrs[i] == idr) {
+            ecs_vector_remove(world->store.sparse_ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
+/* Free transitive closure of id record. Iterators that are yielding its tables
+ * keep the tables alive. */
+static
+void flecs_subset_cache_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_subset_cache_t *cache = idr->subsets;
+    flecs_subset_tables_release(cache->tables);
+    ecs_map_fini(&cache->table_refs);
+    ecs_map_fini(&cache->members);
+    ecs_vec_fini_t(&world->allocator, &cache->created, uint64_t);
+    ecs_vec_fini_t(&world->allocator, &cache->moved, ecs_entity_t);
+    ecs_os_free(cache);
+    idr->subsets = NULL;
+
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (idrs[i] == idr) {
+            ecs_vector_remove(world->store.subset_ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
 static
 void flecs_id_record_free(
     ecs_world_t *world,
@@ -53932,9 +59591,15 @@ void flecs_id_record_free(
     }
 
     /* Unregister the id record from the world & free resources */
+    if (idr->sparse) {
+        flecs_sparse_component_fini(world, idr);
+    }
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    if (idr->subsets) {
+        flecs_subset_cache_fini(world, idr);
+    }
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= ECS_HI_ID_RECORD_ID) {
@@ -54150,6 +59815,298 @@ const ecs_table_record_t* flecs_id_record_get_table(
     return (ecs_table_record_t*)ecs_table_cache_get(&idr->cache, table);
 }
 
+ecs_id_record_t* flecs_sparse_id_record_get(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr || !(idr->flags & EcsIdSparse) || !idr->type_info) {
+        return NULL;
+    }
+
+    return idr;
+}
+
+bool flecs_id_is_sparse(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return false;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr && ECS_IS_PAIR(id) && !ecs_id_is_wildcard(id)) {
+        /* Pair records inherit the Sparse flag from (R, *) on creation */
+        idr = flecs_id_record_get(world, 
+            ecs_pair(ECS_PAIR_FIRST(id), EcsWildcard));
+        return idr && (idr->flags & EcsIdSparse) && 
+            ecs_get_type_info(world, id) != NULL;
+    }
+
+    return idr && (idr->flags & EcsIdSparse) && idr->type_info;
+}
+
+ecs_id_record_t* flecs_sparse_id_record_ensure(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!flecs_id_is_sparse(world, id)) {
+        return NULL;
+    }
+
+    return flecs_id_record_ensure(world, id);
+}
+
+void* flecs_sparse_component_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return NULL;
+    }
+
+    /* Storage is keyed by the entity id including its generation, so that a
+     * recycled id doesn't get the component of a deleted entity. */
+    return _flecs_sparse_get(idr->sparse, 0, entity);
+}
+
+void* flecs_sparse_component_ensure(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    bool construct,
+    bool *is_new)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_assert(ti != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        sparse = idr->sparse = _flecs_sparse_new(&world->allocator, 
+            &world->allocators.sparse_chunk, ti->size);
+        ecs_vector_add(&world->store.sparse_ids, ecs_id_record_t*)[0] = idr;
+    } else {
+        void *ptr = _flecs_sparse_get(sparse, 0, entity);
+        if (ptr) {
+            if (is_new) {
+                *is_new = false;
+            }
+            return ptr;
+        }
+
+        /* Remove element left by a previous generation of the entity */
+        uint64_t prev = flecs_sparse_get_alive(sparse, (uint32_t)entity);
+        if (prev && _flecs_sparse_get(sparse, 0, prev)) {
+            flecs_sparse_component_remove(world, idr, prev);
+        }
+    }
+
+    /* Store element with the generation of the entity */
+    flecs_sparse_set_generation(sparse, entity);
+    void *ptr = _flecs_sparse_ensure(sparse, 0, entity);
+    if (construct) {
+        ecs_xtor_t ctor = ti->hooks.ctor;
+        if (ctor) {
+            ctor(ptr, 1, ti);
+        } else {
+            ecs_os_memset(ptr, 0, ti->size);
+        }
+    }
+
+    flecs_sparse_entity_add(world, entity, idr);
+
+    ecs_iter_action_t on_add = ti->hooks.on_add;
+    if (on_add) {
+        flecs_sparse_component_hook(world, idr, on_add, EcsOnAdd, entity, ptr);
+    }
+
+    if (is_new) {
+        *is_new = true;
+    }
+
+    return ptr;
+}
+
+void flecs_sparse_component_on_set(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    void *ptr)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_iter_action_t on_set = idr->type_info->hooks.on_set;
+    if (on_set) {
+        flecs_sparse_component_hook(world, idr, on_set, EcsOnSet, entity, ptr);
+    }
+}
+
+bool flecs_sparse_component_remove(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    (void)world;
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        return false;
+    }
+
+    void *ptr = _flecs_sparse_get(sparse, 0, entity);
+    if (!ptr) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_action_t on_remove = ti->hooks.on_remove;
+    if (on_remove) {
+        flecs_sparse_component_hook(
+            world, idr, on_remove, EcsOnRemove, entity, ptr);
+    }
+
+    ecs_xtor_t dtor = ti->hooks.dtor;
+    if (dtor) {
+        dtor(ptr, 1, ti);
+    }
+
+    _flecs_sparse_remove_get(sparse, 0, entity);
+    flecs_sparse_entity_remove(world, entity, idr);
+    return true;
+}
+
+void flecs_sparse_components_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (!ecs_map_is_initialized(&world->store.sparse_entities)) {
+        return;
+    }
+
+    ecs_vec_t *ptr = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!ptr) {
+        return;
+    }
+
+    /* Take the list out of the index, as hooks can add or remove sparse
+     * components, which invalidates pointers into the index. */
+    ecs_vec_t idrs = *ptr;
+    ecs_map_remove(&world->store.sparse_entities, entity);
+
+    int32_t i, count = ecs_vec_count(&idrs);
+    ecs_id_record_t **arr = ecs_vec_first(&idrs);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_component_remove(world, arr[i], entity);
+    }
+
+    ecs_vec_fini_t(&world->allocator, &idrs, ecs_id_record_t*);
+}
+
+void flecs_subset_tables_release(
+    ecs_subset_tables_t *tables)
+{
+    if (tables && !ecs_os_adec(&tables->refs)) {
+        ecs_vector_free(tables->tables);
+        ecs_os_free(tables);
+    }
+}
+
+ecs_subset_tables_t* flecs_subset_tables_mut(
+    ecs_subset_cache_t *cache)
+{
+    ecs_subset_tables_t *cur = cache->tables;
+    if (cur->refs == 1) {
+        return cur;
+    }
+
+    ecs_subset_tables_t *result = ecs_os_calloc_t(ecs_subset_tables_t);
+    result->tables = ecs_vector_copy(cur->tables, ecs_subset_elem_t);
+    result->refs = 1;
+    flecs_subset_tables_release(cur);
+    cache->tables = result;
+    return result;
+}
+
+void flecs_subset_cache_remove_table(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table)
+{
+    ecs_map_remove(&cache->table_refs, table->id);
+
+    /* Keep the order in which the hierarchy is walked */
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    int32_t i, j = 0, count = ecs_vector_count(tables->tables);
+    ecs_subset_elem_t *elems = ecs_vector_first(
+        tables->tables, ecs_subset_elem_t);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].table != table) {
+            elems[j ++] = elems[i];
+        }
+    }
+    ecs_vector_set_count(&tables->tables, ecs_subset_elem_t, j);
+}
+
+void flecs_subsets_table_created(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_id_record_t *idr = idrs[i];
+        ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+        if (flecs_table_record_get(world, table, ecs_pair(rel, EcsWildcard))) {
+            ecs_vec_append_t(&world->allocator, &idr->subsets->created, 
+                uint64_t)[0] = table->id;
+        }
+    }
+}
+
+void flecs_subsets_table_deleted(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_subset_cache_t *cache = idrs[i]->subsets;
+        if (ecs_map_get(&cache->table_refs, int32_t, table->id)) {
+            flecs_subset_cache_remove_table(cache, table);
+        }
+    }
+}
+
+void flecs_subsets_entity_moved(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_id_record_t *idr = idrs[i];
+        ecs_subset_cache_t *cache = idr->subsets;
+
+        /* Only entities with subsets can change the closure */
+        ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+        if (ecs_map_get(&cache->members, bool, entity) || 
+            flecs_id_record_get(world, ecs_pair(rel, entity))) 
+        {
+            ecs_vec_append_t(&world->allocator, &cache->moved, 
+                ecs_entity_t)[0] = entity;
+        }
+    }
+}
+
 void flecs_init_id_records(
     ecs_world_t *world)
 {
@@ -54185,7 +60142,11 @@ void flecs_fini_id_records(
 
     ecs_map_fini(&world->id_index_hi);
     flecs_sparse_fini(&world->id_index_lo);
+    ecs_vector_free(world->store.sparse_ids);
+    ecs_map_fini(&world->store.sparse_entities);
+    ecs_vector_free(world->store.subset_ids);
     flecs_sparse_free(world->pending_tables);
     flecs_sparse_free(world->pending_buffer);
+    ecs_vector_free(world->pending_queries);
 }
 
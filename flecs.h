@@ -129,6 +129,7 @@
 #define FLECS_PARSER        /* String parser for queries */
 #define FLECS_PLECS         /* ECS data definition format */
 #define FLECS_RULES         /* Constraint solver for advanced queries */
+#define FLECS_INDEX         /* Lookup entities by component value */
 #define FLECS_SNAPSHOT      /* Snapshot & restore ECS data */
 #define FLECS_STATS         /* Access runtime statistics */
 #define FLECS_MONITOR       /* Track runtime statistics periodically */
@@ -188,6 +189,9 @@ extern "C" {
 #define EcsWorldMeasureFrameTime      (1u << 4)
 #define EcsWorldMeasureSystemTime     (1u << 5)
 #define EcsWorldMultiThreaded         (1u << 6)
+#define EcsWorldHasSparse             (1u << 7)
+#define EcsWorldParallelMerge         (1u << 8)
+#define EcsWorldHasSubsets            (1u << 9)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -233,6 +237,7 @@ extern "C" {
 #define EcsIdTag                       (1u << 9)
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
+#define EcsIdSparse                    (1u << 12)
 
 #define EcsIdHasOnAdd                  (1u << 15) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 16) 
@@ -252,6 +257,13 @@ extern "C" {
 #define ECS_ID_ON_DELETE_OBJECT_FLAG(id) (1u << (3 + ((id) - EcsRemove)))
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Type hook flags (used by ecs_type_hooks_t::flags)
+////////////////////////////////////////////////////////////////////////////////
+
+#define EcsTypeHookRelocatable         (1u << 0u)  /* Type can be moved with memcpy */
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Iterator flags (used by ecs_iter_t::flags)
 ////////////////////////////////////////////////////////////////////////////////
@@ -265,6 +277,7 @@ extern "C" {
 #define EcsIterNoResults               (1u << 6u)  /* Iterator has no results */
 #define EcsIterIgnoreThis              (1u << 7u)  /* Only evaluate non-this terms */
 #define EcsIterMatchVar           (1u << 8u)
+#define EcsIterRowRange                (1u << 9u)  /* Chained filters only return rows of iterator */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Filter flags (used by ecs_filter_t::flags)
@@ -286,6 +299,8 @@ extern "C" {
 #define EcsFilterIsFilter              (1u << 7u)  /* When true, data fields won't be populated */
 #define EcsFilterIsInstanced           (1u << 8u)  /* Is filter instanced (see ecs_filter_desc_t) */
 #define EcsFilterPopulate              (1u << 9u)  /* Populate data, ignore non-matching fields */
+#define EcsFilterCacheResults          (1u << 10u) /* Cache rule results (see ecs_rule_init) */
+#define EcsFilterMatchSparse           (1u << 11u) /* Allow sparse terms (used by queries) */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -332,6 +347,11 @@ extern "C" {
 #define EcsQueryIsOrphaned             (1u << 3u)  /* Is subquery orphaned */
 #define EcsQueryHasOutColumns          (1u << 4u)  /* Does query have out columns */
 #define EcsQueryHasMonitor             (1u << 5u)  /* Does query track changes */
+#define EcsQueryHasSparse              (1u << 6u)  /* Does query have sparse terms */
+#define EcsQueryHasSparseData          (1u << 7u)  /* Does query read sparse data */
+#define EcsQueryChangedOnly            (1u << 8u)  /* Only return changed rows */
+#define EcsQueryTableArrayDirty        (1u << 9u)  /* Table array must be rebuilt */
+#define EcsQueryTableArrayQueued       (1u << 10u) /* Query is in world queue */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1294,6 +1314,11 @@ FLECS_DBG_API
 void flecs_sparse_clear(
     ecs_sparse_t *sparse);
 
+/** Free memory that is not used by the sparse set */
+FLECS_DBG_API
+void flecs_sparse_shrink(
+    ecs_sparse_t *sparse);
+
 /** Set id source. This allows the sparse set to use an external variable for
  * issuing and increasing new ids. */
 FLECS_DBG_API
@@ -1543,6 +1568,14 @@ void* _ecs_sparse_get(
 #define FLECS_BLOCK_ALLOCATOR_H
 
 
+/* Chunks are aligned to the largest power of two that divides the chunk size,
+ * up to this value. This guarantees that an array of elements with a size that
+ * is a multiple of its alignment (like a component column) starts at an 
+ * address that is aligned for the element type. */
+#ifndef FLECS_BALLOC_ALIGN
+#define FLECS_BALLOC_ALIGN (64)
+#endif
+
 typedef struct ecs_block_allocator_block_t {
     void *memory;
     struct ecs_block_allocator_block_t *next;
@@ -1585,6 +1618,10 @@ FLECS_API
 void flecs_ballocator_free(
     ecs_block_allocator_t *ba);
 
+FLECS_API
+int64_t flecs_ballocator_trim(
+    ecs_block_allocator_t *ba);
+
 FLECS_API
 void* flecs_balloc(
     ecs_block_allocator_t *allocator);
@@ -1619,14 +1656,19 @@ void* flecs_bdup(
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
+ * The map uses open addressing. Keys and payloads are stored inline in a
+ * single flat array of slots, so a lookup doesn't have to chase pointers. Each
+ * slot has a control byte that is either empty, deleted or stores 7 bits of the
+ * key hash. Lookups test a group of 8 control bytes at a time with bit tricks on
+ * a 64-bit word (SWAR), which filters out almost all non-matching slots before
+ * their keys are compared. Removed slots are marked as deleted, which means
+ * that removing elements while iterating a map is safe.
  *
- * The datastructure will automatically grow the number of buckets when the
- * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * The number of slots is always a power of 2. The datastructure automatically 
+ * grows the number of slots when the ratio between elements and slots exceeds
+ * a certain threshold (LOAD_FACTOR). Note that payload pointers are only stable
+ * until the map is rehashed. Don't hold on to payload pointers across 
+ * operations that insert elements.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -1648,38 +1690,26 @@ extern "C" {
 typedef uint64_t ecs_map_key_t;
 
 /* Map type */
-typedef struct ecs_bucket_entry_t {
-    struct ecs_bucket_entry_t *next;
-    ecs_map_key_t key;
-    /* payload right after key. */
-} ecs_bucket_entry_t;
-
-typedef struct ecs_bucket_t {
-    ecs_bucket_entry_t *first;
-} ecs_bucket_t;
-
 typedef struct ecs_map_t {
-    ecs_bucket_t *buckets;
-    ecs_bucket_t *buckets_end;
-    int16_t elem_size;
-    uint8_t bucket_shift;
-    bool shared_allocator;
-    int32_t bucket_count;
-    int32_t count;
+    uint8_t *ctrl;            /* Control byte per slot (+ 1 cloned group) */
+    void *slots;              /* Key + payload per slot */
+    int16_t elem_size;        /* Size of payload */
+    int16_t slot_size;        /* Size of key + aligned payload */
+    uint8_t bucket_shift;     /* Shift used to compute slot from key hash */
+    int32_t bucket_count;     /* Number of slots */
+    int32_t count;            /* Number of elements */
+    int32_t deleted;          /* Number of deleted slots */
     struct ecs_allocator_t *allocator;
-    struct ecs_block_allocator_t *entry_allocator;
 } ecs_map_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    ecs_bucket_t *bucket;
-    ecs_bucket_entry_t *entry;
+    int32_t index;
 } ecs_map_iter_t;
 
 typedef struct ecs_map_params_t {
     ecs_size_t size;
     struct ecs_allocator_t *allocator;
-    struct ecs_block_allocator_t entry_allocator;
     int32_t initial_count;
 } ecs_map_params_t;
 
@@ -1831,7 +1861,7 @@ FLECS_API
 int32_t ecs_map_count(
     const ecs_map_t *map);
 
-/** Return number of buckets in map. */
+/** Return number of slots in map. */
 FLECS_API
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map);
@@ -1860,13 +1890,13 @@ void* _ecs_map_next_ptr(
 #define ecs_map_next_ptr(iter, T, key) \
     (T)_ecs_map_next_ptr(iter, key)
 
-/** Grow number of buckets in the map for specified number of elements. */
+/** Grow number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_grow(
     ecs_map_t *map,
     int32_t elem_count);
 
-/** Set number of buckets in the map for specified number of elements. */
+/** Set number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_set_size(
     ecs_map_t *map,
@@ -1924,6 +1954,10 @@ FLECS_API
 void flecs_allocator_fini(
     ecs_allocator_t *a);
 
+FLECS_API
+int64_t flecs_allocator_trim(
+    ecs_allocator_t *a);
+
 FLECS_API
 ecs_block_allocator_t* flecs_allocator_get(
     ecs_allocator_t *a, 
@@ -2304,6 +2338,11 @@ typedef
 int64_t (*ecs_os_api_lainc_t)(
     int64_t *value);
 
+/* Atomic load with acquire semantics */
+typedef
+int32_t (*ecs_os_api_aload_t)(
+    const int32_t *value);
+
 /* Mutex */
 typedef
 ecs_os_mutex_t (*ecs_os_api_mutex_new_t)(
@@ -2473,6 +2512,10 @@ typedef struct ecs_os_api_t {
 
     /* OS API flags */
     ecs_flags32_t flags_;
+
+    /* Atomic load. Added after the other members, so that existing OS API
+     * implementations don't have to set it. Defaults to a compiler builtin. */
+    ecs_os_api_aload_t aload_;
 } ecs_os_api_t;
 
 FLECS_API
@@ -2599,6 +2642,7 @@ void ecs_os_set_api_defaults(void);
 #define ecs_os_adec(value) ecs_os_api.adec_(value)
 #define ecs_os_lainc(value) ecs_os_api.lainc_(value)
 #define ecs_os_ladec(value) ecs_os_api.ladec_(value)
+#define ecs_os_aload(value) ecs_os_api.aload_(value)
 
 /* Mutex */
 #define ecs_os_mutex_new() ecs_os_api.mutex_new_()
@@ -3102,6 +3146,8 @@ struct ecs_filter_t {
     char *name;                /* Name of filter (optional) */
     char *variable_names[1];   /* Array with variable names */
 
+    int32_t *plan;             /* Order in which terms are evaluated */
+
     ecs_iterable_t iterable;   /* Iterable mixin */
 };
 
@@ -3137,6 +3183,8 @@ struct ecs_observer_t {
 
     bool is_multi;              /* If true, the observer triggers on more than one term */
 
+    struct ecs_observer_match_cache_t *match_cache; /* Cached filter matches (multi observers only) */
+
     /* Mixins */
     ecs_world_t *world;
     ecs_entity_t entity;
@@ -3168,6 +3216,13 @@ struct ecs_type_hooks_t {
      * not set explicitly it will be derived from other callbacks. */
     ecs_move_t move_dtor;
 
+    /* Hook flags (see EcsTypeHook* flags).
+     * EcsTypeHookRelocatable indicates that instances of the type may be moved
+     * to a new address with a memcpy, without invoking the move constructor or
+     * destructor. This lets a table grow its column storage by reallocating,
+     * instead of move constructing each existing element into a new buffer. */
+    ecs_flags32_t flags;
+
     /* Callback that is invoked when an instance of a component is added. This
      * callback is invoked before triggers are invoked. */
     ecs_iter_action_t on_add;
@@ -3238,6 +3293,9 @@ typedef struct ecs_switch_t ecs_switch_t;
 /* Cached query table data */
 typedef struct ecs_query_table_node_t ecs_query_table_node_t;
 
+/* Contiguous array with cached query table data */
+typedef struct ecs_query_table_array_t ecs_query_table_array_t;
+
 /* Allocator type */
 struct ecs_allocator_t;
 
@@ -3312,10 +3370,30 @@ typedef struct ecs_page_iter_t {
     int32_t remaining;
 } ecs_page_iter_t;
 
+/* Cursor shared between chunked worker iterators */
+typedef struct ecs_worker_cursor_t {
+    int32_t lock;                 /* Spinlock that protects the position */
+    int32_t done;                 /* Number of workers that are done */
+    int64_t frame;                /* Frame in which the position was reset */
+    ecs_query_table_node_t *node; /* Table node to claim next chunk from */
+    int32_t row;                  /* Next row to claim from node */
+    bool started;                 /* Is the position valid */
+} ecs_worker_cursor_t;
+
 /* Worker-iterator specific data */
 typedef struct ecs_worker_iter_t {
     int32_t index;
     int32_t count;
+
+    /* Chunked iteration */
+    int32_t chunk_size;           /* Rows per chunk (0 if not chunked) */
+    int32_t chunk_first;          /* First row of claimed chunk */
+    int32_t chunk_last;           /* Row after claimed chunk (-1 if no table) */
+    bool chunk_claimed;           /* Is a claimed chunk being iterated */
+    bool chunk_done;              /* Has the worker finished iterating */
+    int64_t chunk_frame;          /* Frame in which the iterator was created */
+    ecs_query_table_node_t *chunk_start; /* First table node of query */
+    ecs_worker_cursor_t *cursor;  /* Cursor shared between workers */
 } ecs_worker_iter_t;
 
 /* Convenience struct to iterate table array for id */
@@ -3374,8 +3452,23 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+    ecs_query_table_node_t *join_next; /* Node to continue with after join */
+    int32_t join_first;  /* Remaining range of rows to join with sparse terms */
+    int32_t join_count;
+    int32_t changed_first; /* Row to continue from when finding changed rows */
+    bool changed_ranges; /* Table changed, remaining toggle/union ranges left */
+    int32_t prev_first;  /* Rows of previous result, used to mark rows dirty */
+    int32_t prev_count;
+    ecs_query_table_array_t *table_array; /* Iterated array, NULL if list */
 } ecs_query_iter_t;
 
+/** Index-iterator specific data */
+typedef struct ecs_index_iter_t {
+    const ecs_entity_t *entities; /* Entities with indexed value */
+    int32_t index;                /* Current position in entities array */
+    int32_t count;                /* Number of entities with indexed value */
+} ecs_index_iter_t;
+
 /** Snapshot-iterator specific data */
 typedef struct ecs_snapshot_iter_t {
     ecs_filter_t filter;
@@ -3396,6 +3489,15 @@ typedef struct ecs_rule_iter_t {
     bool redo;
     int32_t op;
     int32_t sp;
+
+    int32_t cached_result;               /* Next result to replay from cache */
+    struct ecs_rule_cache_results_t *cached; /* Results replayed by iterator */
+    bool fill_cache;                     /* Is iterator populating the cache */
+
+    int32_t worker_index;                /* Index of worker (partitioned iter) */
+    int32_t worker_count;                /* Number of workers (0 if not set) */
+    int32_t worker_op;                   /* Select op that partitions tables */
+    int32_t worker_yield;                /* Yield count, if there is no select */
 } ecs_rule_iter_t;
 
 /* Bits for tracking whether a cache was used/whether the array was allocated.
@@ -3425,6 +3527,7 @@ typedef struct ecs_iter_private_t {
         ecs_filter_iter_t filter;
         ecs_query_iter_t query;
         ecs_rule_iter_t rule;
+        ecs_index_iter_t index;
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
@@ -4078,6 +4181,13 @@ typedef struct ecs_query_desc_t {
 
     /* Entity associated with query (optional) */
     ecs_entity_t entity;
+
+    /* If set, the query only returns the rows for which a component that is
+     * read by the query changed since the last time the rows were iterated.
+     * Changes are tracked per block of 64 rows, so results can include rows
+     * that didn't change. Rows are marked changed by ecs_modified, ecs_set and
+     * by queries that write to the component. */
+    bool changed_only;
 } ecs_query_desc_t;
 
 /** Used with ecs_observer_init. */
@@ -4098,6 +4208,14 @@ typedef struct ecs_observer_desc_t {
      * This is only supported for events that are iterable (see EcsIterable) */
     bool yield_existing;
 
+    /* Invoke the observer once for each contiguous range of entities in a
+     * table for which an event is emitted. Events from bulk operations, like
+     * ecs_bulk_init and ecs_bulk_new_w_id, cover all entities created in a
+     * table. Without this flag, an observer with a field that is matched on a
+     * shared (inherited) component is invoked once per entity. Implies that
+     * the observer filter is instanced (see ecs_filter_desc_t::instanced). */
+    bool batched;
+
     /* Callback to invoke on an event, invoked when the observer matches. */
     ecs_iter_action_t callback;
 
@@ -4152,7 +4270,10 @@ typedef struct EcsIdentifier {
 /** Component information. */
 typedef struct EcsComponent {
     ecs_size_t size;           /* Component size */
-    ecs_size_t alignment;      /* Component alignment */
+    ecs_size_t alignment;      /* Component alignment. Table columns start at an
+                                * address aligned to this value (up to 
+                                * FLECS_BALLOC_ALIGN) if the size is a multiple
+                                * of the alignment. */
 } EcsComponent;
 
 /** Component for storing a poly object */
@@ -4234,6 +4355,7 @@ typedef struct ecs_world_info_t {
         int64_t discard_count;         /* commands discarded, happens when entity is no longer alive when running the command */
         int64_t batched_entity_count;  /* entities for which commands were batched */
         int64_t batched_command_count; /* commands batched */
+        int64_t batched_group_count;   /* groups of entities moved to the same table in a single operation */
     } cmd;
 
     const char *name_prefix;          /* Value set by ecs_set_name_prefix. Used
@@ -4249,6 +4371,17 @@ typedef struct ecs_query_group_info_t {
     void *ctx;            /* Group context, returned by on_group_create */
 } ecs_query_group_info_t;
 
+/** Result returned by ecs_query_next_batch. */
+typedef struct ecs_query_batch_t {
+    ecs_table_t *table;           /* Matched table */
+    ecs_entity_t *entities;       /* Entity ids, starting at offset */
+    int32_t offset;               /* First row of table in result */
+    int32_t count;                /* Number of rows in result */
+    uint64_t group_id;            /* Group id of table */
+    ecs_entity_t *sources;        /* Field sources (0 if field is owned) */
+    void **ptrs;                  /* Field data, starting at offset */
+} ecs_query_batch_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -4422,6 +4555,19 @@ FLECS_API extern const ecs_entity_t EcsTag;
  * are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/* Tag to indicate that a component is stored in a sparse set keyed by entity
+ * instead of in a table column. Adding or removing a sparse component does not
+ * move the entity to another table, which makes it a good fit for components
+ * that are added and removed at a high frequency. 
+ *
+ * Sparse components can be added with ecs_add, ecs_set, ecs_get_mut and 
+ * ecs_emplace, and invoke the on_add, on_set and on_remove hooks. They are 
+ * matched by cached queries. Creating a filter, rule or observer with a sparse
+ * term fails. Since queries iterate entities by table, entities that only have
+ * sparse components are not matched. The tag must be added before the 
+ * component is used. */
+FLECS_API extern const ecs_entity_t EcsSparse;
+
 /* Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -4875,6 +5021,25 @@ int32_t ecs_delete_empty_tables(
     int32_t min_id_count,
     double time_budget_seconds);
 
+/** Release unused memory.
+ * This operation returns memory that is no longer in use to the OS. Table
+ * storage is shrunk to the number of entities in each table, unused chunks of
+ * sparse sets are freed, and blocks of the world & stage allocators that no
+ * longer have any allocated elements are released.
+ * 
+ * This operation is useful after a spike in memory usage, like when a large
+ * number of entities was created and then deleted. It walks all tables and
+ * allocators, so it should not be called every frame.
+ * 
+ * This operation may not be called while the world is in readonly mode.
+ * 
+ * @param world The world.
+ * @return Number of bytes released by the world & stage allocators.
+ */
+FLECS_API
+int64_t ecs_world_trim(
+    ecs_world_t *world);
+
 
 /** Test if pointer is of specified type.
  * Usage:
@@ -5114,6 +5279,42 @@ void ecs_override_id(
     ecs_entity_t entity,
     ecs_id_t id);
 
+/** Add a (component) id to all entities matching a filter.
+ * This operation adds an id to all entities that match the filter. Instead of
+ * moving entities one by one, entities are moved per table: the destination
+ * table is computed once, component columns are moved in a single operation 
+ * and a single OnAdd event is emitted for each table.
+ * 
+ * The filter must match $this. If only part of a table is matched (which can
+ * happen for filters with union or toggle terms), or when the world is in
+ * deferred mode, the operation falls back to per entity add operations.
+ * 
+ * The operation must not be called while iterating the tables it modifies.
+ *
+ * @param world The world.
+ * @param filter The filter that selects the entities.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
+/** Remove a (component) id from all entities matching a filter.
+ * Same as ecs_bulk_add_id, but removes the id. A single OnRemove event is 
+ * emitted for each table.
+ *
+ * @param world The world.
+ * @param filter The filter that selects the entities.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
 /** @} */
 
 
@@ -6585,6 +6786,10 @@ ecs_iter_t ecs_filter_iter(
  * A chained iterator applies a filter to the results of the input iterator. The
  * resulting iterator must be iterated with ecs_filter_next.
  * 
+ * The chained iterator returns all entities of a table returned by the input
+ * iterator, unless the input iterator has the EcsIterRowRange flag (like the
+ * index iterator), in which case it only returns the rows of the input result.
+ * 
  * @param it The input iterator
  * @param filter The filter to apply to the iterator.
  * @return The chained iterator. 
@@ -6804,6 +7009,39 @@ FLECS_API
 void ecs_query_populate(
     ecs_iter_t *iter);
 
+/** Progress the query iterator by multiple results at once.
+ * This operation fills the batch array with up to max_count results. Each
+ * result contains the table, row range and field pointers for a matched table,
+ * which is the same information ecs_query_next_instanced returns for a single
+ * result. For queries that only have This terms, results are obtained straight
+ * from the query cache, which avoids populating the iterator per table.
+ * 
+ * The ptrs array provides the storage for the field pointers and must have
+ * space for max_count * field_count elements. The ptrs member of each result
+ * points into this array.
+ * 
+ * Results are always instanced: if the sources member for a field is not 0, the
+ * field pointer points to a single value instead of an array. Components of
+ * inout/out terms are marked dirty when a result is returned.
+ * 
+ * An iterator should either be progressed with ecs_query_next_batch or with
+ * one of the other next functions. The iterator fields (table, count, ptrs)
+ * are not valid after this operation. When the operation returns 0 the 
+ * iterator is finalized.
+ * 
+ * @param iter The iterator.
+ * @param batch Array in which to store the results.
+ * @param ptrs Storage for field pointers (max_count * field_count elements).
+ * @param max_count The maximum number of results to return.
+ * @return The number of results stored in the batch array.
+ */
+FLECS_API
+int32_t ecs_query_next_batch(
+    ecs_iter_t *iter,
+    ecs_query_batch_t *batch,
+    void **ptrs,
+    int32_t max_count);
+
 /** Returns whether the query data changed since the last iteration.
  * The operation will return true after:
  * - new entities have been matched with
@@ -7382,6 +7620,44 @@ ecs_iter_t ecs_worker_iter(
     int32_t index,
     int32_t count);
 
+/** Create a chunked worker iterator.
+ * Chunked worker iterators divide matched entities in chunks of at most 
+ * chunk_size entities. Resources claim chunks from a cursor that is shared 
+ * between all worker iterators, which means that a resource that finishes its
+ * chunks early will take over chunks that would otherwise have been processed
+ * by a slower resource. This results in better load balancing than 
+ * ecs_worker_iter when tables are small or when table sizes are skewed.
+ * 
+ * The cursor stores the position in the tables of the query, so a resource
+ * only iterates the tables from which it claims chunks. The source iterator 
+ * must therefore be a query iterator. Filter and rule iterators can't be used,
+ * and should be divided with ecs_worker_iter instead.
+ * 
+ * Unlike ecs_worker_iter, the distribution of entities across resources is not
+ * stable between iterations.
+ * 
+ * The cursor must be zero-initialized before it is used for the first time. It
+ * is reset when all 'count' worker iterators are depleted or finalized, and 
+ * when it is used by an iterator that is created in a later frame than the one
+ * in which it was last reset.
+ * 
+ * The iterator must be iterated with ecs_worker_next.
+ * 
+ * @param it The source iterator.
+ * @param index The index of the current resource.
+ * @param count The total number of resources to divide entities between.
+ * @param chunk_size The maximum number of entities in a chunk.
+ * @param cursor The cursor shared between resources.
+ * @return A worker iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_worker_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count,
+    int32_t chunk_size,
+    ecs_worker_cursor_t *cursor);
+
 /** Progress a worker iterator.
  * Progresses an iterator created by ecs_worker_iter.
  * 
@@ -7774,6 +8050,28 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable parallel merging.
+ * When parallel merging is enabled, the values of set commands for components
+ * without OnSet observers or on_set hooks are written after the structural
+ * changes (adding/removing components) of the commands before them have been
+ * applied. When the merge happens while the worker threads of ecs_set_threads
+ * are synchronized, values for different tables are written in parallel.
+ *
+ * Observers and hooks are invoked in the same order as when parallel merging is
+ * disabled. The only difference is that while a queue is merged, observers and
+ * hooks may see the previous value of a component for which a set command was
+ * enqueued. Since values can be written from worker threads, move hooks of
+ * components must be safe to call from multiple threads for different
+ * instances of the component.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -7895,6 +8193,125 @@ FLECS_API
 bool ecs_stage_is_async(
     ecs_world_t *stage);
 
+/** Default number of commands that fit in a command queue. */
+#define ECS_CMD_QUEUE_DEFAULT_CAPACITY (1024)
+
+/** Default maximum size of a value passed to ecs_cmd_queue_set_id. */
+#define ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE (64)
+
+/** A command queue lets threads that are not managed by flecs enqueue
+ * commands for the world without locking. A queue has a single producer and
+ * is drained by ecs_cmd_queues_merge, which is called by ecs_frame_begin (and
+ * therefore ecs_progress). Applications that need multiple producers create
+ * one queue per producer thread. */
+typedef struct ecs_cmd_queue_t ecs_cmd_queue_t;
+
+/** Used with ecs_cmd_queue_new. */
+typedef struct ecs_cmd_queue_desc_t {
+    int32_t _canary;
+
+    /** Maximum number of commands that can be enqueued before the queue is
+     * merged. Defaults to ECS_CMD_QUEUE_DEFAULT_CAPACITY. */
+    int32_t capacity;
+
+    /** Maximum size of values passed to ecs_cmd_queue_set_id. Defaults to
+     * ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE. */
+    ecs_size_t value_size;
+} ecs_cmd_queue_desc_t;
+
+/** Create a command queue.
+ * Storage for the commands is allocated upfront, so that enqueueing a command
+ * never allocates. This operation must be called from the main thread.
+ *
+ * @param world The world.
+ * @param desc Queue parameters.
+ * @return The new queue.
+ */
+FLECS_API
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc);
+
+/** Free a command queue.
+ * Commands that have not been merged yet are applied before the queue is
+ * freed. This operation must be called from the main thread, after the
+ * producer has stopped using the queue.
+ *
+ * @param queue The queue to free.
+ */
+FLECS_API
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue);
+
+/** Enqueue an add command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to add the id to.
+ * @param id The id to add.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_add_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue a remove command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to remove the id from.
+ * @param id The id to remove.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_remove_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue a set command.
+ * The value is copied into the queue with memcpy, and must therefore be
+ * trivially copyable. The size of the value may not exceed the value_size of
+ * the queue.
+ *
+ * @param queue The queue.
+ * @param entity The entity to set the component on.
+ * @param id The component to set.
+ * @param size The size of the value.
+ * @param ptr Pointer to the value.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_set_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr);
+
+/** Enqueue a delete command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to delete.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity);
+
+/** Apply commands from all command queues.
+ * Queues are merged in order of creation, and commands of a queue are applied
+ * in the order in which they were enqueued. Commands for entities that are no
+ * longer alive are discarded. This operation is called by ecs_frame_begin.
+ *
+ * @param world The world.
+ * @return The number of commands that were merged.
+ */
+FLECS_API
+int32_t ecs_cmd_queues_merge(
+    ecs_world_t *world);
+
 /** @} */
 
 /**
@@ -8649,6 +9066,9 @@ int ecs_value_move_ctor(
 #define ecs_add_pair(world, subject, first, second)\
     ecs_add_id(world, subject, ecs_pair(first, second))
 
+#define ecs_bulk_add(world, filter, T)\
+    ecs_bulk_add_id(world, filter, ecs_id(T))
+
 
 /* -- Remove -- */
 
@@ -8658,6 +9078,9 @@ int ecs_value_move_ctor(
 #define ecs_remove_pair(world, subject, first, second)\
     ecs_remove_id(world, subject, ecs_pair(first, second))
 
+#define ecs_bulk_remove(world, filter, T)\
+    ecs_bulk_remove_id(world, filter, ecs_id(T))
+
 
 /* -- Override -- */
 
@@ -8703,6 +9126,18 @@ int ecs_value_move_ctor(
 #define ecs_emplace(world, entity, T)\
     (ECS_CAST(T*, ecs_emplace_id(world, entity, ecs_id(T))))
 
+/* -- Command queues -- */
+
+#define ecs_cmd_queue_add(queue, entity, T)\
+    ecs_cmd_queue_add_id(queue, entity, ecs_id(T))
+
+#define ecs_cmd_queue_remove(queue, entity, T)\
+    ecs_cmd_queue_remove_id(queue, entity, ecs_id(T))
+
+#define ecs_cmd_queue_set(queue, entity, component, ...)\
+    ecs_cmd_queue_set_id(queue, entity, ecs_id(component), sizeof(component),\
+        &(component)__VA_ARGS__)
+
 /* -- Get -- */
 
 #define ecs_get(world, entity, T)\
@@ -9011,6 +9446,9 @@ int ecs_value_move_ctor(
 #ifdef FLECS_NO_RULES
 #undef FLECS_RULES
 #endif
+#ifdef FLECS_NO_INDEX
+#undef FLECS_INDEX
+#endif
 #ifdef FLECS_NO_SNAPSHOT
 #undef FLECS_SNAPSHOT
 #endif
@@ -10419,9 +10857,24 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If set, a multi threaded system divides its entities in chunks of at
+     * most chunk_size entities, which are claimed by worker threads as they
+     * become available. This balances work better across threads when a 
+     * system matches many small tables or tables of very different sizes. When
+     * not set, each thread processes an equal slice of each table. Systems
+     * that are ran with an offset or limit are not chunked. */
+    int32_t chunk_size;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_readonly;
+
+    /* If true, a system that is not multi threaded may run on any worker 
+     * thread. The pipeline runs such systems concurrently with other systems 
+     * between the same merge points, as long as they don't write components
+     * that are read or written by the other systems. Systems that do are ran
+     * in pipeline order on the same thread. */
+    bool concurrent;
 } ecs_system_desc_t;
 
 /* Create a system */
@@ -11547,6 +12000,125 @@ int ecs_iter_to_json_buf(
 
 #endif
 
+#endif
+#ifdef FLECS_INDEX
+#ifdef FLECS_NO_INDEX
+#error "FLECS_NO_INDEX failed: INDEX is required by other addons"
+#endif
+/**
+ * @file index.h
+ * @brief Secondary index addon.
+ *
+ * The index addon maintains a lookup table from the value of a component
+ * member to the entities that have that value. This makes it possible to find
+ * entities by value (for example, the entity for which PlayerId::value is 42)
+ * without scanning all entities with the component.
+ *
+ * The indexed member is located with the reflection data of the component, and
+ * must have an integer, boolean, enum, bitmask or entity type. The index is
+ * kept up to date by an observer for the OnSet and OnRemove events, which means
+ * that values must be assigned with ecs_set or with ecs_modified after the
+ * value has been written, and that entities that have the component but for
+ * which no value has been set are not indexed.
+ */
+
+#ifdef FLECS_INDEX
+
+/* Used to find the indexed member */
+#ifndef FLECS_META
+#define FLECS_META
+#endif
+
+#ifndef FLECS_INDEX_H
+#define FLECS_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Used with ecs_index_init. */
+typedef struct ecs_index_desc_t {
+    int32_t _canary;
+
+    /* Existing entity to associate with index (optional) */
+    ecs_entity_t entity;
+
+    /* Component to index */
+    ecs_entity_t component;
+
+    /* Member of component to index. Nested members are separated with a dot
+     * ("position.x"). If not set, the component must have an integer type. */
+    const char *member;
+} ecs_index_desc_t;
+
+/** Create a secondary index.
+ * The returned entity identifies the index, and is deleted with ecs_delete.
+ * Entities that already have a value for the component are added to the
+ * index when it is created.
+ *
+ * @param world The world.
+ * @param desc Index descriptor.
+ * @return The index, or 0 if the index could not be created.
+ */
+FLECS_API
+ecs_entity_t ecs_index_init(
+    ecs_world_t *world,
+    const ecs_index_desc_t *desc);
+
+/** Find entities by value.
+ * The value must point to a value of the type of the indexed member. The
+ * returned array is valid until the next time an indexed value is set or
+ * removed.
+ *
+ * @param world The world.
+ * @param index The index.
+ * @param value Pointer to value to lookup.
+ * @param count_out Output parameter for the number of entities.
+ * @return Array with entities that have the value, or NULL if there are none.
+ */
+FLECS_API
+const ecs_entity_t* ecs_index_lookup(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value,
+    int32_t *count_out);
+
+/** Create an iterator for entities with a value.
+ * The iterator returns one entity per result, and has a single field for the
+ * indexed component. The iterator can be used as input for a chained filter
+ * iterator (see ecs_filter_chain_iter), in which case the index is used to
+ * find the candidate entities for the filter.
+ *
+ * Indexed values should not be set or removed while iterating.
+ *
+ * @param world The world.
+ * @param index The index.
+ * @param value Pointer to value to lookup.
+ * @return The iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value);
+
+/** Progress an index iterator.
+ *
+ * @param it The iterator.
+ * @return True if more data is available, false if not.
+ */
+FLECS_API
+bool ecs_index_next(
+    ecs_iter_t *it);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
+
 #endif
 #if defined(FLECS_EXPR) || defined(FLECS_META_C)
 #ifndef FLECS_META
@@ -13040,6 +13612,13 @@ extern "C" {
  * Different terms with the same variable name are automatically correlated by
  * the query engine.
  * 
+ * Rules are evaluated from scratch each time they are iterated. When the 
+ * EcsFilterCacheResults flag is set in ecs_filter_desc_t::flags, the results
+ * of an iteration are stored in the rule, and subsequent iterators replay them
+ * until a table is created or deleted, or a table that contains one of the
+ * ids of the rule gains or loses entities. Results are not cached for rules 
+ * with union relationships, or for iterators with constrained variables.
+ * 
  * A rule needs to be explicitly deleted with ecs_rule_fini.
  * 
  * @param world The world.
@@ -13131,6 +13710,30 @@ ecs_iter_t ecs_rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule);
 
+/** Iterate a rule on one of multiple workers.
+ * This operation returns an iterator that evaluates a part of the rule, so 
+ * that the work of evaluating the rule can be divided across threads. The
+ * candidate tables found by the first select operation of the rule program are
+ * distributed across the workers, so that each worker only evaluates the
+ * remainder of the program for its own tables. Together the workers return
+ * the same results as a single rule iterator.
+ * 
+ * If the rule program has no select operation, each worker evaluates the
+ * entire program and returns a subset of the results.
+ * 
+ * @param world The world.
+ * @param rule The rule.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return An iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count);
+
 /** Progress rule iterator.
  * 
  * @param it The iterator.
@@ -14016,6 +14619,7 @@ static const flecs::entity_t Final = EcsFinal;
 static const flecs::entity_t DontInherit = EcsDontInherit;
 static const flecs::entity_t Tag = EcsTag;
 static const flecs::entity_t Union = EcsUnion;
+static const flecs::entity_t Sparse = EcsSparse;
 static const flecs::entity_t Exclusive = EcsExclusive;
 static const flecs::entity_t Acyclic = EcsAcyclic;
 static const flecs::entity_t Symmetric = EcsSymmetric;
@@ -16675,6 +17279,18 @@ struct world {
         ecs_set_automerge(m_world, automerge);
     }
 
+    /** Enable/disable parallel merging.
+     * When enabled, values of set commands for components without OnSet 
+     * observers or hooks are written after structural changes, in parallel
+     * for different tables if worker threads are available.
+     *
+     * @see ecs_set_parallel_merge
+     * @param enable Whether to enable or disable parallel merging.
+     */
+    void set_parallel_merge(bool enable = true) {
+        ecs_set_parallel_merge(m_world, enable);
+    }
+
     /** Merge world or stage.
      * When automatic merging is disabled, an application can call this
      * operation on either an individual stage, or on the world which will merge
@@ -16777,6 +17393,15 @@ struct world {
         ecs_dim(m_world, entity_count);
     }
 
+    /** Release unused memory.
+     * @see ecs_world_trim
+     *
+     * @return Number of bytes released.
+     */
+    int64_t trim() const {
+        return ecs_world_trim(m_world);
+    }
+
     /** Set entity range.
      * This function limits the range of issued entity ids between min and max.
      *
@@ -17682,6 +18307,28 @@ struct column {
         return m_array;
     }
 
+    /** Return pointer to component array.
+     * The pointer is annotated with the alignment of T, which lets the compiler
+     * use aligned vector instructions in loops over the array. Table columns
+     * are aligned to the component alignment, up to FLECS_BALLOC_ALIGN.
+     *
+     * @return Pointer to the first element.
+     */
+    T* data() const {
+        static_assert(alignof(T) <= FLECS_BALLOC_ALIGN,
+            "component alignment exceeds column alignment");
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<T*>(__builtin_assume_aligned(m_array, alignof(T)));
+#else
+        return m_array;
+#endif
+    }
+
+    /** Return number of elements in component array. */
+    size_t count() const {
+        return m_count;
+    }
+
 protected:
     T* m_array;
     size_t m_count;
@@ -21536,6 +22183,17 @@ struct component : untyped_component {
         return *this;
     }
 
+    /** Mark component as relocatable.
+     * A relocatable component can be moved to a new address with a memcpy, 
+     * which lets tables grow without invoking the move constructor for each 
+     * existing instance. Must be set before the component is used. */
+    component<T>& relocatable() {
+        flecs::type_hooks_t h = get_hooks();
+        h.flags |= EcsTypeHookRelocatable;
+        ecs_set_hooks_id(m_world, m_id, &h);
+        return *this;
+    }
+
 private:
     using BindingCtx = _::component_binding_ctx;
 
@@ -23423,9 +24081,16 @@ public:
         return *this;
     }
 
+    /** Only return rows for which components read by the query changed.
+     */
+    Base& changed_only(bool value = true) {
+        m_desc->changed_only = value;
+        return *this;
+    }
+
     /** Specify parent query (creates subquery) */
     Base& observable(const query_base& parent);
-    
+
 protected:
     virtual flecs::world_t* world_v() = 0;
 
@@ -23603,10 +24268,60 @@ public:
     flecs::world world() const {
         return flecs::world(m_world);
     }
+
+    using iterable<Components...>::each;
+
+    /** Each iterator.
+     * Same as iterable::each, but fetches matched tables in batches with
+     * ecs_query_next_batch when the function doesn't have an iter argument.
+     */
+    template <typename Func>
+    void each(Func&& func) const {
+        each(nullptr, FLECS_FWD(func));
+    }
+
+    template <typename Func>
+    void each(flecs::world_t *world, Func&& func) const {
+        using Invoker = _::each_invoker<Func, Components...>;
+        const ecs_filter_t *f = ecs_query_get_filter(m_query);
+        if (Invoker::PassIter || f->field_count > ECS_TERM_DESC_CACHE_SIZE) {
+            iterable<Components...>::each(world, FLECS_FWD(func));
+            return;
+        }
+
+        if (!world) {
+            world = m_world;
+        }
+
+        ecs_iter_t it = ecs_query_iter(world, m_query);
+        ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+
+        ecs_query_batch_t batch[BatchSize];
+        void *ptrs[BatchSize * ECS_TERM_DESC_CACHE_SIZE];
+        ecs_iter_t view = it;
+        Invoker invoker(func);
+
+        int32_t i, count;
+        while ((count = ecs_query_next_batch(&it, batch, ptrs, BatchSize))) {
+            for (i = 0; i < count; i ++) {
+                const ecs_query_batch_t& result = batch[i];
+                view.table = result.table;
+                view.offset = result.offset;
+                view.count = result.count;
+                view.entities = result.entities;
+                view.sources = result.sources;
+                view.ptrs = result.ptrs;
+                invoker.invoke(&view);
+            }
+        }
+    }
     
 private:
     using Terms = typename _::term_ptrs<Components...>::array;
 
+    // Number of results fetched per call to ecs_query_next_batch
+    static constexpr int32_t BatchSize = 32;
+
     ecs_iter_t get_iter(flecs::world_t *world) const override {
         if (!world) {
             world = m_world;
@@ -23768,6 +24483,12 @@ struct observer_builder_i : filter_builder_i<Base, Components ...> {
         return *this;
     }
 
+    /** Invoke observer once for each contiguous range of entities in a table */
+    Base& batched(bool value = true) {
+        m_desc->batched = value;
+        return *this;
+    }
+
     /** Set observer context */
     Base& ctx(void *ptr) {
         m_desc->ctx = ptr;
@@ -24012,6 +24733,17 @@ public:
         return *this;
     }
 
+    /** Specify chunk size for multi threaded system.
+     * When set, threads claim chunks of at most the specified number of 
+     * entities instead of processing an equal slice of each table.
+     *
+     * @param value The maximum number of entities per chunk.
+     */
+    Base& chunk_size(int32_t value) {
+        m_desc->chunk_size = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
@@ -24021,6 +24753,17 @@ public:
         return *this;
     }
 
+    /** Specify whether system can run concurrently with other systems.
+     * Systems that are not multi threaded and that don't write components 
+     * accessed by other systems may run on any worker thread.
+     *
+     * @param value If true system may run on any worker thread.
+     */
+    Base& concurrent(bool value = true) {
+        m_desc->concurrent = value;
+        return *this;
+    }
+
     /** Set system interval.
      * This operation will cause the system to be ran at the specified interval.
      *
@@ -127,6 +127,7 @@
 #define FLECS_PARSER        /* String parser for queries */
 #define FLECS_PLECS         /* ECS data definition format */
 #define FLECS_RULES         /* Constraint solver for advanced queries */
+#define FLECS_INDEX         /* Lookup entities by component value */
 #define FLECS_SNAPSHOT      /* Snapshot & restore ECS data */
 #define FLECS_STATS         /* Access runtime statistics */
 #define FLECS_MONITOR       /* Track runtime statistics periodically */
@@ -543,6 +544,8 @@ struct ecs_filter_t {
     char *name;                /* Name of filter (optional) */
     char *variable_names[1];   /* Array with variable names */
 
+    int32_t *plan;             /* Order in which terms are evaluated */
+
     ecs_iterable_t iterable;   /* Iterable mixin */
 };
 
@@ -578,6 +581,8 @@ struct ecs_observer_t {
 
     bool is_multi;              /* If true, the observer triggers on more than one term */
 
+    struct ecs_observer_match_cache_t *match_cache; /* Cached filter matches (multi observers only) */
+
     /* Mixins */
     ecs_world_t *world;
     ecs_entity_t entity;
@@ -609,6 +614,13 @@ struct ecs_type_hooks_t {
      * not set explicitly it will be derived from other callbacks. */
     ecs_move_t move_dtor;
 
+    /* Hook flags (see EcsTypeHook* flags).
+     * EcsTypeHookRelocatable indicates that instances of the type may be moved
+     * to a new address with a memcpy, without invoking the move constructor or
+     * destructor. This lets a table grow its column storage by reallocating,
+     * instead of move constructing each existing element into a new buffer. */
+    ecs_flags32_t flags;
+
     /* Callback that is invoked when an instance of a component is added. This
      * callback is invoked before triggers are invoked. */
     ecs_iter_action_t on_add;
@@ -814,6 +826,13 @@ typedef struct ecs_query_desc_t {
 
     /* Entity associated with query (optional) */
     ecs_entity_t entity;
+
+    /* If set, the query only returns the rows for which a component that is
+     * read by the query changed since the last time the rows were iterated.
+     * Changes are tracked per block of 64 rows, so results can include rows
+     * that didn't change. Rows are marked changed by ecs_modified, ecs_set and
+     * by queries that write to the component. */
+    bool changed_only;
 } ecs_query_desc_t;
 
 /** Used with ecs_observer_init. */
@@ -834,6 +853,14 @@ typedef struct ecs_observer_desc_t {
      * This is only supported for events that are iterable (see EcsIterable) */
     bool yield_existing;
 
+    /* Invoke the observer once for each contiguous range of entities in a
+     * table for which an event is emitted. Events from bulk operations, like
+     * ecs_bulk_init and ecs_bulk_new_w_id, cover all entities created in a
+     * table. Without this flag, an observer with a field that is matched on a
+     * shared (inherited) component is invoked once per entity. Implies that
+     * the observer filter is instanced (see ecs_filter_desc_t::instanced). */
+    bool batched;
+
     /* Callback to invoke on an event, invoked when the observer matches. */
     ecs_iter_action_t callback;
 
@@ -888,7 +915,10 @@ typedef struct EcsIdentifier {
 /** Component information. */
 typedef struct EcsComponent {
     ecs_size_t size;           /* Component size */
-    ecs_size_t alignment;      /* Component alignment */
+    ecs_size_t alignment;      /* Component alignment. Table columns start at an
+                                * address aligned to this value (up to 
+                                * FLECS_BALLOC_ALIGN) if the size is a multiple
+                                * of the alignment. */
 } EcsComponent;
 
 /** Component for storing a poly object */
@@ -970,6 +1000,7 @@ typedef struct ecs_world_info_t {
         int64_t discard_count;         /* commands discarded, happens when entity is no longer alive when running the command */
         int64_t batched_entity_count;  /* entities for which commands were batched */
         int64_t batched_command_count; /* commands batched */
+        int64_t batched_group_count;   /* groups of entities moved to the same table in a single operation */
     } cmd;
 
     const char *name_prefix;          /* Value set by ecs_set_name_prefix. Used
@@ -985,6 +1016,17 @@ typedef struct ecs_query_group_info_t {
     void *ctx;            /* Group context, returned by on_group_create */
 } ecs_query_group_info_t;
 
+/** Result returned by ecs_query_next_batch. */
+typedef struct ecs_query_batch_t {
+    ecs_table_t *table;           /* Matched table */
+    ecs_entity_t *entities;       /* Entity ids, starting at offset */
+    int32_t offset;               /* First row of table in result */
+    int32_t count;                /* Number of rows in result */
+    uint64_t group_id;            /* Group id of table */
+    ecs_entity_t *sources;        /* Field sources (0 if field is owned) */
+    void **ptrs;                  /* Field data, starting at offset */
+} ecs_query_batch_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -1137,6 +1179,19 @@ FLECS_API extern const ecs_entity_t EcsTag;
  * are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/* Tag to indicate that a component is stored in a sparse set keyed by entity
+ * instead of in a table column. Adding or removing a sparse component does not
+ * move the entity to another table, which makes it a good fit for components
+ * that are added and removed at a high frequency. 
+ *
+ * Sparse components can be added with ecs_add, ecs_set, ecs_get_mut and 
+ * ecs_emplace, and invoke the on_add, on_set and on_remove hooks. They are 
+ * matched by cached queries. Creating a filter, rule or observer with a sparse
+ * term fails. Since queries iterate entities by table, entities that only have
+ * sparse components are not matched. The tag must be added before the 
+ * component is used. */
+FLECS_API extern const ecs_entity_t EcsSparse;
+
 /* Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -1590,6 +1645,25 @@ int32_t ecs_delete_empty_tables(
     int32_t min_id_count,
     double time_budget_seconds);
 
+/** Release unused memory.
+ * This operation returns memory that is no longer in use to the OS. Table
+ * storage is shrunk to the number of entities in each table, unused chunks of
+ * sparse sets are freed, and blocks of the world & stage allocators that no
+ * longer have any allocated elements are released.
+ * 
+ * This operation is useful after a spike in memory usage, like when a large
+ * number of entities was created and then deleted. It walks all tables and
+ * allocators, so it should not be called every frame.
+ * 
+ * This operation may not be called while the world is in readonly mode.
+ * 
+ * @param world The world.
+ * @return Number of bytes released by the world & stage allocators.
+ */
+FLECS_API
+int64_t ecs_world_trim(
+    ecs_world_t *world);
+
 
 /** Test if pointer is of specified type.
  * Usage:
@@ -1829,6 +1903,42 @@ void ecs_override_id(
     ecs_entity_t entity,
     ecs_id_t id);
 
+/** Add a (component) id to all entities matching a filter.
+ * This operation adds an id to all entities that match the filter. Instead of
+ * moving entities one by one, entities are moved per table: the destination
+ * table is computed once, component columns are moved in a single operation 
+ * and a single OnAdd event is emitted for each table.
+ * 
+ * The filter must match $this. If only part of a table is matched (which can
+ * happen for filters with union or toggle terms), or when the world is in
+ * deferred mode, the operation falls back to per entity add operations.
+ * 
+ * The operation must not be called while iterating the tables it modifies.
+ *
+ * @param world The world.
+ * @param filter The filter that selects the entities.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
+/** Remove a (component) id from all entities matching a filter.
+ * Same as ecs_bulk_add_id, but removes the id. A single OnRemove event is 
+ * emitted for each table.
+ *
+ * @param world The world.
+ * @param filter The filter that selects the entities.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
 /** @} */
 
 
@@ -3300,6 +3410,10 @@ ecs_iter_t ecs_filter_iter(
  * A chained iterator applies a filter to the results of the input iterator. The
  * resulting iterator must be iterated with ecs_filter_next.
  * 
+ * The chained iterator returns all entities of a table returned by the input
+ * iterator, unless the input iterator has the EcsIterRowRange flag (like the
+ * index iterator), in which case it only returns the rows of the input result.
+ * 
  * @param it The input iterator
  * @param filter The filter to apply to the iterator.
  * @return The chained iterator. 
@@ -3519,6 +3633,39 @@ FLECS_API
 void ecs_query_populate(
     ecs_iter_t *iter);
 
+/** Progress the query iterator by multiple results at once.
+ * This operation fills the batch array with up to max_count results. Each
+ * result contains the table, row range and field pointers for a matched table,
+ * which is the same information ecs_query_next_instanced returns for a single
+ * result. For queries that only have This terms, results are obtained straight
+ * from the query cache, which avoids populating the iterator per table.
+ * 
+ * The ptrs array provides the storage for the field pointers and must have
+ * space for max_count * field_count elements. The ptrs member of each result
+ * points into this array.
+ * 
+ * Results are always instanced: if the sources member for a field is not 0, the
+ * field pointer points to a single value instead of an array. Components of
+ * inout/out terms are marked dirty when a result is returned.
+ * 
+ * An iterator should either be progressed with ecs_query_next_batch or with
+ * one of the other next functions. The iterator fields (table, count, ptrs)
+ * are not valid after this operation. When the operation returns 0 the 
+ * iterator is finalized.
+ * 
+ * @param iter The iterator.
+ * @param batch Array in which to store the results.
+ * @param ptrs Storage for field pointers (max_count * field_count elements).
+ * @param max_count The maximum number of results to return.
+ * @return The number of results stored in the batch array.
+ */
+FLECS_API
+int32_t ecs_query_next_batch(
+    ecs_iter_t *iter,
+    ecs_query_batch_t *batch,
+    void **ptrs,
+    int32_t max_count);
+
 /** Returns whether the query data changed since the last iteration.
  * The operation will return true after:
  * - new entities have been matched with
@@ -4097,6 +4244,44 @@ ecs_iter_t ecs_worker_iter(
     int32_t index,
     int32_t count);
 
+/** Create a chunked worker iterator.
+ * Chunked worker iterators divide matched entities in chunks of at most 
+ * chunk_size entities. Resources claim chunks from a cursor that is shared 
+ * between all worker iterators, which means that a resource that finishes its
+ * chunks early will take over chunks that would otherwise have been processed
+ * by a slower resource. This results in better load balancing than 
+ * ecs_worker_iter when tables are small or when table sizes are skewed.
+ * 
+ * The cursor stores the position in the tables of the query, so a resource
+ * only iterates the tables from which it claims chunks. The source iterator 
+ * must therefore be a query iterator. Filter and rule iterators can't be used,
+ * and should be divided with ecs_worker_iter instead.
+ * 
+ * Unlike ecs_worker_iter, the distribution of entities across resources is not
+ * stable between iterations.
+ * 
+ * The cursor must be zero-initialized before it is used for the first time. It
+ * is reset when all 'count' worker iterators are depleted or finalized, and 
+ * when it is used by an iterator that is created in a later frame than the one
+ * in which it was last reset.
+ * 
+ * The iterator must be iterated with ecs_worker_next.
+ * 
+ * @param it The source iterator.
+ * @param index The index of the current resource.
+ * @param count The total number of resources to divide entities between.
+ * @param chunk_size The maximum number of entities in a chunk.
+ * @param cursor The cursor shared between resources.
+ * @return A worker iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_worker_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count,
+    int32_t chunk_size,
+    ecs_worker_cursor_t *cursor);
+
 /** Progress a worker iterator.
  * Progresses an iterator created by ecs_worker_iter.
  * 
@@ -4489,6 +4674,28 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable parallel merging.
+ * When parallel merging is enabled, the values of set commands for components
+ * without OnSet observers or on_set hooks are written after the structural
+ * changes (adding/removing components) of the commands before them have been
+ * applied. When the merge happens while the worker threads of ecs_set_threads
+ * are synchronized, values for different tables are written in parallel.
+ *
+ * Observers and hooks are invoked in the same order as when parallel merging is
+ * disabled. The only difference is that while a queue is merged, observers and
+ * hooks may see the previous value of a component for which a set command was
+ * enqueued. Since values can be written from worker threads, move hooks of
+ * components must be safe to call from multiple threads for different
+ * instances of the component.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -4610,6 +4817,125 @@ FLECS_API
 bool ecs_stage_is_async(
     ecs_world_t *stage);
 
+/** Default number of commands that fit in a command queue. */
+#define ECS_CMD_QUEUE_DEFAULT_CAPACITY (1024)
+
+/** Default maximum size of a value passed to ecs_cmd_queue_set_id. */
+#define ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE (64)
+
+/** A command queue lets threads that are not managed by flecs enqueue
+ * commands for the world without locking. A queue has a single producer and
+ * is drained by ecs_cmd_queues_merge, which is called by ecs_frame_begin (and
+ * therefore ecs_progress). Applications that need multiple producers create
+ * one queue per producer thread. */
+typedef struct ecs_cmd_queue_t ecs_cmd_queue_t;
+
+/** Used with ecs_cmd_queue_new. */
+typedef struct ecs_cmd_queue_desc_t {
+    int32_t _canary;
+
+    /** Maximum number of commands that can be enqueued before the queue is
+     * merged. Defaults to ECS_CMD_QUEUE_DEFAULT_CAPACITY. */
+    int32_t capacity;
+
+    /** Maximum size of values passed to ecs_cmd_queue_set_id. Defaults to
+     * ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE. */
+    ecs_size_t value_size;
+} ecs_cmd_queue_desc_t;
+
+/** Create a command queue.
+ * Storage for the commands is allocated upfront, so that enqueueing a command
+ * never allocates. This operation must be called from the main thread.
+ *
+ * @param world The world.
+ * @param desc Queue parameters.
+ * @return The new queue.
+ */
+FLECS_API
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc);
+
+/** Free a command queue.
+ * Commands that have not been merged yet are applied before the queue is
+ * freed. This operation must be called from the main thread, after the
+ * producer has stopped using the queue.
+ *
+ * @param queue The queue to free.
+ */
+FLECS_API
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue);
+
+/** Enqueue an add command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to add the id to.
+ * @param id The id to add.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_add_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue a remove command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to remove the id from.
+ * @param id The id to remove.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_remove_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue a set command.
+ * The value is copied into the queue with memcpy, and must therefore be
+ * trivially copyable. The size of the value may not exceed the value_size of
+ * the queue.
+ *
+ * @param queue The queue.
+ * @param entity The entity to set the component on.
+ * @param id The component to set.
+ * @param size The size of the value.
+ * @param ptr Pointer to the value.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_set_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr);
+
+/** Enqueue a delete command.
+ *
+ * @param queue The queue.
+ * @param entity The entity to delete.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity);
+
+/** Apply commands from all command queues.
+ * Queues are merged in order of creation, and commands of a queue are applied
+ * in the order in which they were enqueued. Commands for entities that are no
+ * longer alive are discarded. This operation is called by ecs_frame_begin.
+ *
+ * @param world The world.
+ * @return The number of commands that were merged.
+ */
+FLECS_API
+int32_t ecs_cmd_queues_merge(
+    ecs_world_t *world);
+
 /** @} */
 
 /**
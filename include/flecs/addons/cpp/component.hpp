@@ -453,6 +453,17 @@ struct component : untyped_component {
         return *this;
     }
 
+    /** Mark component as relocatable.
+     * A relocatable component can be moved to a new address with a memcpy, 
+     * which lets tables grow without invoking the move constructor for each 
+     * existing instance. Must be set before the component is used. */
+    component<T>& relocatable() {
+        flecs::type_hooks_t h = get_hooks();
+        h.flags |= EcsTypeHookRelocatable;
+        ecs_set_hooks_id(m_world, m_id, &h);
+        return *this;
+    }
+
 private:
     using BindingCtx = _::component_binding_ctx;
 
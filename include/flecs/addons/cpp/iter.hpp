@@ -92,6 +92,28 @@ struct column {
         return m_array;
     }
 
+    /** Return pointer to component array.
+     * The pointer is annotated with the alignment of T, which lets the compiler
+     * use aligned vector instructions in loops over the array. Table columns
+     * are aligned to the component alignment, up to FLECS_BALLOC_ALIGN.
+     *
+     * @return Pointer to the first element.
+     */
+    T* data() const {
+        static_assert(alignof(T) <= FLECS_BALLOC_ALIGN,
+            "component alignment exceeds column alignment");
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<T*>(__builtin_assume_aligned(m_array, alignof(T)));
+#else
+        return m_array;
+#endif
+    }
+
+    /** Return number of elements in component array. */
+    size_t count() const {
+        return m_count;
+    }
+
 protected:
     T* m_array;
     size_t m_count;
@@ -41,6 +41,12 @@ struct observer_builder_i : filter_builder_i<Base, Components ...> {
         return *this;
     }
 
+    /** Invoke observer once for each contiguous range of entities in a table */
+    Base& batched(bool value = true) {
+        m_desc->batched = value;
+        return *this;
+    }
+
     /** Set observer context */
     Base& ctx(void *ptr) {
         m_desc->ctx = ptr;
@@ -134,9 +134,16 @@ public:
         return *this;
     }
 
+    /** Only return rows for which components read by the query changed.
+     */
+    Base& changed_only(bool value = true) {
+        m_desc->changed_only = value;
+        return *this;
+    }
+
     /** Specify parent query (creates subquery) */
     Base& observable(const query_base& parent);
-    
+
 protected:
     virtual flecs::world_t* world_v() = 0;
 
@@ -139,10 +139,60 @@ public:
     flecs::world world() const {
         return flecs::world(m_world);
     }
+
+    using iterable<Components...>::each;
+
+    /** Each iterator.
+     * Same as iterable::each, but fetches matched tables in batches with
+     * ecs_query_next_batch when the function doesn't have an iter argument.
+     */
+    template <typename Func>
+    void each(Func&& func) const {
+        each(nullptr, FLECS_FWD(func));
+    }
+
+    template <typename Func>
+    void each(flecs::world_t *world, Func&& func) const {
+        using Invoker = _::each_invoker<Func, Components...>;
+        const ecs_filter_t *f = ecs_query_get_filter(m_query);
+        if (Invoker::PassIter || f->field_count > ECS_TERM_DESC_CACHE_SIZE) {
+            iterable<Components...>::each(world, FLECS_FWD(func));
+            return;
+        }
+
+        if (!world) {
+            world = m_world;
+        }
+
+        ecs_iter_t it = ecs_query_iter(world, m_query);
+        ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+
+        ecs_query_batch_t batch[BatchSize];
+        void *ptrs[BatchSize * ECS_TERM_DESC_CACHE_SIZE];
+        ecs_iter_t view = it;
+        Invoker invoker(func);
+
+        int32_t i, count;
+        while ((count = ecs_query_next_batch(&it, batch, ptrs, BatchSize))) {
+            for (i = 0; i < count; i ++) {
+                const ecs_query_batch_t& result = batch[i];
+                view.table = result.table;
+                view.offset = result.offset;
+                view.count = result.count;
+                view.entities = result.entities;
+                view.sources = result.sources;
+                view.ptrs = result.ptrs;
+                invoker.invoke(&view);
+            }
+        }
+    }
     
 private:
     using Terms = typename _::term_ptrs<Components...>::array;
 
+    // Number of results fetched per call to ecs_query_next_batch
+    static constexpr int32_t BatchSize = 32;
+
     ecs_iter_t get_iter(flecs::world_t *world) const override {
         if (!world) {
             world = m_world;
@@ -51,6 +51,17 @@ public:
         return *this;
     }
 
+    /** Specify chunk size for multi threaded system.
+     * When set, threads claim chunks of at most the specified number of 
+     * entities instead of processing an equal slice of each table.
+     *
+     * @param value The maximum number of entities per chunk.
+     */
+    Base& chunk_size(int32_t value) {
+        m_desc->chunk_size = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
@@ -60,6 +71,17 @@ public:
         return *this;
     }
 
+    /** Specify whether system can run concurrently with other systems.
+     * Systems that are not multi threaded and that don't write components 
+     * accessed by other systems may run on any worker thread.
+     *
+     * @param value If true system may run on any worker thread.
+     */
+    Base& concurrent(bool value = true) {
+        m_desc->concurrent = value;
+        return *this;
+    }
+
     /** Set system interval.
      * This operation will cause the system to be ran at the specified interval.
      *
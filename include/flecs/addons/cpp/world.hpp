@@ -352,6 +352,18 @@ struct world {
         ecs_set_automerge(m_world, automerge);
     }
 
+    /** Enable/disable parallel merging.
+     * When enabled, values of set commands for components without OnSet 
+     * observers or hooks are written after structural changes, in parallel
+     * for different tables if worker threads are available.
+     *
+     * @see ecs_set_parallel_merge
+     * @param enable Whether to enable or disable parallel merging.
+     */
+    void set_parallel_merge(bool enable = true) {
+        ecs_set_parallel_merge(m_world, enable);
+    }
+
     /** Merge world or stage.
      * When automatic merging is disabled, an application can call this
      * operation on either an individual stage, or on the world which will merge
@@ -454,6 +466,15 @@ struct world {
         ecs_dim(m_world, entity_count);
     }
 
+    /** Release unused memory.
+     * @see ecs_world_trim
+     *
+     * @return Number of bytes released.
+     */
+    int64_t trim() const {
+        return ecs_world_trim(m_world);
+    }
+
     /** Set entity range.
      * This function limits the range of issued entity ids between min and max.
      *
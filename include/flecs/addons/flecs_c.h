@@ -259,6 +259,9 @@
 #define ecs_add_pair(world, subject, first, second)\
     ecs_add_id(world, subject, ecs_pair(first, second))
 
+#define ecs_bulk_add(world, filter, T)\
+    ecs_bulk_add_id(world, filter, ecs_id(T))
+
 
 /* -- Remove -- */
 
@@ -268,6 +271,9 @@
 #define ecs_remove_pair(world, subject, first, second)\
     ecs_remove_id(world, subject, ecs_pair(first, second))
 
+#define ecs_bulk_remove(world, filter, T)\
+    ecs_bulk_remove_id(world, filter, ecs_id(T))
+
 
 /* -- Override -- */
 
@@ -313,6 +319,18 @@
 #define ecs_emplace(world, entity, T)\
     (ECS_CAST(T*, ecs_emplace_id(world, entity, ecs_id(T))))
 
+/* -- Command queues -- */
+
+#define ecs_cmd_queue_add(queue, entity, T)\
+    ecs_cmd_queue_add_id(queue, entity, ecs_id(T))
+
+#define ecs_cmd_queue_remove(queue, entity, T)\
+    ecs_cmd_queue_remove_id(queue, entity, ecs_id(T))
+
+#define ecs_cmd_queue_set(queue, entity, component, ...)\
+    ecs_cmd_queue_set_id(queue, entity, ecs_id(component), sizeof(component),\
+        &(component)__VA_ARGS__)
+
 /* -- Get -- */
 
 #define ecs_get(world, entity, T)\
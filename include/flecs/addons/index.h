@@ -0,0 +1,113 @@
+/**
+ * @file index.h
+ * @brief Secondary index addon.
+ *
+ * The index addon maintains a lookup table from the value of a component
+ * member to the entities that have that value. This makes it possible to find
+ * entities by value (for example, the entity for which PlayerId::value is 42)
+ * without scanning all entities with the component.
+ *
+ * The indexed member is located with the reflection data of the component, and
+ * must have an integer, boolean, enum, bitmask or entity type. The index is
+ * kept up to date by an observer for the OnSet and OnRemove events, which means
+ * that values must be assigned with ecs_set or with ecs_modified after the
+ * value has been written, and that entities that have the component but for
+ * which no value has been set are not indexed.
+ */
+
+#ifdef FLECS_INDEX
+
+/* Used to find the indexed member */
+#ifndef FLECS_META
+#define FLECS_META
+#endif
+
+#ifndef FLECS_INDEX_H
+#define FLECS_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Used with ecs_index_init. */
+typedef struct ecs_index_desc_t {
+    int32_t _canary;
+
+    /* Existing entity to associate with index (optional) */
+    ecs_entity_t entity;
+
+    /* Component to index */
+    ecs_entity_t component;
+
+    /* Member of component to index. Nested members are separated with a dot
+     * ("position.x"). If not set, the component must have an integer type. */
+    const char *member;
+} ecs_index_desc_t;
+
+/** Create a secondary index.
+ * The returned entity identifies the index, and is deleted with ecs_delete.
+ * Entities that already have a value for the component are added to the
+ * index when it is created.
+ *
+ * @param world The world.
+ * @param desc Index descriptor.
+ * @return The index, or 0 if the index could not be created.
+ */
+FLECS_API
+ecs_entity_t ecs_index_init(
+    ecs_world_t *world,
+    const ecs_index_desc_t *desc);
+
+/** Find entities by value.
+ * The value must point to a value of the type of the indexed member. The
+ * returned array is valid until the next time an indexed value is set or
+ * removed.
+ *
+ * @param world The world.
+ * @param index The index.
+ * @param value Pointer to value to lookup.
+ * @param count_out Output parameter for the number of entities.
+ * @return Array with entities that have the value, or NULL if there are none.
+ */
+FLECS_API
+const ecs_entity_t* ecs_index_lookup(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value,
+    int32_t *count_out);
+
+/** Create an iterator for entities with a value.
+ * The iterator returns one entity per result, and has a single field for the
+ * indexed component. The iterator can be used as input for a chained filter
+ * iterator (see ecs_filter_chain_iter), in which case the index is used to
+ * find the candidate entities for the filter.
+ *
+ * Indexed values should not be set or removed while iterating.
+ *
+ * @param world The world.
+ * @param index The index.
+ * @param value Pointer to value to lookup.
+ * @return The iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value);
+
+/** Progress an index iterator.
+ *
+ * @param it The iterator.
+ * @return True if more data is available, false if not.
+ */
+FLECS_API
+bool ecs_index_next(
+    ecs_iter_t *it);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
@@ -64,6 +64,13 @@ extern "C" {
  * Different terms with the same variable name are automatically correlated by
  * the query engine.
  * 
+ * Rules are evaluated from scratch each time they are iterated. When the 
+ * EcsFilterCacheResults flag is set in ecs_filter_desc_t::flags, the results
+ * of an iteration are stored in the rule, and subsequent iterators replay them
+ * until a table is created or deleted, or a table that contains one of the
+ * ids of the rule gains or loses entities. Results are not cached for rules 
+ * with union relationships, or for iterators with constrained variables.
+ * 
  * A rule needs to be explicitly deleted with ecs_rule_fini.
  * 
  * @param world The world.
@@ -155,6 +162,30 @@ ecs_iter_t ecs_rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule);
 
+/** Iterate a rule on one of multiple workers.
+ * This operation returns an iterator that evaluates a part of the rule, so 
+ * that the work of evaluating the rule can be divided across threads. The
+ * candidate tables found by the first select operation of the rule program are
+ * distributed across the workers, so that each worker only evaluates the
+ * remainder of the program for its own tables. Together the workers return
+ * the same results as a single rule iterator.
+ * 
+ * If the rule program has no select operation, each worker evaluates the
+ * entire program and returns a subset of the results.
+ * 
+ * @param world The world.
+ * @param rule The rule.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return An iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count);
+
 /** Progress rule iterator.
  * 
  * @param it The iterator.
@@ -88,9 +88,24 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If set, a multi threaded system divides its entities in chunks of at
+     * most chunk_size entities, which are claimed by worker threads as they
+     * become available. This balances work better across threads when a 
+     * system matches many small tables or tables of very different sizes. When
+     * not set, each thread processes an equal slice of each table. Systems
+     * that are ran with an offset or limit are not chunked. */
+    int32_t chunk_size;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_readonly;
+
+    /* If true, a system that is not multi threaded may run on any worker 
+     * thread. The pipeline runs such systems concurrently with other systems 
+     * between the same merge points, as long as they don't write components
+     * that are read or written by the other systems. Systems that do are ran
+     * in pipeline order on the same thread. */
+    bool concurrent;
 } ecs_system_desc_t;
 
 /* Create a system */
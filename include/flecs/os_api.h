@@ -102,6 +102,11 @@ typedef
 int64_t (*ecs_os_api_lainc_t)(
     int64_t *value);
 
+/* Atomic load with acquire semantics */
+typedef
+int32_t (*ecs_os_api_aload_t)(
+    const int32_t *value);
+
 /* Mutex */
 typedef
 ecs_os_mutex_t (*ecs_os_api_mutex_new_t)(
@@ -271,6 +276,10 @@ typedef struct ecs_os_api_t {
 
     /* OS API flags */
     ecs_flags32_t flags_;
+
+    /* Atomic load. Added after the other members, so that existing OS API
+     * implementations don't have to set it. Defaults to a compiler builtin. */
+    ecs_os_api_aload_t aload_;
 } ecs_os_api_t;
 
 FLECS_API
@@ -397,6 +406,7 @@ void ecs_os_set_api_defaults(void);
 #define ecs_os_adec(value) ecs_os_api.adec_(value)
 #define ecs_os_lainc(value) ecs_os_api.lainc_(value)
 #define ecs_os_ladec(value) ecs_os_api.ladec_(value)
+#define ecs_os_aload(value) ecs_os_api.aload_(value)
 
 /* Mutex */
 #define ecs_os_mutex_new() ecs_os_api.mutex_new_()
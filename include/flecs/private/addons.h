@@ -35,6 +35,9 @@
 #ifdef FLECS_NO_RULES
 #undef FLECS_RULES
 #endif
+#ifdef FLECS_NO_INDEX
+#undef FLECS_INDEX
+#endif
 #ifdef FLECS_NO_SNAPSHOT
 #undef FLECS_SNAPSHOT
 #endif
@@ -169,6 +172,12 @@
 #endif
 #include "../addons/json.h"
 #endif
+#ifdef FLECS_INDEX
+#ifdef FLECS_NO_INDEX
+#error "FLECS_NO_INDEX failed: INDEX is required by other addons"
+#endif
+#include "../addons/index.h"
+#endif
 #if defined(FLECS_EXPR) || defined(FLECS_META_C)
 #ifndef FLECS_META
 #define FLECS_META
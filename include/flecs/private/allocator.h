@@ -26,6 +26,10 @@ FLECS_API
 void flecs_allocator_fini(
     ecs_allocator_t *a);
 
+FLECS_API
+int64_t flecs_allocator_trim(
+    ecs_allocator_t *a);
+
 FLECS_API
 ecs_block_allocator_t* flecs_allocator_get(
     ecs_allocator_t *a, 
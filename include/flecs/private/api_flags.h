@@ -22,6 +22,9 @@ extern "C" {
 #define EcsWorldMeasureFrameTime      (1u << 4)
 #define EcsWorldMeasureSystemTime     (1u << 5)
 #define EcsWorldMultiThreaded         (1u << 6)
+#define EcsWorldHasSparse             (1u << 7)
+#define EcsWorldParallelMerge         (1u << 8)
+#define EcsWorldHasSubsets            (1u << 9)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,6 +70,7 @@ extern "C" {
 #define EcsIdTag                       (1u << 9)
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
+#define EcsIdSparse                    (1u << 12)
 
 #define EcsIdHasOnAdd                  (1u << 15) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 16) 
@@ -86,6 +90,13 @@ extern "C" {
 #define ECS_ID_ON_DELETE_OBJECT_FLAG(id) (1u << (3 + ((id) - EcsRemove)))
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Type hook flags (used by ecs_type_hooks_t::flags)
+////////////////////////////////////////////////////////////////////////////////
+
+#define EcsTypeHookRelocatable         (1u << 0u)  /* Type can be moved with memcpy */
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Iterator flags (used by ecs_iter_t::flags)
 ////////////////////////////////////////////////////////////////////////////////
@@ -99,6 +110,7 @@ extern "C" {
 #define EcsIterNoResults               (1u << 6u)  /* Iterator has no results */
 #define EcsIterIgnoreThis              (1u << 7u)  /* Only evaluate non-this terms */
 #define EcsIterMatchVar           (1u << 8u)
+#define EcsIterRowRange                (1u << 9u)  /* Chained filters only return rows of iterator */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Filter flags (used by ecs_filter_t::flags)
@@ -120,6 +132,8 @@ extern "C" {
 #define EcsFilterIsFilter              (1u << 7u)  /* When true, data fields won't be populated */
 #define EcsFilterIsInstanced           (1u << 8u)  /* Is filter instanced (see ecs_filter_desc_t) */
 #define EcsFilterPopulate              (1u << 9u)  /* Populate data, ignore non-matching fields */
+#define EcsFilterCacheResults          (1u << 10u) /* Cache rule results (see ecs_rule_init) */
+#define EcsFilterMatchSparse           (1u << 11u) /* Allow sparse terms (used by queries) */
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -166,6 +180,11 @@ extern "C" {
 #define EcsQueryIsOrphaned             (1u << 3u)  /* Is subquery orphaned */
 #define EcsQueryHasOutColumns          (1u << 4u)  /* Does query have out columns */
 #define EcsQueryHasMonitor             (1u << 5u)  /* Does query track changes */
+#define EcsQueryHasSparse              (1u << 6u)  /* Does query have sparse terms */
+#define EcsQueryHasSparseData          (1u << 7u)  /* Does query read sparse data */
+#define EcsQueryChangedOnly            (1u << 8u)  /* Only return changed rows */
+#define EcsQueryTableArrayDirty        (1u << 9u)  /* Table array must be rebuilt */
+#define EcsQueryTableArrayQueued       (1u << 10u) /* Query is in world queue */
 
 
 ////////////////////////////////////////////////////////////////////////////////
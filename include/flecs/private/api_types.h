@@ -36,6 +36,9 @@ typedef struct ecs_switch_t ecs_switch_t;
 /* Cached query table data */
 typedef struct ecs_query_table_node_t ecs_query_table_node_t;
 
+/* Contiguous array with cached query table data */
+typedef struct ecs_query_table_array_t ecs_query_table_array_t;
+
 /* Allocator type */
 struct ecs_allocator_t;
 
@@ -110,10 +113,30 @@ typedef struct ecs_page_iter_t {
     int32_t remaining;
 } ecs_page_iter_t;
 
+/* Cursor shared between chunked worker iterators */
+typedef struct ecs_worker_cursor_t {
+    int32_t lock;                 /* Spinlock that protects the position */
+    int32_t done;                 /* Number of workers that are done */
+    int64_t frame;                /* Frame in which the position was reset */
+    ecs_query_table_node_t *node; /* Table node to claim next chunk from */
+    int32_t row;                  /* Next row to claim from node */
+    bool started;                 /* Is the position valid */
+} ecs_worker_cursor_t;
+
 /* Worker-iterator specific data */
 typedef struct ecs_worker_iter_t {
     int32_t index;
     int32_t count;
+
+    /* Chunked iteration */
+    int32_t chunk_size;           /* Rows per chunk (0 if not chunked) */
+    int32_t chunk_first;          /* First row of claimed chunk */
+    int32_t chunk_last;           /* Row after claimed chunk (-1 if no table) */
+    bool chunk_claimed;           /* Is a claimed chunk being iterated */
+    bool chunk_done;              /* Has the worker finished iterating */
+    int64_t chunk_frame;          /* Frame in which the iterator was created */
+    ecs_query_table_node_t *chunk_start; /* First table node of query */
+    ecs_worker_cursor_t *cursor;  /* Cursor shared between workers */
 } ecs_worker_iter_t;
 
 /* Convenience struct to iterate table array for id */
@@ -172,8 +195,23 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+    ecs_query_table_node_t *join_next; /* Node to continue with after join */
+    int32_t join_first;  /* Remaining range of rows to join with sparse terms */
+    int32_t join_count;
+    int32_t changed_first; /* Row to continue from when finding changed rows */
+    bool changed_ranges; /* Table changed, remaining toggle/union ranges left */
+    int32_t prev_first;  /* Rows of previous result, used to mark rows dirty */
+    int32_t prev_count;
+    ecs_query_table_array_t *table_array; /* Iterated array, NULL if list */
 } ecs_query_iter_t;
 
+/** Index-iterator specific data */
+typedef struct ecs_index_iter_t {
+    const ecs_entity_t *entities; /* Entities with indexed value */
+    int32_t index;                /* Current position in entities array */
+    int32_t count;                /* Number of entities with indexed value */
+} ecs_index_iter_t;
+
 /** Snapshot-iterator specific data */
 typedef struct ecs_snapshot_iter_t {
     ecs_filter_t filter;
@@ -194,6 +232,15 @@ typedef struct ecs_rule_iter_t {
     bool redo;
     int32_t op;
     int32_t sp;
+
+    int32_t cached_result;               /* Next result to replay from cache */
+    struct ecs_rule_cache_results_t *cached; /* Results replayed by iterator */
+    bool fill_cache;                     /* Is iterator populating the cache */
+
+    int32_t worker_index;                /* Index of worker (partitioned iter) */
+    int32_t worker_count;                /* Number of workers (0 if not set) */
+    int32_t worker_op;                   /* Select op that partitions tables */
+    int32_t worker_yield;                /* Yield count, if there is no select */
 } ecs_rule_iter_t;
 
 /* Bits for tracking whether a cache was used/whether the array was allocated.
@@ -223,6 +270,7 @@ typedef struct ecs_iter_private_t {
         ecs_filter_iter_t filter;
         ecs_query_iter_t query;
         ecs_rule_iter_t rule;
+        ecs_index_iter_t index;
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
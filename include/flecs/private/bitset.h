@@ -74,6 +74,11 @@ void flecs_bitset_swap(
     int32_t elem_a,
     int32_t elem_b);
 
+/** Return index of lowest set bit. Value must not be 0. */
+FLECS_DBG_API
+int32_t flecs_ctz64(
+    uint64_t value);
+
 #ifdef __cplusplus
 }
 #endif
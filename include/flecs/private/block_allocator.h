@@ -9,6 +9,14 @@
 
 #include "api_defines.h"
 
+/* Chunks are aligned to the largest power of two that divides the chunk size,
+ * up to this value. This guarantees that an array of elements with a size that
+ * is a multiple of its alignment (like a component column) starts at an 
+ * address that is aligned for the element type. */
+#ifndef FLECS_BALLOC_ALIGN
+#define FLECS_BALLOC_ALIGN (64)
+#endif
+
 typedef struct ecs_block_allocator_block_t {
     void *memory;
     struct ecs_block_allocator_block_t *next;
@@ -51,6 +59,10 @@ FLECS_API
 void flecs_ballocator_free(
     ecs_block_allocator_t *ba);
 
+FLECS_API
+int64_t flecs_ballocator_trim(
+    ecs_block_allocator_t *ba);
+
 FLECS_API
 void* flecs_balloc(
     ecs_block_allocator_t *allocator);
@@ -6,14 +6,19 @@
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
+ * The map uses open addressing. Keys and payloads are stored inline in a
+ * single flat array of slots, so a lookup doesn't have to chase pointers. Each
+ * slot has a control byte that is either empty, deleted or stores 7 bits of the
+ * key hash. Lookups test a group of 8 control bytes at a time with bit tricks on
+ * a 64-bit word (SWAR), which filters out almost all non-matching slots before
+ * their keys are compared. Removed slots are marked as deleted, which means
+ * that removing elements while iterating a map is safe.
  *
- * The datastructure will automatically grow the number of buckets when the
- * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * The number of slots is always a power of 2. The datastructure automatically 
+ * grows the number of slots when the ratio between elements and slots exceeds
+ * a certain threshold (LOAD_FACTOR). Note that payload pointers are only stable
+ * until the map is rehashed. Don't hold on to payload pointers across 
+ * operations that insert elements.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -36,38 +41,26 @@ extern "C" {
 typedef uint64_t ecs_map_key_t;
 
 /* Map type */
-typedef struct ecs_bucket_entry_t {
-    struct ecs_bucket_entry_t *next;
-    ecs_map_key_t key;
-    /* payload right after key. */
-} ecs_bucket_entry_t;
-
-typedef struct ecs_bucket_t {
-    ecs_bucket_entry_t *first;
-} ecs_bucket_t;
-
 typedef struct ecs_map_t {
-    ecs_bucket_t *buckets;
-    ecs_bucket_t *buckets_end;
-    int16_t elem_size;
-    uint8_t bucket_shift;
-    bool shared_allocator;
-    int32_t bucket_count;
-    int32_t count;
+    uint8_t *ctrl;            /* Control byte per slot (+ 1 cloned group) */
+    void *slots;              /* Key + payload per slot */
+    int16_t elem_size;        /* Size of payload */
+    int16_t slot_size;        /* Size of key + aligned payload */
+    uint8_t bucket_shift;     /* Shift used to compute slot from key hash */
+    int32_t bucket_count;     /* Number of slots */
+    int32_t count;            /* Number of elements */
+    int32_t deleted;          /* Number of deleted slots */
     struct ecs_allocator_t *allocator;
-    struct ecs_block_allocator_t *entry_allocator;
 } ecs_map_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    ecs_bucket_t *bucket;
-    ecs_bucket_entry_t *entry;
+    int32_t index;
 } ecs_map_iter_t;
 
 typedef struct ecs_map_params_t {
     ecs_size_t size;
     struct ecs_allocator_t *allocator;
-    struct ecs_block_allocator_t entry_allocator;
     int32_t initial_count;
 } ecs_map_params_t;
 
@@ -219,7 +212,7 @@ FLECS_API
 int32_t ecs_map_count(
     const ecs_map_t *map);
 
-/** Return number of buckets in map. */
+/** Return number of slots in map. */
 FLECS_API
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map);
@@ -248,13 +241,13 @@ void* _ecs_map_next_ptr(
 #define ecs_map_next_ptr(iter, T, key) \
     (T)_ecs_map_next_ptr(iter, key)
 
-/** Grow number of buckets in the map for specified number of elements. */
+/** Grow number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_grow(
     ecs_map_t *map,
     int32_t elem_count);
 
-/** Set number of buckets in the map for specified number of elements. */
+/** Set number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_set_size(
     ecs_map_t *map,
@@ -98,6 +98,11 @@ FLECS_DBG_API
 void flecs_sparse_clear(
     ecs_sparse_t *sparse);
 
+/** Free memory that is not used by the sparse set */
+FLECS_DBG_API
+void flecs_sparse_shrink(
+    ecs_sparse_t *sparse);
+
 /** Set id source. This allows the sparse set to use an external variable for
  * issuing and increasing new ids. */
 FLECS_DBG_API
@@ -1,25 +1,21 @@
 /**
  * @file switch_list.h
- * @brief Interleaved linked list for storing mutually exclusive values.
+ * @brief Datastructure for storing mutually exclusive values.
  *
- * Datastructure that stores N interleaved linked lists in an array. 
- * This allows for efficient storage of elements with mutually exclusive values.
- * Each linked list has a header element which points to the index in the array
- * that stores the first node of the list. Each list node points to the next
- * array element.
+ * Datastructure that stores for each element a value, and for each value a
+ * dense array with the elements that have the value. This allows for efficient
+ * storage of elements with mutually exclusive values.
  *
- * The datastructure needs to be created with min and max values, so that it can
- * allocate an array of headers that can be directly indexed by the value. The
- * values are stored in a contiguous array, which allows for the values to be
- * iterated without having to follow the linked list nodes.
+ * Each element stores its index in the dense array of its value, so that the
+ * value of an element can be changed in constant time by swapping the element
+ * with the last element in the dense array. The values are stored in a
+ * contiguous array, which allows for the values to be iterated without having
+ * to go through the dense arrays.
  *
  * The datastructure allows for efficient storage and retrieval for values with
- * mutually exclusive values, such as enumeration values. The linked list allows
- * an application to obtain all elements for a given (enumeration) value without
- * having to search.
- *
- * While the list accepts 64 bit values, it only uses the lower 32bits of the
- * value for selecting the correct linked list.
+ * mutually exclusive values, such as enumeration values. The dense arrays allow
+ * an application to obtain all elements for a given (enumeration) value with a
+ * contiguous scan.
  */
 
 #ifndef FLECS_SWITCH_LIST_H
@@ -28,13 +24,11 @@
 #include "flecs/private/api_defines.h"
 
 typedef struct ecs_switch_header_t {
-    int32_t element;        /* First element for value */
-    int32_t count;          /* Number of elements for value */
+    ecs_vec_t elements;     /* vec<int32_t>, elements with value */
 } ecs_switch_header_t;
 
 typedef struct ecs_switch_node_t {
-    int32_t next;           /* Next node in list */
-    int32_t prev;           /* Prev node in list */
+    int32_t index;          /* Index of element in elements of its value */
 } ecs_switch_node_t;
 
 struct ecs_switch_t {    
@@ -137,6 +131,13 @@ int32_t flecs_switch_next(
     const ecs_switch_t *sw,
     int32_t elem);
 
+/** Return elements for value. Elements that were assigned to the value last
+ * are stored last. Use together with case_count(). */
+FLECS_DBG_API
+const int32_t* flecs_switch_elements(
+    const ecs_switch_t *sw,
+    uint64_t value);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
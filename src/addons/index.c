@@ -0,0 +1,447 @@
+/**
+ * @file addons/index.c
+ * @brief Secondary index addon.
+ */
+
+#include "../private_api.h"
+
+#ifdef FLECS_INDEX
+
+/* Location of an entity in the index */
+typedef struct ecs_index_elem_t {
+    uint64_t key;           /* Indexed value */
+    int32_t index;          /* Position in entity array of value */
+} ecs_index_elem_t;
+
+typedef struct ecs_index_t {
+    ecs_world_t *world;
+    ecs_entity_t component;
+    ecs_size_t size;        /* Size of component */
+    ecs_size_t offset;      /* Offset of member in component */
+    ecs_meta_type_op_kind_t kind;
+    ecs_term_t term;        /* Term for index iterator */
+    ecs_map_t values;       /* map<key, vec<ecs_entity_t>> */
+    ecs_map_t entities;     /* map<ecs_entity_t, ecs_index_elem_t> */
+} ecs_index_t;
+
+static
+bool flecs_index_kind_supported(
+    ecs_meta_type_op_kind_t kind)
+{
+    switch(kind) {
+    case EcsOpBool:
+    case EcsOpChar:
+    case EcsOpByte:
+    case EcsOpU8:
+    case EcsOpU16:
+    case EcsOpU32:
+    case EcsOpU64:
+    case EcsOpI8:
+    case EcsOpI16:
+    case EcsOpI32:
+    case EcsOpI64:
+    case EcsOpUPtr:
+    case EcsOpIPtr:
+    case EcsOpEntity:
+    case EcsOpEnum:
+    case EcsOpBitmask:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Convert value to key. Signed values are sign extended, so that the key is
+ * the same regardless of the width of the member type. */
+static
+uint64_t flecs_index_key(
+    ecs_meta_type_op_kind_t kind,
+    const void *ptr)
+{
+    switch(kind) {
+    case EcsOpBool: return *(const ecs_bool_t*)ptr;
+    case EcsOpChar: return (uint64_t)(int64_t)*(const ecs_char_t*)ptr;
+    case EcsOpByte: return *(const ecs_byte_t*)ptr;
+    case EcsOpU8: return *(const ecs_u8_t*)ptr;
+    case EcsOpU16: return *(const ecs_u16_t*)ptr;
+    case EcsOpU32: return *(const ecs_u32_t*)ptr;
+    case EcsOpBitmask: return *(const ecs_u32_t*)ptr;
+    case EcsOpU64: return *(const ecs_u64_t*)ptr;
+    case EcsOpUPtr: return *(const ecs_uptr_t*)ptr;
+    case EcsOpEntity: return *(const ecs_entity_t*)ptr;
+    case EcsOpI8: return (uint64_t)(int64_t)*(const ecs_i8_t*)ptr;
+    case EcsOpI16: return (uint64_t)(int64_t)*(const ecs_i16_t*)ptr;
+    case EcsOpI32: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr;
+    case EcsOpEnum: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr;
+    case EcsOpI64: return (uint64_t)(int64_t)*(const ecs_i64_t*)ptr;
+    case EcsOpIPtr: return (uint64_t)(int64_t)*(const ecs_iptr_t*)ptr;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Find serializer op for (nested) member of component */
+static
+const ecs_meta_type_op_t* flecs_index_find_member(
+    const ecs_world_t *world,
+    ecs_entity_t component,
+    const char *member)
+{
+    const EcsMetaTypeSerialized *ser = ecs_get(
+        world, component, EcsMetaTypeSerialized);
+    if (!ser) {
+        char *path = ecs_get_fullpath(world, component);
+        ecs_err("cannot index '%s': component has no reflection data", path);
+        ecs_os_free(path);
+        return NULL;
+    }
+
+    const ecs_meta_type_op_t *op = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    ecs_assert(op != NULL, ECS_INTERNAL_ERROR, NULL);
+    if (!member) {
+        return op;
+    }
+
+    const char *ptr = member;
+    char token[ECS_MAX_TOKEN_SIZE];
+    while (ptr[0]) {
+        const char *sep = strchr(ptr, '.');
+        ecs_size_t len = sep ? flecs_ito(ecs_size_t, sep - ptr) :
+            ecs_os_strlen(ptr);
+        if (len >= ECS_MAX_TOKEN_SIZE) {
+            ecs_err("member name '%s' is too long", member);
+            return NULL;
+        }
+
+        ecs_os_memcpy(token, ptr, len);
+        token[len] = '\0';
+
+        const uint64_t *cur = NULL;
+        if (op->kind == EcsOpPush && op->members) {
+            cur = flecs_name_index_find_ptr(op->members, token, 0, 0);
+        }
+        if (!cur) {
+            char *path = ecs_get_fullpath(world, component);
+            ecs_err("unknown member '%s' for component '%s'", member, path);
+            ecs_os_free(path);
+            return NULL;
+        }
+
+        /* Member indices are relative to the first op after the push op */
+        op = &op[1 + flecs_uto(int32_t, cur[0])];
+
+        ptr += len;
+        if (ptr[0] == '.') {
+            ptr ++;
+        }
+    }
+
+    return op;
+}
+
+static
+void flecs_index_remove(
+    ecs_index_t *index,
+    ecs_entity_t e)
+{
+    ecs_index_elem_t *elem = ecs_map_get(
+        &index->entities, ecs_index_elem_t, e);
+    if (!elem) {
+        return;
+    }
+
+    uint64_t key = elem->key;
+    int32_t elem_index = elem->index;
+    ecs_map_remove(&index->entities, e);
+
+    ecs_vec_t *v = ecs_map_get(&index->values, ecs_vec_t, key);
+    ecs_assert(v != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Entity is moved to removed position, update its element */
+    int32_t last = ecs_vec_count(v) - 1;
+    if (elem_index != last) {
+        ecs_entity_t moved = ecs_vec_get_t(v, ecs_entity_t, last)[0];
+        ecs_index_elem_t *moved_elem = ecs_map_get(
+            &index->entities, ecs_index_elem_t, moved);
+        ecs_assert(moved_elem != NULL, ECS_INTERNAL_ERROR, NULL);
+        moved_elem->index = elem_index;
+    }
+
+    ecs_vec_remove_t(v, ecs_entity_t, elem_index);
+    if (!ecs_vec_count(v)) {
+        ecs_vec_fini_t(&index->world->allocator, v, ecs_entity_t);
+        ecs_map_remove(&index->values, key);
+    }
+}
+
+static
+void flecs_index_set(
+    ecs_index_t *index,
+    ecs_entity_t e,
+    const void *ptr)
+{
+    uint64_t key = flecs_index_key(index->kind,
+        ECS_OFFSET(ptr, index->offset));
+
+    ecs_index_elem_t *elem = ecs_map_get(
+        &index->entities, ecs_index_elem_t, e);
+    if (elem) {
+        if (elem->key == key) {
+            return;
+        }
+        flecs_index_remove(index, e);
+    }
+
+    ecs_allocator_t *a = &index->world->allocator;
+    ecs_vec_t *v = ecs_map_ensure(&index->values, ecs_vec_t, key);
+    int32_t count = ecs_vec_count(v);
+    if (!count) {
+        /* Values without entities are removed, so this is a new value */
+        ecs_vec_init_t(a, v, ecs_entity_t, 0);
+    }
+    ecs_vec_append_t(a, v, ecs_entity_t)[0] = e;
+
+    elem = ecs_map_ensure(&index->entities, ecs_index_elem_t, e);
+    elem->key = key;
+    elem->index = count;
+}
+
+static
+void flecs_index_observer(
+    ecs_iter_t *it)
+{
+    ecs_index_t *index = it->ctx;
+    int32_t i, count = it->count;
+
+    if (it->event == EcsOnSet) {
+        void *ptr = ecs_field_w_size(it, flecs_itosize(index->size), 1);
+        for (i = 0; i < count; i ++) {
+            flecs_index_set(index, it->entities[i],
+                ECS_ELEM(ptr, index->size, i));
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            flecs_index_remove(index, it->entities[i]);
+        }
+    }
+}
+
+static
+void flecs_index_free(
+    void *ptr)
+{
+    ecs_index_t *index = ptr;
+    ecs_allocator_t *a = &index->world->allocator;
+
+    ecs_map_iter_t mit = ecs_map_iter(&index->values);
+    ecs_vec_t *v;
+    while ((v = ecs_map_next(&mit, ecs_vec_t, NULL))) {
+        ecs_vec_fini_t(a, v, ecs_entity_t);
+    }
+
+    ecs_map_fini(&index->values);
+    ecs_map_fini(&index->entities);
+    ecs_os_free(index);
+}
+
+static
+const ecs_index_t* flecs_index_get(
+    const ecs_world_t *world,
+    ecs_entity_t index)
+{
+    world = ecs_get_world(world);
+    const EcsPoly *o = ecs_poly_bind_get(world, index, ecs_observer_t);
+    ecs_check(o != NULL, ECS_INVALID_PARAMETER, "entity is not an index");
+
+    const ecs_observer_t *observer = o->poly;
+    ecs_check(observer->callback == flecs_index_observer, 
+        ECS_INVALID_PARAMETER, "entity is not an index");
+    return observer->ctx;
+error:
+    return NULL;
+}
+
+ecs_entity_t ecs_index_init(
+    ecs_world_t *world,
+    const ecs_index_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->_canary == 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->component != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_entity_t component = desc->component;
+    const ecs_type_info_t *ti = ecs_get_type_info(world, component);
+    if (!ti) {
+        char *path = ecs_get_fullpath(world, component);
+        ecs_err("cannot index '%s': not a component", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    const ecs_meta_type_op_t *op = flecs_index_find_member(
+        world, component, desc->member);
+    if (!op) {
+        return 0;
+    }
+
+    if (!flecs_index_kind_supported(op->kind) || op->count > 1) {
+        char *path = ecs_get_fullpath(world, op->type);
+        ecs_err("cannot index member of type '%s'", path);
+        ecs_os_free(path);
+        return 0;
+    }
+
+    ecs_index_t *index = ecs_os_calloc_t(ecs_index_t);
+    index->world = world;
+    index->component = component;
+    index->size = ti->size;
+    index->offset = op->offset;
+    index->kind = op->kind;
+    index->term.id = component;
+    index->term.inout = EcsIn;
+    index->term.field_index = 0;
+    ecs_map_init(&index->values, ecs_vec_t, &world->allocator, 0);
+    ecs_map_init(&index->entities, ecs_index_elem_t, &world->allocator, 0);
+
+    ecs_entity_t result = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .entity = desc->entity,
+        .filter.terms = {{ .id = component, .src.flags = EcsSelf }},
+        .events = { EcsOnSet, EcsOnRemove },
+        .callback = flecs_index_observer,
+        .ctx = index,
+        .ctx_free = flecs_index_free
+    });
+    if (!result) {
+        flecs_index_free(index);
+        return 0;
+    }
+
+    /* Add entities that already have the component */
+    ecs_filter_t f = ECS_FILTER_INIT;
+    ecs_filter_t *filter = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ .id = component, .src.flags = EcsSelf, .inout = EcsIn }}
+    });
+    ecs_assert(filter != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, filter);
+    while (ecs_filter_next(&it)) {
+        void *ptr = ecs_field_w_size(&it, flecs_itosize(index->size), 1);
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            flecs_index_set(index, it.entities[i],
+                ECS_ELEM(ptr, index->size, i));
+        }
+    }
+    ecs_filter_fini(filter);
+
+    return result;
+error:
+    return 0;
+}
+
+const ecs_entity_t* ecs_index_lookup(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value,
+    int32_t *count_out)
+{
+    ecs_check(value != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count_out != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const ecs_index_t *impl = flecs_index_get(world, index);
+    ecs_check(impl != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    uint64_t key = flecs_index_key(impl->kind, value);
+    ecs_vec_t *v = ecs_map_get(&impl->values, ecs_vec_t, key);
+    if (!v) {
+        *count_out = 0;
+        return NULL;
+    }
+
+    *count_out = ecs_vec_count(v);
+    return ecs_vec_first_t(v, ecs_entity_t);
+error:
+    return NULL;
+}
+
+ecs_iter_t ecs_index_iter(
+    const ecs_world_t *world,
+    ecs_entity_t index,
+    const void *value)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    const ecs_world_t *real_world = ecs_get_world(world);
+    const ecs_index_t *impl = flecs_index_get(real_world, index);
+    ecs_check(impl != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t count;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        real_world, index, value, &count);
+
+    ecs_iter_t it = {
+        .real_world = (ecs_world_t*)real_world,
+        .world = (ecs_world_t*)world,
+        .terms = (ecs_term_t*)&impl->term,
+        .field_count = 1,
+        .flags = EcsIterRowRange,
+        .next = ecs_index_next,
+        .priv.iter.index = {
+            .entities = entities,
+            .count = count
+        }
+    };
+
+    flecs_iter_init(world, &it, flecs_iter_cache_all);
+
+    it.ids[0] = impl->component;
+    it.columns[0] = 1;
+    it.sizes[0] = impl->size;
+
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool ecs_index_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_index_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_index_iter_t *iter = &it->priv.iter.index;
+    if (iter->index >= iter->count) {
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    ecs_world_t *world = it->real_world;
+    ecs_entity_t e = iter->entities[iter->index ++];
+    ecs_record_t *r = flecs_entities_get(world, e);
+    ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *table = r->table;
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    it->table = table;
+    it->offset = row;
+    it->count = 1;
+    it->entities = ecs_vec_get_t(&table->data.entities, ecs_entity_t, row);
+
+    const ecs_table_record_t *tr = flecs_table_record_get(
+        world, table->storage_table, it->ids[0]);
+    ecs_assert(tr != NULL, ECS_INTERNAL_ERROR, NULL);
+    it->ptrs[0] = ecs_vec_get(
+        &table->data.columns[tr->column], it->sizes[0], row);
+
+    flecs_iter_validate(it);
+    return true;
+error:
+    return false;
+}
+
+#endif
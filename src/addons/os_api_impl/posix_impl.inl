@@ -89,6 +89,18 @@ int64_t posix_ladec(
 #endif
 }
 
+static
+int32_t posix_aload(
+    const int32_t *value) 
+{
+#ifdef __GNUC__
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    /* Unsupported */
+    abort();
+#endif
+}
+
 static
 ecs_os_mutex_t posix_mutex_new(void) {
     pthread_mutex_t *mutex = ecs_os_malloc(sizeof(pthread_mutex_t));
@@ -267,6 +279,7 @@ void ecs_set_os_api_impl(void) {
     api.adec_ = posix_adec;
     api.lainc_ = posix_lainc;
     api.ladec_ = posix_ladec;
+    api.aload_ = posix_aload;
     api.mutex_new_ = posix_mutex_new;
     api.mutex_free_ = posix_mutex_free;
     api.mutex_lock_ = posix_mutex_lock;
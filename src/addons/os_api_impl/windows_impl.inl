@@ -56,6 +56,15 @@ int64_t win_ladec(
     return InterlockedDecrement64(count);
 }
 
+static
+int32_t win_aload(
+    const int32_t *value) 
+{
+    /* Compare exchange with equal values doesn't modify the value, and acts
+     * as a full barrier */
+    return InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
 static
 ecs_os_mutex_t win_mutex_new(void) {
     CRITICAL_SECTION *mutex = ecs_os_malloc_t(CRITICAL_SECTION);
@@ -239,6 +248,7 @@ void ecs_set_os_api_impl(void) {
     api.adec_ = win_adec;
     api.lainc_ = win_lainc;
     api.ladec_ = win_ladec;
+    api.aload_ = win_aload;
     api.mutex_new_ = win_mutex_new;
     api.mutex_free_ = win_mutex_free;
     api.mutex_lock_ = win_mutex_lock;
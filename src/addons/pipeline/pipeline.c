@@ -5,8 +5,15 @@
 #include "pipeline.h"
 
 static ECS_DTOR(EcsPipeline, ptr, {
+    int32_t s;
+    for (s = 0; s < ptr->state->iter_count; s ++) {
+        ecs_vector_free(ptr->state->stages[s].cmd_cuts);
+    }
     ecs_vector_free(ptr->state->ops);
+    ecs_vector_free(ptr->state->groups);
+    ecs_vector_free(ptr->state->merge_order);
     ecs_os_free(ptr->state->iters);
+    ecs_os_free(ptr->state->stages);
 })
 
 typedef enum ecs_write_kind_t {
@@ -211,6 +218,193 @@ bool flecs_pipeline_check_terms(
     return needs_merge;
 }
 
+/* Get whether term accesses component data, and if so, whether it writes */
+static
+bool flecs_pipeline_term_access(
+    ecs_term_t *term,
+    bool *write_out)
+{
+    if (term->oper == EcsNot) {
+        return false;
+    }
+
+    bool from_any = ecs_term_match_0(term);
+    bool from_this = ecs_term_match_this(term);
+    bool is_shared = !from_any && 
+        (!from_this || !(term->src.flags & EcsSelf));
+
+    ecs_inout_kind_t inout = term->inout;
+    if (inout == EcsInOutDefault) {
+        if (from_any) {
+            return false;
+        } else if (is_shared) {
+            inout = EcsIn;
+        } else {
+            inout = EcsInOut;
+        }
+    }
+
+    if (inout == EcsInOutNone) {
+        return false;
+    }
+
+    /* Writes to terms without a source are deferred, and don't modify the 
+     * storage while systems are running */
+    *write_out = !from_any && (inout == EcsOut || inout == EcsInOut);
+
+    return true;
+}
+
+/* Test if two systems access the same component, with at least one write */
+static
+bool flecs_pipeline_systems_conflict(
+    ecs_system_t *sys_a,
+    ecs_system_t *sys_b)
+{
+    ecs_filter_t *filter_a = &sys_a->query->filter;
+    ecs_filter_t *filter_b = &sys_b->query->filter;
+    int32_t a, b;
+
+    for (a = 0; a < filter_a->term_count; a ++) {
+        ecs_term_t *term_a = &filter_a->terms[a];
+        bool write_a;
+        if (!flecs_pipeline_term_access(term_a, &write_a)) {
+            continue;
+        }
+
+        for (b = 0; b < filter_b->term_count; b ++) {
+            ecs_term_t *term_b = &filter_b->terms[b];
+            bool write_b;
+            if (!flecs_pipeline_term_access(term_b, &write_b)) {
+                continue;
+            }
+
+            if (!write_a && !write_b) {
+                continue;
+            }
+
+            if (ecs_id_match(term_a->id, term_b->id) || 
+                ecs_id_match(term_b->id, term_a->id)) 
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Scheduling data for active system while building the pipeline */
+typedef struct ecs_pipeline_sched_t {
+    ecs_system_t *system;
+    int32_t parent;             /* Parent in set of conflicting systems */
+    bool pinned;                /* Must run on main thread */
+} ecs_pipeline_sched_t;
+
+static
+int32_t flecs_pipeline_sched_root(
+    ecs_pipeline_sched_t *sched,
+    int32_t index)
+{
+    while (sched[index].parent != index) {
+        index = sched[index].parent = sched[sched[index].parent].parent;
+    }
+    return index;
+}
+
+static
+void flecs_pipeline_sched_union(
+    ecs_pipeline_sched_t *sched,
+    int32_t a,
+    int32_t b)
+{
+    a = flecs_pipeline_sched_root(sched, a);
+    b = flecs_pipeline_sched_root(sched, b);
+    if (a > b) {
+        int32_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    /* Root is always the first system of the set. A set is pinned if any of
+     * its systems is pinned. */
+    if (a != b) {
+        sched[b].parent = a;
+        sched[a].pinned |= sched[b].pinned;
+    }
+}
+
+/* Add active system to schedule. Systems in the same op that access the same
+ * components are added to the same set, so they run in order on one worker. */
+static
+void flecs_pipeline_sched_add(
+    ecs_vector_t **sched_vec,
+    ecs_pipeline_op_t *op,
+    ecs_system_t *sys)
+{
+    ecs_pipeline_sched_t *elem = ecs_vector_add(
+        sched_vec, ecs_pipeline_sched_t);
+    int32_t i, index = ecs_vector_count(*sched_vec) - 1;
+    elem->system = sys;
+    elem->parent = index;
+    elem->pinned = !sys->concurrent || op->no_readonly;
+
+    if (op->multi_threaded) {
+        return;
+    }
+
+    ecs_pipeline_sched_t *sched = ecs_vector_first(
+        *sched_vec, ecs_pipeline_sched_t);
+    elem = &sched[index];
+
+    for (i = op->offset; i < index; i ++) {
+        if (flecs_pipeline_systems_conflict(sched[i].system, sys)) {
+            flecs_pipeline_sched_union(sched, i, index);
+        }
+    }
+}
+
+/* Assign group to each system. Systems in group 0 run on the main thread, 
+ * other groups are distributed across workers. */
+static
+ecs_vector_t* flecs_pipeline_sched_groups(
+    ecs_vector_t *sched_vec,
+    ecs_vector_t *ops)
+{
+    ecs_vector_t *result = NULL;
+    ecs_pipeline_sched_t *sched = ecs_vector_first(
+        sched_vec, ecs_pipeline_sched_t);
+    int32_t i, count = ecs_vector_count(sched_vec);
+    if (!count) {
+        return NULL;
+    }
+
+    ecs_vector_set_count(&result, int32_t, count);
+    int32_t *groups = ecs_vector_first(result, int32_t);
+
+    ecs_pipeline_op_t *op = ecs_vector_first(ops, ecs_pipeline_op_t);
+    int32_t o, op_count = ecs_vector_count(ops);
+    for (o = 0; o < op_count; o ++) {
+        int32_t first = op[o].offset, last = first + op[o].count;
+        int32_t group_count = 1;
+
+        for (i = first; i < last; i ++) {
+            int32_t root = flecs_pipeline_sched_root(sched, i);
+            if (op[o].multi_threaded) {
+                groups[i] = 0;
+            } else if (root != i) {
+                groups[i] = groups[root];
+            } else if (sched[i].pinned) {
+                groups[i] = 0;
+            } else {
+                groups[i] = group_count ++;
+            }
+        }
+    }
+
+    return result;
+}
+
 static
 bool flecs_pipeline_is_inactive(
     const ecs_pipeline_state_t *pq,
@@ -255,11 +449,15 @@ bool flecs_pipeline_build(
 
     ecs_pipeline_op_t *op = NULL;
     ecs_vector_t *ops = NULL;
+    ecs_vector_t *sched = NULL;
     ecs_query_t *query = pq->query;
 
     if (pq->ops) {
         ecs_vector_free(pq->ops);
     }
+    if (pq->groups) {
+        ecs_vector_free(pq->groups);
+    }
 
     bool multi_threaded = false;
     bool no_readonly = false;
@@ -333,6 +531,7 @@ bool flecs_pipeline_build(
 
             if (!op) {
                 op = ecs_vector_add(&ops, ecs_pipeline_op_t);
+                op->offset = ecs_vector_count(sched);
                 op->count = 0;
                 op->multi_threaded = false;
                 op->no_readonly = false;
@@ -345,6 +544,7 @@ bool flecs_pipeline_build(
                     op->multi_threaded = multi_threaded;
                     op->no_readonly = no_readonly;
                 }
+                flecs_pipeline_sched_add(&sched, op, sys);
                 op->count ++;
             }
         }
@@ -353,6 +553,9 @@ bool flecs_pipeline_build(
     ecs_map_free(ws.ids);
     ecs_map_free(ws.wildcard_ids);
 
+    pq->groups = flecs_pipeline_sched_groups(sched, ops);
+    ecs_vector_free(sched);
+
     /* Find the system ran last this frame (helps workers reset iter) */
     ecs_entity_t last_system = 0;
     op = ecs_vector_first(ops, ecs_pipeline_op_t);
@@ -372,6 +575,8 @@ bool flecs_pipeline_build(
             op->multi_threaded, !op->no_readonly);
         ecs_log_push_1();
 
+        int32_t *groups = ecs_vector_first(pq->groups, int32_t);
+
         it = ecs_query_iter(world, pq->query);
         while (ecs_query_next(&it)) {
             if (flecs_pipeline_is_inactive(pq, it.table)) {
@@ -384,7 +589,14 @@ bool flecs_pipeline_build(
                 ecs_system_t *sys = ecs_poly(poly[i].poly, ecs_system_t);
                 if (ecs_should_log_1()) {
                     char *path = ecs_get_fullpath(world, it.entities[i]);
-                    ecs_dbg("#[green]system#[reset] %s", path);
+                    int32_t group = groups[
+                        op[op_index].offset + ran_since_merge];
+                    if (group) {
+                        ecs_dbg("#[green]system#[reset] %s (group %d)", 
+                            path, group);
+                    } else {
+                        ecs_dbg("#[green]system#[reset] %s", path);
+                    }
                     ecs_os_free(path);
                 }
 
@@ -547,6 +759,20 @@ void ecs_run_pipeline(
     flecs_run_pipeline(world, pq->state, delta_time);
 }
 
+static
+void flecs_pipeline_add_time(
+    ecs_world_t *world,
+    ecs_pipeline_stage_t *ps,
+    ecs_time_t *st)
+{
+    ecs_ftime_t t = (ecs_ftime_t)ecs_time_measure(st);
+    if (ps) {
+        ps->system_time += t;
+    } else {
+        world->info.system_time_total += t;
+    }
+}
+
 void flecs_run_pipeline(
     ecs_world_t *world,
     ecs_pipeline_state_t *pq,
@@ -585,9 +811,17 @@ void flecs_run_pipeline(
 
     flecs_worker_begin(stage->thread_ctx);
 
+    /* Workers measure their own system time, which the main thread collects
+     * when it merges. Commands are cut after each system, so that the main
+     * thread can merge them in pipeline order. */
+    ecs_pipeline_stage_t *ps = NULL;
+    if (stage_count > 1) {
+        ps = &pq->stages[stage_index];
+    }
+
     ecs_time_t st = {0};
     bool measure_time = false;
-    if (!stage_index && (world->flags & EcsWorldMeasureSystemTime)) {
+    if (world->flags & EcsWorldMeasureSystemTime) {
         ecs_time_measure(&st);
         measure_time = true;
     }
@@ -608,7 +842,16 @@ void flecs_run_pipeline(
 
             sys->last_frame = world->info.frame_count_total + 1;
 
-            if (!stage_index || op->multi_threaded) {
+            /* Single threaded systems run on the worker assigned to their 
+             * group. Group 0 always runs on the main thread. */
+            bool run_system = op->multi_threaded;
+            if (!run_system) {
+                int32_t *groups = ecs_vector_first(pq->groups, int32_t);
+                int32_t group = groups[op->offset + ran_since_merge];
+                run_system = (group % stage_count) == stage_index;
+            }
+
+            if (run_system) {
                 ecs_stage_t *s = NULL;
                 if (!op->no_readonly) {
                     s = stage;
@@ -616,6 +859,13 @@ void flecs_run_pipeline(
 
                 ecs_run_intern(world, s, e, sys, stage_index, 
                     stage_count, delta_time, 0, 0, NULL);
+
+                if (ps && s) {
+                    ecs_pipeline_cmd_cut_t *cut = ecs_vector_add(
+                        &ps->cmd_cuts, ecs_pipeline_cmd_cut_t);
+                    cut->system = ran_since_merge;
+                    cut->end = flecs_stage_cmd_cut(s);
+                }
             }
 
             ran_since_merge ++;
@@ -629,8 +879,7 @@ void flecs_run_pipeline(
 
                 if (measure_time) {
                     /* Don't include merge time in system time */
-                    world->info.system_time_total += 
-                        (ecs_ftime_t)ecs_time_measure(&st);
+                    flecs_pipeline_add_time(world, ps, &st);
                 }
 
                 ran_since_merge = 0;
@@ -661,12 +910,117 @@ void flecs_run_pipeline(
 
 done:
     if (measure_time) {
-        world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
+        flecs_pipeline_add_time(world, ps, &st);
     }
 
     flecs_worker_end(stage->thread_ctx);
 }
 
+void flecs_pipeline_merge_order(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq)
+{
+    int32_t s, stage_count = pq->iter_count;
+    ecs_pipeline_stage_t *stages = pq->stages;
+
+    ecs_vector_clear(pq->merge_order);
+
+    /* Stages that don't auto merge are merged by the application */
+    bool ordered = true;
+    for (s = 0; s < stage_count; s ++) {
+        if (!world->stages[s].auto_merge) {
+            ordered = false;
+        }
+    }
+
+    int32_t *cur = flecs_walloc_n(world, int32_t, stage_count);
+    int32_t *end = flecs_walloc_n(world, int32_t, stage_count);
+    for (s = 0; s < stage_count; s ++) {
+        cur[s] = 0;
+        end[s] = 0;
+    }
+
+    /* Each worker ran its systems in pipeline order, so the cuts of a stage
+     * are sorted by system. Take the commands of the earliest system from all
+     * stages until all cuts are processed. If a multi threaded system ran on
+     * multiple stages, its commands are merged in stage order. */
+    while (ordered) {
+        int32_t stage = -1, system = 0;
+        for (s = 0; s < stage_count; s ++) {
+            ecs_vector_t *cuts = stages[s].cmd_cuts;
+            if (cur[s] == ecs_vector_count(cuts)) {
+                continue;
+            }
+
+            ecs_pipeline_cmd_cut_t *cut = ecs_vector_get(
+                cuts, ecs_pipeline_cmd_cut_t, cur[s]);
+            if (stage == -1 || cut->system < system) {
+                stage = s;
+                system = cut->system;
+            }
+        }
+
+        if (stage == -1) {
+            break;
+        }
+
+        ecs_pipeline_cmd_cut_t *cut = ecs_vector_get(
+            stages[stage].cmd_cuts, ecs_pipeline_cmd_cut_t, cur[stage]);
+        if (cut->end != end[stage]) {
+            ecs_cmd_range_t *range = ecs_vector_add(
+                &pq->merge_order, ecs_cmd_range_t);
+            range->stage = stage;
+            range->first = end[stage];
+            range->count = cut->end - end[stage];
+            end[stage] = cut->end;
+        }
+
+        cur[stage] ++;
+    }
+
+    /* Commands that weren't added by a system are merged last */
+    for (s = 0; s < stage_count; s ++) {
+        int32_t count = ecs_vec_count(&world->stages[s].commands);
+        if (ordered && (count != end[s])) {
+            ecs_cmd_range_t *range = ecs_vector_add(
+                &pq->merge_order, ecs_cmd_range_t);
+            range->stage = s;
+            range->first = end[s];
+            range->count = count - end[s];
+        }
+
+        ecs_vector_clear(stages[s].cmd_cuts);
+    }
+
+    flecs_wfree_n(world, int32_t, stage_count, end);
+    flecs_wfree_n(world, int32_t, stage_count, cur);
+
+    if (ordered) {
+        world->merge_order = ecs_vector_first(
+            pq->merge_order, ecs_cmd_range_t);
+        world->merge_order_count = ecs_vector_count(pq->merge_order);
+    }
+}
+
+void flecs_pipeline_system_time(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq)
+{
+    /* Workers run systems at the same time, so the time spent in the systems
+     * of an op is the time of the worker that took the longest. */
+    ecs_ftime_t max = 0;
+    int32_t s, stage_count = pq->iter_count;
+    for (s = 0; s < stage_count; s ++) {
+        ecs_pipeline_stage_t *ps = &pq->stages[s];
+        if (ps->system_time > max) {
+            max = ps->system_time;
+        }
+        ps->system_time = 0;
+    }
+
+    world->info.system_time_total += max;
+}
+
 bool ecs_progress(
     ecs_world_t *world,
     ecs_ftime_t user_delta_time)
@@ -3,24 +3,45 @@
 
 #include "../../private_api.h"
 
+/** Number of iterations a thread spins on a sync point before it blocks */
+#ifndef ECS_WORKER_SPIN_COUNT
+#define ECS_WORKER_SPIN_COUNT (1024)
+#endif
+
 /** Instruction data for pipeline.
  * This type is the element type in the "ops" vector of a pipeline and contains
  * information about the set of systems that need to be ran before a merge. */
 typedef struct ecs_pipeline_op_t {
+    int32_t offset;             /* Offset of first system in groups vector */
     int32_t count;              /* Number of systems to run before merge */
     bool multi_threaded;        /* Whether systems can be ran multi threaded */
     bool no_readonly;            /* Whether systems are staged or not */
 } ecs_pipeline_op_t;
 
+/* Number of commands in the queue of a stage after it ran a system */
+typedef struct ecs_pipeline_cmd_cut_t {
+    int32_t system;             /* Index of system in op */
+    int32_t end;                /* Number of commands after system ran */
+} ecs_pipeline_cmd_cut_t;
+
+/* Data that a worker collects while running the systems of an op */
+typedef struct ecs_pipeline_stage_t {
+    ecs_vector_t *cmd_cuts;     /* vector<ecs_pipeline_cmd_cut_t> */
+    ecs_ftime_t system_time;    /* Time spent running systems */
+} ecs_pipeline_stage_t;
+
 typedef struct ecs_pipeline_state_t {
     ecs_query_t *query;         /* Pipeline query */
     ecs_vector_t *ops;          /* Pipeline schedule */
+    ecs_vector_t *groups;       /* Concurrency group for each active system */
     ecs_entity_t last_system;   /* Last system ran by pipeline */
     ecs_id_record_t *idr_inactive; /* Cached record for quick inactive test */
     int32_t match_count;        /* Used to track of rebuild is necessary */
     int32_t rebuild_count;      /* Number of pipeline rebuilds */
     ecs_iter_t *iters;          /* Iterator for worker(s) */
+    ecs_pipeline_stage_t *stages; /* Per worker data (same count as iters) */
     int32_t iter_count;
+    ecs_vector_t *merge_order;  /* vector<ecs_cmd_range_t> */
 
     /* Members for continuing pipeline iteration after pipeline rebuild */
     ecs_pipeline_op_t *cur_op;  /* Current pipeline op */
@@ -54,6 +75,14 @@ void flecs_run_pipeline(
     ecs_pipeline_state_t *pq,
     ecs_ftime_t delta_time);
 
+void flecs_pipeline_merge_order(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq);
+
+void flecs_pipeline_system_time(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Worker API
 ////////////////////////////////////////////////////////////////////////////////
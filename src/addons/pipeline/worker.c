@@ -9,6 +9,35 @@ typedef struct ecs_worker_state_t {
     ecs_pipeline_state_t *pq;
 } ecs_worker_state_t;
 
+/* Wait until main thread signals workers. Spins for a bounded number of 
+ * iterations before blocking on the condition variable, since for short 
+ * systems the next signal often arrives before a parked thread would have
+ * been woken up. */
+static
+void flecs_worker_wait(
+    ecs_world_t *world,
+    int32_t gen)
+{
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->workers_gen) != gen) {
+            return;
+        }
+    }
+
+    /* The parked counter is incremented before the generation is checked, 
+     * and the main thread increments the generation before it checks the
+     * counter. Either the worker sees the new generation, or the main thread
+     * sees the parked worker and wakes it up. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (ecs_os_aload(&world->workers_gen) == gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* flecs_worker(void *arg) {
@@ -23,13 +52,13 @@ void* flecs_worker(void *arg) {
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t gen = world->workers_gen;
+    ecs_os_mutex_unlock(world->sync_mutex);
 
     if (!(world->flags & EcsWorldQuitWorkers)) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        flecs_worker_wait(world, gen);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
 
@@ -108,16 +137,43 @@ void flecs_sync_worker(
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
+    /* Read generation before signaling, as the main thread won't signal the
+     * workers before all of them have reached the sync point */
+    int32_t gen = ecs_os_aload(&world->workers_gen);
+
     /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == stage_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    if (ecs_os_ainc(&world->workers_waiting) == stage_count) {
+        /* Only wake up main thread when all threads are waiting */
+        ecs_os_mutex_lock(world->sync_mutex);
+        if (world->sync_parked) {
+            ecs_os_cond_signal(world->sync_cond);
+        }
+        ecs_os_mutex_unlock(world->sync_mutex);
     }
 
-    /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    /* Wait until main thread signals that thread can continue. While workers
+     * are synchronized the main thread can hand out merge jobs. */
+    do {
+        flecs_worker_wait(world, gen);
+        gen = ecs_os_aload(&world->workers_gen);
+
+        /* The job is written before workers_gen is incremented, so the
+         * acquire load of the generation makes it visible */
+        ecs_merge_job_action_t job = world->merge_job;
+        if (!job) {
+            break;
+        }
+
+        job(world, world->merge_job_ctx);
+
+        if (ecs_os_ainc(&world->merge_jobs_done) == stage_count) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            if (world->sync_parked) {
+                ecs_os_cond_signal(world->sync_cond);
+            }
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+    } while (true);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -129,17 +185,27 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != stage_count) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->workers_waiting) == stage_count) {
+            break;
+        }
     }
-    
+
+    if (i == ECS_WORKER_SPIN_COUNT) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        world->sync_parked = true;
+        while (ecs_os_aload(&world->workers_waiting) != stage_count) {
+            ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+        }
+        world->sync_parked = false;
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+
     /* We should have been signalled unless all workers are waiting on sync */
     ecs_assert(world->workers_waiting == stage_count, 
         ECS_INTERNAL_ERROR, NULL);
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     ecs_dbg_3("#[bold]pipeline: workers synced");
 }
 
@@ -149,9 +215,55 @@ void flecs_signal_workers(
     ecs_world_t *world)
 {
     ecs_dbg_3("#[bold]pipeline: signal workers");
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+
+    /* Workers that are still spinning pick up the new generation without
+     * having to go through the mutex. The mutex is only taken when workers
+     * are parked on the condition variable. */
+    ecs_os_ainc(&world->workers_gen);
+
+    if (ecs_os_aload(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+}
+
+/* Run merge job on synchronized workers and the main thread */
+static
+void flecs_workers_run_merge_job(
+    ecs_world_t *world,
+    ecs_merge_job_action_t job,
+    void *ctx)
+{
+    int32_t stage_count = ecs_get_stage_count(world);
+
+    world->merge_job = job;
+    world->merge_job_ctx = ctx;
+    world->merge_jobs_done = 0;
+    flecs_signal_workers(world);
+
+    job(world, ctx);
+
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (ecs_os_aload(&world->merge_jobs_done) == stage_count) {
+            break;
+        }
+    }
+
+    if (i == ECS_WORKER_SPIN_COUNT) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        world->sync_parked = true;
+        while (ecs_os_aload(&world->merge_jobs_done) != stage_count) {
+            ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+        }
+        world->sync_parked = false;
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
+
+    /* Workers wake up from the next signal without running the job again */
+    world->merge_job = NULL;
+    world->merge_job_ctx = NULL;
 }
 
 /** Stop workers */
@@ -293,7 +405,16 @@ void flecs_workers_progress(
     int32_t stage_count = ecs_get_stage_count(world);
 
     if (stage_count != pq->iter_count) {
+        int32_t i;
+        for (i = stage_count; i < pq->iter_count; i ++) {
+            ecs_vector_free(pq->stages[i].cmd_cuts);
+        }
         pq->iters = ecs_os_realloc_n(pq->iters, ecs_iter_t, stage_count);
+        pq->stages = ecs_os_realloc_n(
+            pq->stages, ecs_pipeline_stage_t, stage_count);
+        for (i = pq->iter_count; i < stage_count; i ++) {
+            ecs_os_zeromem(&pq->stages[i]);
+        }
         pq->iter_count = stage_count;
     }
 
@@ -333,9 +454,20 @@ void flecs_workers_progress(
             /* Wait until all workers are waiting on sync point */
             flecs_wait_for_sync(world);
 
-            /* Merge */
+            if (world->flags & EcsWorldMeasureSystemTime) {
+                flecs_pipeline_system_time(world, pq);
+            }
+
+            /* Merge. Workers are synchronized, so they can help with writing
+             * values when parallel merging is enabled. Commands are merged in
+             * the order in which their systems appear in the pipeline. */
             if (!op->no_readonly) {
+                flecs_pipeline_merge_order(world, pq);
+                world->merge_run = flecs_workers_run_merge_job;
                 ecs_readonly_end(world);
+                world->merge_run = NULL;
+                world->merge_order = NULL;
+                world->merge_order_count = 0;
             }
             if (is_threaded) {
                 world->flags |= EcsWorldMultiThreaded;
@@ -89,6 +89,11 @@ typedef struct ecs_rule_with_ctx_t {
     ecs_id_record_t *idr;      /* Currently evaluated table set */
     ecs_table_cache_iter_t it;
     int32_t column;
+
+    /* Partitioning state of select for worker iterators */
+    ecs_table_t *worker_table; /* Last table found by select */
+    int32_t worker_tables;     /* Number of tables found by select */
+    bool worker_owned;         /* Is last table owned by current worker */
 } ecs_rule_with_ctx_t;
 
 /* Subset context */
@@ -100,9 +105,10 @@ typedef struct ecs_rule_subset_frame_t {
 } ecs_rule_subset_frame_t;
 
 typedef struct ecs_rule_subset_ctx_t {
-    ecs_rule_subset_frame_t storage[16]; /* Alloc-free array for small trees */
-    ecs_rule_subset_frame_t *stack;
+    ecs_vec_t stack;                     /* vec<ecs_rule_subset_frame_t> */
     int32_t sp;
+    ecs_subset_tables_t *closure;        /* Tables of transitive closure */
+    int32_t closure_index;               /* Current element in closure */
 } ecs_rule_subset_ctx_t;
 
 /* Superset context */
@@ -112,8 +118,7 @@ typedef struct ecs_rule_superset_frame_t {
 } ecs_rule_superset_frame_t;
 
 typedef struct ecs_rule_superset_ctx_t {
-    ecs_rule_superset_frame_t storage[16]; /* Alloc-free array for small trees */
-    ecs_rule_superset_frame_t *stack;
+    ecs_vec_t stack;                     /* vec<ecs_rule_superset_frame_t> */
     ecs_id_record_t *idr;
     int32_t sp;
 } ecs_rule_superset_ctx_t;
@@ -158,6 +163,36 @@ typedef struct ecs_rule_term_vars_t {
     int32_t second;
 } ecs_rule_term_vars_t;
 
+/* Table cached rule results depend on, with the value of its entity counter 
+ * (dirty_state[0]) at the time the results were cached */
+typedef struct ecs_rule_cache_table_t {
+    ecs_table_t *table;
+    int32_t dirty_state;
+} ecs_rule_cache_table_t;
+
+/* Results of rules created with EcsFilterCacheResults. Results are stored as
+ * the register and column frames of the yield operation, so that replaying a
+ * result is the same as yielding it from the program. Iterators that replay
+ * results hold a reference, so that results aren't modified or freed while
+ * they are replayed. Results don't use the world allocator, since the last
+ * reference can be released by a worker thread. */
+typedef struct ecs_rule_cache_results_t {
+    ecs_vector_t *registers;    /* vector<ecs_var_t>, var_count per result */
+    ecs_vector_t *columns;      /* vector<int32_t>, term_count per result */
+    int32_t count;              /* Number of cached results */
+    int32_t refs;               /* Cache + number of replaying iterators */
+} ecs_rule_cache_results_t;
+
+/* Result cache. A new fill populates a separate results object, which
+ * replaces the current results when all results have been stored. */
+typedef struct ecs_rule_cache_t {
+    ecs_rule_cache_results_t *results; /* Results that can be replayed */
+    ecs_rule_cache_results_t *filling; /* Results that are being populated */
+    ecs_vec_t tables;           /* vec<ecs_rule_cache_table_t> */
+    int64_t table_stamp;        /* Table create + delete count at fill time */
+    bool valid;                 /* Can cache be replayed */
+} ecs_rule_cache_t;
+
 /* Top-level rule datastructure */
 struct ecs_rule_t {
     ecs_header_t hdr;
@@ -183,6 +218,8 @@ struct ecs_rule_t {
     int32_t frame_count;        /* Number of register frames */
     int32_t operation_count;    /* Number of operations in rule */
 
+    ecs_rule_cache_t *cache;    /* Result cache (EcsFilterCacheResults) */
+
     ecs_iterable_t iterable;    /* Iterable mixin */
 };
 
@@ -2676,12 +2713,32 @@ ecs_rule_t* ecs_rule_init(
 
     result->iterable.init = rule_iter_init;
 
+    if (ECS_BIT_IS_SET(result->filter.flags, EcsFilterCacheResults)) {
+        ecs_allocator_t *a = &((ecs_world_t*)ecs_get_world(world))->allocator;
+        ecs_rule_cache_t *cache = result->cache = 
+            ecs_os_calloc_t(ecs_rule_cache_t);
+        ecs_vec_init_t(a, &cache->tables, ecs_rule_cache_table_t, 0);
+    }
+
     return result;
 error:
     ecs_rule_fini(result);
     return NULL;
 }
 
+/* Release reference to cached results. Results are freed when the cache and
+ * all iterators that replay them have released them. */
+static
+void flecs_rule_cache_results_release(
+    ecs_rule_cache_results_t *results)
+{
+    if (results && !ecs_os_adec(&results->refs)) {
+        ecs_vector_free(results->registers);
+        ecs_vector_free(results->columns);
+        ecs_os_free(results);
+    }
+}
+
 void ecs_rule_fini(
     ecs_rule_t *rule)
 {
@@ -2690,6 +2747,16 @@ void ecs_rule_fini(
         ecs_os_free(rule->vars[i].name);
     }
 
+    ecs_rule_cache_t *cache = rule->cache;
+    if (cache) {
+        ecs_allocator_t *a = 
+            &((ecs_world_t*)ecs_get_world(rule->world))->allocator;
+        flecs_rule_cache_results_release(cache->results);
+        flecs_rule_cache_results_release(cache->filling);
+        ecs_vec_fini_t(a, &cache->tables, ecs_rule_cache_table_t);
+        ecs_os_free(cache);
+    }
+
     ecs_filter_fini(&rule->filter);
 
     ecs_os_free(rule->operations);
@@ -2895,11 +2962,240 @@ bool ecs_rule_var_is_entity(
     return rule->vars[var_id].kind == EcsRuleVarKindEntity;
 }
 
+/* Returns the id record an id with variables and Any resolves to. Results for
+ * the id can only change when the tables of this id record change. */
+static
+ecs_id_t flecs_rule_cache_id(
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = ECS_PAIR_FIRST(id);
+        ecs_entity_t second = ECS_PAIR_SECOND(id);
+        if (first == EcsAny) {
+            first = EcsWildcard;
+        }
+        if (second == EcsAny) {
+            second = EcsWildcard;
+        }
+        return ecs_pair(first, second);
+    } else if (id == EcsAny) {
+        return EcsWildcard;
+    }
+    return id;
+}
+
+/* Store the tables of an id, so that changes to them invalidate the cache */
+static
+bool flecs_rule_cache_add_tables(
+    ecs_world_t *world,
+    ecs_rule_cache_t *cache,
+    ecs_id_t id)
+{
+    id = flecs_rule_cache_id(id);
+
+    /* The target of a union relationship can change without the entity
+     * changing tables, which isn't tracked by the cache. */
+    if (ECS_IS_PAIR(id) && flecs_id_record_get(
+        world, ecs_pair(EcsUnion, ECS_PAIR_FIRST(id))))
+    {
+        return false;
+    }
+
+    ecs_id_record_t *idr = flecs_query_id_record_get(world, id);
+    if (!idr) {
+        /* Tables created for the id will change the table stamp */
+        return true;
+    }
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_all_iter(&idr->cache, &it)) {
+        ecs_allocator_t *a = &world->allocator;
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+            ecs_rule_cache_table_t *elem = ecs_vec_append_t(
+                a, &cache->tables, ecs_rule_cache_table_t);
+            elem->table = table;
+            elem->dirty_state = dirty_state[0];
+        }
+    }
+
+    return true;
+}
+
+/* Start populating the cache. The tables the results depend on are stored
+ * before evaluating the rule, so that changes made while the iterator is 
+ * active invalidate the results. */
+static
+bool flecs_rule_cache_fill_begin(
+    ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_assert(cache != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (cache->filling) {
+        return false;
+    }
+
+    /* Iterators that are replaying the current results keep their reference
+     * to it, new results are stored in a separate object. */
+    ecs_vec_clear(&cache->tables);
+    cache->valid = false;
+
+    const ecs_filter_t *filter = &rule->filter;
+    int32_t i, term_count = filter->term_count;
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        if (!flecs_rule_cache_add_tables(world, cache, term->id)) {
+            return false;
+        }
+
+        /* Terms that traverse relationships also depend on the tables with
+         * the traversed relationship */
+        ecs_term_id_t *ids[3] = { &term->first, &term->src, &term->second };
+        int32_t t;
+        for (t = 0; t < 3; t ++) {
+            ecs_term_id_t *term_id = ids[t];
+            if (term_id->trav && (term_id->flags & (EcsUp|EcsDown))) {
+                if (!flecs_rule_cache_add_tables(world, cache, 
+                    ecs_pair(term_id->trav, EcsWildcard))) 
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    cache->table_stamp = world->info.table_create_total + 
+        world->info.table_delete_total;
+
+    cache->filling = ecs_os_calloc_t(ecs_rule_cache_results_t);
+    cache->filling->refs = 1;
+
+    return true;
+}
+
+/* Store result that's about to be yielded by the yield operation */
+static
+void flecs_rule_cache_append(
+    ecs_rule_iter_t *it,
+    ecs_rule_op_t *op)
+{
+    const ecs_rule_t *rule = it->rule;
+    ecs_rule_cache_results_t *results = rule->cache->filling;
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+
+    if (var_count) {
+        ecs_var_t *regs = ecs_vector_addn(
+            &results->registers, ecs_var_t, var_count);
+        ecs_os_memcpy_n(regs, get_register_frame(it, op->frame), 
+            ecs_var_t, var_count);
+    }
+
+    if (term_count) {
+        int32_t *columns = ecs_vector_addn(
+            &results->columns, int32_t, term_count);
+        ecs_os_memcpy_n(columns, rule_get_columns_frame(it, op->frame), 
+            int32_t, term_count);
+    }
+
+    results->count ++;
+}
+
+/* Results are valid if no tables were created or deleted, and none of the 
+ * tables the results depend on gained or lost entities. */
+static
+bool flecs_rule_cache_is_valid(
+    const ecs_world_t *world,
+    const ecs_rule_cache_t *cache)
+{
+    if (!cache->valid) {
+        return false;
+    }
+
+    int64_t table_stamp = world->info.table_create_total + 
+        world->info.table_delete_total;
+    if (cache->table_stamp != table_stamp) {
+        return false;
+    }
+
+    const ecs_rule_cache_table_t *tables = ecs_vec_first(&cache->tables);
+    int32_t i, count = ecs_vec_count(&cache->tables);
+    for (i = 0; i < count; i ++) {
+        const ecs_rule_cache_table_t *elem = &tables[i];
+        if (elem->table->dirty_state[0] != elem->dirty_state) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Allocator for data owned by the iterator. Uses the allocator of the stage,
+ * since rules can be iterated from multiple threads. */
+static
+ecs_allocator_t* flecs_rule_iter_allocator(
+    const ecs_iter_t *it)
+{
+    ecs_world_t *world = it->world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    return &stage->allocator;
+}
+
+/* Get frame from subset or superset stack, grow stack if necessary */
+static
+void* flecs_rule_stack_frame(
+    const ecs_iter_t *it,
+    ecs_vec_t *stack,
+    ecs_size_t size,
+    int32_t sp)
+{
+    if (sp >= ecs_vec_count(stack)) {
+        ecs_vec_set_count(flecs_rule_iter_allocator(it), stack, size, sp + 1);
+    }
+    return ecs_vec_get(stack, size, sp);
+}
+
+#define flecs_rule_stack_frame_t(it, stack, T, sp)\
+    ECS_CAST(T*, flecs_rule_stack_frame(it, stack, ECS_SIZEOF(T), sp))
+
 static
 void ecs_rule_iter_free(
     ecs_iter_t *iter)
 {
     ecs_rule_iter_t *it = &iter->priv.iter.rule;
+    const ecs_rule_t *rule = it->rule;
+
+    if (it->op_ctx) {
+        ecs_allocator_t *a = flecs_rule_iter_allocator(iter);
+        int32_t i;
+        for (i = 0; i < rule->operation_count; i ++) {
+            ecs_rule_op_kind_t kind = rule->operations[i].kind;
+            if (kind == EcsRuleSubSet) {
+                ecs_vec_fini_t(a, &it->op_ctx[i].is.subset.stack, 
+                    ecs_rule_subset_frame_t);
+                flecs_subset_tables_release(it->op_ctx[i].is.subset.closure);
+            } else if (kind == EcsRuleSuperSet) {
+                ecs_vec_fini_t(a, &it->op_ctx[i].is.superset.stack, 
+                    ecs_rule_superset_frame_t);
+            }
+        }
+    }
+
+    if (it->fill_cache) {
+        /* Iterator was stopped before all results were stored */
+        ecs_rule_cache_t *cache = it->rule->cache;
+        it->fill_cache = false;
+        flecs_rule_cache_results_release(cache->filling);
+        cache->filling = NULL;
+    }
+
+    flecs_rule_cache_results_release(it->cached);
+    it->cached = NULL;
+
     ecs_os_free(it->registers);
     ecs_os_free(it->columns);
     ecs_os_free(it->op_ctx);
@@ -2947,6 +3243,7 @@ ecs_iter_t ecs_rule_iter(
     }
 
     it->op = 0;
+    it->cached_result = -1;
 
     for (i = 0; i < rule->var_count; i ++) {
         if (rule->vars[i].kind == EcsRuleVarKindEntity) {
@@ -2979,6 +3276,37 @@ ecs_iter_t ecs_rule_iter(
     return result;
 }
 
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_rule_iter(world, rule);
+    ecs_rule_iter_t *it = &result.priv.iter.rule;
+    it->worker_index = index;
+    it->worker_count = count;
+    it->worker_op = -1;
+
+    /* Partition the program at its first select operation, so that only the
+     * remainder of the program is evaluated for the tables of a worker */
+    int32_t i;
+    for (i = 0; i < rule->operation_count; i ++) {
+        if (rule->operations[i].kind == EcsRuleSelect) {
+            it->worker_op = i;
+            break;
+        }
+    }
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
 /* Edge case: if the filter has the same variable for both predicate and
  * object, they are both resolved at the same time but at the time of 
  * evaluating the filter they're still wildcards which would match columns
@@ -3216,9 +3544,11 @@ bool eval_superset(
     }
 
     if (!redo) {
-        op_ctx->stack = op_ctx->storage;
+        ecs_vec_reset_t(flecs_rule_iter_allocator(it), &op_ctx->stack, 
+            ecs_rule_superset_frame_t);
         sp = op_ctx->sp = 0;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_superset_frame_t, sp);
 
         /* Get table of object for which to get supersets */
         ecs_entity_t second = ECS_PAIR_SECOND(filter.mask);
@@ -3269,7 +3599,7 @@ bool eval_superset(
     }
 
     sp = op_ctx->sp;
-    frame = &op_ctx->stack[sp];
+    frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_superset_frame_t, sp);
     table = frame->table;
     int32_t column = frame->column;
 
@@ -3279,13 +3609,14 @@ bool eval_superset(
 
     if (next_table) {
         sp ++;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_superset_frame_t, sp);
         frame->table = next_table;
         frame->column = -1;
     }
 
     do {
-        frame = &op_ctx->stack[sp];
+        frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_superset_frame_t, sp);
         table = frame->table;
         column = frame->column;
 
@@ -3305,6 +3636,329 @@ bool eval_superset(
     return false;
 }
 
+/* Closure is up to date if no tables were created and no targets moved to 
+ * another table since it was last used. */
+static
+bool flecs_rule_subsets_valid(
+    const ecs_subset_cache_t *cache)
+{
+    return !ecs_vec_count(&cache->created) && !ecs_vec_count(&cache->moved);
+}
+
+/* Add (R, member) pair of table to closure. Tables are yielded once for each
+ * pair, like when walking the hierarchy. Returns true if the table was not
+ * yet in the closure. */
+static
+bool flecs_rule_subsets_add_pair(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table,
+    int32_t column)
+{
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    ecs_subset_elem_t *elem = ecs_vector_add(
+        &tables->tables, ecs_subset_elem_t);
+    elem->table = table;
+    elem->column = column;
+
+    int32_t *refs = ecs_map_ensure(&cache->table_refs, int32_t, table->id);
+    return !(refs[0] ++);
+}
+
+/* Remove (R, member) pair of table from closure. Returns true if the table is
+ * no longer in the closure. */
+static
+bool flecs_rule_subsets_remove_pair(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table,
+    int32_t column)
+{
+    int32_t *refs = ecs_map_get(&cache->table_refs, int32_t, table->id);
+    if (!refs) {
+        return false;
+    }
+
+    if (!(-- refs[0])) {
+        flecs_subset_cache_remove_table(cache, table);
+        return true;
+    }
+
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    int32_t i, count = ecs_vector_count(tables->tables);
+    ecs_subset_elem_t *elems = ecs_vector_first(
+        tables->tables, ecs_subset_elem_t);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].table == table && elems[i].column == column) {
+            ecs_os_memmove(&elems[i], &elems[i + 1], 
+                ECS_SIZEOF(ecs_subset_elem_t) * (count - i - 1));
+            ecs_vector_set_count(&tables->tables, ecs_subset_elem_t, count - 1);
+            break;
+        }
+    }
+
+    return false;
+}
+
+typedef struct ecs_rule_closure_frame_t {
+    ecs_table_cache_iter_t it;
+    ecs_table_t *table;
+    int32_t row;
+} ecs_rule_closure_frame_t;
+
+/* Compute transitive closure of a pair. Tables are stored in the same order
+ * in which the subset operation would find them when walking the hierarchy. */
+static
+void flecs_rule_subsets_build(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_entity_t rel,
+    ecs_id_record_t *idr)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t stack;
+    ecs_vec_init_t(a, &stack, ecs_rule_closure_frame_t, 16);
+
+    ecs_rule_closure_frame_t *frame = ecs_vec_append_t(
+        a, &stack, ecs_rule_closure_frame_t);
+    flecs_table_cache_all_iter(&idr->cache, &frame->it);
+    frame->table = NULL;
+
+    while (ecs_vec_count(&stack)) {
+        frame = ecs_vec_last_t(&stack, ecs_rule_closure_frame_t);
+        ecs_table_t *table = frame->table;
+        if (table && frame->row < ecs_table_count(table)) {
+            ecs_entity_t e = ecs_vec_get_t(&table->data.entities, 
+                ecs_entity_t, frame->row)[0];
+            frame->row ++;
+
+            ecs_id_record_t *e_idr = flecs_id_record_get(
+                world, ecs_pair(rel, e));
+            if (e_idr) {
+                ecs_map_ensure(&cache->members, bool, e)[0] = true;
+                frame = ecs_vec_append_t(a, &stack, ecs_rule_closure_frame_t);
+                flecs_table_cache_all_iter(&e_idr->cache, &frame->it);
+                frame->table = NULL;
+            }
+            continue;
+        }
+
+        const ecs_table_record_t *tr = flecs_table_cache_next(
+            &frame->it, ecs_table_record_t);
+        if (!tr) {
+            ecs_vec_remove_last(&stack);
+            continue;
+        }
+
+        /* Only walk the entities of a table the first time it's found */
+        table = tr->hdr.table;
+        if (flecs_rule_subsets_add_pair(cache, table, tr->column)) {
+            frame->table = table;
+            frame->row = 0;
+        } else {
+            frame->table = NULL;
+        }
+    }
+
+    ecs_vec_fini_t(a, &stack, ecs_rule_closure_frame_t);
+}
+
+/* Queue entities of table that have subsets */
+static
+void flecs_rule_subsets_queue_table(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_table_count(table);
+    ecs_entity_t *entities = ecs_vec_first(&table->data.entities);
+    ecs_vec_t *moved = &cache->moved;
+    for (i = 0; i < count; i ++) {
+        ecs_vec_append_t(&world->allocator, moved, ecs_entity_t)[0] = 
+            entities[i];
+    }
+}
+
+/* Add or remove the subsets of a target that entered or left the closure */
+static
+void flecs_rule_subsets_update_target(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_id_record_t *e_idr,
+    bool add)
+{
+    ecs_table_cache_iter_t it;
+    if (!flecs_table_cache_all_iter(&e_idr->cache, &it)) {
+        return;
+    }
+
+    const ecs_table_record_t *tr;
+    while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+        ecs_table_t *table = tr->hdr.table;
+        bool changed;
+        if (add) {
+            changed = flecs_rule_subsets_add_pair(cache, table, tr->column);
+        } else {
+            changed = flecs_rule_subsets_remove_pair(cache, table, tr->column);
+        }
+        if (changed) {
+            flecs_rule_subsets_queue_table(world, cache, table);
+        }
+    }
+}
+
+/* Apply created tables and moved targets to closure. Only the subsets of 
+ * targets that entered or left the closure are visited. */
+static
+void flecs_rule_subsets_apply(
+    ecs_world_t *world,
+    ecs_subset_cache_t *cache,
+    ecs_id_record_t *idr)
+{
+    ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+
+    /* Count the pairs of created tables with targets that are in the closure.
+     * Targets that don't have subsets in the closure yet are evaluated with the
+     * moved targets. */
+    int32_t i, count = ecs_vec_count(&cache->created);
+    uint64_t *created = ecs_vec_first(&cache->created);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get(
+            &world->store.tables, ecs_table_t, created[i]);
+        if (!table || ecs_map_get(&cache->table_refs, int32_t, table->id)) {
+            continue;
+        }
+
+        const ecs_table_record_t *tr = flecs_table_record_get(
+            world, table, ecs_pair(rel, EcsWildcard));
+        if (!tr) {
+            continue;
+        }
+
+        int32_t c;
+        for (c = tr->column; c < (tr->column + tr->count); c ++) {
+            ecs_id_t pair = table->type.array[c];
+            ecs_entity_t tgt = ecs_pair_second(world, pair);
+            if ((pair == idr->id) || 
+                ecs_map_get(&cache->members, bool, tgt)) 
+            {
+                flecs_rule_subsets_add_pair(cache, table, c);
+            } else if (tgt) {
+                ecs_vec_append_t(&world->allocator, &cache->moved, 
+                    ecs_entity_t)[0] = tgt;
+            }
+        }
+    }
+    ecs_vec_clear(&cache->created);
+
+    /* Evaluate targets until no more tables are added to or removed from the
+     * closure. A target has subsets in the closure if its table is. */
+    ecs_vec_t *moved = &cache->moved;
+    while (ecs_vec_count(moved)) {
+        ecs_entity_t e = ecs_vec_last_t(moved, ecs_entity_t)[0];
+        ecs_vec_remove_last(moved);
+
+        ecs_table_t *table = NULL;
+        bool is_alive = ecs_is_alive(world, e);
+        if (is_alive) {
+            table = flecs_entities_get(world, e)->table;
+        }
+
+        bool in_closure = table && 
+            ecs_map_get(&cache->table_refs, int32_t, table->id);
+        bool is_member = ecs_map_get(&cache->members, bool, e) != NULL;
+        if (in_closure == is_member) {
+            continue;
+        }
+
+        /* A deleted target with a recycled id no longer owns the pair */
+        ecs_id_record_t *e_idr = NULL;
+        if (is_alive || !ecs_get_alive(world, (uint32_t)e)) {
+            e_idr = flecs_id_record_get(world, ecs_pair(rel, e));
+        }
+
+        if (in_closure) {
+            if (!e_idr) {
+                continue;
+            }
+            ecs_map_ensure(&cache->members, bool, e)[0] = true;
+        } else {
+            ecs_map_remove(&cache->members, e);
+        }
+
+        if (e_idr) {
+            flecs_rule_subsets_update_target(world, cache, e_idr, in_closure);
+        }
+    }
+}
+
+/* Get up to date transitive closure for a pair. Returns NULL if the closure
+ * isn't available, in which case the hierarchy is walked. */
+static
+ecs_subset_tables_t* flecs_rule_get_subsets(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return NULL;
+    }
+
+    ecs_subset_cache_t *cache = idr->subsets;
+    if (cache && flecs_rule_subsets_valid(cache)) {
+        return cache->tables;
+    }
+
+    /* Don't modify cache when other threads could be reading it */
+    if (world->flags & EcsWorldMultiThreaded) {
+        return NULL;
+    }
+
+    if (cache) {
+        flecs_rule_subsets_apply(world, cache, idr);
+        return cache->tables;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    cache = idr->subsets = ecs_os_calloc_t(ecs_subset_cache_t);
+    cache->tables = ecs_os_calloc_t(ecs_subset_tables_t);
+    cache->tables->refs = 1;
+    ecs_map_init(&cache->table_refs, int32_t, a, 0);
+    ecs_map_init(&cache->members, bool, a, 0);
+    ecs_vec_init_t(a, &cache->created, uint64_t, 0);
+    ecs_vec_init_t(a, &cache->moved, ecs_entity_t, 0);
+    ecs_vector_add(&world->store.subset_ids, ecs_id_record_t*)[0] = idr;
+    world->flags |= EcsWorldHasSubsets;
+
+    flecs_rule_subsets_build(world, cache, ECS_PAIR_FIRST(id), idr);
+
+    return cache->tables;
+}
+
+/* Yield next non-empty table from transitive closure */
+static
+bool eval_subset_closure(
+    ecs_rule_iter_t *iter,
+    ecs_rule_op_t *op,
+    ecs_rule_subset_ctx_t *op_ctx,
+    ecs_var_t *regs)
+{
+    ecs_vector_t *tables = op_ctx->closure->tables;
+    int32_t count = ecs_vector_count(tables);
+    ecs_subset_elem_t *elem;
+    do {
+        int32_t index = op_ctx->closure_index ++;
+        if (index >= count) {
+            return false;
+        }
+        elem = ecs_vector_get(tables, ecs_subset_elem_t, index);
+    } while (!ecs_table_count(elem->table));
+
+    ecs_table_t *table = elem->table;
+    table_reg_set(iter->rule, regs, op->r_out, table);
+    set_term_vars(iter->rule, regs, op->term, table->type.array[elem->column]);
+
+    return true;
+}
+
 static
 bool eval_subset(
     ecs_iter_t *it,
@@ -3332,9 +3986,24 @@ bool eval_subset(
     ecs_table_t *table = NULL;
 
     if (!redo) {
-        op_ctx->stack = op_ctx->storage;
+        /* Use transitive closure if the pair is known. The iterator keeps a
+         * reference to the closure tables while it yields them. */
+        flecs_subset_tables_release(op_ctx->closure);
+        op_ctx->closure = NULL;
+        if (!filter.wildcard && !filter.same_var) {
+            op_ctx->closure = flecs_rule_get_subsets(world, filter.mask);
+            if (op_ctx->closure) {
+                ecs_os_ainc(&op_ctx->closure->refs);
+                op_ctx->closure_index = 0;
+                return eval_subset_closure(iter, op, op_ctx, regs);
+            }
+        }
+
+        ecs_vec_reset_t(flecs_rule_iter_allocator(it), &op_ctx->stack, 
+            ecs_rule_subset_frame_t);
         sp = op_ctx->sp = 0;
-        frame = &op_ctx->stack[sp];
+        frame = flecs_rule_stack_frame_t(
+            it, &op_ctx->stack, ecs_rule_subset_frame_t, sp);
         idr = frame->with_ctx.idr = find_tables(world, filter.mask);
         if (!idr) {
             return false;
@@ -3354,9 +4023,13 @@ bool eval_subset(
         goto yield;
     }
 
+    if (op_ctx->closure) {
+        return eval_subset_closure(iter, op, op_ctx, regs);
+    }
+
     do {
         sp = op_ctx->sp;
-        frame = &op_ctx->stack[sp];
+        frame = ecs_vec_get_t(&op_ctx->stack, ecs_rule_subset_frame_t, sp);
         table = frame->table;
         row = frame->row;
 
@@ -3378,7 +4051,8 @@ bool eval_subset(
                     /* If none of the frames yielded anything, no more data */
                     return false;
                 }
-                frame = &op_ctx->stack[sp];
+                frame = ecs_vec_get_t(
+                    &op_ctx->stack, ecs_rule_subset_frame_t, sp);
                 table = frame->table;
                 idr = frame->with_ctx.idr;
                 row = ++ frame->row;
@@ -3411,7 +4085,11 @@ bool eval_subset(
 
             /* If table set is found, find first non-empty table */
             if (idr) {
-                ecs_rule_subset_frame_t *new_frame = &op_ctx->stack[sp + 1];
+                /* Growing the stack can move the current frame */
+                ecs_rule_subset_frame_t *new_frame = flecs_rule_stack_frame_t(
+                    it, &op_ctx->stack, ecs_rule_subset_frame_t, sp + 1);
+                frame = ecs_vec_get_t(
+                    &op_ctx->stack, ecs_rule_subset_frame_t, sp);
                 new_frame->with_ctx.idr = idr;
                 flecs_table_cache_iter(&idr->cache, &new_frame->with_ctx.it);
                 table_record = find_next_table(&filter, &new_frame->with_ctx);
@@ -3591,6 +4269,45 @@ bool eval_select(
     return true;
 }
 
+/* Select operation for partitioned iterators. Each table found by the select
+ * at which the program is partitioned is assigned to one of the workers, and
+ * tables of other workers are skipped. Since all workers evaluate the program
+ * in the same order, each table is evaluated by exactly one worker. */
+static
+bool eval_select_partition(
+    ecs_iter_t *it,
+    ecs_rule_op_t *op,
+    int32_t op_index,
+    bool redo)
+{
+    ecs_rule_iter_t *iter = &it->priv.iter.rule;
+    if (iter->worker_count <= 1 || iter->worker_op != op_index) {
+        return eval_select(it, op, op_index, redo);
+    }
+
+    ecs_rule_with_ctx_t *op_ctx = &iter->op_ctx[op_index].is.with;
+    ecs_var_t *regs = get_registers(iter, op);
+
+    while (eval_select(it, op, op_index, redo)) {
+        ecs_table_t *table = table_reg_get(iter->rule, regs, op->r_out).table;
+        if (table != op_ctx->worker_table) {
+            /* Wildcard selects can return the same table multiple times */
+            op_ctx->worker_table = table;
+            op_ctx->worker_owned = (op_ctx->worker_tables % 
+                iter->worker_count) == iter->worker_index;
+            op_ctx->worker_tables ++;
+        }
+
+        if (op_ctx->worker_owned) {
+            return true;
+        }
+
+        redo = true;
+    }
+
+    return false;
+}
+
 /* With operation. The With operation always comes after either the Select or
  * another With operation, and applies additional filters to the table. */
 static
@@ -4018,7 +4735,7 @@ bool eval_op(
     case EcsRuleInput:
         return eval_input(it, op, op_index, redo);
     case EcsRuleSelect:
-        return eval_select(it, op, op_index, redo);
+        return eval_select_partition(it, op, op_index, redo);
     case EcsRuleWith:
         return eval_with(it, op, op_index, redo);
     case EcsRuleSubSet:
@@ -4339,6 +5056,53 @@ bool ecs_rule_next_instanced(
     if (first_time) {
         ecs_assert(redo == false, ECS_INTERNAL_ERROR, NULL);
         rule_iter_set_initial_state(it, iter, rule);
+
+        /* Cached results are only valid when no variables are constrained. The
+         * cache is not modified while the world is accessed from multiple
+         * threads, so that iterators on other threads can safely replay it. */
+        if (rule->cache && !it->constrained_vars) {
+            ecs_world_t *world = it->real_world;
+            if (flecs_rule_cache_is_valid(world, rule->cache)) {
+                /* Partitioned iterators replay every worker_count'th result */
+                iter->cached_result = iter->worker_count > 1 
+                    ? iter->worker_index : 0;
+                iter->cached = rule->cache->results;
+                ecs_os_ainc(&iter->cached->refs);
+            } else if (!(world->flags & EcsWorldMultiThreaded) && 
+                iter->worker_count <= 1) 
+            {
+                iter->fill_cache = flecs_rule_cache_fill_begin(world, rule);
+            }
+        }
+    }
+
+    /* Replay cached results */
+    if (iter->cached_result != -1) {
+        ecs_rule_cache_results_t *cache = iter->cached;
+        int32_t index = iter->cached_result;
+        if (index >= cache->count) {
+            ecs_iter_fini(it);
+            return false;
+        }
+
+        ecs_rule_op_t *op = &rule->operations[rule->operation_count - 1];
+        ecs_assert(op->kind == EcsRuleYield, ECS_INTERNAL_ERROR, NULL);
+        int32_t var_count = rule->var_count;
+        int32_t term_count = rule->filter.term_count;
+        if (var_count) {
+            ecs_os_memcpy_n(get_register_frame(iter, op->frame), 
+                ecs_vector_get(cache->registers, ecs_var_t, 
+                    index * var_count), ecs_var_t, var_count);
+        }
+        if (term_count) {
+            ecs_os_memcpy_n(rule_get_columns_frame(iter, op->frame),
+                ecs_vector_get(cache->columns, int32_t,
+                    index * term_count), int32_t, term_count);
+        }
+
+        populate_iterator(rule, it, iter, op);
+        iter->cached_result += iter->worker_count > 1 ? iter->worker_count : 1;
+        return true;
     }
 
     do {
@@ -4373,8 +5137,19 @@ bool ecs_rule_next_instanced(
         bool result = eval_op(it, op, op_index, redo);
         iter->op = result ? op->on_pass : op->on_fail;
 
+        /* If the program isn't partitioned at a select, each worker yields 
+         * every worker_count'th result */
+        bool yield = op->kind == EcsRuleYield;
+        if (yield && iter->worker_count > 1 && iter->worker_op == -1) {
+            yield = (iter->worker_yield ++ % iter->worker_count) == 
+                iter->worker_index;
+        }
+
         /* If the current operation is yield, return results */
-        if (op->kind == EcsRuleYield) {
+        if (yield) {
+            if (iter->fill_cache) {
+                flecs_rule_cache_append(iter, op);
+            }
             populate_iterator(rule, it, iter, op);
             iter->redo = true;
             return true;
@@ -4394,6 +5169,16 @@ bool ecs_rule_next_instanced(
         }
     } while (iter->op != -1);
 
+    /* All results have been stored, cache can now be replayed */
+    if (iter->fill_cache) {
+        ecs_rule_cache_t *cache = rule->cache;
+        flecs_rule_cache_results_release(cache->results);
+        cache->results = cache->filling;
+        cache->filling = NULL;
+        cache->valid = true;
+        iter->fill_cache = false;
+    }
+
     ecs_iter_fini(it);
 
 error:
@@ -96,7 +96,14 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
+        /* Chunks are claimed from the tables of the system query, so paged
+         * systems fall back to a regular worker iterator */
+        if (system_data->chunk_size && it == &qit) {
+            wit = ecs_worker_chunk_iter(it, stage_index, stage_count, 
+                system_data->chunk_size, &system_data->chunk_cursor);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+        }
         it = &wit;
     }
 
@@ -276,6 +283,8 @@ ecs_entity_t ecs_system_init(
 
         system->multi_threaded = desc->multi_threaded;
         system->no_readonly = desc->no_readonly;
+        system->concurrent = desc->concurrent;
+        system->chunk_size = desc->chunk_size;
 
         if (desc->interval != 0 || desc->rate != 0 || desc->tick_source != 0) {
 #ifdef FLECS_TIMER
@@ -323,6 +332,12 @@ ecs_entity_t ecs_system_init(
         if (desc->no_readonly) {
             system->no_readonly = desc->no_readonly;
         }
+        if (desc->concurrent) {
+            system->concurrent = desc->concurrent;
+        }
+        if (desc->chunk_size) {
+            system->chunk_size = desc->chunk_size;
+        }
     }
 
     ecs_poly_modified(world, entity, ecs_system_t);
@@ -23,6 +23,9 @@ typedef struct ecs_system_t {
     /* Schedule parameters */
     bool multi_threaded;
     bool no_readonly;
+    bool concurrent;
+    int32_t chunk_size;
+    ecs_worker_cursor_t chunk_cursor; /* Shared between workers */
 
     int64_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
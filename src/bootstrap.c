@@ -323,6 +323,12 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_sparse(ecs_iter_t *it) {
+    flecs_register_id_flag_for_relation(it, EcsSparse, EcsIdSparse, 0, 0);
+    it->real_world->flags |= EcsWorldHasSparse;
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -766,6 +772,7 @@ void flecs_bootstrap(
     flecs_bootstrap_tag(world, EcsDontInherit);
     flecs_bootstrap_tag(world, EcsTag);
     flecs_bootstrap_tag(world, EcsUnion);
+    flecs_bootstrap_tag(world, EcsSparse);
     flecs_bootstrap_tag(world, EcsExclusive);
     flecs_bootstrap_tag(world, EcsAcyclic);
     flecs_bootstrap_tag(world, EcsWith);
@@ -900,6 +907,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = EcsSparse, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_sparse
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer_init(world, &(ecs_observer_desc_t){
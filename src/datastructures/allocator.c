@@ -35,6 +35,19 @@ void flecs_allocator_fini(
     flecs_ballocator_fini(&a->chunks);
 }
 
+int64_t flecs_allocator_trim(
+    ecs_allocator_t *a)
+{
+    int64_t result = 0;
+    int32_t i = 0, count = flecs_sparse_count(&a->sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_block_allocator_t *ba = flecs_sparse_get_dense(
+            &a->sizes, ecs_block_allocator_t, i);
+        result += flecs_ballocator_trim(ba);
+    }
+    return result + flecs_ballocator_trim(&a->chunks);
+}
+
 ecs_block_allocator_t* flecs_allocator_get(
     ecs_allocator_t *a, 
     ecs_size_t size)
@@ -7,6 +7,19 @@
 int64_t ecs_block_allocator_alloc_count = 0;
 int64_t ecs_block_allocator_free_count = 0;
 
+/* Alignment of chunks returned for an allocator with the specified data size */
+static
+ecs_size_t flecs_balloc_align(
+    ecs_size_t data_size)
+{
+    ecs_size_t size = ECS_ALIGN(data_size, 16);
+    ecs_size_t align = size & -size;
+    if (align > FLECS_BALLOC_ALIGN) {
+        align = FLECS_BALLOC_ALIGN;
+    }
+    return align;
+}
+
 static
 ecs_block_allocator_chunk_header_t* flecs_balloc_block(
     ecs_block_allocator_t *allocator)
@@ -15,11 +28,18 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
         return NULL;
     }
 
+    /* Allocate enough memory to align the first chunk. Chunk sizes are a
+     * multiple of the chunk alignment, so all other chunks are aligned too */
+    ecs_size_t align = flecs_balloc_align(allocator->data_size);
     ecs_block_allocator_block_t *block = 
         ecs_os_malloc(ECS_SIZEOF(ecs_block_allocator_block_t) +
-            allocator->block_size);
-    ecs_block_allocator_chunk_header_t *first_chunk = ECS_OFFSET(block, 
+            allocator->block_size + align);
+    uintptr_t first_addr = (uintptr_t)ECS_OFFSET(block, 
         ECS_SIZEOF(ecs_block_allocator_block_t));
+    first_addr = (first_addr + (uintptr_t)(align - 1)) & 
+        ~(uintptr_t)(align - 1);
+    ecs_block_allocator_chunk_header_t *first_chunk = 
+        (ecs_block_allocator_chunk_header_t*)first_addr;
 
     block->memory = first_chunk;
     if (!allocator->block_tail) {
@@ -54,7 +74,8 @@ void flecs_ballocator_init(
     ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
     ba->data_size = size;
 #ifdef FLECS_SANITIZE
-    size += ECS_SIZEOF(int64_t);
+    /* Reserve space for the chunk size, without changing data alignment */
+    size = ECS_ALIGN(size, 16) + flecs_balloc_align(size);
 #endif
     ba->chunk_size = ECS_ALIGN(size, 16);
     ba->chunks_per_block = ECS_MAX(4096 / ba->chunk_size, 1);
@@ -98,6 +119,132 @@ void flecs_ballocator_free(
     ecs_os_free(ba);
 }
 
+typedef struct flecs_block_free_t {
+    uintptr_t memory;
+    int32_t free_count;
+} flecs_block_free_t;
+
+static
+int flecs_block_free_compare(
+    const void *ptr_1,
+    const void *ptr_2)
+{
+    uintptr_t b_1 = ((const flecs_block_free_t*)ptr_1)->memory;
+    uintptr_t b_2 = ((const flecs_block_free_t*)ptr_2)->memory;
+    return (b_1 > b_2) - (b_1 < b_2);
+}
+
+/* Find block that contains chunk in array sorted by memory address */
+static
+flecs_block_free_t* flecs_block_free_find(
+    flecs_block_free_t *blocks,
+    int32_t count,
+    ecs_size_t block_size,
+    const void *chunk)
+{
+    uintptr_t addr = (uintptr_t)chunk;
+    int32_t lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        uintptr_t start = blocks[mid].memory;
+        if (addr < start) {
+            hi = mid - 1;
+        } else if (addr >= (start + (uintptr_t)block_size)) {
+            lo = mid + 1;
+        } else {
+            return &blocks[mid];
+        }
+    }
+    return NULL;
+}
+
+int64_t flecs_ballocator_trim(
+    ecs_block_allocator_t *ba)
+{
+    ecs_assert(ba != NULL, ECS_INTERNAL_ERROR, NULL);
+
+#ifdef FLECS_USE_OS_ALLOC
+    return 0;
+#endif
+
+    if (!ba->head) {
+        return 0; /* No free chunks */
+    }
+
+    int32_t i, block_count = 0;
+    ecs_block_allocator_block_t *block;
+    for (block = ba->block_head; block; block = block->next) {
+        block_count ++;
+    }
+
+    flecs_block_free_t *blocks = ecs_os_malloc_n(
+        flecs_block_free_t, block_count);
+    for (i = 0, block = ba->block_head; block; block = block->next, i ++) {
+        blocks[i].memory = (uintptr_t)block->memory;
+        blocks[i].free_count = 0;
+    }
+
+    ecs_qsort_t(blocks, block_count, flecs_block_free_t, 
+        flecs_block_free_compare);
+
+    /* Count free chunks per block */
+    ecs_block_allocator_chunk_header_t *chunk;
+    for (chunk = ba->head; chunk; chunk = chunk->next) {
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, chunk);
+        ecs_assert(bf != NULL, ECS_INTERNAL_ERROR, NULL);
+        bf->free_count ++;
+    }
+
+    int32_t release_count = 0;
+    for (i = 0; i < block_count; i ++) {
+        ecs_assert(blocks[i].free_count <= ba->chunks_per_block, 
+            ECS_INTERNAL_ERROR, NULL);
+        release_count += blocks[i].free_count == ba->chunks_per_block;
+    }
+
+    if (!release_count) {
+        ecs_os_free(blocks);
+        return 0;
+    }
+
+    /* Remove chunks of released blocks from the free list */
+    ecs_block_allocator_chunk_header_t **prev = &ba->head;
+    for (chunk = ba->head; chunk; chunk = chunk->next) {
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, chunk);
+        if (bf->free_count != ba->chunks_per_block) {
+            *prev = chunk;
+            prev = &chunk->next;
+        }
+    }
+    *prev = NULL;
+
+    /* Unlink & free released blocks */
+    ecs_block_allocator_block_t **prev_block = &ba->block_head;
+    ecs_block_allocator_block_t *next;
+    ba->block_tail = NULL;
+    for (block = ba->block_head; block; block = next) {
+        next = block->next;
+        flecs_block_free_t *bf = flecs_block_free_find(
+            blocks, block_count, ba->block_size, block->memory);
+        if (bf->free_count == ba->chunks_per_block) {
+            ecs_os_free(block);
+            ecs_os_linc(&ecs_block_allocator_free_count);
+        } else {
+            *prev_block = block;
+            prev_block = &block->next;
+            ba->block_tail = block;
+        }
+    }
+    *prev_block = NULL;
+
+    ecs_os_free(blocks);
+
+    return (int64_t)release_count * (ECS_SIZEOF(ecs_block_allocator_block_t) +
+        ba->block_size + flecs_balloc_align(ba->data_size));
+}
+
 void* flecs_balloc(
     ecs_block_allocator_t *ba) 
 {
@@ -118,7 +265,7 @@ void* flecs_balloc(
     ecs_assert(ba->alloc_count >= 0, ECS_INTERNAL_ERROR, "corrupted allocator");
     ba->alloc_count ++;
     *(int64_t*)result = ba->chunk_size;
-    result = ECS_OFFSET(result, ECS_SIZEOF(int64_t));
+    result = ECS_OFFSET(result, flecs_balloc_align(ba->data_size));
     ecs_os_memset(result, 0xAA, ba->data_size);
 #endif
 
@@ -156,7 +303,7 @@ void flecs_bfree(
     }
 
 #ifdef FLECS_SANITIZE
-    memory = ECS_OFFSET(memory, -ECS_SIZEOF(int64_t));
+    memory = ECS_OFFSET(memory, -flecs_balloc_align(ba->data_size));
     if (*(int64_t*)memory != ba->chunk_size) {
         ecs_err("chunk %p returned to wrong allocator "
             "(chunk = %ub, allocator = %ub)",
@@ -5,12 +5,24 @@
  * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
 #define LOAD_FACTOR (1.2f)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
-#define GET_ELEM(array, elem_size, index) \
-    ECS_OFFSET(array, (elem_size) * (index))
+
+/* Number of control bytes that are tested at the same time. The control array
+ * has GROUP_SIZE cloned bytes at the end, so that a group can be loaded from
+ * any slot without wrapping around. This requires the map to have at least
+ * GROUP_SIZE slots. */
+#define GROUP_SIZE (8)
+
+/* Control byte values. Full slots store the 7 bits of the hash (h2) that were
+ * not used to compute the slot, so the most significant bit is never set. */
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+
+#define GROUP_LSBS (0x0101010101010101ull)
+#define GROUP_MSBS (0x8080808080808080ull)
 
 static
 uint8_t ecs_log2(uint32_t v) {
-    static const uint8_t log2table[32] = 
+    static const uint8_t log2table[32] =
         {0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
          8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31};
 
@@ -22,6 +34,70 @@ uint8_t ecs_log2(uint32_t v) {
     return log2table[(uint32_t)(v * 0x07C4ACDDU) >> 27];
 }
 
+/* Get index of lowest set bit in group mask, divided by 8 (the byte index) */
+static
+int32_t flecs_map_group_first(
+    uint64_t mask)
+{
+    ecs_assert(mask != 0, ECS_INTERNAL_ERROR, NULL);
+    return flecs_ctz64(mask) >> 3;
+}
+
+/* Get index of highest set byte in group mask */
+static
+int32_t flecs_map_group_last(
+    uint64_t mask)
+{
+    ecs_assert(mask != 0, ECS_INTERNAL_ERROR, NULL);
+    int32_t result = GROUP_SIZE - 1;
+    while (!(mask & (0x80ull << (result * 8)))) {
+        result --;
+    }
+    return result;
+}
+
+/* Load group of control bytes, with the first byte in the least significant
+ * byte of the result */
+static
+uint64_t flecs_map_group_load(
+    const uint8_t *ctrl)
+{
+    uint64_t result;
+    ecs_os_memcpy(&result, ctrl, ECS_SIZEOF(uint64_t));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+/* Return mask with the msb set for each control byte that matches h2. This can
+ * return false positives for a byte that follows a match, which is fine as the
+ * key of each candidate slot is compared. */
+static
+uint64_t flecs_map_group_match(
+    uint64_t group,
+    uint64_t h2)
+{
+    uint64_t x = group ^ (GROUP_LSBS * h2);
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+/* Return mask with the msb set for each empty control byte */
+static
+uint64_t flecs_map_group_empty(
+    uint64_t group)
+{
+    return (group & (~group << 6)) & GROUP_MSBS;
+}
+
+/* Return mask with the msb set for each empty or deleted control byte */
+static
+uint64_t flecs_map_group_empty_or_deleted(
+    uint64_t group)
+{
+    return (group & ~(group << 7)) & GROUP_MSBS;
+}
+
 /* Get bucket count for number of elements */
 static
 int32_t get_bucket_count(
@@ -38,204 +114,298 @@ uint8_t get_bucket_shift (
     return (uint8_t)(64u - ecs_log2((uint32_t)bucket_count));
 }
 
-/* Get bucket index for provided map key */
+/* Get hash for provided map key. The most significant bits are used for the
+ * slot index, the 7 bits after that are stored in the control byte. */
 static
-int32_t get_bucket_index(
-    uint16_t bucket_shift,
-    ecs_map_key_t key) 
+uint64_t flecs_map_hash(
+    ecs_map_key_t key)
 {
-    ecs_assert(bucket_shift != 0, ECS_INTERNAL_ERROR, NULL);
-    return (int32_t)((11400714819323198485ull * key) >> bucket_shift);
+    return 11400714819323198485ull * key;
 }
 
-/* Get bucket for key */
 static
-ecs_bucket_t* flecs_map_get_bucket(
+int32_t flecs_map_h1(
     const ecs_map_t *map,
-    ecs_map_key_t key)
+    uint64_t hash)
 {
     ecs_assert(map->bucket_shift == get_bucket_shift(map->bucket_count),
         ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map->bucket_shift, key);
-    ecs_assert(bucket_id < map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (int32_t)(hash >> map->bucket_shift);
 }
 
-/* Ensure that map has at least new_count buckets */
 static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
+uint8_t flecs_map_h2(
+    const ecs_map_t *map,
+    uint64_t hash)
 {
-    int32_t bucket_count = map->bucket_count;
-    new_count = flecs_next_pow_of_2(new_count);
-    if (new_count < 2) {
-        new_count = 2;
-    }
+    return (uint8_t)((hash >> (map->bucket_shift - 7)) & 0x7F);
+}
 
-    if (new_count && new_count > bucket_count) {
-        if (map->allocator) {
-            map->buckets = flecs_realloc_n(map->allocator, ecs_bucket_t,
-                new_count, bucket_count, map->buckets);
-        } else {
-            map->buckets = ecs_os_realloc_n(
-                map->buckets, ecs_bucket_t, new_count);
-        }
+static
+ecs_size_t flecs_map_slot_size(
+    ecs_size_t elem_size)
+{
+    return ECS_ALIGN((KEY_SIZE + elem_size), KEY_SIZE);
+}
 
-        map->buckets_end = ECS_ELEM_T(map->buckets, ecs_bucket_t, new_count);
-        map->bucket_count = new_count;
-        map->bucket_shift = get_bucket_shift(new_count);
-        ecs_os_memset_n(ECS_ELEM_T(map->buckets, ecs_bucket_t, bucket_count),
-            0, ecs_bucket_t, (new_count - bucket_count));
-    }
+static
+ecs_size_t flecs_map_alloc_size(
+    const ecs_map_t *map)
+{
+    int32_t count = map->bucket_count;
+    return (map->slot_size * count) + count + GROUP_SIZE;
 }
 
-/* Free contents of bucket */
 static
-void clear_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_entry_t *bucket)
+ecs_map_key_t* flecs_map_slot(
+    const ecs_map_t *map,
+    int32_t index)
 {
-    while(bucket) {
-      ecs_bucket_entry_t *next = bucket->next;
-      flecs_bfree(allocator, bucket);
-      bucket = next;
-    }
+    return ECS_OFFSET(map->slots, map->slot_size * index);
 }
 
-/* Clear all buckets */
 static
-void clear_buckets(
-    ecs_map_t *map)
+void flecs_map_set_ctrl(
+    ecs_map_t *map,
+    int32_t index,
+    uint8_t ctrl)
 {
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(map->entry_allocator, map->buckets[i].first);
+    map->ctrl[index] = ctrl;
+    if (index < GROUP_SIZE) {
+        /* Update cloned byte */
+        map->ctrl[map->bucket_count + index] = ctrl;
     }
+}
+
+/* Allocate storage for slots and control bytes */
+static
+void flecs_map_alloc(
+    ecs_map_t *map,
+    int32_t bucket_count)
+{
+    ecs_assert(bucket_count >= GROUP_SIZE, ECS_INTERNAL_ERROR, NULL);
+    map->bucket_count = bucket_count;
+    map->bucket_shift = get_bucket_shift(bucket_count);
+    map->deleted = 0;
+
+    ecs_size_t size = flecs_map_alloc_size(map);
     if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, count, map->buckets);
+        map->slots = flecs_alloc(map->allocator, size);
     } else {
-        ecs_os_free(map->buckets);
+        map->slots = ecs_os_malloc(size);
     }
-    map->buckets = NULL;
-    map->bucket_count = 0;
+
+    map->ctrl = ECS_OFFSET(map->slots, map->slot_size * bucket_count);
+    ecs_os_memset(map->ctrl, CTRL_EMPTY, bucket_count + GROUP_SIZE);
 }
 
-/* Add element to bucket */
 static
-void* flecs_map_add_to_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
-    ecs_map_key_t key,
-    const void *payload)
+void flecs_map_free_slots(
+    ecs_map_t *map,
+    void *slots,
+    int32_t bucket_count)
 {
-    ecs_bucket_entry_t *new_entry = flecs_balloc(allocator);
-    new_entry->key = key;
-    new_entry->next = bucket->first;
-    bucket->first = new_entry;
-    void *new_payload = ECS_OFFSET(&new_entry->key, ECS_SIZEOF(ecs_map_key_t));
-    if (elem_size && payload) {
-        ecs_os_memcpy(new_payload, payload, elem_size);
+    if (!slots) {
+        return;
+    }
+
+    ecs_size_t size = (map->slot_size * bucket_count) +
+        bucket_count + GROUP_SIZE;
+    if (map->allocator) {
+        flecs_free(map->allocator, size, slots);
+    } else {
+        ecs_os_free(slots);
     }
-    return new_payload;
 }
 
-/*  Remove element from bucket */
+/* Find first empty or deleted slot for hash. Map must have free slots. */
 static
-bool remove_from_bucket(
-    ecs_block_allocator_t *allocator,
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key)
+int32_t flecs_map_find_free(
+    const ecs_map_t *map,
+    uint64_t hash)
 {
-    ecs_bucket_entry_t *entry;
-    for (entry = bucket->first; entry; entry = entry->next) {
-        if (entry->key == key) {
-            ecs_bucket_entry_t **next_holder = &bucket->first;
-            while(*next_holder != entry) {
-                next_holder = &(*next_holder)->next;
-            }
-            *next_holder = entry->next;
-            flecs_bfree(allocator, entry);
-            return true;
+    int32_t mask = map->bucket_count - 1;
+    int32_t pos = flecs_map_h1(map, hash);
+    int32_t stride = 0;
+
+    while (true) {
+        uint64_t group = flecs_map_group_load(&map->ctrl[pos]);
+        uint64_t free_mask = flecs_map_group_empty_or_deleted(group);
+        if (free_mask) {
+            return (pos + flecs_map_group_first(free_mask)) & mask;
         }
+
+        /* Triangular probing visits every group when the number of slots is
+         * a power of 2 */
+        stride += GROUP_SIZE;
+        pos = (pos + stride) & mask;
+        ecs_assert(stride <= map->bucket_count, ECS_INTERNAL_ERROR, NULL);
     }
-    
-    return false;
 }
 
-/* Get payload pointer for key from bucket */
+/* Find slot index for key, or -1 if key is not in map */
 static
-void* flecs_map_get_from_bucket(
-    ecs_bucket_t *bucket,
+int32_t flecs_map_find(
+    const ecs_map_t *map,
     ecs_map_key_t key)
 {
-    ecs_bucket_entry_t *entry;
-    for (entry = bucket->first; entry; entry = entry->next) {
-        if (entry->key == key) {
-            return ECS_OFFSET(&entry->key, ECS_SIZEOF(ecs_map_key_t));
+    uint64_t hash = flecs_map_hash(key);
+    uint64_t h2 = flecs_map_h2(map, hash);
+    int32_t mask = map->bucket_count - 1;
+    int32_t pos = flecs_map_h1(map, hash);
+    int32_t stride = 0;
+
+    while (true) {
+        uint64_t group = flecs_map_group_load(&map->ctrl[pos]);
+        uint64_t match = flecs_map_group_match(group, h2);
+        while (match) {
+            int32_t index = (pos + flecs_map_group_first(match)) & mask;
+            if (flecs_map_slot(map, index)[0] == key) {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        /* An empty slot terminates the probe sequence */
+        if (flecs_map_group_empty(group)) {
+            return -1;
+        }
+
+        stride += GROUP_SIZE;
+        pos = (pos + stride) & mask;
+        if (stride > map->bucket_count) {
+            return -1;
         }
     }
-    
-    return NULL;
 }
 
-/* Grow number of buckets */
+/* Resize slot array, reinsert elements and drop deleted slots */
 static
 void flecs_map_rehash(
     ecs_map_t *map,
     int32_t bucket_count)
 {
     ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    
+
     int32_t old_count = map->bucket_count;
-    ecs_bucket_t *old_buckets = map->buckets;
-    
+    uint8_t *old_ctrl = map->ctrl;
+    void *old_slots = map->slots;
+
     int32_t new_count = flecs_next_pow_of_2(bucket_count);
-    map->bucket_count = new_count;
-    map->bucket_shift = get_bucket_shift(new_count);
-    if (map->allocator) {
-        map->buckets = flecs_calloc_n(map->allocator, ecs_bucket_t, new_count);
-    } else {
-        map->buckets = ecs_os_calloc_n(ecs_bucket_t, new_count);
+    int32_t min_count = get_bucket_count(map->count);
+    if (new_count < min_count) {
+        new_count = min_count;
     }
-    map->buckets_end = ECS_ELEM_T(map->buckets, ecs_bucket_t, new_count);
+    if (new_count < GROUP_SIZE) {
+        new_count = GROUP_SIZE;
+    }
+
+    flecs_map_alloc(map, new_count);
 
-    /* Remap old bucket entries to new buckets */
+    /* Reinsert old slots */
+    ecs_size_t slot_size = map->slot_size;
     int32_t index;
     for (index = 0; index < old_count; ++index) {
-        ecs_bucket_entry_t* entry;
-        for (entry = old_buckets[index].first; entry;) {
-            ecs_bucket_entry_t* next = entry->next;
-            int32_t bucket_index = get_bucket_index(
-                map->bucket_shift, entry->key);
-            ecs_bucket_t *bucket = &map->buckets[bucket_index];
-            entry->next = bucket->first;
-            bucket->first = entry;
-            entry = next;
+        if (old_ctrl[index] & CTRL_EMPTY) {
+            continue; /* Empty or deleted */
         }
-    }
 
-    if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, old_count, old_buckets);
-    } else {
-        ecs_os_free(old_buckets);
+        ecs_map_key_t *old_slot = ECS_OFFSET(old_slots, slot_size * index);
+        uint64_t hash = flecs_map_hash(old_slot[0]);
+        int32_t new_index = flecs_map_find_free(map, hash);
+        flecs_map_set_ctrl(map, new_index, flecs_map_h2(map, hash));
+        ecs_os_memcpy(flecs_map_slot(map, new_index), old_slot, slot_size);
     }
+
+    flecs_map_free_slots(map, old_slots, old_count);
 }
 
-bool ecs_map_is_initialized(
-    const ecs_map_t *result)
+/* Get index of probe group for slot, relative to the start of the probe */
+static
+int32_t flecs_map_probe_index(
+    const ecs_map_t *map,
+    int32_t index,
+    uint64_t hash)
 {
-    return result != NULL && result->bucket_count != 0;
+    int32_t mask = map->bucket_count - 1;
+    return ((index - flecs_map_h1(map, hash)) & mask) / GROUP_SIZE;
 }
 
 static
-ecs_size_t flecs_map_chunk_size(
-    ecs_size_t size)
+void flecs_map_swap_slots(
+    ecs_map_t *map,
+    int32_t index_a,
+    int32_t index_b)
+{
+    uint8_t *a = (uint8_t*)flecs_map_slot(map, index_a);
+    uint8_t *b = (uint8_t*)flecs_map_slot(map, index_b);
+    ecs_size_t i, size = map->slot_size;
+    for (i = 0; i < size; i ++) {
+        uint8_t tmp = a[i];
+        a[i] = b[i];
+        b[i] = tmp;
+    }
+}
+
+/* Remove deleted slots without resizing the map. This avoids allocating a new
+ * slot array for maps that have many removes & inserts, but don't grow. */
+static
+void flecs_map_drop_deleted(
+    ecs_map_t *map)
+{
+    int32_t index, count = map->bucket_count;
+    uint8_t *ctrl = map->ctrl;
+
+    /* Mark deleted slots as empty, and full slots as deleted. Slots that are
+     * marked as deleted still need to be moved to their new position. */
+    for (index = 0; index < count; index ++) {
+        ctrl[index] = (ctrl[index] & CTRL_EMPTY) ? CTRL_EMPTY : CTRL_DELETED;
+    }
+    ecs_os_memcpy(&ctrl[count], ctrl, GROUP_SIZE);
+
+    for (index = 0; index < count; index ++) {
+        if (ctrl[index] != CTRL_DELETED) {
+            continue;
+        }
+
+        ecs_map_key_t *slot = flecs_map_slot(map, index);
+        uint64_t hash = flecs_map_hash(slot[0]);
+        uint8_t h2 = flecs_map_h2(map, hash);
+        int32_t new_index = flecs_map_find_free(map, hash);
+
+        /* If the slot is in the same probe group as the new slot, there is no
+         * need to move it. */
+        if (flecs_map_probe_index(map, index, hash) == 
+            flecs_map_probe_index(map, new_index, hash)) 
+        {
+            flecs_map_set_ctrl(map, index, h2);
+            continue;
+        }
+
+        if (ctrl[new_index] == CTRL_EMPTY) {
+            /* Move slot to empty position */
+            flecs_map_set_ctrl(map, new_index, h2);
+            ecs_os_memcpy(flecs_map_slot(map, new_index), slot, 
+                map->slot_size);
+            flecs_map_set_ctrl(map, index, CTRL_EMPTY);
+        } else {
+            /* Target slot still needs to be moved, swap & process current 
+             * slot again. */
+            ecs_assert(ctrl[new_index] == CTRL_DELETED, 
+                ECS_INTERNAL_ERROR, NULL);
+            flecs_map_set_ctrl(map, new_index, h2);
+            flecs_map_swap_slots(map, index, new_index);
+            index --;
+        }
+    }
+
+    map->deleted = 0;
+}
+
+bool ecs_map_is_initialized(
+    const ecs_map_t *result)
 {
-    int32_t entry_size = size + ECS_SIZEOF(ecs_bucket_entry_t);
-    return ECS_MAX(entry_size, ECS_SIZEOF(ecs_block_allocator_chunk_header_t));
+    return result != NULL && result->bucket_count != 0;
 }
 
 void _ecs_map_params_init(
@@ -245,14 +415,13 @@ void _ecs_map_params_init(
 {
     params->size = size;
     params->allocator = allocator;
-    flecs_ballocator_init(&params->entry_allocator,
-        flecs_map_chunk_size(size));
+    params->initial_count = 0;
 }
 
 void ecs_map_params_fini(
     ecs_map_params_t *params)
 {
-    flecs_ballocator_fini(&params->entry_allocator);
+    (void)params;
 }
 
 void _ecs_map_init_w_params(
@@ -263,17 +432,15 @@ void _ecs_map_init_w_params(
 
     result->count = 0;
     result->elem_size = flecs_ito(int16_t, params->size);
+    result->slot_size = flecs_ito(int16_t, flecs_map_slot_size(params->size));
     result->allocator = params->allocator;
 
-    if (params->entry_allocator.chunk_size) {
-        result->entry_allocator = &params->entry_allocator;
-        result->shared_allocator = true;
-    } else {
-        result->entry_allocator = flecs_ballocator_new(
-            flecs_map_chunk_size(params->size));
+    int32_t bucket_count = get_bucket_count(params->initial_count);
+    if (bucket_count < GROUP_SIZE) {
+        bucket_count = GROUP_SIZE;
     }
 
-    ensure_buckets(result, get_bucket_count(params->initial_count));
+    flecs_map_alloc(result, bucket_count);
 }
 
 void _ecs_map_init_w_params_if(
@@ -281,7 +448,7 @@ void _ecs_map_init_w_params_if(
     ecs_map_params_t *params)
 {
     if (ecs_map_is_initialized(result)) {
-        ecs_assert(params->size == result->elem_size, 
+        ecs_assert(params->size == result->elem_size,
             ECS_INVALID_PARAMETER, NULL);
         return;
     }
@@ -331,40 +498,12 @@ void ecs_map_fini(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-#ifdef FLECS_SANITIZE
-    bool sanitize = true;
-#else
-    bool sanitize = false;
-#endif
-
-    /* Free buckets in sanirized mode, so we can replace the allocator with
-     * regular malloc/free and use asan/valgrind to find memory errors. */
-    if (map->shared_allocator || sanitize) {
-        ecs_bucket_t *bucket = map->buckets;
-        while ((bucket != map->buckets_end)) {
-            ecs_bucket_entry_t *entry = bucket->first;
-            while (entry) {
-                ecs_bucket_entry_t *next = entry->next;
-                flecs_bfree(map->entry_allocator, entry);
-                entry = next;
-            }
-            bucket ++;
-        }
-    }
-
-    if (map->entry_allocator && !map->shared_allocator) {
-        flecs_ballocator_free(map->entry_allocator);
-        map->entry_allocator = NULL;
-    }
-    if (map->allocator) {
-        flecs_free_n(map->allocator, ecs_bucket_t, map->bucket_count, 
-            map->buckets);
-    } else {
-        ecs_os_free(map->buckets);
-    }
-    map->buckets = NULL;
-    map->buckets_end = NULL;
+    flecs_map_free_slots(map, map->slots, map->bucket_count);
+    map->slots = NULL;
+    map->ctrl = NULL;
     map->bucket_count = 0;
+    map->count = 0;
+    map->deleted = 0;
     ecs_assert(!ecs_map_is_initialized(map), ECS_INTERNAL_ERROR, NULL);
 }
 
@@ -390,9 +529,12 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
+    int32_t index = flecs_map_find(map, key);
+    if (index == -1) {
+        return NULL;
+    }
 
-    return flecs_map_get_from_bucket(bucket, key);
+    return ECS_OFFSET(flecs_map_slot(map, index), KEY_SIZE);
 }
 
 void* _ecs_map_get_ptr(
@@ -416,9 +558,7 @@ bool ecs_map_has(
         return false;
     }
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-
-    return flecs_map_get_from_bucket(bucket, key) != NULL;
+    return flecs_map_find(map, key) != -1;
 }
 
 void* _ecs_map_ensure(
@@ -446,30 +586,44 @@ void* _ecs_map_set(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ecs_map_is_initialized(map), ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-
-    void *elem = flecs_map_get_from_bucket(bucket, key);
-    if (!elem) {
-        void *added_data = flecs_map_add_to_bucket(
-            map->entry_allocator, bucket, elem_size, key, payload);
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            flecs_map_rehash(map, target_bucket_count);
-            bucket = flecs_map_get_bucket(map, key);
-            added_data = flecs_map_get_from_bucket(bucket, key);
-            ecs_assert(added_data != NULL, ECS_INVALID_PARAMETER, NULL);
-        }
-        return added_data;
-    } else {
+    int32_t index = flecs_map_find(map, key);
+    if (index != -1) {
+        void *elem = ECS_OFFSET(flecs_map_slot(map, index), KEY_SIZE);
         if (payload) {
             ecs_os_memcpy(elem, payload, elem_size);
         }
         return elem;
     }
+
+    /* Deleted slots are part of the load, as they don't terminate a probe
+     * sequence. If there are too many, rehash (and grow if necessary). */
+    int32_t load = map->count + map->deleted + 1;
+    if (get_bucket_count(load) > map->bucket_count) {
+        int32_t bucket_count = get_bucket_count(map->count + 1);
+        if (bucket_count > map->bucket_count) {
+            flecs_map_rehash(map, bucket_count);
+        } else {
+            flecs_map_drop_deleted(map);
+        }
+    }
+
+    uint64_t hash = flecs_map_hash(key);
+    index = flecs_map_find_free(map, hash);
+    map->deleted -= map->ctrl[index] == CTRL_DELETED;
+    flecs_map_set_ctrl(map, index, flecs_map_h2(map, hash));
+    map->count ++;
+
+    ecs_map_key_t *slot = flecs_map_slot(map, index);
+    slot[0] = key;
+
+    void *elem = ECS_OFFSET(slot, KEY_SIZE);
+    if (elem_size && payload) {
+        ecs_os_memcpy(elem, payload, elem_size);
+    }
+
+    return elem;
 }
 
 int32_t ecs_map_remove(
@@ -478,12 +632,35 @@ int32_t ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = flecs_map_get_bucket(map, key);
-    if (remove_from_bucket(map->entry_allocator, bucket, key)) {
-        return --map->count;
+    if (!ecs_map_is_initialized(map)) {
+        return 0;
+    }
+
+    int32_t index = flecs_map_find(map, key);
+    if (index == -1) {
+        return map->count;
+    }
+
+    /* If every group that contains the slot also contains an empty slot, no
+     * probe sequence could have passed over the slot while it was full, and it
+     * can be marked as empty. Otherwise the slot is marked as deleted, so that
+     * probe sequences continue past it. */
+    int32_t mask = map->bucket_count - 1;
+    uint64_t empty_after = flecs_map_group_empty(
+        flecs_map_group_load(&map->ctrl[index]));
+    uint64_t empty_before = flecs_map_group_empty(
+        flecs_map_group_load(&map->ctrl[(index - GROUP_SIZE) & mask]));
+    if (empty_after && empty_before && 
+       ((flecs_map_group_first(empty_after) + 
+         (GROUP_SIZE - 1 - flecs_map_group_last(empty_before))) < GROUP_SIZE))
+    {
+        flecs_map_set_ctrl(map, index, CTRL_EMPTY);
+    } else {
+        flecs_map_set_ctrl(map, index, CTRL_DELETED);
+        map->deleted ++;
     }
-    
-    return map->count;
+
+    return --map->count;
 }
 
 int32_t ecs_map_count(
@@ -502,9 +679,9 @@ void ecs_map_clear(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    clear_buckets(map);
+    flecs_map_free_slots(map, map->slots, map->bucket_count);
     map->count = 0;
-    ensure_buckets(map, 2);
+    flecs_map_alloc(map, GROUP_SIZE);
 }
 
 ecs_map_iter_t ecs_map_iter(
@@ -512,8 +689,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .entry = NULL
+        .index = 0
     };
 }
 
@@ -527,46 +703,29 @@ void* _ecs_map_next(
     if (!ecs_map_is_initialized(map)) {
         return NULL;
     }
-    if (iter->bucket == map->buckets_end) {
-        return NULL;
-    }
 
-    ecs_assert(!elem_size || elem_size == map->elem_size, 
+    ecs_assert(!elem_size || elem_size == map->elem_size,
         ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_entry_t *entry = NULL;
-    
-    if (!iter->bucket) {
-        for (iter->bucket = map->buckets; 
-            iter->bucket != map->buckets_end; 
-            ++iter->bucket) 
-        {
-            if (iter->bucket->first) {
-                entry = iter->bucket->first;
-                break;
-            }
-        }
-        if (iter->bucket == map->buckets_end) {
-            return NULL;
-        }
-    } else if ((entry = iter->entry) == NULL) {
-        do {
-            ++iter->bucket;
-            if (iter->bucket == map->buckets_end) {
-                return NULL;
-            }
-        } while(!iter->bucket->first);
-        entry = iter->bucket->first;
+    const uint8_t *ctrl = map->ctrl;
+    int32_t index = iter->index, count = map->bucket_count;
+    while (index < count && (ctrl[index] & CTRL_EMPTY)) {
+        index ++; /* Skip empty & deleted slots */
     }
-    
-    if (key_out) {
-        ecs_assert(entry != NULL, ECS_INTERNAL_ERROR, NULL);
-        *key_out = entry->key;
+
+    if (index >= count) {
+        iter->index = count;
+        return NULL;
     }
 
-    iter->entry = entry->next;
+    iter->index = index + 1;
+
+    ecs_map_key_t *slot = flecs_map_slot(map, index);
+    if (key_out) {
+        *key_out = slot[0];
+    }
 
-    return ECS_OFFSET(&entry->key, ECS_SIZEOF(ecs_map_key_t));
+    return ECS_OFFSET(slot, KEY_SIZE);
 }
 
 void* _ecs_map_next_ptr(
@@ -582,7 +741,7 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -595,9 +754,9 @@ void ecs_map_grow(
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t bucket_count = get_bucket_count(element_count);
 
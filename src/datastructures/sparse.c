@@ -381,6 +381,43 @@ void flecs_sparse_clear(
     sparse->max_id_local = 0;
 }
 
+void flecs_sparse_shrink(
+    ecs_sparse_t *sparse)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    /* Free chunks that don't have any paired elements */
+    int32_t i, count = ecs_vector_count(sparse->chunks);
+    int32_t last = 0;
+    chunk_t *chunks = ecs_vector_first(sparse->chunks, chunk_t);
+    for (i = 0; i < count; i ++) {
+        chunk_t *chunk = &chunks[i];
+        int32_t *indices = chunk->sparse;
+        if (!indices) {
+            continue;
+        }
+
+        int32_t j;
+        for (j = 0; j < FLECS_SPARSE_CHUNK_SIZE; j ++) {
+            if (indices[j]) {
+                break;
+            }
+        }
+
+        if (j == FLECS_SPARSE_CHUNK_SIZE) {
+            flecs_sparse_chunk_free(sparse, chunk);
+            chunk->sparse = NULL;
+            chunk->data = NULL;
+        } else {
+            last = i + 1;
+        }
+    }
+
+    ecs_vector_set_count(&sparse->chunks, chunk_t, last);
+    ecs_vector_reclaim(&sparse->chunks, chunk_t);
+    ecs_vector_reclaim(&sparse->dense, uint64_t);
+}
+
 void _flecs_sparse_fini(
     ecs_sparse_t *sparse)
 {
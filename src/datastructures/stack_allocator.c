@@ -112,6 +112,34 @@ void flecs_stack_reset(
     stack->first.sp = 0;
 }
 
+int64_t flecs_stack_trim(
+    ecs_stack_t *stack)
+{
+    /* Only release pages if nothing is allocated from the stack */
+    if (stack->cur != &stack->first || stack->first.sp) {
+        return 0;
+    }
+
+    int64_t result = 0;
+    ecs_stack_page_t *next, *cur = stack->first.next;
+    for (; cur; cur = next) {
+        next = cur->next;
+        ecs_os_linc(&ecs_stack_allocator_free_count);
+        ecs_os_free(cur);
+        result += FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE;
+    }
+
+    if (stack->first.data) {
+        ecs_os_linc(&ecs_stack_allocator_free_count);
+        ecs_os_free(stack->first.data);
+        result += ECS_STACK_PAGE_SIZE;
+    }
+
+    stack->first.next = NULL;
+    stack->first.data = NULL;
+    return result;
+}
+
 void flecs_stack_init(
     ecs_stack_t *stack)
 {
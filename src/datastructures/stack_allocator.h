@@ -53,6 +53,9 @@ void flecs_stack_free(
 void flecs_stack_reset(
     ecs_stack_t *stack);
 
+int64_t flecs_stack_trim(
+    ecs_stack_t *stack);
+
 ecs_stack_cursor_t flecs_stack_get_cursor(
     ecs_stack_t *stack);
 
@@ -1,27 +1,28 @@
 #include "../private_api.h"
 
 #ifdef FLECS_SANITIZE
-static 
-void verify_nodes(
+static
+void verify_elements(
+    const ecs_switch_t *sw,
     ecs_switch_header_t *hdr,
-    ecs_switch_node_t *nodes)
+    uint64_t value)
 {
     if (!hdr) {
         return;
     }
 
-    int32_t prev = -1, elem = hdr->element, count = 0;
-    while (elem != -1) {
-        ecs_assert(prev == nodes[elem].prev, ECS_INTERNAL_ERROR, NULL);
-        prev = elem;
-        elem = nodes[elem].next;
-        count ++;
+    ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    uint64_t *values = ecs_vec_first(&sw->values);
+    int32_t *elements = ecs_vec_first(&hdr->elements);
+    int32_t i, count = ecs_vec_count(&hdr->elements);
+    for (i = 0; i < count; i ++) {
+        int32_t elem = elements[i];
+        ecs_assert(nodes[elem].index == i, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(values[elem] == value, ECS_INTERNAL_ERROR, NULL);
     }
-
-    ecs_assert(count == hdr->count, ECS_INTERNAL_ERROR, NULL);
 }
 #else
-#define verify_nodes(hdr, nodes)
+#define verify_elements(sw, hdr, value)
 #endif
 
 static
@@ -45,50 +46,61 @@ ecs_switch_header_t *ensure_header(
         return NULL;
     }
 
-    ecs_switch_header_t *node = get_header(sw, value);
-    if (!node) {
-        node = ecs_map_ensure(&sw->hdrs, ecs_switch_header_t, value);
-        node->element = -1;
+    ecs_switch_header_t *hdr = get_header(sw, value);
+    if (!hdr) {
+        hdr = ecs_map_ensure(&sw->hdrs, ecs_switch_header_t, value);
+        ecs_vec_init_t(sw->hdrs.allocator, &hdr->elements, int32_t, 0);
     }
 
-    return node;
+    return hdr;
 }
 
+/* Remove element from the elements of a value. The last element is moved into
+ * the slot of the removed element. */
 static
-void remove_node(
+void remove_element(
     ecs_switch_header_t *hdr,
     ecs_switch_node_t *nodes,
-    ecs_switch_node_t *node,
     int32_t element)
 {
-    ecs_assert(&nodes[element] == node, ECS_INTERNAL_ERROR, NULL);
-
-    /* Update previous node/header */
-    if (hdr->element == element) {
-        ecs_assert(node->prev == -1, ECS_INVALID_PARAMETER, NULL);
-        /* If this is the first node, update the header */
-        hdr->element = node->next;
-    } else {
-        /* If this is not the first node, update the previous node to the 
-         * removed node's next ptr */
-        ecs_assert(node->prev != -1, ECS_INVALID_PARAMETER, NULL);
-        ecs_switch_node_t *prev_node = &nodes[node->prev];
-        prev_node->next = node->next;
+    int32_t index = nodes[element].index;
+    int32_t *elements = ecs_vec_first(&hdr->elements);
+    int32_t last = ecs_vec_count(&hdr->elements) - 1;
+    ecs_assert(index <= last, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(elements[index] == element, ECS_INTERNAL_ERROR, NULL);
+
+    if (index != last) {
+        int32_t moved = elements[last];
+        elements[index] = moved;
+        nodes[moved].index = index;
     }
 
-    /* Update next node */
-    int32_t next = node->next;
-    if (next != -1) {
-        ecs_assert(next >= 0, ECS_INVALID_PARAMETER, NULL);
-        /* If this is not the last node, update the next node to point to the
-         * removed node's prev ptr */
-        ecs_switch_node_t *next_node = &nodes[next];
-        next_node->prev = node->prev;
-    }
+    ecs_vec_remove_last(&hdr->elements);
+    nodes[element].index = -1;
+}
 
-    /* Decrease count of current header */
-    hdr->count --;
-    ecs_assert(hdr->count >= 0, ECS_INTERNAL_ERROR, NULL);
+static
+void add_element(
+    ecs_switch_t *sw,
+    ecs_switch_header_t *hdr,
+    ecs_switch_node_t *nodes,
+    int32_t element)
+{
+    nodes[element].index = ecs_vec_count(&hdr->elements);
+    int32_t *elem = ecs_vec_append_t(
+        sw->hdrs.allocator, &hdr->elements, int32_t);
+    *elem = element;
+}
+
+static
+void fini_headers(
+    ecs_switch_t *sw)
+{
+    ecs_map_iter_t it = ecs_map_iter(&sw->hdrs);
+    ecs_switch_header_t *hdr;
+    while ((hdr = ecs_map_next(&it, ecs_switch_header_t, NULL))) {
+        ecs_vec_fini_t(sw->hdrs.allocator, &hdr->elements, int32_t);
+    }
 }
 
 void flecs_switch_init(
@@ -105,8 +117,7 @@ void flecs_switch_init(
 
     int i;
     for (i = 0; i < elements; i ++) {
-        nodes[i].prev = -1;
-        nodes[i].next = -1;
+        nodes[i].index = -1;
         values[i] = 0;
     }
 }
@@ -114,6 +125,7 @@ void flecs_switch_init(
 void flecs_switch_clear(
     ecs_switch_t *sw)
 {
+    fini_headers(sw);
     ecs_map_clear(&sw->hdrs);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->nodes, ecs_switch_node_t);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->values, uint64_t);
@@ -122,6 +134,7 @@ void flecs_switch_clear(
 void flecs_switch_fini(
     ecs_switch_t *sw)
 {
+    fini_headers(sw);
     ecs_map_fini(&sw->hdrs);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->nodes, ecs_switch_node_t);
     ecs_vec_fini_t(sw->hdrs.allocator, &sw->values, uint64_t);
@@ -130,12 +143,11 @@ void flecs_switch_fini(
 void flecs_switch_add(
     ecs_switch_t *sw)
 {
-    ecs_switch_node_t *node = ecs_vec_append_t(sw->hdrs.allocator, 
+    ecs_switch_node_t *node = ecs_vec_append_t(sw->hdrs.allocator,
         &sw->nodes, ecs_switch_node_t);
-    uint64_t *value = ecs_vec_append_t(sw->hdrs.allocator, 
+    uint64_t *value = ecs_vec_append_t(sw->hdrs.allocator,
         &sw->values, uint64_t);
-    node->prev = -1;
-    node->next = -1;
+    node->index = -1;
     *value = 0;
 }
 
@@ -156,9 +168,7 @@ void flecs_switch_set_count(
 
     int32_t i;
     for (i = old_count; i < count; i ++) {
-        ecs_switch_node_t *node = &nodes[i];
-        node->prev = -1;
-        node->next = -1;
+        nodes[i].index = -1;
         values[i] = 0;
     }
 }
@@ -210,39 +220,26 @@ void flecs_switch_set(
     }
 
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
-    ecs_switch_node_t *node = &nodes[element];
 
+    /* Get dst header first, as ensuring a header can move existing headers */
     ecs_switch_header_t *dst_hdr = ensure_header(sw, value);
     ecs_switch_header_t *cur_hdr = get_header(sw, cur_value);
 
-    verify_nodes(cur_hdr, nodes);
-    verify_nodes(dst_hdr, nodes);
+    verify_elements(sw, cur_hdr, cur_value);
+    verify_elements(sw, dst_hdr, value);
 
     /* If value is not 0, and dst_hdr is NULL, then this is not a valid value
      * for this switch */
     ecs_assert(dst_hdr != NULL || !value, ECS_INVALID_PARAMETER, NULL);
 
     if (cur_hdr) {
-        remove_node(cur_hdr, nodes, node, element);
+        remove_element(cur_hdr, nodes, element);
     }
 
-    /* Now update the node itself by adding it as the first node of dst */
-    node->prev = -1;
     values[element] = value;
 
     if (dst_hdr) {
-        node->next = dst_hdr->element;
-
-        /* Also update the dst header */
-        int32_t first = dst_hdr->element;
-        if (first != -1) {
-            ecs_assert(first >= 0, ECS_INTERNAL_ERROR, NULL);
-            ecs_switch_node_t *first_node = &nodes[first];
-            first_node->prev = element;
-        }
-
-        dst_hdr->element = element;
-        dst_hdr->count ++;        
+        add_element(sw, dst_hdr, nodes, element);
     }
 }
 
@@ -257,36 +254,25 @@ void flecs_switch_remove(
     uint64_t *values = ecs_vec_first(&sw->values);
     uint64_t value = values[elem];
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
-    ecs_switch_node_t *node = &nodes[elem];
 
-    /* If node is currently assigned to a case, remove it from the list */
+    /* If element is currently assigned to a value, remove it from the list */
     if (value != 0) {
         ecs_switch_header_t *hdr = get_header(sw, value);
         ecs_assert(hdr != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        verify_nodes(hdr, nodes);
-        remove_node(hdr, nodes, node, elem);
+        verify_elements(sw, hdr, value);
+        remove_element(hdr, nodes, elem);
     }
 
+    /* The last element is moved into the slot of the removed element, so
+     * update the elements of its value. */
     int32_t last_elem = ecs_vec_count(&sw->nodes) - 1;
     if (last_elem != elem) {
-        ecs_switch_node_t *last = ecs_vec_last_t(&sw->nodes, ecs_switch_node_t);
-        int32_t next = last->next, prev = last->prev;
-        if (next != -1) {
-            ecs_switch_node_t *n = &nodes[next];
-            n->prev = elem;
-        }
-
-        if (prev != -1) {
-            ecs_switch_node_t *n = &nodes[prev];
-            n->next = elem;
-        } else {
-            ecs_switch_header_t *hdr = get_header(sw, values[last_elem]);
-            if (hdr && hdr->element != -1) {
-                ecs_assert(hdr->element == last_elem, 
-                    ECS_INTERNAL_ERROR, NULL);
-                hdr->element = elem;
-            }
+        ecs_switch_header_t *hdr = get_header(sw, values[last_elem]);
+        if (hdr) {
+            int32_t index = nodes[last_elem].index;
+            ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
+            ecs_vec_get_t(&hdr->elements, int32_t, index)[0] = elem;
         }
     }
 
@@ -323,7 +309,7 @@ int32_t flecs_switch_case_count(
         return 0;
     }
 
-    return hdr->count;
+    return ecs_vec_count(&hdr->elements);
 }
 
 void flecs_switch_swap(
@@ -331,11 +317,36 @@ void flecs_switch_swap(
     int32_t elem_1,
     int32_t elem_2)
 {
-    uint64_t v1 = flecs_switch_get(sw, elem_1);
-    uint64_t v2 = flecs_switch_get(sw, elem_2);
+    if (elem_1 == elem_2) {
+        return;
+    }
+
+    uint64_t *values = ecs_vec_first(&sw->values);
+    ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    uint64_t v1 = values[elem_1];
+    uint64_t v2 = values[elem_2];
+
+    /* Swap element ids in the elements of both values, then swap the nodes so
+     * that each node points to the right index. */
+    ecs_switch_header_t *hdr_1 = get_header(sw, v1);
+    ecs_switch_header_t *hdr_2 = get_header(sw, v2);
+    if (hdr_1) {
+        ecs_vec_get_t(&hdr_1->elements, int32_t, nodes[elem_1].index)[0] =
+            elem_2;
+    }
+    if (hdr_2) {
+        ecs_vec_get_t(&hdr_2->elements, int32_t, nodes[elem_2].index)[0] =
+            elem_1;
+    }
+
+    ecs_switch_node_t tmp = nodes[elem_1];
+    nodes[elem_1] = nodes[elem_2];
+    nodes[elem_2] = tmp;
+    values[elem_1] = v2;
+    values[elem_2] = v1;
 
-    flecs_switch_set(sw, elem_2, v1);
-    flecs_switch_set(sw, elem_1, v2);
+    verify_elements(sw, hdr_1, v1);
+    verify_elements(sw, hdr_2, v2);
 }
 
 int32_t flecs_switch_first(
@@ -343,13 +354,20 @@ int32_t flecs_switch_first(
     uint64_t value)
 {
     ecs_assert(sw != NULL, ECS_INVALID_PARAMETER, NULL);
-    
+
     ecs_switch_header_t *hdr = get_header(sw, value);
     if (!hdr) {
         return -1;
     }
 
-    return hdr->element;
+    /* Iterate elements from last to first, so that elements that were most
+     * recently assigned to the value are returned first */
+    int32_t count = ecs_vec_count(&hdr->elements);
+    if (!count) {
+        return -1;
+    }
+
+    return ecs_vec_get_t(&hdr->elements, int32_t, count - 1)[0];
 }
 
 int32_t flecs_switch_next(
@@ -361,6 +379,28 @@ int32_t flecs_switch_next(
     ecs_assert(element >= 0, ECS_INVALID_PARAMETER, NULL);
 
     ecs_switch_node_t *nodes = ecs_vec_first(&sw->nodes);
+    int32_t index = nodes[element].index;
+    if (index <= 0) {
+        return -1;
+    }
+
+    uint64_t *values = ecs_vec_first(&sw->values);
+    ecs_switch_header_t *hdr = get_header(sw, values[element]);
+    ecs_assert(hdr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    return ecs_vec_get_t(&hdr->elements, int32_t, index - 1)[0];
+}
+
+const int32_t* flecs_switch_elements(
+    const ecs_switch_t *sw,
+    uint64_t value)
+{
+    ecs_assert(sw != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_switch_header_t *hdr = get_header(sw, value);
+    if (!hdr) {
+        return NULL;
+    }
 
-    return nodes[element].next;
+    return ecs_vec_first(&hdr->elements);
 }
@@ -16,6 +16,7 @@ const ecs_entity_t* flecs_bulk_new(
 typedef struct {
     ecs_type_info_t *ti;
     void *ptr;
+    bool is_sparse;
 } flecs_component_ptr_t;
 
 static
@@ -229,6 +230,9 @@ ecs_table_t* flecs_find_table_add(
     ecs_id_t id,
     ecs_table_diff_builder_t *diff)
 {
+    ecs_check(!flecs_id_is_sparse(world, id), ECS_UNSUPPORTED,
+        "sparse components can only be added with ecs_add/ecs_set");
+
     ecs_table_diff_t temp_diff = ECS_TABLE_DIFF_INIT;
     table = flecs_table_traverse_add(world, table, &id, &temp_diff);
     ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -643,6 +647,13 @@ void flecs_delete_entity(
     ecs_table_t *table = record->table;
     int32_t row = ECS_RECORD_TO_ROW(record->row);
 
+    if ((world->flags & EcsWorldHasSubsets) && 
+        (record->row & EcsEntityObservedTarget)) 
+    {
+        flecs_subsets_entity_moved(world, ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row)[0]);
+    }
+
     /* Invoke remove actions before deleting */
     flecs_notify_on_remove(world, table, NULL, row, 1, &diff->removed);
     flecs_table_delete(world, table, row, true);
@@ -905,6 +916,16 @@ void flecs_add_id(
     }
 
     ecs_record_t *r = flecs_entities_ensure(world, entity);
+
+    /* Sparse components are not stored in tables, so adding them doesn't
+     * move the entity */
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        flecs_sparse_component_ensure(world, idr, entity, true, NULL);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *src_table = r->table;
     ecs_table_t *dst_table = flecs_table_traverse_add(
@@ -927,6 +948,11 @@ void flecs_remove_id(
         return;
     }
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr && flecs_sparse_component_remove(world, idr, entity)) {
+        goto done;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *src_table = NULL;
     if (!r || !(src_table = r->table)) {
@@ -958,6 +984,14 @@ flecs_component_ptr_t flecs_get_mut(
     ecs_check((id & ECS_COMPONENT_MASK) == id || 
         ECS_HAS_ID_FLAG(id, PAIR), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        dst.ptr = flecs_sparse_component_ensure(world, idr, entity, true, NULL);
+        dst.ti = (ecs_type_info_t*)idr->type_info;
+        dst.is_sparse = true;
+        return dst;
+    }
+
     if (r->table) {
         dst = flecs_get_component_ptr(
             world, r->table, ECS_RECORD_TO_ROW(r->row), id);
@@ -1221,6 +1255,13 @@ ecs_entity_t ecs_new_w_id(
     ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(!id || ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
 
+    /* Sparse components are not part of the table, add them separately */
+    if (id && flecs_id_is_sparse(ecs_get_world(world), id)) {
+        ecs_entity_t entity = ecs_new_w_id(world, 0);
+        ecs_add_id(world, entity, id);
+        return entity;
+    }
+
     ecs_stage_t *stage = flecs_stage_from_world(&world);    
     ecs_entity_t entity = ecs_new_id(world);
 
@@ -1909,6 +1950,10 @@ void ecs_clear(
         return; /* Nothing to clear */
     }
 
+    if (world->flags & EcsWorldHasSparse) {
+        flecs_sparse_components_remove(world, entity);
+    }
+
     ecs_table_t *table = r->table;
     if (table) {
         ecs_table_diff_t diff = {
@@ -2394,6 +2439,10 @@ void ecs_delete(
     if (r) {
         flecs_journal_begin(world, EcsJournalDelete, entity, NULL, NULL);
 
+        if (world->flags & EcsWorldHasSparse) {
+            flecs_sparse_components_remove(world, entity);
+        }
+
         ecs_flags32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
         ecs_table_t *table;
         if (row_flags) {
@@ -2478,6 +2527,146 @@ error:
     return;
 }
 
+static
+void flecs_bulk_commit_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_id_t id,
+    bool remove)
+{
+    int32_t count = ecs_table_count(table);
+    if (!count) {
+        return;
+    }
+
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    ecs_table_t *dst_table;
+    if (remove) {
+        dst_table = flecs_table_traverse_remove(world, table, &id, &diff);
+    } else {
+        dst_table = flecs_table_traverse_add(world, table, &id, &diff);
+    }
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (dst_table == table) {
+        /* Table didn't change, but a union relationship could have */
+        flecs_notify_on_add(world, table, table, 0, count, &diff.added, 0);
+        return;
+    }
+
+    if (table->observed_count) {
+        flecs_update_component_monitors(world, &diff.added, &diff.removed);
+    }
+
+    if (diff.removed.count) {
+        flecs_notify_on_remove(world, table, dst_table, 0, count, 
+            &diff.removed);
+    }
+
+    if (!dst_table->type.count) {
+        /* All components were removed, entities no longer have a table */
+        flecs_table_clear_entities_silent(world, table);
+        return;
+    }
+
+    /* Move all entities in one go, and update their records */
+    int32_t dst_count = ecs_table_count(dst_table);
+    flecs_table_merge(world, dst_table, table, &dst_table->data, &table->data);
+    flecs_notify_on_add(world, dst_table, table, dst_count, count, 
+        &diff.added, 0);
+}
+
+static
+void flecs_bulk_commit(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id,
+    bool remove)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter->flags & EcsFilterMatchThis, ECS_INVALID_PARAMETER, 
+        "filter for bulk operation must match $this");
+
+    ecs_world_t *stage_world = world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    ecs_iter_t it = ecs_filter_iter(stage_world, filter);
+    ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+
+    /* If the world is deferred or the id is sparse, entities aren't moved in
+     * bulk. Fall back to regular (deferred) add/remove operations. */
+    bool deferred = flecs_defer_cmd(world, stage);
+    bool per_entity = deferred || flecs_id_is_sparse(world, id);
+
+    ecs_vec_t tables;
+    ecs_vec_init_t(&world->allocator, &tables, ecs_table_t*, 0);
+
+    while (ecs_filter_next(&it)) {
+        ecs_table_t *table = it.table;
+        if (!table || !it.count) {
+            continue;
+        }
+
+        /* If only part of the table is matched (for example because the
+         * filter has union or toggle terms), enqueue per entity commands. These
+         * are flushed after the tables have been moved. */
+        if (per_entity || it.offset || it.count != ecs_table_count(table)) {
+            int32_t i;
+            for (i = 0; i < it.count; i ++) {
+                if (remove) {
+                    ecs_remove_id(stage_world, it.entities[i], id);
+                } else {
+                    ecs_add_id(stage_world, it.entities[i], id);
+                }
+            }
+            continue;
+        }
+
+        /* Filters can return the same table multiple times for wildcards */
+        int32_t count = ecs_vec_count(&tables);
+        if (count && 
+            ecs_vec_get_t(&tables, ecs_table_t*, count - 1)[0] == table) 
+        {
+            continue;
+        }
+
+        ecs_vec_append_t(&world->allocator, &tables, ecs_table_t*)[0] = table;
+    }
+
+    /* Tables are collected before they're moved, so that the filter doesn't
+     * iterate tables it has already moved entities into. */
+    int32_t i, count = ecs_vec_count(&tables);
+    ecs_table_t **table_array = ecs_vec_first_t(&tables, ecs_table_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_bulk_commit_table(world, table_array[i], id, remove);
+    }
+
+    ecs_vec_fini_t(&world->allocator, &tables, ecs_table_t*);
+
+    if (!deferred) {
+        flecs_defer_end(world, stage);
+    }
+error:
+    return;
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    flecs_bulk_commit(world, filter, id, false);
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    flecs_bulk_commit(world, filter, id, true);
+}
+
 ecs_entity_t ecs_clone(
     ecs_world_t *world,
     ecs_entity_t dst,
@@ -2535,6 +2724,15 @@ const void* ecs_get_id(
 
     world = ecs_get_world(world);
 
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return NULL;
+    }
+
+    if ((idr->flags & EcsIdSparse) && idr->type_info) {
+        return flecs_sparse_component_get(idr, entity);
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     if (!r) {
         return NULL;
@@ -2545,11 +2743,6 @@ const void* ecs_get_id(
         return NULL;
     }
 
-    ecs_id_record_t *idr = flecs_id_record_get(world, id);
-    if (!idr) {
-        return NULL;
-    }
-
     const ecs_table_record_t *tr = NULL;
     ecs_table_t *storage_table = table->storage_table;
     if (storage_table) {
@@ -2810,9 +3003,17 @@ void* ecs_emplace_id(
     }
 
     ecs_record_t *r = flecs_entities_ensure(world, entity);
-    flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
 
-    void *ptr = flecs_get_component(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
+    void *ptr;
+    ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+    if (idr) {
+        ptr = flecs_sparse_component_ensure(world, idr, entity, 
+            false /* Add without ctor */, NULL);
+    } else {
+        flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
+        ptr = flecs_get_component(
+            world, r->table, ECS_RECORD_TO_ROW(r->row), id);
+    }
     ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
 
     flecs_defer_end(world, stage);
@@ -2840,7 +3041,9 @@ void flecs_modified_id_if(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
-    if (!flecs_table_record_get(world, table, id)) {
+    if (!table || flecs_sparse_id_record_get(world, id) ||
+        !flecs_table_record_get(world, table, id)) 
+    {
         flecs_defer_end(world, stage);
         return;
     }
@@ -2848,7 +3051,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2875,12 +3078,22 @@ void ecs_modified_id(
      * operations are being deferred. */
     ecs_check(ecs_has_id(world, entity, id), ECS_INVALID_PARAMETER, NULL);
 
+    /* Sparse components have no change tracking or OnSet observers, so only
+     * the on_set hook is invoked */
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr) {
+        flecs_sparse_component_on_set(world, idr, entity, 
+            flecs_sparse_component_get(idr, entity));
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, id, ECS_RECORD_TO_ROW(r->row));
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2917,13 +3130,18 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    if (!dst.is_sparse) {
+        flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
-    ecs_table_t *table = r->table;
-    if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
-        ecs_type_t ids = { .array = &id, .count = 1 };
-        flecs_notify_on_set(
-            world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        ecs_table_t *table = r->table;
+        if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
+            ecs_type_t ids = { .array = &id, .count = 1 };
+            flecs_notify_on_set(
+                world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        }
+    } else {
+        flecs_sparse_component_on_set(world, 
+            flecs_id_record_get(world, id), entity, dst.ptr);
     }
 
     flecs_defer_end(world, stage);
@@ -2965,15 +3183,20 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    if (!dst.is_sparse) {
+        flecs_table_mark_dirty(world, r->table, id, ECS_RECORD_TO_ROW(r->row));
 
-    if (cmd_kind == EcsOpSet) {
-        ecs_table_t *table = r->table;
-        if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
-            ecs_type_t ids = { .array = &id, .count = 1 };
-            flecs_notify_on_set(
-                world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+        if (cmd_kind == EcsOpSet) {
+            ecs_table_t *table = r->table;
+            if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
+                ecs_type_t ids = { .array = &id, .count = 1 };
+                flecs_notify_on_set(
+                    world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
+            }
         }
+    } else if (cmd_kind == EcsOpSet) {
+        flecs_sparse_component_on_set(world, 
+            flecs_id_record_get(world, id), entity, dst.ptr);
     }
 
     flecs_defer_end(world, stage);
@@ -3104,6 +3327,11 @@ bool ecs_has_id(
     /* Make sure we're not working with a stage */
     world = ecs_get_world(world);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record_get(world, id);
+    if (idr) {
+        return flecs_sparse_component_get(idr, entity) != NULL;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table;
     if (!r || !(table = r->table)) {
@@ -3967,10 +4195,236 @@ bool flecs_remove_invalid(
     return true;
 }
 
+/* Entities with the same table transition that are moved together */
+typedef struct ecs_cmd_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    ecs_table_diff_builder_t diff;
+    ecs_vec_t entities;          /* vec<ecs_entity_t> */
+} ecs_cmd_group_t;
+
+/* Move entities in group to the destination table. Because entities are
+ * appended to the destination table in order, they end up in a contiguous
+ * range, which is used to notify observers with a single event. */
+static
+void flecs_cmd_group_flush(
+    ecs_world_t *world,
+    ecs_cmd_group_t *group)
+{
+    int32_t i, count = ecs_vec_count(&group->entities);
+    if (!count) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&group->entities);
+    ecs_table_t *src_table = group->src, *dst_table = group->dst;
+    ecs_table_diff_t diff;
+    flecs_table_diff_build_noalloc(&group->diff, &diff);
+
+    flecs_defer_begin(world, &world->stages[0]);
+
+    if (count == 1) {
+        ecs_record_t *r = flecs_entities_get(world, entities[0]);
+        flecs_commit(world, entities[0], r, dst_table, &diff, true, 0);
+    } else {
+        int32_t first_row = 0;
+        bool monitored = false;
+
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = entities[i];
+            ecs_record_t *r = flecs_entities_get(world, e);
+            ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+            ecs_assert(r->table == src_table, ECS_INTERNAL_ERROR, NULL);
+            flecs_journal_begin(world, EcsJournalMove, e, 
+                &diff.added, &diff.removed);
+
+            uint32_t row_flags = r->row & ECS_ROW_FLAGS_MASK;
+            int observed = (row_flags & EcsEntityObservedAcyclic) != 0;
+            flecs_table_observer_add(dst_table, observed);
+
+            int32_t dst_row;
+            if (src_table) {
+                int32_t src_row = ECS_RECORD_TO_ROW(r->row);
+                dst_row = flecs_table_append(
+                    world, dst_table, e, r, false, false);
+                flecs_table_move(world, e, e, dst_table, dst_row, 
+                    src_table, src_row, true);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row, row_flags);
+                flecs_table_delete(world, src_table, src_row, false);
+                flecs_table_observer_add(src_table, -observed);
+            } else {
+                dst_row = flecs_table_append(
+                    world, dst_table, e, r, true, true);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row, row_flags);
+            }
+
+            if (!i) {
+                first_row = dst_row;
+            }
+
+            ecs_assert(dst_row == (first_row + i), ECS_INTERNAL_ERROR, NULL);
+            monitored |= row_flags != 0;
+            flecs_journal_end();
+        }
+
+        flecs_notify_on_add(world, dst_table, src_table, first_row, count, 
+            &diff.added, 0);
+
+        if (monitored) {
+            flecs_update_component_monitors(world, &diff.added, &diff.removed);
+        }
+
+        world->info.cmd.batched_group_count ++;
+    }
+
+    flecs_defer_end(world, &world->stages[0]);
+    ecs_vec_clear(&group->entities);
+}
+
+/* Add entity to group if it has the same table transition as the entities
+ * already in the group. Only transitions that add ids are grouped. */
+static
+bool flecs_cmd_group_add(
+    ecs_world_t *world,
+    ecs_cmd_group_t *group,
+    ecs_entity_t entity,
+    ecs_record_t *r,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff)
+{
+    if (!r || !dst_table || !dst_table->type.count || diff->removed.count) {
+        return false;
+    }
+
+    ecs_table_t *src_table = r->table;
+    if (src_table == dst_table) {
+        return false;
+    }
+
+    if (!src_table && world->range_check_enabled) {
+        return false;
+    }
+
+    if (ecs_vec_count(&group->entities)) {
+        if (group->src != src_table || group->dst != dst_table ||
+            group->diff.added.count != diff->added.count ||
+            ecs_os_memcmp(group->diff.added.array, diff->added.array, 
+                ECS_SIZEOF(ecs_id_t) * diff->added.count))
+        {
+            flecs_cmd_group_flush(world, group);
+        }
+    }
+
+    if (!ecs_vec_count(&group->entities)) {
+        group->src = src_table;
+        group->dst = dst_table;
+        flecs_table_diff_builder_clear(&group->diff);
+        flecs_table_diff_build_append_table(world, &group->diff, diff);
+    }
+
+    ecs_vec_append_t(&world->allocator, &group->entities, ecs_entity_t)[0] = 
+        entity;
+    return true;
+}
+
+/* Test if emplaced component can be added together with the other components
+ * of a batch. Emplaced components are added without invoking the constructor,
+ * which is only possible in a batched move if there is no constructor. */
+static
+bool flecs_cmd_emplace_can_batch(
+    ecs_world_t *world,
+    ecs_cmd_t *cmd,
+    ecs_table_t *table)
+{
+    ecs_id_record_t *idr = cmd->idr;
+    if (!idr) {
+        idr = flecs_id_record_get(world, cmd->id);
+    }
+    if (!idr || (idr->flags & EcsIdSparse)) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (!ti || ti->hooks.ctor) {
+        return false;
+    }
+
+    /* If entity already has the component use regular path, which reports
+     * an error */
+    if (table && flecs_id_record_get_table(idr, table)) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Move emplaced values into the components that were added by the batch. The
+ * value is moved directly from the command queue into the table column. */
+static
+void flecs_cmd_batch_emplace(
+    ecs_world_t *world,
+    ecs_record_t *r,
+    ecs_table_t *src_table,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    ecs_table_t *table = r->table;
+    if (!table || !table->storage_table) {
+        return;
+    }
+
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    int32_t cur = start, next_for_entity;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+
+        if (cmd->kind != EcsOpEmplace) {
+            continue;
+        }
+
+        if (!flecs_cmd_emplace_can_batch(world, cmd, src_table)) {
+            continue;
+        }
+
+        /* If the component was removed again by the batch, the emplace is
+         * processed as a regular command which adds it back */
+        const ecs_table_record_t *tr = flecs_table_record_get(
+            world, table->storage_table, cmd->id);
+        if (!tr) {
+            continue;
+        }
+
+        flecs_component_ptr_t dst = flecs_get_component_w_index(
+            table, tr->column, row);
+        const ecs_type_info_t *ti = dst.ti;
+        ecs_move_t move_ctor = ti->hooks.move_ctor;
+        if (move_ctor) {
+            move_ctor(dst.ptr, cmd->is._1.value, 1, ti);
+        } else {
+            ecs_os_memcpy(dst.ptr, cmd->is._1.value, ti->size);
+        }
+
+        flecs_table_mark_dirty(world, table, cmd->id, row);
+        flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
+
+        /* Clear value so that skipped command doesn't destruct it again */
+        cmd->is._1.value = NULL;
+        cmd->kind = EcsOpSkip;
+        world->info.cmd.get_mut_count ++;
+    } while ((cur = next_for_entity));
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
     ecs_table_diff_builder_t *diff,
+    ecs_cmd_group_t *group,
     ecs_entity_t entity,
     ecs_cmd_t *cmds,
     int32_t start)
@@ -3981,6 +4435,8 @@ void flecs_cmd_batch_for_entity(
         table = r->table;
     }
 
+    ecs_table_t *src_table = table;
+
     world->info.cmd.batched_entity_count ++;
 
     ecs_cmd_t *cmd;
@@ -3989,6 +4445,8 @@ void flecs_cmd_batch_for_entity(
     int32_t cur = start;
     ecs_id_t id;
     bool has_set = false;
+    bool has_emplace = false;
+    bool add_only = true;
 
     do {
         cmd = &cmds[cur];
@@ -4012,13 +4470,25 @@ void flecs_cmd_batch_for_entity(
             } else {
                 /* Id was no longer valid and had a Delete policy */
                 cmd->kind = EcsOpSkip;
+                flecs_cmd_group_flush(world, group);
                 ecs_delete(world, entity);
                 flecs_table_diff_builder_clear(diff);
                 return;
             }
         }
 
+        /* Sparse components don't change the table of the entity, so they
+         * are not batched. The command is executed as a regular command. */
+        if (id && flecs_id_is_sparse(world, id)) {
+            add_only = false;
+            continue;
+        }
+
         ecs_cmd_kind_t kind = cmd->kind;
+        if (kind != EcsOpAdd) {
+            add_only = false;
+        }
+
         switch(kind) {
         case EcsOpAdd:
             table = flecs_find_table_add(world, table, id, diff);
@@ -4031,8 +4501,13 @@ void flecs_cmd_batch_for_entity(
             has_set = true;
             break;
         case EcsOpEmplace:
-            /* Don't add for emplace, as this requires a special call to ensure
-             * the constructor is not invoked for the component */
+            /* Only add for emplace if the component has no constructor, as
+             * the constructor must not be invoked for the component. */
+            if (flecs_cmd_emplace_can_batch(world, cmd, src_table)) {
+                table = flecs_find_table_add(world, table, id, diff);
+                world->info.cmd.batched_command_count ++;
+                has_emplace = true;
+            }
             break;
         case EcsOpRemove:
             table = flecs_find_table_remove(world, table, id, diff);
@@ -4040,6 +4515,9 @@ void flecs_cmd_batch_for_entity(
             break;
         case EcsOpClear:
             table = NULL;
+            if (world->flags & EcsWorldHasSparse) {
+                flecs_sparse_components_remove(world, entity);
+            }
             world->info.cmd.batched_command_count ++;
             break;
         default:
@@ -4055,8 +4533,22 @@ void flecs_cmd_batch_for_entity(
 
     /* Move entity to destination table in single operation */
     flecs_table_diff_build_noalloc(diff, &table_diff);
+
+    /* If entity only has add commands, try to move it together with other
+     * entities that have the same table transition */
+    if (add_only && flecs_cmd_group_add(
+        world, group, entity, r, table, &table_diff)) 
+    {
+        flecs_table_diff_builder_clear(diff);
+        return;
+    }
+
+    flecs_cmd_group_flush(world, group);
     flecs_defer_begin(world, &world->stages[0]);
     flecs_commit(world, entity, r, table, &table_diff, true, 0);
+    if (has_emplace) {
+        flecs_cmd_batch_emplace(world, r, src_table, cmds, start);
+    }
     flecs_defer_end(world, &world->stages[0]);
     flecs_table_diff_builder_clear(diff);
 
@@ -4079,6 +4571,10 @@ void flecs_cmd_batch_for_entity(
                     idr = flecs_id_record_get(world, cmd->id);
                 }
 
+                if (idr->flags & EcsIdSparse) {
+                    break;
+                }
+
                 if (!flecs_id_record_get_table(idr, table)) {
                     /* Component was deleted */
                     cmd->kind = EcsOpSkip;
@@ -4094,6 +4590,465 @@ void flecs_cmd_batch_for_entity(
     }
 }
 
+/* Minimum number of values written by a single merge job. Values for the same
+ * table are never split up between jobs. */
+#ifndef FLECS_MERGE_JOB_MIN_COUNT
+#define FLECS_MERGE_JOB_MIN_COUNT (256)
+#endif
+
+typedef struct ecs_merge_job_t {
+    ecs_merge_write_t *writes;
+    int32_t *bounds;             /* End of each job in writes array */
+    int32_t job_count;
+    int32_t next;                /* Number of claimed jobs */
+} ecs_merge_job_t;
+
+/* Test if a set command can be written to storage after the structural changes
+ * of the merge have been applied. This is only the case if writing the value
+ * has no side effects besides invoking the move hook. If the entity doesn't
+ * have the component yet, it is added here when the move to the new table runs
+ * no hooks or observers, so the value write can still be deferred.
+ *
+ * Commands that stay serial (flush the pending writes before they run):
+ * - commands other than set/mut, as they can run code that reads values
+ * - sets to sparse components, or components with an on_set hook
+ * - sets to tables with OnSet observers
+ * - sets that add a component to a table with add actions (ctors, on_add 
+ *   hooks, OnAdd/OnSet observers, IsA, union relationships)
+ * - sets to entities that are not stored in a table yet */
+static
+bool flecs_merge_write_defer(
+    ecs_world_t *world,
+    ecs_cmd_t *cmd)
+{
+    ecs_cmd_kind_t kind = cmd->kind;
+    if (kind != EcsOpSet && kind != EcsOpMut) {
+        return false;
+    }
+
+    ecs_id_record_t *idr = cmd->idr;
+    if (!idr) {
+        idr = flecs_id_record_get(world, cmd->id);
+    }
+    if (!idr || (idr->flags & EcsIdSparse)) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (!ti || ti->hooks.on_set) {
+        return false;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, cmd->entity);
+    ecs_table_t *table = r ? r->table : NULL;
+    if (!table) {
+        return false;
+    }
+
+    if (!table->storage_table || 
+        !flecs_id_record_get_table(idr, table->storage_table)) 
+    {
+        /* Entity doesn't have the component yet. Nothing can observe the
+         * values of pending writes while adding it if the destination table
+         * has no add actions, otherwise use the regular path. */
+        ecs_id_t id = cmd->id;
+        ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+        ecs_table_t *dst = flecs_table_traverse_add(world, table, &id, &diff);
+        if (dst == table || (dst->flags & EcsTableHasAddActions) ||
+            !dst->storage_table || 
+            !flecs_id_record_get_table(idr, dst->storage_table))
+        {
+            return false;
+        }
+
+        flecs_commit(world, cmd->entity, r, dst, &diff, true, 0);
+    } else if ((kind == EcsOpSet) && (table->flags & EcsTableHasOnSet)) {
+        return false;
+    }
+
+    ecs_merge_write_t *w = ecs_vec_append_t(
+        &world->allocator, &world->merge_writes, ecs_merge_write_t);
+    w->entity = cmd->entity;
+    w->id = cmd->id;
+    w->value = cmd->is._1.value;
+    w->size = cmd->is._1.size;
+    return true;
+}
+
+static
+int flecs_merge_write_compare(
+    const void *ptr_a,
+    const void *ptr_b)
+{
+    const ecs_merge_write_t *a = ptr_a;
+    const ecs_merge_write_t *b = ptr_b;
+    if (a->table != b->table) {
+        uint64_t id_a = a->table->id, id_b = b->table->id;
+        return (id_a > id_b) - (id_a < id_b);
+    }
+    return (a->order > b->order) - (a->order < b->order);
+}
+
+static
+void flecs_merge_writes_apply(
+    ecs_merge_write_t *writes,
+    int32_t count)
+{
+    int32_t i, j;
+    for (i = 0; i < count; i += j) {
+        ecs_merge_write_t *w = &writes[i];
+        ecs_table_t *table = w->table;
+        const ecs_type_info_t *ti = table->type_info[w->column];
+        ecs_size_t size = ti->size;
+        void *dst = ecs_vec_get(
+            &table->data.columns[w->column], size, w->row);
+        ecs_move_t move = ti->hooks.move;
+        if (move) {
+            move(dst, w->value, 1, ti);
+            flecs_stack_free(w->value, w->size);
+            j = 1;
+            continue;
+        }
+
+        /* Values that were set for consecutive rows in a loop are usually
+         * also stored consecutively in the queue, in which case they can be
+         * copied with a single memcpy */
+        for (j = 1; (i + j) < count; j ++) {
+            ecs_merge_write_t *next = &writes[i + j];
+            if (next->table != table || next->column != w->column ||
+                next->row != (w->row + j) || 
+                next->value != ECS_OFFSET(w->value, size * j))
+            {
+                break;
+            }
+        }
+
+        ecs_os_memcpy(dst, w->value, size * j);
+
+        int32_t k;
+        for (k = 0; k < j; k ++) {
+            flecs_stack_free(writes[i + k].value, writes[i + k].size);
+        }
+    }
+}
+
+static
+void flecs_merge_job(
+    ecs_world_t *world,
+    void *ctx)
+{
+    (void)world;
+    ecs_merge_job_t *job = ctx;
+    int32_t i;
+    while ((i = ecs_os_ainc(&job->next) - 1) < job->job_count) {
+        int32_t start = i ? job->bounds[i - 1] : 0;
+        flecs_merge_writes_apply(&job->writes[start], job->bounds[i] - start);
+    }
+}
+
+/* Write values of deferred set commands to storage. When worker threads are
+ * available, values for different tables are written in parallel. */
+static
+void flecs_merge_writes_flush(
+    ecs_world_t *world)
+{
+    int32_t i, count = ecs_vec_count(&world->merge_writes);
+    if (!count) {
+        return;
+    }
+
+    /* Find where values should be written. Entities may have moved to another
+     * table since the command was added. */
+    ecs_merge_write_t *writes = ecs_vec_first(&world->merge_writes);
+    ecs_table_t *first_table = NULL;
+    bool single_table = true;
+    int32_t write_count = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_merge_write_t *w = &writes[i];
+        ecs_record_t *r = flecs_entities_get(world, w->entity);
+        ecs_table_t *table = r ? r->table : NULL;
+        const ecs_table_record_t *tr = NULL;
+        if (table && table->storage_table) {
+            tr = flecs_table_record_get(world, table->storage_table, w->id);
+        }
+
+        if (!tr) {
+            /* Entity was deleted or component was removed */
+            flecs_dtor_value(world, w->id, w->value, 1);
+            flecs_stack_free(w->value, w->size);
+            world->info.cmd.discard_count ++;
+            continue;
+        }
+
+        if (!first_table) {
+            first_table = table;
+        } else if (first_table != table) {
+            single_table = false;
+        }
+
+        /* Mark dirty here, before the writes are divided between threads */
+        int32_t row = ECS_RECORD_TO_ROW(r->row);
+        flecs_table_mark_column_dirty(world, table, tr->column, row, 1);
+
+        ecs_merge_write_t *dst = &writes[write_count];
+        *dst = *w;
+        dst->table = table;
+        dst->row = row;
+        dst->column = tr->column;
+        dst->order = write_count;
+        write_count ++;
+    }
+
+    ecs_merge_run_action_t run = world->merge_run;
+    if (!run || single_table || (write_count < FLECS_MERGE_JOB_MIN_COUNT * 2)) {
+        flecs_merge_writes_apply(writes, write_count);
+        ecs_vec_clear(&world->merge_writes);
+        return;
+    }
+
+    /* Group values by table while preserving queue order within a table, so
+     * that the last value for a component is the one that remains */
+    qsort(writes, flecs_itosize(write_count), ECS_SIZEOF(ecs_merge_write_t), 
+        flecs_merge_write_compare);
+
+    int32_t max_jobs = write_count / FLECS_MERGE_JOB_MIN_COUNT + 1;
+    int32_t *bounds = flecs_walloc_n(world, int32_t, max_jobs);
+    int32_t job_count = 0, start = 0;
+    for (i = 1; i < write_count; i ++) {
+        if ((writes[i].table != writes[i - 1].table) && 
+            ((i - start) >= FLECS_MERGE_JOB_MIN_COUNT)) 
+        {
+            bounds[job_count ++] = i;
+            start = i;
+        }
+    }
+    bounds[job_count ++] = write_count;
+
+    ecs_merge_job_t job = {
+        .writes = writes,
+        .bounds = bounds,
+        .job_count = job_count
+    };
+
+    if (job_count == 1) {
+        flecs_merge_writes_apply(writes, write_count);
+    } else {
+        run(world, flecs_merge_job, &job);
+    }
+
+    flecs_wfree_n(world, int32_t, max_jobs, bounds);
+    ecs_vec_clear(&world->merge_writes);
+}
+
+/* Take command queue from stage, so that commands that are added to the stage
+ * while the queue is flushed are stored in a new queue. */
+static
+void flecs_defer_take(
+    ecs_stage_t *stage,
+    ecs_vec_t *commands,
+    ecs_stack_t *stack)
+{
+    *commands = stage->commands;
+    stage->commands.array = NULL;
+    stage->commands.count = 0;
+    stage->commands.size = 0;
+    ecs_vec_init_t(NULL, &stage->commands, ecs_cmd_t, 0);
+
+    *stack = stage->defer_stack;
+    flecs_stack_init(&stage->defer_stack);
+    flecs_sparse_clear(&stage->cmd_entries);
+}
+
+/* Restore flushed command queue, so its storage is reused */
+static
+void flecs_defer_restore(
+    ecs_stage_t *stage,
+    ecs_vec_t *commands,
+    ecs_stack_t *stack)
+{
+    ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
+
+    /* Restore defer queue */
+    ecs_vec_clear(commands);
+    stage->commands = *commands;
+
+    /* Restore stack */
+    flecs_stack_fini(&stage->defer_stack);
+    stage->defer_stack = *stack;
+    flecs_stack_reset(&stage->defer_stack);
+}
+
+/* Run range of commands from a queue that was taken from a stage */
+static
+void flecs_defer_flush(
+    ecs_world_t *world,
+    ecs_stage_t *dst_stage,
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count,
+    bool merge_to_world)
+{
+    /* Values that are written after structural changes. Values left by a 
+     * merge that is still in progress are written first, so that they don't
+     * overwrite values set by commands in this queue. */
+    bool merge_writes = merge_to_world && 
+        (world->flags & EcsWorldParallelMerge);
+    if (merge_writes) {
+        flecs_merge_writes_flush(world);
+    }
+
+    ecs_table_diff_builder_t diff;
+    flecs_table_diff_builder_init(world, &diff);
+
+    ecs_cmd_group_t group = {0};
+    flecs_table_diff_builder_init(world, &group.diff);
+    ecs_vec_init_t(&world->allocator, &group.entities, ecs_entity_t, 0);
+
+    int32_t i, last = first + count;
+    for (i = first; i < last; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_entity_t e = cmd->entity;
+        bool is_alive = flecs_entities_is_valid(world, e);
+
+        /* A negative index indicates the first command for an entity */
+        if (merge_to_world && (cmd->next_for_entity < 0)) {
+            /* Batch commands for entity to limit archetype moves */
+            if (is_alive) {
+                flecs_cmd_batch_for_entity(
+                    world, &diff, &group, e, cmds, i);
+            } else {
+                world->info.cmd.discard_count ++;
+            }
+
+        /* An add command that is the only command for an entity can be
+         * moved together with other entities that get the same id */
+        } else if (merge_to_world && is_alive && e && 
+            (cmd->kind == EcsOpAdd) && !cmd->next_for_entity) 
+        {
+            flecs_cmd_batch_for_entity(
+                world, &diff, &group, e, cmds, i);
+        }
+
+        /* If entity is no longer alive, this could be because the queue
+         * contained both a delete and a subsequent add/remove/set which
+         * should be ignored. */
+        ecs_cmd_kind_t kind = cmd->kind;
+        if ((kind == EcsOpSkip) || (e && !is_alive)) {
+            world->info.cmd.discard_count ++;
+            flecs_discard_cmd(world, cmd);
+            continue;
+        }
+
+        if (merge_writes) {
+            if (flecs_merge_write_defer(world, cmd)) {
+                if (kind == EcsOpSet) {
+                    world->info.cmd.set_count ++;
+                } else {
+                    world->info.cmd.get_mut_count ++;
+                }
+                continue;
+            }
+
+            /* Command may depend on values of earlier commands */
+            flecs_merge_writes_flush(world);
+        }
+
+        /* Command may depend on entities that haven't been moved yet */
+        flecs_cmd_group_flush(world, &group);
+
+        ecs_id_t id = cmd->id;
+
+        switch(kind) {
+        case EcsOpAdd:
+            ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (flecs_remove_invalid(world, id, &id)) {
+                if (id) {
+                    world->info.cmd.add_count ++;
+                    flecs_add_id(world, e, id);
+                } else {
+                    world->info.cmd.discard_count ++;
+                }
+            } else {
+                world->info.cmd.discard_count ++;
+                ecs_delete(world, e);
+            }
+            break;
+        case EcsOpRemove:
+            flecs_remove_id(world, e, id);
+            world->info.cmd.remove_count ++;
+            break;
+        case EcsOpClone:
+            ecs_clone(world, e, id, cmd->is._1.clone_value);
+            break;
+        case EcsOpSet:
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.set_count ++;
+            break;
+        case EcsOpEmplace:
+            if (merge_to_world) {
+                ecs_emplace_id(world, e, id);
+            }
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.get_mut_count ++;
+            break;
+        case EcsOpMut:
+            flecs_move_ptr_w_id(world, dst_stage, e, 
+                cmd->id, flecs_itosize(cmd->is._1.size), 
+                cmd->is._1.value, kind);
+            world->info.cmd.get_mut_count ++;
+            break;
+        case EcsOpModified:
+            flecs_modified_id_if(world, e, id);
+            world->info.cmd.modified_count ++;
+            break;
+        case EcsOpDelete: {
+            ecs_delete(world, e);
+            world->info.cmd.delete_count ++;
+            break;
+        }
+        case EcsOpClear:
+            ecs_clear(world, e);
+            world->info.cmd.clear_count ++;
+            break;
+        case EcsOpOnDeleteAction:
+            flecs_on_delete(world, id, e);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpEnable:
+            ecs_enable_id(world, e, id, true);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpDisable:
+            ecs_enable_id(world, e, id, false);
+            world->info.cmd.other_count ++;
+            break;
+        case EcsOpBulkNew:
+            flecs_flush_bulk_new(world, cmd);
+            world->info.cmd.other_count ++;
+            continue;
+        case EcsOpSkip:
+            break;
+        }
+
+        if (cmd->is._1.value) {
+            flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
+        }
+    }
+
+    if (merge_writes) {
+        flecs_merge_writes_flush(world);
+    }
+
+    flecs_cmd_group_flush(world, &group);
+    ecs_vec_fini_t(&world->allocator, &group.entities, ecs_entity_t);
+    flecs_table_diff_builder_fini(world, &group.diff);
+    flecs_table_diff_builder_fini(world, &diff);
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_end(
     ecs_world_t *world,
@@ -4118,148 +5073,82 @@ bool flecs_defer_end(
 
         ecs_stage_t *dst_stage = flecs_stage_from_world(&world);
         if (ecs_vec_count(&stage->commands)) {
-            ecs_vec_t commands = stage->commands;
-            stage->commands.array = NULL;
-            stage->commands.count = 0;
-            stage->commands.size = 0;
-
-            ecs_cmd_t *cmds = ecs_vec_first(&commands);
-            int32_t i, count = ecs_vec_count(&commands);
-            ecs_vec_init_t(NULL, &stage->commands, ecs_cmd_t, 0);
-
-            ecs_stack_t stack = stage->defer_stack;
-            flecs_stack_init(&stage->defer_stack);
-
-            ecs_table_diff_builder_t diff;
-            flecs_table_diff_builder_init(world, &diff);
-            flecs_sparse_clear(&stage->cmd_entries);
-
-            for (i = 0; i < count; i ++) {
-                ecs_cmd_t *cmd = &cmds[i];
-                ecs_entity_t e = cmd->entity;
-                bool is_alive = flecs_entities_is_valid(world, e);
-
-                /* A negative index indicates the first command for an entity */
-                if (merge_to_world && (cmd->next_for_entity < 0)) {
-                    /* Batch commands for entity to limit archetype moves */
-                    if (is_alive) {
-                        flecs_cmd_batch_for_entity(world, &diff, e, cmds, i);
-                    } else {
-                        world->info.cmd.discard_count ++;
-                    }
-                }
+            ecs_vec_t commands;
+            ecs_stack_t stack;
+            flecs_defer_take(stage, &commands, &stack);
+            flecs_defer_flush(world, dst_stage, ecs_vec_first(&commands), 0,
+                ecs_vec_count(&commands), merge_to_world);
+            flecs_defer_restore(stage, &commands, &stack);
+        }
 
-                /* If entity is no longer alive, this could be because the queue
-                 * contained both a delete and a subsequent add/remove/set which
-                 * should be ignored. */
-                ecs_cmd_kind_t kind = cmd->kind;
-                if ((kind == EcsOpSkip) || (e && !is_alive)) {
-                    world->info.cmd.discard_count ++;
-                    flecs_discard_cmd(world, cmd);
-                    continue;
-                }
+        return true;
+    }
 
-                ecs_id_t id = cmd->id;
-
-                switch(kind) {
-                case EcsOpAdd:
-                    ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
-                    if (flecs_remove_invalid(world, id, &id)) {
-                        if (id) {
-                            world->info.cmd.add_count ++;
-                            flecs_add_id(world, e, id);
-                        } else {
-                            world->info.cmd.discard_count ++;
-                        }
-                    } else {
-                        world->info.cmd.discard_count ++;
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    flecs_remove_id(world, e, id);
-                    world->info.cmd.remove_count ++;
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, id, cmd->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.set_count ++;
-                    break;
-                case EcsOpEmplace:
-                    if (merge_to_world) {
-                        ecs_emplace_id(world, e, id);
-                    }
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.get_mut_count ++;
-                    break;
-                case EcsOpMut:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
-                    world->info.cmd.get_mut_count ++;
-                    break;
-                case EcsOpModified:
-                    flecs_modified_id_if(world, e, id);
-                    world->info.cmd.modified_count ++;
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    world->info.cmd.delete_count ++;
-                    break;
-                }
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    world->info.cmd.clear_count ++;
-                    break;
-                case EcsOpOnDeleteAction:
-                    flecs_on_delete(world, id, e);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpEnable:
-                    ecs_enable_id(world, e, id, true);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_id(world, e, id, false);
-                    world->info.cmd.other_count ++;
-                    break;
-                case EcsOpBulkNew:
-                    flecs_flush_bulk_new(world, cmd);
-                    world->info.cmd.other_count ++;
-                    continue;
-                case EcsOpSkip:
-                    break;
-                }
+    return false;
+}
 
-                if (cmd->is._1.value) {
-                    flecs_stack_free(cmd->is._1.value, cmd->is._1.size);
-                }
-            }
+/* Make sure that batching doesn't follow the commands of an entity past the
+ * end of a range. Commands of a later range may only run after the commands
+ * of other stages that are ordered before them. */
+static
+void flecs_cmd_range_cut(
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count)
+{
+    int32_t i, last = first + count;
+    for (i = first; i < last; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        int32_t next = cmd->next_for_entity;
+        if (next < 0) {
+            next *= -1;
+        }
+        if (next >= last) {
+            cmd->next_for_entity = 0;
+        }
+    }
+}
 
-            ecs_vec_fini_t(&stage->allocator, &stage->commands, ecs_cmd_t);
+/* Leave safe section for all stages, and run the deferred commands of the
+ * stages in the order of the provided ranges. Ranges of commands must have 
+ * been separated with flecs_stage_cmd_cut, and together must cover all 
+ * commands of all stages. */
+void flecs_defer_end_ordered(
+    ecs_world_t *world,
+    const ecs_cmd_range_t *ranges,
+    int32_t range_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
 
-            /* Restore defer queue */
-            ecs_vec_clear(&commands);
-            stage->commands = commands;
+    int32_t i, stage_count = world->stage_count;
+    ecs_vec_t *commands = flecs_walloc_n(world, ecs_vec_t, stage_count);
+    ecs_stack_t *stacks = flecs_walloc_n(world, ecs_stack_t, stage_count);
 
-            /* Restore stack */
-            flecs_stack_fini(&stage->defer_stack);
-            stage->defer_stack = stack;
-            flecs_stack_reset(&stage->defer_stack);
+    for (i = 0; i < stage_count; i ++) {
+        ecs_stage_t *stage = &world->stages[i];
+        ecs_assert(stage->defer == 1, ECS_INVALID_OPERATION, 
+            "mismatching defer_begin/defer_end detected");
+        stage->defer --;
+        flecs_defer_take(stage, &commands[i], &stacks[i]);
+    }
 
-            flecs_table_diff_builder_fini(world, &diff);
-        }
+    for (i = 0; i < range_count; i ++) {
+        const ecs_cmd_range_t *range = &ranges[i];
+        ecs_vec_t *stage_commands = &commands[range->stage];
+        ecs_assert(range->first + range->count <= 
+            ecs_vec_count(stage_commands), ECS_INTERNAL_ERROR, NULL);
+        ecs_cmd_t *cmds = ecs_vec_first(stage_commands);
+        flecs_cmd_range_cut(cmds, range->first, range->count);
+        flecs_defer_flush(world, &world->stages[0], 
+            cmds, range->first, range->count, true);
+    }
 
-        return true;
+    for (i = 0; i < stage_count; i ++) {
+        flecs_defer_restore(&world->stages[i], &commands[i], &stacks[i]);
     }
 
-    return false;
+    flecs_wfree_n(world, ecs_stack_t, stage_count, stacks);
+    flecs_wfree_n(world, ecs_vec_t, stage_count, commands);
 }
 
 /* Delete operations from queue without executing them. */
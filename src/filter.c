@@ -873,6 +873,111 @@ void ecs_term_fini(
     term->name = NULL;
 }
 
+typedef struct ecs_filter_plan_elem_t {
+    int64_t cost;
+    int32_t term;
+    int32_t count;
+} ecs_filter_plan_elem_t;
+
+/* Estimate how expensive it is to reach a verdict with a term (or Or chain).
+ * Terms that are most likely to reject a table come first, so that a table 
+ * that doesn't match fails on as few lookups as possible. */
+static
+int64_t flecs_filter_plan_cost(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_oper_kind_t oper = term->oper;
+    if (!term->src.id || oper == EcsOptional) {
+        /* Terms that can't reject a table are evaluated last */
+        return INT64_MAX;
+    }
+
+    if (!ecs_term_match_this(term)) {
+        /* Terms with a fixed source yield the same result for every table */
+        return 0;
+    }
+
+    ecs_id_record_t *idr = flecs_query_id_record_get(world, term->id);
+    int64_t table_count = 0;
+    if (idr) {
+        table_count = flecs_table_cache_count(&idr->cache);
+    }
+
+    if (oper == EcsAnd) {
+        /* The fewer tables have the id, the more likely it rejects a table. 
+         * Terms that traverse relationships are more expensive to test. */
+        if ((term->src.flags & EcsTraverseFlags) != EcsSelf) {
+            table_count += INT32_MAX;
+        }
+        return 1 + table_count;
+    } else if (oper == EcsNot) {
+        /* The more tables have the id, the more likely it rejects a table */
+        return 2 * (int64_t)INT32_MAX + 1 - table_count;
+    }
+
+    /* Or chains reject a table only if none of their terms match */
+    return 3 * (int64_t)INT32_MAX;
+}
+
+/* Compute order in which flecs_filter_match_table evaluates terms. The plan is
+ * computed once when the filter is finalized, from the tables that exist at
+ * that point. A plan that gets out of date only affects performance. */
+static
+void flecs_filter_plan(
+    const ecs_world_t *world,
+    ecs_filter_t *filter)
+{
+    int32_t i, j, term_count = filter->term_count;
+    if (term_count < 2) {
+        ecs_os_free(filter->plan);
+        filter->plan = NULL;
+        return;
+    }
+
+    ecs_term_t *terms = filter->terms;
+    ecs_filter_plan_elem_t *elems = ecs_os_malloc_n(
+        ecs_filter_plan_elem_t, term_count);
+    int32_t elem_count = 0;
+
+    /* Insertion sort, terms of an Or chain are kept together as one element.
+     * Elements with the same cost remain in declaration order. */
+    for (i = 0; i < term_count; ) {
+        ecs_term_t *term = &terms[i];
+        int32_t count = 1;
+        if (term->oper == EcsOr) {
+            while ((i + count) < term_count && 
+                terms[i + count].oper == EcsOr &&
+                terms[i + count].field_index == term->field_index) 
+            {
+                count ++;
+            }
+        }
+
+        int64_t cost = flecs_filter_plan_cost(world, term);
+        for (j = elem_count; j > 0 && elems[j - 1].cost > cost; j --) {
+            elems[j] = elems[j - 1];
+        }
+
+        elems[j] = (ecs_filter_plan_elem_t){ 
+            .cost = cost, .term = i, .count = count };
+        elem_count ++;
+        i += count;
+    }
+
+    filter->plan = ecs_os_realloc_n(filter->plan, int32_t, term_count);
+
+    int32_t *plan = filter->plan;
+    for (i = 0; i < elem_count; i ++) {
+        for (j = 0; j < elems[i].count; j ++) {
+            plan[0] = elems[i].term + j;
+            plan ++;
+        }
+    }
+
+    ecs_os_free(elems);
+}
+
 int ecs_filter_finalize(
     const ecs_world_t *world,
     ecs_filter_t *f)
@@ -915,6 +1020,16 @@ int ecs_filter_finalize(
         prev_src_id = term->src.id;
         prev_or = is_or;
 
+        /* Sparse components are not stored in tables, so they can't be 
+         * matched by filters. Queries match them while iterating. */
+        if (!(f->flags & EcsFilterMatchSparse) && 
+            flecs_id_is_sparse(ecs_get_world(world), term->id)) 
+        {
+            flecs_filter_error(&ctx, 
+                "sparse component can only be matched by a query");
+            return -1;
+        }
+
         if (ecs_term_match_this(term)) {
             ECS_BIT_SET(f->flags, EcsFilterMatchThis);
         } else {
@@ -947,6 +1062,8 @@ int ecs_filter_finalize(
         ECS_BIT_SET(f->flags, EcsFilterIsFilter);
     }
 
+    flecs_filter_plan(ecs_get_world(world), f);
+
     return 0;
 }
 
@@ -1116,10 +1233,15 @@ void ecs_filter_copy(
         int32_t i, term_count = src->term_count;
         dst->terms = ecs_os_malloc_n(ecs_term_t, term_count);
         dst->terms_owned = true;
+        dst->plan = NULL;
 
         for (i = 0; i < term_count; i ++) {
             dst->terms[i] = ecs_term_copy(&src->terms[i]);
         }
+
+        if (src->plan) {
+            dst->plan = ecs_os_memdup_n(src->plan, int32_t, term_count);
+        }
     } else {
         ecs_os_memset_t(dst, 0, ecs_filter_t);
     }
@@ -1138,6 +1260,7 @@ void ecs_filter_move(
         if (src->terms_owned) {
             dst->terms = src->terms;
             dst->terms_owned = true;
+            src->plan = NULL;
         } else {
             ecs_filter_copy(dst, src);
         }
@@ -1163,9 +1286,12 @@ void ecs_filter_fini(
     }
 
     ecs_os_free(filter->name);
+    ecs_os_free(filter->plan);
 
     filter->terms = NULL;
+    filter->term_count = 0;
     filter->name = NULL;
+    filter->plan = NULL;
 
     if (filter->owned) {
         ecs_os_free(filter);
@@ -1638,16 +1764,22 @@ bool flecs_filter_match_table(
     ecs_flags32_t iter_flags)
 {
     ecs_term_t *terms = filter->terms;
-    int32_t i, count = filter->term_count;
+    const int32_t *plan = filter->plan;
+    int32_t p, count = filter->term_count;
 
     bool is_or = false;
     bool or_result = false;
+    int32_t or_field = -1;
     int32_t match_count = 1;
     if (matches_left) {
         match_count = *matches_left;
     }
 
-    for (i = 0; i < count; i ++) {
+    /* Terms are evaluated in the order of the filter plan (if any), which
+     * keeps the terms of an Or chain together. Because the plan may put two Or
+     * chains next to each other, chains are told apart by their field. */
+    for (p = 0; p < count; p ++) {
+        int32_t i = plan ? plan[p] : p;
         if (i == skip_term) {
             continue;
         }
@@ -1658,10 +1790,7 @@ bool flecs_filter_match_table(
         const ecs_table_t *match_table = table;
         int32_t t_i = term->field_index;
 
-        if (!is_or && oper == EcsOr) {
-            is_or = true;
-            or_result = false;
-        } else if (is_or && oper != EcsOr) {
+        if (is_or && (oper != EcsOr || t_i != or_field)) {
             if (!or_result) {
                 return false;
             }
@@ -1669,6 +1798,12 @@ bool flecs_filter_match_table(
             is_or = false;
         }
 
+        if (!is_or && oper == EcsOr) {
+            is_or = true;
+            or_result = false;
+            or_field = t_i;
+        }
+
         ecs_entity_t src_id = src->id;
         if (!src_id) {
             if (ids) {
@@ -1703,8 +1838,13 @@ bool flecs_filter_match_table(
             or_result |= result;
             if (result) {
                 /* If Or term matched, skip following Or terms */
-                for (; i < count && terms[i].oper == EcsOr; i ++) { }
-                i -- ;
+                for (; p < count; p ++) {
+                    const ecs_term_t *next = &terms[plan ? plan[p] : p];
+                    if (next->oper != EcsOr || next->field_index != or_field) {
+                        break;
+                    }
+                }
+                p -- ;
             }
         } else if (!result) {
             return false;
@@ -2152,7 +2292,8 @@ int32_t ecs_filter_pivot_term(
 
     ecs_term_t *terms = filter->terms;
     int32_t i, term_count = filter->term_count;
-    int32_t pivot_term = -1, min_count = -1, self_pivot_term = -1;
+    int32_t pivot_term = -1, min_count = -1;
+    bool pivot_self = false;
 
     for (i = 0; i < term_count; i ++) {
         ecs_term_t *term = &terms[i];
@@ -2173,20 +2314,21 @@ int32_t ecs_filter_pivot_term(
             return -2; /* -2 indicates filter doesn't match anything */
         }
 
+        /* Iterating a term that traverses relationships also visits the
+         * tables that inherit the id, so prefer any term that only matches
+         * on self. Between terms of the same kind pick the one with the
+         * fewest tables. */
         int32_t table_count = flecs_table_cache_count(&idr->cache);
-        if (min_count == -1 || table_count < min_count) {
+        bool self = (term->src.flags & EcsTraverseFlags) == EcsSelf;
+        if (pivot_term == -1 || (self && !pivot_self) || 
+           ((self == pivot_self) && (table_count < min_count))) 
+        {
             min_count = table_count;
             pivot_term = i;
-            if ((term->src.flags & EcsTraverseFlags) == EcsSelf) {
-                self_pivot_term = i;
-            }
+            pivot_self = self;
         }
     }
 
-    if (self_pivot_term != -1) {
-        pivot_term = self_pivot_term;
-    }
-
     return pivot_term;
 error:
     return -2;
@@ -2530,9 +2672,17 @@ error:
     return false;
 
 yield:
-    it->offset = 0;
-    flecs_iter_populate_data(world, it, table, 0, 
-        table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
+    if (chain_it && ECS_BIT_IS_SET(chain_it->flags, EcsIterRowRange)) {
+        /* Only return the rows returned by the chained iterator, which are a
+         * subset of the table (for example when it's an index iterator). */
+        it->offset = chain_it->offset;
+        flecs_iter_populate_data(world, it, table, chain_it->offset, 
+            chain_it->count, it->ptrs, it->sizes);
+    } else {
+        it->offset = 0;
+        flecs_iter_populate_data(world, it, table, 0, 
+            table ? ecs_table_count(table) : 0, it->ptrs, it->sizes);
+    }
     ECS_BIT_SET(it->flags, EcsIterIsValid);
     return true;    
 }
@@ -281,6 +281,157 @@ void flecs_id_record_assert_empty(
         ECS_INTERNAL_ERROR, NULL);
 }
 
+/* Invoke component hook for a sparse component of a single entity */
+static
+void flecs_sparse_component_hook(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_iter_action_t callback,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    void *ptr)
+{
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_t it = { .field_count = 1 };
+    it.entities = &entity;
+
+    flecs_iter_init(world, &it, flecs_iter_cache_all);
+    it.world = world;
+    it.real_world = world;
+    it.ptrs[0] = ptr;
+    it.sizes[0] = ti->size;
+    it.ids[0] = idr->id;
+    it.event = event;
+    it.event_id = idr->id;
+    it.ctx = ti->hooks.ctx;
+    it.binding_ctx = ti->hooks.binding_ctx;
+    it.count = 1;
+    flecs_iter_validate(&it);
+    callback(&it);
+    ecs_iter_fini(&it);
+}
+
+/* Register sparse component with the entity, so that deleting the entity only
+ * has to visit the sparse components it has. */
+static
+void flecs_sparse_entity_add(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    ecs_map_init_if(&world->store.sparse_entities, ecs_vec_t, 
+        &world->allocator, 0);
+    ecs_vec_t *idrs = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!idrs) {
+        idrs = ecs_map_ensure(&world->store.sparse_entities, ecs_vec_t, entity);
+        ecs_vec_init_t(&world->allocator, idrs, ecs_id_record_t*, 1);
+    }
+    ecs_vec_append_t(&world->allocator, idrs, ecs_id_record_t*)[0] = idr;
+}
+
+static
+void flecs_sparse_entity_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    if (!ecs_map_is_initialized(&world->store.sparse_entities)) {
+        return;
+    }
+
+    ecs_vec_t *idrs = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!idrs) {
+        return;
+    }
+
+    int32_t i, count = ecs_vec_count(idrs);
+    ecs_id_record_t **arr = ecs_vec_first(idrs);
+    for (i = 0; i < count; i ++) {
+        if (arr[i] == idr) {
+            ecs_vec_remove_t(idrs, ecs_id_record_t*, i);
+            break;
+        }
+    }
+
+    if (!ecs_vec_count(idrs)) {
+        ecs_vec_fini_t(&world->allocator, idrs, ecs_id_record_t*);
+        ecs_map_remove(&world->store.sparse_entities, entity);
+    }
+}
+
+static
+void flecs_sparse_component_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_action_t on_remove = ti ? ti->hooks.on_remove : NULL;
+    ecs_xtor_t dtor = ti ? ti->hooks.dtor : NULL;
+    if (on_remove || dtor) {
+        int32_t i, count = flecs_sparse_count(sparse);
+        const uint64_t *entities = flecs_sparse_ids(sparse);
+        for (i = 0; i < count; i ++) {
+            void *ptr = _flecs_sparse_get_dense(sparse, 0, i);
+            if (on_remove) {
+                flecs_sparse_component_hook(world, idr, on_remove, 
+                    EcsOnRemove, entities[i], ptr);
+            }
+            if (dtor) {
+                dtor(ptr, 1, ti);
+            }
+        }
+    }
+
+    int32_t i, count = flecs_sparse_count(sparse);
+    const uint64_t *entities = flecs_sparse_ids(sparse);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_entity_remove(world, entities[i], idr);
+    }
+
+    flecs_sparse_free(sparse);
+    idr->sparse = NULL;
+
+    count = ecs_vector_count(world->store.sparse_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.sparse_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (idrs[i] == idr) {
+            ecs_vector_remove(world->store.sparse_ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
+/* Free transitive closure of id record. Iterators that are yielding its tables
+ * keep the tables alive. */
+static
+void flecs_subset_cache_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_subset_cache_t *cache = idr->subsets;
+    flecs_subset_tables_release(cache->tables);
+    ecs_map_fini(&cache->table_refs);
+    ecs_map_fini(&cache->members);
+    ecs_vec_fini_t(&world->allocator, &cache->created, uint64_t);
+    ecs_vec_fini_t(&world->allocator, &cache->moved, ecs_entity_t);
+    ecs_os_free(cache);
+    idr->subsets = NULL;
+
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (idrs[i] == idr) {
+            ecs_vector_remove(world->store.subset_ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
 static
 void flecs_id_record_free(
     ecs_world_t *world,
@@ -350,9 +501,15 @@ void flecs_id_record_free(
     }
 
     /* Unregister the id record from the world & free resources */
+    if (idr->sparse) {
+        flecs_sparse_component_fini(world, idr);
+    }
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    if (idr->subsets) {
+        flecs_subset_cache_fini(world, idr);
+    }
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= ECS_HI_ID_RECORD_ID) {
@@ -568,6 +725,298 @@ const ecs_table_record_t* flecs_id_record_get_table(
     return (ecs_table_record_t*)ecs_table_cache_get(&idr->cache, table);
 }
 
+ecs_id_record_t* flecs_sparse_id_record_get(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr || !(idr->flags & EcsIdSparse) || !idr->type_info) {
+        return NULL;
+    }
+
+    return idr;
+}
+
+bool flecs_id_is_sparse(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return false;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr && ECS_IS_PAIR(id) && !ecs_id_is_wildcard(id)) {
+        /* Pair records inherit the Sparse flag from (R, *) on creation */
+        idr = flecs_id_record_get(world, 
+            ecs_pair(ECS_PAIR_FIRST(id), EcsWildcard));
+        return idr && (idr->flags & EcsIdSparse) && 
+            ecs_get_type_info(world, id) != NULL;
+    }
+
+    return idr && (idr->flags & EcsIdSparse) && idr->type_info;
+}
+
+ecs_id_record_t* flecs_sparse_id_record_ensure(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!flecs_id_is_sparse(world, id)) {
+        return NULL;
+    }
+
+    return flecs_id_record_ensure(world, id);
+}
+
+void* flecs_sparse_component_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return NULL;
+    }
+
+    /* Storage is keyed by the entity id including its generation, so that a
+     * recycled id doesn't get the component of a deleted entity. */
+    return _flecs_sparse_get(idr->sparse, 0, entity);
+}
+
+void* flecs_sparse_component_ensure(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    bool construct,
+    bool *is_new)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_assert(ti != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        sparse = idr->sparse = _flecs_sparse_new(&world->allocator, 
+            &world->allocators.sparse_chunk, ti->size);
+        ecs_vector_add(&world->store.sparse_ids, ecs_id_record_t*)[0] = idr;
+    } else {
+        void *ptr = _flecs_sparse_get(sparse, 0, entity);
+        if (ptr) {
+            if (is_new) {
+                *is_new = false;
+            }
+            return ptr;
+        }
+
+        /* Remove element left by a previous generation of the entity */
+        uint64_t prev = flecs_sparse_get_alive(sparse, (uint32_t)entity);
+        if (prev && _flecs_sparse_get(sparse, 0, prev)) {
+            flecs_sparse_component_remove(world, idr, prev);
+        }
+    }
+
+    /* Store element with the generation of the entity */
+    flecs_sparse_set_generation(sparse, entity);
+    void *ptr = _flecs_sparse_ensure(sparse, 0, entity);
+    if (construct) {
+        ecs_xtor_t ctor = ti->hooks.ctor;
+        if (ctor) {
+            ctor(ptr, 1, ti);
+        } else {
+            ecs_os_memset(ptr, 0, ti->size);
+        }
+    }
+
+    flecs_sparse_entity_add(world, entity, idr);
+
+    ecs_iter_action_t on_add = ti->hooks.on_add;
+    if (on_add) {
+        flecs_sparse_component_hook(world, idr, on_add, EcsOnAdd, entity, ptr);
+    }
+
+    if (is_new) {
+        *is_new = true;
+    }
+
+    return ptr;
+}
+
+void flecs_sparse_component_on_set(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    void *ptr)
+{
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_iter_action_t on_set = idr->type_info->hooks.on_set;
+    if (on_set) {
+        flecs_sparse_component_hook(world, idr, on_set, EcsOnSet, entity, ptr);
+    }
+}
+
+bool flecs_sparse_component_remove(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    (void)world;
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        return false;
+    }
+
+    void *ptr = _flecs_sparse_get(sparse, 0, entity);
+    if (!ptr) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    ecs_iter_action_t on_remove = ti->hooks.on_remove;
+    if (on_remove) {
+        flecs_sparse_component_hook(
+            world, idr, on_remove, EcsOnRemove, entity, ptr);
+    }
+
+    ecs_xtor_t dtor = ti->hooks.dtor;
+    if (dtor) {
+        dtor(ptr, 1, ti);
+    }
+
+    _flecs_sparse_remove_get(sparse, 0, entity);
+    flecs_sparse_entity_remove(world, entity, idr);
+    return true;
+}
+
+void flecs_sparse_components_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    if (!ecs_map_is_initialized(&world->store.sparse_entities)) {
+        return;
+    }
+
+    ecs_vec_t *ptr = ecs_map_get(
+        &world->store.sparse_entities, ecs_vec_t, entity);
+    if (!ptr) {
+        return;
+    }
+
+    /* Take the list out of the index, as hooks can add or remove sparse
+     * components, which invalidates pointers into the index. */
+    ecs_vec_t idrs = *ptr;
+    ecs_map_remove(&world->store.sparse_entities, entity);
+
+    int32_t i, count = ecs_vec_count(&idrs);
+    ecs_id_record_t **arr = ecs_vec_first(&idrs);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_component_remove(world, arr[i], entity);
+    }
+
+    ecs_vec_fini_t(&world->allocator, &idrs, ecs_id_record_t*);
+}
+
+void flecs_subset_tables_release(
+    ecs_subset_tables_t *tables)
+{
+    if (tables && !ecs_os_adec(&tables->refs)) {
+        ecs_vector_free(tables->tables);
+        ecs_os_free(tables);
+    }
+}
+
+ecs_subset_tables_t* flecs_subset_tables_mut(
+    ecs_subset_cache_t *cache)
+{
+    ecs_subset_tables_t *cur = cache->tables;
+    if (cur->refs == 1) {
+        return cur;
+    }
+
+    ecs_subset_tables_t *result = ecs_os_calloc_t(ecs_subset_tables_t);
+    result->tables = ecs_vector_copy(cur->tables, ecs_subset_elem_t);
+    result->refs = 1;
+    flecs_subset_tables_release(cur);
+    cache->tables = result;
+    return result;
+}
+
+void flecs_subset_cache_remove_table(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table)
+{
+    ecs_map_remove(&cache->table_refs, table->id);
+
+    /* Keep the order in which the hierarchy is walked */
+    ecs_subset_tables_t *tables = flecs_subset_tables_mut(cache);
+    int32_t i, j = 0, count = ecs_vector_count(tables->tables);
+    ecs_subset_elem_t *elems = ecs_vector_first(
+        tables->tables, ecs_subset_elem_t);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].table != table) {
+            elems[j ++] = elems[i];
+        }
+    }
+    ecs_vector_set_count(&tables->tables, ecs_subset_elem_t, j);
+}
+
+void flecs_subsets_table_created(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_id_record_t *idr = idrs[i];
+        ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+        if (flecs_table_record_get(world, table, ecs_pair(rel, EcsWildcard))) {
+            ecs_vec_append_t(&world->allocator, &idr->subsets->created, 
+                uint64_t)[0] = table->id;
+        }
+    }
+}
+
+void flecs_subsets_table_deleted(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_subset_cache_t *cache = idrs[i]->subsets;
+        if (ecs_map_get(&cache->table_refs, int32_t, table->id)) {
+            flecs_subset_cache_remove_table(cache, table);
+        }
+    }
+}
+
+void flecs_subsets_entity_moved(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    int32_t i, count = ecs_vector_count(world->store.subset_ids);
+    ecs_id_record_t **idrs = ecs_vector_first(
+        world->store.subset_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_id_record_t *idr = idrs[i];
+        ecs_subset_cache_t *cache = idr->subsets;
+
+        /* Only entities with subsets can change the closure */
+        ecs_entity_t rel = ECS_PAIR_FIRST(idr->id);
+        if (ecs_map_get(&cache->members, bool, entity) || 
+            flecs_id_record_get(world, ecs_pair(rel, entity))) 
+        {
+            ecs_vec_append_t(&world->allocator, &cache->moved, 
+                ecs_entity_t)[0] = entity;
+        }
+    }
+}
+
 void flecs_init_id_records(
     ecs_world_t *world)
 {
@@ -603,6 +1052,10 @@ void flecs_fini_id_records(
 
     ecs_map_fini(&world->id_index_hi);
     flecs_sparse_fini(&world->id_index_lo);
+    ecs_vector_free(world->store.sparse_ids);
+    ecs_map_fini(&world->store.sparse_entities);
+    ecs_vector_free(world->store.subset_ids);
     flecs_sparse_free(world->pending_tables);
     flecs_sparse_free(world->pending_buffer);
+    ecs_vector_free(world->pending_queries);
 }
@@ -34,6 +34,33 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+typedef struct ecs_subset_elem_t {
+    ecs_table_t *table;
+    int32_t column;
+} ecs_subset_elem_t;
+
+/* Tables of a transitive closure. Iterators that yield the tables hold a
+ * reference, so a closure that changes while it is iterated replaces its
+ * tables instead of modifying them. Tables use the OS heap, since a worker
+ * thread can release the last reference. */
+typedef struct ecs_subset_tables_t {
+    ecs_vector_t *tables; /* vector<ecs_subset_elem_t>, in depth-first order */
+    int32_t refs;         /* Cache + number of iterators yielding tables */
+} ecs_subset_tables_t;
+
+/* Transitive closure of a (R, tgt) pair: all tables that have the pair, or
+ * have (R, e) where e is in one of the tables of the closure. The storage
+ * queues tables with an R pair that are created, and targets that move to
+ * another table. Queued changes are applied the next time the closure is
+ * used. Deleted tables are removed right away. */
+typedef struct ecs_subset_cache_t {
+    ecs_subset_tables_t *tables;
+    ecs_map_t table_refs; /* map<table id, int32_t>, (R, member) pairs */
+    ecs_map_t members;    /* map<entity, bool>, entities with subsets in closure */
+    ecs_vec_t created;    /* vec<uint64_t>, ids of created tables */
+    ecs_vec_t moved;      /* vec<ecs_entity_t>, targets that changed table */
+} ecs_subset_cache_t;
+
 /* Payload for id index which contains all datastructures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -51,9 +78,17 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Transitive closure for pairs with a transitive relationship. Lazily 
+     * created by the rule engine. */
+    ecs_subset_cache_t *subsets;
+
     /* Cached pointer to type info for id, if id contains data. */
     const ecs_type_info_t *type_info;
 
+    /* Component storage for ids with the Sparse property. Lazily created when
+     * the id is added to its first entity. */
+    ecs_sparse_t *sparse; /* sparse<entity, T> */
+
     /* Id of record */
     ecs_id_t id;
 
@@ -126,6 +161,83 @@ const ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Get id record if id is stored in a sparse set */
+ecs_id_record_t* flecs_sparse_id_record_get(
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+/* Test if id is stored in a sparse set */
+bool flecs_id_is_sparse(
+    const ecs_world_t *world,
+    ecs_id_t id);
+
+/* Same as flecs_sparse_id_record_get, but creates the record if necessary */
+ecs_id_record_t* flecs_sparse_id_record_ensure(
+    ecs_world_t *world,
+    ecs_id_t id);
+
+/* Get sparse component for entity, or NULL if entity does not have it */
+void* flecs_sparse_component_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Get or add sparse component for entity. When the component is added the
+ * constructor is invoked if construct is true, followed by the on_add hook. */
+void* flecs_sparse_component_ensure(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    bool construct,
+    bool *is_new);
+
+/* Invoke on_set hook for sparse component of entity */
+void flecs_sparse_component_on_set(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity,
+    void *ptr);
+
+/* Remove sparse component from entity. Returns false if not found. */
+bool flecs_sparse_component_remove(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Remove all sparse components from entity (used when entity is deleted). Only
+ * visits the sparse components of the entity. */
+void flecs_sparse_components_remove(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Release reference to tables of transitive closure */
+void flecs_subset_tables_release(
+    ecs_subset_tables_t *tables);
+
+/* Get closure tables that can be modified. Tables that are being yielded by
+ * iterators are copied. */
+ecs_subset_tables_t* flecs_subset_tables_mut(
+    ecs_subset_cache_t *cache);
+
+/* Remove table from transitive closure */
+void flecs_subset_cache_remove_table(
+    ecs_subset_cache_t *cache,
+    ecs_table_t *table);
+
+/* Queue table with R pairs for the closures of R */
+void flecs_subsets_table_created(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Remove deleted table from closures */
+void flecs_subsets_table_deleted(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Queue pair target that moved to another table, or was deleted */
+void flecs_subsets_entity_moved(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
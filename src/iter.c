@@ -461,7 +461,8 @@ bool ecs_field_is_set(
 
     int32_t column = it->columns[index - 1];
     if (!column) {
-        return false;
+        /* Fields for sparse components are not stored in a table column */
+        return it->ptrs && it->ptrs[index - 1] != NULL;
     } else if (column < 0) {
         if (it->references) {
             column = -column - 1;
@@ -1076,6 +1077,240 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+/* Tell the CPU that the thread is spinning on a lock */
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define flecs_cpu_pause() __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define flecs_cpu_pause() __asm__ __volatile__("yield")
+#else
+#define flecs_cpu_pause()
+#endif
+
+/* Number of pause rounds after which a waiting worker yields its thread */
+#define ECS_WORKER_CURSOR_SPIN_COUNT (16)
+
+static
+void flecs_worker_cursor_lock(
+    ecs_worker_cursor_t *cursor)
+{
+    /* Only the thread that increments the lock from 0 to 1 owns it. The lock
+     * is only held while the position is advanced, so a waiting worker first
+     * spins with an increasing number of pauses before it yields the thread.
+     * Waiting workers only read the lock, so they don't slow down the owner. */
+    int32_t spin = 0;
+    while (ecs_os_ainc(&cursor->lock) != 1) {
+        ecs_os_adec(&cursor->lock);
+        do {
+            if (spin < ECS_WORKER_CURSOR_SPIN_COUNT) {
+                int32_t i, pauses = 1 << (spin / 4);
+                for (i = 0; i < pauses; i ++) {
+                    flecs_cpu_pause();
+                }
+                spin ++;
+            } else if (ecs_os_api.sleep_) {
+                ecs_os_sleep(0, 0);
+            }
+        } while (ecs_os_aload(&cursor->lock) != 0);
+    }
+}
+
+static
+void flecs_worker_cursor_unlock(
+    ecs_worker_cursor_t *cursor)
+{
+    ecs_os_adec(&cursor->lock);
+}
+
+static
+void flecs_worker_chunk_done(
+    ecs_iter_t *it)
+{
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    if (iter->chunk_done) {
+        return;
+    }
+
+    iter->chunk_done = true;
+
+    /* The last worker to finish resets the position, so that the cursor can be
+     * reused in the same frame. */
+    ecs_worker_cursor_t *cursor = iter->cursor;
+    flecs_worker_cursor_lock(cursor);
+    if (cursor->frame == iter->chunk_frame) {
+        if (++ cursor->done == iter->count) {
+            cursor->started = false;
+        }
+    }
+    flecs_worker_cursor_unlock(cursor);
+}
+
+static
+void flecs_worker_chunk_fini(
+    ecs_iter_t *it)
+{
+    /* Iterators that are finalized before they are depleted don't claim any
+     * more chunks, which must not prevent the cursor from being reset. */
+    flecs_worker_chunk_done(it);
+}
+
+ecs_iter_t ecs_worker_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count,
+    int32_t chunk_size,
+    ecs_worker_cursor_t *cursor)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, 
+        "chunked worker iterators require a query iterator");
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(cursor != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_worker_iter(it, index, count);
+    ecs_worker_iter_t *iter = &result.priv.iter.worker;
+    iter->chunk_size = chunk_size;
+    iter->chunk_frame = ecs_get_world_info(it->world)->frame_count_total;
+    iter->chunk_start = it->priv.iter.query.node;
+    iter->cursor = cursor;
+    result.fini = flecs_worker_chunk_fini;
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Claim the next chunk from the cursor. All workers share the position in the
+ * list of matched tables, so a worker only iterates the tables it claims. */
+static
+ecs_query_table_node_t* flecs_worker_chunk_claim(
+    ecs_iter_t *it)
+{
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    ecs_worker_cursor_t *cursor = iter->cursor;
+    int32_t chunk_size = iter->chunk_size;
+
+    flecs_worker_cursor_lock(cursor);
+
+    /* Reset the position for the first worker of a new frame, in case workers
+     * of a previous frame stopped before the last one finished. */
+    if (!cursor->started || cursor->frame != iter->chunk_frame) {
+        cursor->node = iter->chunk_start;
+        cursor->row = 0;
+        cursor->done = 0;
+        cursor->frame = iter->chunk_frame;
+        cursor->started = true;
+    }
+
+    ecs_query_table_node_t *node = cursor->node;
+    if (node) {
+        ecs_table_t *table = node->table;
+        if (table) {
+            int32_t count = node->count;
+            if (!count) {
+                count = ecs_table_count(table);
+            }
+
+            iter->chunk_first = node->offset + cursor->row;
+            cursor->row += chunk_size;
+            if (cursor->row < count) {
+                iter->chunk_last = iter->chunk_first + chunk_size;
+            } else {
+                iter->chunk_last = node->offset + count;
+                cursor->node = node->next;
+                cursor->row = 0;
+            }
+        } else {
+            /* Results without a table (tasks) are processed by one worker */
+            iter->chunk_first = 0;
+            iter->chunk_last = -1;
+            cursor->node = node->next;
+        }
+    }
+
+    flecs_worker_cursor_unlock(cursor);
+
+    return node;
+}
+
+static
+bool ecs_worker_chunk_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    bool instanced = ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced);
+    int32_t first = 0, last = 0;
+
+    if (iter->chunk_done) {
+        return false;
+    }
+
+    while (true) {
+        if (!iter->chunk_claimed) {
+            ecs_query_table_node_t *node = flecs_worker_chunk_claim(it);
+            flecs_query_iter_seek(chain_it, node);
+            if (!node) {
+                /* Finish up the last result before releasing the iterator */
+                flecs_query_iter_next(chain_it);
+                ecs_iter_fini(chain_it);
+                flecs_worker_chunk_done(it);
+                return false;
+            }
+            iter->chunk_claimed = true;
+        }
+
+        if (!flecs_query_iter_next(chain_it)) {
+            iter->chunk_claimed = false;
+            continue;
+        }
+
+        if (iter->chunk_last == -1) {
+            break;
+        }
+
+        /* A result can extend beyond the claimed chunk, as other workers 
+         * iterate other chunks of the same table */
+        first = chain_it->offset;
+        last = first + chain_it->count;
+        if (first < iter->chunk_first) {
+            first = iter->chunk_first;
+        }
+        if (last > iter->chunk_last) {
+            last = iter->chunk_last;
+        }
+        if (first < last) {
+            break;
+        }
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+
+    /* Keep instancing setting from original iterator */
+    ECS_BIT_COND(it->flags, EcsIterIsInstanced, instanced);
+
+    if (!it->table || iter->chunk_last == -1) {
+        return true;
+    }
+
+    int32_t offset = first - it->offset;
+    int32_t count = last - first;
+
+    it->instance_count = count;
+    it->frame_offset += offset;
+    flecs_offset_iter(it, offset);
+    it->count = count;
+
+    if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
+        it->offset = first;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+}
+
 static
 bool ecs_worker_next_instanced(
     ecs_iter_t *it)
@@ -1084,10 +1319,14 @@ bool ecs_worker_next_instanced(
     ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(it->next == ecs_worker_next, ECS_INVALID_PARAMETER, NULL);
 
+    ecs_worker_iter_t *iter = &it->priv.iter.worker;
+    if (iter->chunk_size) {
+        return ecs_worker_chunk_next_instanced(it);
+    }
+
     bool instanced = ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced);
 
     ecs_iter_t *chain_it = it->chain_it;
-    ecs_worker_iter_t *iter = &it->priv.iter.worker;
     int32_t res_count = iter->count, res_index = iter->index;
     int32_t per_worker, instances_per_worker, first;
 
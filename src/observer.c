@@ -370,6 +370,121 @@ void flecs_observers_invoke(
     }
 }
 
+/* Match filter of multi observer with table the event was emitted for */
+static
+bool flecs_multi_observer_match(
+    ecs_world_t *world,
+    ecs_observer_t *o,
+    ecs_iter_t *user_it,
+    const ecs_table_t *table,
+    const ecs_table_t *prev_table,
+    ecs_term_t *term)
+{
+    if (!flecs_filter_match_table(world, &o->filter, table, user_it->ids, 
+        user_it->columns, user_it->sources, NULL, NULL, false, -1, 
+        user_it->flags))
+    {
+        return false;
+    }
+
+    /* Monitor observers only invoke when the filter matches for the first
+     * time with an entity */
+    if (o->is_monitor) {
+        if (flecs_filter_match_table(world, &o->filter, prev_table, 
+            NULL, NULL, NULL, NULL, NULL, true, -1, user_it->flags)) 
+        {
+            return false;
+        }
+    }
+
+    /* While filter matching needs to be reversed for a Not term, the
+     * component data must be fetched from the table we got notified for.
+     * Repeat the matching process for the non-matching table so we get the
+     * correct column ids and sources, which we need for populate_data */
+    if (term->oper == EcsNot) {
+        flecs_filter_match_table(world, &o->filter, prev_table, user_it->ids, 
+            user_it->columns, user_it->sources, NULL, NULL, false, -1, 
+            user_it->flags | EcsFilterPopulate);
+    }
+
+    return true;
+}
+
+/* Filter results can only be cached if they only depend on the table. Terms
+ * that traverse IsA only depend on other entities if a table has an IsA pair,
+ * which is checked when the cache is accessed. */
+static
+bool flecs_multi_observer_can_cache(
+    const ecs_filter_t *filter,
+    bool *has_up)
+{
+    int32_t i, count = filter->term_count;
+    *has_up = false;
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &filter->terms[i];
+        if (term->oper == EcsAndFrom || term->oper == EcsOrFrom) {
+            return false;
+        }
+        if (term->src.id && !ecs_term_match_this(term)) {
+            return false;
+        }
+        if (term->src.flags & EcsUp) {
+            if (term->src.trav != EcsIsA) {
+                return false;
+            }
+            *has_up = true;
+        }
+    }
+    return true;
+}
+
+static
+ecs_observer_match_t* flecs_multi_observer_cache_get(
+    ecs_world_t *world,
+    ecs_observer_t *o,
+    const ecs_table_t *table,
+    const ecs_table_t *prev_table,
+    ecs_entity_t event,
+    int32_t pivot_term,
+    int32_t column,
+    bool *hit)
+{
+    ecs_observer_match_cache_t *cache = o->match_cache;
+    *hit = false;
+    if (!cache) {
+        return NULL;
+    }
+
+    if (cache->has_up && 
+        ((table->flags | prev_table->flags) & EcsTableHasIsA)) 
+    {
+        return NULL;
+    }
+
+    /* A deleted table can't be matched anymore, but its address may be reused
+     * by a new table with a different type. */
+    int32_t i;
+    if (cache->table_delete_total != world->info.table_delete_total) {
+        for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+            cache->entries[i].table = NULL;
+        }
+        cache->table_delete_total = world->info.table_delete_total;
+    }
+
+    uint64_t hash = table->id ^ (prev_table->id << 3) ^ 
+        (uint64_t)event ^ (uint64_t)pivot_term;
+    ecs_observer_match_t *m = &cache->entries[
+        hash % FLECS_OBSERVER_MATCH_CACHE_SIZE];
+    if (m->table == table && m->prev_table == prev_table && 
+        m->event == event && m->pivot_term == pivot_term && 
+        m->column == column) 
+    {
+        *hit = true;
+    }
+
+    return m;
+}
+
 static
 bool flecs_multi_observer_invoke(ecs_iter_t *it) {
     ecs_observer_t *o = it->ctx;
@@ -420,30 +535,43 @@ bool flecs_multi_observer_invoke(ecs_iter_t *it) {
     user_it.columns[0] = 0;
     user_it.columns[pivot_term] = column;
 
-    if (flecs_filter_match_table(world, &o->filter, table, user_it.ids, 
-        user_it.columns, user_it.sources, NULL, NULL, false, -1, 
-        user_it.flags))
-    {
-        /* Monitor observers only invoke when the filter matches for the first
-         * time with an entity */
-        if (o->is_monitor) {
-            if (flecs_filter_match_table(world, &o->filter, prev_table, 
-                NULL, NULL, NULL, NULL, NULL, true, -1, user_it.flags)) 
-            {
-                goto done;
-            }
+    /* Events for the same table produce the same result, so that bulk 
+     * operations only evaluate the filter once per table */
+    int32_t field_count = o->filter.field_count;
+    bool hit, match;
+    ecs_observer_match_t *cached = flecs_multi_observer_cache_get(world, o, 
+        table, prev_table, it->event, pivot_term, column, &hit);
+    if (hit) {
+        match = cached->match;
+        if (match) {
+            ecs_os_memcpy_n(user_it.ids, cached->ids, ecs_id_t, field_count);
+            ecs_os_memcpy_n(user_it.columns, cached->columns, int32_t, 
+                field_count);
+            ecs_os_memcpy_n(user_it.sources, cached->sources, ecs_entity_t, 
+                field_count);
         }
-
-        /* While filter matching needs to be reversed for a Not term, the
-         * component data must be fetched from the table we got notified for.
-         * Repeat the matching process for the non-matching table so we get the
-         * correct column ids and sources, which we need for populate_data */
-        if (term->oper == EcsNot) {
-            flecs_filter_match_table(world, &o->filter, prev_table, user_it.ids, 
-                user_it.columns, user_it.sources, NULL, NULL, false, -1, 
-                user_it.flags | EcsFilterPopulate);
+    } else {
+        match = flecs_multi_observer_match(
+            world, o, &user_it, table, prev_table, term);
+        if (cached) {
+            cached->table = table;
+            cached->prev_table = prev_table;
+            cached->event = it->event;
+            cached->pivot_term = pivot_term;
+            cached->column = column;
+            cached->match = match;
+            if (match) {
+                ecs_os_memcpy_n(cached->ids, user_it.ids, ecs_id_t, 
+                    field_count);
+                ecs_os_memcpy_n(cached->columns, user_it.columns, int32_t, 
+                    field_count);
+                ecs_os_memcpy_n(cached->sources, user_it.sources, 
+                    ecs_entity_t, field_count);
+            }
         }
+    }
 
+    if (match) {
         flecs_iter_populate_data(world, &user_it, it->table, it->offset, 
             it->count, user_it.ptrs, user_it.sizes);
 
@@ -461,7 +589,6 @@ bool flecs_multi_observer_invoke(ecs_iter_t *it) {
         return true;
     }
 
-done:
     ecs_iter_fini(&user_it);
     return false;
 }
@@ -654,8 +781,23 @@ int flecs_multi_observer_init(
     /* Mark observer as multi observer */
     observer->is_multi = true;
 
-    /* Create a child observer for each term in the filter */
+    /* Cache filter results if they only depend on the matched table */
     ecs_filter_t *filter = &observer->filter;
+    bool has_up;
+    if (flecs_multi_observer_can_cache(filter, &has_up)) {
+        int32_t i, field_count = filter->field_count;
+        ecs_observer_match_cache_t *cache = observer->match_cache = 
+            ecs_os_calloc_t(ecs_observer_match_cache_t);
+        cache->has_up = has_up;
+        for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+            ecs_observer_match_t *m = &cache->entries[i];
+            m->ids = ecs_os_calloc_n(ecs_id_t, field_count);
+            m->columns = ecs_os_calloc_n(int32_t, field_count);
+            m->sources = ecs_os_calloc_n(ecs_entity_t, field_count);
+        }
+    }
+
+    /* Create a child observer for each term in the filter */
     ecs_observer_desc_t child_desc = *desc;
     child_desc.last_event_id = observer->last_event_id;
     child_desc.run = NULL;
@@ -792,6 +934,9 @@ ecs_entity_t ecs_observer_init(
          * filter will have the name of the observer. */
         ecs_filter_desc_t filter_desc = desc->filter;
         filter_desc.name = ecs_get_name(world, entity);
+        if (desc->batched) {
+            filter_desc.instanced = true;
+        }
         ecs_filter_t *filter = filter_desc.storage = &observer->filter;
         *filter = ECS_FILTER_INIT;
 
@@ -928,6 +1073,18 @@ void flecs_observer_fini(
     if (observer->is_multi) {
         /* Child observers get deleted up by entity cleanup logic */
         ecs_os_free(observer->last_event_id);
+
+        ecs_observer_match_cache_t *cache = observer->match_cache;
+        if (cache) {
+            int32_t i;
+            for (i = 0; i < FLECS_OBSERVER_MATCH_CACHE_SIZE; i ++) {
+                ecs_observer_match_t *m = &cache->entries[i];
+                ecs_os_free(m->ids);
+                ecs_os_free(m->columns);
+                ecs_os_free(m->sources);
+            }
+            ecs_os_free(cache);
+        }
     } else {
         if (observer->filter.term_count) {
             flecs_unregister_observer(
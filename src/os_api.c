@@ -26,11 +26,27 @@ int64_t ecs_os_api_realloc_count = 0;
 int64_t ecs_os_api_calloc_count = 0;
 int64_t ecs_os_api_free_count = 0;
 
+/* Atomic load for OS API implementations that don't provide one. MSVC gives
+ * volatile loads acquire semantics on the platforms it supports. */
+static
+int32_t ecs_os_api_aload(
+    const int32_t *value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+    return *(const volatile int32_t*)value;
+#endif
+}
+
 void ecs_os_set_api(
     ecs_os_api_t *os_api)
 {
     if (!ecs_os_api_initialized) {
         ecs_os_api = *os_api;
+        if (!ecs_os_api.aload_) {
+            ecs_os_api.aload_ = ecs_os_api_aload;
+        }
         ecs_os_api_initialized = true;
     }
 }
@@ -434,6 +450,11 @@ void ecs_os_set_api_defaults(void)
         ecs_os_api.module_to_etc_ = ecs_os_api_module_to_etc;
     }
 
+    /* Atomics */
+    if (!ecs_os_api.aload_) {
+        ecs_os_api.aload_ = ecs_os_api_aload;
+    }
+
     ecs_os_api.abort_ = abort;
 
 #   ifdef FLECS_OS_API_IMPL
@@ -466,7 +487,7 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL);
 }
 
 bool ecs_os_has_time(void) {
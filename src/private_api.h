@@ -129,6 +129,19 @@ void flecs_query_notify(
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+bool flecs_query_update_table_array(
+    ecs_query_t *query);
+
+/* Find next result without finalizing the iterator when it is depleted */
+bool flecs_query_iter_next(
+    ecs_iter_t *it);
+
+/* Restrict query iterator to the results of a single table node. Used by
+ * chunked worker iterators to iterate the tables they claimed. */
+void flecs_query_iter_seek(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node);
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
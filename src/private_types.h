@@ -27,6 +27,9 @@ extern const ecs_entity_t EcsFlag;
 
 #define ECS_MAX_JOBS_PER_WORKER (16)
 
+/* Number of rows per block for which changes are tracked by dirty_blocks */
+#define ECS_DIRTY_BLOCK_SIZE (64)
+
 /* Magic number for a flecs object */
 #define ECS_OBJECT_MAGIC (0x6563736f)
 
@@ -183,6 +186,8 @@ struct ecs_table_t {
     ecs_type_info_t **type_info;     /* Cached type info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_vec_t *dirty_blocks;         /* Per column, dirty state for each block
+                                      * of rows (only for changed_only queries) */
 
     int16_t sw_count;
     int16_t sw_offset;
@@ -230,6 +235,13 @@ typedef struct flecs_bitset_term_t {
     int32_t column_index;
 } flecs_bitset_term_t;
 
+/* Query term for component stored in sparse set */
+typedef struct flecs_sparse_join_term_t {
+    ecs_id_record_t *idr;
+    ecs_oper_kind_t oper;
+    int32_t field_index;
+} flecs_sparse_join_term_t;
+
 typedef struct ecs_query_table_match_t ecs_query_table_match_t;
 
 /** List node used to iterate tables in a query.
@@ -266,6 +278,35 @@ struct ecs_query_table_match_t {
     int32_t *monitor;         /* Used to monitor table for changes */
 };
 
+/** Match fields that are read for each iterated table */
+typedef struct ecs_query_table_data_t {
+    int32_t *columns;
+    int32_t *storage_columns;
+    ecs_id_t *ids;
+    ecs_entity_t *sources;
+    ecs_size_t *sizes;
+    ecs_ref_t *references;
+    ecs_vector_t *sparse_columns;
+    ecs_vector_t *bitset_columns;
+} ecs_query_table_data_t;
+
+/** Element of a table array. Stores a copy of the list node and match data,
+ * so that iterating the array doesn't dereference the match. */
+typedef struct ecs_query_table_elem_t {
+    ecs_query_table_node_t node; /* Must be first, iterators walk the nodes */
+    ecs_query_table_data_t data;
+} ecs_query_table_elem_t;
+
+/** Contiguous array with the tables of a query, in iteration order. Iterators 
+ * hold a reference to the array, which is replaced instead of modified while
+ * it is referenced. */
+struct ecs_query_table_array_t {
+    ecs_query_table_elem_t *elems;
+    int32_t count;
+    int32_t size;
+    int32_t refs;                    /* Query + number of iterators */
+};
+
 /** A single table can occur multiple times in the cache when a term matches
  * multiple table columns. */
 typedef struct ecs_query_table_t {
@@ -315,9 +356,21 @@ struct ecs_query_t {
     /* Tables matched with query */
     ecs_table_cache_t cache;
 
+    /* Terms for components stored in sparse sets, which are joined with the
+     * rows of matched tables during iteration */
+    ecs_vector_t *sparse_terms; /* vector<flecs_sparse_join_term_t> */
+
+    /* Filter used to match tables if the query has sparse terms. The sparse
+     * terms are optional in this filter. */
+    ecs_filter_t match_filter;
+
     /* Linked list with all matched non-empty tables, in iteration order */
     ecs_query_table_list_t list;
 
+    /* Contiguous copy of list nodes, so iteration doesn't chase pointers */
+    ecs_query_table_array_t *table_array;
+    ecs_vector_t *table_array_retired; /* vector<ecs_query_table_array_t*> */
+
     /* Contains head/tail to nodes of query groups (if group_by is used) */
     ecs_map_t groups;
 
@@ -376,6 +429,34 @@ typedef struct ecs_event_id_record_t {
     int32_t observer_count;
 } ecs_event_id_record_t;
 
+/** Number of filter match results cached by a multi observer */
+#define FLECS_OBSERVER_MATCH_CACHE_SIZE (8)
+
+/** Result of matching the filter of a multi observer with a table */
+typedef struct ecs_observer_match_t {
+    const ecs_table_t *table;      /* Table the event was emitted for */
+    const ecs_table_t *prev_table; /* Table before the event (monitor, Not) */
+    ecs_entity_t event;
+    int32_t pivot_term;            /* Term of the child observer */
+    int32_t column;                /* Column of the pivot term */
+    bool match;
+
+    /* Field data of the match, field_count elements each */
+    ecs_id_t *ids;
+    int32_t *columns;
+    ecs_entity_t *sources;
+} ecs_observer_match_t;
+
+/** Filter match results of a multi observer, so that events for the same
+ * table don't have to evaluate the filter again. Since a table type never
+ * changes, results only become invalid when a table is deleted, after which
+ * its address could be reused by a new table. */
+typedef struct ecs_observer_match_cache_t {
+    ecs_observer_match_t entries[FLECS_OBSERVER_MATCH_CACHE_SIZE];
+    int64_t table_delete_total;    /* Value of world counter when filled */
+    bool has_up;                   /* Filter has terms that traverse IsA */
+} ecs_observer_match_cache_t;
+
 /* World level allocators are for operations that are not multithreaded */
 typedef struct ecs_world_allocators_t {
     ecs_map_params_t ptr;
@@ -443,6 +524,13 @@ typedef struct ecs_cmd_t {
     } is;
 } ecs_cmd_t;
 
+/* Range of commands in the queue of a stage */
+typedef struct ecs_cmd_range_t {
+    int32_t stage;              /* Stage index */
+    int32_t first;              /* First command in range */
+    int32_t count;              /* Number of commands in range */
+} ecs_cmd_range_t;
+
 /* Entity specific metadata for command in defer queue */
 typedef struct ecs_cmd_entry_t {
     int32_t first;
@@ -526,8 +614,67 @@ typedef struct ecs_store_t {
 
     /* Stack of ids being deleted. */
     ecs_vector_t *marked_ids;    /* vector<ecs_marked_ids_t> */
+
+    /* Id records with sparse component storage */
+    ecs_vector_t *sparse_ids;    /* vector<ecs_id_record_t*> */
+
+    /* Sparse components per entity */
+    ecs_map_t sparse_entities;   /* map<entity, vec<ecs_id_record_t*>> */
+
+    /* Id records with a transitive closure */
+    ecs_vector_t *subset_ids;    /* vector<ecs_id_record_t*> */
 } ecs_store_t;
 
+/* Component value that is written to storage after the structural changes of
+ * a merge have been applied (see ecs_set_parallel_merge) */
+typedef struct ecs_merge_write_t {
+    ecs_entity_t entity;
+    ecs_id_t id;
+    void *value;
+    ecs_size_t size;
+
+    /* Storage location, resolved right before the value is written */
+    int32_t row;
+    int32_t column;
+    int32_t order;               /* Position in queue, used for stable sort */
+    ecs_table_t *table;
+} ecs_merge_write_t;
+
+/* Job that writes part of the values of a parallel merge. The job is invoked
+ * on multiple threads at the same time, which claim work until none is left. */
+typedef void (*ecs_merge_job_action_t)(
+    ecs_world_t *world,
+    void *ctx);
+
+/* Run merge job on all threads, returns when all threads are done */
+typedef void (*ecs_merge_run_action_t)(
+    ecs_world_t *world,
+    ecs_merge_job_action_t job,
+    void *ctx);
+
+/* Command in a command queue. The value of a set command is stored in the
+ * same slot, directly after the element. */
+typedef struct ecs_cmd_queue_elem_t {
+    ecs_cmd_kind_t kind;
+    ecs_size_t size;
+    ecs_entity_t entity;
+    ecs_id_t id;
+} ecs_cmd_queue_elem_t;
+
+/* Bounded queue that a single producer thread adds commands to, and that is
+ * merged by the thread that owns the world. */
+struct ecs_cmd_queue_t {
+    ecs_world_t *world;
+    void *slots;                 /* Ring buffer with capacity slots */
+    ecs_size_t slot_size;        /* Size of element + value */
+    ecs_size_t value_size;       /* Max size of value */
+    int32_t capacity;
+    int32_t head;                /* Next slot to write (producer) */
+    int32_t tail;                /* Next slot to read (consumer) */
+    int32_t count;               /* Number of published commands */
+    int32_t used;                /* Number of slots that can't be written */
+};
+
 /* fini actions */
 typedef struct ecs_action_elem_t {
     ecs_fini_action_t action;
@@ -568,6 +715,7 @@ struct ecs_world_t {
     /* --  Pending table event buffers -- */
     ecs_sparse_t *pending_buffer;  /* sparse<table_id, ecs_table_t*> */
     ecs_sparse_t *pending_tables;  /* sparse<table_id, ecs_table_t*> */
+    ecs_vector_t *pending_queries; /* vector<ecs_query_t*>, table array updates */
 
     /* Used to track when cache needs to be updated */
     ecs_monitor_set_t monitors;    /* map<id, ecs_monitor_t> */
@@ -589,6 +737,21 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t workers_gen;         /* Incremented each time workers are signaled */
+    bool sync_parked;            /* Whether main thread blocks on sync_cond */
+
+    /* -- Command queues -- */
+    ecs_vec_t cmd_queues;        /* vec<ecs_cmd_queue_t*> */
+
+    /* -- Parallel merge -- */
+    ecs_vec_t merge_writes;      /* vec<ecs_merge_write_t> */
+    ecs_merge_run_action_t merge_run; /* Set while workers can run merge jobs */
+    ecs_merge_job_action_t merge_job; /* Job that workers should run */
+    void *merge_job_ctx;         /* Context passed to merge job */
+    int32_t merge_jobs_done;     /* Number of workers that finished job */
+    const ecs_cmd_range_t *merge_order; /* If set, order of stage merge */
+    int32_t merge_order_count;   /* Number of ranges in merge_order */
 
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
@@ -205,6 +205,21 @@ ecs_query_table_list_t* flecs_query_ensure_node_list(
     }
 }
 
+/* Mark table array of query as outdated. The query is added to a queue on the
+ * world, so that only queries with changed tables are updated. */
+static
+void flecs_query_table_array_dirty(
+    ecs_query_t *query)
+{
+    query->flags |= EcsQueryTableArrayDirty;
+    if (!(query->flags & EcsQueryTableArrayQueued)) {
+        ecs_query_t **elem = ecs_vector_add(
+            &query->world->pending_queries, ecs_query_t*);
+        *elem = query;
+        query->flags |= EcsQueryTableArrayQueued;
+    }
+}
+
 /* Remove node from list */
 static
 void flecs_query_remove_table_node(
@@ -294,6 +309,7 @@ void flecs_query_remove_table_node(
     node->next = NULL;
 
     query->match_count ++;
+    flecs_query_table_array_dirty(query);
 }
 
 /* Add node to list */
@@ -357,6 +373,7 @@ void flecs_query_insert_table_node(
 
     query->list.info.table_count ++;
     query->match_count ++;
+    flecs_query_table_array_dirty(query);
 
     ecs_assert(node->prev != node, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(node->next != node, ECS_INTERNAL_ERROR, NULL);
@@ -765,6 +782,9 @@ void flecs_query_set_table_match(
     int32_t field_count = filter->field_count;
     ecs_term_t *terms = filter->terms;
 
+    /* Table arrays store pointers to match resources */
+    flecs_query_table_array_dirty(query);
+
     /* Reset resources in case this is an existing record */
     if (qm->sparse_columns) {
         ecs_vector_free(qm->sparse_columns);
@@ -794,6 +814,11 @@ void flecs_query_set_table_match(
             }
         }
 
+        /* Track changes per block of rows for changed_only queries */
+        if (query->flags & EcsQueryChangedOnly) {
+            flecs_table_get_dirty_blocks(world, table);
+        }
+
         /* Look for union fields */
         if (table->flags & EcsTableHasUnion) {
             for (i = 0; i < term_count; i ++) {
@@ -826,6 +851,20 @@ void flecs_query_set_table_match(
             }
         }
 
+        /* Sparse fields are not stored in the table */
+        if (query->flags & EcsQueryHasSparse) {
+            int32_t count = ecs_vector_count(query->sparse_terms);
+            flecs_sparse_join_term_t *jt = ecs_vector_first(
+                query->sparse_terms, flecs_sparse_join_term_t);
+            for (i = 0; i < count; i ++) {
+                int32_t field = jt[i].field_index;
+                if (!qm->columns[field]) {
+                    qm->ids[field] = jt[i].idr->id;
+                    qm->sizes[field] = jt[i].idr->type_info->size;
+                }
+            }
+        }
+
         /* Look for disabled fields */
         if (table->flags & EcsTableHasToggle) {
             for (i = 0; i < term_count; i ++) {
@@ -878,6 +917,17 @@ void flecs_query_set_table_match(
     }
 }
 
+/* Filter used to match tables with the query */
+static
+ecs_filter_t* flecs_query_match_filter(
+    ecs_query_t *query)
+{
+    if (query->flags & EcsQueryHasSparse) {
+        return &query->match_filter;
+    }
+    return &query->filter;
+}
+
 /** Populate query cache with tables */
 static
 void flecs_query_match_tables(
@@ -887,7 +937,7 @@ void flecs_query_match_tables(
     ecs_table_t *table = NULL;
     ecs_query_table_t *qt = NULL;
 
-    ecs_iter_t it = ecs_filter_iter(world, &query->filter);
+    ecs_iter_t it = ecs_filter_iter(world, flecs_query_match_filter(query));
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
     ECS_BIT_SET(it.flags, EcsIterIsFilter);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
@@ -916,7 +966,7 @@ bool flecs_query_match_table(
     }
 
     ecs_query_table_t *qt = NULL;
-    ecs_filter_t *filter = &query->filter;
+    ecs_filter_t *filter = flecs_query_match_filter(query);
     int var_id = ecs_filter_find_this_var(filter);
     if (var_id == -1) {
         /* If query doesn't match with This term, it can't match with tables */
@@ -944,6 +994,60 @@ bool flecs_query_match_table(
 
 ECS_SORT_TABLE_WITH_COMPARE(_, flecs_query_sort_table_generic, order_by, static)
 
+/* Max number of out of order rows for which insertion sort is used instead of
+ * a full sort. Tables of a sorted query are typically already sorted, except
+ * for a few rows that were added or changed since the last sort. */
+#define ECS_SORT_INSERTION_THRESHOLD (16)
+
+/* Min number of rows per out of order row for insertion sort. Small tables are
+ * cheap to sort regardless, and use the regular sort. */
+#define ECS_SORT_INSERTION_RATIO (32)
+
+/* Count number of rows that compare lower than their predecessor */
+static
+int32_t flecs_query_count_unsorted(
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, result = 0;
+    for (i = 1; i < count; i ++) {
+        if (compare(entities[i - 1], ECS_ELEM(ptr, size, i - 1),
+            entities[i], ECS_ELEM(ptr, size, i)) > 0)
+        {
+            result ++;
+        }
+    }
+    return result;
+}
+
+/* Insertion sort only moves a row past rows that compare higher, so rows with
+ * equal values keep their order. */
+static
+void flecs_query_insertion_sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, j;
+    for (i = 1; i < count; i ++) {
+        for (j = i; j > 0; j --) {
+            if (compare(entities[j - 1], ECS_ELEM(ptr, size, j - 1),
+                entities[j], ECS_ELEM(ptr, size, j)) <= 0)
+            {
+                break;
+            }
+            ecs_table_swap_rows(world, table, j - 1, j);
+        }
+    }
+}
+
 static
 void flecs_query_sort_table(
     ecs_world_t *world,
@@ -974,6 +1078,24 @@ void flecs_query_sort_table(
         ptr = ecs_vec_first(column);
     }
 
+    /* A table is marked dirty when any of its rows is written, which doesn't
+     * mean that its order changed. Do a linear pass first to find out if (and
+     * how much) sorting is necessary. Both shortcuts keep the order of rows
+     * with equal values, so equal rows don't swap places on each resort. */
+    int32_t unsorted = flecs_query_count_unsorted(
+        entities, ptr, size, count, compare);
+    if (!unsorted) {
+        return;
+    }
+
+    if (unsorted <= ECS_SORT_INSERTION_THRESHOLD && 
+        (unsorted * ECS_SORT_INSERTION_RATIO) <= count) 
+    {
+        flecs_query_insertion_sort_table(
+            world, table, entities, ptr, size, count, compare);
+        return;
+    }
+
     if (sort) {
         sort(world, table, entities, ptr, size, 0, count - 1, compare);
     } else {
@@ -1017,6 +1139,54 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Returns true if the current row of helper a sorts before helper b. Ties are
+ * resolved by helper index, so that rows from tables earlier in the list come
+ * first. */
+static
+bool flecs_query_sort_helper_lt(
+    sort_helper_t *helper,
+    int32_t a,
+    int32_t b,
+    ecs_order_by_action_t compare)
+{
+    int r = compare(e_from_helper(&helper[a]), ptr_from_helper(&helper[a]),
+        e_from_helper(&helper[b]), ptr_from_helper(&helper[b]));
+    if (r) {
+        return r < 0;
+    }
+    return a < b;
+}
+
+static
+void flecs_query_sort_heap_down(
+    sort_helper_t *helper,
+    int32_t *heap,
+    int32_t count,
+    int32_t i,
+    ecs_order_by_action_t compare)
+{
+    for (;;) {
+        int32_t min = i, l = 2 * i + 1, r = l + 1;
+        if (l < count && flecs_query_sort_helper_lt(
+            helper, heap[l], heap[min], compare))
+        {
+            min = l;
+        }
+        if (r < count && flecs_query_sort_helper_lt(
+            helper, heap[r], heap[min], compare))
+        {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+        int32_t tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    }
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -1084,56 +1254,43 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
-        }
-
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
-            }
-
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
-
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
-            }
-        }
-
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
-            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->match = cur_helper->match;
-            cur->offset = cur_helper->row;
-            cur->count = 1;
+    /* Merge sorted tables with a min-heap of helpers, ordered by the current
+     * row of each helper. Popping the next row is O(log k) in the number of
+     * tables, instead of a linear scan over all helpers. */
+    int32_t i, heap_count = to_sort;
+    int32_t *heap = ecs_os_malloc_n(int32_t, to_sort);
+    for (i = 0; i < to_sort; i ++) {
+        heap[i] = i;
+    }
+    for (i = heap_count / 2 - 1; i >= 0; i --) {
+        flecs_query_sort_heap_down(helper, heap, heap_count, i, compare);
+    }
+
+    ecs_query_table_node_t *slice = NULL;
+    while (heap_count) {
+        sort_helper_t *cur_helper = &helper[heap[0]];
+        if (!slice || slice->match != cur_helper->match) {
+            slice = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
+            ecs_assert(slice != NULL, ECS_INTERNAL_ERROR, NULL);
+            slice->match = cur_helper->match;
+            slice->offset = cur_helper->row;
+            slice->count = 1;
         } else {
-            cur->count ++;
+            slice->count ++;
         }
 
         cur_helper->row ++;
-    } while (proceed);
+        if (cur_helper->row == cur_helper->count) {
+            heap[0] = heap[-- heap_count];
+        }
+        flecs_query_sort_heap_down(helper, heap, heap_count, 0, compare);
+    }
+
+    ecs_os_free(heap);
 
     /* Iterate through the vector of slices to set the prev/next ptrs. This
      * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vector_count(query->table_slices);    
+    int32_t count = ecs_vector_count(query->table_slices);
     ecs_query_table_node_t *nodes = ecs_vector_first(
         query->table_slices, ecs_query_table_node_t);
     for (i = 0; i < count; i ++) {
@@ -1178,6 +1335,174 @@ void flecs_query_build_sorted_tables(
     }
 }
 
+static
+void flecs_query_table_data_init(
+    ecs_query_table_data_t *data,
+    ecs_query_table_match_t *match)
+{
+    data->columns = match->columns;
+    data->storage_columns = match->storage_columns;
+    data->ids = match->ids;
+    data->sources = match->sources;
+    data->sizes = match->sizes;
+    data->references = ecs_vec_first(&match->refs);
+    data->sparse_columns = match->sparse_columns;
+    data->bitset_columns = match->bitset_columns;
+}
+
+static
+void flecs_query_table_array_free(
+    ecs_query_table_array_t *array)
+{
+    ecs_os_free(array->elems);
+    ecs_os_free(array);
+}
+
+/* Free retired arrays that are no longer used by iterators. Returns the number
+ * of arrays that are still in use. */
+static
+int32_t flecs_query_table_array_sweep(
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->table_array_retired);
+    ecs_query_table_array_t **arrays = ecs_vector_first(
+        query->table_array_retired, ecs_query_table_array_t*);
+    
+    for (i = count - 1; i >= 0; i --) {
+        if (!ecs_os_aload(&arrays[i]->refs)) {
+            flecs_query_table_array_free(arrays[i]);
+            arrays[i] = arrays[-- count];
+        }
+    }
+
+    ecs_vector_set_count(&query->table_array_retired, 
+        ecs_query_table_array_t*, count);
+
+    return count;
+}
+
+/* Build array with copies of the list nodes. Iterating the array is a linear
+ * scan, whereas nodes in the list are scattered across match allocations. The
+ * array is only rebuilt on the main thread after the set of iterated tables
+ * changed, so iterators (which can run on worker threads) only read from it.
+ * An array that is referenced by an iterator is never modified. Instead a new
+ * array is created, and the old one is retired until its iterators are done. */
+static
+void flecs_query_build_table_array(
+    ecs_query_t *query)
+{
+    ecs_assert(!(query->world->flags & EcsWorldReadonly), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    if (!(query->flags & EcsQueryTableArrayDirty)) {
+        return;
+    }
+
+    query->flags &= ~EcsQueryTableArrayDirty;
+
+    /* Sorted queries iterate the table slices */
+    if (query->order_by) {
+        return;
+    }
+
+    ecs_query_table_node_t *cur;
+    int32_t i = 0, count = 0;
+    for (cur = query->list.first; cur; cur = cur->next) {
+        count ++;
+    }
+
+    ecs_query_table_array_t *array = query->table_array;
+    if (array && (array->size < count || ecs_os_aload(&array->refs) != 1)) {
+        if (ecs_os_adec(&array->refs)) {
+            ecs_query_table_array_t **retired = ecs_vector_add(
+                &query->table_array_retired, ecs_query_table_array_t*);
+            *retired = array;
+        } else {
+            flecs_query_table_array_free(array);
+        }
+        array = query->table_array = NULL;
+    }
+
+    if (!count) {
+        if (array) {
+            array->count = 0;
+        }
+        return;
+    }
+
+    if (!array) {
+        array = query->table_array = ecs_os_calloc_t(ecs_query_table_array_t);
+        array->size = flecs_next_pow_of_2(count);
+        array->elems = ecs_os_malloc_n(ecs_query_table_elem_t, array->size);
+        array->refs = 1;
+    }
+
+    array->count = count;
+    ecs_query_table_elem_t *elems = array->elems;
+
+    for (cur = query->list.first; cur; cur = cur->next, i ++) {
+        ecs_query_table_node_t *node = &elems[i].node;
+        *node = *cur;
+        node->prev = i ? &elems[i - 1].node : NULL;
+        node->next = (i < (count - 1)) ? &elems[i + 1].node : NULL;
+        flecs_query_table_data_init(&elems[i].data, cur->match);
+    }
+}
+
+/* Bring table array of query up to date. Returns whether the query must stay
+ * queued, which is the case while retired arrays are used by iterators. */
+bool flecs_query_update_table_array(
+    ecs_query_t *query)
+{
+    flecs_query_build_table_array(query);
+    if (flecs_query_table_array_sweep(query)) {
+        return true;
+    }
+
+    query->flags &= ~EcsQueryTableArrayQueued;
+    return false;
+}
+
+static
+void flecs_query_table_array_fini(
+    ecs_query_t *query)
+{
+    if (query->flags & EcsQueryTableArrayQueued) {
+        ecs_world_t *world = query->world;
+        int32_t i, count = ecs_vector_count(world->pending_queries);
+        ecs_query_t **queries = ecs_vector_first(
+            world->pending_queries, ecs_query_t*);
+        for (i = 0; i < count; i ++) {
+            if (queries[i] == query) {
+                ecs_vector_remove(world->pending_queries, ecs_query_t*, i);
+                break;
+            }
+        }
+    }
+
+    if (query->table_array) {
+        flecs_query_table_array_free(query->table_array);
+    }
+
+    ecs_vector_each(query->table_array_retired, ecs_query_table_array_t*, 
+        array, {
+            flecs_query_table_array_free(*array);
+        });
+    ecs_vector_free(query->table_array_retired);
+}
+
+static
+void flecs_query_table_array_release(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    if (iter->table_array) {
+        /* Arrays are only freed on the main thread */
+        ecs_os_adec(&iter->table_array->refs);
+        iter->table_array = NULL;
+    }
+}
+
 static
 void flecs_query_sort_tables(
     ecs_world_t *world,
@@ -1323,6 +1648,99 @@ bool flecs_query_is_term_id_supported(
     return false;
 }
 
+/* Terms for sparse components can't be matched with tables, as the component
+ * is never stored in a table. Tables are matched with a copy of the filter in
+ * which these terms are optional, and the terms are evaluated per entity while
+ * iterating. */
+static
+int flecs_query_init_sparse_terms(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    if (!(world->flags & EcsWorldHasSparse)) {
+        return 0;
+    }
+
+    ecs_term_t *terms = query->filter.terms;
+    ecs_term_t *match_terms = NULL;
+    int32_t i, count = query->filter.term_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (!ecs_term_match_this(term)) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper != EcsAnd && oper != EcsNot && oper != EcsOptional) {
+            continue;
+        }
+
+        ecs_id_t id = term->id;
+        if (ecs_id_is_wildcard(id)) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_sparse_id_record_ensure(world, id);
+        if (!idr) {
+            continue;
+        }
+
+        flecs_id_record_claim(world, idr);
+
+        flecs_sparse_join_term_t *jt = ecs_vector_add(
+            &query->sparse_terms, flecs_sparse_join_term_t);
+        jt->idr = idr;
+        jt->oper = oper;
+        jt->field_index = term->field_index;
+
+        /* Terms are copied by ecs_filter_init, so a shallow copy is enough */
+        if (!match_terms) {
+            match_terms = ecs_os_memdup_n(terms, ecs_term_t, count);
+        }
+        match_terms[i].oper = EcsOptional;
+
+        query->flags |= EcsQueryHasSparse;
+        if (oper != EcsNot && term->inout != EcsInOutNone) {
+            query->flags |= EcsQueryHasSparseData;
+        }
+    }
+
+    if (!match_terms) {
+        return 0;
+    }
+
+    query->match_filter = ECS_FILTER_INIT;
+    ecs_filter_t *f = ecs_filter_init(world, &(ecs_filter_desc_t){
+        .terms_buffer = match_terms,
+        .terms_buffer_count = count,
+        .storage = &query->match_filter,
+        .flags = query->filter.flags & 
+            (EcsFilterMatchEmptyTables | EcsFilterMatchSparse)
+    });
+    ecs_os_free(match_terms);
+
+    return f ? 0 : -1;
+}
+
+static
+void flecs_query_fini_sparse_terms(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    for (i = 0; i < count; i ++) {
+        flecs_id_record_release(world, terms[i].idr);
+    }
+    ecs_vector_free(query->sparse_terms);
+
+    if (query->flags & EcsQueryHasSparse) {
+        ecs_filter_fini(&query->match_filter);
+    }
+}
+
 static
 int flecs_query_process_signature(
     ecs_world_t *world,
@@ -1529,9 +1947,10 @@ void flecs_query_rematch_tables(
 
     if (parent_query) {
         parent_it = ecs_query_iter(world, parent_query);
-        it = ecs_filter_chain_iter(&parent_it, &query->filter);
+        it = ecs_filter_chain_iter(
+            &parent_it, flecs_query_match_filter(query));
     } else {
-        it = ecs_filter_iter(world, &query->filter);
+        it = ecs_filter_iter(world, flecs_query_match_filter(query));
     }
 
     ECS_BIT_SET(it.flags, EcsIterIsInstanced);
@@ -1858,6 +2277,8 @@ void flecs_query_fini(
 
     ecs_vector_free(query->subqueries);
     ecs_vector_free(query->table_slices);
+    flecs_query_table_array_fini(query);
+    flecs_query_fini_sparse_terms(world, query);
     ecs_filter_fini(&query->filter);
 
     flecs_query_allocators_fini(query);
@@ -1881,7 +2302,8 @@ ecs_query_t* ecs_query_init(
     ecs_observer_desc_t observer_desc = { .filter = desc->filter };
     ecs_entity_t entity = desc->entity;
 
-    observer_desc.filter.flags = EcsFilterMatchEmptyTables;
+    observer_desc.filter.flags = EcsFilterMatchEmptyTables | 
+        EcsFilterMatchSparse;
     observer_desc.filter.storage = &result->filter;
     result->filter = ECS_FILTER_INIT;
 
@@ -1890,6 +2312,9 @@ ecs_query_t* ecs_query_init(
     }
 
     flecs_query_allocators_init(result);
+    if (flecs_query_init_sparse_terms(world, result)) {
+        goto error;
+    }
 
     if (result->filter.term_count) {
         observer_desc.entity = entity;
@@ -1901,8 +2326,9 @@ ecs_query_t* ecs_query_init(
 
         /* ecs_filter_init could have moved away resources from the terms array
          * in the descriptor, so use the terms array from the filter. */
-        observer_desc.filter.terms_buffer = result->filter.terms;
-        observer_desc.filter.terms_buffer_count = result->filter.term_count;
+        const ecs_filter_t *match_filter = flecs_query_match_filter(result);
+        observer_desc.filter.terms_buffer = match_filter->terms;
+        observer_desc.filter.terms_buffer_count = match_filter->term_count;
         observer_desc.filter.expr = NULL; /* Already parsed */
 
         entity = ecs_observer_init(world, &observer_desc);
@@ -1952,6 +2378,10 @@ ecs_query_t* ecs_query_init(
         result->flags |= EcsQueryIsSubquery;
     }
 
+    if (desc->changed_only) {
+        result->flags |= EcsQueryChangedOnly | EcsQueryHasMonitor;
+    }
+
     /* If the query refers to itself, add the components that were queried for
      * to the query itself. */
     if (entity)  {
@@ -2066,8 +2496,27 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
-        it.node = ecs_vector_first(query->table_slices, ecs_query_table_node_t);
+    if (query->order_by) {
+        if (query->list.info.table_count) {
+            it.node = ecs_vector_first(
+                query->table_slices, ecs_query_table_node_t);
+        }
+    } else {
+        /* The table array is kept up to date while processing table events,
+         * which happens before the world enters readonly mode. Rematching or
+         * matching new tables can outdate it outside of table events. */
+        if (!(world->flags & EcsWorldReadonly)) {
+            flecs_query_build_table_array(query);
+        }
+        ecs_assert(!(query->flags & EcsQueryTableArrayDirty),
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_query_table_array_t *array = query->table_array;
+        if (array && array->count) {
+            it.node = &array->elems[0].node;
+            it.table_array = array;
+        } else {
+            it.node = NULL;
+        }
     }
 
     ecs_flags32_t flags = 0;
@@ -2121,10 +2570,17 @@ ecs_iter_t ecs_query_iter(
         ecs_iter_fini(&fit);
     }
 
+    /* Keep array alive while it's iterated */
+    if (it.table_array) {
+        ecs_os_ainc(&it.table_array->refs);
+        result.fini = flecs_query_table_array_release;
+    }
+
     return result;
 error:
 noresults:
     result.priv.iter.query.node = NULL;
+    result.priv.iter.query.table_array = NULL;
     return result;
 }
 
@@ -2140,6 +2596,9 @@ void ecs_query_set_group(
     ecs_query_t *q = qit->query;
     ecs_check(q != NULL, ECS_INVALID_PARAMETER, NULL);
 
+    /* Group nodes are iterated from the list */
+    flecs_query_table_array_release(it);
+
     ecs_query_table_list_t *node = flecs_query_get_group(q, group_id);
     if (!node) {
         qit->node = NULL;
@@ -2262,51 +2721,65 @@ int sparse_column_next(
 
     /* Find next entity to iterate in sparse column */
     int32_t first, sparse_first = iter->sparse_first;
+    int32_t i, count = ecs_vector_count(sparse_columns);
 
     if (!filter) {
+        /* Scan elements of smallest case, from last to first so that entities
+         * that most recently switched to the case are returned first. */
+        const int32_t *elements = flecs_switch_elements(
+            sw_smallest, case_smallest);
+        int32_t index = sparse_first;
         if (first_iteration) {
-            first = flecs_switch_first(sw_smallest, case_smallest);
-        } else {
-            first = flecs_switch_next(sw_smallest, sparse_first);
+            index = flecs_switch_case_count(sw_smallest, case_smallest);
         }
-    } else {
-        int32_t cur_first = cur->first, cur_count = cur->count;
-        first = cur_first;
-        while (flecs_switch_get(sw_smallest, first) != case_smallest) {
-            first ++;
-            if (first >= (cur_first + cur_count)) {
-                first = -1;
-                break;
+
+        do {
+            if (!index) {
+                goto done;
             }
-        }
-    }
 
-    if (first == -1) {
-        goto done;
-    }
+            first = elements[-- index];
 
-    /* Check if entity matches with other sparse columns, if any */
-    int32_t i, count = ecs_vector_count(sparse_columns);
-    do {
-        for (i = 0; i < count; i ++) {
-            if (i == sparse_smallest) {
-                /* Already validated this one */
-                continue;
-            }
+            /* Check if entity matches with other sparse columns, if any */
+            for (i = 0; i < count; i ++) {
+                if (i == sparse_smallest) {
+                    /* Already validated this one */
+                    continue;
+                }
 
-            column = &columns[i];
-            sw = column->sw_column;
+                column = &columns[i];
+                sw = column->sw_column;
+                if (flecs_switch_get(sw, first) != column->sw_case) {
+                    break;
+                }
+            }
+        } while (i != count);
 
-            if (flecs_switch_get(sw, first) != column->sw_case) {
-                first = flecs_switch_next(sw_smallest, first);
-                if (first == -1) {
-                    goto done;
+        iter->sparse_first = index;
+    } else {
+        /* Find first entity in range that matches all sparse columns */
+        int32_t cur_last = cur->first + cur->count;
+        for (first = cur->first; first < cur_last; first ++) {
+            for (i = 0; i < count; i ++) {
+                column = &columns[i];
+                sw = column->sw_column;
+                if (flecs_switch_get(sw, first) != column->sw_case) {
+                    break;
                 }
             }
+            if (i == count) {
+                break;
+            }
+        }
+
+        if (first == cur_last) {
+            goto done;
         }
-    } while (i != count);
 
-    cur->first = iter->sparse_first = first;
+        iter->sparse_first = first;
+    }
+
+    cur->first = first;
     cur->count = 1;
 
     return 0;
@@ -2319,69 +2792,171 @@ done:
     return -1;
 }
 
-#define BS_MAX ((uint64_t)0xFFFFFFFFFFFFFFFF)
-
+/* Test if rows in block changed for any of the columns that are read by the
+ * query, since the query last iterated the match */
 static
-int bitset_column_next(
-    ecs_table_t *table,
-    ecs_vector_t *bitset_columns,
-    ecs_query_iter_t *iter,
-    query_iter_cursor_t *cur)
+bool flecs_query_block_changed(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_vec_t *dirty_blocks,
+    int32_t block)
 {
-    /* Precomputed single-bit test */
-    static const uint64_t bitmask[64] = {
-    (uint64_t)1 << 0, (uint64_t)1 << 1, (uint64_t)1 << 2, (uint64_t)1 << 3,
-    (uint64_t)1 << 4, (uint64_t)1 << 5, (uint64_t)1 << 6, (uint64_t)1 << 7,
-    (uint64_t)1 << 8, (uint64_t)1 << 9, (uint64_t)1 << 10, (uint64_t)1 << 11,
-    (uint64_t)1 << 12, (uint64_t)1 << 13, (uint64_t)1 << 14, (uint64_t)1 << 15,
-    (uint64_t)1 << 16, (uint64_t)1 << 17, (uint64_t)1 << 18, (uint64_t)1 << 19,
-    (uint64_t)1 << 20, (uint64_t)1 << 21, (uint64_t)1 << 22, (uint64_t)1 << 23,
-    (uint64_t)1 << 24, (uint64_t)1 << 25, (uint64_t)1 << 26, (uint64_t)1 << 27,  
-    (uint64_t)1 << 28, (uint64_t)1 << 29, (uint64_t)1 << 30, (uint64_t)1 << 31,
-    (uint64_t)1 << 32, (uint64_t)1 << 33, (uint64_t)1 << 34, (uint64_t)1 << 35,  
-    (uint64_t)1 << 36, (uint64_t)1 << 37, (uint64_t)1 << 38, (uint64_t)1 << 39,
-    (uint64_t)1 << 40, (uint64_t)1 << 41, (uint64_t)1 << 42, (uint64_t)1 << 43,
-    (uint64_t)1 << 44, (uint64_t)1 << 45, (uint64_t)1 << 46, (uint64_t)1 << 47,  
-    (uint64_t)1 << 48, (uint64_t)1 << 49, (uint64_t)1 << 50, (uint64_t)1 << 51,
-    (uint64_t)1 << 52, (uint64_t)1 << 53, (uint64_t)1 << 54, (uint64_t)1 << 55,  
-    (uint64_t)1 << 56, (uint64_t)1 << 57, (uint64_t)1 << 58, (uint64_t)1 << 59,
-    (uint64_t)1 << 60, (uint64_t)1 << 61, (uint64_t)1 << 62, (uint64_t)1 << 63
-    };
+    int32_t *monitor = match->monitor;
+    int32_t *storage_columns = match->storage_columns;
+    int32_t i, field_count = query->filter.field_count;
+    for (i = 0; i < field_count; i ++) {
+        int32_t mon = monitor[i + 1];
+        int32_t column = storage_columns[i];
+        if (mon == -1 || column < 0) {
+            continue;
+        }
 
-    /* Precomputed test to verify if remainder of block is set (or not) */
-    static const uint64_t bitmask_remain[64] = {
-    BS_MAX, BS_MAX - (BS_MAX >> 63), BS_MAX - (BS_MAX >> 62),
-    BS_MAX - (BS_MAX >> 61), BS_MAX - (BS_MAX >> 60), BS_MAX - (BS_MAX >> 59),
-    BS_MAX - (BS_MAX >> 58), BS_MAX - (BS_MAX >> 57), BS_MAX - (BS_MAX >> 56), 
-    BS_MAX - (BS_MAX >> 55), BS_MAX - (BS_MAX >> 54), BS_MAX - (BS_MAX >> 53), 
-    BS_MAX - (BS_MAX >> 52), BS_MAX - (BS_MAX >> 51), BS_MAX - (BS_MAX >> 50), 
-    BS_MAX - (BS_MAX >> 49), BS_MAX - (BS_MAX >> 48), BS_MAX - (BS_MAX >> 47), 
-    BS_MAX - (BS_MAX >> 46), BS_MAX - (BS_MAX >> 45), BS_MAX - (BS_MAX >> 44), 
-    BS_MAX - (BS_MAX >> 43), BS_MAX - (BS_MAX >> 42), BS_MAX - (BS_MAX >> 41), 
-    BS_MAX - (BS_MAX >> 40), BS_MAX - (BS_MAX >> 39), BS_MAX - (BS_MAX >> 38), 
-    BS_MAX - (BS_MAX >> 37), BS_MAX - (BS_MAX >> 36), BS_MAX - (BS_MAX >> 35), 
-    BS_MAX - (BS_MAX >> 34), BS_MAX - (BS_MAX >> 33), BS_MAX - (BS_MAX >> 32), 
-    BS_MAX - (BS_MAX >> 31), BS_MAX - (BS_MAX >> 30), BS_MAX - (BS_MAX >> 29), 
-    BS_MAX - (BS_MAX >> 28), BS_MAX - (BS_MAX >> 27), BS_MAX - (BS_MAX >> 26), 
-    BS_MAX - (BS_MAX >> 25), BS_MAX - (BS_MAX >> 24), BS_MAX - (BS_MAX >> 23), 
-    BS_MAX - (BS_MAX >> 22), BS_MAX - (BS_MAX >> 21), BS_MAX - (BS_MAX >> 20), 
-    BS_MAX - (BS_MAX >> 19), BS_MAX - (BS_MAX >> 18), BS_MAX - (BS_MAX >> 17), 
-    BS_MAX - (BS_MAX >> 16), BS_MAX - (BS_MAX >> 15), BS_MAX - (BS_MAX >> 14), 
-    BS_MAX - (BS_MAX >> 13), BS_MAX - (BS_MAX >> 12), BS_MAX - (BS_MAX >> 11), 
-    BS_MAX - (BS_MAX >> 10), BS_MAX - (BS_MAX >> 9), BS_MAX - (BS_MAX >> 8), 
-    BS_MAX - (BS_MAX >> 7), BS_MAX - (BS_MAX >> 6), BS_MAX - (BS_MAX >> 5), 
-    BS_MAX - (BS_MAX >> 4), BS_MAX - (BS_MAX >> 3), BS_MAX - (BS_MAX >> 2),
-    BS_MAX - (BS_MAX >> 1)
-    };
+        ecs_vec_t *blocks = &dirty_blocks[column];
+        if (block < ecs_vec_count(blocks)) {
+            if (ecs_vec_get_t(blocks, int32_t, block)[0] > mon) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Find next range of rows that changed since the query last iterated the
+ * match. Changes to shared components, or rows that were added, removed or
+ * moved invalidate the entire table. */
+static
+int flecs_query_changed_rows_next(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_query_iter_t *iter,
+    query_iter_cursor_t *cur)
+{
+    ecs_world_t *world = query->world;
+    ecs_table_t *table = match->node.table;
+    int32_t first = cur->first, last = first + cur->count;
+    if (iter->changed_first) {
+        first = iter->changed_first;
+    }
+
+    iter->changed_first = 0;
+
+    if (flecs_query_get_match_monitor(query, match)) {
+        /* Match hasn't been iterated yet, everything changed */
+        goto all;
+    }
+
+    int32_t *monitor = match->monitor;
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    if (monitor[0] != dirty_state[0]) {
+        goto all;
+    }
+
+    int32_t i, field_count = query->filter.field_count;
+    int32_t *storage_columns = match->storage_columns;
+    bool owned_changed = false;
+    for (i = 0; i < field_count; i ++) {
+        int32_t mon = monitor[i + 1];
+        if (mon == -1) {
+            continue;
+        }
+
+        int32_t column = storage_columns[i];
+        if (column >= 0) {
+            if (mon != dirty_state[column + 1]) {
+                owned_changed = true;
+            }
+        } else if (column == -2) {
+            if (flecs_query_check_match_monitor_term(query, match, i + 1)) {
+                goto all;
+            }
+        }
+    }
+
+    if (!owned_changed) {
+        return -1;
+    }
+
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    ecs_assert(dirty_blocks != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t block = first / ECS_DIRTY_BLOCK_SIZE;
+    int32_t block_last = (last - 1) / ECS_DIRTY_BLOCK_SIZE;
+    int32_t block_first = -1;
+    for (; block <= block_last; block ++) {
+        if (flecs_query_block_changed(query, match, dirty_blocks, block)) {
+            if (block_first == -1) {
+                block_first = block;
+            }
+        } else if (block_first != -1) {
+            break;
+        }
+    }
+
+    if (block_first == -1) {
+        return -1;
+    }
+
+    int32_t range_first = block_first * ECS_DIRTY_BLOCK_SIZE;
+    int32_t range_last = block * ECS_DIRTY_BLOCK_SIZE;
+    if (range_first < first) {
+        range_first = first;
+    }
+    if (range_last >= last) {
+        range_last = last;
+    } else {
+        iter->changed_first = range_last;
+    }
+
+    cur->first = range_first;
+    cur->count = range_last - range_first;
+    return 0;
+all:
+    cur->first = first;
+    cur->count = last - first;
+    return 0;
+}
+
+#define BS_MAX ((uint64_t)0xFFFFFFFFFFFFFFFF)
+
+/* Load block of bits that are enabled for all bitset columns. Bits past the
+ * last element are cleared. */
+static
+uint64_t flecs_query_bitset_block(
+    flecs_bitset_term_t *columns,
+    int32_t column_count,
+    int32_t block,
+    int32_t elem_count)
+{
+    uint64_t v = columns[0].bs_column->data[block];
+    int32_t i;
+    for (i = 1; i < column_count; i ++) {
+        v &= columns[i].bs_column->data[block];
+    }
+
+    int32_t remain = elem_count - block * 64;
+    if (remain < 64) {
+        v &= BS_MAX >> (64 - remain);
+    }
+
+    return v;
+}
 
+static
+int bitset_column_next(
+    ecs_table_t *table,
+    ecs_vector_t *bitset_columns,
+    ecs_query_iter_t *iter,
+    query_iter_cursor_t *cur)
+{
     int32_t i, count = ecs_vector_count(bitset_columns);
     flecs_bitset_term_t *columns = ecs_vector_first(
         bitset_columns, flecs_bitset_term_t);
     int32_t bs_offset = table->bs_offset;
 
-    int32_t first = iter->bitset_first;
-    int32_t last = 0;
-
+    /* Enabled elements are found by testing blocks of 64 bits, in which the
+     * bits of all bitset columns are combined. */
+    int32_t elem_count = 0;
     for (i = 0; i < count; i ++) {
         flecs_bitset_term_t *column = &columns[i];
         ecs_bitset_t *bs = columns[i].bs_column;
@@ -2392,126 +2967,165 @@ int bitset_column_next(
             bs = &table->data.bs_columns[index - bs_offset];
             columns[i].bs_column = bs;
         }
-        
-        int32_t bs_elem_count = bs->count;
-        int32_t bs_block = first >> 6;
-        int32_t bs_block_count = ((bs_elem_count - 1) >> 6) + 1;
 
-        if (bs_block >= bs_block_count) {
+        if (!i || bs->count < elem_count) {
+            elem_count = bs->count;
+        }
+    }
+
+    int32_t first = iter->bitset_first;
+    if (first >= elem_count) {
+        goto done;
+    }
+
+    /* Step 1: find first block with enabled elements */
+    int32_t block = first >> 6;
+    int32_t block_count = ((elem_count - 1) >> 6) + 1;
+    uint64_t v = flecs_query_bitset_block(columns, count, block, elem_count);
+    v &= BS_MAX << (first & 0x3F);
+    while (!v) {
+        if ((++ block) >= block_count) {
+            /* No enabled elements left */
             goto done;
         }
+        v = flecs_query_bitset_block(columns, count, block, elem_count);
+    }
 
-        uint64_t *data = bs->data;
-        int32_t bs_start = first & 0x3F;
+    first = block * 64 + flecs_ctz64(v);
 
-        /* Step 1: find the first non-empty block */
-        uint64_t v = data[bs_block];
-        uint64_t remain = bitmask_remain[bs_start];
-        while (!(v & remain)) {
-            /* If no elements are remaining, move to next block */
-            if ((++bs_block) >= bs_block_count) {
-                /* No non-empty blocks left */
-                goto done;
-            }
+    /* Step 2: find first disabled element after the first enabled element */
+    uint64_t disabled = ~v & (BS_MAX << (first & 0x3F));
+    while (!disabled) {
+        if ((++ block) >= block_count) {
+            break;
+        }
+        disabled = ~flecs_query_bitset_block(
+            columns, count, block, elem_count);
+    }
 
-            bs_start = 0;
-            remain = BS_MAX; /* Test the full block */
-            v = data[bs_block];
+    int32_t last = elem_count;
+    if (disabled) {
+        last = block * 64 + flecs_ctz64(disabled);
+        if (last > elem_count) {
+            last = elem_count;
         }
+    }
 
-        /* Step 2: find the first non-empty element in the block */
-        while (!(v & bitmask[bs_start])) {
-            bs_start ++;
+    ecs_assert(last > first, ECS_INTERNAL_ERROR, NULL);
 
-            /* Block was not empty, so bs_start must be smaller than 64 */
-            ecs_assert(bs_start < 64, ECS_INTERNAL_ERROR, NULL);
-        }
-        
-        /* Step 3: Find number of contiguous enabled elements after start */
-        int32_t bs_end = bs_start, bs_block_end = bs_block;
-        
-        remain = bitmask_remain[bs_end];
-        while ((v & remain) == remain) {
-            bs_end = 0;
-            bs_block_end ++;
+    cur->first = first;
+    cur->count = last - first;
 
-            if (bs_block_end == bs_block_count) {
-                break;
-            }
+    /* Keep track of last processed element for iteration */ 
+    iter->bitset_first = last;
+
+    return 0;
+done:
+    iter->sparse_smallest = 0;
+    iter->sparse_first = 0;
+    return -1;
+}
 
-            v = data[bs_block_end];
-            remain = BS_MAX; /* Test the full block */
+static
+bool flecs_query_sparse_match_row(
+    const flecs_sparse_join_term_t *terms,
+    int32_t term_count,
+    const ecs_query_table_match_t *match,
+    ecs_entity_t e)
+{
+    int32_t i;
+    for (i = 0; i < term_count; i ++) {
+        const flecs_sparse_join_term_t *jt = &terms[i];
+        ecs_oper_kind_t oper = jt->oper;
+        if (oper == EcsOptional) {
+            continue;
         }
 
-        /* Step 4: find remainder of enabled elements in current block */
-        if (bs_block_end != bs_block_count) {
-            while ((v & bitmask[bs_end])) {
-                bs_end ++;
-            }
+        bool has = match->columns[jt->field_index] != 0 || 
+            flecs_sparse_component_get(jt->idr, e) != NULL;
+        if (has != (oper == EcsAnd)) {
+            return false;
         }
+    }
+    return true;
+}
 
-        /* Block was not 100% occupied, so bs_start must be smaller than 64 */
-        ecs_assert(bs_end < 64, ECS_INTERNAL_ERROR, NULL);
+/* Find the first range of rows in the cursor that matches the sparse terms. If
+ * the query reads sparse data the range is a single row, as sparse components
+ * are not stored contiguously. The remainder of the cursor is stored in the
+ * iterator so the next call can resume from there. */
+static
+bool flecs_query_sparse_join(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    ecs_table_t *table,
+    ecs_query_iter_t *iter,
+    query_iter_cursor_t *cur)
+{
+    int32_t term_count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    ecs_entity_t *entities = ecs_vec_first(&table->data.entities);
+    int32_t row = cur->first, end = cur->first + cur->count;
 
-        /* Step 5: translate to element start/end and make sure that each column
-         * range is a subset of the previous one. */
-        first = bs_block * 64 + bs_start;
-        int32_t cur_last = bs_block_end * 64 + bs_end;
-        
-        /* No enabled elements found in table */
-        if (first == cur_last) {
-            goto done;
+    for (; row < end; row ++) {
+        if (flecs_query_sparse_match_row(terms, term_count, match, 
+            entities[row])) 
+        {
+            break;
         }
+    }
 
-        /* If multiple bitsets are evaluated, make sure each subsequent range
-         * is equal or a subset of the previous range */
-        if (i) {
-            /* If the first element of a subsequent bitset is larger than the
-             * previous last value, start over. */
-            if (first >= last) {
-                i = -1;
-                continue;
-            }
+    if (row == end) {
+        iter->join_count = 0;
+        return false;
+    }
 
-            /* Make sure the last element of the range doesn't exceed the last
-             * element of the previous range. */
-            if (cur_last > last) {
-                cur_last = last;
+    int32_t last = row + 1;
+    if (!(query->flags & EcsQueryHasSparseData)) {
+        for (; last < end; last ++) {
+            if (!flecs_query_sparse_match_row(terms, term_count, match, 
+                entities[last])) 
+            {
+                break;
             }
         }
+    }
 
-        last = cur_last;
-        int32_t elem_count = last - first;
+    cur->first = row;
+    cur->count = last - row;
+    iter->join_first = last;
+    iter->join_count = end - last;
 
-        /* Make sure last element doesn't exceed total number of elements in 
-         * the table */
-        if (elem_count > (bs_elem_count - first)) {
-            elem_count = (bs_elem_count - first);
-            if (!elem_count) {
-                iter->bitset_first = 0;
-                goto done;
-            }
+    return true;
+}
+
+static
+void flecs_query_sparse_populate(
+    ecs_query_t *query,
+    ecs_iter_t *it)
+{
+    int32_t i, term_count = ecs_vector_count(query->sparse_terms);
+    flecs_sparse_join_term_t *terms = ecs_vector_first(
+        query->sparse_terms, flecs_sparse_join_term_t);
+    ecs_entity_t e = it->entities[0];
+
+    for (i = 0; i < term_count; i ++) {
+        flecs_sparse_join_term_t *jt = &terms[i];
+        int32_t field = jt->field_index;
+        if (jt->oper == EcsNot || it->columns[field]) {
+            continue;
         }
-        
-        cur->first = first;
-        cur->count = elem_count;
-        iter->bitset_first = first;
+        it->ptrs[field] = flecs_sparse_component_get(jt->idr, e);
     }
-    
-    /* Keep track of last processed element for iteration */ 
-    iter->bitset_first = last;
-
-    return 0;
-done:
-    iter->sparse_smallest = 0;
-    iter->sparse_first = 0;
-    return -1;
 }
 
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    int32_t row,
+    int32_t row_count)
 {
     ecs_table_t *table = qm->node.table;
     if (!table) {
@@ -2538,7 +3152,8 @@ void flecs_query_mark_columns_dirty(
                 continue;
             }
 
-            dirty_state[column + 1] ++;
+            flecs_table_mark_column_dirty(
+                query->world, table, column, row, row_count);
         }
     }
 }
@@ -2558,7 +3173,7 @@ bool ecs_query_next_table(
     if ((query->flags & EcsQueryHasOutColumns)) {
         ecs_query_table_node_t *prev = iter->prev;
         if (prev && it->count) {
-            flecs_query_mark_columns_dirty(query, prev->match);
+            flecs_query_mark_columns_dirty(query, prev->match, 0, 0);
         }
     }
 
@@ -2646,12 +3261,41 @@ error:
     return false;
 }
 
-bool ecs_query_next_instanced(
-    ecs_iter_t *it)
+/* Process result returned by previous call to next. Results are processed
+ * once, so a mix of regular and batched iteration doesn't mark twice. */
+static
+void flecs_query_iter_sync_prev(
+    ecs_query_iter_t *iter)
 {
-    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_query_table_node_t *prev = iter->prev;
+    if (!prev) {
+        return;
+    }
+
+    ecs_query_t *query = iter->query;
+    ecs_flags32_t flags = query->flags;
+
+    /* Match has been iterated, update monitor for change tracking. If not
+     * all changed rows or ranges of the match have been returned yet, the 
+     * monitor is synchronized after the last range. */
+    if ((flags & EcsQueryHasMonitor) && !iter->changed_first && 
+        !iter->changed_ranges) 
+    {
+        flecs_query_sync_match_monitor(query, prev->match);
+    }
+    if (flags & EcsQueryHasOutColumns) {
+        flecs_query_mark_columns_dirty(query, prev->match, 
+            iter->prev_first, iter->prev_count);
+    }
 
+    iter->prev = NULL;
+}
+
+/* Find next result. Unlike ecs_query_next_instanced this does not finalize the
+ * iterator when no more results are available. */
+bool flecs_query_iter_next(
+    ecs_iter_t *it)
+{
     ecs_query_iter_t *iter = &it->priv.iter.query;
     ecs_query_t *query = iter->query;
     ecs_world_t *world = query->world;
@@ -2663,16 +3307,11 @@ bool ecs_query_next_instanced(
     (void)world;
 
     query_iter_cursor_t cur;
-    ecs_query_table_node_t *node, *next, *prev, *last;
-    if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
-            flecs_query_sync_match_monitor(query, prev->match);
-        }
-        if (flags & EcsQueryHasOutColumns) {
-            flecs_query_mark_columns_dirty(query, prev->match);
-        }
-    }
+    ecs_query_table_node_t *node, *next, *last;
+    ecs_query_table_data_t list_data;
+    const ecs_query_table_data_t *data;
+    bool is_array = iter->table_array != NULL;
+    flecs_query_iter_sync_prev(iter);
 
     iter->skip_count = 0;
 
@@ -2681,23 +3320,40 @@ bool ecs_query_next_instanced(
     last = iter->last;
     for (node = iter->node; node != last; node = next) {     
         ecs_query_table_match_t *match = node->match;
-        ecs_table_t *table = match->node.table;
+        ecs_table_t *table;
+        if (is_array) {
+            /* Array elements store the match data inline */
+            data = &((ecs_query_table_elem_t*)node)->data;
+            table = node->table;
+        } else {
+            flecs_query_table_data_init(&list_data, match);
+            data = &list_data;
+            table = match->node.table;
+        }
 
         next = node->next;
 
         if (table) {
-            cur.first = node->offset;
-            cur.count = node->count;
-            if (!cur.count) {
-                cur.count = ecs_table_count(table);
+            bool join_resume = iter->join_count != 0;
+            if (join_resume) {
+                /* Continue with remaining rows of previous sparse join */
+                cur.first = iter->join_first;
+                cur.count = iter->join_count;
+                next = iter->join_next;
+            } else {
+                cur.first = node->offset;
+                cur.count = node->count;
+                if (!cur.count) {
+                    cur.count = ecs_table_count(table);
 
-                /* List should never contain empty tables */
-                ecs_assert(cur.count != 0, ECS_INTERNAL_ERROR, NULL);
+                    /* List should never contain empty tables */
+                    ecs_assert(cur.count != 0, ECS_INTERNAL_ERROR, NULL);
+                }
             }
 
-            ecs_vector_t *bitset_columns = match->bitset_columns;
-            ecs_vector_t *sparse_columns = match->sparse_columns;
-            if (bitset_columns || sparse_columns) {
+            ecs_vector_t *bitset_columns = data->bitset_columns;
+            ecs_vector_t *sparse_columns = data->sparse_columns;
+            if (!join_resume && (bitset_columns || sparse_columns)) {
                 bool found = false;
 
                 do {
@@ -2739,11 +3395,50 @@ bool ecs_query_next_instanced(
                 } while (!found);
 
                 if (!found) {
+                    if (iter->changed_ranges) {
+                        /* Last range of changed table has been returned */
+                        flecs_query_sync_match_monitor(query, match);
+                        iter->changed_ranges = false;
+                    }
                     continue;
                 }
             }
 
-            it->group_id = match->node.group_id;
+            if ((flags & EcsQueryChangedOnly) && !join_resume) {
+                if (bitset_columns || sparse_columns) {
+                    /* Row ranges are already determined by toggle/union
+                     * columns, only test if table changed. The table stays
+                     * changed until its last range has been returned. */
+                    if (!iter->changed_ranges && 
+                        !flecs_query_check_match_monitor(query, match)) 
+                    {
+                        continue;
+                    }
+                    iter->changed_ranges = next == node;
+                } else if (flecs_query_changed_rows_next(
+                    query, match, iter, &cur) == -1) 
+                {
+                    /* Nothing changed, sync monitor so that the blocks of
+                     * this table don't have to be tested again */
+                    flecs_query_sync_match_monitor(query, match);
+                    continue;
+                } else if (iter->changed_first) {
+                    /* More changed rows left in table */
+                    next = node;
+                }
+            }
+
+            if (flags & EcsQueryHasSparse) {
+                if (!flecs_query_sparse_join(query, match, table, iter, &cur)) {
+                    continue;
+                }
+                if (iter->join_count) {
+                    iter->join_next = next;
+                    next = node;
+                }
+            }
+
+            it->group_id = is_array ? node->group_id : match->node.group_id;
         } else {
             cur.count = 0;
             cur.first = 0;
@@ -2751,9 +3446,9 @@ bool ecs_query_next_instanced(
 
         if (only_this) {
             /* If query has only This terms, reuse cache storage */
-            it->ids = match->ids;
-            it->columns = match->columns;
-            it->sizes = match->sizes;
+            it->ids = data->ids;
+            it->columns = data->columns;
+            it->sizes = data->sizes;
         } else {
             /* If query has non-This terms make sure not to overwrite them */
             int32_t t, term_count = filter->term_count;
@@ -2764,30 +3459,219 @@ bool ecs_query_next_instanced(
                 }
 
                 int32_t field = term->field_index;
-                it->ids[field] = match->ids[field];
-                it->columns[field] = match->columns[field];
-                it->sizes[field] = match->sizes[field];
+                it->ids[field] = data->ids[field];
+                it->columns[field] = data->columns[field];
+                it->sizes[field] = data->sizes[field];
             }
         }
 
-        it->sources = match->sources;
-        it->references = ecs_vec_first(&match->refs);
+        it->sources = data->sources;
+        it->references = data->references;
         it->instance_count = 0;
 
         flecs_iter_populate_data(world, it, table, cur.first, cur.count,
             it->ptrs, NULL);
 
+        if ((flags & EcsQueryHasSparseData) && table && it->ptrs) {
+            flecs_query_sparse_populate(query, it);
+        }
+
         iter->node = next;
         iter->prev = node;
-        goto yield;
+        iter->prev_first = cur.first;
+        iter->prev_count = cur.count;
+        return true;
+    }
+
+    iter->node = last;
+    return false;
+}
+
+void flecs_query_iter_seek(
+    ecs_iter_t *it,
+    ecs_query_table_node_t *node)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    iter->node = node;
+    iter->last = node ? node->next : NULL;
+    iter->sparse_smallest = 0;
+    iter->sparse_first = 0;
+    iter->bitset_first = 0;
+    iter->skip_count = 0;
+    iter->join_next = NULL;
+    iter->join_first = 0;
+    iter->join_count = 0;
+    iter->changed_first = 0;
+    iter->changed_ranges = false;
+}
+
+bool ecs_query_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+
+    if (flecs_query_iter_next(it)) {
+        return true;
     }
 
 error:
     ecs_iter_fini(it);
     return false;
+}
+
+static
+void* flecs_query_batch_field(
+    ecs_world_t *world,
+    const ecs_query_table_data_t *data,
+    ecs_table_t *table,
+    const ecs_term_t *terms,
+    int32_t field,
+    int32_t offset)
+{
+    int32_t column = data->columns[field];
+    if (!column || terms[field].inout == EcsInOutNone) {
+        return NULL;
+    }
+
+    if (column < 0) {
+        /* Component is not owned, get it from cached reference */
+        ecs_ref_t *ref = &data->references[-column - 1];
+        if (!ref->id) {
+            return NULL;
+        }
+        return ecs_ref_get_id(world, ref, ref->id);
+    }
+
+    int32_t storage_column = data->storage_columns[field];
+    if (storage_column >= 0) {
+        ecs_size_t size = table->type_info[storage_column]->size;
+        return ecs_vec_get(&table->data.columns[storage_column], size, offset);
+    }
+
+    int32_t u_index = flecs_table_column_to_union_index(table, column - 1);
+    if (u_index != -1) {
+        ecs_switch_t *sw = &table->data.sw_columns[u_index];
+        return ecs_vec_get_t(flecs_switch_values(sw), ecs_entity_t, offset);
+    }
+
+    return NULL;
+}
+
+int32_t ecs_query_next_batch(
+    ecs_iter_t *it,
+    ecs_query_batch_t *batch,
+    void **ptrs,
+    int32_t max_count)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(batch != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(max_count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptrs != NULL || !it->field_count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_world_t *world = query->world;
+    ecs_flags32_t flags = query->flags;
+    const ecs_filter_t *filter = &query->filter;
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, field_count = it->field_count;
+    bool is_filter = ECS_BIT_IS_SET(it->flags, EcsIterIsFilter);
+
+    /* Queries that return row ranges, sparse data or fields that are not
+     * matched on This use the regular iterator to produce results. */
+    bool direct = !(flags & (EcsQueryChangedOnly | EcsQueryHasSparse | 
+        EcsQueryHasSparseData)) && (filter->flags & EcsFilterMatchOnlyThis);
+
+    flecs_query_iter_sync_prev(iter);
+    flecs_iter_validate(it);
+
+    int32_t count = 0;
+    ecs_query_table_node_t *node = iter->node, *last = iter->last;
+    ecs_query_table_data_t list_data;
+    const ecs_query_table_data_t *data;
+    bool is_array = iter->table_array != NULL;
+    while (count < max_count && node != last) {
+        ecs_query_batch_t *elem = &batch[count];
+        void **elem_ptrs = ptrs ? &ptrs[count * field_count] : NULL;
+        ecs_query_table_match_t *match = node->match;
+        ecs_table_t *table;
+        if (is_array) {
+            data = &((ecs_query_table_elem_t*)node)->data;
+            table = node->table;
+        } else {
+            flecs_query_table_data_init(&list_data, match);
+            data = &list_data;
+            table = match->node.table;
+        }
+
+        if (!direct || !table || data->bitset_columns || 
+            data->sparse_columns) 
+        {
+            if (!flecs_query_iter_next(it)) {
+                break;
+            }
+
+            elem->table = it->table;
+            elem->entities = it->entities;
+            elem->offset = it->offset;
+            elem->count = it->count;
+            elem->group_id = it->group_id;
+            elem->sources = it->sources;
+            elem->ptrs = elem_ptrs;
+            if (it->ptrs) {
+                ecs_os_memcpy_n(elem_ptrs, it->ptrs, void*, field_count);
+            } else if (field_count) {
+                ecs_os_memset_n(elem_ptrs, 0, void*, field_count);
+            }
+
+            node = iter->node;
+            count ++;
+            continue;
+        }
 
-yield:
-    return true;  
+        int32_t offset = node->offset;
+        int32_t table_count = node->count;
+        if (!table_count) {
+            table_count = ecs_table_count(table);
+            ecs_assert(table_count != 0, ECS_INTERNAL_ERROR, NULL);
+        }
+
+        elem->table = table;
+        elem->entities = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, offset);
+        elem->offset = offset;
+        elem->count = table_count;
+        elem->group_id = node->group_id;
+        elem->sources = data->sources;
+        elem->ptrs = elem_ptrs;
+
+        for (i = 0; i < field_count; i ++) {
+            elem_ptrs[i] = is_filter ? NULL : flecs_query_batch_field(
+                world, data, table, terms, i, offset);
+        }
+
+        /* Results are not revisited, so sync change tracking right away */
+        if (flags & EcsQueryHasMonitor) {
+            flecs_query_sync_match_monitor(query, match);
+        }
+        if (flags & EcsQueryHasOutColumns) {
+            flecs_query_mark_columns_dirty(query, match, offset, table_count);
+        }
+
+        node = node->next;
+        iter->node = node;
+        count ++;
+    }
+
+    if (!count) {
+        ecs_iter_fini(it);
+    }
+
+    return count;
+error:
+    return 0;
 }
 
 bool ecs_query_changed(
@@ -2799,9 +3683,9 @@ bool ecs_query_changed(
         ecs_check(ECS_BIT_IS_SET(it->flags, EcsIterIsValid), 
             ECS_INVALID_PARAMETER, NULL);
 
-        ecs_query_table_match_t *qm = 
-            (ecs_query_table_match_t*)it->priv.iter.query.prev;
-        ecs_assert(qm != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_query_table_node_t *prev = it->priv.iter.query.prev;
+        ecs_assert(prev != NULL, ECS_INVALID_PARAMETER, NULL);
+        ecs_query_table_match_t *qm = prev->match;
 
         if (!query) {
             query = it->priv.iter.query.query;
@@ -85,6 +85,10 @@ void flecs_stages_merge(
                 "mismatching defer_begin/defer_end detected");
             flecs_defer_end(world, stage);
         }
+    } else if (world->merge_order) {
+        /* Merge commands of all stages in the order provided by the caller */
+        flecs_defer_end_ordered(world, world->merge_order, 
+            world->merge_order_count);
     } else {
         /* Merge stages. Only merge if the stage has auto_merging turned on, or 
          * if this is a forced merge (like when ecs_merge is called) */
@@ -128,6 +132,13 @@ void flecs_stage_manual_merge(
     flecs_stages_merge(world, true);
 }
 
+int32_t flecs_stage_cmd_cut(
+    ecs_stage_t *stage)
+{
+    flecs_sparse_clear(&stage->cmd_entries);
+    return ecs_vec_count(&stage->commands);
+}
+
 bool flecs_defer_begin(
     ecs_world_t *world,
     ecs_stage_t *stage)
@@ -707,6 +718,14 @@ void ecs_set_automerge(
     }
 }
 
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldParallelMerge, enable);
+}
+
 bool ecs_stage_is_readonly(
     const ecs_world_t *stage)
 {
@@ -772,6 +791,293 @@ bool ecs_stage_is_async(
     return ((ecs_stage_t*)stage)->async;
 }
 
+/* -- Command queues -- */
+
+/* Reserve slot for command. Only called by the producer thread. */
+static
+ecs_cmd_queue_elem_t* flecs_cmd_queue_reserve(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_kind_t kind,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    /* The consumer only ever decreases the number of used slots, so if the
+     * value read is outdated, the queue appears more full than it is. The
+     * acquire load ensures the consumer is done reading a slot before it is
+     * reused. */
+    if (ecs_os_aload(&queue->used) == queue->capacity) {
+        return NULL;
+    }
+
+    ecs_os_ainc(&queue->used);
+
+    ecs_cmd_queue_elem_t *elem = ECS_ELEM(
+        queue->slots, queue->slot_size, queue->head);
+    elem->kind = kind;
+    elem->size = 0;
+    elem->entity = entity;
+    elem->id = id;
+    return elem;
+}
+
+/* Make command visible to consumer. Only called by the producer thread. */
+static
+void flecs_cmd_queue_publish(
+    ecs_cmd_queue_t *queue)
+{
+    queue->head = (queue->head + 1) % queue->capacity;
+
+    /* Atomic increment ensures that the element is written before the
+     * consumer can see it */
+    ecs_os_ainc(&queue->count);
+}
+
+static
+void flecs_cmd_queue_apply(
+    ecs_world_t *world,
+    ecs_cmd_queue_elem_t *elem)
+{
+    ecs_entity_t e = elem->entity;
+    ecs_id_t id = elem->id;
+
+    /* Producers can't check whether entities and ids are valid, since they
+     * can't read from the world */
+    if (!ecs_is_alive(world, e) || (id && !ecs_id_is_valid(world, id))) {
+        world->info.cmd.discard_count ++;
+        return;
+    }
+
+    switch(elem->kind) {
+    case EcsOpAdd:
+        ecs_add_id(world, e, id);
+        break;
+    case EcsOpRemove:
+        ecs_remove_id(world, e, id);
+        break;
+    case EcsOpSet:
+        ecs_set_id(world, e, id, flecs_itosize(elem->size), 
+            ECS_OFFSET(elem, ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16)));
+        break;
+    case EcsOpDelete:
+        ecs_delete(world, e);
+        break;
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Apply commands published to queue. Commands that are published while the
+ * queue is merged are applied by the next merge. */
+static
+int32_t flecs_cmd_queue_merge(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue)
+{
+    /* The acquire load ensures that elements published by the producer are
+     * visible to this thread */
+    int32_t i, count = ecs_os_aload(&queue->count);
+    for (i = 0; i < count; i ++) {
+        ecs_os_adec(&queue->count);
+
+        ecs_cmd_queue_elem_t *elem = ECS_ELEM(
+            queue->slots, queue->slot_size, queue->tail);
+        flecs_cmd_queue_apply(world, elem);
+        queue->tail = (queue->tail + 1) % queue->capacity;
+
+        /* Return slot to producer after the command has been read. Values of
+         * set commands are copied by ecs_set_id, also when deferred. */
+        ecs_os_adec(&queue->used);
+    }
+
+    return count;
+}
+
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->_canary == 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->value_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_has_threading(), ECS_MISSING_OS_API, "ainc/adec/aload");
+
+    int32_t capacity = desc->capacity;
+    if (!capacity) {
+        capacity = ECS_CMD_QUEUE_DEFAULT_CAPACITY;
+    }
+
+    ecs_size_t value_size = desc->value_size;
+    if (!value_size) {
+        value_size = ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE;
+    }
+    value_size = ECS_ALIGN(value_size, 16);
+
+    ecs_cmd_queue_t *result = ecs_os_calloc_t(ecs_cmd_queue_t);
+    result->world = world;
+    result->capacity = capacity;
+    result->value_size = value_size;
+    result->slot_size = 
+        ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16) + value_size;
+    result->slots = ecs_os_malloc(result->slot_size * capacity);
+
+    ecs_vec_append_t(&world->allocator, &world->cmd_queues, 
+        ecs_cmd_queue_t*)[0] = result;
+
+    return result;
+error:
+    return NULL;
+}
+
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_world_t *world = queue->world;
+
+    /* Apply commands that haven't been merged yet */
+    ecs_defer_begin(world);
+    flecs_cmd_queue_merge(world, queue);
+    ecs_defer_end(world);
+
+    ecs_cmd_queue_t **queues = ecs_vec_first(&world->cmd_queues);
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    for (i = 0; i < count; i ++) {
+        if (queues[i] == queue) {
+            /* Preserve order, so queues are merged in order of creation */
+            ecs_os_memmove(&queues[i], &queues[i + 1], 
+                ECS_SIZEOF(ecs_cmd_queue_t*) * (count - i - 1));
+            ecs_vec_remove_last(&world->cmd_queues);
+            break;
+        }
+    }
+
+    ecs_os_free(queue->slots);
+    ecs_os_free(queue);
+error:
+    return;
+}
+
+bool ecs_cmd_queue_add_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpAdd, entity, id)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_remove_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpRemove, entity, id)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_set_id(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(flecs_utosize(size) <= queue->value_size, 
+        ECS_INVALID_PARAMETER, "value exceeds value_size of queue");
+
+    ecs_cmd_queue_elem_t *elem = flecs_cmd_queue_reserve(
+        queue, EcsOpSet, entity, id);
+    if (!elem) {
+        return false;
+    }
+
+    elem->size = flecs_utosize(size);
+    ecs_os_memcpy(ECS_OFFSET(elem, 
+        ECS_ALIGN(ECS_SIZEOF(ecs_cmd_queue_elem_t), 16)), ptr, elem->size);
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    if (!flecs_cmd_queue_reserve(queue, EcsOpDelete, entity, 0)) {
+        return false;
+    }
+    flecs_cmd_queue_publish(queue);
+    return true;
+error:
+    return false;
+}
+
+int32_t ecs_cmd_queues_merge(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), 
+        ECS_INVALID_OPERATION, NULL);
+
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    if (!count) {
+        return 0;
+    }
+
+    /* Commands are applied as deferred commands, so that they are batched
+     * with the other commands for the same entity */
+    int32_t result = 0;
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_queue_t *queue = ecs_vec_get_t(
+            &world->cmd_queues, ecs_cmd_queue_t*, i)[0];
+        result += flecs_cmd_queue_merge(world, queue);
+    }
+    ecs_defer_end(world);
+
+    return result;
+error:
+    return 0;
+}
+
+void flecs_cmd_queues_fini(
+    ecs_world_t *world)
+{
+    ecs_cmd_queue_t **queues = ecs_vec_first(&world->cmd_queues);
+    int32_t i, count = ecs_vec_count(&world->cmd_queues);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(queues[i]->slots);
+        ecs_os_free(queues[i]);
+    }
+    ecs_vec_fini_t(&world->allocator, &world->cmd_queues, ecs_cmd_queue_t*);
+}
+
 bool ecs_is_deferred(
     const ecs_world_t *world)
 {
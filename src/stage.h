@@ -16,6 +16,10 @@ void flecs_stage_fini(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Free command queues of world */
+void flecs_cmd_queues_fini(
+    ecs_world_t *world);
+
 /* Post-frame merge actions */
 void flecs_stage_merge_post_frame(
     ecs_world_t *world,
@@ -99,8 +103,18 @@ bool flecs_defer_end(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+void flecs_defer_end_ordered(
+    ecs_world_t *world,
+    const ecs_cmd_range_t *ranges,
+    int32_t range_count);
+
 bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Stop batching commands with commands that are already in the queue, and
+ * return the number of commands in the queue. */
+int32_t flecs_stage_cmd_cut(
+    ecs_stage_t *stage);
+
 #endif
@@ -801,6 +801,24 @@ void flecs_run_remove_hooks(
     }
 }
 
+/* Queue pair targets that leave or enter the table, so that transitive 
+ * closures that contain the tables of their subsets are updated. */
+static
+void flecs_table_subsets_moved(
+    ecs_world_t *world,
+    ecs_record_t **records,
+    ecs_entity_t *entities,
+    int32_t row,
+    int32_t count)
+{
+    int32_t i, end = row + count;
+    for (i = row; i < end; i ++) {
+        if (records[i]->row & EcsEntityObservedTarget) {
+            flecs_subsets_entity_moved(world, entities[i]);
+        }
+    }
+}
+
 static
 void flecs_dtor_all_components(
     ecs_world_t *world,
@@ -822,6 +840,10 @@ void flecs_dtor_all_components(
 
     (void)records;
 
+    if (update_entity_index && (world->flags & EcsWorldHasSubsets)) {
+        flecs_table_subsets_moved(world, records, entities, row, count);
+    }
+
     /* If table has components with destructors, iterate component columns */
     if (table->flags & EcsTableHasDtors) {
         /* Throw up a lock just to be sure */
@@ -860,6 +882,9 @@ void flecs_dtor_all_components(
                     ECS_INTERNAL_ERROR, NULL);
 
                 if (is_delete) {
+                    if (world->flags & EcsWorldHasSparse) {
+                        flecs_sparse_components_remove(world, e);
+                    }
                     flecs_entities_remove(world, e);
                     ecs_assert(ecs_is_valid(world, e) == false, 
                         ECS_INTERNAL_ERROR, NULL);
@@ -887,6 +912,9 @@ void flecs_dtor_all_components(
                 ecs_assert(!e || records[i]->table == table, 
                     ECS_INTERNAL_ERROR, NULL);
 
+                if (world->flags & EcsWorldHasSparse) {
+                    flecs_sparse_components_remove(world, e);
+                }
                 flecs_entities_remove(world, e);
                 ecs_assert(!ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
             } 
@@ -1044,6 +1072,10 @@ void flecs_table_free(
                 .kind = EcsQueryTableUnmatch,
                 .table = table
             });
+
+        if (world->flags & EcsWorldHasSubsets) {
+            flecs_subsets_table_deleted(world, table);
+        }
     }
 
     if (ecs_should_log_2()) {
@@ -1072,6 +1104,13 @@ void flecs_table_free(
     }
 
     flecs_wfree_n(world, int32_t, table->storage_count + 1, table->dirty_state);
+    if (table->dirty_blocks) {
+        int32_t i, column_count = table->storage_count;
+        for (i = 0; i < column_count; i ++) {
+            ecs_vec_fini_t(&world->allocator, &table->dirty_blocks[i], int32_t);
+        }
+        flecs_wfree_n(world, ecs_vec_t, column_count, table->dirty_blocks);
+    }
     flecs_wfree_n(world, int32_t, table->storage_count + table->type.count, 
         table->storage_map);
     flecs_table_records_unregister(world, table);
@@ -1177,10 +1216,88 @@ void flecs_table_mark_table_dirty(
     }
 }
 
+/* Make sure that dirty blocks exist for all rows of the table. Rows are marked
+ * dirty while iterating, possibly from multiple threads at the same time, so
+ * the blocks are created when rows are added instead. */
+static
+void flecs_table_grow_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    if (!dirty_blocks) {
+        return;
+    }
+
+    int32_t count = ecs_vec_count(&table->data.entities);
+    int32_t block_count = (count + ECS_DIRTY_BLOCK_SIZE - 1) / 
+        ECS_DIRTY_BLOCK_SIZE;
+
+    /* Blocks of all columns are grown together */
+    if (ecs_vec_count(&dirty_blocks[0]) >= block_count) {
+        return;
+    }
+
+    int32_t i, j, column_count = table->storage_count;
+    for (i = 0; i < column_count; i ++) {
+        ecs_vec_t *blocks = &dirty_blocks[i];
+        int32_t cur_count = ecs_vec_count(blocks);
+        ecs_vec_set_count_t(&world->allocator, blocks, int32_t, block_count);
+        int32_t *states = ecs_vec_first_t(blocks, int32_t);
+        for (j = cur_count; j < block_count; j ++) {
+            states[j] = 0;
+        }
+    }
+}
+
+void flecs_table_mark_column_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count)
+{
+    (void)world;
+    int32_t *dirty_state = table->dirty_state;
+    if (!dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ dirty_state[column + 1];
+
+    ecs_vec_t *dirty_blocks = table->dirty_blocks;
+    if (!dirty_blocks) {
+        return;
+    }
+
+    if (!count) {
+        row = 0;
+        count = ecs_table_count(table);
+        if (!count) {
+            return;
+        }
+    }
+
+    /* Store dirty state of column in blocks that contain the rows, so that
+     * queries can find which rows changed since they were last iterated. This
+     * can run on multiple threads, so it doesn't grow the blocks. */
+    ecs_vec_t *blocks = &dirty_blocks[column];
+    int32_t i;
+    int32_t first = row / ECS_DIRTY_BLOCK_SIZE;
+    int32_t last = (row + count - 1) / ECS_DIRTY_BLOCK_SIZE;
+    ecs_assert(last < ecs_vec_count(blocks), ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *states = ecs_vec_first_t(blocks, int32_t);
+    for (i = first; i <= last; i ++) {
+        states[i] = state;
+    }
+}
+
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1188,7 +1305,7 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_column_dirty(world, table, index, row, 1);
     }
 }
 
@@ -1352,9 +1469,12 @@ void* flecs_table_grow_column(
     ecs_assert(dst_size >= dst_count, ECS_INTERNAL_ERROR, NULL);
 
     /* If the array could possibly realloc and the component has a move action 
-     * defined, move old elements manually */
+     * defined, move old elements manually. Relocatable types can be moved with
+     * a memcpy, so they can use a regular realloc. */
     ecs_move_t move_ctor;
-    if (count && can_realloc && (move_ctor = ti->hooks.ctor_move_dtor)) {
+    if (count && can_realloc && (move_ctor = ti->hooks.ctor_move_dtor) &&
+        !(ti->hooks.flags & EcsTypeHookRelocatable))
+    {
         ecs_xtor_t ctor = ti->hooks.ctor;
         ecs_assert(ctor != NULL, ECS_INTERNAL_ERROR, NULL);
         ecs_assert(move_ctor != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1469,6 +1589,7 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_grow_dirty_blocks(world, table);
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -1525,9 +1646,16 @@ int32_t flecs_table_append(
         &data->records, ecs_record_t*);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
     *r = record;
+
+    if ((world->flags & EcsWorldHasSubsets) && 
+        (record->row & EcsEntityObservedTarget)) 
+    {
+        flecs_subsets_entity_moved(world, entity);
+    }
  
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    flecs_table_grow_dirty_blocks(world, table);
     ecs_assert(count >= 0, ECS_INTERNAL_ERROR, NULL);
 
     ecs_type_info_t **type_info = table->type_info;
@@ -2129,8 +2257,11 @@ void flecs_merge_column(
         ecs_vec_set_count(&world->allocator, 
             dst, size, dst_count + src_count);
 
+        /* Relocatable values don't need to be constructed & moved */
+        bool relocate = ti && (ti->hooks.flags & EcsTypeHookRelocatable);
+
         /* Construct new values */
-        if (ti) {
+        if (ti && !relocate) {
             flecs_ctor_component(ti, dst, dst_count, src_count);
         }
         
@@ -2139,7 +2270,7 @@ void flecs_merge_column(
         
         /* Move values into column */
         ecs_move_t move = NULL;
-        if (ti) {
+        if (ti && !relocate) {
             move = ti->hooks.move;
         }
         if (move) {
@@ -2184,6 +2315,7 @@ void flecs_merge_table_data(
         ECS_SIZEOF(ecs_entity_t), NULL);
     ecs_assert(dst_data->entities.count == src_count + dst_count, 
         ECS_INTERNAL_ERROR, NULL);
+    ecs_entity_t *entities = dst_data->entities.array;
 
     /* Merge record pointers */
     flecs_merge_column(world, &dst_data->records, &src_data->records, 
@@ -2203,16 +2335,21 @@ void flecs_merge_table_data(
             i_new ++;
             i_old ++;
         } else if (dst_id < src_id) {
-            /* New column, make sure vector is large enough. */
+            /* New column, make sure vector is large enough. Only construct
+             * the merged values, existing values are already constructed. */
             ecs_vec_t *column = &dst[i_new];
+            ecs_vec_set_size(&world->allocator, column, size, 
+                dst_data->entities.size);
             ecs_vec_set_count(&world->allocator, column, size, src_count + dst_count);
-            flecs_ctor_component(dst_ti, column, 0, src_count + dst_count);
+            flecs_run_add_hooks(world, dst_table, dst_ti, column, 
+                &entities[dst_count], dst_id, dst_count, src_count, true);
             i_new ++;
         } else if (dst_id > src_id) {
             /* Old column does not occur in new table, destruct */
             ecs_vec_t *column = &src[i_old];
             ecs_type_info_t *ti = src_type_info[i_old];
-            flecs_dtor_component(ti, column, 0, src_count);
+            flecs_run_remove_hooks(world, src_table, ti, column, 
+                &entities[dst_count], src_id, 0, src_count, true);
             ecs_vec_fini(&world->allocator, column, ti->size);
             i_old ++;
         }
@@ -2227,20 +2364,25 @@ void flecs_merge_table_data(
         ecs_type_info_t *ti = dst_type_info[i_new];
         int32_t size = ti->size;        
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+        ecs_vec_set_size(&world->allocator, column, size, 
+            dst_data->entities.size);
         ecs_vec_set_count(&world->allocator, column, size, src_count + dst_count);
-        flecs_ctor_component(ti, column, 0, src_count + dst_count);
+        flecs_run_add_hooks(world, dst_table, ti, column, 
+            &entities[dst_count], dst_ids[i_new], dst_count, src_count, true);
     }
 
     /* Destruct remaining columns */
     for (; i_old < src_column_count; i_old ++) {
         ecs_vec_t *column = &src[i_old];
         ecs_type_info_t *ti = src_type_info[i_old];
-        flecs_dtor_component(ti, column, 0, src_count);
+        flecs_run_remove_hooks(world, src_table, ti, column, 
+            &entities[dst_count], src_ids[i_old], 0, src_count, true);
         ecs_vec_fini(&world->allocator, column, ti->size);
     }    
 
     /* Mark entity column as dirty */
     flecs_table_mark_table_dirty(world, dst_table, 0); 
+    flecs_table_grow_dirty_blocks(world, dst_table);
 }
 
 int32_t ecs_table_count(
@@ -2305,6 +2447,12 @@ void flecs_table_merge(
         uint32_t flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
         record->row = ECS_ROW_TO_RECORD(dst_count + i, flags);
         record->table = dst_table;
+
+        if ((flags & EcsEntityObservedTarget) && 
+            (world->flags & EcsWorldHasSubsets)) 
+        {
+            flecs_subsets_entity_moved(world, src_entities[i]);
+        }
     }
 
     /* Merge table columns */
@@ -2350,6 +2498,8 @@ void flecs_table_replace_data(
         flecs_table_init_data(world, table);
     }
 
+    flecs_table_grow_dirty_blocks(world, table);
+
     int32_t count = ecs_table_count(table);
 
     if (!prev_count && count) {
@@ -2377,6 +2527,40 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+ecs_vec_t* flecs_table_get_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (!table->dirty_blocks) {
+        int32_t column_count = table->storage_count;
+        if (!column_count) {
+            return NULL;
+        }
+
+        int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+        int32_t i, j, count = ecs_table_count(table);
+        int32_t block_count = (count + ECS_DIRTY_BLOCK_SIZE - 1) / 
+            ECS_DIRTY_BLOCK_SIZE;
+
+        table->dirty_blocks = flecs_alloc_n(&world->allocator, 
+            ecs_vec_t, column_count);
+
+        /* Changes that happened before blocks were tracked are not known, so
+         * initialize existing blocks with the dirty state of the column */
+        for (i = 0; i < column_count; i ++) {
+            ecs_vec_t *blocks = &table->dirty_blocks[i];
+            ecs_vec_init_t(&world->allocator, blocks, int32_t, block_count);
+            ecs_vec_set_count_t(&world->allocator, blocks, int32_t, 
+                block_count);
+            int32_t *states = ecs_vec_first_t(blocks, int32_t);
+            for (j = 0; j < block_count; j ++) {
+                states[j] = dirty_state[i + 1];
+            }
+        }
+    }
+    return table->dirty_blocks;
+}
+
 void flecs_table_notify(
     ecs_world_t *world,
     ecs_table_t *table,
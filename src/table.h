@@ -114,6 +114,12 @@ int32_t* flecs_table_get_dirty_state(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Get dirty state for blocks of rows in table columns. Enables tracking
+ * changes per block of rows for the table. */
+ecs_vec_t* flecs_table_get_dirty_blocks(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
 /* Initialize root table */
 void flecs_init_root_table(
     ecs_world_t *world);
@@ -168,7 +174,16 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows dirty for column. If count is 0, mark all rows. */
+void flecs_table_mark_column_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t row,
+    int32_t count);
 
 void flecs_table_notify(
     ecs_world_t *world,
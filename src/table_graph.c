@@ -514,6 +514,7 @@ void flecs_init_table(
     table->type_info = NULL;
     table->flags = 0;
     table->dirty_state = NULL;
+    table->dirty_blocks = NULL;
     table->lock = 0;
     table->refcount = 1;
     table->generation = 0;
@@ -521,6 +522,10 @@ void flecs_init_table(
     flecs_table_init_node(&table->node);
 
     flecs_table_init(world, table, prev);
+
+    if (world->flags & EcsWorldHasSubsets) {
+        flecs_subsets_table_created(world, table);
+    }
 }
 
 static
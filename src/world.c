@@ -72,6 +72,9 @@ const ecs_entity_t EcsChildOf =               ECS_HI_COMPONENT_ID + 25;
 const ecs_entity_t EcsIsA =                   ECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsDependsOn =             ECS_HI_COMPONENT_ID + 27;
 
+/* Storage properties */
+const ecs_entity_t EcsSparse =                ECS_HI_COMPONENT_ID + 28;
+
 /* Identifier tags */
 const ecs_entity_t EcsName =                  ECS_HI_COMPONENT_ID + 30;
 const ecs_entity_t EcsSymbol =                ECS_HI_COMPONENT_ID + 31;
@@ -599,6 +602,9 @@ void flecs_log_addons(void) {
     #ifdef FLECS_RULES
         ecs_trace("FLECS_RULES");
     #endif
+    #ifdef FLECS_INDEX
+        ecs_trace("FLECS_INDEX");
+    #endif
     #ifdef FLECS_SNAPSHOT
         ecs_trace("FLECS_SNAPSHOT");
     #endif
@@ -727,6 +733,10 @@ ecs_world_t *ecs_mini(void) {
         ecs_table_t*);
     flecs_name_index_init(&world->aliases, &world->allocator);
     flecs_name_index_init(&world->symbols, &world->allocator);
+    ecs_vec_init_t(&world->allocator, &world->merge_writes, 
+        ecs_merge_write_t, 0);
+    ecs_vec_init_t(&world->allocator, &world->cmd_queues, 
+        ecs_cmd_queue_t*, 0);
 
     world->info.time_scale = 1.0;
 
@@ -999,6 +1009,7 @@ void ecs_set_hooks_id(
     if (h->move_ctor) ti->hooks.move_ctor = h->move_ctor;
     if (h->ctor_move_dtor) ti->hooks.ctor_move_dtor = h->ctor_move_dtor;
     if (h->move_dtor) ti->hooks.move_dtor = h->move_dtor;
+    ti->hooks.flags |= h->flags;
 
     if (h->on_add) ti->hooks.on_add = h->on_add;
     if (h->on_remove) ti->hooks.on_remove = h->on_remove;
@@ -1227,6 +1238,9 @@ int ecs_fini(
     flecs_name_index_fini(&world->aliases);
     flecs_name_index_fini(&world->symbols);
     ecs_set_stage_count(world, 0);
+    ecs_vec_fini_t(&world->allocator, &world->merge_writes, 
+        ecs_merge_write_t);
+    flecs_cmd_queues_fini(world);
     ecs_log_pop_1();
 
     flecs_world_allocators_fini(world);
@@ -1257,6 +1271,68 @@ void ecs_dim(
     flecs_entities_set_size(world, entity_count + ECS_HI_COMPONENT_ID);
 }
 
+int64_t ecs_world_trim(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    /* Shrink table storage. This returns memory to the world allocator, which
+     * is trimmed below. Skip the first (dummy) table. */
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    flecs_table_shrink(world, &world->store.root);
+    for (i = 1; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense(
+            &world->store.tables, ecs_table_t, i);
+        if (!table->lock) {
+            flecs_table_shrink(world, table);
+        }
+    }
+
+    flecs_sparse_shrink(&world->store.entity_index);
+    flecs_sparse_shrink(&world->store.tables);
+    flecs_sparse_shrink(&world->id_index_lo);
+    flecs_sparse_shrink(world->type_info);
+    flecs_sparse_shrink(world->pending_tables);
+    flecs_sparse_shrink(world->pending_buffer);
+
+    /* Shrink sparse component storage */
+    count = ecs_vector_count(world->store.sparse_ids);
+    ecs_id_record_t **sparse_ids = ecs_vector_first(
+        world->store.sparse_ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        flecs_sparse_shrink(sparse_ids[i]->sparse);
+    }
+
+    int64_t result = flecs_allocator_trim(&world->allocator);
+
+    ecs_world_allocators_t *a = &world->allocators;
+    result += flecs_ballocator_trim(&a->query_table);
+    result += flecs_ballocator_trim(&a->query_table_match);
+    result += flecs_ballocator_trim(&a->graph_edge_lo);
+    result += flecs_ballocator_trim(&a->graph_edge);
+    result += flecs_ballocator_trim(&a->id_record);
+    result += flecs_ballocator_trim(&a->id_record_chunk);
+    result += flecs_ballocator_trim(&a->table_diff);
+    result += flecs_ballocator_trim(&a->sparse_chunk);
+    result += flecs_ballocator_trim(&a->hashmap);
+
+    count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = &world->stages[i];
+        result += flecs_allocator_trim(&stage->allocator);
+        result += flecs_ballocator_trim(&stage->allocators.cmd_entry_chunk);
+        result += flecs_stack_trim(&stage->allocators.iter_stack);
+        result += flecs_stack_trim(&stage->allocators.deser_stack);
+    }
+
+    ecs_dbg_1("#[red]trimmed#[normal] %.2fKB", (double)result / 1024.0);
+
+    return result;
+error:
+    return 0;
+}
+
 void flecs_eval_component_monitors(
     ecs_world_t *world)
 {
@@ -1604,6 +1680,9 @@ ecs_ftime_t ecs_frame_begin(
     /* Keep track of total scaled time passed in world */
     world->info.world_time_total += world->info.delta_time;
 
+    /* Merge commands that were added to command queues by other threads */
+    ecs_cmd_queues_merge(world);
+
     ecs_run_aperiodic(world, 0);
 
     return world->info.delta_time;
@@ -1681,6 +1760,31 @@ void flecs_delete_table(
     flecs_table_release(world, table);
 }
 
+/* Bring the table arrays of queries in sync with the tables that became empty
+ * or non-empty. This happens here and not when a query is iterated, as
+ * iterators can be created from multiple threads. Only queries of which the
+ * iterated tables changed, or that have retired arrays, are queued. */
+static
+void flecs_process_query_table_arrays(
+    ecs_world_t *world)
+{
+    int32_t i, kept = 0, count = ecs_vector_count(world->pending_queries);
+    if (!count) {
+        return;
+    }
+
+    ecs_query_t **queries = ecs_vector_first(
+        world->pending_queries, ecs_query_t*);
+    for (i = 0; i < count; i ++) {
+        ecs_query_t *query = queries[i];
+        if (flecs_query_update_table_array(query)) {
+            queries[kept ++] = query;
+        }
+    }
+
+    ecs_vector_set_count(&world->pending_queries, ecs_query_t*, kept);
+}
+
 static
 void flecs_process_empty_queries(
     ecs_world_t *world)
@@ -1754,6 +1858,7 @@ void flecs_process_pending_tables(
      * more predictable. */
     int32_t i, count = flecs_sparse_count(world->pending_tables);
     if (!count) {
+        flecs_process_query_table_arrays(world);
         return;
     }
 
@@ -1814,6 +1919,8 @@ void flecs_process_pending_tables(
         world->pending_buffer = pending_tables;
     } while ((count = flecs_sparse_count(world->pending_tables)));
 
+    flecs_process_query_table_arrays(world);
+
     flecs_journal_end();
 }
 
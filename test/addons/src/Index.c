@@ -0,0 +1,439 @@
+#include <addons.h>
+
+typedef struct {
+    ecs_i32_t id;
+    ecs_f32_t score;
+} Player;
+
+typedef struct {
+    ecs_i32_t x;
+    ecs_i32_t y;
+} Cell;
+
+typedef struct {
+    ecs_f32_t speed;
+    Cell cell;
+} Grid;
+
+typedef struct {
+    ecs_i8_t value;
+} Signed;
+
+static
+ecs_entity_t player_init(
+    ecs_world_t *world)
+{
+    return ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Player"}),
+        .members = {
+            {"id", ecs_id(ecs_i32_t)},
+            {"score", ecs_id(ecs_f32_t)}
+        }
+    });
+}
+
+static
+bool has_entity(
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_entity_t e)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (entities[i] == e) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Index_lookup() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {20, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Player, {10, 3});
+
+    int32_t count, value = 10;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 2);
+    test_assert(has_entity(entities, count, e1));
+    test_assert(has_entity(entities, count, e3));
+
+    value = 20;
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_not_found() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_set(world, 0, Player, {10, 1});
+
+    int32_t count = -1, value = 30;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_assert(entities == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {10, 2});
+
+    ecs_set(world, e1, Player, {20, 1});
+
+    int32_t count, value = 10;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    value = 20;
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e1);
+
+    /* Setting a member that's not indexed doesn't change the index */
+    ecs_set(world, e1, Player, {20, 5});
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e1);
+
+    /* Values written through ecs_get_mut are indexed after ecs_modified */
+    Player *p = ecs_get_mut(world, e2, Player);
+    p->id = 20;
+    ecs_modified(world, e2, Player);
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 2);
+    test_assert(has_entity(entities, count, e1));
+    test_assert(has_entity(entities, count, e2));
+
+    value = 10;
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_after_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {10, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Player, {10, 3});
+
+    ecs_remove(world, e1, Player);
+
+    int32_t count, value = 10;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 2);
+    test_assert(has_entity(entities, count, e2));
+    test_assert(has_entity(entities, count, e3));
+
+    ecs_remove(world, e3, Player);
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    ecs_remove(world, e2, Player);
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_after_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {10, 2});
+
+    ecs_delete(world, e1);
+
+    int32_t count, value = 10;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_existing() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {20, 2});
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    int32_t count, value = 10;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e1);
+
+    value = 20;
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_nested_member() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Cell) = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Cell"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    ecs_entity_t ecs_id(Grid) = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Grid"}),
+        .members = {
+            {"speed", ecs_id(ecs_f32_t)},
+            {"cell", ecs_id(Cell)}
+        }
+    });
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Grid),
+        .member = "cell.y"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Grid, {1, {1, 2}});
+    ecs_entity_t e2 = ecs_set(world, 0, Grid, {1, {2, 3}});
+    ecs_entity_t e3 = ecs_set(world, 0, Grid, {1, {3, 2}});
+
+    int32_t count, value = 2;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 2);
+    test_assert(has_entity(entities, count, e1));
+    test_assert(has_entity(entities, count, e3));
+
+    value = 3;
+    entities = ecs_index_lookup(world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e2);
+
+    ecs_fini(world);
+}
+
+void Index_lookup_signed() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Signed) = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "Signed"}),
+        .members = {
+            {"value", ecs_id(ecs_i8_t)}
+        }
+    });
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Signed),
+        .member = "value"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Signed, {-1});
+    ecs_set(world, 0, Signed, {1});
+
+    int32_t count;
+    ecs_i8_t value = -1;
+    const ecs_entity_t *entities = ecs_index_lookup(
+        world, index, &value, &count);
+    test_int(count, 1);
+    test_uint(entities[0], e1);
+
+    ecs_fini(world);
+}
+
+void Index_invalid_member_type() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_log_set_level(-4);
+    test_assert(0 == ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "score"
+    }));
+
+    test_assert(0 == ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "name"
+    }));
+
+    test_assert(0 == ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player)
+    }));
+
+    ecs_fini(world);
+}
+
+void Index_iter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_set(world, 0, Player, {20, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Player, {10, 3});
+    ecs_add(world, e3, Tag);
+
+    int32_t value = 10, count = 0;
+    float score = 0;
+    ecs_iter_t it = ecs_index_iter(world, index, &value);
+    while (ecs_index_next(&it)) {
+        test_int(it.count, 1);
+        test_assert(it.entities[0] == e1 || it.entities[0] == e3);
+        test_assert(it.table == ecs_get_table(world, it.entities[0]));
+
+        Player *p = ecs_field(&it, Player, 1);
+        test_int(p->id, 10);
+        test_uint(ecs_field_id(&it, 1), ecs_id(Player));
+        score += p->score;
+        count ++;
+    }
+
+    test_int(count, 2);
+    test_int(score, 4);
+
+    ecs_fini(world);
+}
+
+void Index_chain_filter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Player, {10, 1});
+    ecs_entity_t e2 = ecs_set(world, 0, Player, {10, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Player, {10, 3});
+    ecs_entity_t e4 = ecs_set(world, 0, Player, {20, 4});
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+    ecs_add(world, e4, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Player) }, { Tag }}
+    });
+    test_assert(f != NULL);
+
+    /* e2 and e3 are in the same table, but only index results are returned */
+    ecs_delete(world, e1);
+    ecs_set(world, e3, Player, {30, 3});
+
+    int32_t value = 10;
+    ecs_iter_t index_it = ecs_index_iter(world, index, &value);
+    ecs_iter_t it = ecs_filter_chain_iter(&index_it, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    Player *p = ecs_field(&it, Player, 1);
+    test_int(p->id, 10);
+    test_int(p->score, 2);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Index_delete_index() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Player) = player_init(world);
+
+    ecs_entity_t index = ecs_index_init(world, &(ecs_index_desc_t){
+        .component = ecs_id(Player),
+        .member = "id"
+    });
+    test_assert(index != 0);
+
+    ecs_set(world, 0, Player, {10, 1});
+    ecs_delete(world, index);
+
+    /* Setting values after the index is deleted must not crash */
+    ecs_set(world, 0, Player, {10, 2});
+
+    ecs_fini(world);
+}
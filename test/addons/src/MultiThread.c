@@ -1257,3 +1257,403 @@ void MultiThread_bulk_new_in_no_readonly_w_multithread() {
 
     ecs_fini(world);
 }
+
+static int32_t sync_invoked = 0;
+
+static
+void SyncSingleThreaded(ecs_iter_t *it) {
+    sync_invoked ++;
+}
+
+void MultiThread_many_sync_points_w_4_threads() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    /* Alternate between multi and single threaded systems so that every 
+     * system is followed by a sync point */
+    int i;
+    for (i = 0; i < 8; i ++) {
+        ecs_system_init(world, &(ecs_system_desc_t){
+            .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+            .query.filter.terms = {{ ecs_id(Position) }},
+            .callback = Progress,
+            .multi_threaded = true
+        });
+
+        ecs_system_init(world, &(ecs_system_desc_t){
+            .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+            .callback = SyncSingleThreaded
+        });
+    }
+
+    ecs_entity_t e[10];
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+
+    for (i = 0; i < 100; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    test_int(sync_invoked, 8 * 100);
+
+    for (i = 0; i < 10; i ++) {
+        test_int(ecs_get(world, e[i], Position)->x, 8 * 100);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_chunked_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = Progress,
+        .multi_threaded = true,
+        .chunk_size = 7
+    });
+
+    int i, ENTITIES = 100;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+        if (i > 80) {
+            ecs_add(world, handles[i], TagA);
+        }
+        if (i > 95) {
+            ecs_add(world, handles[i], TagB);
+        }
+    }
+
+    ecs_set_threads(world, 4);
+
+    for (i = 0; i < 10; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 10);
+    }
+
+    ecs_fini(world);
+}
+
+static
+void ProgressRun(ecs_iter_t *it) {
+    while (ecs_iter_next(it)) {
+        Progress(it);
+    }
+}
+
+void MultiThread_4_thread_chunked_system_w_run() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .run = ProgressRun,
+        .multi_threaded = true,
+        .chunk_size = 3
+    });
+
+    int i, ENTITIES = 50;
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+    }
+
+    ecs_set_threads(world, 4);
+
+    for (i = 0; i < 10; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 10);
+    }
+
+    ecs_fini(world);
+}
+
+typedef struct {
+    int32_t stage_id;
+    int32_t order;
+} SystemRun;
+
+static int32_t run_order = 0;
+
+static
+void RecordRun(ecs_iter_t *it) {
+    SystemRun *run = it->ctx;
+    run->stage_id = ecs_get_stage_id(it->world);
+    run->order = ecs_os_ainc(&run_order);
+}
+
+void MultiThread_concurrent_systems() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, 0, Velocity, {0, 0});
+
+    SystemRun run_a = {-1}, run_b = {-1};
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .callback = RecordRun,
+        .ctx = &run_a,
+        .concurrent = true
+    });
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Velocity), .inout = EcsOut }},
+        .callback = RecordRun,
+        .ctx = &run_b,
+        .concurrent = true
+    });
+
+    ecs_set_threads(world, 3);
+
+    ecs_progress(world, 0);
+
+    /* Systems don't share components, and are distributed across workers */
+    test_int(run_a.stage_id, 1);
+    test_int(run_b.stage_id, 2);
+
+    ecs_fini(world);
+}
+
+void MultiThread_concurrent_systems_w_conflict() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e, Velocity, {0, 0});
+
+    SystemRun run_a = {-1}, run_b = {-1}, run_c = {-1};
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .callback = RecordRun,
+        .ctx = &run_a,
+        .concurrent = true
+    });
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Velocity), .inout = EcsOut }},
+        .callback = RecordRun,
+        .ctx = &run_b,
+        .concurrent = true
+    });
+
+    /* Reads component written by the first system */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .callback = RecordRun,
+        .ctx = &run_c,
+        .concurrent = true
+    });
+
+    ecs_set_threads(world, 3);
+
+    ecs_progress(world, 0);
+
+    test_int(run_a.stage_id, 1);
+    test_int(run_b.stage_id, 2);
+    test_int(run_c.stage_id, 1);
+    test_assert(run_a.order < run_c.order);
+
+    ecs_fini(world);
+}
+
+void MultiThread_concurrent_system_w_pinned_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e, Velocity, {0, 0});
+
+    SystemRun run_a = {-1}, run_b = {-1}, run_c = {-1};
+
+    /* Not concurrent, always runs on main thread */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .callback = RecordRun,
+        .ctx = &run_a
+    });
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .callback = RecordRun,
+        .ctx = &run_b,
+        .concurrent = true
+    });
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Velocity), .inout = EcsIn }},
+        .callback = RecordRun,
+        .ctx = &run_c,
+        .concurrent = true
+    });
+
+    ecs_set_threads(world, 2);
+
+    ecs_progress(world, 0);
+
+    test_int(run_a.stage_id, 0);
+    test_int(run_b.stage_id, 0);
+    test_int(run_c.stage_id, 1);
+    test_assert(run_a.order < run_b.order);
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t set_mass_entity = 0;
+static ecs_entity_t set_mass_id = 0;
+
+static
+void SetMass(ecs_iter_t *it) {
+    ecs_set_id(it->world, set_mass_entity, set_mass_id, sizeof(Mass), it->ctx);
+}
+
+void MultiThread_concurrent_systems_merge_in_pipeline_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e, Velocity, {0, 0});
+    set_mass_entity = ecs_new_id(world);
+    set_mass_id = ecs_id(Mass);
+
+    Mass mass_a = 1, mass_b = 2, mass_c = 3;
+
+    /* Runs on stage 1 */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .callback = SetMass,
+        .ctx = &mass_a,
+        .concurrent = true
+    });
+
+    /* Runs on stage 2 */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Velocity), .inout = EcsOut }},
+        .callback = SetMass,
+        .ctx = &mass_b,
+        .concurrent = true
+    });
+
+    /* Runs on stage 1, after the first system */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .callback = SetMass,
+        .ctx = &mass_c,
+        .concurrent = true
+    });
+
+    ecs_set_threads(world, 3);
+
+    ecs_progress(world, 0);
+
+    /* Commands are merged in pipeline order, not in stage order */
+    test_assert(ecs_has(world, set_mass_entity, Mass));
+    test_int(*ecs_get(world, set_mass_entity, Mass), 3);
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t cmd_entity = 0;
+
+static
+void AddCmdId(ecs_iter_t *it) {
+    ecs_add_id(it->world, cmd_entity, *(ecs_id_t*)it->ctx);
+}
+
+static
+void RemoveCmdId(ecs_iter_t *it) {
+    ecs_remove_id(it->world, cmd_entity, *(ecs_id_t*)it->ctx);
+}
+
+void MultiThread_concurrent_systems_merge_interleaved_stages() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagX);
+    ECS_TAG(world, Bar);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e, Velocity, {0, 0});
+    cmd_entity = ecs_new(world, Bar);
+
+    /* Runs on stage 1 */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .callback = AddCmdId,
+        .ctx = &TagX,
+        .concurrent = true
+    });
+
+    /* Runs on stage 0 */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Velocity), .inout = EcsOut }},
+        .callback = RemoveCmdId,
+        .ctx = &Bar,
+        .concurrent = true
+    });
+
+    /* Runs on stage 1, after the first system. Its command for the entity 
+     * must not be merged together with the command of the first system, as
+     * the command of the second system has to run in between. */
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .query.filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .callback = AddCmdId,
+        .ctx = &Bar,
+        .concurrent = true
+    });
+
+    ecs_set_threads(world, 2);
+
+    ecs_progress(world, 0);
+
+    test_assert(ecs_has(world, cmd_entity, TagX));
+    test_assert(ecs_has(world, cmd_entity, Bar));
+
+    ecs_fini(world);
+}
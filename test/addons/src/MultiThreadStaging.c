@@ -611,3 +611,132 @@ void MultiThreadStaging_set_pair_w_new_target_tgt_component_defer() {
 
     ecs_fini(world);
 }
+
+static ecs_entity_t parallel_merge_position;
+static ecs_entity_t parallel_merge_velocity;
+
+static
+void ParallelMergeSet(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_set_id(it->world, it->entities[i], parallel_merge_position, 
+            sizeof(Position), &(Position){p[i].x + 1, p[i].y + 2});
+        ecs_set_id(it->world, it->entities[i], parallel_merge_velocity, 
+            sizeof(Velocity), &(Velocity){p[i].x, p[i].y});
+    }
+}
+
+void MultiThreadStaging_parallel_merge_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    parallel_merge_position = ecs_id(Position);
+    parallel_merge_velocity = ecs_id(Velocity);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, {
+            .add = { ecs_dependson(EcsOnUpdate) }
+        }),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = ParallelMergeSet,
+        .multi_threaded = true
+    });
+
+    ecs_entity_t tags[] = { TagA, TagB, TagC };
+    ecs_entity_t e[2000];
+    int i;
+    for (i = 0; i < 2000; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+        ecs_add_id(world, e[i], tags[i % 3]);
+        if (i < 1000) {
+            ecs_set(world, e[i], Velocity, {0, 0});
+        }
+    }
+
+    ecs_set_parallel_merge(world, true);
+    ecs_set_threads(world, 4);
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < 2000; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i + 2);
+        test_int(p->y, i * 2 + 4);
+
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i + 1);
+        test_int(v->y, i * 2 + 2);
+    }
+
+    ecs_fini(world);
+}
+
+static int parallel_merge_on_set_count = 0;
+
+static
+void ParallelMergeOnSet(ecs_iter_t *it) {
+    Velocity *v = ecs_field(it, Velocity, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        const Position *p = ecs_get_id(
+            it->world, it->entities[i], parallel_merge_position);
+        test_assert(p != NULL);
+        test_int(v[i].x + 1, p->x);
+        parallel_merge_on_set_count ++;
+    }
+}
+
+void MultiThreadStaging_parallel_merge_set_w_on_set_observer() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    parallel_merge_position = ecs_id(Position);
+    parallel_merge_velocity = ecs_id(Velocity);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, {
+            .add = { ecs_dependson(EcsOnUpdate) }
+        }),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = ParallelMergeSet,
+        .multi_threaded = true
+    });
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }},
+        .events = { EcsOnSet },
+        .callback = ParallelMergeOnSet
+    });
+
+    ecs_entity_t e[1000];
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_set_parallel_merge(world, true);
+    ecs_set_threads(world, 4);
+
+    ecs_progress(world, 0);
+    test_int(parallel_merge_on_set_count, 1000);
+
+    for (i = 0; i < 1000; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i + 1);
+        test_int(p->y, i * 2 + 2);
+    }
+
+    ecs_fini(world);
+}
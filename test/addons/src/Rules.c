@@ -6785,3 +6785,420 @@ void Rules_rule_w_short_notation() {
 
     ecs_fini(world);
 }
+
+void Rules_cached_results_replay() {
+    ecs_world_t *world = ecs_mini();
+
+    test_assert(ecs_plecs_from_str(world, NULL, rules) == 0);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "HomePlanet($This, $X), Enemy($This, $Y)",
+        .flags = EcsFilterCacheResults
+    });
+
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+    int32_t y_var = ecs_rule_find_var(r, "Y");
+    test_assert(y_var != -1);
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+
+        test_true(test_iter(&it, ecs_rule_next, &(test_iter_result_t){
+            .entity_names = {"Luke", "Luke", "Yoda", "Yoda", "Rey"},
+            .term_ids_expr = {
+                {"(HomePlanet,Tatooine)", "(Enemy,DarthVader)"}, 
+                {"(HomePlanet,Tatooine)", "(Enemy,Palpatine)"}, 
+                {"(HomePlanet,Dagobah)", "(Enemy,DarthVader)"},
+                {"(HomePlanet,Dagobah)", "(Enemy,Palpatine)"}, 
+                {"(HomePlanet,Tatooine)", "(Enemy,Palpatine)"}
+            },
+            .variables = {
+                {x_var, .entity_names = {
+                    "Tatooine", "Tatooine", "Dagobah", "Dagobah", "Tatooine"
+                }},
+                {y_var, .entity_names = {
+                    "DarthVader", "Palpatine", "DarthVader", "Palpatine", 
+                    "Palpatine"
+                }}
+            }
+        }));
+    }
+
+    ecs_rule_fini(r);
+    
+    ecs_fini(world);
+}
+
+void Rules_cached_results_invalidate_on_table_change() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, Rel);
+
+    ecs_entity_t t1 = ecs_new_id(world);
+    ecs_entity_t t2 = ecs_new_id(world);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_add_pair(world, e1, Rel, t1);
+
+    ecs_entity_t e2 = ecs_new(world, TagA);
+
+    /* Create empty table with (Rel, t2) */
+    ecs_entity_t e3 = ecs_new(world, TagA);
+    ecs_add_pair(world, e3, Rel, t2);
+    ecs_delete(world, e3);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA, (Rel, $X)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(t1, ecs_iter_get_var(&it, x_var));
+    test_bool(false, ecs_rule_next(&it));
+
+    /* Moves entity to existing table */
+    ecs_add_pair(world, e2, Rel, t2);
+
+    it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(t1, ecs_iter_get_var(&it, x_var));
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_uint(t2, ecs_iter_get_var(&it, x_var));
+    test_bool(false, ecs_rule_next(&it));
+
+    /* Creates new table */
+    ecs_remove(world, e1, TagA);
+
+    it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_uint(t2, ecs_iter_get_var(&it, x_var));
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+    
+    ecs_fini(world);
+}
+
+void Rules_cached_results_stop_early() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+    ecs_add(world, e2, TagB);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    ecs_iter_fini(&it);
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+    
+    ecs_fini(world);
+}
+
+void Rules_cached_results_w_constrained_var() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, Rel);
+
+    ecs_entity_t t1 = ecs_new_id(world);
+    ecs_entity_t t2 = ecs_new_id(world);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_add_pair(world, e1, Rel, t1);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+    ecs_add_pair(world, e2, Rel, t2);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA, (Rel, $X)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e1, it.entities[0]);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_rule_next(&it));
+
+    it = ecs_rule_iter(world, r);
+    ecs_iter_set_var(&it, x_var, t2);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_uint(t2, ecs_iter_get_var(&it, x_var));
+    test_bool(false, ecs_rule_next(&it));
+
+    it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e1, it.entities[0]);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+    
+    ecs_fini(world);
+}
+
+typedef struct rule_result_sum_t {
+    int32_t count;
+    uint64_t sum;
+} rule_result_sum_t;
+
+static
+void rule_result_sum(
+    ecs_iter_t *it,
+    rule_result_sum_t *result)
+{
+    while (ecs_rule_next(it)) {
+        /* Results of rules without This variable have no entities */
+        int32_t i, v, count = it->count ? it->count : 1;
+        for (i = 0; i < count; i ++) {
+            uint64_t hash = it->count ? it->entities[i] : 0;
+            for (v = 0; v < it->variable_count; v ++) {
+                ecs_entity_t var = ecs_iter_get_var(it, v);
+                if (ecs_rule_var_is_entity(it->priv.iter.rule.rule, v)) {
+                    hash = hash * 31 + var;
+                }
+            }
+            result->count ++;
+            result->sum += hash;
+        }
+    }
+}
+
+void Rules_worker_iter_2_workers() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, Rel);
+
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_new(world, TagA);
+        ecs_add_pair(world, e[i], Rel, ecs_new_id(world));
+    }
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA, (Rel, $X)"
+    });
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_worker_iter(world, r, 0, 2);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e[0], it.entities[0]);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e[2], it.entities[0]);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e[4], it.entities[0]);
+    test_bool(false, ecs_rule_next(&it));
+
+    it = ecs_rule_worker_iter(world, r, 1, 2);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e[1], it.entities[0]);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e[3], it.entities[0]);
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_worker_iter_3_workers_w_vars() {
+    ecs_world_t *world = ecs_mini();
+
+    test_assert(ecs_plecs_from_str(world, NULL, rules) == 0);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Enemy($X, $Y), Sith($Y), Human($X)"
+    });
+    test_assert(r != NULL);
+
+    rule_result_sum_t expect = {0};
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    rule_result_sum(&it, &expect);
+    test_assert(expect.count > 1);
+
+    rule_result_sum_t actual = {0};
+    int i;
+    for (i = 0; i < 3; i ++) {
+        it = ecs_rule_worker_iter(world, r, i, 3);
+        rule_result_sum(&it, &actual);
+    }
+
+    test_int(expect.count, actual.count);
+    test_uint(expect.sum, actual.sum);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_worker_iter_cached_results() {
+    ecs_world_t *world = ecs_mini();
+
+    test_assert(ecs_plecs_from_str(world, NULL, rules) == 0);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "HomePlanet($This, $X), Enemy($This, $Y)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    /* Worker iterators don't populate the cache */
+    rule_result_sum_t actual = {0};
+    ecs_iter_t it = ecs_rule_worker_iter(world, r, 0, 2);
+    rule_result_sum(&it, &actual);
+    it = ecs_rule_worker_iter(world, r, 1, 2);
+    rule_result_sum(&it, &actual);
+
+    rule_result_sum_t expect = {0};
+    it = ecs_rule_iter(world, r);
+    rule_result_sum(&it, &expect);
+    test_int(5, expect.count);
+    test_int(expect.count, actual.count);
+    test_uint(expect.sum, actual.sum);
+
+    /* Replay cached results */
+    actual = (rule_result_sum_t){0};
+    it = ecs_rule_worker_iter(world, r, 0, 2);
+    rule_result_sum(&it, &actual);
+    test_int(3, actual.count);
+    it = ecs_rule_worker_iter(world, r, 1, 2);
+    rule_result_sum(&it, &actual);
+    test_int(expect.count, actual.count);
+    test_uint(expect.sum, actual.sum);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_worker_iter_no_select() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_add(world, e, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA(e), TagB(e)"
+    });
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_worker_iter(world, r, 0, 2);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e, ecs_field_src(&it, 1));
+    test_uint(e, ecs_field_src(&it, 2));
+    test_bool(false, ecs_rule_next(&it));
+
+    it = ecs_rule_worker_iter(world, r, 1, 2);
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_cached_results_refill_while_replaying() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+    ecs_add(world, e2, TagB);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    /* Populate cache */
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) { }
+
+    /* Replay cached results */
+    it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+
+    /* Invalidates cache */
+    ecs_entity_t e3 = ecs_new(world, TagA);
+
+    /* Repopulates cache while outer iterator is replaying */
+    ecs_iter_t inner = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&inner));
+    test_int(2, inner.count);
+    test_uint(e1, inner.entities[0]);
+    test_uint(e3, inner.entities[1]);
+    ecs_iter_fini(&inner);
+
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+    
+    ecs_fini(world);
+}
@@ -1144,3 +1144,251 @@ void TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both() {
 
     ecs_fini(world);
 }
+
+static
+int32_t rule_count(
+    ecs_world_t *world,
+    ecs_rule_t *r)
+{
+    int32_t count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        count += it.count;
+    }
+    return count;
+}
+
+void TransitiveRules_trans_subsets_32_levels() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t parent = root;
+    int i;
+    for (i = 0; i < 32; i ++) {
+        ecs_entity_t e = ecs_new_w_pair(world, LocatedIn, parent);
+        parent = e;
+    }
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(r != NULL);
+
+    test_int(32, rule_count(world, r));
+    test_int(32, rule_count(world, r));
+
+    ecs_rule_fini(r);
+    ecs_fini(world);
+}
+
+void TransitiveRules_trans_subsets_after_add_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t e1 = ecs_new_w_pair(world, LocatedIn, root);
+    ecs_entity_t e2 = ecs_new_w_pair(world, LocatedIn, e1);
+    ecs_entity_t e3 = ecs_new_w_pair(world, LocatedIn, e1);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(r != NULL);
+
+    test_int(3, rule_count(world, r));
+
+    /* Add to existing table */
+    ecs_entity_t e4 = ecs_new_w_pair(world, LocatedIn, e1);
+    test_int(4, rule_count(world, r));
+
+    /* Create new table */
+    ecs_entity_t e5 = ecs_new_w_pair(world, LocatedIn, e2);
+    test_int(5, rule_count(world, r));
+
+    /* Move to existing table outside of hierarchy */
+    ecs_entity_t other = ecs_new_id(world);
+    ecs_entity_t e6 = ecs_new_w_pair(world, LocatedIn, other);
+    test_int(5, rule_count(world, r));
+    ecs_remove_pair(world, e4, LocatedIn, e1);
+    ecs_add_pair(world, e4, LocatedIn, other);
+    test_int(4, rule_count(world, r));
+
+    /* Move back */
+    ecs_remove_pair(world, e6, LocatedIn, other);
+    ecs_add_pair(world, e6, LocatedIn, e3);
+    test_int(5, rule_count(world, r));
+
+    ecs_delete(world, e2);
+    test_int(3, rule_count(world, r));
+
+    ecs_rule_fini(r);
+    ecs_fini(world);
+}
+
+static ecs_rule_t *trans_rule;
+static int32_t trans_stage_count[2];
+
+static
+void TransSubsetsFromStage(ecs_iter_t *it) {
+    int32_t stage_id = ecs_get_stage_id(it->world);
+    test_assert(stage_id >= 0 && stage_id < 2);
+    trans_stage_count[stage_id] = rule_count(it->world, trans_rule);
+}
+
+void TransitiveRules_trans_subsets_40_levels_from_worker() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t parent = root;
+    int i;
+    for (i = 0; i < 40; i ++) {
+        ecs_entity_t e = ecs_new_w_pair(world, LocatedIn, parent);
+        parent = e;
+    }
+
+    trans_rule = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(trans_rule != NULL);
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) } }),
+        .callback = TransSubsetsFromStage,
+        .multi_threaded = true
+    });
+
+    ecs_set_threads(world, 2);
+
+    /* The closure isn't computed while workers are running, so workers walk
+     * the hierarchy */
+    ecs_progress(world, 0);
+    test_int(40, trans_stage_count[0]);
+    test_int(40, trans_stage_count[1]);
+
+    /* Compute closure on main thread, and replay it from workers */
+    test_int(40, rule_count(world, trans_rule));
+    trans_stage_count[0] = trans_stage_count[1] = 0;
+    ecs_progress(world, 0);
+    test_int(40, trans_stage_count[0]);
+    test_int(40, trans_stage_count[1]);
+
+    ecs_rule_fini(trans_rule);
+    ecs_fini(world);
+}
+
+void TransitiveRules_trans_subsets_multiple_parents() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t e1 = ecs_new_w_pair(world, LocatedIn, root);
+    ecs_entity_t e2 = ecs_new_w_pair(world, LocatedIn, root);
+    ecs_entity_t e3 = ecs_new_w_pair(world, LocatedIn, e1);
+    ecs_add_pair(world, e3, LocatedIn, e2);
+    ecs_new_w_pair(world, LocatedIn, e3);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(r != NULL);
+
+    /* Table of e3 is yielded for each parent */
+    test_int(5, rule_count(world, r));
+
+    /* e3 is still in the closure through e2 */
+    ecs_remove_pair(world, e1, LocatedIn, root);
+    test_int(3, rule_count(world, r));
+
+    ecs_remove_pair(world, e2, LocatedIn, root);
+    test_int(0, rule_count(world, r));
+
+    ecs_add_pair(world, e1, LocatedIn, root);
+    test_int(3, rule_count(world, r));
+
+    ecs_add_pair(world, e2, LocatedIn, root);
+    test_int(5, rule_count(world, r));
+
+    ecs_rule_fini(r);
+    ecs_fini(world);
+}
+
+void TransitiveRules_trans_subsets_delete_target() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t e1 = ecs_new_w_pair(world, LocatedIn, root);
+    ecs_entity_t e2 = ecs_new_w_pair(world, LocatedIn, e1);
+    ecs_new_w_pair(world, LocatedIn, e2);
+    ecs_new_w_pair(world, LocatedIn, e2);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(r != NULL);
+
+    test_int(4, rule_count(world, r));
+
+    /* Pairs with e1 are removed, which moves the subtree out of the closure */
+    ecs_delete(world, e1);
+    test_int(0, rule_count(world, r));
+
+    /* Id of e1 is recycled by an entity that isn't in the closure */
+    ecs_entity_t e4 = ecs_new_id(world);
+    ecs_new_w_pair(world, LocatedIn, e4);
+    test_int(0, rule_count(world, r));
+
+    ecs_add_pair(world, e2, LocatedIn, root);
+    test_int(3, rule_count(world, r));
+
+    ecs_add_pair(world, e4, LocatedIn, e2);
+    test_int(5, rule_count(world, r));
+
+    ecs_rule_fini(r);
+    ecs_fini(world);
+}
+
+void TransitiveRules_trans_subsets_iter_while_changed() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t root = ecs_set_name(world, 0, "Root");
+    ecs_entity_t e1 = ecs_new_w_pair(world, LocatedIn, root);
+    ecs_new_w_pair(world, LocatedIn, e1);
+    ecs_new_w_pair(world, LocatedIn, e1);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn($This, Root)"
+    });
+    test_assert(r != NULL);
+
+    test_int(3, rule_count(world, r));
+
+    /* Outer iterator keeps yielding the closure it started with, while the
+     * inner iterators update it */
+    int32_t count = 0, inner = 3;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        count += it.count;
+
+        ecs_entity_t e = ecs_new_w_pair(world, LocatedIn, it.entities[0]);
+        ecs_add(world, e, Tag);
+        inner += 1;
+        test_int(inner, rule_count(world, r));
+    }
+
+    test_int(3, count);
+    test_int(5, rule_count(world, r));
+
+    ecs_rule_fini(r);
+    ecs_fini(world);
+}
@@ -628,6 +628,15 @@ void Rules_table_subj_as_obj_in_not(void);
 void Rules_invalid_variable_only(void);
 void Rules_page_iter(void);
 void Rules_rule_w_short_notation(void);
+void Rules_cached_results_replay(void);
+void Rules_cached_results_invalidate_on_table_change(void);
+void Rules_cached_results_stop_early(void);
+void Rules_cached_results_w_constrained_var(void);
+void Rules_worker_iter_2_workers(void);
+void Rules_worker_iter_3_workers_w_vars(void);
+void Rules_worker_iter_cached_results(void);
+void Rules_worker_iter_no_select(void);
+void Rules_cached_results_refill_while_replaying(void);
 
 // Testsuite 'TransitiveRules'
 void TransitiveRules_trans_X_X(void);
@@ -654,6 +663,12 @@ void TransitiveRules_rule_iter_set_transitive_self_variable(void);
 void TransitiveRules_rule_iter_set_transitive_2_variables_set_one(void);
 void TransitiveRules_rule_iter_set_transitive_2_variables_set_both(void);
 void TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both(void);
+void TransitiveRules_trans_subsets_32_levels(void);
+void TransitiveRules_trans_subsets_after_add_remove(void);
+void TransitiveRules_trans_subsets_40_levels_from_worker(void);
+void TransitiveRules_trans_subsets_multiple_parents(void);
+void TransitiveRules_trans_subsets_delete_target(void);
+void TransitiveRules_trans_subsets_iter_while_changed(void);
 
 // Testsuite 'SystemPeriodic'
 void SystemPeriodic_1_type_1_component(void);
@@ -867,6 +882,14 @@ void MultiThread_get_binding_ctx(void);
 void MultiThread_get_ctx_w_run(void);
 void MultiThread_get_binding_ctx_w_run(void);
 void MultiThread_bulk_new_in_no_readonly_w_multithread(void);
+void MultiThread_many_sync_points_w_4_threads(void);
+void MultiThread_4_thread_chunked_system(void);
+void MultiThread_4_thread_chunked_system_w_run(void);
+void MultiThread_concurrent_systems(void);
+void MultiThread_concurrent_systems_w_conflict(void);
+void MultiThread_concurrent_system_w_pinned_system(void);
+void MultiThread_concurrent_systems_merge_in_pipeline_order(void);
+void MultiThread_concurrent_systems_merge_interleaved_stages(void);
 
 // Testsuite 'MultiThreadStaging'
 void MultiThreadStaging_setup(void);
@@ -884,6 +907,8 @@ void MultiThreadStaging_set_pair_w_new_target_readonly(void);
 void MultiThreadStaging_set_pair_w_new_target_tgt_component_readonly(void);
 void MultiThreadStaging_set_pair_w_new_target_defer(void);
 void MultiThreadStaging_set_pair_w_new_target_tgt_component_defer(void);
+void MultiThreadStaging_parallel_merge_set(void);
+void MultiThreadStaging_parallel_merge_set_w_on_set_observer(void);
 
 // Testsuite 'Snapshot'
 void Snapshot_simple_snapshot(void);
@@ -952,6 +977,20 @@ void Http_stop_start(void);
 // Testsuite 'Rest'
 void Rest_teardown(void);
 
+// Testsuite 'Index'
+void Index_lookup(void);
+void Index_lookup_not_found(void);
+void Index_lookup_after_set(void);
+void Index_lookup_after_remove(void);
+void Index_lookup_after_delete(void);
+void Index_lookup_existing(void);
+void Index_lookup_nested_member(void);
+void Index_lookup_signed(void);
+void Index_invalid_member_type(void);
+void Index_iter(void);
+void Index_chain_filter(void);
+void Index_delete_index(void);
+
 bake_test_case Parser_testcases[] = {
     {
         "resolve_this",
@@ -3403,6 +3442,42 @@ bake_test_case Rules_testcases[] = {
     {
         "rule_w_short_notation",
         Rules_rule_w_short_notation
+    },
+    {
+        "cached_results_replay",
+        Rules_cached_results_replay
+    },
+    {
+        "cached_results_invalidate_on_table_change",
+        Rules_cached_results_invalidate_on_table_change
+    },
+    {
+        "cached_results_stop_early",
+        Rules_cached_results_stop_early
+    },
+    {
+        "cached_results_w_constrained_var",
+        Rules_cached_results_w_constrained_var
+    },
+    {
+        "worker_iter_2_workers",
+        Rules_worker_iter_2_workers
+    },
+    {
+        "worker_iter_3_workers_w_vars",
+        Rules_worker_iter_3_workers_w_vars
+    },
+    {
+        "worker_iter_cached_results",
+        Rules_worker_iter_cached_results
+    },
+    {
+        "worker_iter_no_select",
+        Rules_worker_iter_no_select
+    },
+    {
+        "cached_results_refill_while_replaying",
+        Rules_cached_results_refill_while_replaying
     }
 };
 
@@ -3502,6 +3577,30 @@ bake_test_case TransitiveRules_testcases[] = {
     {
         "rule_iter_set_transitive_self_2_variables_set_both",
         TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both
+    },
+    {
+        "trans_subsets_32_levels",
+        TransitiveRules_trans_subsets_32_levels
+    },
+    {
+        "trans_subsets_after_add_remove",
+        TransitiveRules_trans_subsets_after_add_remove
+    },
+    {
+        "trans_subsets_40_levels_from_worker",
+        TransitiveRules_trans_subsets_40_levels_from_worker
+    },
+    {
+        "trans_subsets_multiple_parents",
+        TransitiveRules_trans_subsets_multiple_parents
+    },
+    {
+        "trans_subsets_delete_target",
+        TransitiveRules_trans_subsets_delete_target
+    },
+    {
+        "trans_subsets_iter_while_changed",
+        TransitiveRules_trans_subsets_iter_while_changed
     }
 };
 
@@ -4278,6 +4377,38 @@ bake_test_case MultiThread_testcases[] = {
     {
         "bulk_new_in_no_readonly_w_multithread",
         MultiThread_bulk_new_in_no_readonly_w_multithread
+    },
+    {
+        "many_sync_points_w_4_threads",
+        MultiThread_many_sync_points_w_4_threads
+    },
+    {
+        "4_thread_chunked_system",
+        MultiThread_4_thread_chunked_system
+    },
+    {
+        "4_thread_chunked_system_w_run",
+        MultiThread_4_thread_chunked_system_w_run
+    },
+    {
+        "concurrent_systems",
+        MultiThread_concurrent_systems
+    },
+    {
+        "concurrent_systems_w_conflict",
+        MultiThread_concurrent_systems_w_conflict
+    },
+    {
+        "concurrent_system_w_pinned_system",
+        MultiThread_concurrent_system_w_pinned_system
+    },
+    {
+        "concurrent_systems_merge_in_pipeline_order",
+        MultiThread_concurrent_systems_merge_in_pipeline_order
+    },
+    {
+        "concurrent_systems_merge_interleaved_stages",
+        MultiThread_concurrent_systems_merge_interleaved_stages
     }
 };
 
@@ -4337,6 +4468,14 @@ bake_test_case MultiThreadStaging_testcases[] = {
     {
         "set_pair_w_new_target_tgt_component_defer",
         MultiThreadStaging_set_pair_w_new_target_tgt_component_defer
+    },
+    {
+        "parallel_merge_set",
+        MultiThreadStaging_parallel_merge_set
+    },
+    {
+        "parallel_merge_set_w_on_set_observer",
+        MultiThreadStaging_parallel_merge_set_w_on_set_observer
     }
 };
 
@@ -4579,6 +4718,57 @@ bake_test_case Rest_testcases[] = {
     }
 };
 
+bake_test_case Index_testcases[] = {
+    {
+        "lookup",
+        Index_lookup
+    },
+    {
+        "lookup_not_found",
+        Index_lookup_not_found
+    },
+    {
+        "lookup_after_set",
+        Index_lookup_after_set
+    },
+    {
+        "lookup_after_remove",
+        Index_lookup_after_remove
+    },
+    {
+        "lookup_after_delete",
+        Index_lookup_after_delete
+    },
+    {
+        "lookup_existing",
+        Index_lookup_existing
+    },
+    {
+        "lookup_nested_member",
+        Index_lookup_nested_member
+    },
+    {
+        "lookup_signed",
+        Index_lookup_signed
+    },
+    {
+        "invalid_member_type",
+        Index_invalid_member_type
+    },
+    {
+        "iter",
+        Index_iter
+    },
+    {
+        "chain_filter",
+        Index_chain_filter
+    },
+    {
+        "delete_index",
+        Index_delete_index
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Parser",
@@ -4619,14 +4809,14 @@ static bake_test_suite suites[] = {
         "Rules",
         NULL,
         NULL,
-        168,
+        177,
         Rules_testcases
     },
     {
         "TransitiveRules",
         NULL,
         NULL,
-        24,
+        30,
         TransitiveRules_testcases
     },
     {
@@ -4710,14 +4900,14 @@ static bake_test_suite suites[] = {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        47,
+        55,
         MultiThread_testcases
     },
     {
         "MultiThreadStaging",
         MultiThreadStaging_setup,
         NULL,
-        14,
+        16,
         MultiThreadStaging_testcases
     },
     {
@@ -4754,9 +4944,16 @@ static bake_test_suite suites[] = {
         NULL,
         1,
         Rest_testcases
+    },
+    {
+        "Index",
+        NULL,
+        NULL,
+        12,
+        Index_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("addons", argc, argv, suites, 25);
+    return bake_test_run("addons", argc, argv, suites, 26);
 }
@@ -396,3 +396,143 @@ void Add_invalid_pair_w_0_obj() {
 
     ecs_add_id(world, e, ecs_pair(Tag, 0));
 }
+
+void Add_bulk_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_add(world, e3, Tag);
+    ecs_entity_t e4 = ecs_new(world, Velocity);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_add_id(world, f, ecs_id(Velocity));
+
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e3, Velocity));
+    test_assert(ecs_has(world, e3, Tag));
+    test_assert(!ecs_has(world, e4, Position));
+
+    test_assert(ecs_get_table(world, e1) == ecs_get_table(world, e2));
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10); test_int(p->y, 20);
+    p = ecs_get(world, e2, Position);
+    test_int(p->x, 30); test_int(p->y, 40);
+    p = ecs_get(world, e3, Position);
+    test_int(p->x, 50); test_int(p->y, 60);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Add_bulk_add_to_nonempty_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }, { ecs_id(Velocity), .oper = EcsNot }}
+    });
+
+    ecs_bulk_add_id(world, f, ecs_id(Velocity));
+
+    test_assert(ecs_get_table(world, e1) == ecs_get_table(world, e2));
+    test_int(ECS_RECORD_TO_ROW(ecs_record_find(world, e1)->row), 0);
+    test_int(ECS_RECORD_TO_ROW(ecs_record_find(world, e2)->row), 1);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10); test_int(p->y, 20);
+    const Velocity *v = ecs_get(world, e1, Velocity);
+    test_int(v->x, 1); test_int(v->y, 2);
+    p = ecs_get(world, e2, Position);
+    test_int(p->x, 30); test_int(p->y, 40);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+static int bulk_on_add_count = 0;
+static int bulk_on_add_invoked = 0;
+
+static
+void BulkOnAdd(ecs_iter_t *it) {
+    bulk_on_add_invoked ++;
+    bulk_on_add_count += it->count;
+}
+
+void Add_bulk_add_observer() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Tag }},
+        .events = { EcsOnAdd },
+        .callback = BulkOnAdd
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_add(world, f, Tag);
+
+    test_int(bulk_on_add_invoked, 1);
+    test_int(bulk_on_add_count, 3);
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e2, Tag));
+    test_assert(ecs_has(world, e3, Tag));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Add_bulk_add_deferred() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_defer_begin(world);
+    ecs_bulk_add(world, f, Tag);
+    test_assert(!ecs_has(world, e1, Tag));
+    test_assert(!ecs_has(world, e2, Tag));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e2, Tag));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
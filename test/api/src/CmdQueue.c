@@ -0,0 +1,581 @@
+#include <api.h>
+
+void CmdQueue_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, Tag));
+    test_assert(!ecs_has(world, e, Tag));
+
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_set_id(q, e, ecs_id(Position),
+        sizeof(Position), &(Position){10, 20}));
+    test_assert(!ecs_has(world, e, Position));
+
+    test_int(1, ecs_cmd_queues_merge(world));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_w_id(world, Tag);
+    test_bool(true, ecs_cmd_queue_remove_id(q, e, Tag));
+    test_assert(ecs_has(world, e, Tag));
+
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_delete(q, e));
+    test_assert(ecs_is_alive(world, e));
+
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(!ecs_is_alive(world, e));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_add_w_pair() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, Tgt);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, ecs_pair(Rel, Tgt)));
+
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(ecs_has_pair(world, e, Rel, Tgt));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_set_macro() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new(world, Velocity);
+    test_bool(true, ecs_cmd_queue_set(q, e, Position, {10, 20}));
+    test_bool(true, ecs_cmd_queue_remove(q, e, Velocity));
+
+    test_int(2, ecs_cmd_queues_merge(world));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_merge_in_order() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_set(q, e, Position, {10, 20}));
+    test_bool(true, ecs_cmd_queue_remove(q, e, Position));
+    test_bool(true, ecs_cmd_queue_set(q, e, Position, {30, 40}));
+
+    test_int(3, ecs_cmd_queues_merge(world));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_merge_multiple_queues() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_cmd_queue_t *q_1 = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    ecs_cmd_queue_t *q_2 = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q_1 != NULL);
+    test_assert(q_2 != NULL);
+
+    ecs_entity_t e_1 = ecs_new_id(world);
+    ecs_entity_t e_2 = ecs_new_id(world);
+
+    /* Queues are merged in order of creation */
+    test_bool(true, ecs_cmd_queue_set(q_2, e_1, Position, {30, 40}));
+    test_bool(true, ecs_cmd_queue_set(q_1, e_1, Position, {10, 20}));
+    test_bool(true, ecs_cmd_queue_set(q_2, e_2, Position, {50, 60}));
+
+    test_int(3, ecs_cmd_queues_merge(world));
+
+    const Position *p = ecs_get(world, e_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    p = ecs_get(world, e_2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+
+    test_int(0, ecs_cmd_queues_merge(world));
+
+    ecs_cmd_queue_free(q_1);
+    ecs_cmd_queue_free(q_2);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_merge_on_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, Tag));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_progress(world, 0);
+    test_assert(ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_merge_on_frame_begin() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, Tag));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_frame_begin(world, 1);
+    test_assert(ecs_has(world, e, Tag));
+    ecs_frame_end(world);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_queue_full() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .capacity = 2
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, TagA));
+    test_bool(true, ecs_cmd_queue_add_id(q, e, TagB));
+    test_bool(false, ecs_cmd_queue_add_id(q, e, TagC));
+
+    test_int(2, ecs_cmd_queues_merge(world));
+    test_assert(ecs_has(world, e, TagA));
+    test_assert(ecs_has(world, e, TagB));
+    test_assert(!ecs_has(world, e, TagC));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_queue_full_after_merge() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .capacity = 2
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, TagA));
+    test_bool(true, ecs_cmd_queue_add_id(q, e, TagB));
+    test_bool(false, ecs_cmd_queue_add_id(q, e, TagC));
+
+    test_int(2, ecs_cmd_queues_merge(world));
+    test_bool(true, ecs_cmd_queue_add_id(q, e, TagC));
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(ecs_has(world, e, TagC));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_value_too_large() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .value_size = 4
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    char value[32] = {0};
+
+    test_expect_abort();
+    ecs_cmd_queue_set_id(q, e, ecs_id(Position), sizeof(value), value);
+}
+
+void CmdQueue_dead_entity_discarded() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, Tag));
+    ecs_delete(world, e);
+
+    int64_t discard_count = ecs_get_world_info(world)->cmd.discard_count;
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(!ecs_is_alive(world, e));
+    test_int(discard_count + 1, ecs_get_world_info(world)->cmd.discard_count);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_invalid_id_discarded() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, ecs_pair(Tag, EcsWildcard)));
+
+    int64_t discard_count = ecs_get_world_info(world)->cmd.discard_count;
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_assert(!ecs_has_pair(world, e, Tag, EcsWildcard));
+    test_int(discard_count + 1, ecs_get_world_info(world)->cmd.discard_count);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_free_merges_remaining() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q, e, Tag));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+    test_assert(ecs_has(world, e, Tag));
+
+    ecs_fini(world);
+}
+
+void CmdQueue_free_middle_queue() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_cmd_queue_t *q_1 = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    ecs_cmd_queue_t *q_2 = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    ecs_cmd_queue_t *q_3 = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+
+    ecs_cmd_queue_free(q_2);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_add_id(q_1, e, TagA));
+    test_bool(true, ecs_cmd_queue_add_id(q_3, e, TagC));
+
+    test_int(2, ecs_cmd_queues_merge(world));
+    test_assert(ecs_has(world, e, TagA));
+    test_assert(!ecs_has(world, e, TagB));
+    test_assert(ecs_has(world, e, TagC));
+
+    ecs_cmd_queue_free(q_1);
+    ecs_cmd_queue_free(q_3);
+
+    ecs_fini(world);
+}
+
+static int on_set_invoked = 0;
+
+static
+void CmdQueue_OnSet(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    test_int(it->count, 1);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    on_set_invoked ++;
+}
+
+void CmdQueue_w_on_set_observer() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_OBSERVER(world, CmdQueue_OnSet, EcsOnSet, Position);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0});
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_bool(true, ecs_cmd_queue_set(q, e, Position, {10, 20}));
+    test_int(on_set_invoked, 0);
+
+    test_int(1, ecs_cmd_queues_merge(world));
+    test_int(on_set_invoked, 1);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_wraparound() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .capacity = 3
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        test_bool(true, ecs_cmd_queue_set(q, e, Position, {i, i * 2}));
+        test_bool(true, ecs_cmd_queue_set(q, e, Position, {i + 1, i * 2 + 1}));
+        test_int(2, ecs_cmd_queues_merge(world));
+
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i + 1);
+        test_int(p->y, i * 2 + 1);
+    }
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+#define PRODUCER_COUNT (4)
+#define PRODUCER_ENTITY_COUNT (500)
+
+typedef struct {
+    ecs_cmd_queue_t *queue;
+    ecs_entity_t *entities;
+    ecs_entity_t component;
+    int32_t *done;
+    int32_t index;
+} producer_ctx_t;
+
+static
+void* producer(void *arg) {
+    producer_ctx_t *ctx = arg;
+
+    int i;
+    for (i = 0; i < PRODUCER_ENTITY_COUNT; i ++) {
+        Position p = {ctx->index, i};
+        while (!ecs_cmd_queue_set_id(ctx->queue, ctx->entities[i],
+            ctx->component, sizeof(Position), &p))
+        {
+            ecs_os_sleep(0, 1000);
+        }
+    }
+
+    ecs_os_ainc(ctx->done);
+
+    return NULL;
+}
+
+void CmdQueue_producer_thread() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[PRODUCER_ENTITY_COUNT];
+    int i;
+    for (i = 0; i < PRODUCER_ENTITY_COUNT; i ++) {
+        entities[i] = ecs_new_id(world);
+    }
+
+    int32_t done = 0;
+    producer_ctx_t ctx = {
+        .queue = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){0}),
+        .entities = entities,
+        .component = ecs_id(Position),
+        .done = &done
+    };
+
+    ecs_os_thread_t thr = ecs_os_thread_new(producer, &ctx);
+    ecs_os_thread_join(thr);
+    test_int(done, 1);
+
+    test_int(PRODUCER_ENTITY_COUNT, ecs_cmd_queues_merge(world));
+
+    for (i = 0; i < PRODUCER_ENTITY_COUNT; i ++) {
+        const Position *p = ecs_get(world, entities[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, 0);
+        test_int(p->y, i);
+    }
+
+    ecs_cmd_queue_free(ctx.queue);
+
+    ecs_fini(world);
+}
+
+void CmdQueue_producer_threads() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[PRODUCER_COUNT][PRODUCER_ENTITY_COUNT];
+    producer_ctx_t ctx[PRODUCER_COUNT];
+    ecs_os_thread_t thr[PRODUCER_COUNT];
+    int32_t done = 0;
+
+    int t, i;
+    for (t = 0; t < PRODUCER_COUNT; t ++) {
+        for (i = 0; i < PRODUCER_ENTITY_COUNT; i ++) {
+            entities[t][i] = ecs_new_id(world);
+        }
+
+        /* Small queues, so that producers have to wait for merges */
+        ctx[t] = (producer_ctx_t){
+            .queue = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+                .capacity = 16
+            }),
+            .entities = entities[t],
+            .component = ecs_id(Position),
+            .done = &done,
+            .index = t
+        };
+    }
+
+    for (t = 0; t < PRODUCER_COUNT; t ++) {
+        thr[t] = ecs_os_thread_new(producer, &ctx[t]);
+    }
+
+    while (*(volatile int32_t*)&done != PRODUCER_COUNT) {
+        ecs_frame_begin(world, 0);
+        ecs_frame_end(world);
+    }
+
+    for (t = 0; t < PRODUCER_COUNT; t ++) {
+        ecs_os_thread_join(thr[t]);
+    }
+
+    ecs_cmd_queues_merge(world);
+
+    for (t = 0; t < PRODUCER_COUNT; t ++) {
+        for (i = 0; i < PRODUCER_ENTITY_COUNT; i ++) {
+            const Position *p = ecs_get(world, entities[t][i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, t);
+            test_int(p->y, i);
+        }
+        ecs_cmd_queue_free(ctx[t].queue);
+    }
+
+    ecs_fini(world);
+}
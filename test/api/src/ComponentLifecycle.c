@@ -2736,3 +2736,103 @@ void ComponentLifecycle_move_ctor_on_move() {
 
     ecs_fini(world);
 }
+
+void ComponentLifecycle_relocatable_no_move_ctor_on_grow() {
+    ecs_world_t* world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position),
+        .move = ecs_move(Position),
+        .move_ctor = position_move_ctor,
+        .flags = EcsTypeHookRelocatable
+    });
+
+    const ecs_type_info_t *ti = ecs_get_type_info(world, ecs_id(Position));
+    test_assert(ti != NULL);
+    test_assert(ti->hooks.flags & EcsTypeHookRelocatable);
+
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_new(world, Position);
+        Position *p = ecs_get_mut(world, e[i], Position);
+        test_assert(p != NULL);
+        p->x = i;
+        p->y = i * 2;
+    }
+
+    test_int(ctor_position, 64);
+    test_int(move_ctor_position, 0);
+    test_int(move_position, 0);
+    test_int(dtor_position, 0);
+
+    for (i = 0; i < 64; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+
+    test_int(dtor_position, 64);
+}
+
+void ComponentLifecycle_hooks_on_bulk_add_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position),
+        .on_add = ecs_on_add(Position),
+        .on_remove = ecs_on_remove(Position)
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_add(world, e1, Velocity);
+    ecs_new(world, Velocity);
+    ecs_new(world, Velocity);
+    test_int(ctor_position, 1);
+    test_int(on_add_position, 1);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Velocity) }, { ecs_id(Position), .oper = EcsNot }}
+    });
+
+    /* Existing value in destination table must not be constructed again */
+    ecs_bulk_add(world, f, Position);
+    test_int(ctor_position, 3);
+    test_int(on_add_position, 3);
+    test_int(dtor_position, 0);
+
+    ecs_filter_fini(f);
+
+    f = ecs_filter(world, {
+        .terms = {{ ecs_id(Velocity) }}
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    while (ecs_filter_next(&it)) {
+        int i;
+        for (i = 0; i < it.count; i ++) {
+            ecs_set(world, it.entities[i], Position, {10, 20});
+        }
+    }
+
+    ecs_bulk_remove(world, f, Position);
+    test_int(on_remove_position, 3);
+    test_int(dtor_position, 3);
+    test_assert(!ecs_has(world, e1, Position));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+
+    test_int(dtor_position, 3);
+}
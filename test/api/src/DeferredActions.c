@@ -2743,3 +2743,787 @@ void DeferredActions_defer_remove_after_set_and_emplace_different_id() {
 
     ecs_fini(world);
 }
+
+void DeferredActions_parallel_merge_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e2, Velocity, {0, 0});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {1, 2});
+    test_int(ecs_get(world, e1, Position)->x, 0);
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    const Velocity *v = ecs_get(world, e2, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_twice() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Position, {30, 40});
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_new_component() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Velocity));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_then_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_delete(world, e1);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(ecs_is_alive(world, e2));
+
+    const Position *p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_then_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_remove(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+
+    ecs_fini(world);
+}
+
+static int parallel_merge_on_set_count = 0;
+static int parallel_merge_on_set_x[2];
+
+static
+void ParallelMergeOnSet(ecs_iter_t *it) {
+    Velocity *v = ecs_field(it, Velocity, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        test_assert(parallel_merge_on_set_count < 2);
+        parallel_merge_on_set_x[parallel_merge_on_set_count ++] = 
+            (int)v[i].x;
+    }
+}
+
+void DeferredActions_parallel_merge_set_w_on_set_observer() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }},
+        .events = { EcsOnSet },
+        .callback = ParallelMergeOnSet
+    });
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e1, Velocity, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {0, 0});
+    parallel_merge_on_set_count = 0;
+
+    ecs_defer_begin(world);
+    ecs_set(world, e2, Velocity, {2, 0});
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 0});
+    ecs_defer_end(world);
+
+    test_int(parallel_merge_on_set_count, 2);
+    test_int(parallel_merge_on_set_x[0], 2);
+    test_int(parallel_merge_on_set_x[1], 1);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+static int parallel_merge_move_count = 0;
+
+static
+void parallel_merge_move(void *dst, void *src, int32_t count, 
+    const ecs_type_info_t *ti) 
+{
+    parallel_merge_move_count += count;
+    ecs_os_memcpy(dst, src, ti->size * count);
+}
+
+void DeferredActions_parallel_merge_set_w_move_hook() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_hooks(world, Position, {
+        .move = parallel_merge_move
+    });
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    parallel_merge_move_count = 0;
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    test_int(parallel_merge_move_count, 0);
+    ecs_defer_end(world);
+
+    test_int(parallel_merge_move_count, 1);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_w_change_detection() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }}
+    });
+
+    test_bool(ecs_query_changed(q, NULL), true);
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+    test_bool(ecs_query_changed(q, NULL), false);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_defer_end(world);
+
+    test_bool(ecs_query_changed(q, NULL), true);
+
+    ecs_fini(world);
+}
+
+static int batched_group_invoked = 0;
+static int batched_group_count = 0;
+
+static
+void BatchedGroupOnAdd(ecs_iter_t *it) {
+    batched_group_invoked ++;
+    batched_group_count += it->count;
+}
+
+void DeferredActions_defer_add_batched_group() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Burning);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Burning }},
+        .events = { EcsOnAdd },
+        .callback = BatchedGroupOnAdd
+    });
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    batched_group_invoked = 0;
+    batched_group_count = 0;
+    int64_t group_count = ecs_get_world_info(world)->cmd.batched_group_count;
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_add(world, e[i], Burning);
+    }
+    ecs_defer_end(world);
+
+    test_int(batched_group_invoked, 1);
+    test_int(batched_group_count, 10);
+    test_int(ecs_get_world_info(world)->cmd.batched_group_count, 
+        group_count + 1);
+
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_has(world, e[i], Burning));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batched_group_new_entities() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Burning);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Burning }},
+        .events = { EcsOnAdd },
+        .callback = BatchedGroupOnAdd
+    });
+
+    batched_group_invoked = 0;
+    batched_group_count = 0;
+
+    ecs_entity_t e[10];
+    int i;
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_new(world, Burning);
+    }
+    ecs_defer_end(world);
+
+    test_int(batched_group_invoked, 1);
+    test_int(batched_group_count, 10);
+
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_has(world, e[i], Burning));
+    }
+
+    test_int(ecs_count(world, Burning), 10);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batched_group_different_transitions() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Burning);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Burning }},
+        .events = { EcsOnAdd },
+        .callback = BatchedGroupOnAdd
+    });
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+        if (i >= 3) {
+            ecs_set(world, e[i], Velocity, {i, 0});
+        }
+    }
+
+    batched_group_invoked = 0;
+    batched_group_count = 0;
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 6; i ++) {
+        ecs_add(world, e[i], Burning);
+    }
+    ecs_defer_end(world);
+
+    test_int(batched_group_invoked, 2);
+    test_int(batched_group_count, 6);
+
+    for (i = 0; i < 6; i ++) {
+        test_assert(ecs_has(world, e[i], Burning));
+        test_int(ecs_get(world, e[i], Position)->x, i);
+        if (i >= 3) {
+            test_int(ecs_get(world, e[i], Velocity)->x, i);
+        } else {
+            test_assert(!ecs_has(world, e[i], Velocity));
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batched_group_interleaved_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Burning);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Burning }},
+        .events = { EcsOnAdd },
+        .callback = BatchedGroupOnAdd
+    });
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    batched_group_invoked = 0;
+    batched_group_count = 0;
+
+    ecs_defer_begin(world);
+    ecs_add(world, e[0], Burning);
+    ecs_add(world, e[1], Burning);
+    ecs_set(world, e[1], Position, {10, 0});
+    ecs_add(world, e[2], Burning);
+    ecs_add(world, e[3], Burning);
+    ecs_defer_end(world);
+
+    test_int(batched_group_invoked, 3);
+    test_int(batched_group_count, 4);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(ecs_has(world, e[i], Burning));
+    }
+
+    test_int(ecs_get(world, e[0], Position)->x, 0);
+    test_int(ecs_get(world, e[1], Position)->x, 10);
+    test_int(ecs_get(world, e[2], Position)->x, 2);
+    test_int(ecs_get(world, e[3], Position)->x, 3);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batched_group_w_isa() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Position, {10, 20});
+    ecs_override(world, base, Position);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_new_id(world);
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 4; i ++) {
+        ecs_add_pair(world, e[i], EcsIsA, base);
+    }
+    ecs_defer_end(world);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(ecs_has_pair(world, e[i], EcsIsA, base));
+        test_assert(ecs_owns(world, e[i], Position));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batched_group_w_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Burning);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Burning }},
+        .events = { EcsOnAdd },
+        .callback = BatchedGroupOnAdd
+    });
+
+    ecs_entity_t e[3];
+    int i;
+    for (i = 0; i < 3; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    batched_group_invoked = 0;
+    batched_group_count = 0;
+
+    ecs_defer_begin(world);
+    ecs_add(world, e[0], Burning);
+    ecs_add(world, e[1], Burning);
+    ecs_remove(world, e[1], Position);
+    ecs_add(world, e[2], Burning);
+    ecs_defer_end(world);
+
+    test_int(batched_group_invoked, 3);
+    test_int(batched_group_count, 3);
+
+    for (i = 0; i < 3; i ++) {
+        test_assert(ecs_has(world, e[i], Burning));
+    }
+
+    test_assert(ecs_has(world, e[0], Position));
+    test_assert(!ecs_has(world, e[1], Position));
+    test_assert(ecs_has(world, e[2], Position));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_emplace_batched() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new(world, Tag);
+
+    int64_t batched = ecs_get_world_info(world)->cmd.batched_command_count;
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Velocity, {1, 2});
+    Position *p = ecs_emplace(world, e, Position);
+    p->x = 10;
+    p->y = 20;
+    ecs_defer_end(world);
+
+    test_int(ecs_get_world_info(world)->cmd.batched_command_count, 
+        batched + 2);
+
+    test_assert(ecs_has(world, e, Tag));
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr != NULL);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+static int emplace_batched_move_ctor = 0;
+static int emplace_batched_dtor = 0;
+
+static
+void emplace_batched_move_ctor_hook(void *dst, void *src, int32_t count, 
+    const ecs_type_info_t *ti) 
+{
+    emplace_batched_move_ctor += count;
+    ecs_os_memcpy(dst, src, ti->size * count);
+}
+
+static
+void emplace_batched_dtor_hook(void *ptr, int32_t count, 
+    const ecs_type_info_t *ti) 
+{
+    (void)ptr;
+    (void)ti;
+    emplace_batched_dtor += count;
+}
+
+void DeferredActions_defer_emplace_batched_w_move_ctor() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_hooks(world, Position, {
+        .move_ctor = emplace_batched_move_ctor_hook,
+        .dtor = emplace_batched_dtor_hook
+    });
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Velocity);
+    Position *p = ecs_emplace(world, e, Position);
+    p->x = 10;
+    p->y = 20;
+    ecs_defer_end(world);
+
+    test_int(emplace_batched_move_ctor, 1);
+    test_int(emplace_batched_dtor, 0);
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr != NULL);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+    test_assert(ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+
+    test_int(emplace_batched_dtor, 1);
+}
+
+typedef struct HugeComponent {
+    char data[8192];
+} HugeComponent;
+
+void DeferredActions_defer_emplace_batched_large() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, HugeComponent);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Tag);
+    HugeComponent *p = ecs_emplace(world, e, HugeComponent);
+    ecs_os_memset(p->data, 1, ECS_SIZEOF(p->data));
+    p->data[8191] = 2;
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Tag));
+    const HugeComponent *ptr = ecs_get(world, e, HugeComponent);
+    test_assert(ptr != NULL);
+    test_int(ptr->data[0], 1);
+    test_int(ptr->data[4096], 1);
+    test_int(ptr->data[8191], 2);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_emplace_batched_then_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new(world, Tag);
+
+    ecs_defer_begin(world);
+    Position *p = ecs_emplace(world, e, Position);
+    p->x = 10;
+    p->y = 20;
+    ecs_remove(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Tag));
+    test_assert(ecs_has(world, e, Position));
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr != NULL);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_consecutive_rows() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {0, 0});
+        ecs_set(world, e[i], Velocity, {0, 0});
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, e[i], Position, {i, i * 2});
+    }
+    for (i = 9; i >= 0; i --) {
+        ecs_set(world, e[i], Velocity, {i, i * 3});
+    }
+    ecs_set(world, e[5], Position, {50, 60});
+    ecs_defer_end(world);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        if (i == 5) {
+            test_int(p->x, 50);
+            test_int(p->y, 60);
+        } else {
+            test_int(p->x, i);
+            test_int(p->y, i * 2);
+        }
+
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i);
+        test_int(v->y, i * 3);
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_parallel_merge_set_new_component_move_row() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {0, 0});
+
+    /* Adding Velocity to e1 moves e2 to the row of e1 before the value of e2
+     * is written */
+    ecs_defer_begin(world);
+    ecs_set(world, e2, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(!ecs_has(world, e2, Velocity));
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 0);
+    test_int(p->y, 0);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    const Velocity *v = ecs_get(world, e1, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t parallel_merge_on_add_src = 0;
+static ecs_entity_t parallel_merge_on_add_position = 0;
+static int parallel_merge_on_add_x = 0;
+
+static
+void ParallelMergeOnAdd(ecs_iter_t *it) {
+    const Position *p = ecs_get_id(it->world, parallel_merge_on_add_src, 
+        parallel_merge_on_add_position);
+    test_assert(p != NULL);
+    parallel_merge_on_add_x = (int)p->x;
+}
+
+void DeferredActions_parallel_merge_set_new_component_w_on_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }},
+        .events = { EcsOnAdd },
+        .callback = ParallelMergeOnAdd
+    });
+
+    ecs_set_parallel_merge(world, true);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {0, 0});
+    parallel_merge_on_add_src = e1;
+    parallel_merge_on_add_position = ecs_id(Position);
+
+    /* Observer must see the value of e1 written by the earlier command */
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_int(parallel_merge_on_add_x, 10);
+
+    const Velocity *v = ecs_get(world, e2, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
@@ -1389,3 +1389,51 @@ void EnabledComponents_sort() {
 
     ecs_fini(world);
 }
+
+void EnabledComponents_query_runs_across_blocks_3_bitsets() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e[1000];
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        e[i] = ecs_new(world, Position);
+        ecs_add(world, e[i], Velocity);
+        ecs_add(world, e[i], Mass);
+        ecs_enable_component(world, e[i], Position, true);
+        ecs_enable_component(world, e[i], Velocity, true);
+        ecs_enable_component(world, e[i], Mass, true);
+    }
+
+    /* Each bitset has one disabled element, which splits the table in runs
+     * that span multiple blocks of 64 elements */
+    ecs_enable_component(world, e[100], Position, false);
+    ecs_enable_component(world, e[400], Velocity, false);
+    ecs_enable_component(world, e[700], Mass, false);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity, Mass");
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 100);
+    test_uint(it.entities[0], e[0]);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 299);
+    test_uint(it.entities[0], e[101]);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 299);
+    test_uint(it.entities[0], e[401]);
+
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 299);
+    test_uint(it.entities[0], e[701]);
+
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
@@ -10097,3 +10097,148 @@ void Filter_filter_w_short_notation() {
 
     ecs_fini(world);
 }
+
+void Filter_filter_iter_2_or_chains_and_not() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagD);
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL != ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .expr = "TagA || TagB, Foo, TagC || TagD, !Bar"
+    }));
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_add(world, e1, Foo);
+    ecs_add(world, e1, TagC);
+
+    ecs_entity_t e2 = ecs_new(world, TagB);
+    ecs_add(world, e2, Foo);
+    ecs_add(world, e2, TagD);
+
+    ecs_entity_t e3 = ecs_new(world, TagA);
+    ecs_add(world, e3, Foo);
+
+    ecs_entity_t e4 = ecs_new(world, TagC);
+    ecs_add(world, e4, Foo);
+
+    ecs_entity_t e5 = ecs_new(world, TagA);
+    ecs_add(world, e5, Foo);
+    ecs_add(world, e5, TagC);
+    ecs_add(world, e5, Bar);
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(TagA, ecs_field_id(&it, 1));
+    test_uint(Foo, ecs_field_id(&it, 2));
+    test_uint(TagC, ecs_field_id(&it, 3));
+    test_uint(Bar, ecs_field_id(&it, 4));
+
+    test_bool(true, ecs_filter_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_uint(TagB, ecs_field_id(&it, 1));
+    test_uint(Foo, ecs_field_id(&it, 2));
+    test_uint(TagD, ecs_field_id(&it, 3));
+    test_uint(Bar, ecs_field_id(&it, 4));
+
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_iter_after_plan_tables_created() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL != ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ TagA }, { TagB }, { TagC }}
+    }));
+
+    ecs_entity_t e1 = ecs_new(world, TagA);
+    ecs_add(world, e1, TagB);
+    ecs_add(world, e1, TagC);
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_bool(false, ecs_filter_next(&it));
+
+    /* Create tables that change which terms are most selective */
+    int i;
+    for (i = 0; i < 8; i ++) {
+        ecs_entity_t e = ecs_new(world, TagB);
+        ecs_add_id(world, e, ecs_new_id(world));
+        ecs_add(world, e, TagA);
+    }
+
+    ecs_entity_t e2 = ecs_new(world, TagC);
+    ecs_add(world, e2, TagA);
+    ecs_add(world, e2, TagB);
+
+    it = ecs_filter_iter(world, &f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(2, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(e2, it.entities[1]);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_chain_page_iter() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_add_id(world, e_1, TagB);
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add_id(world, e_2, TagB);
+    ecs_entity_t e_3 = ecs_new(world, TagA);
+    ecs_add_id(world, e_3, TagB);
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL != ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ TagB }}
+    }));
+
+    /* Chained filter returns the whole table, not just the page */
+    ecs_iter_t child_it = ecs_term_iter(world, &(ecs_term_t) { TagA });
+    ecs_iter_t page_it = ecs_page_iter(&child_it, 1, 1);
+    ecs_iter_t it = ecs_filter_chain_iter(&page_it, &f);
+    test_int(it.field_count, 1);
+
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 3);
+    test_int(it.entities[0], e_1);
+    test_int(it.entities[1], e_2);
+    test_int(it.entities[2], e_3);
+    test_int(ecs_field_id(&it, 1), TagB);
+
+    test_assert(!ecs_filter_next(&it));
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
@@ -515,3 +515,51 @@ void Internals_table_create_leak_check() {
 
     ecs_fini(world);
 }
+
+static
+void test_column_alignment(
+    ecs_size_t size,
+    ecs_size_t alignment)
+{
+    ecs_world_t *world = ecs_mini();
+
+    ecs_entity_t c = ecs_component_init(world, &(ecs_component_desc_t){
+        .type.size = size,
+        .type.alignment = alignment
+    });
+
+    /* Create entities one by one so column is reallocated multiple times */
+    ecs_entity_t e = 0;
+    int i;
+    for (i = 0; i < 100; i ++) {
+        e = ecs_new_w_id(world, c);
+        const void *ptr = ecs_get_id(world, e, c);
+        test_assert(ptr != NULL);
+        test_int((uintptr_t)ptr % (uintptr_t)alignment, 0);
+    }
+
+    ecs_filter_t *f = ecs_filter(world, { .terms = {{ c }} });
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 100);
+    const void *ptr = ecs_field_w_size(&it, (size_t)size, 1);
+    test_assert(ptr != NULL);
+    test_int((uintptr_t)ptr % (uintptr_t)alignment, 0);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Internals_column_alignment_32() {
+    test_column_alignment(32, 32);
+}
+
+void Internals_column_alignment_64() {
+    test_column_alignment(64, 64);
+}
+
+void Internals_column_alignment_192_64() {
+    test_column_alignment(192, 64);
+}
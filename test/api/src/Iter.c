@@ -1944,3 +1944,225 @@ void Iter_worker_iter_w_binding_ctx() {
 
     ecs_fini(world);
 }
+
+void Iter_worker_chunk_iter() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Self);
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_new_id(world);
+        ecs_set(world, e[i], Self, {e[i]});
+    }
+
+    ecs_add(world, e[4], TagA);
+    ecs_add(world, e[5], TagA);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Self) }}
+    });
+
+    ecs_worker_cursor_t cursor = {0};
+    ecs_iter_t it_1 = ecs_query_iter(world, q);
+    ecs_iter_t wit_1 = ecs_worker_chunk_iter(&it_1, 0, 2, 3, &cursor);
+    ecs_iter_t it_2 = ecs_query_iter(world, q);
+    ecs_iter_t wit_2 = ecs_worker_chunk_iter(&it_2, 1, 2, 3, &cursor);
+
+    /* First chunk of first table */
+    test_bool(ecs_worker_next(&wit_1), true);
+    test_int(wit_1.count, 3);
+    test_int(wit_1.entities[0], e[0]);
+    test_int(wit_1.entities[1], e[1]);
+    test_int(wit_1.entities[2], e[2]);
+    Self *ptr = ecs_field(&wit_1, Self, 1);
+    test_int(ptr[0].value, e[0]);
+    test_int(ptr[2].value, e[2]);
+
+    /* Remainder of first table */
+    test_bool(ecs_worker_next(&wit_2), true);
+    test_int(wit_2.count, 1);
+    test_int(wit_2.entities[0], e[3]);
+    ptr = ecs_field(&wit_2, Self, 1);
+    test_int(ptr[0].value, e[3]);
+
+    /* Worker 1 takes over the second table */
+    test_bool(ecs_worker_next(&wit_1), true);
+    test_int(wit_1.count, 2);
+    test_int(wit_1.entities[0], e[4]);
+    test_int(wit_1.entities[1], e[5]);
+    ptr = ecs_field(&wit_1, Self, 1);
+    test_int(ptr[0].value, e[4]);
+    test_int(ptr[1].value, e[5]);
+
+    test_bool(ecs_worker_next(&wit_2), false);
+    test_bool(ecs_worker_next(&wit_1), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_worker_chunk_iter_skewed_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Self);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    /* One large table and two small tables */
+    ecs_entity_t e[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        e[i] = ecs_new_id(world);
+        ecs_set(world, e[i], Self, {e[i]});
+        if (i >= 90) {
+            ecs_add(world, e[i], TagA);
+        }
+        if (i >= 95) {
+            ecs_add(world, e[i], TagB);
+        }
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Self) }}
+    });
+
+    ecs_worker_cursor_t cursor = {0};
+    ecs_iter_t it[3], wit[3];
+    for (i = 0; i < 3; i ++) {
+        it[i] = ecs_query_iter(world, q);
+        wit[i] = ecs_worker_chunk_iter(&it[i], i, 3, 16, &cursor);
+    }
+
+    int32_t count[3] = {0}, total = 0;
+    bool active[3] = {true, true, true};
+    int32_t active_count = 3;
+
+    /* Round robin between workers, every entity must be visited once */
+    while (active_count) {
+        for (i = 0; i < 3; i ++) {
+            if (!active[i]) {
+                continue;
+            }
+
+            if (!ecs_worker_next(&wit[i])) {
+                active[i] = false;
+                active_count --;
+                continue;
+            }
+
+            test_assert(wit[i].count <= 16);
+
+            Self *ptr = ecs_field(&wit[i], Self, 1);
+            int j;
+            for (j = 0; j < wit[i].count; j ++) {
+                test_int(ptr[j].value, wit[i].entities[j]);
+            }
+
+            count[i] += wit[i].count;
+            total += wit[i].count;
+        }
+    }
+
+    test_int(total, 100);
+    test_assert(count[0] != 0);
+    test_assert(count[1] != 0);
+    test_assert(count[2] != 0);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_worker_chunk_iter_reset_cursor() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_new(world, TagA);
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ TagA }}
+    });
+
+    ecs_worker_cursor_t cursor = {0};
+
+    int iteration;
+    for (iteration = 0; iteration < 2; iteration ++) {
+        ecs_iter_t it_1 = ecs_query_iter(world, q);
+        ecs_iter_t wit_1 = ecs_worker_chunk_iter(&it_1, 0, 2, 4, &cursor);
+        ecs_iter_t it_2 = ecs_query_iter(world, q);
+        ecs_iter_t wit_2 = ecs_worker_chunk_iter(&it_2, 1, 2, 4, &cursor);
+
+        int32_t total = 0;
+        while (ecs_worker_next(&wit_1)) {
+            total += wit_1.count;
+        }
+        test_int(total, 10);
+
+        test_bool(ecs_worker_next(&wit_2), false);
+
+        /* All workers are done, cursor can be reused */
+        test_bool(cursor.started, false);
+    }
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_worker_chunk_iter_fini_early() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_new(world, TagA);
+    }
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ TagA }}
+    });
+
+    ecs_worker_cursor_t cursor = {0};
+
+    ecs_iter_t it_1 = ecs_query_iter(world, q);
+    ecs_iter_t wit_1 = ecs_worker_chunk_iter(&it_1, 0, 2, 4, &cursor);
+    ecs_iter_t it_2 = ecs_query_iter(world, q);
+    ecs_iter_t wit_2 = ecs_worker_chunk_iter(&it_2, 1, 2, 4, &cursor);
+
+    /* First worker stops after its first chunk */
+    test_bool(ecs_worker_next(&wit_1), true);
+    test_int(wit_1.count, 4);
+    ecs_iter_fini(&wit_1);
+
+    int32_t total = 0;
+    while (ecs_worker_next(&wit_2)) {
+        total += wit_2.count;
+    }
+    test_int(total, 6);
+
+    /* Next iteration starts from the first table again */
+    it_1 = ecs_query_iter(world, q);
+    wit_1 = ecs_worker_chunk_iter(&it_1, 0, 2, 4, &cursor);
+    it_2 = ecs_query_iter(world, q);
+    wit_2 = ecs_worker_chunk_iter(&it_2, 1, 2, 4, &cursor);
+
+    total = 0;
+    while (ecs_worker_next(&wit_2)) {
+        total += wit_2.count;
+    }
+    test_int(total, 10);
+    test_bool(ecs_worker_next(&wit_1), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
@@ -3803,3 +3803,352 @@ void Observer_cache_test_9() {
 
     ecs_fini(world);
 }
+
+typedef struct {
+    int32_t invoked;
+    int32_t count;
+    int32_t max_count;
+    int32_t shared;
+} BatchCtx;
+
+static
+void Observer_batch(ecs_iter_t *it) {
+    BatchCtx *ctx = it->ctx;
+    ctx->invoked ++;
+    ctx->count += it->count;
+    if (it->count > ctx->max_count) {
+        ctx->max_count = it->count;
+    }
+    int32_t i;
+    for (i = 1; i <= it->field_count; i ++) {
+        if (ecs_field_src(it, i) != 0) {
+            ctx->shared ++;
+        }
+    }
+}
+
+void Observer_batched_bulk_new() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnAdd },
+        .batched = true,
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_bulk_new(world, Position, 1000);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1000);
+    test_int(ctx.max_count, 1000);
+
+    ecs_fini(world);
+}
+
+void Observer_batched_bulk_init_w_data() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .batched = true,
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    Position p[100] = {0};
+    const ecs_entity_t *entities = ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 100,
+        .ids = { ecs_id(Position) },
+        .data = (void*[]){ p }
+    });
+    test_assert(entities != NULL);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+    test_int(ctx.max_count, 100);
+
+    ecs_fini(world);
+}
+
+void Observer_batched_multi_bulk_new() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }},
+        .events = { EcsOnAdd },
+        .batched = true,
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t type = ecs_new_w_id(world, EcsPrefab);
+    ecs_add(world, type, Position);
+    ecs_add(world, type, Velocity);
+
+    ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 1000,
+        .ids = { ecs_id(Position), ecs_id(Velocity) }
+    });
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1000);
+    test_int(ctx.max_count, 1000);
+
+    ecs_fini(world);
+}
+
+void Observer_batched_shared_component() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }, { ecs_id(Position) }},
+        .events = { EcsOnAdd },
+        .batched = true,
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Velocity, {1, 2});
+
+    ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 100,
+        .ids = { ecs_id(Position), ecs_pair(EcsIsA, base) }
+    });
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+    test_int(ctx.max_count, 100);
+    test_int(ctx.shared, 1);
+
+    ecs_fini(world);
+}
+
+void Observer_not_batched_shared_component() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }, { ecs_id(Position) }},
+        .events = { EcsOnAdd },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Velocity, {1, 2});
+
+    ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 100,
+        .ids = { ecs_id(Position), ecs_pair(EcsIsA, base) }
+    });
+    test_int(ctx.invoked, 100);
+    test_int(ctx.count, 100);
+    test_int(ctx.max_count, 1);
+
+    ecs_fini(world);
+}
+
+void Observer_multi_cached_match() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {
+            { ecs_id(Position) }, 
+            { ecs_id(Velocity) }, 
+            { Tag, .oper = EcsNot }
+        },
+        .events = { EcsOnAdd },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Velocity);
+        ecs_add(world, e, Position);
+    }
+    test_int(ctx.invoked, 100);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Velocity);
+        ecs_add(world, e, Tag);
+        ecs_add(world, e, Position);
+    }
+    test_int(ctx.invoked, 100);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add(world, e, Velocity);
+    }
+    test_int(ctx.invoked, 200);
+    test_int(ctx.count, 200);
+
+    ecs_fini(world);
+}
+
+void Observer_multi_cached_match_w_not_event() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {
+            { ecs_id(Position) }, 
+            { Tag, .oper = EcsNot }
+        },
+        .events = { EcsOnAdd },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        test_int(ctx.invoked, i * 2 + 1);
+        ecs_add(world, e, Tag);
+        ecs_remove(world, e, Tag);
+        test_int(ctx.invoked, i * 2 + 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Observer_multi_cached_match_after_table_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {
+            { ecs_id(Position) }, 
+            { ecs_id(Velocity) }, 
+            { TagA, .oper = EcsNot }
+        },
+        .events = { EcsOnAdd },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t e = ecs_new(world, Velocity);
+    ecs_add(world, e, TagB);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 1);
+    ecs_delete(world, e);
+
+    /* Delete tables, so that new tables can reuse their storage */
+    ecs_delete_empty_tables(world, 0, 0, 1, 0, 0);
+    test_assert(ecs_delete_empty_tables(world, 0, 0, 1, 0, 0) != 0);
+
+    e = ecs_new(world, Velocity);
+    ecs_add(world, e, TagA);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 1);
+
+    e = ecs_new(world, Velocity);
+    ecs_add(world, e, TagB);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 2);
+
+    ecs_fini(world);
+}
+
+void Observer_multi_cached_match_w_isa() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }},
+        .events = { EcsOnAdd },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Velocity, {1, 2});
+
+    ecs_entity_t e = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 1);
+
+    /* Match depends on base, so result for table can't be reused */
+    ecs_remove(world, base, Velocity);
+
+    e = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 1);
+
+    /* Existing instances now match through base */
+    ecs_set(world, base, Velocity, {1, 2});
+    test_int(ctx.invoked, 2);
+
+    e = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_add(world, e, Position);
+    test_int(ctx.invoked, 3);
+
+    ecs_fini(world);
+}
+
+void Observer_multi_cached_match_monitor() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    BatchCtx ctx = {0};
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }},
+        .events = { EcsMonitor },
+        .callback = Observer_batch,
+        .ctx = &ctx
+    });
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add(world, e, Velocity);
+        test_int(ctx.invoked, i * 2 + 1);
+
+        /* Already matched, monitor doesn't trigger */
+        ecs_add(world, e, Tag);
+        test_int(ctx.invoked, i * 2 + 1);
+
+        ecs_remove(world, e, Position);
+        test_int(ctx.invoked, i * 2 + 2);
+    }
+
+    ecs_fini(world);
+}
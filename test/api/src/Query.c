@@ -8159,3 +8159,657 @@ void Query_query_next_table_w_populate_skip_last() {
 
     ecs_fini(world);
 }
+
+void Query_iter_after_empty_and_rematch_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_add(world, e2, TagA);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, TagB);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Empty the table in the middle of the list */
+    ecs_delete(world, e2);
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Empty all tables */
+    ecs_delete(world, e1);
+    ecs_delete(world, e3);
+
+    it = ecs_query_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Make table non-empty again */
+    ecs_entity_t e4 = ecs_new(world, Position);
+    ecs_add(world, e4, TagA);
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e4);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+static
+int32_t changed_only_count(
+    ecs_world_t *world,
+    ecs_query_t *q,
+    int32_t *result_count)
+{
+    int32_t count = 0, results = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        count += it.count;
+        results ++;
+    }
+    if (result_count) {
+        *result_count = results;
+    }
+    return count;
+}
+
+void Query_changed_only_first_iter() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 200; i ++) {
+        ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 200);
+    test_int(changed_only_count(world, q, NULL), 0);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_modified_one() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[200];
+    for (int i = 0; i < 200; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 200);
+
+    ecs_set(world, e[150], Position, {10, 20});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.offset, 128);
+    test_int(it.count, 64);
+    Position *p = ecs_field(&it, Position, 1);
+    test_uint(it.entities[150 - 128], e[150]);
+    test_int(p[150 - 128].x, 10);
+    test_int(p[150 - 128].y, 20);
+    test_bool(false, ecs_query_next(&it));
+
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_modified_two_blocks() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[300];
+    for (int i = 0; i < 300; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 300);
+
+    ecs_set(world, e[10], Position, {10, 20});
+    ecs_set(world, e[290], Position, {10, 20});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.offset, 0);
+    test_int(it.count, 64);
+    test_uint(it.entities[10], e[10]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.offset, 256);
+    test_int(it.count, 44);
+    test_uint(it.entities[290 - 256], e[290]);
+    test_bool(false, ecs_query_next(&it));
+
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_after_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    for (int i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 100);
+
+    /* Adding rows invalidates the entire table */
+    ecs_set(world, 0, Position, {0, 0});
+    test_int(changed_only_count(world, q, NULL), 101);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    /* New table is returned in its entirety */
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e, Tag);
+    test_int(changed_only_count(world, q, NULL), 102);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_out_term() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    for (int i = 0; i < 200; i ++) {
+        ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    ecs_query_t *q_write = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsOut }},
+        .changed_only = true
+    });
+    test_assert(q_write != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 200);
+
+    /* Writing query returns all rows the first time, which marks them dirty */
+    test_int(changed_only_count(world, q_write, NULL), 200);
+    test_int(changed_only_count(world, q, NULL), 200);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    /* Writing query doesn't read Position, so doesn't return rows again */
+    test_int(changed_only_count(world, q_write, NULL), 0);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_next_batch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {70, 80});
+    ecs_add(world, e2, TagA);
+    ecs_add(world, e3, TagB);
+    ecs_add(world, e4, TagA);
+    ecs_add(world, e4, TagB);
+    ecs_set(world, 0, Velocity, {1, 2});
+
+    ecs_query_t *q = ecs_query_new(world, "Position, ?Velocity");
+    test_assert(q != NULL);
+
+    ecs_query_batch_t batch[3];
+    void *ptrs[3 * 2];
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_int(3, ecs_query_next_batch(&it, batch, ptrs, 3));
+    test_assert(batch[0].table == ecs_get_table(world, e1));
+    test_int(batch[0].offset, 0);
+    test_int(batch[0].count, 1);
+    test_uint(batch[0].entities[0], e1);
+    test_assert(batch[0].ptrs == &ptrs[0]);
+    test_assert(batch[0].ptrs[0] == ecs_get(world, e1, Position));
+    test_assert(batch[0].ptrs[1] == NULL);
+    test_uint(batch[0].sources[0], 0);
+
+    test_assert(batch[1].table == ecs_get_table(world, e2));
+    test_int(batch[1].count, 1);
+    test_uint(batch[1].entities[0], e2);
+    test_assert(batch[1].ptrs == &ptrs[2]);
+    test_assert(batch[1].ptrs[0] == ecs_get(world, e2, Position));
+
+    test_assert(batch[2].table == ecs_get_table(world, e3));
+    test_int(batch[2].count, 1);
+    test_uint(batch[2].entities[0], e3);
+    test_assert(batch[2].ptrs[0] == ecs_get(world, e3, Position));
+
+    test_int(1, ecs_query_next_batch(&it, batch, ptrs, 3));
+    test_assert(batch[0].table == ecs_get_table(world, e4));
+    test_int(batch[0].count, 1);
+    test_uint(batch[0].entities[0], e4);
+    Position *p = batch[0].ptrs[0];
+    test_int(p->x, 70);
+    test_int(p->y, 80);
+
+    test_int(0, ecs_query_next_batch(&it, batch, ptrs, 3));
+
+    ecs_fini(world);
+}
+
+void Query_next_batch_w_shared() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add_pair(world, e1, EcsIsA, base);
+    ecs_add_pair(world, e2, EcsIsA, base);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    ecs_query_batch_t batch[2];
+    void *ptrs[2 * 2];
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_int(1, ecs_query_next_batch(&it, batch, ptrs, 2));
+    test_int(batch[0].count, 2);
+    test_uint(batch[0].entities[0], e1);
+    test_uint(batch[0].entities[1], e2);
+    test_uint(batch[0].sources[0], 0);
+    test_uint(batch[0].sources[1], base);
+
+    Position *p = batch[0].ptrs[0];
+    test_int(p[0].x, 10);
+    test_int(p[1].x, 30);
+    test_assert(batch[0].ptrs[1] == ecs_get(world, base, Velocity));
+
+    test_int(0, ecs_query_next_batch(&it, batch, ptrs, 2));
+
+    ecs_fini(world);
+}
+
+void Query_next_batch_w_toggle() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_enable_component(world, e1, Position, true);
+    ecs_enable_component(world, e2, Position, false);
+    ecs_enable_component(world, e3, Position, true);
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {70, 80});
+    ecs_add(world, e4, Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    ecs_query_batch_t batch[4];
+    void *ptrs[4];
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_int(3, ecs_query_next_batch(&it, batch, ptrs, 4));
+    test_int(batch[0].offset, 0);
+    test_int(batch[0].count, 1);
+    test_uint(batch[0].entities[0], e1);
+    test_assert(batch[0].ptrs[0] == ecs_get(world, e1, Position));
+    test_int(batch[1].offset, 2);
+    test_int(batch[1].count, 1);
+    test_uint(batch[1].entities[0], e3);
+    test_assert(batch[1].ptrs[0] == ecs_get(world, e3, Position));
+    test_int(batch[2].count, 1);
+    test_uint(batch[2].entities[0], e4);
+    test_assert(batch[2].ptrs[0] == ecs_get(world, e4, Position));
+
+    test_int(0, ecs_query_next_batch(&it, batch, ptrs, 4));
+
+    ecs_fini(world);
+}
+
+void Query_next_batch_mark_dirty() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e2, Tag);
+
+    ecs_query_t *q_read = ecs_query_new(world, "[in] Position");
+    test_assert(q_read != NULL);
+    ecs_query_t *q_write = ecs_query_new(world, "[out] Position");
+    test_assert(q_write != NULL);
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    ecs_iter_t it = ecs_query_iter(world, q_read);
+    while (ecs_query_next(&it)) { }
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    ecs_query_batch_t batch[4];
+    void *ptrs[4];
+
+    it = ecs_query_iter(world, q_write);
+    test_int(2, ecs_query_next_batch(&it, batch, ptrs, 4));
+    test_int(0, ecs_query_next_batch(&it, batch, ptrs, 4));
+
+    test_bool(true, ecs_query_changed(q_read, NULL));
+    it = ecs_query_iter(world, q_read);
+    test_int(2, ecs_query_next_batch(&it, batch, ptrs, 4));
+    test_int(0, ecs_query_next_batch(&it, batch, ptrs, 4));
+    test_bool(false, ecs_query_changed(q_read, NULL));
+
+    ecs_fini(world);
+}
+
+void Query_nested_iter_w_new_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, 0, Position, {10, 20});
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    int32_t i, outer_count = 0, inner_count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        outer_count ++;
+
+        /* Grow the set of matched tables while the outer iterator is alive */
+        for (i = 0; i < 32; i ++) {
+            ecs_entity_t e = ecs_new_w_id(world, ecs_new_id(world));
+            ecs_set(world, e, Position, {30, 40});
+        }
+
+        ecs_iter_t nested = ecs_query_iter(world, q);
+        while (ecs_query_next(&nested)) {
+            inner_count ++;
+        }
+    }
+
+    test_int(outer_count, 1);
+    test_int(inner_count, 33);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_toggle() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[5];
+    for (int i = 0; i < 5; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+        ecs_enable_component(world, e[i], Position, true);
+    }
+    ecs_enable_component(world, e[1], Position, false);
+    ecs_enable_component(world, e[3], Position, false);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    int32_t results = 0;
+    test_int(changed_only_count(world, q, &results), 3);
+    test_int(results, 3);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    /* All enabled ranges of the changed table are returned */
+    ecs_set(world, e[4], Position, {10, 20});
+    test_int(changed_only_count(world, q, &results), 3);
+    test_int(results, 3);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_union() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_ENTITY(world, Movement, Union);
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+
+    ecs_entity_t e[3];
+    for (int i = 0; i < 3; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+        ecs_add_pair(world, e[i], Movement, Walking);
+    }
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {3, 0});
+    ecs_add_pair(world, e4, Movement, Running);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {
+            { ecs_id(Position), .inout = EcsIn },
+            { ecs_pair(Movement, Walking) }
+        },
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    int32_t results = 0;
+    test_int(changed_only_count(world, q, &results), 3);
+    test_int(results, 3);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    /* All entities with the union target of the changed table are returned */
+    ecs_set(world, e[0], Position, {10, 20});
+    test_int(changed_only_count(world, q, &results), 3);
+    test_int(results, 3);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_get_mut() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[200];
+    for (int i = 0; i < 200; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 200);
+
+    Position *p = ecs_get_mut(world, e[150], Position);
+    test_assert(p != NULL);
+    p->x = 10;
+
+    /* ecs_get_mut doesn't mark the row dirty until ecs_modified is called */
+    test_int(changed_only_count(world, q, NULL), 0);
+    ecs_modified(world, e[150], Position);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.offset, 128);
+    test_int(it.count, 64);
+    p = ecs_field(&it, Position, 1);
+    test_uint(it.entities[150 - 128], e[150]);
+    test_int(p[150 - 128].x, 10);
+    test_bool(false, ecs_query_next(&it));
+
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_only_write_after_grow() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[300];
+    for (int i = 0; i < 100; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsIn }},
+        .changed_only = true
+    });
+    test_assert(q != NULL);
+
+    ecs_query_t *q_write = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position), .inout = EcsInOut }}
+    });
+    test_assert(q_write != NULL);
+
+    test_int(changed_only_count(world, q, NULL), 100);
+
+    /* Adding rows creates the blocks for the new rows, so that iterating
+     * marks them dirty without growing the blocks */
+    for (int i = 100; i < 300; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+    test_int(changed_only_count(world, q, NULL), 300);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_iter_t it = ecs_query_iter(world, q_write);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 300);
+    test_uint(it.entities[299], e[299]);
+    test_bool(false, ecs_query_next(&it));
+
+    test_int(changed_only_count(world, q, NULL), 300);
+    test_int(changed_only_count(world, q, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void Query_iter_while_table_array_changes() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    /* Tables that become non-empty while the iterator is alive don't modify
+     * the array that is being iterated */
+    ecs_iter_t it_1 = ecs_query_iter(world, q);
+    ecs_entity_t e2 = ecs_new(world, TagA);
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_entity_t e3 = ecs_new(world, TagB);
+    ecs_set(world, e3, Position, {50, 60});
+
+    ecs_iter_t it_2 = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it_2));
+    test_int(it_2.count, 1);
+    test_uint(it_2.entities[0], e1);
+
+    test_bool(true, ecs_query_next(&it_1));
+    test_int(it_1.count, 1);
+    test_uint(it_1.entities[0], e1);
+    test_bool(false, ecs_query_next(&it_1));
+
+    test_bool(true, ecs_query_next(&it_2));
+    test_int(it_2.count, 1);
+    test_uint(it_2.entities[0], e2);
+
+    /* Iterator that is finalized before it's depleted releases the array */
+    ecs_iter_fini(&it_2);
+
+    ecs_delete(world, e2);
+
+    ecs_iter_t it_3 = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it_3));
+    test_int(it_3.count, 1);
+    test_uint(it_3.entities[0], e1);
+    test_bool(true, ecs_query_next(&it_3));
+    test_int(it_3.count, 1);
+    test_uint(it_3.entities[0], e3);
+    const Position *p = ecs_field(&it_3, Position, 1);
+    test_int(p[0].x, 50);
+    test_int(p[0].y, 60);
+    test_bool(false, ecs_query_next(&it_3));
+
+    ecs_fini(world);
+}
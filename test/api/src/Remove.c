@@ -171,3 +171,106 @@ void Remove_not_added() {
 
     ecs_fini(world);
 }
+
+void Remove_bulk_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e1, Velocity);
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e2, Velocity);
+    ecs_add(world, e2, Tag);
+    ecs_entity_t e3 = ecs_new(world, Velocity);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_remove(world, f, Velocity);
+
+    test_assert(!ecs_has(world, e1, Velocity));
+    test_assert(!ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e2, Tag));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 10); test_int(p->y, 20);
+    p = ecs_get(world, e2, Position);
+    test_int(p->x, 30); test_int(p->y, 40);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Remove_bulk_remove_last() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_remove(world, f, Position);
+
+    test_assert(ecs_is_alive(world, e1));
+    test_assert(ecs_is_alive(world, e2));
+    test_assert(!ecs_has(world, e1, Position));
+    test_assert(!ecs_has(world, e2, Position));
+    test_assert(ecs_get_table(world, e1) == NULL);
+    test_assert(ecs_get_table(world, e2) == NULL);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+static int bulk_on_remove_count = 0;
+static int bulk_on_remove_invoked = 0;
+
+static
+void BulkOnRemove(ecs_iter_t *it) {
+    bulk_on_remove_invoked ++;
+    bulk_on_remove_count += it->count;
+}
+
+void Remove_bulk_remove_observer() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Tag }},
+        .events = { EcsOnRemove },
+        .callback = BulkOnRemove
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_add(world, e1, Tag);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_add(world, e2, Tag);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_remove(world, f, Tag);
+
+    test_int(bulk_on_remove_invoked, 1);
+    test_int(bulk_on_remove_count, 2);
+    test_assert(!ecs_has(world, e1, Tag));
+    test_assert(!ecs_has(world, e2, Tag));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
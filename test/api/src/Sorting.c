@@ -80,10 +80,10 @@ void Sorting_sort_by_component_same_value_1() {
     
 
     test_assert(it.entities[0] == e5);
-    test_assert(it.entities[1] == e4);
-    test_assert(it.entities[2] == e3);
-    test_assert(it.entities[3] == e2);
-    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e1);
+    test_assert(it.entities[4] == e2);
 
     test_assert(!ecs_query_next(&it));
 
@@ -113,12 +113,12 @@ void Sorting_sort_by_component_same_value_2() {
     test_assert(ecs_query_next(&it));
 
     test_int(it.count, 6);
-    test_assert(it.entities[0] == e4);
-    test_assert(it.entities[1] == e6);
-    test_assert(it.entities[2] == e2);
-    test_assert(it.entities[3] == e1);
-    test_assert(it.entities[4] == e3);
-    test_assert(it.entities[5] == e5);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e6);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[5] == e3);
 
     test_assert(!ecs_query_next(&it));
 
@@ -1752,3 +1752,132 @@ void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term() {
 
     ecs_fini(world);
 }
+
+void Sorting_sort_1000_entities_change_few() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t start = ecs_new(world, 0);
+
+    for (int i = 0; i < 1000; i ++) {
+        ecs_set(world, i + start, Position, {rand()});
+    }
+
+    for (int k = 0; k < 3; k ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        int32_t x = 0, count = 0;
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_field(&it, Position, 1);
+            count += it.count;
+
+            int32_t j;
+            for (j = 0; j < it.count; j ++) {  
+                test_assert(x <= p[j].x);
+                x = p[j].x;
+            }
+        }
+
+        test_int(count, 1000);
+
+        /* Change a few rows, so that the table is mostly sorted */
+        for (int i = 0; i < 5; i ++) {
+            ecs_set(world, (rand() % 1000) + start, Position, {rand()});
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_entities_16_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t tags[16];
+    for (int i = 0; i < 16; i ++) {
+        tags[i] = ecs_new_id(world);
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    for (int i = 0; i < 800; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {rand()});
+        ecs_add_id(world, e, tags[i % 16]);
+    }
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    int32_t x = 0, count = 0;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        count += it.count;
+
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {  
+            test_assert(x <= p[j].x);
+            x = p[j].x;
+        }
+    }
+
+    test_int(count, 800);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_1000_entities_change_few_w_equal_values() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t start = ecs_new(world, 0);
+
+    /* Groups of 10 entities with the same value, created in sorted order */
+    for (int i = 0; i < 1000; i ++) {
+        ecs_set(world, i + start, Position, {i / 10});
+    }
+
+    for (int k = 0; k < 3; k ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        int32_t x = 0, count = 0;
+        ecs_entity_t prev = 0;
+        while (ecs_query_next(&it)) {
+            Position *p = ecs_field(&it, Position, 1);
+            count += it.count;
+
+            /* Entities with equal values keep their creation order */
+            int32_t j;
+            for (j = 0; j < it.count; j ++) {  
+                test_assert(x <= p[j].x);
+                if (x == p[j].x) {
+                    test_assert(prev < it.entities[j]);
+                }
+                x = p[j].x;
+                prev = it.entities[j];
+            }
+        }
+
+        test_int(count, 1000);
+
+        /* Move the first entity of a group into a later group, so that the
+         * table is mostly sorted */
+        ecs_set(world, k * 10 + start, Position, {50 + k});
+    }
+
+    ecs_fini(world);
+}
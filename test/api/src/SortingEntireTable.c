@@ -79,10 +79,10 @@ void SortingEntireTable_sort_by_component_same_value_1() {
     
 
     test_assert(it.entities[0] == e5);
-    test_assert(it.entities[1] == e4);
-    test_assert(it.entities[2] == e3);
-    test_assert(it.entities[3] == e2);
-    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e1);
+    test_assert(it.entities[4] == e2);
 
     test_assert(!ecs_query_next(&it));
 
@@ -113,12 +113,12 @@ void SortingEntireTable_sort_by_component_same_value_2() {
     test_assert(ecs_query_next(&it));
 
     test_int(it.count, 6);
-    test_assert(it.entities[0] == e4);
-    test_assert(it.entities[1] == e6);
-    test_assert(it.entities[2] == e2);
-    test_assert(it.entities[3] == e1);
-    test_assert(it.entities[4] == e3);
-    test_assert(it.entities[5] == e5);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e6);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[5] == e3);
 
     test_assert(!ecs_query_next(&it));
 
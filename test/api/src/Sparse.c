@@ -0,0 +1,907 @@
+#include <api.h>
+
+static int ctor_invoked = 0;
+static int dtor_invoked = 0;
+
+static ECS_CTOR(Position, ptr, {
+    ptr->x = 10;
+    ptr->y = 20;
+    ctor_invoked ++;
+})
+
+static ECS_DTOR(Position, ptr, {
+    dtor_invoked ++;
+})
+
+void Sparse_add() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, Position);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_get_table(world, e) == NULL);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+
+    ecs_fini(world);
+}
+
+void Sparse_add_twice() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e, Position);
+    test_assert(ecs_has(world, e, Position));
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void Sparse_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    test_assert(ecs_has(world, e, Position));
+
+    ecs_remove(world, e, Position);
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(ecs_get(world, e, Position) == NULL);
+
+    ecs_add(world, e, Position);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_get(world, e, Position) != NULL);
+
+    ecs_fini(world);
+}
+
+void Sparse_remove_not_added() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+
+    ecs_remove(world, e2, Position);
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(!ecs_has(world, e2, Position));
+    test_assert(ecs_has(world, e2, Velocity));
+
+    ecs_fini(world);
+}
+
+void Sparse_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_set(world, e1, Position, {50, 60});
+    p = ecs_get(world, e1, Position);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+
+    ecs_fini(world);
+}
+
+void Sparse_get_mut() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    Position *p = ecs_get_mut(world, e, Position);
+    test_assert(p != NULL);
+    p->x = 10;
+    p->y = 20;
+    ecs_modified(world, e, Position);
+
+    test_assert(ecs_get_mut(world, e, Position) == p);
+    test_assert(ecs_get(world, e, Position) == p);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void Sparse_emplace() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position)
+    });
+
+    ecs_entity_t e = ecs_new_id(world);
+    Position *p = ecs_emplace(world, e, Position);
+    test_assert(p != NULL);
+    test_int(ctor_invoked, 0);
+    p->x = 30;
+    p->y = 40;
+
+    test_assert(ecs_has(world, e, Position));
+    const Position *ptr = ecs_get(world, e, Position);
+    test_int(ptr->x, 30);
+    test_int(ptr->y, 40);
+
+    ecs_fini(world);
+}
+
+void Sparse_has() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(!ecs_has(world, e1, Velocity));
+    test_assert(!ecs_has(world, e2, Position));
+    test_assert(ecs_has(world, e2, Velocity));
+    test_assert(!ecs_has(world, e3, Position));
+
+    ecs_fini(world);
+}
+
+void Sparse_set_no_table_change() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_table_t *table = ecs_get_table(world, e);
+    test_assert(table != NULL);
+
+    ecs_set(world, e, Position, {10, 20});
+    test_assert(ecs_get_table(world, e) == table);
+    test_int(ecs_search(world, table, ecs_id(Position), 0), -1);
+
+    ecs_remove(world, e, Position);
+    test_assert(ecs_get_table(world, e) == table);
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void Sparse_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_delete(world, e);
+    test_assert(!ecs_is_alive(world, e));
+
+    /* Recycled id must not inherit component of deleted entity */
+    ecs_entity_t e2 = ecs_new_id(world);
+    test_assert((uint32_t)e2 == (uint32_t)e);
+    test_assert(!ecs_has(world, e2, Position));
+
+    ecs_fini(world);
+}
+
+void Sparse_clear() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+
+    ecs_clear(world, e);
+    test_assert(ecs_is_alive(world, e));
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void Sparse_delete_parent() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t parent = ecs_new_id(world);
+    ecs_entity_t child = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set(world, child, Position, {10, 20});
+
+    ecs_delete(world, parent);
+    test_assert(!ecs_is_alive(world, child));
+
+    ecs_entity_t e = ecs_new_id(world);
+    test_assert(!ecs_has(world, e, Position));
+    e = ecs_new_id(world);
+    test_assert(!ecs_has(world, e, Position));
+
+    ecs_fini(world);
+}
+
+void Sparse_dtor_on_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position)
+    });
+
+    ecs_entity_t e = ecs_new(world, Position);
+    test_int(ctor_invoked, 1);
+    test_int(dtor_invoked, 0);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_remove(world, e, Position);
+    test_int(ctor_invoked, 1);
+    test_int(dtor_invoked, 1);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 1);
+}
+
+void Sparse_dtor_on_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position)
+    });
+
+    ecs_entity_t e = ecs_new(world, Position);
+    test_int(dtor_invoked, 0);
+
+    ecs_delete(world, e);
+    test_int(dtor_invoked, 1);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 1);
+}
+
+void Sparse_dtor_on_fini() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position)
+    });
+
+    ecs_new(world, Position);
+    ecs_new(world, Position);
+    ecs_new(world, Position);
+    test_int(ctor_invoked, 3);
+    test_int(dtor_invoked, 0);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 3);
+}
+
+void Sparse_deferred_add_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new(world, Velocity);
+    ecs_table_t *table = ecs_get_table(world, e);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Position);
+    ecs_add(world, e, Velocity);
+    test_assert(!ecs_has(world, e, Position));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_get_table(world, e) == table);
+
+    ecs_defer_begin(world);
+    ecs_remove(world, e, Position);
+    ecs_remove(world, e, Velocity);
+    test_assert(ecs_has(world, e, Position));
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void Sparse_deferred_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new(world, Velocity);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+    test_assert(!ecs_has(world, e, Position));
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_defer_begin(world);
+    Position *pm = ecs_get_mut(world, e, Position);
+    test_int(pm->x, 10);
+    test_int(pm->y, 20);
+    pm->x = 30;
+    ecs_defer_end(world);
+
+    p = ecs_get(world, e, Position);
+    test_int(p->x, 30);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void Sparse_pair() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tgt);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_set_pair(world, e, Position, Tgt, {10, 20});
+    test_assert(ecs_has_pair(world, e, ecs_id(Position), Tgt));
+    test_assert(ecs_get_table(world, e) == NULL);
+
+    const Position *p = ecs_get_pair(world, e, Position, Tgt);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_remove_pair(world, e, ecs_id(Position), Tgt);
+    test_assert(!ecs_has_pair(world, e, ecs_id(Position), Tgt));
+
+    ecs_fini(world);
+}
+
+void Sparse_query() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {3, 4});
+    ecs_entity_t e3 = ecs_set(world, 0, Velocity, {5, 6});
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e3, Position, {30, 40});
+    (void)e2;
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_assert(ecs_field_is_set(&it, 1));
+    test_uint(ecs_field_id(&it, 1), ecs_id(Position));
+    Position *p = ecs_field(&it, Position, 1);
+    Velocity *v = ecs_field(&it, Velocity, 2);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    p = ecs_field(&it, Position, 1);
+    v = ecs_field(&it, Velocity, 2);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    test_int(v->x, 5);
+    test_int(v->y, 6);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sparse_query_w_not() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {3, 4});
+    ecs_entity_t e3 = ecs_set(world, 0, Velocity, {5, 6});
+    ecs_entity_t e4 = ecs_set(world, 0, Velocity, {7, 8});
+    ecs_add(world, e1, Position);
+    ecs_add(world, e4, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Velocity, !Position");
+    test_assert(q != NULL);
+
+    /* No sparse data is read, so consecutive rows are returned as one range */
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    test_assert(!ecs_field_is_set(&it, 2));
+    Velocity *v = ecs_field(&it, Velocity, 1);
+    test_int(v[0].x, 3);
+    test_int(v[1].x, 5);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sparse_query_w_optional() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {3, 4});
+    ecs_set(world, e2, Position, {10, 20});
+
+    ecs_query_t *q = ecs_query_new(world, "Velocity, ?Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_assert(!ecs_field_is_set(&it, 2));
+    test_assert(ecs_field(&it, Position, 2) == NULL);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_assert(ecs_field_is_set(&it, 2));
+    Position *p = ecs_field(&it, Position, 2);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sparse_query_sparse_only() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_entity_t e2 = ecs_new(world, Tag);
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_new(world, Velocity);
+    ecs_new(world, Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_int(it.count, 1);
+        Position *p = ecs_field(&it, Position, 1);
+        if (it.entities[0] == e1) {
+            test_int(p->x, 10);
+            test_int(p->y, 20);
+        } else {
+            test_uint(it.entities[0], e2);
+            test_int(p->x, 30);
+            test_int(p->y, 40);
+        }
+        count ++;
+    }
+
+    test_int(count, 2);
+
+    ecs_fini(world);
+}
+
+void Sparse_query_no_data_range() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_entity_t e3 = ecs_new(world, Velocity);
+    ecs_entity_t e4 = ecs_new(world, Velocity);
+    ecs_entity_t e5 = ecs_new(world, Velocity);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e2, Position);
+    ecs_add(world, e4, Position);
+    ecs_add(world, e5, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Velocity, [none] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e1);
+    test_uint(it.entities[1], e2);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e4);
+    test_uint(it.entities[1], e5);
+
+    test_bool(ecs_query_next(&it), false);
+    (void)e3;
+
+    ecs_fini(world);
+}
+
+void Sparse_query_after_remove() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e2, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "Velocity, Position");
+    test_assert(q != NULL);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        count += it.count;
+    }
+    test_int(count, 2);
+
+    ecs_remove(world, e1, Position);
+
+    count = 0;
+    it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_uint(it.entities[0], e2);
+        count += it.count;
+    }
+    test_int(count, 1);
+
+    ecs_fini(world);
+}
+
+static int sparse_on_add_invoked = 0;
+static int sparse_on_set_invoked = 0;
+static int sparse_on_remove_invoked = 0;
+static ecs_entity_t sparse_hook_entity = 0;
+
+static
+void sparse_on_add(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    test_assert(it->event == EcsOnAdd);
+    test_uint(it->entities[0], sparse_hook_entity);
+    sparse_on_add_invoked ++;
+}
+
+static
+void sparse_on_set(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    test_assert(it->event == EcsOnSet);
+    test_uint(it->entities[0], sparse_hook_entity);
+    Position *p = ecs_field(it, Position, 1);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    sparse_on_set_invoked ++;
+}
+
+static
+void sparse_on_remove(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    test_assert(it->event == EcsOnRemove);
+    test_uint(it->entities[0], sparse_hook_entity);
+    sparse_on_remove_invoked ++;
+}
+
+void Sparse_hooks() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_set_hooks(world, Position, {
+        .on_add = sparse_on_add,
+        .on_set = sparse_on_set,
+        .on_remove = sparse_on_remove
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = sparse_hook_entity = ecs_new_id(world);
+    ecs_set(world, e, Position, {10, 20});
+    test_int(sparse_on_add_invoked, 1);
+    test_int(sparse_on_set_invoked, 1);
+    test_int(sparse_on_remove_invoked, 0);
+
+    ecs_set(world, e, Position, {10, 20});
+    test_int(sparse_on_add_invoked, 1);
+    test_int(sparse_on_set_invoked, 2);
+    test_int(sparse_on_remove_invoked, 0);
+
+    ecs_remove(world, e, Position);
+    test_int(sparse_on_add_invoked, 1);
+    test_int(sparse_on_set_invoked, 2);
+    test_int(sparse_on_remove_invoked, 1);
+
+    ecs_add(world, e, Position);
+    test_int(sparse_on_add_invoked, 2);
+    test_int(sparse_on_set_invoked, 2);
+    test_int(sparse_on_remove_invoked, 1);
+
+    ecs_delete(world, e);
+    test_int(sparse_on_add_invoked, 2);
+    test_int(sparse_on_set_invoked, 2);
+    test_int(sparse_on_remove_invoked, 2);
+
+    ecs_fini(world);
+}
+
+void Sparse_on_set_hook_w_modified() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_set_hooks(world, Position, {
+        .on_set = sparse_on_set
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = sparse_hook_entity = ecs_new_id(world);
+    Position *p = ecs_get_mut(world, e, Position);
+    test_assert(p != NULL);
+    test_int(sparse_on_set_invoked, 0);
+
+    p->x = 10;
+    p->y = 20;
+    ecs_modified(world, e, Position);
+    test_int(sparse_on_set_invoked, 1);
+
+    ecs_fini(world);
+}
+
+void Sparse_recycled_id() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_delete(world, e1);
+
+    ecs_entity_t e2 = ecs_new_id(world);
+    test_assert((uint32_t)e2 == (uint32_t)e1);
+    test_assert(e2 != e1);
+    test_assert(!ecs_has(world, e2, Position));
+    test_assert(ecs_get(world, e2, Position) == NULL);
+
+    ecs_set(world, e2, Position, {30, 40});
+    const Position *p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_w_sparse_term() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_filter_t f = ECS_FILTER_INIT;
+    test_assert(NULL == ecs_filter_init(world, &(ecs_filter_desc_t){
+        .storage = &f,
+        .terms = {{ ecs_id(Position) }}
+    }));
+
+    ecs_fini(world);
+}
+
+static
+void SparseObserver(ecs_iter_t *it) { }
+
+void Sparse_observer_w_sparse_term() {
+    ecs_log_set_level(-4);
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    test_assert(0 == ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnAdd },
+        .callback = SparseObserver
+    }));
+
+    ecs_fini(world);
+}
+
+void Sparse_query_terms_not_modified() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_set(world, e, Position, {10, 20});
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+    test_assert(q != NULL);
+
+    const ecs_filter_t *f = ecs_query_get_filter(q);
+    test_int(f->terms[0].oper, EcsAnd);
+    test_int(f->terms[1].oper, EcsAnd);
+
+    char *str = ecs_query_str(q);
+    test_str(str, "Position, Velocity");
+    ecs_os_free(str);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e);
+    test_int(it.terms[0].oper, EcsAnd);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sparse_delete_wo_sparse() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {1, 2});
+
+    /* Sparse components don't set flags on the entity record, which would
+     * make the entity look like it's observed */
+    ecs_record_t *r = ecs_record_find(world, e1);
+    test_assert(r != NULL);
+    test_int(ECS_RECORD_TO_ROW_FLAGS(r->row), 0);
+    r = ecs_record_find(world, e2);
+    test_assert(r != NULL);
+    test_int(ECS_RECORD_TO_ROW_FLAGS(r->row), 0);
+
+    ecs_delete(world, e2);
+    test_assert(ecs_has(world, e1, Position));
+
+    ecs_remove(world, e1, Position);
+    ecs_delete(world, e1);
+    test_assert(!ecs_is_alive(world, e1));
+
+    ecs_fini(world);
+}
+
+static int velocity_dtor_invoked = 0;
+
+static ECS_DTOR(Velocity, ptr, {
+    velocity_dtor_invoked ++;
+})
+
+void Sparse_delete_w_multiple_sparse() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+    ecs_add_id(world, ecs_id(Velocity), EcsSparse);
+    ecs_set_hooks(world, Position, {
+        .dtor = ecs_dtor(Position)
+    });
+    ecs_set_hooks(world, Velocity, {
+        .dtor = ecs_dtor(Velocity)
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_remove(world, e2, Position);
+    test_int(dtor_invoked, 1);
+    test_int(velocity_dtor_invoked, 0);
+
+    ecs_delete(world, e1);
+    test_int(dtor_invoked, 2);
+    test_int(velocity_dtor_invoked, 1);
+
+    ecs_delete(world, e2);
+    test_int(dtor_invoked, 2);
+    test_int(velocity_dtor_invoked, 2);
+
+    /* Recycled id doesn't have the components of the deleted entity */
+    ecs_entity_t e3 = ecs_new_id(world);
+    test_assert((uint32_t)e3 == (uint32_t)e2);
+    test_assert(!ecs_has(world, e3, Position));
+    test_assert(!ecs_has(world, e3, Velocity));
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 2);
+    test_int(velocity_dtor_invoked, 2);
+}
@@ -147,13 +147,16 @@ void Switch_delete_first() {
 
     ecs_iter_t it = ecs_query_iter(world, q);
 
+    /* Deleting e1 moves e3, the last element of the case, into the slot of
+     * e1 in the case array, which now is [e3, e2]. Entities of a case are 
+     * returned from last to first, so e2 is returned before e3. */
     test_assert(ecs_query_next(&it));
     test_int(it.count, 1);
-    test_int(it.entities[0], e3);
+    test_int(it.entities[0], e2);
 
     test_assert(ecs_query_next(&it));
     test_int(it.count, 1);
-    test_int(it.entities[0], e2);
+    test_int(it.entities[0], e3);
 
     test_assert(!ecs_query_next(&it));
 
@@ -1744,3 +1747,52 @@ void Switch_add_switch_to_prefab_instance() {
 
     ecs_fini(world);
 }
+
+void Switch_query_1_case_many_entities_switch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Movement, Union);
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+
+    ecs_query_t *q = ecs_query_new(world, "(Movement, Running)");
+    test_assert(q != NULL);
+
+    ecs_entity_t e[300];
+    int32_t i;
+    for (i = 0; i < 300; i ++) {
+        e[i] = ecs_new_w_pair(world, Movement, Walking);
+    }
+
+    /* Switch cases back and forth, and delete some entities */
+    for (i = 0; i < 300; i += 2) {
+        ecs_add_pair(world, e[i], Movement, Running);
+    }
+    for (i = 0; i < 300; i += 4) {
+        ecs_add_pair(world, e[i], Movement, Walking);
+    }
+    for (i = 0; i < 300; i += 10) {
+        ecs_delete(world, e[i]);
+        e[i] = 0;
+    }
+
+    int32_t expect = 0;
+    for (i = 0; i < 300; i ++) {
+        if (e[i] && ecs_has_pair(world, e[i], Movement, Running)) {
+            expect ++;
+        }
+    }
+    test_int(expect, 60);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        test_int(it.count, 1);
+        test_assert(ecs_has_pair(world, it.entities[0], Movement, Running));
+        count ++;
+    }
+
+    test_int(count, expect);
+
+    ecs_fini(world);
+}
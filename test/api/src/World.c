@@ -1468,3 +1468,96 @@ void World_no_name_prefix_after_init() {
 
     ecs_fini(world);
 }
+
+void World_trim_after_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 10000);
+    test_assert(ids != NULL);
+
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, 10000);
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10000);
+
+    int i;
+    for (i = 0; i < 10000; i ++) {
+        ecs_delete(world, entities[i]);
+    }
+
+    test_assert(ecs_world_trim(world) > 0);
+    test_int(ecs_world_trim(world), 0);
+
+    for (i = 0; i < 10000; i ++) {
+        test_assert(!ecs_is_alive(world, entities[i]));
+    }
+
+    ecs_entity_t e = ecs_new(world, Position);
+    test_assert(e != 0);
+    ecs_set(world, e, Position, {10, 20});
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_os_free(entities);
+
+    ecs_fini(world);
+}
+
+void World_trim_keeps_data() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[1000];
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    for (i = 0; i < 1000; i += 2) {
+        ecs_delete(world, e[i]);
+    }
+
+    ecs_world_trim(world);
+
+    for (i = 1; i < 1000; i += 2) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    for (i = 0; i < 1000; i += 2) {
+        test_assert(!ecs_is_alive(world, e[i]));
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    for (i = 0; i < 1000; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_threading_wo_aload() {
+    ecs_os_set_api_defaults();
+    ecs_os_api_t os_api = ecs_os_api;
+    os_api.aload_ = NULL;
+    ecs_os_set_api(&os_api);
+
+    /* OS APIs that don't set aload get a default implementation */
+    test_assert(ecs_os_api.aload_ != NULL);
+    test_assert(ecs_os_has_threading());
+
+    int32_t value = 10;
+    test_int(ecs_os_aload(&value), 10);
+
+    ecs_world_t *world = ecs_init();
+    test_assert(world != NULL);
+    ecs_fini(world);
+}
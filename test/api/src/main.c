@@ -230,6 +230,10 @@ void Add_invalid_add_pair_w_any_obj(void);
 void Add_invalid_pair_w_0(void);
 void Add_invalid_pair_w_0_rel(void);
 void Add_invalid_pair_w_0_obj(void);
+void Add_bulk_add(void);
+void Add_bulk_add_to_nonempty_table(void);
+void Add_bulk_add_observer(void);
+void Add_bulk_add_deferred(void);
 
 // Testsuite 'Switch'
 void Switch_get_case_no_switch(void);
@@ -277,6 +281,41 @@ void Switch_delete_case_trigger_after_delete_switch(void);
 void Switch_add_2(void);
 void Switch_add_2_reverse(void);
 void Switch_add_switch_to_prefab_instance(void);
+void Switch_query_1_case_many_entities_switch(void);
+
+// Testsuite 'Sparse'
+void Sparse_add(void);
+void Sparse_add_twice(void);
+void Sparse_remove(void);
+void Sparse_remove_not_added(void);
+void Sparse_set(void);
+void Sparse_get_mut(void);
+void Sparse_emplace(void);
+void Sparse_has(void);
+void Sparse_set_no_table_change(void);
+void Sparse_delete(void);
+void Sparse_clear(void);
+void Sparse_delete_parent(void);
+void Sparse_dtor_on_remove(void);
+void Sparse_dtor_on_delete(void);
+void Sparse_dtor_on_fini(void);
+void Sparse_deferred_add_remove(void);
+void Sparse_deferred_set(void);
+void Sparse_pair(void);
+void Sparse_query(void);
+void Sparse_query_w_not(void);
+void Sparse_query_w_optional(void);
+void Sparse_query_sparse_only(void);
+void Sparse_query_no_data_range(void);
+void Sparse_query_after_remove(void);
+void Sparse_hooks(void);
+void Sparse_on_set_hook_w_modified(void);
+void Sparse_recycled_id(void);
+void Sparse_filter_w_sparse_term(void);
+void Sparse_observer_w_sparse_term(void);
+void Sparse_query_terms_not_modified(void);
+void Sparse_delete_wo_sparse(void);
+void Sparse_delete_w_multiple_sparse(void);
 
 // Testsuite 'EnabledComponents'
 void EnabledComponents_is_component_enabled(void);
@@ -330,6 +369,7 @@ void EnabledComponents_query_randomized_3_bitsets(void);
 void EnabledComponents_query_randomized_4_bitsets(void);
 void EnabledComponents_defer_enable(void);
 void EnabledComponents_sort(void);
+void EnabledComponents_query_runs_across_blocks_3_bitsets(void);
 
 // Testsuite 'Remove'
 void Remove_zero(void);
@@ -339,6 +379,9 @@ void Remove_2_again(void);
 void Remove_2_overlap(void);
 void Remove_1_from_empty(void);
 void Remove_not_added(void);
+void Remove_bulk_remove(void);
+void Remove_bulk_remove_last(void);
+void Remove_bulk_remove_observer(void);
 
 // Testsuite 'GlobalComponentIds'
 void GlobalComponentIds_declare(void);
@@ -823,6 +866,8 @@ void ComponentLifecycle_on_add_after_ctor_w_add(void);
 void ComponentLifecycle_on_add_after_ctor_w_add_to(void);
 void ComponentLifecycle_with_before_hooks(void);
 void ComponentLifecycle_move_ctor_on_move(void);
+void ComponentLifecycle_relocatable_no_move_ctor_on_grow(void);
+void ComponentLifecycle_hooks_on_bulk_add_remove(void);
 
 // Testsuite 'Sorting'
 void Sorting_sort_by_component(void);
@@ -858,6 +903,9 @@ void Sorting_sort_relation_marked(void);
 void Sorting_dont_resort_after_set_unsorted_component(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term(void);
+void Sorting_sort_1000_entities_change_few(void);
+void Sorting_sort_entities_16_tables(void);
+void Sorting_sort_1000_entities_change_few_w_equal_values(void);
 
 // Testsuite 'SortingEntireTable'
 void SortingEntireTable_sort_by_component(void);
@@ -1140,6 +1188,9 @@ void Filter_flag_match_only_this(void);
 void Filter_flag_match_only_this_w_ref(void);
 void Filter_filter_w_alloc(void);
 void Filter_filter_w_short_notation(void);
+void Filter_filter_iter_2_or_chains_and_not(void);
+void Filter_filter_iter_after_plan_tables_created(void);
+void Filter_chain_page_iter(void);
 
 // Testsuite 'FilterStr'
 void FilterStr_one_term(void);
@@ -1363,6 +1414,22 @@ void Query_query_next_table_w_populate_first_changed(void);
 void Query_query_next_table_w_populate_last_changed(void);
 void Query_query_next_table_w_populate_skip_first(void);
 void Query_query_next_table_w_populate_skip_last(void);
+void Query_iter_after_empty_and_rematch_tables(void);
+void Query_changed_only_first_iter(void);
+void Query_changed_only_modified_one(void);
+void Query_changed_only_modified_two_blocks(void);
+void Query_changed_only_after_add(void);
+void Query_changed_only_out_term(void);
+void Query_next_batch(void);
+void Query_next_batch_w_shared(void);
+void Query_next_batch_w_toggle(void);
+void Query_next_batch_mark_dirty(void);
+void Query_nested_iter_w_new_tables(void);
+void Query_changed_only_toggle(void);
+void Query_changed_only_union(void);
+void Query_changed_only_get_mut(void);
+void Query_changed_only_write_after_grow(void);
+void Query_iter_while_table_array_changes(void);
 
 // Testsuite 'Iter'
 void Iter_page_iter_0_0(void);
@@ -1401,6 +1468,10 @@ void Iter_page_iter_w_ctx(void);
 void Iter_page_iter_w_binding_ctx(void);
 void Iter_worker_iter_w_ctx(void);
 void Iter_worker_iter_w_binding_ctx(void);
+void Iter_worker_chunk_iter(void);
+void Iter_worker_chunk_iter_skewed_tables(void);
+void Iter_worker_chunk_iter_reset_cursor(void);
+void Iter_worker_chunk_iter_fini_early(void);
 
 // Testsuite 'Pairs'
 void Pairs_type_w_one_pair(void);
@@ -1709,6 +1780,16 @@ void Observer_cache_test_6(void);
 void Observer_cache_test_7(void);
 void Observer_cache_test_8(void);
 void Observer_cache_test_9(void);
+void Observer_batched_bulk_new(void);
+void Observer_batched_bulk_init_w_data(void);
+void Observer_batched_multi_bulk_new(void);
+void Observer_batched_shared_component(void);
+void Observer_not_batched_shared_component(void);
+void Observer_multi_cached_match(void);
+void Observer_multi_cached_match_w_not_event(void);
+void Observer_multi_cached_match_after_table_delete(void);
+void Observer_multi_cached_match_w_isa(void);
+void Observer_multi_cached_match_monitor(void);
 
 // Testsuite 'ObserverOnSet'
 void ObserverOnSet_set_1_of_1(void);
@@ -1989,6 +2070,9 @@ void World_get_type_info(void);
 void World_get_type_info_after_delete_with(void);
 void World_get_type_info_after_reuse(void);
 void World_no_name_prefix_after_init(void);
+void World_trim_after_delete(void);
+void World_trim_keeps_data(void);
+void World_threading_wo_aload(void);
 
 // Testsuite 'WorldInfo'
 void WorldInfo_get_tick(void);
@@ -2125,6 +2209,27 @@ void DeferredActions_defer_add_after_clear(void);
 void DeferredActions_defer_cmd_after_modified(void);
 void DeferredActions_defer_remove_after_emplace_different_id(void);
 void DeferredActions_defer_remove_after_set_and_emplace_different_id(void);
+void DeferredActions_parallel_merge_set(void);
+void DeferredActions_parallel_merge_set_twice(void);
+void DeferredActions_parallel_merge_set_new_component(void);
+void DeferredActions_parallel_merge_set_then_delete(void);
+void DeferredActions_parallel_merge_set_then_remove(void);
+void DeferredActions_parallel_merge_set_w_on_set_observer(void);
+void DeferredActions_parallel_merge_set_w_move_hook(void);
+void DeferredActions_parallel_merge_set_w_change_detection(void);
+void DeferredActions_defer_add_batched_group(void);
+void DeferredActions_defer_add_batched_group_new_entities(void);
+void DeferredActions_defer_add_batched_group_different_transitions(void);
+void DeferredActions_defer_add_batched_group_interleaved_set(void);
+void DeferredActions_defer_add_batched_group_w_isa(void);
+void DeferredActions_defer_add_batched_group_w_remove(void);
+void DeferredActions_defer_emplace_batched(void);
+void DeferredActions_defer_emplace_batched_w_move_ctor(void);
+void DeferredActions_defer_emplace_batched_large(void);
+void DeferredActions_defer_emplace_batched_then_remove(void);
+void DeferredActions_parallel_merge_set_consecutive_rows(void);
+void DeferredActions_parallel_merge_set_new_component_move_row(void);
+void DeferredActions_parallel_merge_set_new_component_w_on_add(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_setup(void);
@@ -2249,6 +2354,9 @@ void Internals_table_observed_after_delete(void);
 void Internals_table_observed_after_on_remove(void);
 void Internals_table_observed_after_entity_flag(void);
 void Internals_table_create_leak_check(void);
+void Internals_column_alignment_32(void);
+void Internals_column_alignment_64(void);
+void Internals_column_alignment_192_64(void);
 
 // Testsuite 'Error'
 void Error_setup(void);
@@ -2265,6 +2373,29 @@ void Error_log_warning(void);
 void Error_log_error(void);
 void Error_last_error(void);
 
+// Testsuite 'CmdQueue'
+void CmdQueue_add(void);
+void CmdQueue_set(void);
+void CmdQueue_remove(void);
+void CmdQueue_delete(void);
+void CmdQueue_add_w_pair(void);
+void CmdQueue_set_macro(void);
+void CmdQueue_merge_in_order(void);
+void CmdQueue_merge_multiple_queues(void);
+void CmdQueue_merge_on_progress(void);
+void CmdQueue_merge_on_frame_begin(void);
+void CmdQueue_queue_full(void);
+void CmdQueue_queue_full_after_merge(void);
+void CmdQueue_value_too_large(void);
+void CmdQueue_dead_entity_discarded(void);
+void CmdQueue_invalid_id_discarded(void);
+void CmdQueue_free_merges_remaining(void);
+void CmdQueue_free_middle_queue(void);
+void CmdQueue_w_on_set_observer(void);
+void CmdQueue_wraparound(void);
+void CmdQueue_producer_thread(void);
+void CmdQueue_producer_threads(void);
+
 bake_test_case Id_testcases[] = {
     {
         "0_is_wildcard",
@@ -3115,6 +3246,22 @@ bake_test_case Add_testcases[] = {
     {
         "invalid_pair_w_0_obj",
         Add_invalid_pair_w_0_obj
+    },
+    {
+        "bulk_add",
+        Add_bulk_add
+    },
+    {
+        "bulk_add_to_nonempty_table",
+        Add_bulk_add_to_nonempty_table
+    },
+    {
+        "bulk_add_observer",
+        Add_bulk_add_observer
+    },
+    {
+        "bulk_add_deferred",
+        Add_bulk_add_deferred
     }
 };
 
@@ -3298,6 +3445,141 @@ bake_test_case Switch_testcases[] = {
     {
         "add_switch_to_prefab_instance",
         Switch_add_switch_to_prefab_instance
+    },
+    {
+        "query_1_case_many_entities_switch",
+        Switch_query_1_case_many_entities_switch
+    }
+};
+
+bake_test_case Sparse_testcases[] = {
+    {
+        "add",
+        Sparse_add
+    },
+    {
+        "add_twice",
+        Sparse_add_twice
+    },
+    {
+        "remove",
+        Sparse_remove
+    },
+    {
+        "remove_not_added",
+        Sparse_remove_not_added
+    },
+    {
+        "set",
+        Sparse_set
+    },
+    {
+        "get_mut",
+        Sparse_get_mut
+    },
+    {
+        "emplace",
+        Sparse_emplace
+    },
+    {
+        "has",
+        Sparse_has
+    },
+    {
+        "set_no_table_change",
+        Sparse_set_no_table_change
+    },
+    {
+        "delete",
+        Sparse_delete
+    },
+    {
+        "clear",
+        Sparse_clear
+    },
+    {
+        "delete_parent",
+        Sparse_delete_parent
+    },
+    {
+        "dtor_on_remove",
+        Sparse_dtor_on_remove
+    },
+    {
+        "dtor_on_delete",
+        Sparse_dtor_on_delete
+    },
+    {
+        "dtor_on_fini",
+        Sparse_dtor_on_fini
+    },
+    {
+        "deferred_add_remove",
+        Sparse_deferred_add_remove
+    },
+    {
+        "deferred_set",
+        Sparse_deferred_set
+    },
+    {
+        "pair",
+        Sparse_pair
+    },
+    {
+        "query",
+        Sparse_query
+    },
+    {
+        "query_w_not",
+        Sparse_query_w_not
+    },
+    {
+        "query_w_optional",
+        Sparse_query_w_optional
+    },
+    {
+        "query_sparse_only",
+        Sparse_query_sparse_only
+    },
+    {
+        "query_no_data_range",
+        Sparse_query_no_data_range
+    },
+    {
+        "query_after_remove",
+        Sparse_query_after_remove
+    },
+    {
+        "hooks",
+        Sparse_hooks
+    },
+    {
+        "on_set_hook_w_modified",
+        Sparse_on_set_hook_w_modified
+    },
+    {
+        "recycled_id",
+        Sparse_recycled_id
+    },
+    {
+        "filter_w_sparse_term",
+        Sparse_filter_w_sparse_term
+    },
+    {
+        "observer_w_sparse_term",
+        Sparse_observer_w_sparse_term
+    },
+    {
+        "query_terms_not_modified",
+        Sparse_query_terms_not_modified
+    },
+    {
+        "delete_wo_sparse",
+        Sparse_delete_wo_sparse
+    },
+    {
+        "delete_w_multiple_sparse",
+        Sparse_delete_w_multiple_sparse
     }
 };
 
@@ -3505,6 +3787,10 @@ bake_test_case EnabledComponents_testcases[] = {
     {
         "sort",
         EnabledComponents_sort
+    },
+    {
+        "query_runs_across_blocks_3_bitsets",
+        EnabledComponents_query_runs_across_blocks_3_bitsets
     }
 };
 
@@ -3536,6 +3822,18 @@ bake_test_case Remove_testcases[] = {
     {
         "not_added",
         Remove_not_added
+    },
+    {
+        "bulk_remove",
+        Remove_bulk_remove
+    },
+    {
+        "bulk_remove_last",
+        Remove_bulk_remove_last
+    },
+    {
+        "bulk_remove_observer",
+        Remove_bulk_remove_observer
     }
 };
 
@@ -5378,6 +5676,14 @@ bake_test_case ComponentLifecycle_testcases[] = {
     {
         "move_ctor_on_move",
         ComponentLifecycle_move_ctor_on_move
+    },
+    {
+        "relocatable_no_move_ctor_on_grow",
+        ComponentLifecycle_relocatable_no_move_ctor_on_grow
+    },
+    {
+        "hooks_on_bulk_add_remove",
+        ComponentLifecycle_hooks_on_bulk_add_remove
     }
 };
 
@@ -5513,6 +5819,18 @@ bake_test_case Sorting_testcases[] = {
     {
         "dont_resort_after_set_unsorted_component_w_tag_w_out_term",
         Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term
+    },
+    {
+        "sort_1000_entities_change_few",
+        Sorting_sort_1000_entities_change_few
+    },
+    {
+        "sort_entities_16_tables",
+        Sorting_sort_entities_16_tables
+    },
+    {
+        "sort_1000_entities_change_few_w_equal_values",
+        Sorting_sort_1000_entities_change_few_w_equal_values
     }
 };
 
@@ -6631,6 +6949,18 @@ bake_test_case Filter_testcases[] = {
     {
         "filter_w_short_notation",
         Filter_filter_w_short_notation
+    },
+    {
+        "filter_iter_2_or_chains_and_not",
+        Filter_filter_iter_2_or_chains_and_not
+    },
+    {
+        "filter_iter_after_plan_tables_created",
+        Filter_filter_iter_after_plan_tables_created
+    },
+    {
+        "chain_page_iter",
+        Filter_chain_page_iter
     }
 };
 
@@ -7513,6 +7843,70 @@ bake_test_case Query_testcases[] = {
     {
         "query_next_table_w_populate_skip_last",
         Query_query_next_table_w_populate_skip_last
+    },
+    {
+        "iter_after_empty_and_rematch_tables",
+        Query_iter_after_empty_and_rematch_tables
+    },
+    {
+        "changed_only_first_iter",
+        Query_changed_only_first_iter
+    },
+    {
+        "changed_only_modified_one",
+        Query_changed_only_modified_one
+    },
+    {
+        "changed_only_modified_two_blocks",
+        Query_changed_only_modified_two_blocks
+    },
+    {
+        "changed_only_after_add",
+        Query_changed_only_after_add
+    },
+    {
+        "changed_only_out_term",
+        Query_changed_only_out_term
+    },
+    {
+        "next_batch",
+        Query_next_batch
+    },
+    {
+        "next_batch_w_shared",
+        Query_next_batch_w_shared
+    },
+    {
+        "next_batch_w_toggle",
+        Query_next_batch_w_toggle
+    },
+    {
+        "next_batch_mark_dirty",
+        Query_next_batch_mark_dirty
+    },
+    {
+        "nested_iter_w_new_tables",
+        Query_nested_iter_w_new_tables
+    },
+    {
+        "changed_only_toggle",
+        Query_changed_only_toggle
+    },
+    {
+        "changed_only_union",
+        Query_changed_only_union
+    },
+    {
+        "changed_only_get_mut",
+        Query_changed_only_get_mut
+    },
+    {
+        "changed_only_write_after_grow",
+        Query_changed_only_write_after_grow
+    },
+    {
+        "iter_while_table_array_changes",
+        Query_iter_while_table_array_changes
     }
 };
 
@@ -7660,6 +8054,22 @@ bake_test_case Iter_testcases[] = {
     {
         "worker_iter_w_binding_ctx",
         Iter_worker_iter_w_binding_ctx
+    },
+    {
+        "worker_chunk_iter",
+        Iter_worker_chunk_iter
+    },
+    {
+        "worker_chunk_iter_skewed_tables",
+        Iter_worker_chunk_iter_skewed_tables
+    },
+    {
+        "worker_chunk_iter_reset_cursor",
+        Iter_worker_chunk_iter_reset_cursor
+    },
+    {
+        "worker_chunk_iter_fini_early",
+        Iter_worker_chunk_iter_fini_early
     }
 };
 
@@ -8877,6 +9287,46 @@ bake_test_case Observer_testcases[] = {
     {
         "cache_test_9",
         Observer_cache_test_9
+    },
+    {
+        "batched_bulk_new",
+        Observer_batched_bulk_new
+    },
+    {
+        "batched_bulk_init_w_data",
+        Observer_batched_bulk_init_w_data
+    },
+    {
+        "batched_multi_bulk_new",
+        Observer_batched_multi_bulk_new
+    },
+    {
+        "batched_shared_component",
+        Observer_batched_shared_component
+    },
+    {
+        "not_batched_shared_component",
+        Observer_not_batched_shared_component
+    },
+    {
+        "multi_cached_match",
+        Observer_multi_cached_match
+    },
+    {
+        "multi_cached_match_w_not_event",
+        Observer_multi_cached_match_w_not_event
+    },
+    {
+        "multi_cached_match_after_table_delete",
+        Observer_multi_cached_match_after_table_delete
+    },
+    {
+        "multi_cached_match_w_isa",
+        Observer_multi_cached_match_w_isa
+    },
+    {
+        "multi_cached_match_monitor",
+        Observer_multi_cached_match_monitor
     }
 };
 
@@ -9950,6 +10400,18 @@ bake_test_case World_testcases[] = {
     {
         "no_name_prefix_after_init",
         World_no_name_prefix_after_init
+    },
+    {
+        "trim_after_delete",
+        World_trim_after_delete
+    },
+    {
+        "trim_keeps_data",
+        World_trim_keeps_data
+    },
+    {
+        "threading_wo_aload",
+        World_threading_wo_aload
     }
 };
 
@@ -10475,6 +10937,90 @@ bake_test_case DeferredActions_testcases[] = {
     {
         "defer_remove_after_set_and_emplace_different_id",
         DeferredActions_defer_remove_after_set_and_emplace_different_id
+    },
+    {
+        "parallel_merge_set",
+        DeferredActions_parallel_merge_set
+    },
+    {
+        "parallel_merge_set_twice",
+        DeferredActions_parallel_merge_set_twice
+    },
+    {
+        "parallel_merge_set_new_component",
+        DeferredActions_parallel_merge_set_new_component
+    },
+    {
+        "parallel_merge_set_then_delete",
+        DeferredActions_parallel_merge_set_then_delete
+    },
+    {
+        "parallel_merge_set_then_remove",
+        DeferredActions_parallel_merge_set_then_remove
+    },
+    {
+        "parallel_merge_set_w_on_set_observer",
+        DeferredActions_parallel_merge_set_w_on_set_observer
+    },
+    {
+        "parallel_merge_set_w_move_hook",
+        DeferredActions_parallel_merge_set_w_move_hook
+    },
+    {
+        "parallel_merge_set_w_change_detection",
+        DeferredActions_parallel_merge_set_w_change_detection
+    },
+    {
+        "defer_add_batched_group",
+        DeferredActions_defer_add_batched_group
+    },
+    {
+        "defer_add_batched_group_new_entities",
+        DeferredActions_defer_add_batched_group_new_entities
+    },
+    {
+        "defer_add_batched_group_different_transitions",
+        DeferredActions_defer_add_batched_group_different_transitions
+    },
+    {
+        "defer_add_batched_group_interleaved_set",
+        DeferredActions_defer_add_batched_group_interleaved_set
+    },
+    {
+        "defer_add_batched_group_w_isa",
+        DeferredActions_defer_add_batched_group_w_isa
+    },
+    {
+        "defer_add_batched_group_w_remove",
+        DeferredActions_defer_add_batched_group_w_remove
+    },
+    {
+        "defer_emplace_batched",
+        DeferredActions_defer_emplace_batched
+    },
+    {
+        "defer_emplace_batched_w_move_ctor",
+        DeferredActions_defer_emplace_batched_w_move_ctor
+    },
+    {
+        "defer_emplace_batched_large",
+        DeferredActions_defer_emplace_batched_large
+    },
+    {
+        "defer_emplace_batched_then_remove",
+        DeferredActions_defer_emplace_batched_then_remove
+    },
+    {
+        "parallel_merge_set_consecutive_rows",
+        DeferredActions_parallel_merge_set_consecutive_rows
+    },
+    {
+        "parallel_merge_set_new_component_move_row",
+        DeferredActions_parallel_merge_set_new_component_move_row
+    },
+    {
+        "parallel_merge_set_new_component_w_on_add",
+        DeferredActions_parallel_merge_set_new_component_w_on_add
     }
 };
 
@@ -10939,6 +11485,18 @@ bake_test_case Internals_testcases[] = {
     {
         "table_create_leak_check",
         Internals_table_create_leak_check
+    },
+    {
+        "column_alignment_32",
+        Internals_column_alignment_32
+    },
+    {
+        "column_alignment_64",
+        Internals_column_alignment_64
+    },
+    {
+        "column_alignment_192_64",
+        Internals_column_alignment_192_64
     }
 };
 
@@ -10993,6 +11551,93 @@ bake_test_case Error_testcases[] = {
     }
 };
 
+bake_test_case CmdQueue_testcases[] = {
+    {
+        "add",
+        CmdQueue_add
+    },
+    {
+        "set",
+        CmdQueue_set
+    },
+    {
+        "remove",
+        CmdQueue_remove
+    },
+    {
+        "delete",
+        CmdQueue_delete
+    },
+    {
+        "add_w_pair",
+        CmdQueue_add_w_pair
+    },
+    {
+        "set_macro",
+        CmdQueue_set_macro
+    },
+    {
+        "merge_in_order",
+        CmdQueue_merge_in_order
+    },
+    {
+        "merge_multiple_queues",
+        CmdQueue_merge_multiple_queues
+    },
+    {
+        "merge_on_progress",
+        CmdQueue_merge_on_progress
+    },
+    {
+        "merge_on_frame_begin",
+        CmdQueue_merge_on_frame_begin
+    },
+    {
+        "queue_full",
+        CmdQueue_queue_full
+    },
+    {
+        "queue_full_after_merge",
+        CmdQueue_queue_full_after_merge
+    },
+    {
+        "value_too_large",
+        CmdQueue_value_too_large
+    },
+    {
+        "dead_entity_discarded",
+        CmdQueue_dead_entity_discarded
+    },
+    {
+        "invalid_id_discarded",
+        CmdQueue_invalid_id_discarded
+    },
+    {
+        "free_merges_remaining",
+        CmdQueue_free_merges_remaining
+    },
+    {
+        "free_middle_queue",
+        CmdQueue_free_middle_queue
+    },
+    {
+        "w_on_set_observer",
+        CmdQueue_w_on_set_observer
+    },
+    {
+        "wraparound",
+        CmdQueue_wraparound
+    },
+    {
+        "producer_thread",
+        CmdQueue_producer_thread
+    },
+    {
+        "producer_threads",
+        CmdQueue_producer_threads
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Id",
@@ -11040,28 +11685,35 @@ static bake_test_suite suites[] = {
         "Add",
         NULL,
         NULL,
-        25,
+        29,
         Add_testcases
     },
     {
         "Switch",
         NULL,
         NULL,
-        45,
+        46,
         Switch_testcases
     },
+    {
+        "Sparse",
+        NULL,
+        NULL,
+        32,
+        Sparse_testcases
+    },
     {
         "EnabledComponents",
         NULL,
         NULL,
-        51,
+        52,
         EnabledComponents_testcases
     },
     {
         "Remove",
         NULL,
         NULL,
-        7,
+        10,
         Remove_testcases
     },
     {
@@ -11159,14 +11811,14 @@ static bake_test_suite suites[] = {
         "ComponentLifecycle",
         ComponentLifecycle_setup,
         NULL,
-        76,
+        78,
         ComponentLifecycle_testcases
     },
     {
         "Sorting",
         NULL,
         NULL,
-        33,
+        36,
         Sorting_testcases
     },
     {
@@ -11180,7 +11832,7 @@ static bake_test_suite suites[] = {
         "Filter",
         NULL,
         NULL,
-        245,
+        248,
         Filter_testcases
     },
     {
@@ -11194,14 +11846,14 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        199,
+        215,
         Query_testcases
     },
     {
         "Iter",
         NULL,
         NULL,
-        36,
+        40,
         Iter_testcases
     },
     {
@@ -11222,7 +11874,7 @@ static bake_test_suite suites[] = {
         "Observer",
         NULL,
         NULL,
-        85,
+        95,
         Observer_testcases
     },
     {
@@ -11271,7 +11923,7 @@ static bake_test_suite suites[] = {
         "World",
         World_setup,
         NULL,
-        51,
+        54,
         World_testcases
     },
     {
@@ -11292,7 +11944,7 @@ static bake_test_suite suites[] = {
         "DeferredActions",
         NULL,
         NULL,
-        91,
+        112,
         DeferredActions_testcases
     },
     {
@@ -11320,7 +11972,7 @@ static bake_test_suite suites[] = {
         "Internals",
         Internals_setup,
         NULL,
-        18,
+        21,
         Internals_testcases
     },
     {
@@ -11329,9 +11981,16 @@ static bake_test_suite suites[] = {
         NULL,
         12,
         Error_testcases
+    },
+    {
+        "CmdQueue",
+        NULL,
+        NULL,
+        21,
+        CmdQueue_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("api", argc, argv, suites, 48);
+    return bake_test_run("api", argc, argv, suites, 50);
 }
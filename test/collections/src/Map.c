@@ -20,6 +20,17 @@ void fill_map(
     }
 }
 
+static
+void fill_map_n(
+    ecs_map_t *map,
+    int64_t count)
+{
+    int64_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_map_set(map, i, &i);
+    }
+}
+
 static int32_t malloc_count;
 
 static
@@ -308,7 +319,7 @@ void Map_grow() {
         ecs_map_set(map, i, &v);
     }
 
-    test_int(malloc_count, 1);
+    test_int(malloc_count, 0);
 
     ecs_map_free(map);
 }
@@ -333,3 +344,95 @@ void Map_ensure() {
 
     ecs_map_free(map);
 }
+
+void Map_set_remove_many() {
+    ecs_map_t *map = ecs_map_new(int64_t, NULL, 0);
+
+    int64_t i, count = 10000;
+    for (i = 0; i < count; i ++) {
+        int64_t v = i * 2;
+        ecs_map_set(map, i * 1000003, &v);
+    }
+
+    test_int(ecs_map_count(map), count);
+
+    for (i = 0; i < count; i ++) {
+        int64_t *v = ecs_map_get(map, int64_t, i * 1000003);
+        test_assert(v != NULL);
+        test_int(*v, i * 2);
+    }
+
+    for (i = 0; i < count; i += 2) {
+        ecs_map_remove(map, i * 1000003);
+    }
+
+    test_int(ecs_map_count(map), count / 2);
+
+    for (i = 0; i < count; i ++) {
+        int64_t *v = ecs_map_get(map, int64_t, i * 1000003);
+        if (i % 2) {
+            test_assert(v != NULL);
+            test_int(*v, i * 2);
+        } else {
+            test_assert(v == NULL);
+        }
+    }
+
+    for (i = 0; i < count; i += 2) {
+        int64_t v = i * 3;
+        ecs_map_set(map, i * 1000003, &v);
+    }
+
+    test_int(ecs_map_count(map), count);
+
+    for (i = 0; i < count; i ++) {
+        int64_t *v = ecs_map_get(map, int64_t, i * 1000003);
+        test_assert(v != NULL);
+        test_int(*v, i * (i % 2 ? 2 : 3));
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_remove_reinsert_no_grow() {
+    ecs_map_t *map = ecs_map_new(int64_t, NULL, 8);
+    fill_map_n(map, 8);
+
+    int32_t bucket_count = ecs_map_bucket_count(map);
+
+    int64_t i;
+    for (i = 0; i < 10000; i ++) {
+        int64_t key = (i + 100) << 32;
+        ecs_map_set(map, key, &i);
+        test_int(*ecs_map_get(map, int64_t, key), i);
+        ecs_map_remove(map, key);
+        test_assert(ecs_map_get(map, int64_t, key) == NULL);
+    }
+
+    test_int(ecs_map_count(map), 8);
+    test_int(ecs_map_bucket_count(map), bucket_count);
+
+    for (i = 0; i < 8; i ++) {
+        test_int(*ecs_map_get(map, int64_t, i), i);
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_iter_remove() {
+    ecs_map_t *map = ecs_map_new(int64_t, NULL, 0);
+    fill_map_n(map, 100);
+
+    int32_t count = 0;
+    ecs_map_key_t key;
+    ecs_map_iter_t it = ecs_map_iter(map);
+    while (ecs_map_next(&it, int64_t, &key)) {
+        ecs_map_remove(map, key);
+        count ++;
+    }
+
+    test_int(count, 100);
+    test_int(ecs_map_count(map), 0);
+
+    ecs_map_free(map);
+}
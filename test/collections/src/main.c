@@ -61,6 +61,9 @@ void Map_remove_unknown(void);
 void Map_grow(void);
 void Map_set_size_0(void);
 void Map_ensure(void);
+void Map_set_remove_many(void);
+void Map_remove_reinsert_no_grow(void);
+void Map_iter_remove(void);
 
 // Testsuite 'Sparse'
 void Sparse_setup(void);
@@ -308,6 +311,18 @@ bake_test_case Map_testcases[] = {
     {
         "ensure",
         Map_ensure
+    },
+    {
+        "set_remove_many",
+        Map_set_remove_many
+    },
+    {
+        "remove_reinsert_no_grow",
+        Map_remove_reinsert_no_grow
+    },
+    {
+        "iter_remove",
+        Map_iter_remove
     }
 };
 
@@ -509,7 +524,7 @@ static bake_test_suite suites[] = {
         "Map",
         Map_setup,
         NULL,
-        19,
+        22,
         Map_testcases
     },
     {
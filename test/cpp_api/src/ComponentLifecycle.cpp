@@ -1634,3 +1634,22 @@ void ComponentLifecycle_emplace_w_on_add_existing() {
     e1.emplace<Position>();
     test_int(on_add, 1);
 }
+
+void ComponentLifecycle_relocatable_no_move_ctor_on_grow() {
+    flecs::world ecs;
+
+    ecs.component<Pod>().relocatable();
+
+    flecs::entity e[64];
+    for (int i = 0; i < 64; i ++) {
+        e[i] = ecs.entity().set<Pod>({i});
+    }
+
+    test_int(Pod::move_ctor_invoked, 0);
+
+    for (int i = 0; i < 64; i ++) {
+        const Pod *p = e[i].get<Pod>();
+        test_assert(p != nullptr);
+        test_int(p->value, i);
+    }
+}
@@ -598,3 +598,32 @@ void Observer_run_callback() {
 
 
 }
+
+void Observer_batched() {
+    flecs::world world;
+
+    auto base = world.prefab().set<Velocity>({1, 2});
+
+    int32_t invoked = 0, count = 0;
+    world.observer<Velocity, Position>()
+        .event(flecs::OnAdd)
+        .batched()
+        .iter([&](flecs::iter& it, Velocity *v, Position *p) {
+            test_assert(!it.is_self(1));
+            test_assert(it.is_self(2));
+            test_assert(p != nullptr);
+            test_int(v->x, 1);
+            test_int(v->y, 2);
+            invoked ++;
+            count += it.count();
+        });
+
+    ecs_bulk_desc_t desc = {};
+    desc.count = 100;
+    desc.ids[0] = world.id<Position>();
+    desc.ids[1] = world.pair(flecs::IsA, base);
+    ecs_bulk_init(world, &desc);
+
+    test_int(invoked, 1);
+    test_int(count, 100);
+}
@@ -2150,3 +2150,162 @@ void Query_instanced_nested_query_w_world() {
 
     test_int(count, 2);
 }
+
+struct alignas(64) Particles {
+    float x[16];
+};
+
+void Query_iter_field_data_aligned() {
+    flecs::world ecs;
+
+    for (int i = 0; i < 10; i ++) {
+        ecs.entity().set<Particles>({});
+    }
+
+    auto q = ecs.query<Particles>();
+
+    int32_t count = 0;
+    q.iter([&](flecs::iter& it) {
+        auto p = it.field<Particles>(1);
+        Particles *data = p.data();
+        test_assert(data != nullptr);
+        test_int(reinterpret_cast<uintptr_t>(data) % 64, 0);
+        test_int(p.count(), it.count());
+
+        for (size_t i = 0; i < p.count(); i ++) {
+            data[i].x[0] = 1;
+        }
+
+        count += it.count();
+    });
+
+    test_int(count, 10);
+}
+
+void Query_each_sparse() {
+    flecs::world ecs;
+
+    ecs.component<Position>().add(flecs::Sparse);
+
+    auto e1 = ecs.entity().set<Velocity>({1, 2});
+    auto e2 = ecs.entity().set<Velocity>({3, 4});
+    auto e3 = ecs.entity().set<Velocity>({5, 6});
+    e1.set<Position>({10, 20});
+    e3.set<Position>({30, 40});
+
+    test_assert(e1.table() == e2.table());
+    test_assert(e1.table() == e3.table());
+
+    auto q = ecs.query<Position, const Velocity>();
+
+    int32_t count = 0;
+    q.each([&](flecs::entity e, Position& p, const Velocity& v) {
+        test_assert(e != e2);
+        p.x += v.x;
+        p.y += v.y;
+        count ++;
+    });
+
+    test_int(count, 2);
+
+    const Position *p = e1.get<Position>();
+    test_int(p->x, 11);
+    test_int(p->y, 22);
+
+    p = e3.get<Position>();
+    test_int(p->x, 35);
+    test_int(p->y, 46);
+
+    e1.remove<Position>();
+    test_assert(!e1.has<Position>());
+    test_assert(e1.table() == e2.table());
+}
+
+void Query_each_changed_only() {
+    flecs::world ecs;
+
+    flecs::entity e[100];
+    for (int i = 0; i < 100; i ++) {
+        e[i] = ecs.entity().set<Position>({i, 0});
+    }
+
+    auto q = ecs.query_builder<const Position>()
+        .changed_only()
+        .build();
+
+    int32_t count = 0;
+    q.each([&](const Position&) { count ++; });
+    test_int(count, 100);
+
+    count = 0;
+    q.each([&](const Position&) { count ++; });
+    test_int(count, 0);
+
+    e[80].set<Position>({10, 20});
+
+    count = 0;
+    bool found = false;
+    q.each([&](flecs::entity ent, const Position& p) { 
+        if (ent == e[80]) {
+            test_int(p.x, 10);
+            test_int(p.y, 20);
+            found = true;
+        }
+        count ++; 
+    });
+    test_int(count, 100 - 64);
+    test_bool(found, true);
+}
+
+void Query_each_batch_many_tables() {
+    flecs::world ecs;
+
+    // Create more tables than are fetched in a single batch
+    flecs::entity e[100];
+    for (int i = 0; i < 100; i ++) {
+        flecs::entity tag = ecs.entity();
+        e[i] = ecs.entity().add(tag).set<Position>({i, 0});
+    }
+
+    auto q = ecs.query<Position>();
+
+    int32_t count = 0;
+    q.each([&](flecs::entity ent, Position& p) {
+        test_assert(ent == e[static_cast<int>(p.x)]);
+        p.y = p.x * 2;
+        count ++;
+    });
+    test_int(count, 100);
+
+    count = 0;
+    q.each([&](const Position& p) {
+        test_int(p.y, p.x * 2);
+        count ++;
+    });
+    test_int(count, 100);
+}
+
+void Query_each_batch_w_shared() {
+    flecs::world ecs;
+
+    auto base = ecs.entity().set<Velocity>({1, 2});
+    ecs.entity().is_a(base).set<Position>({10, 20});
+    ecs.entity().is_a(base).set<Position>({30, 40});
+    ecs.entity().set<Velocity>({3, 4}).set<Position>({50, 60});
+
+    auto q = ecs.query<Position, const Velocity>();
+
+    int32_t count = 0;
+    q.each([&](Position& p, const Velocity& v) {
+        p.x += v.x;
+        p.y += v.y;
+        count ++;
+    });
+    test_int(count, 3);
+
+    int32_t sum = 0;
+    q.each([&](const Position& p, const Velocity&) {
+        sum += p.x + p.y;
+    });
+    test_int(sum, 11 + 22 + 31 + 42 + 53 + 64);
+}
@@ -2009,3 +2009,31 @@ void System_run_callback() {
     test_int(v->x, 1);
     test_int(v->y, 2);
 }
+
+void System_multithread_system_w_chunk_size() {
+    flecs::world world;
+
+    world.set_threads(2);
+
+    flecs::entity e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = world.entity().set<Position>({10, 20});
+    }
+
+    world.system<Position>()
+        .multi_threaded()
+        .chunk_size(3)
+        .each([](Position& p) {
+            p.x ++;
+            p.y ++;
+        });
+
+    world.progress();
+    world.progress();
+
+    for (int i = 0; i < 10; i ++) {
+        const Position *p = e[i].get<Position>();
+        test_int(p->x, 12);
+        test_int(p->y, 22);
+    }
+}
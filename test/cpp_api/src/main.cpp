@@ -425,6 +425,7 @@ void System_multithread_system_w_query_iter(void);
 void System_multithread_system_w_query_iter_w_iter(void);
 void System_multithread_system_w_query_iter_w_world(void);
 void System_run_callback(void);
+void System_multithread_system_w_chunk_size(void);
 
 // Testsuite 'Event'
 void Event_evt_1_id_entity(void);
@@ -524,6 +525,11 @@ void Query_named_query(void);
 void Query_instanced_nested_query_w_iter(void);
 void Query_instanced_nested_query_w_entity(void);
 void Query_instanced_nested_query_w_world(void);
+void Query_iter_field_data_aligned(void);
+void Query_each_sparse(void);
+void Query_each_changed_only(void);
+void Query_each_batch_many_tables(void);
+void Query_each_batch_w_shared(void);
 
 // Testsuite 'QueryBuilder'
 void QueryBuilder_builder_assign_same_type(void);
@@ -773,6 +779,7 @@ void Observer_on_add_tag_each(void);
 void Observer_on_add_expr(void);
 void Observer_observer_w_filter_term(void);
 void Observer_run_callback(void);
+void Observer_batched(void);
 
 // Testsuite 'Filter'
 void Filter_term_each_component(void);
@@ -861,6 +868,7 @@ void ComponentLifecycle_ctor_w_2_worlds_explicit_registration(void);
 void ComponentLifecycle_defer_emplace(void);
 void ComponentLifecycle_emplace_w_on_add(void);
 void ComponentLifecycle_emplace_w_on_add_existing(void);
+void ComponentLifecycle_relocatable_no_move_ctor_on_grow(void);
 
 // Testsuite 'Refs'
 void Refs_get_ref_by_ptr(void);
@@ -2718,6 +2726,10 @@ bake_test_case System_testcases[] = {
     {
         "run_callback",
         System_run_callback
+    },
+    {
+        "multithread_system_w_chunk_size",
+        System_multithread_system_w_chunk_size
     }
 };
 
@@ -3099,6 +3111,26 @@ bake_test_case Query_testcases[] = {
     {
         "instanced_nested_query_w_world",
         Query_instanced_nested_query_w_world
+    },
+    {
+        "iter_field_data_aligned",
+        Query_iter_field_data_aligned
+    },
+    {
+        "each_sparse",
+        Query_each_sparse
+    },
+    {
+        "each_changed_only",
+        Query_each_changed_only
+    },
+    {
+        "each_batch_many_tables",
+        Query_each_batch_many_tables
+    },
+    {
+        "each_batch_w_shared",
+        Query_each_batch_w_shared
     }
 };
 
@@ -4070,6 +4102,10 @@ bake_test_case Observer_testcases[] = {
     {
         "run_callback",
         Observer_run_callback
+    },
+    {
+        "batched",
+        Observer_batched
     }
 };
 
@@ -4412,6 +4448,10 @@ bake_test_case ComponentLifecycle_testcases[] = {
     {
         "emplace_w_on_add_existing",
         ComponentLifecycle_emplace_w_on_add_existing
+    },
+    {
+        "relocatable_no_move_ctor_on_grow",
+        ComponentLifecycle_relocatable_no_move_ctor_on_grow
     }
 };
 
@@ -5291,7 +5331,7 @@ static bake_test_suite suites[] = {
         "System",
         NULL,
         NULL,
-        60,
+        61,
         System_testcases
     },
     {
@@ -5312,7 +5352,7 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        74,
+        79,
         Query_testcases
     },
     {
@@ -5347,7 +5387,7 @@ static bake_test_suite suites[] = {
         "Observer",
         NULL,
         NULL,
-        22,
+        23,
         Observer_testcases
     },
     {
@@ -5361,7 +5401,7 @@ static bake_test_suite suites[] = {
         "ComponentLifecycle",
         NULL,
         NULL,
-        65,
+        66,
         ComponentLifecycle_testcases
     },
     {